@@ -29,6 +29,9 @@ function(add_resources out_var id)
     list(POP_FRONT options resource_id in_f_bin)
 
     set(out_f_cpp "${CMAKE_CURRENT_BINARY_DIR}/${in_f_bin}.cpp")
+    # resources outside this folder (e.g. ../firmware) are generated in a matching sub-folder
+    get_filename_component(out_d_cpp ${out_f_cpp} DIRECTORY)
+    file(MAKE_DIRECTORY ${out_d_cpp})
     add_custom_command(
       OUTPUT ${out_f_cpp}
       COMMAND xxd -i ${in_f_bin} > ${out_f_cpp}
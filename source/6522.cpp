@@ -44,6 +44,7 @@ void SY6522::Reset(const bool powerCycle)
 		m_regs.TIMER1_LATCH.w = 0xffff;	// Some random value (but pick $ffff so it's deterministic)
 										// . NB. if it's too small (< ~$0007) then MB detection routines will fail!
 		m_isBusDriven = false;
+		m_timerBaseCycle = g_nCumulativeCycles;
 	}
 
 	CpuCreateCriticalSection();	// Reset() called by SY6522 global ctor, so explicitly create CPU's CriticalSection
@@ -146,6 +147,8 @@ void SY6522::UpdateIFR(BYTE clr_ifr, BYTE set_ifr /*= 0*/)
 
 void SY6522::Write(BYTE nReg, BYTE nValue)
 {
+	UpdateCounters();
+
 	switch (nReg)
 	{
 	case 0x00:	// ORB
@@ -225,16 +228,63 @@ void SY6522::Write(BYTE nReg, BYTE nValue)
 
 //-----------------------------------------------------------------------------
 
-void SY6522::UpdateTimer1(USHORT clocks)
+// Bring the TIMER1/2 counters forward from m_timerBaseCycle to the current cycle.
+// Called on demand (register access, underflow event, debugger, save-state) - the underflow itself is signalled by the SyncEvent.
+// NB. The caller must have called CpuCalcCycles() (eg. via MockingboardCardManager::UpdateCycles()) if mid-way through an execution period.
+void SY6522::UpdateCounters(void)
+{
+	if (g_nCumulativeCycles <= m_timerBaseCycle)
+	{
+		m_timerBaseCycle = g_nCumulativeCycles;	// NB. can go backwards when loading a save-state
+		return;
+	}
+
+	const UINT64 clocks = g_nCumulativeCycles - m_timerBaseCycle;
+	m_timerBaseCycle = g_nCumulativeCycles;
+
+	UpdateTimer1(clocks);
+	UpdateTimer2(clocks);
+}
+
+void SY6522::SetCumulativeCycles(void)
+{
+	m_timerBaseCycle = g_nCumulativeCycles;
+}
+
+// Equivalent to repeatedly calling CheckTimerUnderflow() & OnTimer1Underflow() for smaller amounts of clocks
+void SY6522::UpdateTimer1(UINT64 clocks)
 {
-	if (CheckTimerUnderflow(m_regs.TIMER1_COUNTER.w, m_timer1IrqDelay, clocks))
-		m_timer1IrqDelay = OnTimer1Underflow(m_regs.TIMER1_COUNTER.w);
+	// An IRQ delay means that the counter has already underflowed, ie. TIMER=0xFFFF is really -1 (or 0xFFFE is -2 for MegaAudio)
+	const int64_t counter = m_timer1IrqDelay ? (int64_t)(short)m_regs.TIMER1_COUNTER.w : (int64_t)m_regs.TIMER1_COUNTER.w;
+	const int64_t minTimer = m_isMegaAudio ? -2 : -1;	// MegaAudio asserts IRQ 1 cycle late!
+
+	int64_t timer = counter - (int64_t)clocks;
+	if (timer < minTimer)
+	{
+		// Reload from the latch, accounting for all underflowed cycles (GH#651) and the extra 2 cycles (GH#652)
+		int64_t period;
+		if (m_isMegaAudio)
+			period = (m_regs.TIMER1_LATCH.w ? m_regs.TIMER1_LATCH.w : 0xFFFF) + kExtraMegaAudioTimerCycles;	// MegaAudio && T1.LATCH=0: use 0xFFFF (or maybe 0x10000?)
+		else
+			period = m_regs.TIMER1_LATCH.w + kExtraTimerCycles;
+
+		timer = minTimer + (timer - minTimer) % period;
+		if (timer < minTimer)
+			timer += period;
+	}
+
+	m_regs.TIMER1_COUNTER.w = (USHORT)timer;
+	m_timer1IrqDelay = (timer < 0) ? 1 : 0;
 }
 
-void SY6522::UpdateTimer2(USHORT clocks)
+void SY6522::UpdateTimer2(UINT64 clocks)
 {
 	// No TIMER2 latch so "after timing out, the counter will continue to decrement"
-	CheckTimerUnderflow(m_regs.TIMER2_COUNTER.w, m_timer2IrqDelay, clocks);
+	const USHORT counter = m_regs.TIMER2_COUNTER.w - (USHORT)clocks;
+	m_regs.TIMER2_COUNTER.w = counter;
+
+	// IRQ delay if the counter has only just wrapped: TIMER = 0xFFFF (or 0xFFFE for MegaAudio)
+	m_timer2IrqDelay = (counter == 0xFFFF || (m_isMegaAudio && counter == 0xFFFE && clocks >= 2)) ? 1 : 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -339,6 +389,8 @@ BYTE SY6522::Read(BYTE nReg)
 {
 	BYTE nValue = 0x00;
 
+	UpdateCounters();
+
 	switch (nReg)
 	{
 	case 0x00:	// IRB
@@ -633,6 +685,8 @@ UINT SY6522::GetOpcodeCycles(BYTE reg, UINT zpOpcodeCycles, UINT opcodeCycles,
 
 void SY6522::SaveSnapshot(YamlSaveHelper& yamlSaveHelper)
 {
+	UpdateCounters();
+
 	YamlSaveHelper::Label label(yamlSaveHelper, "%s:\n", SS_YAML_KEY_SY6522);
 
 	yamlSaveHelper.SaveHexUint8(SS_YAML_KEY_SY6522_REG_ORB, m_regs.ORB);
@@ -676,6 +730,7 @@ void SY6522::LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version)
 	m_regs.ORA_NO_HS = 0;	// Not saved
 
 	m_timer1IrqDelay = m_timer2IrqDelay = 0;
+	m_timerBaseCycle = g_nCumulativeCycles;
 
 	if (version >= 4)
 	{
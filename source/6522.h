@@ -3,7 +3,7 @@
 class SY6522
 {
 public:
-	SY6522(UINT slot, bool isMegaAudio) : m_slot(slot), m_isMegaAudio(isMegaAudio), m_isBusDriven(false), m_bad6522(false)
+	SY6522(UINT slot, bool isMegaAudio) : m_timerBaseCycle(0), m_slot(slot), m_isMegaAudio(isMegaAudio), m_isBusDriven(false), m_bad6522(false)
 	{
 		for (UINT i = 0; i < kNumTimersPer6522; i++)
 			m_syncEvent[i] = NULL;
@@ -35,8 +35,7 @@ public:
 
 	void UpdateIFR(BYTE clr_ifr, BYTE set_ifr = 0);
 
-	void UpdateTimer1(USHORT clocks);
-	void UpdateTimer2(USHORT clocks);
+	void SetCumulativeCycles(void);
 
 	enum { rORB = 0, rORA, rDDRB, rDDRA, rT1CL, rT1CH, rT1LL, rT1LH, rT2CL, rT2CH, rSR, rACR, rPCR, rIFR, rIER, rORA_NO_HS, SIZE_6522_REGS };
 
@@ -54,11 +53,11 @@ public:
 		return 0;
 	}
 	BYTE GetBusViewOfORB(void) { return m_regs.ORB & m_regs.DDRB; }	// Return how the AY8913 sees ORB on the bus (ie. not CPU's view which will be OR'd with !DDRB)
-	USHORT GetRegT1C(void) { return m_regs.TIMER1_COUNTER.w; }
-	USHORT GetRegT2C(void) { return m_regs.TIMER2_COUNTER.w; }
-	void GetRegs(BYTE regs[SIZE_6522_REGS]) { memcpy(&regs[0], (BYTE*)&m_regs, SIZE_6522_REGS); }	// For debugger
+	USHORT GetRegT1C(void) { UpdateCounters(); return m_regs.TIMER1_COUNTER.w; }
+	USHORT GetRegT2C(void) { UpdateCounters(); return m_regs.TIMER2_COUNTER.w; }
+	void GetRegs(BYTE regs[SIZE_6522_REGS]) { UpdateCounters(); memcpy(&regs[0], (BYTE*)&m_regs, SIZE_6522_REGS); }	// For debugger
 	void SetRegIRA(BYTE reg) { m_regs.ORA = reg; }
-	bool IsTimer1IrqDelay(void) { return m_timer1IrqDelay ? true : false; }
+	bool IsTimer1IrqDelay(void) { UpdateCounters(); return m_timer1IrqDelay ? true : false; }
 	void SetBusBeingDriven(bool state) { m_isBusDriven = state; }
 	bool IsBad(void) { return m_bad6522; }
 
@@ -87,6 +86,10 @@ public:
 private:
 	USHORT SetTimerSyncEvent(BYTE reg, USHORT timerLatch);
 
+	void UpdateCounters(void);
+	void UpdateTimer1(UINT64 clocks);
+	void UpdateTimer2(UINT64 clocks);
+
 	USHORT GetTimer1Counter(BYTE reg);
 	USHORT GetTimer2Counter(BYTE reg);
 	bool IsTimer1Underflowed(BYTE reg);
@@ -142,10 +145,13 @@ private:
 
 #pragma pack(pop)
 
+	// TIMER1/2 counters (and IRQ delays) are only valid at m_timerBaseCycle: they are brought up to date on demand
+	// (register access, debugger, save-state) instead of after every execution period - see UpdateCounters()
 	Regs m_regs;
 
 	int m_timer1IrqDelay;
 	int m_timer2IrqDelay;
+	UINT64 m_timerBaseCycle;
 	bool m_timer1Active;
 	bool m_timer2Active;
 
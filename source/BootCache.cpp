@@ -0,0 +1,282 @@
+/*
+  AppleWin : An Apple //e emulator for Windows
+
+  Copyright (C) 1994-1996, Michael O'Brien
+  Copyright (C) 1999-2001, Oliver Schmidt
+  Copyright (C) 2002-2005, Tom Charlesworth
+  Copyright (C) 2006-2024, Tom Charlesworth, Michael Pohoreski
+
+  AppleWin is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  AppleWin is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with AppleWin; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+/*
+  BootCache.cpp
+
+  Cache the machine state once a disk image has booted:
+  . the first (cold) boot runs as normal, and when the trigger fires the state is saved via Snapshot_SaveState()
+  . later runs with the same images & config restore it via Snapshot_LoadState() instead of booting
+
+  The cache file is named after a hash of:
+  . the contents & pathname of each inserted floppy & hard disk image (snapshots refer to images by pathname)
+  . the machine config (CConfigNeedingRestart)
+  . the trigger
+  So a changed image (or config) simply misses the cache, and is booted & cached again.
+*/
+
+#include "StdAfx.h"
+
+#include "BootCache.h"
+#include "SaveState.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Harddisk.h"
+#include "Keyboard.h"
+#include "Log.h"
+#include "StrFormat.h"
+
+#include "Configuration/Config.h"
+
+#define BOOTCACHE_KEYWAIT_POLLS 1000	// # of $C000 reads before the keyboard wait trigger fires
+
+static BootCacheTrigger_e g_bootCacheTrigger = BOOTCACHE_TRIGGER_NONE;
+static uint64_t g_bootCacheTriggerValue = 0;	// PC or # cycles
+static std::string g_strBootCacheTrigger;
+static std::string g_strBootCacheDirectory;
+static std::string g_strBootCachePathname;
+
+static bool g_bBootCachePending = false;		// cold boot in progress: waiting for the trigger
+static unsigned __int64 g_uBootCacheStartCycle = 0;
+static UINT64 g_uBootCacheKeybReadCount = 0;	// KeybGetReadCount() when armed
+
+//===========================================================================
+
+bool BootCache_SetTrigger(const std::string& trigger)
+{
+	char* end = NULL;
+
+	if (trigger.compare(0, 3, "pc=") == 0)
+	{
+		const unsigned long pc = strtoul(trigger.c_str() + 3, &end, 16);
+		if (*end || end == trigger.c_str() + 3 || pc > 0xFFFF)
+			return false;
+		g_bootCacheTrigger = BOOTCACHE_TRIGGER_PC;
+		g_bootCacheTriggerValue = pc;
+	}
+	else if (trigger == "key")
+	{
+		g_bootCacheTrigger = BOOTCACHE_TRIGGER_KEYWAIT;
+		g_bootCacheTriggerValue = 0;
+	}
+	else if (trigger.compare(0, 7, "cycles=") == 0)
+	{
+		const unsigned long long cycles = strtoull(trigger.c_str() + 7, &end, 10);
+		if (*end || end == trigger.c_str() + 7 || cycles == 0)
+			return false;
+		g_bootCacheTrigger = BOOTCACHE_TRIGGER_CYCLES;
+		g_bootCacheTriggerValue = cycles;
+	}
+	else
+	{
+		return false;
+	}
+
+	g_strBootCacheTrigger = trigger;
+	return true;
+}
+
+void BootCache_SetDirectory(const std::string& directory)
+{
+	g_strBootCacheDirectory = directory;
+}
+
+//===========================================================================
+
+// FNV-1a
+static uint64_t BootCache_Hash(uint64_t hash, const void* pData, const size_t size)
+{
+	const BYTE* p = (const BYTE*) pData;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= p[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static uint64_t BootCache_HashString(uint64_t hash, const std::string& str)
+{
+	return BootCache_Hash(hash, str.c_str(), str.size() + 1);	// include the terminator, so "ab"+"c" != "a"+"bc"
+}
+
+static bool BootCache_HashFile(uint64_t& hash, const std::string& pathname)
+{
+	FILE* fp = fopen(pathname.c_str(), "rb");
+	if (!fp)
+		return false;
+
+	std::vector<BYTE> buffer(64 * 1024);
+	size_t size;
+	while ((size = fread(&buffer[0], 1, buffer.size(), fp)) > 0)
+		hash = BootCache_Hash(hash, &buffer[0], size);
+
+	fclose(fp);
+	hash = BootCache_HashString(hash, pathname);
+	return true;
+}
+
+static bool BootCache_HashImages(uint64_t& hash)
+{
+	UINT numImages = 0;
+
+	for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
+	{
+		const SS_CARDTYPE type = GetCardMgr().QuerySlot(slot);
+
+		for (int drive = DRIVE_1; drive < NUM_DRIVES; drive++)
+		{
+			std::string pathname;
+			if (type == CT_Disk2)
+				pathname = dynamic_cast<Disk2InterfaceCard&>(GetCardMgr().GetRef(slot)).DiskGetFullPathName(drive);
+			else if (type == CT_GenericHDD)
+				pathname = dynamic_cast<HarddiskInterfaceCard&>(GetCardMgr().GetRef(slot)).HarddiskGetFullPathName(drive);
+
+			if (pathname.empty())
+				continue;
+
+			hash = BootCache_Hash(hash, &slot, sizeof(slot));
+			hash = BootCache_Hash(hash, &drive, sizeof(drive));
+			if (!BootCache_HashFile(hash, pathname))
+				return false;
+			numImages++;
+		}
+	}
+
+	return numImages > 0;
+}
+
+static void BootCache_HashConfig(uint64_t& hash)
+{
+	const CConfigNeedingRestart config = CConfigNeedingRestart::Create();
+
+	hash = BootCache_Hash(hash, &config.m_Apple2Type, sizeof(config.m_Apple2Type));
+	hash = BootCache_Hash(hash, &config.m_CpuType, sizeof(config.m_CpuType));
+	hash = BootCache_Hash(hash, &config.m_Slot[0], sizeof(config.m_Slot));
+	hash = BootCache_Hash(hash, &config.m_SlotAux, sizeof(config.m_SlotAux));
+	hash = BootCache_HashString(hash, config.m_tfeInterface);
+	hash = BootCache_Hash(hash, &config.m_tfeVirtualDNS, sizeof(config.m_tfeVirtualDNS));
+	hash = BootCache_Hash(hash, &config.m_bEnableTheFreezesF8Rom, sizeof(config.m_bEnableTheFreezesF8Rom));
+	hash = BootCache_Hash(hash, &config.m_videoRefreshRate, sizeof(config.m_videoRefreshRate));
+}
+
+//===========================================================================
+
+// Save or load the cache file, without changing the user's save-state filename
+static void BootCache_Snapshot(const bool bSave)
+{
+	const std::string strSaveStatePathname = Snapshot_GetPathname();
+
+	Snapshot_SetFilename(g_strBootCachePathname);
+	if (bSave)
+		Snapshot_SaveState();
+	else
+		Snapshot_LoadState();
+
+	Snapshot_SetFilename(strSaveStatePathname);
+}
+
+// Call after power-on, once the images have been inserted
+// Returns true if the cached state was restored
+bool BootCache_Startup(void)
+{
+	g_bBootCachePending = false;
+
+	if (g_strBootCacheDirectory.empty() || g_bootCacheTrigger == BOOTCACHE_TRIGGER_NONE)
+		return false;
+
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	if (!BootCache_HashImages(hash))
+	{
+		LogFileOutput("BootCache: no disk images to cache\n");
+		return false;
+	}
+	BootCache_HashConfig(hash);
+	hash = BootCache_HashString(hash, g_strBootCacheTrigger);
+
+	g_strBootCachePathname = g_strBootCacheDirectory;
+	if (*g_strBootCachePathname.rbegin() != PATH_SEPARATOR)
+		g_strBootCachePathname += PATH_SEPARATOR;
+	g_strBootCachePathname += StrFormat("boot-%016llx.yaml", (unsigned long long)hash);
+
+	if (GetFileAttributes(g_strBootCachePathname.c_str()) != INVALID_FILE_ATTRIBUTES)
+	{
+		LogFileOutput("BootCache: restoring %s\n", g_strBootCachePathname.c_str());
+		BootCache_Snapshot(false);
+		return true;
+	}
+
+	LogFileOutput("BootCache: miss, will save to %s (trigger: %s)\n", g_strBootCachePathname.c_str(), g_strBootCacheTrigger.c_str());
+	g_bBootCachePending = true;
+	g_uBootCacheStartCycle = g_nCumulativeCycles;
+	g_uBootCacheKeybReadCount = KeybGetReadCount();
+	return false;
+}
+
+bool BootCache_IsPending(void)
+{
+	return g_bBootCachePending;
+}
+
+// Use instead of CpuExecute() while pending
+// . for the PC trigger, execute one opcode at a time so that the state is saved exactly at the trigger PC
+uint32_t BootCache_Execute(const uint32_t uCycles, const bool bVideoUpdate)
+{
+	if (g_bootCacheTrigger != BOOTCACHE_TRIGGER_PC)
+		return CpuExecute(uCycles, bVideoUpdate);
+
+	uint32_t uExecutedCycles = 0;
+	do
+	{
+		uExecutedCycles += CpuExecute(0, bVideoUpdate);	// 0 = single opcode
+	}
+	while (uExecutedCycles < uCycles && regs.pc != g_bootCacheTriggerValue);
+
+	return uExecutedCycles;
+}
+
+// Call after each BootCache_Execute(), once the cards have been updated
+void BootCache_Update(void)
+{
+	if (!g_bBootCachePending)
+		return;
+
+	bool bTriggered = false;
+	switch (g_bootCacheTrigger)
+	{
+	case BOOTCACHE_TRIGGER_PC:		bTriggered = (regs.pc == g_bootCacheTriggerValue); break;
+	case BOOTCACHE_TRIGGER_KEYWAIT:	bTriggered = (KeybGetReadCount() - g_uBootCacheKeybReadCount >= BOOTCACHE_KEYWAIT_POLLS); break;
+	case BOOTCACHE_TRIGGER_CYCLES:	bTriggered = (g_nCumulativeCycles - g_uBootCacheStartCycle >= g_bootCacheTriggerValue); break;
+	default: break;
+	}
+
+	if (!bTriggered)
+		return;
+
+	g_bBootCachePending = false;
+
+	LogFileOutput("BootCache: saving %s after %llu cycles\n", g_strBootCachePathname.c_str(), (unsigned long long)(g_nCumulativeCycles - g_uBootCacheStartCycle));
+	BootCache_Snapshot(true);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// Boot cache: a save-state taken once a disk image has booted, so that later runs can skip the boot
+
+enum BootCacheTrigger_e
+{
+	BOOTCACHE_TRIGGER_NONE,
+	BOOTCACHE_TRIGGER_PC,		// PC reached an address
+	BOOTCACHE_TRIGGER_KEYWAIT,	// program is polling the keyboard
+	BOOTCACHE_TRIGGER_CYCLES,	// number of cycles since power-on
+};
+
+bool BootCache_SetTrigger(const std::string& trigger);	// "pc=<hex addr>", "key" or "cycles=<n>"
+void BootCache_SetDirectory(const std::string& directory);
+bool BootCache_Startup(void);
+bool BootCache_IsPending(void);
+uint32_t BootCache_Execute(const uint32_t uCycles, const bool bVideoUpdate);
+void BootCache_Update(void);
@@ -136,6 +136,7 @@ static volatile BOOL g_bNmiFlank = FALSE; // Positive going flank on NMI line
 
 static bool g_irqDefer1Opcode = false;
 static bool g_interruptInLastExecutionBatch = false;	// Last batch of executed cycles included an interrupt (IRQ/NMI)
+static uint32_t g_uDebugRunCycles = 0;				// MODE_STEPPING: next CpuExecute() runs this many cycles on the regular (non-debug) core
 
 // NB. No need to save to save-state, as IRQ() follows CheckSynchronousInterruptSources(), and IRQ() always sets it to false.
 static bool g_irqOnLastOpcodeCycle = false;
@@ -205,6 +206,14 @@ bool IsInterruptInLastExecution(void)
 	return g_interruptInLastExecutionBatch;
 }
 
+// Called by the debugger when the only active breakpoints are memory write traps (see MemWriteTrap()):
+// . the next single-step instead runs a batch of opcodes at full emulation speed
+// . the batch ends early once an opcode writes to a watched byte
+void CpuSetDebugRunCycles(const uint32_t uCycles)
+{
+	g_uDebugRunCycles = uCycles;
+}
+
 void SetIrqOnLastOpcodeCycle(void)
 {
 	if (!(regs.ps & AF_INTERRUPT))
@@ -607,7 +616,7 @@ static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 
 static uint32_t InternalCpuExecute(const uint32_t uTotalCycles, const bool bVideoUpdate)
 {
-	if (g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK)
+	if (g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK || g_uDebugRunCycles)
 	{
 		if (!GetIsMemCacheValid())
 		{
@@ -735,10 +744,14 @@ uint32_t CpuExecute(const uint32_t uCycles, const bool bVideoUpdate)
 	// uCycles:
 	//  =0  : Do single step
 	//  >0  : Do multi-opcode emulation
-	const uint32_t uExecutedCycles = InternalCpuExecute(uCycles, bVideoUpdate);
+	const uint32_t uExecutedCycles = InternalCpuExecute(g_uDebugRunCycles ? g_uDebugRunCycles : uCycles, bVideoUpdate);
+	g_uDebugRunCycles = 0;
+
+	// Between execution batches is the only place where the CPU emulation can switch to/from bank switching by pointer
+	MemUpdateBankSwitchMode(uExecutedCycles);
 
-	// Update 6522s (NB. Do this before updating g_nCumulativeCycles below)
-	// . Ensures that 6522 regs are up-to-date for any potential save-state
+	// Update Mockingboards' cycle count (NB. Do this before updating g_nCumulativeCycles below)
+	// . 6522 TIMER1/2 counters are computed on demand (eg. for any potential save-state), so there's no per-period 6522 work
 	// . SyncEvent will trigger the 6522 TIMER1/2 underflow on the correct cycle
 	GetCardMgr().GetMockingboardCardMgr().UpdateCycles(uExecutedCycles);
 
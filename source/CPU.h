@@ -61,4 +61,5 @@ bool IsIrqAsserted(void);
 bool Is6502InterruptEnabled(void);
 void ResetCyclesExecutedForDebugger(void);
 bool IsInterruptInLastExecution(void);
+void CpuSetDebugRunCycles(const uint32_t uCycles);
 void SetIrqOnLastOpcodeCycle(void);
@@ -386,7 +386,7 @@ static uint32_t Cpu6502(uint32_t uTotalCycles, const bool bVideoUpdate)
 		}
 // NTSC_END
 
-	} while (uExecutedCycles < uTotalCycles);
+	} while (uExecutedCycles < uTotalCycles && !g_memWriteTrapHit);	// Stop after an opcode writes to a debugger watchpoint
 
 	EF_TO_AF
 
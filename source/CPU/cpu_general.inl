@@ -101,6 +101,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 					*(page+(addr & 0xFF)) = (BYTE)(a);									\
 				else if ((addr & 0xF000) == APPLE_IO_BEGIN)								\
 					IOWrite[(addr>>4) & 0xFF](regs.pc,addr,1,(BYTE)(a),uExecutedCycles);\
+				else if (memwriteTrap[addr >> 8])							/* watchpoint */\
+					MemWriteTrap(addr,(BYTE)(a),uExecutedCycles);						\
 			}																			\
 		}
 #define _WRITE_ALT(a) {																	\
@@ -114,6 +116,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 				}																		\
 				else if ((addr & 0xF000) == APPLE_IO_BEGIN)								\
 					IOWrite[(addr>>4) & 0xFF](regs.pc,addr,1,(BYTE)(a),uExecutedCycles);\
+				else if (memwriteTrap[addr >> 8])							/* watchpoint */\
+					MemWriteTrap(addr,(BYTE)(a),uExecutedCycles);						\
 			}																			\
 		}
 #define _WRITE_WITH_IO_F8xx(a) {											/* GH#827 */\
@@ -129,6 +133,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 				}																		\
 				else if ((addr & 0xF000) == APPLE_IO_BEGIN)								\
 					IOWrite[(addr>>4) & 0xFF](regs.pc,addr,1,(BYTE)(a),uExecutedCycles);\
+				else if (memwriteTrap[addr >> 8])							/* watchpoint */\
+					MemWriteTrap(addr,(BYTE)(a),uExecutedCycles);						\
 			}																			\
 		}
 
@@ -69,7 +69,12 @@ void CardManager::InsertInternal(UINT slot, SS_CARDTYPE type)
 	case CT_MockingboardC:
 	case CT_MegaAudio:
 	case CT_SDMusic:
-		m_slot[slot] = new MockingboardCard(slot, type);
+	case CT_Phasor:
+		{
+			MockingboardCard* pCard = new MockingboardCard(slot, type);
+			m_slot[slot] = pCard;
+			m_mockingboardCardMgr.InsertCard(slot, pCard);
+		}
 		break;
 	case CT_GenericPrinter:
 		_ASSERT(m_pParallelPrinterCard == NULL);
@@ -92,9 +97,6 @@ void CardManager::InsertInternal(UINT slot, SS_CARDTYPE type)
 		if (m_pZ80Card) break;	// Only support one Z80 card
 		m_slot[slot] = m_pZ80Card = new Z80Card(slot);
 		break;
-	case CT_Phasor:
-		m_slot[slot] = new MockingboardCard(slot, type);
-		break;
 	case CT_Echo:
 		m_slot[slot] = new DummyCard(type, slot);
 		break;
@@ -180,6 +182,12 @@ void CardManager::RemoveInternal(UINT slot)
 		case CT_Z80:
 			m_pZ80Card = NULL;
 			break;
+		case CT_MockingboardC:
+		case CT_MegaAudio:
+		case CT_SDMusic:
+		case CT_Phasor:
+			m_mockingboardCardMgr.RemoveCard(slot);
+			break;
 		}
 
 		UnregisterIoHandler(slot);
@@ -92,6 +92,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static std::string g_sBreakMemoryFullPrefixAddr;
 	static int g_breakpointHitID = -1;
 
+	// G with only memory write breakpoints: run on the regular CPU core, with Memory.cpp trapping writes to the watched pages
+	static bool g_bDebugWriteTrapRun = false;
+	static MemWriteTrapHit_t g_DebugWriteTrapHit;	// last write trap hit (for 'stop reason')
+
 	int          g_nBreakpoints = 0;
 	Breakpoint_t g_aBreakpoints[ MAX_BREAKPOINTS ];
 
@@ -290,16 +294,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	bool  g_bSourceAddSymbols     = false;
 	bool  g_bSourceAddMemory      = false;
 
-	std::string g_aSourceFileName;
-
-	MemoryTextFile_t g_AssemblerSourceBuffer;
-
-	int    g_iSourceDisplayStart  = 0;
-	int    g_nSourceAssembleBytes = 0;
-	int    g_nSourceAssemblySymbols = 0;
+	// TS & PS: run until the next source line
+	enum SourceStep_e
+	{
+		  SOURCE_STEP_NONE
+		, SOURCE_STEP_INTO
+		, SOURCE_STEP_OVER // JSR
+	};
 
-	// TODO: Support multiple source filenames
-	SourceAssembly_t g_aSourceDebug;
+	SourceStep_e     g_eSourceStep         = SOURCE_STEP_NONE;
+	SourceInfoLine_t g_SourceStepLine      = { -1, 0 }; // started on
+	int              g_nSourceStepReturn   = -1;        // JSR being stepped over: PC & SP after its RTS
+	WORD             g_nSourceStepReturnSP = 0;
 
 
 
@@ -399,9 +405,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static	void _CmdColorGet ( const int iScheme, const int iColor );
 
 // Source Level Debugging
-	static	bool BufferAssemblyListing ( const std::string & pFileName );
-	static	bool ParseAssemblyListing ( bool bBytesToMemory, bool bAddSymbols );
-
+	static	void SourceStepBefore ();
+	static	bool SourceStepIsDone ();
 
 // Window
 	void _WindowJoin ();
@@ -765,6 +770,18 @@ Update_t CmdBookmarkSave (int nArgs)
 //===========================================================================
 Update_t CmdBenchmark (int nArgs)
 {
+	// BENCHMARK SYM [#]
+	if (nArgs)
+	{
+		int iParam;
+		bool bFound = FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_SOURCE_BEGIN, _PARAM_SOURCE_END ) > 0 ? true : false;
+		if (!bFound || (iParam != PARAM_SRC_SYMBOLS) || (nArgs > 2))
+			return Help_Arg_1( CMD_BENCHMARK );
+
+		const int nSymbols = (nArgs == 2) ? g_aArgs[ 2 ].nValue : 50000;
+		return SymbolsBenchmark( nSymbols );
+	}
+
 	if (g_bBenchmarking)
 		CmdBenchmarkStart(0);
 	else
@@ -1095,6 +1112,9 @@ bool GetBreakpointInfo ( WORD nOffset, bool & bBreakpointActive_, bool & bBreakp
 	{
 		Breakpoint_t *pBP = &g_aBreakpoints[ iBreakpoint ];
 		
+		if (pBP->bCondition && (pBP->nLength >= _6502_MEM_LEN)) // BPIF/BPT aren't tied to an address
+			continue;
+
 		if ((pBP->nLength)
 //			 && (pBP->bEnabled) // not bSet
 			 && (nOffset >= pBP->nAddress) && (nOffset < (pBP->nAddress + pBP->nLength))) // [nAddress,nAddress+nLength]
@@ -1115,19 +1135,45 @@ bool GetBreakpointInfo ( WORD nOffset, bool & bBreakpointActive_, bool & bBreakp
 	return false;
 }
 
+// Tracepoint: log the hit to the console without stopping
+static void LogBreakpointHit(const Breakpoint_t * pBP, int iBreakpoint)
+{
+	ConsolePrintFormat( CHC_INFO "Trace #%X" CHC_DEFAULT " %08X "
+		CHC_REGS "PC" CHC_ARG_SEP ":" CHC_ADDRESS "%04X "
+		CHC_REGS "A"  CHC_ARG_SEP ":" CHC_NUM_HEX "%02X "
+		CHC_REGS "X"  CHC_ARG_SEP ":" CHC_NUM_HEX "%02X "
+		CHC_REGS "Y"  CHC_ARG_SEP ":" CHC_NUM_HEX "%02X "
+		CHC_REGS "S"  CHC_ARG_SEP ":" CHC_NUM_HEX "%04X "
+		CHC_REGS "P"  CHC_ARG_SEP ":" CHC_NUM_HEX "%02X "
+		CHC_DEFAULT "Cycles" CHC_ARG_SEP ":" CHC_NUM_DEC "%llu"
+		, iBreakpoint
+		, pBP->nHitCount
+		, regs.pc, regs.a, regs.x, regs.y, regs.sp, regs.ps
+		, (unsigned long long) g_nCumulativeCycles
+	);
+}
+
 // returns the hit type if the breakpoint stops
 static BreakpointHit_t HitBreakpoint(Breakpoint_t * pBP, BreakpointHit_t eHitType, int iBreakpoint)
 {
-	if (pBP->bStop && g_breakpointHitID < 0)
+	if (pBP->bCondition && !BreakpointConditionEval(g_aBreakpointConditions[iBreakpoint]))
+		return BP_HIT_NONE;
+
+	pBP->bHit = true;
+	++pBP->nHitCount;
+
+	if (pBP->bLog)
+		LogBreakpointHit(pBP, iBreakpoint);
+
+	const bool bStop = pBP->bStop && (pBP->nHitCount >= pBP->nHitTarget);
+	if (bStop && g_breakpointHitID < 0)
 	{
 		g_breakpointHitID = iBreakpoint;
 		_ASSERT(g_pDebugBreakpointHit == nullptr);
 		g_pDebugBreakpointHit = pBP;
 	}
 
-	pBP->bHit = true;
-	++pBP->nHitCount;
-	return pBP->bStop ? eHitType : BP_HIT_NONE;
+	return bStop ? eHitType : BP_HIT_NONE;
 }
 
 
@@ -1166,6 +1212,47 @@ void ClearTempBreakpoints ()
 	}
 }
 
+// PC breakpoints for remote control (debug server), same as "bpx nAddress"
+//===========================================================================
+bool DebugSetBreakpointPC ( WORD nAddress )
+{
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+
+		if (pBP->bSet)
+			continue;
+
+		pBP->Clear();
+		_CmdBreakpointAddReg( pBP, BP_SRC_REG_PC, BP_OP_EQUAL, nAddress, 1, false );
+		g_nBreakpoints++;
+		return true;
+	}
+
+	return false;	// All Breakpoint slots are currently in use
+}
+
+// @return true if there was a PC breakpoint at nAddress
+//===========================================================================
+bool DebugClearBreakpointPC ( WORD nAddress )
+{
+	bool bFound = false;
+
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+
+		if (pBP->bSet && (pBP->eSource == BP_SRC_REG_PC) && (pBP->eOperator == BP_OP_EQUAL) && (pBP->nAddress == nAddress))
+		{
+			_BWZ_RemoveOne(g_aBreakpoints, iBreakpoint, g_nBreakpoints);
+			bFound = true;
+		}
+	}
+
+	return bFound;
+}
+
+//===========================================================================
 static void DebugEnterStepping()
 {
 	ClearTempBreakpoints();
@@ -1472,6 +1559,116 @@ int CheckBreakpointsIO ()
 	return iBreakpointHit;
 }
 
+// Can all active breakpoints be checked by Memory.cpp's write traps, instead of after every single-step?
+//===========================================================================
+static bool _BreakpointsCanUseWriteTraps ()
+{
+	if (g_nDebugStepUntil != -1 || g_nDebugSkipLen > 0 || g_hTraceFile)
+		return false;
+
+	if (g_nDebugBreakOnInvalid || g_iDebugBreakOnOpcode || g_bDebugBreakOnInterrupt)
+		return false;
+
+	int nTraps = 0;
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+		if (! _BreakpointValid( pBP ))
+			continue;
+
+		if (pBP->eSource != BP_SRC_MEM_WRITE_ONLY || pBP->eOperator != BP_OP_EQUAL)
+			return false;
+
+		if (! MemCanWriteTrap( pBP->nAddress, pBP->nLength ))	// eg. stack page or I/O
+			return false;
+
+		nTraps++;
+	}
+
+	return nTraps > 0;
+}
+
+//===========================================================================
+static void _BreakpointsStartWriteTraps ()
+{
+	MemWriteTrapClear();
+
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+		if (_BreakpointValid( pBP ))
+			MemWriteTrapAdd( pBP->nAddress, pBP->nLength );
+	}
+
+	g_bDebugWriteTrapRun = true;
+}
+
+//===========================================================================
+static void _BreakpointsStopWriteTraps ()
+{
+	if (! g_bDebugWriteTrapRun)
+		return;
+
+	MemWriteTrapClear();
+	g_bDebugWriteTrapRun = false;
+}
+
+// The write trap records the PC after the opcode's operands were fetched, so search back for the opcode that targets the address
+//===========================================================================
+static WORD _GetWriteTrapOpcodeAddress ( const MemWriteTrapHit_t & hit )
+{
+	for (int nOpcodeBytes = 3; nOpcodeBytes >= 2; nOpcodeBytes--)
+	{
+		const WORD nAddress = hit.pc - nOpcodeBytes;
+		const BYTE nOpcode = ReadByteFromMemory( nAddress );
+		if (g_aOpmodes[ g_aOpcodes[ nOpcode ].nAddressMode ].m_nBytes != nOpcodeBytes)
+			continue;
+		if (! (g_aOpcodes[ nOpcode ].nMemoryAccess & (MEM_WI|MEM_W)))
+			continue;
+
+		int aTarget[ 3 ] = { NO_6502_TARGET, NO_6502_TARGET, NO_6502_TARGET };
+		int nBytes;
+		_6502_GetTargets( nAddress, &aTarget[0], &aTarget[1], &aTarget[2], &nBytes, true, false );
+
+		for (int iTarget = 0; iTarget < 3; iTarget++)
+		{
+			if (aTarget[ iTarget ] == hit.addr)
+				return nAddress;
+		}
+	}
+
+	return hit.pc;
+}
+
+// Only called when g_bDebugWriteTrapRun
+//===========================================================================
+static int CheckBreakpointsWriteTrap ()
+{
+	int iBreakpointHit = 0;
+
+	if (! MemWriteTrapGetHit( g_DebugWriteTrapHit ))
+		return 0;
+
+	const WORD nAddress = g_DebugWriteTrapHit.addr;
+
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+		if (! _BreakpointValid( pBP ) || pBP->eSource != BP_SRC_MEM_WRITE_ONLY)
+			continue;
+
+		if (_CheckBreakpointValue( pBP, nAddress ))
+		{
+			g_nBreakMemoryAddr = nAddress;	// last BP hit
+			g_sBreakMemoryFullPrefixAddr = GetFullPrefixAddrForBreakpoint(pBP->addrPrefix, nAddress, DEVICE_e::DEV_MEMORY, false);	// string is last BP hit
+			iBreakpointHit |= HitBreakpoint(pBP, BP_HIT_MEMW, iBreakpoint);
+			// Don't break - instead process all BPs so that all pBP->nHitCount's are correct
+		}
+	}
+
+	return iBreakpointHit;
+}
+
 // Returns true if a register breakpoint is triggered
 //===========================================================================
 int CheckBreakpointsReg ()
@@ -1521,6 +1718,21 @@ int CheckBreakpointsReg ()
 	return iAnyBreakpointHit;
 }
 
+// Any enabled PC breakpoint at nAddress: doesn't update the hit counts (unlike CheckBreakpointsReg())
+//===========================================================================
+bool DebugCheckBreakpointPC ( WORD nAddress )
+{
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+
+		if (_BreakpointValid( pBP ) && (pBP->eSource == BP_SRC_REG_PC) && _CheckBreakpointValue( pBP, nAddress ))
+			return true;
+	}
+
+	return false;
+}
+
 // Returns true if a video breakpoint is triggered
 //===========================================================================
 int CheckBreakpointsVideo ()
@@ -2029,6 +2241,8 @@ Update_t CmdBreakpointChange (int nArgs)
 				case PARAM_BP_CHANGE_TEMP_OFF: bp.bTemp    = false; break;
 				case PARAM_BP_CHANGE_STOP_ON : bp.bStop    = true ; break;
 				case PARAM_BP_CHANGE_STOP_OFF: bp.bStop    = false; break;
+				case PARAM_BP_CHANGE_LOG_ON  : bp.bLog     = true ; break;
+				case PARAM_BP_CHANGE_LOG_OFF : bp.bLog     = false; break;
 			}
 		}
 	}
@@ -2036,6 +2250,136 @@ Update_t CmdBreakpointChange (int nArgs)
 	return UPDATE_BREAKPOINTS;
 }
 
+// Expression commands are not cooked, so the slot # isn't in g_aArgs[1].nValue
+//===========================================================================
+static int _BreakpointSlotFromArg ( const Arg_t & arg )
+{
+	char *pEnd = NULL;
+	const int iSlot = (int) strtol( arg.sArg, &pEnd, 16 );
+	if ((pEnd == arg.sArg) || *pEnd || (iSlot < 0) || (iSlot >= MAX_BREAKPOINTS) || !g_aBreakpoints[ iSlot ].bSet)
+		return -1;
+	return iSlot;
+}
+
+// Returns the raw console input after the command and nSkipArgs args
+//===========================================================================
+static const char * _BreakpointExpressionText ( int nSkipArgs )
+{
+	const char *pText = g_pConsoleFirstArg;
+	if (! pText)
+		return "";
+
+	while (nSkipArgs--)
+	{
+		pText = SkipWhiteSpace( pText );
+		while (*pText && (*pText != CHAR_SPACE) && (*pText != CHAR_TAB))
+			pText++;
+	}
+
+	return SkipWhiteSpace( pText );
+}
+
+// bpif <expression>
+// bpt  <expression>
+//===========================================================================
+static Update_t _CmdBreakpointAddExpression ( int nArgs, const int iCommand, const bool bStop )
+{
+	if (! nArgs)
+		return Help_Arg_1( iCommand );
+
+	BreakpointCondition_t condition;
+	std::string sError;
+	if (! BreakpointConditionCompile( _BreakpointExpressionText( 0 ), condition, sError ))
+		return ConsoleDisplayErrorFormat( "Error: %s", sError.c_str() );
+
+	int iBreakpoint = 0;
+	while ((iBreakpoint < MAX_BREAKPOINTS) && g_aBreakpoints[ iBreakpoint ].bSet)
+		iBreakpoint++;
+
+	if (iBreakpoint >= MAX_BREAKPOINTS)
+		return ConsoleDisplayError( "All Breakpoint slots are currently in use." );
+
+	// Checked every instruction: PC in [0000,FFFF] && <expression>
+	Breakpoint_t *pBP = &g_aBreakpoints[ iBreakpoint ];
+	pBP->Clear();
+	_CmdBreakpointAddReg( pBP, BP_SRC_REG_PC, BP_OP_EQUAL, 0, _6502_MEM_LEN, false );
+	pBP->bStop      = bStop;
+	pBP->bLog       = !bStop;
+	pBP->bCondition = true;
+	g_aBreakpointConditions[ iBreakpoint ] = condition;
+	g_nBreakpoints++;
+
+	return UPDATE_BREAKPOINTS | UPDATE_CONSOLE_DISPLAY;
+}
+
+//===========================================================================
+Update_t CmdBreakpointAddCond (int nArgs)
+{
+	return _CmdBreakpointAddExpression( nArgs, CMD_BREAKPOINT_ADD_COND, true );
+}
+
+//===========================================================================
+Update_t CmdBreakpointAddTrace (int nArgs)
+{
+	return _CmdBreakpointAddExpression( nArgs, CMD_BREAKPOINT_ADD_TRACE, false );
+}
+
+// bpcond # [expression]
+//===========================================================================
+Update_t CmdBreakpointCondition (int nArgs)
+{
+	if (! g_nBreakpoints)
+		return _BP_InfoNone();
+
+	if (! nArgs)
+		return Help_Arg_1( CMD_BREAKPOINT_CONDITION );
+
+	const int iSlot = _BreakpointSlotFromArg( g_aArgs[1] );
+	if (iSlot < 0)
+		return Help_Arg_1( CMD_BREAKPOINT_CONDITION );
+
+	Breakpoint_t & bp = g_aBreakpoints[ iSlot ];
+
+	if (nArgs == 1)
+	{
+		if (bp.nLength >= _6502_MEM_LEN)
+			return ConsoleDisplayError( "Breakpoint has no address: use BPC to remove it." );
+
+		bp.bCondition = false;
+		g_aBreakpointConditions[ iSlot ].Clear();
+		return UPDATE_BREAKPOINTS;
+	}
+
+	std::string sError;
+	if (! BreakpointConditionCompile( _BreakpointExpressionText( 1 ), g_aBreakpointConditions[ iSlot ], sError ))
+		return ConsoleDisplayErrorFormat( "Error: %s", sError.c_str() );
+
+	bp.bCondition = true;
+	return UPDATE_BREAKPOINTS;
+}
+
+// bphit # <count>
+//===========================================================================
+Update_t CmdBreakpointHitCount (int nArgs)
+{
+	if (! g_nBreakpoints)
+		return _BP_InfoNone();
+
+	if (nArgs != 2)
+		return Help_Arg_1( CMD_BREAKPOINT_HIT_COUNT );
+
+	const int iSlot = _BreakpointSlotFromArg( g_aArgs[1] );
+	if (iSlot < 0)
+		return Help_Arg_1( CMD_BREAKPOINT_HIT_COUNT );
+
+	WORD nHitTarget = 0;
+	if (! ArgsGetValue( &g_aArgs[2], &nHitTarget ))
+		return Help_Arg_1( CMD_BREAKPOINT_HIT_COUNT );
+
+	g_aBreakpoints[ iSlot ].nHitTarget = nHitTarget;
+	return UPDATE_BREAKPOINTS;
+}
+
 // called by BreakpointsClear, WatchesClear, ZeroPagePointersClear
 //===========================================================================
 void _BWZ_ClearViaArgs ( int nArgs, Breakpoint_t * aBreakWatchZero, const int nMax, int & nTotal )
@@ -2231,6 +2575,20 @@ void _BWZ_List ( const Breakpoint_t * aBreakWatchZero, const int iBWZ ) //, bool
 		aMemAccess[ iBPM ],
 		sSymbol.c_str()
 	);
+
+	const Breakpoint_t & bp = aBreakWatchZero[ iBWZ ];
+	if (bp.bCondition || bp.bLog || bp.nHitTarget)
+	{
+		std::string sExtra;
+		if (bp.bLog)
+			sExtra += CHC_INFO "Log ";
+		if (bp.nHitTarget)
+			sExtra += StrFormat( CHC_DEFAULT "Hit" CHC_ARG_SEP ">=" CHC_NUM_HEX "%X ", bp.nHitTarget );
+		if (bp.bCondition)
+			sExtra += StrFormat( CHC_DEFAULT "If" CHC_ARG_SEP ": " CHC_DEFAULT "%s", g_aBreakpointConditions[ iBWZ ].sExpression.c_str() );
+
+		ConsolePrintFormat( "       %s", sExtra.c_str() );
+	}
 }
 
 void _BWZ_ListAll ( const Breakpoint_t * aBreakWatchZero, const int nMax )
@@ -2310,26 +2668,84 @@ Update_t CmdBreakpointSave (int nArgs)
 
 	ConfigSave_PrepareHeader( PARAM_CAT_BREAKPOINTS, CMD_BREAKPOINT_CLEAR );
 
+	// Reloading clears all breakpoints and adds these to the first free slots, in order:
+	// so BPCOND, BPHIT and BPD refer to the slot a breakpoint will get, not the one it has now
+	int iReload = 0;
+
 	int iBreakpoint = 0;
 	while (iBreakpoint < MAX_BREAKPOINTS)
 	{
-		if (g_aBreakpoints[ iBreakpoint ].bSet)
+		const Breakpoint_t & bp = g_aBreakpoints[ iBreakpoint ];
+		if (! bp.bSet)
+		{
+			iBreakpoint++;
+			continue;
+		}
+
+		if (bp.bCondition && (bp.nLength >= _6502_MEM_LEN))
 		{
-			g_ConfigState.PushLineFormat( "%s %x %04X,%04X\n"
-				, g_aCommands[ CMD_BREAKPOINT_ADD_REG ].m_sName
-				, iBreakpoint
-				, g_aBreakpoints[ iBreakpoint ].nAddress
-				, g_aBreakpoints[ iBreakpoint ].nLength
+			g_ConfigState.PushLineFormat( "%s %s\n"
+				, g_aCommands[ bp.bStop ? CMD_BREAKPOINT_ADD_COND : CMD_BREAKPOINT_ADD_TRACE ].m_sName
+				, g_aBreakpointConditions[ iBreakpoint ].sExpression.c_str()
+			);
+		}
+		else
+		{
+			// One line per breakpoint, so that each one gets exactly one slot
+			switch (bp.eSource)
+			{
+				case BP_SRC_MEM_RW        :
+				case BP_SRC_MEM_READ_ONLY :
+				case BP_SRC_MEM_WRITE_ONLY:
+					g_ConfigState.PushLineFormat( "%s %04X,%04X\n"
+						, g_aCommands[ (bp.eSource == BP_SRC_MEM_RW) ? CMD_BREAKPOINT_ADD_MEM
+							: (bp.eSource == BP_SRC_MEM_READ_ONLY) ? CMD_BREAKPOINT_ADD_MEMR : CMD_BREAKPOINT_ADD_MEMW ].m_sName
+						, bp.nAddress
+						, bp.nLength
+					);
+					break;
+				case BP_SRC_VIDEO_SCANNER:
+					g_ConfigState.PushLineFormat( "%s %X\n"
+						, g_aCommands[ CMD_BREAKPOINT_ADD_VIDEO ].m_sName
+						, bp.nAddress
+					);
+					break;
+				default:
+					g_ConfigState.PushLineFormat( "%s %s %s %04X,%04X\n"
+						, g_aCommands[ CMD_BREAKPOINT_ADD_REG ].m_sName
+						, g_aBreakpointSource[ bp.eSource ]
+						, g_aBreakpointSymbols[ bp.eOperator ]
+						, bp.nAddress
+						, bp.nLength
+					);
+					break;
+			}
+			if (bp.bCondition)
+			{
+				g_ConfigState.PushLineFormat( "%s %x %s\n"
+					, g_aCommands[ CMD_BREAKPOINT_CONDITION ].m_sName
+					, iReload
+					, g_aBreakpointConditions[ iBreakpoint ].sExpression.c_str()
+				);
+			}
+		}
+		if (bp.nHitTarget)
+		{
+			g_ConfigState.PushLineFormat( "%s %x %X\n"
+				, g_aCommands[ CMD_BREAKPOINT_HIT_COUNT ].m_sName
+				, iReload
+				, bp.nHitTarget
 			);
 		}
 		if (! g_aBreakpoints[ iBreakpoint ].bEnabled)
 		{
 			g_ConfigState.PushLineFormat( "%s %x\n"
 				, g_aCommands[ CMD_BREAKPOINT_DISABLE ].m_sName
-				, iBreakpoint
+				, iReload
 			);
 		}
 		
+		iReload++;
 		iBreakpoint++;
 	}
 
@@ -2440,6 +2856,59 @@ Update_t CmdAssemble (int nArgs)
 	return UPDATE_CONSOLE_DISPLAY;
 }
 
+//===========================================================================
+Update_t CmdAssembleSource (int nArgs)
+{
+	if (nArgs != 1)
+		return Help_Arg_1( CMD_ASSEMBLE_SOURCE );
+
+	const std::string pFileName = g_aArgs[ 1 ].sArg;
+	std::string sFileName;
+
+	if (pFileName[0] == PATH_SEPARATOR || pFileName[1] == ':')	// NB. Any prefix quote has already been stripped
+		sFileName = pFileName;
+	else
+		sFileName = g_sCurrentDir + pFileName;
+
+	SourceAsmResult_t result;
+	if (! SourceAssembleFile( sFileName, result ))
+	{
+		for (const std::string & sError : result.aErrors)
+			ConsolePrintFormat( "%s%s", CHC_ERROR, sError.c_str() );
+		return ConsoleUpdate();
+	}
+
+	SourceAssemblerWriteMemory( result );
+	const int nSymbols = SourceAssemblerAddSymbols( result, SYMBOLS_SRC_1 );
+
+	g_SourceInfo.LoadAssembly( result ); // TS & PS step by line
+	g_bSourceLevelDebugging = true;
+
+	ConsolePrintFormat( "%sAssembled: %s%d%s lines, %s%d%s bytes, %s%d%s symbols"
+		, CHC_INFO
+		, CHC_NUM_DEC, result.nSourceLines, CHC_DEFAULT
+		, CHC_NUM_DEC, result.nBytes      , CHC_DEFAULT
+		, CHC_NUM_DEC, nSymbols           , CHC_DEFAULT
+	);
+	for (const SourceAsmSegment_t & segment : result.aSegments)
+	{
+		ConsolePrintFormat( "  %s%04X%s:%s%04X"
+			, CHC_ADDRESS, segment.nAddress, CHC_DEFAULT
+			, CHC_ADDRESS, (UINT)(segment.nAddress + segment.aBytes.size() - 1)
+		);
+	}
+
+	if (result.nStartAddress >= 0)
+	{
+		// move disassembler to the code
+		g_nDisasmCurAddress = (WORD) result.nStartAddress;
+		WindowUpdateDisasmSize(); // calc cur line
+		DisasmCalcTopBotAddress();
+	}
+
+	return ConsoleUpdate() | UPDATE_ALL;
+}
+
 // CPU ____________________________________________________________________________________________
 // CPU Step, Trace ________________________________________________________________________________
 
@@ -2535,6 +3004,11 @@ static Update_t CmdGo (int nArgs, const bool bFullSpeed)
 
 	DebugEnterStepping();
 
+	if (_BreakpointsCanUseWriteTraps())
+		_BreakpointsStartWriteTraps();
+	else
+		_BreakpointsStopWriteTraps();
+
 	SoundCore_SetFade(FADE_IN);
 
 	return UPDATE_CONSOLE_DISPLAY;
@@ -6790,213 +7264,13 @@ Update_t CmdOutputRun (int nArgs)
 
 // Source Level Debugging _________________________________________________________________________
 
-//===========================================================================
-bool BufferAssemblyListing ( const std::string & pFileName )
-{
-	bool bStatus = false; // true = loaded
-
-	if (pFileName.empty())
-		return bStatus;
-
-	g_AssemblerSourceBuffer.Reset();
-	g_AssemblerSourceBuffer.Read( pFileName );
-
-	if (g_AssemblerSourceBuffer.GetNumLines())
-	{
-		g_bSourceLevelDebugging = true;
-		bStatus = true;
-	}
-
-	return bStatus;
-}
-
-
-//===========================================================================
-int FindSourceLine ( WORD nAddress )
-{
-	int iAddress = 0;
-	int iLine = 0;
-	int iSourceLine = NO_SOURCE_LINE;
-
-//	iterate of <address,line>
-//	probably should be sorted by address
-//	then can do binary search
-//	iSourceLine = g_aSourceDebug.find( nAddress );
-#if 0 // _DEBUG
-	{
-		for (int i = 0; i < g_vSourceLines.size(); i++ )
-		{
-			LogOutput( "%d: %s\n", i, g_vSourceLines[ i ] );
-		}
-	}
-#endif
-
-	SourceAssembly_t::iterator iSource = g_aSourceDebug.begin();
-	while (iSource != g_aSourceDebug.end() )
-	{
-		iAddress = iSource->first;
-		iLine = iSource->second;
-
-#if 0 // _DEBUG
-		LogOutput( "%04X -> %d line\n", iAddress, iLine );
-#endif
-
-		if (iAddress == nAddress)
-		{
-			iSourceLine = iLine;
-			break;
-		}
-
-		iSource++;
-	}
-	// not found
-
-	return iSourceLine;
-}
-
-//===========================================================================
-bool ParseAssemblyListing ( bool bBytesToMemory, bool bAddSymbols )
-{
-	bool bStatus = false; // true = loaded
-
-	// Assembler source listing file:
-	//
-	// xxxx:_b1_[b2]_[b3]__n_[label]_[opcode]_[param]
-//	char  sByte1[ 2 ];
-//	char  sByte2[ 2 ];
-//	char  sByte3[ 2 ];
-//	char  sLineN[ W ];
-	char sName[ MAX_SYMBOLS_LEN ];
-//	char  sAsm  [ W ];
-//	char  sParam[ W ];
-
-	const int MAX_LINE = 256;
-	char  sLine[ MAX_LINE ];
-	char  sText[ MAX_LINE ];
-//	char  sLabel[ MAX_LINE ];
-
-	g_nSourceAssembleBytes = 0;
-	g_nSourceAssemblySymbols = 0;
-
-	const uint32_t INVALID_ADDRESS = _6502_MEM_END + 1;
-
-	int nLines = g_AssemblerSourceBuffer.GetNumLines();
-	for ( int iLine = 0; iLine < nLines; iLine++ )
-	{
-		g_AssemblerSourceBuffer.GetLine( iLine, sText, MAX_LINE - 1 );
-
-		uint32_t nAddress = INVALID_ADDRESS;
-
-		strcpy( sLine, sText );
-		char *p = sLine;
-		p = strstr( sLine, ":" );
-		if (p)
-		{
-			*p = 0;
-			//	sscanf( sLine, "%s %s %s %s %s %s %s %s", sAddr1, sByte1, sByte2, sByte3, sLineN, sLabel, sAsm, sParam );
-			sscanf( sLine, "%X", &nAddress );
-
-			if (nAddress >= INVALID_ADDRESS) // || (sName[0] == 0) )
-				continue;
-
-			if (bBytesToMemory)
-			{
-				char *pEnd = p + 1;				
-				char *pStart;
-				int  iByte;
-				for (iByte = 0; iByte < 4; iByte++ ) // BUG: Some assemblers also put 4 bytes on a line
-				{
-					// xx xx xx
-					// ^ ^
-					// | |
-					// | end
-					// start
-					pStart = pEnd + 1;
-					pEnd = const_cast<char*>( SkipUntilWhiteSpace( pStart ));
-					int nLen = (int) (pEnd - pStart);
-					if (nLen != 2)
-					{
-						break;
-					}
-					*pEnd = 0;
-					if (TextIsHexByte( pStart ))
-					{
-						BYTE nByte = TextConvert2CharsToByte( pStart );
-						WriteByteToMemory(((WORD)nAddress) + iByte, nByte);
-					}
-				}
-				g_nSourceAssembleBytes += iByte;
-			}
-
-			g_aSourceDebug[ (WORD) nAddress ] = iLine; // g_nSourceAssemblyLines;
-		}
-
-		strcpy( sLine, sText );
-		if (bAddSymbols)
-		{
-			// Add user symbol:          symbolname EQU $address
-			//  or user symbol: address: symbolname DFB #bytes
- 			char *pEQU = strstr( sLine, "EQU" ); // EQUal / EQUate
-			char *pDFB = strstr( sLine, "DFB" ); // DeFine Byte
-			char *pLabel = NULL;
-
-			if (pEQU)
-				pLabel = pEQU;
-			if (pDFB)
-				pLabel = pDFB;
-
-			if (pLabel)
-			{	
-				char *pLabelEnd = pLabel - 1;
-				pLabelEnd = const_cast<char*>( SkipWhiteSpaceReverse( pLabelEnd, &sLine[ 0 ] ));
-				char * pLabelStart = NULL; // SkipWhiteSpaceReverse( pLabelEnd, &sLine[ 0 ] );
-				if (pLabelEnd)
-				{
-					pLabelStart = const_cast<char*>( SkipUntilWhiteSpaceReverse( pLabelEnd, &sLine[ 0 ] ));
-					pLabelEnd++;
-					pLabelStart++;
-					
-					int nLen = (int) (pLabelEnd - pLabelStart);
-					nLen = MIN( nLen, MAX_SYMBOLS_LEN );
-					strncpy( sName, pLabelStart, nLen );
-					sName[ nLen - 1 ] = 0;
-
-					char *pAddressEQU = strstr( pLabel, "$" );
-					char *pAddressDFB = strstr( sLine, ":" ); // Get address from start of line
-					char *pAddress = NULL;
-
-					if (pAddressEQU)
-						pAddress = pAddressEQU + 1;
-					if (pAddressDFB)
-					{
-						*pAddressDFB = 0;
-						pAddress = sLine;
-					}
-
-					if (pAddress)
-					{
-						char *pAddressEnd;
-						nAddress = (uint32_t) strtol( pAddress, &pAddressEnd, 16 );
-						g_aSymbols[ SYMBOLS_SRC_2 ][ (WORD) nAddress] = sName;
-						g_nSourceAssemblySymbols++;
-					}
-				}
-			}
-		}
-	} // for
-
-	bStatus = true;
-	
-	return bStatus;
-}
-
-
 //===========================================================================
 Update_t CmdSource (int nArgs)
 {
 	if (! nArgs)
 	{
 		g_bSourceLevelDebugging = false;
+		g_SourceInfo.Clear();
 	}
 	else
 	{
@@ -7020,38 +7294,47 @@ Update_t CmdSource (int nArgs)
 			}
 			else
 			{
-				const std::string sFileName = g_sProgramDir + pFileName;
+				const std::string sFileName = (pFileName[0] == PATH_SEPARATOR || pFileName[1] == ':')
+					? pFileName
+					: g_sProgramDir + pFileName;
 
 				const int MAX_MINI_FILENAME = 20; 
 				const std::string sMiniFileName = sFileName.substr(0, MIN(MAX_MINI_FILENAME, sFileName.size()));
 
-				if (BufferAssemblyListing( sFileName ))
+				std::string sError;
+				if (g_SourceInfo.LoadFile( sFileName, sError ))
 				{
-					g_aSourceFileName = pFileName;
+					g_bSourceLevelDebugging = true;
+
+					const int nBytes = g_bSourceAddMemory ? g_SourceInfo.WriteMemory() : 0;
+
+					int nSymbols = 0;
+					if (g_bSourceAddSymbols)
+					{
+						for (const SourceInfoSymbol_t & symbol : g_SourceInfo.GetSymbols())
+							SymbolTableInsert( SYMBOLS_SRC_2, symbol.nAddress, symbol.sName );
+						nSymbols = (int) g_SourceInfo.GetSymbols().size();
+					}
 
-					if (! ParseAssemblyListing( g_bSourceAddMemory, g_bSourceAddSymbols ))
+					if (nBytes)
 					{
-						ConsoleBufferPushFormat( "Couldn't load filename: %s", sMiniFileName.c_str() );
+						ConsoleBufferPushFormat( "  Read: %d lines, %d symbols, %d bytes"
+							, g_SourceInfo.GetNumLines()
+							, nSymbols, nBytes );
 					}
 					else
 					{
-						if (g_nSourceAssembleBytes)
-						{
-							ConsoleBufferPushFormat( "  Read: %d lines, %d symbols, %d bytes"
-								, g_AssemblerSourceBuffer.GetNumLines() // g_nSourceAssemblyLines
-								, g_nSourceAssemblySymbols, g_nSourceAssembleBytes );
-						}
-						else
-						{
-							ConsoleBufferPushFormat( "  Read: %d lines, %d symbols"
-								, g_AssemblerSourceBuffer.GetNumLines() // g_nSourceAssemblyLines
-								, g_nSourceAssemblySymbols );
-						}
+						ConsoleBufferPushFormat( "  Read: %d lines, %d symbols"
+							, g_SourceInfo.GetNumLines()
+							, nSymbols );
 					}
+					ConsoleBufferPushFormat( "  %d files, %d scopes, %d address ranges"
+						, g_SourceInfo.GetNumFiles(), g_SourceInfo.GetNumScopes(), g_SourceInfo.GetNumRanges() );
 				}
 				else
 				{
 					ConsoleBufferPushFormat( "Error reading: %s", sMiniFileName.c_str() );
+					ConsoleBufferPushFormat( "  %s", sError.c_str() );
 				}
 			}
 		}
@@ -7061,6 +7344,79 @@ Update_t CmdSource (int nArgs)
 	return UPDATE_CONSOLE_DISPLAY;	
 }
 
+// Runs until the PC is on another source line, or back at the start of this one (a loop)
+//===========================================================================
+static Update_t CmdStepSource ( const SourceStep_e eStep )
+{
+	if (g_SourceInfo.IsEmpty())
+		return ConsoleDisplayError( "No source: see SOURCE, ASM" );
+
+	const SourceInfoRange_t *pLine = g_SourceInfo.FindLine( regs.pc );
+	g_SourceStepLine.iFile = pLine ? g_SourceInfo.GetLine( pLine->iItem ).iFile : -1;
+	g_SourceStepLine.nLine = pLine ? g_SourceInfo.GetLine( pLine->iItem ).nLine : 0;
+	g_eSourceStep = eStep;
+	g_nSourceStepReturn = -1;
+
+	// As G, but one instruction at a time
+	g_nDebugSteps = -1;
+	g_nDebugStepCycles  = 0;
+	g_nDebugStepStart = regs.pc;
+	g_nDebugStepUntil = -1;
+	g_nDebugSkipStart = -1;
+	g_nDebugSkipLen   = -1;
+
+	g_bGoCmd_ReinitFlag = true;
+
+	DebugEnterStepping();
+	_BreakpointsStopWriteTraps();
+
+	return UPDATE_CONSOLE_DISPLAY;
+}
+
+//===========================================================================
+Update_t CmdStepOverSource (int nArgs)
+{
+	return CmdStepSource( SOURCE_STEP_OVER );
+}
+
+//===========================================================================
+Update_t CmdTraceSource (int nArgs)
+{
+	return CmdStepSource( SOURCE_STEP_INTO );
+}
+
+// A JSR to code without source is always stepped over
+//===========================================================================
+void SourceStepBefore ()
+{
+	if ((g_nSourceStepReturn >= 0) || (ReadByteFromMemory( regs.pc ) != OPCODE_JSR))
+		return;
+
+	const WORD nTarget = ReadByteFromMemory( (regs.pc + 1) & _6502_MEM_END ) | (ReadByteFromMemory( (regs.pc + 2) & _6502_MEM_END ) << 8);
+	if ((g_eSourceStep == SOURCE_STEP_OVER) || ! g_SourceInfo.FindLine( nTarget ))
+	{
+		g_nSourceStepReturn   = (regs.pc + 3) & _6502_MEM_END;
+		g_nSourceStepReturnSP = regs.sp;
+	}
+}
+
+//===========================================================================
+bool SourceStepIsDone ()
+{
+	if (g_nSourceStepReturn >= 0)
+	{
+		if ((regs.pc != g_nSourceStepReturn) || (regs.sp != g_nSourceStepReturnSP))
+			return false;
+		g_nSourceStepReturn = -1;
+	}
+
+	const SourceInfoRange_t *pLine = g_SourceInfo.FindLine( regs.pc );
+	if (! pLine)
+		return false;
+
+	return ! SourceInfoSameLine( g_SourceInfo.GetLine( pLine->iItem ), g_SourceStepLine ) || (regs.pc == pLine->nFirst);
+}
+
 //===========================================================================
 Update_t CmdSync (int nArgs)
 {
@@ -8426,6 +8782,8 @@ Update_t ExecuteCommand (int nArgs)
 		bool bCook = true;
 		if (g_iCommand == CMD_OUTPUT_ECHO)
 			bCook = false;
+		if ((g_iCommand >= CMD_BREAKPOINT_ADD_COND) && (g_iCommand <= CMD_BREAKPOINT_HIT_COUNT)) // expressions are parsed from the raw input
+			bCook = false;
 
 		int nArgsCooked = nArgs;
 		if (bCook)
@@ -9097,6 +9455,12 @@ void DebugContinueStepping (const bool bCallerWillUpdateDisplay/*=false*/)
 			UpdateLBR();
 			const WORD oldPC = regs.pc;
 
+			if (g_bDebugWriteTrapRun && g_nDebugSteps < 0)
+				CpuSetDebugRunCycles( (uint32_t)(g_fCurrentCLK6502 / 1000.0) );	// 1ms batch, ends early on a write trap
+
+			if (g_eSourceStep != SOURCE_STEP_NONE)
+				SourceStepBefore();
+
 			SingleStep(g_bGoCmd_ReinitFlag);
 			g_bGoCmd_ReinitFlag = false;
 
@@ -9132,7 +9496,14 @@ void DebugContinueStepping (const bool bCallerWillUpdateDisplay/*=false*/)
 			}
 
 			g_pDebugBreakpointHit = nullptr;	// First BP hit
-			g_bDebugBreakpointHit |= CheckBreakpointsIO() | CheckBreakpointsReg() | CheckBreakpointsVideo() | CheckBreakpointsDmaToOrFromIOMemory() | CheckBreakpointsDmaToOrFromMemory(-1);
+			if (g_bDebugWriteTrapRun)
+				g_bDebugBreakpointHit |= CheckBreakpointsWriteTrap();
+			else if (g_nBreakpoints)	// CheckBreakpointsIO() decodes the opcode's targets, so skip when there is nothing to check
+				g_bDebugBreakpointHit |= CheckBreakpointsIO() | CheckBreakpointsReg() | CheckBreakpointsVideo();
+			g_bDebugBreakpointHit |= CheckBreakpointsDmaToOrFromIOMemory() | CheckBreakpointsDmaToOrFromMemory(-1);
+
+			if ((g_eSourceStep != SOURCE_STEP_NONE) && ! g_bDebugBreakpointHit && SourceStepIsDone())
+				g_nDebugSteps = 0;
 		}
 
 		if (regs.pc == g_nDebugStepUntil || g_bDebugBreakpointHit)
@@ -9159,6 +9530,8 @@ void DebugContinueStepping (const bool bCallerWillUpdateDisplay/*=false*/)
 					);
 					if (g_pDebugBreakpointHit->eSource == BP_SRC_REG_PC)
 						interceptBreakpoint.Set(BPTYPE_PC, regs.pc, BPACCESS_R);
+					if (g_pDebugBreakpointHit->bCondition && (g_breakpointHitID >= 0))
+						stopReason = StrFormat( "Condition matches: %s", g_aBreakpointConditions[ g_breakpointHitID ].sExpression.c_str() );
 				}
 			}
 			else if (g_bDebugBreakpointHit & BP_HIT_MEM)
@@ -9169,6 +9542,12 @@ void DebugContinueStepping (const bool bCallerWillUpdateDisplay/*=false*/)
 			else if (g_bDebugBreakpointHit & BP_HIT_MEMW)
 			{
 				stopReason = StrFormat("Write access at %s", g_sBreakMemoryFullPrefixAddr.c_str());
+				if (g_bDebugWriteTrapRun)
+					stopReason += StrFormat( " = " CHC_NUM_HEX "%02X" CHC_DEFAULT " by opcode at " CHC_ARG_SEP "$" CHC_ADDRESS "%04X" CHC_DEFAULT ", cycle %llu",
+						g_DebugWriteTrapHit.value,
+						_GetWriteTrapOpcodeAddress( g_DebugWriteTrapHit ),
+						(unsigned long long) g_DebugWriteTrapHit.cycle
+					);
 				interceptBreakpoint.Set(BPTYPE_MEM, g_nBreakMemoryAddr, BPACCESS_W);
 			}
 			else if (g_bDebugBreakpointHit & BP_HIT_MEMR)
@@ -9250,6 +9629,9 @@ void DebugContinueStepping (const bool bCallerWillUpdateDisplay/*=false*/)
 
 	if (!g_nDebugSteps)
 	{
+		_BreakpointsStopWriteTraps();
+		g_eSourceStep = SOURCE_STEP_NONE;
+
 		SoundCore_SetFade(FADE_OUT);	// NB. Call when MODE_STEPPING (not MODE_DEBUG) - see function
 
 		g_nAppMode = MODE_DEBUG;
@@ -9312,6 +9694,8 @@ static void DebugEnd ()
 
 	g_vMemorySearchResults.clear();
 
+	_BreakpointsStopWriteTraps();
+
 	g_nAppMode = MODE_RUNNING;
 
 	ReleaseDebuggerMemDC();
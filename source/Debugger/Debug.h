@@ -13,6 +13,9 @@
 #include "Debugger_Help.h"
 #include "Debugger_Display.h"
 #include "Debugger_Symbols.h"
+#include "Debugger_Condition.h"
+#include "Debugger_SourceAssembler.h"
+#include "Debugger_SourceInfo.h"
 #include "Util_MemoryTextFile.h"
 #include "BreakpointCard.h"
 
@@ -118,14 +121,6 @@
 //	extern MemorySearchArray_t g_vMemSearchMatches;
 	extern std::vector<int> g_vMemorySearchResults;
 
-// Source Level Debugging
-	extern std::string g_aSourceFileName;
-	extern MemoryTextFile_t g_AssemblerSourceBuffer;
-
-	extern int    g_iSourceDisplayStart   ;
-	extern int    g_nSourceAssembleBytes  ;
-	extern int    g_nSourceAssemblySymbols;
-
 // Version
 	extern const int DEBUGGER_VERSION;
 
@@ -155,9 +150,6 @@
 
 	bool GetBreakpointInfo ( WORD nOffset, bool & bBreakpointActive_, bool & bBreakpointEnable_ );
 
-// Source Level Debugging
-	int FindSourceLine( WORD nAddress );
-
 // Memory
 	size_t Util_GetTextScreen( char* &pText_ );
 	void   Util_CopyTextToClipboard( const size_t nSize, const char *pText );
@@ -192,6 +184,9 @@
 	bool	DebuggerCheckMemBreakpoints(WORD nAddress, WORD nSize, bool isDmaToMemory);
 
 	void	ClearTempBreakpoints();
+	bool	DebugSetBreakpointPC(WORD nAddress);
+	bool	DebugClearBreakpointPC(WORD nAddress);
+	bool	DebugCheckBreakpointPC(WORD nAddress);
 	void	DebugSetAutoRunScript(std::string& sAutoRunScriptFilename);
 
 	typedef void(*CBFUNCTION)(uint8_t slot, INTERCEPTBREAKPOINT interceptBreakpoint);
@@ -42,6 +42,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	// Assembler
 //		{"!"           , CmdAssemberMini      , CMD_ASSEMBLER_MINI       , "Mini assembler"             },
 		{"A"           , CmdAssemble          , CMD_ASSEMBLE             , "Assemble instructions"      },
+		{"ASM"         , CmdAssembleSource    , CMD_ASSEMBLE_SOURCE      , "Assemble a source file into memory" },
 	// CPU (Main)
 		{"."           , CmdCursorJumpPC      , CMD_CURSOR_JUMP_PC       , "Locate the cursor in the disasm window" }, // centered
 		{"="           , CmdCursorSetPC       , CMD_CURSOR_SET_PC        , "Sets the PC to the current instruction" },
@@ -63,10 +64,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //		{"RTS"         , CmdStackReturn       , CMD_STACK_RETURN         },
 		{"P"           , CmdStepOver          , CMD_STEP_OVER            , "Step current instruction"   },
 		{"RTS"         , CmdStepOut           , CMD_STEP_OUT             , "Step out of subroutine"     }, 
+		{"PS"          , CmdStepOverSource    , CMD_STEP_OVER_SOURCE     , "Step to the next source line, over JSR" },
 	// CPU - Meta Info
 		{"T"           , CmdTrace             , CMD_TRACE                , "Trace current instruction"  },
 		{"TF"          , CmdTraceFile         , CMD_TRACE_FILE           , "Save trace to filename [with video scanner info]" },
 		{"TL"          , CmdTraceLine         , CMD_TRACE_LINE           , "Trace (with cycle counting)" },
+		{"TS"          , CmdTraceSource       , CMD_TRACE_SOURCE         , "Trace to the next source line" },
 		{"U"           , CmdUnassemble        , CMD_UNASSEMBLE           , "Disassemble instructions"   },
 //		{"WAIT"        , CmdWait              , CMD_WAIT                 , "Run until
 	// Bookmarks
@@ -100,6 +103,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //		{"BPLOAD"      , CmdBreakpointLoad    , CMD_BREAKPOINT_LOAD      , "Loads breakpoints" },
 		{"BPSAVE"      , CmdBreakpointSave    , CMD_BREAKPOINT_SAVE      , "Saves breakpoints" },
 		{"BPCHANGE"    , CmdBreakpointChange  , CMD_BREAKPOINT_CHANGE    , "Change breakpoint" },
+		{"BPIF"        , CmdBreakpointAddCond , CMD_BREAKPOINT_ADD_COND  , "Add breakpoint on expression" },
+		{"BPT"         , CmdBreakpointAddTrace, CMD_BREAKPOINT_ADD_TRACE , "Add tracepoint (log, don't stop) on expression" },
+		{"BPCOND"      , CmdBreakpointCondition, CMD_BREAKPOINT_CONDITION, "Set/clear the condition of a breakpoint" },
+		{"BPHIT"       , CmdBreakpointHitCount, CMD_BREAKPOINT_HIT_COUNT , "Only stop after breakpoint was hit # times" },
 	// Config
 		{"BENCHMARK"   , CmdBenchmark         , CMD_BENCHMARK            , "Benchmark the emulator" },
 		{"BW"          , CmdConfigColorMono   , CMD_CONFIG_BW            , "Sets/Shows RGB for Black & White scheme" },
@@ -431,6 +438,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		{"t"          , NULL, PARAM_BP_CHANGE_TEMP_OFF },
 		{"S"          , NULL, PARAM_BP_CHANGE_STOP_ON  },
 		{"s"          , NULL, PARAM_BP_CHANGE_STOP_OFF },
+		{"L"          , NULL, PARAM_BP_CHANGE_LOG_ON   },
+		{"l"          , NULL, PARAM_BP_CHANGE_LOG_OFF  },
 // Regs (for PUSH / POP)
 		{"A"          , NULL, PARAM_REG_A          },
 		{"X"          , NULL, PARAM_REG_X          },
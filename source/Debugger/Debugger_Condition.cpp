@@ -0,0 +1,581 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2010, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Breakpoint Conditions
+ *
+ * Compiles expressions such as:
+ *    PC = 0800 and A >= 80 and mem[FA] == 3
+ * into postfix code that is cheap enough to evaluate every instruction.
+ *
+ * Grammar (lowest to highest precedence):
+ *    or    : and   { (OR  | '||') and   }
+ *    and   : not   { (AND | '&&') not   }
+ *    not   : (NOT | '!') not | cmp
+ *    cmp   : bits  [ ('=' | '==' | '!=' | '<' | '<=' | '>' | '>=') bits ]
+ *    bits  : sum   { ('&' | '|' | '^') sum }
+ *    sum   : unary { ('+' | '-') unary }
+ *    unary : ('-' | '~') unary | value
+ *    value : '(' or ')' | [MEM] '[' or ']' | W '[' or ']'
+ *          | register | flag | symbol | ['$'] hex | '#' decimal
+ *
+ * Registers: A X Y PC S SP P.  Flags: C Z I D B V N.
+ * Register and flag names take precedence over hex values, ie. use $C for the hex value.
+ * Arithmetic is 16-bit, comparisons are unsigned.
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+#include "Debugger_Condition.h"
+
+#include "../CPU.h"
+#include "../Memory.h"
+
+// Globals __________________________________________________________________
+
+	BreakpointCondition_t g_aBreakpointConditions[ MAX_BREAKPOINTS ];
+
+
+// Evaluate _________________________________________________________________
+
+//===========================================================================
+static inline int _ConditionApply( const BYTE eOp, const int nLHS, const int nRHS )
+{
+	switch (eOp)
+	{
+		case COND_OP_ADD          : return (nLHS + nRHS) & 0xFFFF;
+		case COND_OP_SUB          : return (nLHS - nRHS) & 0xFFFF;
+		case COND_OP_BIT_AND      : return nLHS &  nRHS;
+		case COND_OP_BIT_OR       : return nLHS |  nRHS;
+		case COND_OP_BIT_XOR      : return nLHS ^  nRHS;
+		case COND_OP_EQUAL        : return nLHS == nRHS;
+		case COND_OP_NOT_EQUAL    : return nLHS != nRHS;
+		case COND_OP_LESS_THAN    : return nLHS <  nRHS;
+		case COND_OP_LESS_EQUAL   : return nLHS <= nRHS;
+		case COND_OP_GREATER_THAN : return nLHS >  nRHS;
+		case COND_OP_GREATER_EQUAL: return nLHS >= nRHS;
+		case COND_OP_AND          : return nLHS && nRHS;
+		case COND_OP_OR           : return nLHS || nRHS;
+		default:
+			_ASSERT(0);
+			return 0;
+	}
+}
+
+// Called from the CPU stepping loop, so keep this cheap:
+// no allocations, and memory is read without side-effects (no I/O soft-switch access)
+//===========================================================================
+bool BreakpointConditionEval ( const BreakpointCondition_t & condition )
+{
+	int aStack[ MAX_COND_STACK ];
+	int iTop = -1;
+
+	const BreakpointCondOp_t *pOp  = condition.aCode.data();
+	const BreakpointCondOp_t *pEnd = pOp + condition.aCode.size();
+
+	for ( ; pOp < pEnd; pOp++ )
+	{
+		switch (pOp->eOp)
+		{
+			case COND_OP_CONST    : aStack[ ++iTop ] = pOp->nValue; break;
+			case COND_OP_REG_A    : aStack[ ++iTop ] = regs.a ; break;
+			case COND_OP_REG_X    : aStack[ ++iTop ] = regs.x ; break;
+			case COND_OP_REG_Y    : aStack[ ++iTop ] = regs.y ; break;
+			case COND_OP_REG_PC   : aStack[ ++iTop ] = regs.pc; break;
+			case COND_OP_REG_S    : aStack[ ++iTop ] = regs.sp; break;
+			case COND_OP_REG_P    : aStack[ ++iTop ] = regs.ps; break;
+			case COND_OP_FLAG     : aStack[ ++iTop ] = (regs.ps & pOp->nValue) ? 1 : 0; break;
+			case COND_OP_PEEK_ABS : aStack[ ++iTop ] = ReadByteFromMemory( pOp->nValue ); break;
+			case COND_OP_PEEK     : aStack[ iTop ] = ReadByteFromMemory( (WORD) aStack[ iTop ] ); break;
+			case COND_OP_PEEK_WORD: aStack[ iTop ] = ReadWordFromMemory( (WORD) aStack[ iTop ] ); break;
+			case COND_OP_NEGATE   : aStack[ iTop ] = (-aStack[ iTop ]) & 0xFFFF; break;
+			case COND_OP_INVERT   : aStack[ iTop ] = (~aStack[ iTop ]) & 0xFFFF; break;
+			case COND_OP_NOT      : aStack[ iTop ] = !aStack[ iTop ]; break;
+			default:
+				iTop--;
+				aStack[ iTop ] = _ConditionApply( pOp->eOp, aStack[ iTop ], aStack[ iTop + 1 ] );
+				break;
+		}
+	}
+
+	return (iTop >= 0) && (aStack[ iTop ] != 0);
+}
+
+
+// Compile __________________________________________________________________
+
+	struct CondToken_t
+	{
+		ArgToken_e  eToken;
+		std::string sText ; // TOKEN_ALPHANUMERIC only
+	};
+
+	struct CondParser_t
+	{
+		std::vector<CondToken_t>          aTokens;
+		size_t                            iToken ;
+		std::vector<BreakpointCondOp_t> * pCode  ;
+		int                               nDepth ;
+		std::string                       sError ;
+	};
+
+	// Merged tokens that the console parser doesn't have
+	const ArgToken_e COND_TOKEN_EQUAL_EQUAL = (ArgToken_e)(NUM_TOKENS + 0); // ==
+	const ArgToken_e COND_TOKEN_LOGICAL_AND = (ArgToken_e)(NUM_TOKENS + 1); // &&
+	const ArgToken_e COND_TOKEN_LOGICAL_OR  = (ArgToken_e)(NUM_TOKENS + 2); // ||
+
+static bool _ConditionParseOr ( CondParser_t & parser );
+
+// Split the expression using the same token table as the console
+//===========================================================================
+static bool _ConditionTokenize ( const char *pSrc, std::vector<CondToken_t> & aTokens_, std::string & sError_ )
+{
+	while (pSrc && *pSrc)
+	{
+		pSrc = SkipWhiteSpace( pSrc );
+		if (! *pSrc)
+			break;
+
+		ArgToken_e eToken = NO_TOKEN;
+		ArgToken_e eTokenEnd = NO_TOKEN;
+		const char *pEnd = FindTokenOrAlphaNumeric( pSrc, g_aTokens, NUM_TOKENS, &eToken );
+		if ((eToken == NO_TOKEN) || (eToken == TOKEN_ALPHANUMERIC))
+		{
+			eToken = TOKEN_ALPHANUMERIC;
+			pEnd = SkipUntilToken( pSrc+1, g_aTokens, NUM_TOKENS, &eTokenEnd );
+		}
+
+		if (eToken == TOKEN_COMMENT_EOL)
+			break;
+
+		if ((eToken == TOKEN_QUOTE_SINGLE) || (eToken == TOKEN_QUOTE_DOUBLE) || (eToken == TOKEN_SPACE))
+		{
+			sError_ = StrFormat( "Unexpected '%c'", *pSrc );
+			return false;
+		}
+
+		CondToken_t token;
+		token.eToken = eToken;
+		if (eToken == TOKEN_ALPHANUMERIC)
+			token.sText.assign( pSrc, pEnd - pSrc );
+
+		// Merge the C style operators: == && ||
+		if (! aTokens_.empty())
+		{
+			ArgToken_e &ePrev = aTokens_.back().eToken;
+			if      ((ePrev == TOKEN_EQUAL    ) && (eToken == TOKEN_EQUAL    ) && (pSrc[-1] == '=')) { ePrev = COND_TOKEN_EQUAL_EQUAL; pSrc = pEnd; continue; }
+			else if ((ePrev == TOKEN_AMPERSAND) && (eToken == TOKEN_AMPERSAND) && (pSrc[-1] == '&')) { ePrev = COND_TOKEN_LOGICAL_AND; pSrc = pEnd; continue; }
+			else if ((ePrev == TOKEN_PIPE     ) && (eToken == TOKEN_PIPE     ) && (pSrc[-1] == '|')) { ePrev = COND_TOKEN_LOGICAL_OR ; pSrc = pEnd; continue; }
+		}
+
+		aTokens_.push_back( token );
+		pSrc = pEnd;
+	}
+
+	if (aTokens_.empty())
+	{
+		sError_ = "Missing expression";
+		return false;
+	}
+
+	return true;
+}
+
+//===========================================================================
+static const CondToken_t * _ConditionPeek ( const CondParser_t & parser )
+{
+	return (parser.iToken < parser.aTokens.size()) ? &parser.aTokens[ parser.iToken ] : NULL;
+}
+
+//===========================================================================
+static bool _ConditionIsKeyword ( const CondToken_t *pToken, const char *pKeyword )
+{
+	return pToken && (pToken->eToken == TOKEN_ALPHANUMERIC) && (_stricmp( pToken->sText.c_str(), pKeyword ) == 0);
+}
+
+//===========================================================================
+static bool _ConditionEmit ( CondParser_t & parser, const BreakpointCondOp_e eOp, const WORD nValue = 0 )
+{
+	std::vector<BreakpointCondOp_t> &aCode = *parser.pCode;
+	const size_t nCode = aCode.size();
+
+	switch (eOp)
+	{
+		case COND_OP_CONST    :
+		case COND_OP_REG_A    :
+		case COND_OP_REG_X    :
+		case COND_OP_REG_Y    :
+		case COND_OP_REG_PC   :
+		case COND_OP_REG_S    :
+		case COND_OP_REG_P    :
+		case COND_OP_FLAG     :
+		case COND_OP_PEEK_ABS :
+			if (++parser.nDepth > MAX_COND_STACK)
+			{
+				parser.sError = "Expression too complex";
+				return false;
+			}
+			break;
+
+		case COND_OP_PEEK:
+			// mem[ constant ] doesn't need the address on the stack
+			if (nCode && (aCode[ nCode-1 ].eOp == COND_OP_CONST))
+			{
+				aCode[ nCode-1 ].eOp = COND_OP_PEEK_ABS;
+				return true;
+			}
+			break;
+
+		case COND_OP_PEEK_WORD:
+			break;
+
+		case COND_OP_NEGATE:
+		case COND_OP_INVERT:
+		case COND_OP_NOT   :
+			if (nCode && (aCode[ nCode-1 ].eOp == COND_OP_CONST))
+			{
+				int nValue = aCode[ nCode-1 ].nValue;
+				if      (eOp == COND_OP_NEGATE) nValue = -nValue;
+				else if (eOp == COND_OP_INVERT) nValue = ~nValue;
+				else                            nValue = !nValue;
+				aCode[ nCode-1 ].nValue = (WORD) nValue;
+				return true;
+			}
+			break;
+
+		default: // binary
+			parser.nDepth--;
+			if ((nCode >= 2) && (aCode[ nCode-1 ].eOp == COND_OP_CONST) && (aCode[ nCode-2 ].eOp == COND_OP_CONST))
+			{
+				aCode[ nCode-2 ].nValue = (WORD) _ConditionApply( eOp, aCode[ nCode-2 ].nValue, aCode[ nCode-1 ].nValue );
+				aCode.pop_back();
+				return true;
+			}
+			break;
+	}
+
+	BreakpointCondOp_t op;
+	op.eOp    = (BYTE) eOp;
+	op.nValue = nValue;
+	aCode.push_back( op );
+	return true;
+}
+
+//===========================================================================
+static bool _ConditionExpect ( CondParser_t & parser, const ArgToken_e eToken, const char *pText )
+{
+	const CondToken_t *pToken = _ConditionPeek( parser );
+	if (!pToken || (pToken->eToken != eToken))
+	{
+		parser.sError = StrFormat( "Expected '%s'", pText );
+		return false;
+	}
+	parser.iToken++;
+	return true;
+}
+
+//===========================================================================
+static bool _ConditionParseNumber ( CondParser_t & parser, const std::string & sText, const int nBase, WORD & nValue_ )
+{
+	char *pEnd = NULL;
+	const unsigned long nValue = strtoul( sText.c_str(), &pEnd, nBase );
+	if (sText.empty() || *pEnd || (nValue > 0xFFFF))
+	{
+		parser.sError = StrFormat( "Bad number '%s'", sText.c_str() );
+		return false;
+	}
+	nValue_ = (WORD) nValue;
+	return true;
+}
+
+//===========================================================================
+static bool _ConditionParseIdentifier ( CondParser_t & parser, const std::string & sName )
+{
+	struct Name_t
+	{
+		const char         *pName;
+		BreakpointCondOp_e  eOp  ;
+		WORD                nMask;
+	};
+	static const Name_t aNames[] =
+	{
+		{ "A" , COND_OP_REG_A , 0            },
+		{ "X" , COND_OP_REG_X , 0            },
+		{ "Y" , COND_OP_REG_Y , 0            },
+		{ "PC", COND_OP_REG_PC, 0            },
+		{ "S" , COND_OP_REG_S , 0            },
+		{ "SP", COND_OP_REG_S , 0            },
+		{ "P" , COND_OP_REG_P , 0            },
+		{ "C" , COND_OP_FLAG  , AF_CARRY     },
+		{ "Z" , COND_OP_FLAG  , AF_ZERO      },
+		{ "I" , COND_OP_FLAG  , AF_INTERRUPT },
+		{ "D" , COND_OP_FLAG  , AF_DECIMAL   },
+		{ "B" , COND_OP_FLAG  , AF_BREAK     },
+		{ "V" , COND_OP_FLAG  , AF_OVERFLOW  },
+		{ "N" , COND_OP_FLAG  , AF_SIGN      },
+	};
+
+	for (const Name_t & name : aNames)
+	{
+		if (_stricmp( sName.c_str(), name.pName ) == 0)
+			return _ConditionEmit( parser, name.eOp, name.nMask );
+	}
+
+	WORD nAddress = 0;
+	if (FindAddressFromSymbol( sName.c_str(), &nAddress ))
+		return _ConditionEmit( parser, COND_OP_CONST, nAddress );
+
+	if (! _ConditionParseNumber( parser, sName, 16, nAddress ))
+	{
+		parser.sError = StrFormat( "Unknown register, symbol, or value '%s'", sName.c_str() );
+		return false;
+	}
+	return _ConditionEmit( parser, COND_OP_CONST, nAddress );
+}
+
+//===========================================================================
+static bool _ConditionParseValue ( CondParser_t & parser )
+{
+	const CondToken_t *pToken = _ConditionPeek( parser );
+	if (! pToken)
+	{
+		parser.sError = "Unexpected end of expression";
+		return false;
+	}
+	parser.iToken++;
+
+	switch (pToken->eToken)
+	{
+		case TOKEN_PAREN_L:
+			return _ConditionParseOr( parser ) && _ConditionExpect( parser, TOKEN_PAREN_R, ")" );
+
+		case TOKEN_BRACKET_L:
+			return _ConditionParseOr( parser ) && _ConditionExpect( parser, TOKEN_BRACKET_R, "]" ) && _ConditionEmit( parser, COND_OP_PEEK );
+
+		case TOKEN_DOLLAR:
+		case TOKEN_HASH:
+		{
+			const CondToken_t *pNumber = _ConditionPeek( parser );
+			if (!pNumber || (pNumber->eToken != TOKEN_ALPHANUMERIC))
+			{
+				parser.sError = "Missing number";
+				return false;
+			}
+			parser.iToken++;
+
+			WORD nValue = 0;
+			return _ConditionParseNumber( parser, pNumber->sText, (pToken->eToken == TOKEN_HASH) ? 10 : 16, nValue )
+				&& _ConditionEmit( parser, COND_OP_CONST, nValue );
+		}
+
+		case TOKEN_ALPHANUMERIC:
+		{
+			const CondToken_t *pNext = _ConditionPeek( parser );
+			if (pNext && (pNext->eToken == TOKEN_BRACKET_L))
+			{
+				BreakpointCondOp_e eOp;
+				if (_ConditionIsKeyword( pToken, "MEM" ) || _ConditionIsKeyword( pToken, "PEEK" ))
+					eOp = COND_OP_PEEK;
+				else if (_ConditionIsKeyword( pToken, "W" ) || _ConditionIsKeyword( pToken, "WORD" ))
+					eOp = COND_OP_PEEK_WORD;
+				else
+				{
+					parser.sError = StrFormat( "Unknown memory accessor '%s'", pToken->sText.c_str() );
+					return false;
+				}
+				parser.iToken++;
+				return _ConditionParseOr( parser ) && _ConditionExpect( parser, TOKEN_BRACKET_R, "]" ) && _ConditionEmit( parser, eOp );
+			}
+			return _ConditionParseIdentifier( parser, pToken->sText );
+		}
+
+		default:
+			break;
+	}
+
+	parser.sError = "Expected a value";
+	return false;
+}
+
+//===========================================================================
+static bool _ConditionParseUnary ( CondParser_t & parser )
+{
+	const CondToken_t *pToken = _ConditionPeek( parser );
+	if (pToken && ((pToken->eToken == TOKEN_MINUS) || (pToken->eToken == TOKEN_TILDE)))
+	{
+		parser.iToken++;
+		return _ConditionParseUnary( parser )
+			&& _ConditionEmit( parser, (pToken->eToken == TOKEN_MINUS) ? COND_OP_NEGATE : COND_OP_INVERT );
+	}
+	return _ConditionParseValue( parser );
+}
+
+//===========================================================================
+static bool _ConditionParseSum ( CondParser_t & parser )
+{
+	if (! _ConditionParseUnary( parser ))
+		return false;
+
+	const CondToken_t *pToken;
+	while ((pToken = _ConditionPeek( parser )) && ((pToken->eToken == TOKEN_PLUS) || (pToken->eToken == TOKEN_MINUS)))
+	{
+		parser.iToken++;
+		if (! _ConditionParseUnary( parser ))
+			return false;
+		if (! _ConditionEmit( parser, (pToken->eToken == TOKEN_PLUS) ? COND_OP_ADD : COND_OP_SUB ))
+			return false;
+	}
+	return true;
+}
+
+//===========================================================================
+static bool _ConditionParseBits ( CondParser_t & parser )
+{
+	if (! _ConditionParseSum( parser ))
+		return false;
+
+	const CondToken_t *pToken;
+	while ((pToken = _ConditionPeek( parser )) != NULL)
+	{
+		BreakpointCondOp_e eOp;
+		if      (pToken->eToken == TOKEN_AMPERSAND) eOp = COND_OP_BIT_AND;
+		else if (pToken->eToken == TOKEN_PIPE     ) eOp = COND_OP_BIT_OR ;
+		else if (pToken->eToken == TOKEN_CARET    ) eOp = COND_OP_BIT_XOR;
+		else
+			break;
+
+		parser.iToken++;
+		if (! (_ConditionParseSum( parser ) && _ConditionEmit( parser, eOp )))
+			return false;
+	}
+	return true;
+}
+
+//===========================================================================
+static bool _ConditionParseCompare ( CondParser_t & parser )
+{
+	if (! _ConditionParseBits( parser ))
+		return false;
+
+	const CondToken_t *pToken = _ConditionPeek( parser );
+	if (! pToken)
+		return true;
+
+	BreakpointCondOp_e eOp;
+	switch (pToken->eToken)
+	{
+		case TOKEN_EQUAL           :
+		case COND_TOKEN_EQUAL_EQUAL: eOp = COND_OP_EQUAL        ; break;
+		case TOKEN_NOT_EQUAL       : eOp = COND_OP_NOT_EQUAL    ; break;
+		case TOKEN_LESS_THAN       : eOp = COND_OP_LESS_THAN    ; break;
+		case TOKEN_LESS_EQUAL      : eOp = COND_OP_LESS_EQUAL   ; break;
+		case TOKEN_GREATER_THAN    : eOp = COND_OP_GREATER_THAN ; break;
+		case TOKEN_GREATER_EQUAL   : eOp = COND_OP_GREATER_EQUAL; break;
+		default:
+			return true;
+	}
+
+	parser.iToken++;
+	return _ConditionParseBits( parser ) && _ConditionEmit( parser, eOp );
+}
+
+//===========================================================================
+static bool _ConditionParseNot ( CondParser_t & parser )
+{
+	const CondToken_t *pToken = _ConditionPeek( parser );
+	if (pToken && ((pToken->eToken == TOKEN_EXCLAMATION) || _ConditionIsKeyword( pToken, "NOT" )))
+	{
+		parser.iToken++;
+		return _ConditionParseNot( parser ) && _ConditionEmit( parser, COND_OP_NOT );
+	}
+	return _ConditionParseCompare( parser );
+}
+
+//===========================================================================
+static bool _ConditionParseAnd ( CondParser_t & parser )
+{
+	if (! _ConditionParseNot( parser ))
+		return false;
+
+	const CondToken_t *pToken;
+	while ((pToken = _ConditionPeek( parser )) && ((pToken->eToken == COND_TOKEN_LOGICAL_AND) || _ConditionIsKeyword( pToken, "AND" )))
+	{
+		parser.iToken++;
+		if (! (_ConditionParseNot( parser ) && _ConditionEmit( parser, COND_OP_AND )))
+			return false;
+	}
+	return true;
+}
+
+//===========================================================================
+static bool _ConditionParseOr ( CondParser_t & parser )
+{
+	if (! _ConditionParseAnd( parser ))
+		return false;
+
+	const CondToken_t *pToken;
+	while ((pToken = _ConditionPeek( parser )) && ((pToken->eToken == COND_TOKEN_LOGICAL_OR) || _ConditionIsKeyword( pToken, "OR" )))
+	{
+		parser.iToken++;
+		if (! (_ConditionParseAnd( parser ) && _ConditionEmit( parser, COND_OP_OR )))
+			return false;
+	}
+	return true;
+}
+
+// @return false and sError_ on a syntax error; condition_ is only modified on success
+//===========================================================================
+bool BreakpointConditionCompile ( const char *pExpression, BreakpointCondition_t & condition_, std::string & sError_ )
+{
+	std::vector<BreakpointCondOp_t> aCode;
+
+	CondParser_t parser;
+	parser.iToken = 0;
+	parser.pCode  = &aCode;
+	parser.nDepth = 0;
+
+	if (! _ConditionTokenize( pExpression, parser.aTokens, sError_ ))
+		return false;
+
+	if (! _ConditionParseOr( parser ))
+	{
+		sError_ = parser.sError;
+		return false;
+	}
+
+	if (parser.iToken < parser.aTokens.size())
+	{
+		const CondToken_t &token = parser.aTokens[ parser.iToken ];
+		sError_ = (token.eToken == TOKEN_ALPHANUMERIC)
+			? StrFormat( "Unexpected '%s'", token.sText.c_str() )
+			: std::string( "Unexpected operator" );
+		return false;
+	}
+
+	condition_.sExpression = SkipWhiteSpace( pExpression );
+	condition_.sExpression = condition_.sExpression.substr( 0, condition_.sExpression.find( ';' ) );
+	while (!condition_.sExpression.empty() && (condition_.sExpression.back() == CHAR_SPACE))
+		condition_.sExpression.pop_back();
+	condition_.aCode.swap( aCode );
+	return true;
+}
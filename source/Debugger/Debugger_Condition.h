@@ -0,0 +1,67 @@
+#pragma once
+
+// Breakpoint Conditions __________________________________________________________________________
+
+	// Compiled form of a breakpoint expression, i.e.
+	//    PC = 0800 and A >= 80 and mem[FA] == 3
+	// The expression is compiled once (postfix) and evaluated on a small value stack.
+	enum BreakpointCondOp_e
+	{
+		  COND_OP_CONST      // push nValue
+		, COND_OP_REG_A
+		, COND_OP_REG_X
+		, COND_OP_REG_Y
+		, COND_OP_REG_PC
+		, COND_OP_REG_S
+		, COND_OP_REG_P
+		, COND_OP_FLAG       // push (P & nValue) != 0
+		, COND_OP_PEEK_ABS   // push mem[ nValue ]
+		, COND_OP_PEEK       // pop address, push mem[ address ]
+		, COND_OP_PEEK_WORD  // pop address, push mem[ address ] | mem[ address+1 ] << 8
+		, COND_OP_NEGATE
+		, COND_OP_INVERT     // ~
+		, COND_OP_NOT        // ! not
+		, COND_OP_ADD
+		, COND_OP_SUB
+		, COND_OP_BIT_AND
+		, COND_OP_BIT_OR
+		, COND_OP_BIT_XOR
+		, COND_OP_EQUAL
+		, COND_OP_NOT_EQUAL
+		, COND_OP_LESS_THAN
+		, COND_OP_LESS_EQUAL
+		, COND_OP_GREATER_THAN
+		, COND_OP_GREATER_EQUAL
+		, COND_OP_AND        // && and
+		, COND_OP_OR         // || or
+
+		, NUM_COND_OPS
+	};
+
+	struct BreakpointCondOp_t
+	{
+		BYTE eOp   ; // BreakpointCondOp_e
+		WORD nValue;
+	};
+
+	enum
+	{
+		MAX_COND_STACK = 16
+	};
+
+	struct BreakpointCondition_t
+	{
+		std::string                     sExpression; // as entered, for BPL and BPSAVE
+		std::vector<BreakpointCondOp_t> aCode      ;
+
+		void Clear()
+		{
+			sExpression.clear();
+			aCode.clear();
+		}
+	};
+
+	extern BreakpointCondition_t g_aBreakpointConditions[ MAX_BREAKPOINTS ];
+
+	bool BreakpointConditionCompile( const char *pExpression, BreakpointCondition_t & condition_, std::string & sError_ );
+	bool BreakpointConditionEval   ( const BreakpointCondition_t & condition );
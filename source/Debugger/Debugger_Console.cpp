@@ -68,6 +68,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		int       g_nConsoleDisplayLines  = 0;
 		int       g_nConsoleDisplayWidth  = 0;
 		conchar_t g_aConsoleDisplay[ CONSOLE_HEIGHT ][ CONSOLE_WIDTH ];
+		ConsoleDisplayHook_t g_pConsoleDisplayHook = NULL; // also sees every line pushed to the display
 
 	// Error Level
 //		ConsoleOutputLevel_e g_eConsoleOutputLevel = ConsoleOutputLevel_e::CONSOLE_OUTPUT_LEVEL_NONE;	 // Show nothing
@@ -409,6 +410,9 @@ void ConsoleDisplayPush ( const conchar_t * pText )
 			, pText
 			, sizeof(conchar_t) * CONSOLE_WIDTH
 		);
+
+		if (g_pConsoleDisplayHook)
+			g_pConsoleDisplayHook( pText );
 	}
 	
 	g_nConsoleDisplayTotal++;
@@ -418,6 +422,13 @@ void ConsoleDisplayPush ( const conchar_t * pText )
 }
 
 
+//===========================================================================
+void ConsoleDisplaySetHook ( ConsoleDisplayHook_t pHook )
+{
+	g_pConsoleDisplayHook = pHook;
+}
+
+
 //===========================================================================
 void ConsoleDisplayPause ()
 {
@@ -364,6 +364,10 @@
 	Update_t ConsoleUpdate       ();
 	void     ConsoleFlush        ();
 
+	// Copy of the output, e.g. to stdout when there is no debugger window (see common2::ScriptEngine)
+	typedef void (*ConsoleDisplayHook_t)( const conchar_t * pText );
+	void     ConsoleDisplaySetHook ( ConsoleDisplayHook_t pHook );
+
 	// Input
 	const char *ConsoleInputPeek      ();
 	bool     ConsoleInputClear     ();
@@ -25,8 +25,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "Debug.h"
 
+#include "../CPU.h"
 #include "../Memory.h"
 
+#include <unordered_map>
+
 inline static void _memsetz(void* dst, int val, size_t len)
 {
 	memset(dst, val, len);
@@ -843,3 +846,301 @@ void DisasmCalcTopBotAddress()
 	DisasmCalcTopFromCurAddress();
 	DisasmCalcBotFromTopAddress();
 }
+
+
+// Disassembly Cache ______________________________________________________________________________
+
+	// Formatting a disassembly line is mostly string work, so the displays keep the formatted lines
+	// and only redo the ones whose inputs changed since the last frame:
+	// . the pages the line was read from (instruction bytes, indirect pointer, target value)
+	// . X/Y for indexed addressing
+	// . symbols, data disassembly, breakpoints and the disasm display config (cache generation)
+	//
+	// memdirty[] alone can't be used to detect memory changes: it isn't set by paging changes or
+	// WriteByteToMemory() while the mem cache is invalid, and MemReset() clears it.
+	// Instead the pages lines depend on are compared with a copy once per DisasmCacheUpdate().
+
+	enum
+	{
+		DISASM_CACHE_MAX_DEPENDENCIES = 8,
+		DISASM_CACHE_MAX_LINES        = 4096, // flushed by DisasmCacheUpdate() when exceeded
+	};
+
+	struct DisasmCachePage_t
+	{
+		BYTE     aData[ _6502_PAGE_SIZE ];
+		uint32_t nVersion;
+		bool     bTracked;
+	};
+
+	struct DisasmCacheEntry_t
+	{
+		DisasmCacheLine_t data;
+		uint32_t          nGeneration;
+		int               nPages; // -1 = too many dependencies, never valid
+		BYTE              aPage       [ DISASM_CACHE_MAX_DEPENDENCIES ];
+		uint32_t          aPageVersion[ DISASM_CACHE_MAX_DEPENDENCIES ];
+		bool              bIndexed;
+		BYTE              nRegX;
+		BYTE              nRegY;
+	};
+
+	struct DisasmCacheKey_t
+	{
+		const Opcodes_t* pOpcodes; // 6502 or 65C02
+		int      iConfigDisasmTargets;
+		int      iConfigDisasmBranchType;
+		bool     bConfigDisasmOpcodeSpaces;
+		int      bDisplaySymbolTables;
+		uint32_t nBreakpointsHash;
+
+		bool operator == (const DisasmCacheKey_t& rhs) const
+		{
+			return (pOpcodes                  == rhs.pOpcodes                 )
+				&& (iConfigDisasmTargets      == rhs.iConfigDisasmTargets     )
+				&& (iConfigDisasmBranchType   == rhs.iConfigDisasmBranchType  )
+				&& (bConfigDisasmOpcodeSpaces == rhs.bConfigDisasmOpcodeSpaces)
+				&& (bDisplaySymbolTables      == rhs.bDisplaySymbolTables     )
+				&& (nBreakpointsHash          == rhs.nBreakpointsHash         );
+		}
+	};
+
+	static uint32_t          g_nDisasmCacheGeneration = 1;
+	static DisasmCacheKey_t  g_tDisasmCacheKey;
+	static DisasmCachePage_t g_aDisasmCachePages[ _6502_NUM_PAGES ];
+
+	static std::unordered_map<WORD, DisasmCacheEntry_t> g_mDisasmCacheLines;
+
+	// Line start index for the current top address
+	static WORD                  g_nDisasmCacheTopAddress = 0;
+	static uint32_t              g_nDisasmCacheRowsGeneration = 0;
+	static std::vector<WORD>     g_aDisasmCacheRows;
+	static std::vector<BYTE>     g_aDisasmCacheRowPages;         // pages spanned by the rows
+	static std::vector<uint32_t> g_aDisasmCacheRowPageVersions;
+
+
+//===========================================================================
+static void DisasmCacheReadPage( BYTE iPage, BYTE* pData_ )
+{
+	if (GetIsMemCacheValid())
+	{
+		memcpy( pData_, mem + (iPage << 8), _6502_PAGE_SIZE );
+		return;
+	}
+
+	for (int iByte = 0; iByte < _6502_PAGE_SIZE; iByte++)
+		pData_[ iByte ] = ReadByteFromMemory( (WORD)((iPage << 8) + iByte) );
+}
+
+//===========================================================================
+static uint32_t DisasmCacheTrackPage( BYTE iPage )
+{
+	DisasmCachePage_t& page = g_aDisasmCachePages[ iPage ];
+	if (!page.bTracked)
+	{
+		DisasmCacheReadPage( iPage, page.aData );
+		page.bTracked = true;
+		page.nVersion++;
+	}
+	return page.nVersion;
+}
+
+//===========================================================================
+static DisasmCacheKey_t DisasmCacheGetKey()
+{
+	DisasmCacheKey_t key;
+	key.pOpcodes                  = g_aOpcodes;
+	key.iConfigDisasmTargets      = g_iConfigDisasmTargets;
+	key.iConfigDisasmBranchType   = g_iConfigDisasmBranchType;
+	key.bConfigDisasmOpcodeSpaces = g_bConfigDisasmOpcodeSpaces;
+	key.bDisplaySymbolTables      = g_bDisplaySymbolTables;
+
+	// FNV-1a of the fields displayed by GetBreakpointInfo()
+	uint32_t nHash = 2166136261u;
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		const Breakpoint_t& bp = g_aBreakpoints[ iBreakpoint ];
+		const uint32_t aField[4] = { bp.nAddress, bp.nLength, bp.bSet, bp.bEnabled };
+		for (int iField = 0; iField < 4; iField++)
+			nHash = (nHash ^ aField[ iField ]) * 16777619u;
+	}
+	key.nBreakpointsHash = nHash;
+
+	return key;
+}
+
+//===========================================================================
+void DisasmCacheInvalidate()
+{
+	g_nDisasmCacheGeneration++;
+}
+
+//===========================================================================
+void DisasmCacheUpdate()
+{
+	const DisasmCacheKey_t key = DisasmCacheGetKey();
+	if (!(key == g_tDisasmCacheKey))
+	{
+		g_tDisasmCacheKey = key;
+		DisasmCacheInvalidate();
+	}
+
+	if (g_mDisasmCacheLines.size() > DISASM_CACHE_MAX_LINES)
+		g_mDisasmCacheLines.clear();
+
+	BYTE aData[ _6502_PAGE_SIZE ];
+	for (int iPage = 0; iPage < _6502_NUM_PAGES; iPage++)
+	{
+		DisasmCachePage_t& page = g_aDisasmCachePages[ iPage ];
+		if (!page.bTracked)
+			continue;
+
+		DisasmCacheReadPage( (BYTE) iPage, aData );
+		if (memcmp( aData, page.aData, _6502_PAGE_SIZE ))
+		{
+			memcpy( page.aData, aData, _6502_PAGE_SIZE );
+			page.nVersion++;
+		}
+	}
+}
+
+//===========================================================================
+static bool DisasmCacheIsValid( const DisasmCacheEntry_t& entry )
+{
+	if (entry.nGeneration != g_nDisasmCacheGeneration || entry.nPages < 0)
+		return false;
+
+	for (int iPage = 0; iPage < entry.nPages; iPage++)
+	{
+		if (g_aDisasmCachePages[ entry.aPage[ iPage ] ].nVersion != entry.aPageVersion[ iPage ])
+			return false;
+	}
+
+	if (entry.bIndexed && ((entry.nRegX != regs.x) || (entry.nRegY != regs.y)))
+		return false;
+
+	return true;
+}
+
+//===========================================================================
+static void DisasmCacheAddDependency( DisasmCacheEntry_t& entry_, WORD nAddress )
+{
+	if (entry_.nPages < 0)
+		return;
+
+	const BYTE iPage = (BYTE)(nAddress >> 8);
+	for (int i = 0; i < entry_.nPages; i++)
+	{
+		if (entry_.aPage[ i ] == iPage)
+			return;
+	}
+
+	if (entry_.nPages == DISASM_CACHE_MAX_DEPENDENCIES)
+	{
+		entry_.nPages = -1;
+		return;
+	}
+
+	entry_.aPage       [ entry_.nPages ] = iPage;
+	entry_.aPageVersion[ entry_.nPages ] = DisasmCacheTrackPage( iPage );
+	entry_.nPages++;
+}
+
+//===========================================================================
+const DisasmCacheLine_t& DisasmCacheGetLine( WORD nAddress )
+{
+	DisasmCacheEntry_t& entry = g_mDisasmCacheLines[ nAddress ];
+	if (DisasmCacheIsValid( entry ))
+		return entry.data;
+
+	DisasmCacheLine_t& data = entry.data;
+	data.iTable  = NUM_SYMBOL_TABLES;
+	data.pSymbol = FindSymbolFromAddress( nAddress, &data.iTable );
+	data.bDisasmFormatFlags = GetDisassemblyLine( nAddress, data.line );
+	GetBreakpointInfo( nAddress, data.bBreakpointActive, data.bBreakpointEnable );
+
+	entry.nGeneration = g_nDisasmCacheGeneration;
+	entry.nPages      = 0;
+	entry.bIndexed    = data.line.bTargetX || data.line.bTargetY;
+	entry.nRegX       = regs.x;
+	entry.nRegY       = regs.y;
+
+	// Instruction (or data directive) bytes
+	const int nBytes = std::max( data.line.nOpbyte, 1 );
+	for (int iByte = 0; iByte < nBytes; iByte += _6502_PAGE_SIZE)
+		DisasmCacheAddDependency( entry, nAddress + iByte );
+	DisasmCacheAddDependency( entry, nAddress + nBytes - 1 );
+
+	if (data.line.pDisasmData)
+	{
+		DisasmCacheAddDependency( entry, data.line.pDisasmData->nStartAddress );
+		DisasmCacheAddDependency( entry, data.line.pDisasmData->nEndAddress );
+	}
+
+	// Indirect pointer and target value, see GetDisassemblyLine()
+	if (data.bDisasmFormatFlags & DISASM_FORMAT_TARGET_POINTER)
+	{
+		int nTargetPartial;
+		int nTargetPartial2;
+		int nTargetPointer;
+		_6502_GetTargets( nAddress, &nTargetPartial, &nTargetPartial2, &nTargetPointer, NULL );
+
+		DisasmCacheAddDependency( entry, data.line.nTarget );
+		DisasmCacheAddDependency( entry, data.line.nTarget + 1 );
+		if (nTargetPointer != NO_6502_TARGET)
+		{
+			DisasmCacheAddDependency( entry, nTargetPointer );
+			DisasmCacheAddDependency( entry, nTargetPointer + 1 );
+		}
+		entry.bIndexed = true; // indirect targets also depend on registers
+	}
+
+	return data;
+}
+
+//===========================================================================
+WORD DisasmCacheGetRowAddress( WORD nTopAddress, int iRow )
+{
+	bool bValid = (nTopAddress == g_nDisasmCacheTopAddress)
+	           && (g_nDisasmCacheRowsGeneration == g_nDisasmCacheGeneration)
+	           && !g_aDisasmCacheRows.empty();
+
+	for (size_t iPage = 0; bValid && (iPage < g_aDisasmCacheRowPages.size()); iPage++)
+	{
+		if (g_aDisasmCachePages[ g_aDisasmCacheRowPages[ iPage ] ].nVersion != g_aDisasmCacheRowPageVersions[ iPage ])
+			bValid = false;
+	}
+
+	if (!bValid)
+	{
+		g_nDisasmCacheTopAddress     = nTopAddress;
+		g_nDisasmCacheRowsGeneration = g_nDisasmCacheGeneration;
+		g_aDisasmCacheRows.assign( 1, nTopAddress );
+		g_aDisasmCacheRowPages.clear();
+		g_aDisasmCacheRowPageVersions.clear();
+	}
+
+	while ((int)g_aDisasmCacheRows.size() <= iRow)
+	{
+		const WORD nAddress = g_aDisasmCacheRows.back();
+
+		int iOpmode;
+		int nOpbytes;
+		_6502_GetOpmodeOpbyte( nAddress, iOpmode, nOpbytes );
+
+		// The index depends on every page an instruction was read from
+		for (int iByte = 0; iByte < nOpbytes; iByte++)
+		{
+			const BYTE iPage = (BYTE)((nAddress + iByte) >> 8);
+			if (std::find( g_aDisasmCacheRowPages.begin(), g_aDisasmCacheRowPages.end(), iPage ) == g_aDisasmCacheRowPages.end())
+			{
+				g_aDisasmCacheRowPages.push_back( iPage );
+				g_aDisasmCacheRowPageVersions.push_back( DisasmCacheTrackPage( iPage ) );
+			}
+		}
+
+		g_aDisasmCacheRows.push_back( nAddress + nOpbytes );
+	}
+
+	return g_aDisasmCacheRows[ iRow ];
+}
@@ -19,3 +19,19 @@ void DisasmCalcCurFromTopAddress();
 void DisasmCalcBotFromTopAddress();
 void DisasmCalcTopBotAddress();
 WORD DisasmCalcAddressFromLines(WORD iAddress, int nLines);
+
+// Disassembly Cache
+struct DisasmCacheLine_t
+{
+	DisasmLine_t       line;
+	int                bDisasmFormatFlags;
+	std::string const* pSymbol; // symbol at this address (not the target), may be NULL
+	int                iTable;  // table of pSymbol
+	bool               bBreakpointActive;
+	bool               bBreakpointEnable;
+};
+
+void DisasmCacheInvalidate();
+void DisasmCacheUpdate(); // once per displayed frame, before the lookups below
+const DisasmCacheLine_t& DisasmCacheGetLine(WORD nAddress);
+WORD DisasmCacheGetRowAddress(WORD nTopAddress, int iRow);
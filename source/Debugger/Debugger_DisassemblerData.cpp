@@ -704,6 +704,7 @@ DisasmData_t* Disassembly_IsDataAddress ( WORD nAddress )
 void Disassembly_AddData( DisasmData_t tData)
 {
 	g_aDisassemblerData.push_back( tData );
+	DisasmCacheInvalidate(); // may have moved the DisasmData_t the cached lines point to
 }
 
 // DEPRECATED ! Inlined in _6502_GetOpmodeOpbyte() !
@@ -739,6 +740,7 @@ void Disassembly_DelData( DisasmData_t tData)
 				if ((nAddress >= pData->nStartAddress) && (nAddress <= pData->nEndAddress))
 				{
 					pData->iDirective = _NOP_REMOVED;
+					DisasmCacheInvalidate();
 
 					// TODO: delete from vector?
 				}
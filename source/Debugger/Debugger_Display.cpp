@@ -1381,14 +1381,15 @@ WORD DrawDisassemblyLine ( int iLine, const WORD nBaseAddress )
 //	int iOpcode;
 	int iOpmode;
 	int nOpbyte;
-	DisasmLine_t line;
+	const DisasmCacheLine_t& cached = DisasmCacheGetLine( nBaseAddress );
+	DisasmLine_t line = cached.line; // copy: sTarget is truncated in place below
 
-	int iTable = NUM_SYMBOL_TABLES;
-	std::string const* pSymbol = FindSymbolFromAddress( nBaseAddress, &iTable );
+	int iTable = cached.iTable;
+	std::string const* pSymbol = cached.pSymbol;
 	const char* pMnemonic = NULL;
 
 	// Data Disassembler
-	int bDisasmFormatFlags = GetDisassemblyLine( nBaseAddress, line );
+	int bDisasmFormatFlags = cached.bDisasmFormatFlags;
 	const DisasmData_t *pData = line.pDisasmData;
 
 //	iOpcode = line.iOpcode;	
@@ -1475,9 +1476,8 @@ WORD DrawDisassemblyLine ( int iLine, const WORD nBaseAddress )
 	linerect.right  = DISPLAY_DISASM_RIGHT;
 	linerect.bottom = linerect.top + nFontHeight;
 
-	bool bBreakpointActive;
-	bool bBreakpointEnable;
-	GetBreakpointInfo( nBaseAddress, bBreakpointActive, bBreakpointEnable );
+	bool bBreakpointActive = cached.bBreakpointActive;
+	bool bBreakpointEnable = cached.bBreakpointEnable;
 	bool bAddressAtPC = (nBaseAddress == regs.pc);
 	int  bAddressIsBookmark = Bookmark_Find( nBaseAddress );
 
@@ -2952,14 +2952,14 @@ void DrawSoftSwitches( int iSoftSwitch )
 
 
 //===========================================================================
-void DrawSourceLine( int iSourceLine, RECT &rect )
+void DrawSourceLine( const SourceInfoFile_t *pFile, int iSourceLine, RECT &rect )
 {
 	char sLine[ CONSOLE_WIDTH ];
 	memset( sLine, 0, CONSOLE_WIDTH );
 
-	if ((iSourceLine >=0) && (iSourceLine < g_AssemblerSourceBuffer.GetNumLines() ))
+	if (pFile && (iSourceLine >=0) && (iSourceLine < (int) pFile->aText.size() ))
 	{
-		char * pSource = g_AssemblerSourceBuffer.GetLine( iSourceLine );
+		const char * pSource = pFile->aText[ iSourceLine ].c_str();
 
 //		int nLenSrc = strlen( pSource );
 //		if (nLenSrc >= CONSOLE_WIDTH)
@@ -3741,8 +3741,17 @@ void DrawSubWindow_Source2 (Update_t bUpdate)
 	rect.left = 0;
 	rect.right = DISPLAY_DISASM_RIGHT; // HACK: MAGIC #: 7
 
+	// The file & scope of the PC
+	const SourceInfoRange_t *pLine  = g_SourceInfo.FindLine ( regs.pc );
+	const SourceInfoRange_t *pScope = g_SourceInfo.FindScope( regs.pc );
+	const SourceInfoFile_t  *pFile  = pLine ? &g_SourceInfo.GetFile( g_SourceInfo.GetLine( pLine->iItem ).iFile ) : NULL;
+
 // Draw Title
-	std::string sTitle = "   Source: " + g_aSourceFileName;
+	std::string sTitle = "   Source: ";
+	if (pFile)
+		sTitle += pFile->sName;
+	if (pScope && ! g_SourceInfo.GetScope( pScope->iItem ).sName.empty())
+		sTitle += "  " + g_SourceInfo.GetScope( pScope->iItem ).sName;
 	sTitle.resize(MIN(sTitle.size(), size_t(g_nConsoleDisplayWidth)));
 
 	DebuggerSetColorBG( DebuggerGetColor( BG_SOURCE_TITLE ));
@@ -3755,7 +3764,7 @@ void DrawSubWindow_Source2 (Update_t bUpdate)
 	int iForeground;
 
 	int iSourceCursor = 2; // (g_nDisasmWinHeight / 2);
-	int iSourceLine = FindSourceLine( regs.pc );
+	int iSourceLine = pLine ? g_SourceInfo.GetLine( pLine->iItem ).nLine - 1 : NO_SOURCE_LINE;
 
 	if (iSourceLine == NO_SOURCE_LINE)
 	{
@@ -3763,9 +3772,9 @@ void DrawSubWindow_Source2 (Update_t bUpdate)
 	}
 	else
 	{
+		if (iSourceLine < iSourceCursor) // near the top of the file
+			iSourceCursor = iSourceLine;
 		iSourceLine -= iSourceCursor;
-		if (iSourceLine < 0)
-			iSourceLine = 0;
 	}
 
 	for ( int iLine = 0; iLine < nLines; iLine++ )
@@ -3786,7 +3795,7 @@ void DrawSubWindow_Source2 (Update_t bUpdate)
 		DebuggerSetColorBG( DebuggerGetColor( iBackground ));
 		DebuggerSetColorFG( DebuggerGetColor( iForeground ));
 
-		DrawSourceLine( iSourceLine, rect );
+		DrawSourceLine( pFile, iSourceLine, rect );
 		iSourceLine++;
 	}
 }
@@ -4023,6 +4032,8 @@ void DrawSubWindow_Code ( int iWindow )
 	SelectObject( GetDebuggerMemDC(), g_aFontConfig[ FONT_DISASM_DEFAULT ]._hFont );
 #endif
 
+	DisasmCacheUpdate();
+
 	WORD nAddress = g_nDisasmTopAddress; // g_nDisasmCurAddress;
 	for (int iLine = 0; iLine < nLines; iLine++ )
 	{
@@ -511,7 +511,7 @@ Update_t CmdHelpSpecific (int nArgs)
 			switch ( iParam )
 			{
 				case PARAM_CAT_BOOKMARKS  : iCmdBegin = CMD_BOOKMARK        ; iCmdEnd = CMD_BOOKMARK_SAVE        ; break;
-				case PARAM_CAT_BREAKPOINTS: iCmdBegin = CMD_BREAK_INVALID   ; iCmdEnd = CMD_BREAKPOINT_CHANGE    ; break;
+				case PARAM_CAT_BREAKPOINTS: iCmdBegin = CMD_BREAK_INVALID   ; iCmdEnd = CMD_BREAKPOINT_HIT_COUNT ; break;
 				case PARAM_CAT_CONFIG     : iCmdBegin = CMD_BENCHMARK       ; iCmdEnd = CMD_CONFIG_SET_DEBUG_DIR; break;
 				case PARAM_CAT_CPU        : iCmdBegin = CMD_ASSEMBLE        ; iCmdEnd = CMD_UNASSEMBLE           ; break;
 				case PARAM_CAT_FLAGS      :
@@ -669,7 +669,7 @@ Update_t CmdHelpSpecific (int nArgs)
 			if (iCmd <= CMD_BOOKMARK_SAVE)
 				pCategory = g_aParameters[ PARAM_CAT_BOOKMARKS ].m_sName;
 			else
-			if (iCmd <= CMD_BREAKPOINT_SAVE)
+			if (iCmd <= CMD_BREAKPOINT_HIT_COUNT)
 				pCategory = g_aParameters[ PARAM_CAT_BREAKPOINTS ].m_sName;
 			else
 			if (iCmd <= CMD_CONFIG_SET_DEBUG_DIR)
@@ -757,6 +757,14 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleColorizePrint( " Usage: [address | symbol]" );
 			ConsoleBufferPush( " Enter mini-assembler mode [starting at optional address or symbol]." );
 			break;
+		case CMD_ASSEMBLE_SOURCE:
+			ConsoleColorizePrint( " Usage: filename" );
+			ConsoleBufferPush( "  Assembles a Merlin style source (labels, expressions, MAC, PUT) into memory." );
+			ConsoleBufferPush( "  Code before the first ORG starts at $0800." );
+			ConsoleBufferPush( "  The labels replace the SYMSRC symbol table." );
+			Help_Examples();
+			ConsolePrintFormat( "%s   %s hello.s", CHC_EXAMPLE, pCommand->m_sName );
+			break;
 		case CMD_UNASSEMBLE:
 			ConsoleColorizePrint( " Usage: [address | symbol]" );
 			ConsoleBufferPush( "  Disassembles memory." );
@@ -785,6 +793,13 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleColorizePrint( " Usage: [address8 | address16 | symbol] ## [##]" );
 			ConsoleBufferPush( "  Output a byte or word to the IO address $C0xx" );
 			break;
+		case CMD_BENCHMARK:
+			ConsoleColorizePrintFormat( " Usage: [%s [#]]", g_aParameters[ PARAM_SRC_SYMBOLS ].m_sName );
+			ConsoleBufferPush( " No arguments toggles the CPU benchmark." );
+			ConsoleBufferPush( " SYM loads # generated symbols (default 50000 = $C350) and times the lookups." );
+			Help_Examples();
+			ConsolePrintFormat( "%s  BENCHMARK SYM C350", CHC_EXAMPLE );
+			break;
 		case CMD_PROFILE:
 			ConsoleColorizePrintFormat( " Usage: [%s | %s | %s]"
 				, g_aParameters[ PARAM_RESET ].m_sName
@@ -813,12 +828,17 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleColorizePrintFormat( " Usage: [ %s | %s ] \"filename\""          , g_aParameters[ PARAM_SRC_MEMORY  ].m_sName, g_aParameters[ PARAM_SRC_SYMBOLS ].m_sName );
 			ConsoleBufferPushFormat( "   %s: read source bytes into memory."        , g_aParameters[ PARAM_SRC_MEMORY  ].m_sName );
 			ConsoleBufferPushFormat( "   %s: read symbols into Source symbol table.", g_aParameters[ PARAM_SRC_SYMBOLS ].m_sName );
-			ConsoleBufferPushFormat( " Supports: %s."                               , g_aParameters[ PARAM_SRC_MERLIN  ].m_sName );
+			ConsoleBufferPushFormat( " Supports: %s listing, cc65 .dbg (ld65 --dbgfile)", g_aParameters[ PARAM_SRC_MERLIN  ].m_sName );
+			ConsoleBufferPush( " No filename: stops source level debugging." );
 			break;
 		case CMD_STEP_OUT: 
 			ConsoleBufferPush( "  Steps out of current subroutine" );
 			ConsoleBufferPush( "  Hotkey: Ctrl-Space" ); // TODO: FIXME
 			break;
+		case CMD_STEP_OVER_SOURCE:
+			ConsoleBufferPush( "  Runs until the next source line (see SOURCE, ASM)" );
+			ConsoleBufferPush( "  JSR will be stepped into AND out of." );
+			break;
 		case CMD_STEP_OVER: // Bad name? FIXME/TODO: do we need to rename?
 			ConsoleColorizePrint( " Usage: [#]" );
 			ConsoleBufferPush( "  Steps, # times, thru current instruction" );
@@ -831,6 +851,10 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleBufferPush( "  JSR will be stepped into" );
 			ConsoleBufferPush( "  Hotkey: Shift-Space" );
 			break;
+		case CMD_TRACE_SOURCE:
+			ConsoleBufferPush( "  Runs until the next source line (see SOURCE, ASM)" );
+			ConsoleBufferPush( "  JSR will be stepped into" );
+			break;
 		case CMD_TRACE_FILE:
 			ConsoleColorizePrint( " Usage: \"[filename]\" [v]" );
 			break;
@@ -964,6 +988,37 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsolePrintFormat("%s   %s 01/00FF         ; break on memory for aux at $00FF", CHC_EXAMPLE, pCommand->m_sName);
 			ConsolePrintFormat("%s   %s ROM/FF58        ; break on ROM read at $FF58", CHC_EXAMPLE, pCommand->m_sName);
 			break;
+		case CMD_BREAKPOINT_ADD_COND:
+		case CMD_BREAKPOINT_ADD_TRACE:
+			ConsoleColorizePrint( " Usage: <expression>" );
+			if (iCommand == CMD_BREAKPOINT_ADD_COND)
+				ConsoleBufferPush( "  Stop when the expression is true, checked every instruction." );
+			else
+				ConsoleBufferPush( "  Log the registers when the expression is true, without stopping." );
+			ConsoleBufferPush( "  Registers: A X Y PC S P, Flags: C Z I D B V N" );
+			ConsoleBufferPush( "  Memory: [addr] or mem[addr] (byte), w[addr] (word)" );
+			ConsoleBufferPush( "  Operators: = == != < <= > >= + - & | ^ ~ and or not && || !" );
+			ConsoleBufferPush( "  Values are hex; use $ for hex that is also a register name, # for decimal." );
+			Help_Examples();
+			ConsolePrintFormat( "%s   %s PC=$0800 and A>=80 and mem[FA]==3", CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( "%s   %s (PC=FDED) && (A & 7F) == 0D", CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( "%s   %s w[3C] >= #1000 and not C", CHC_EXAMPLE, pCommand->m_sName );
+			break;
+		case CMD_BREAKPOINT_CONDITION:
+			ConsoleColorizePrint( " Usage: # [expression]" );
+			ConsoleBufferPush( "  Only hit breakpoint # when the expression is also true." );
+			ConsoleBufferPush( "  No expression removes the condition." );
+			ConsoleColorizePrintFormat( " See also: %s%s", CHC_COMMAND, g_aCommands[ CMD_BREAKPOINT_ADD_COND ].m_sName );
+			Help_Examples();
+			ConsolePrintFormat( "%s   %s 0 X=0 and [FA] != 0", CHC_EXAMPLE, pCommand->m_sName );
+			break;
+		case CMD_BREAKPOINT_HIT_COUNT:
+			ConsoleColorizePrint( " Usage: # <count>" );
+			ConsoleBufferPush( "  Keep counting hits, but only stop once breakpoint # has been hit <count> times." );
+			ConsoleBufferPush( "  A count of 0 stops on every hit." );
+			Help_Examples();
+			ConsolePrintFormat( "%s   %s 0 10    // stop on the 16th hit", CHC_EXAMPLE, pCommand->m_sName );
+			break;
 		case CMD_BREAKPOINT_ADD_VIDEO:
 			ConsoleColorizePrint( " Usage: <vpos[,length]>" );
 			break;
@@ -0,0 +1,1439 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2010, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Source Assembler
+ *
+ * Two-pass assembler for multi-line sources, in Merlin syntax:
+ *
+ *    label   opcode  operand   comment
+ *
+ * . A label starts in column 1 (a trailing ':' is dropped). :name is local to the previous global label.
+ * . '*' or ';' in column 1, or ';' at the start of a field, is a comment.
+ *   The operand ends at the first space outside quotes, so a comment can follow without ';'.
+ * . 6502 opcodes, and the 65C02 ones on a 65C02 or after XC.  LDA: forces absolute addressing.
+ * . Operands: #expr #<expr #>expr  expr  expr,X  expr,Y  (expr,X)  (expr),Y  (expr)
+ *   Zero page is used when the value is known in pass 1 and < $100.
+ * . Expressions: $hex %binary decimal 'c' "c" (high bit set) * (current address) symbols,
+ *   unary - ~ < (low byte) > (high byte), then * / + - << >> & ! ^ (eor) | with C precedence, and ( ).
+ *   #< #> and a leading < > in DFB apply to the whole expression, as in Merlin.
+ * . Directives:
+ *     ORG expr        EQU expr (or =)    DFB/DB expr,...    DA/DW expr,...    DDB expr,... (big endian)
+ *     HEX 0102FF      ASC "text"[hex]    DCI "text"[hex]    DS count[,fill] or DS \ (to the next page)
+ *     PUT/USE file    END                XC [OFF]
+ *     name MAC ... EOM (or <<<), called as: name arg1;arg2 (or PMC/>>> name.arg1;arg2)
+ *     In the body, ]1 to ]9 are the arguments; :local labels are local to each call.
+ *   ASC & DCI set the high bit when the delimiter is below ' (ie. "), as in Merlin.
+ *   Listing & object file directives (LST, TR, SAV, DSK, ...) are ignored.
+ *
+ * Pass 0 reads the files, expands PUT & macros into one list of statements;
+ * pass 1 defines the symbols and picks the addressing modes; pass 2 evaluates & emits.
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+#include "Debugger_SourceAssembler.h"
+
+#include "../CPU.h"
+#include "../Memory.h"
+
+#include <deque>
+#include <unordered_map>
+
+// Keywords _________________________________________________________________
+
+	enum SourceAsmDirective_e
+	{
+		  SRC_DIR_NONE
+		, SRC_DIR_ORG
+		, SRC_DIR_EQU
+		, SRC_DIR_DFB
+		, SRC_DIR_DA
+		, SRC_DIR_DDB
+		, SRC_DIR_HEX
+		, SRC_DIR_ASC
+		, SRC_DIR_DCI
+		, SRC_DIR_DS
+		, SRC_DIR_PUT
+		, SRC_DIR_END
+		, SRC_DIR_XC
+		, SRC_DIR_MAC
+		, SRC_DIR_EOM
+		, SRC_DIR_PMC
+		, SRC_DIR_IGNORE
+	};
+
+	struct SourceAsmDirective_t
+	{
+		const char          *m_pName     ;
+		SourceAsmDirective_e m_eDirective;
+	};
+
+	const SourceAsmDirective_t g_aSourceAsmDirectives[] =
+	{
+		{"ORG"    , SRC_DIR_ORG   },
+		{"EQU"    , SRC_DIR_EQU   },
+		{"="      , SRC_DIR_EQU   },
+		{"DFB"    , SRC_DIR_DFB   },
+		{"DB"     , SRC_DIR_DFB   },
+		{"DA"     , SRC_DIR_DA    },
+		{"DW"     , SRC_DIR_DA    },
+		{"DDB"    , SRC_DIR_DDB   },
+		{"HEX"    , SRC_DIR_HEX   },
+		{"ASC"    , SRC_DIR_ASC   },
+		{"DCI"    , SRC_DIR_DCI   },
+		{"DS"     , SRC_DIR_DS    },
+		{"PUT"    , SRC_DIR_PUT   },
+		{"USE"    , SRC_DIR_PUT   },
+		{"INCLUDE", SRC_DIR_PUT   },
+		{"END"    , SRC_DIR_END   },
+		{"XC"     , SRC_DIR_XC    },
+		{"MAC"    , SRC_DIR_MAC   },
+		{"EOM"    , SRC_DIR_EOM   },
+		{"<<<"    , SRC_DIR_EOM   },
+		{"PMC"    , SRC_DIR_PMC   },
+		{">>>"    , SRC_DIR_PMC   },
+		// Listing & object file
+		{"LST"    , SRC_DIR_IGNORE},
+		{"LSTDO"  , SRC_DIR_IGNORE},
+		{"EXP"    , SRC_DIR_IGNORE},
+		{"TR"     , SRC_DIR_IGNORE},
+		{"PAG"    , SRC_DIR_IGNORE},
+		{"SKP"    , SRC_DIR_IGNORE},
+		{"TTL"    , SRC_DIR_IGNORE},
+		{"CYC"    , SRC_DIR_IGNORE},
+		{"AST"    , SRC_DIR_IGNORE},
+		{"DAT"    , SRC_DIR_IGNORE},
+		{"SAV"    , SRC_DIR_IGNORE},
+		{"DSK"    , SRC_DIR_IGNORE},
+		{"TYP"    , SRC_DIR_IGNORE},
+		{"OBJ"    , SRC_DIR_IGNORE},
+	};
+
+	enum
+	{
+		SRC_ASM_MAX_DEPTH  = 16, // nested PUT & macro calls
+		SRC_ASM_MAX_ERRORS = 50,
+		SRC_ASM_MAX_ARGS   =  9, // ]1 .. ]9
+	};
+
+	struct SourceAsmMnemonic_t
+	{
+		const char *m_pName;
+		short       m_aOpcode[ 2 ][ NUM_ADDRESSING_MODES ]; // [0] 6502, [1] 65C02, -1 = n/a
+	};
+
+	struct SourceAsmKeywords_t
+	{
+		std::vector<SourceAsmMnemonic_t>      m_aMnemonics;
+		std::unordered_map<std::string, int> m_aKeywords ; // upper case -> mnemonic (>= 0) or -directive
+	};
+
+//===========================================================================
+static SourceAsmKeywords_t _SourceAsmHashKeywords ()
+{
+	SourceAsmKeywords_t keywords;
+
+	// lower case mnemonics are the invalid opcodes, or not on this CPU
+	const Opcodes_t *aTables[ 2 ] = { g_aOpcodes6502, g_aOpcodes65C02 };
+	for ( int iCpu = 0; iCpu < 2; iCpu++ )
+	{
+		for ( int iOpcode = 0; iOpcode < NUM_OPCODES; iOpcode++ )
+		{
+			const Opcodes_t & opcode = aTables[ iCpu ][ iOpcode ];
+			if (islower( opcode.sMnemonic[ 0 ] ))
+				continue;
+
+			std::unordered_map<std::string, int>::iterator iKeyword = keywords.m_aKeywords.find( opcode.sMnemonic );
+			if (iKeyword == keywords.m_aKeywords.end())
+			{
+				SourceAsmMnemonic_t mnemonic;
+				mnemonic.m_pName = opcode.sMnemonic;
+				memset( mnemonic.m_aOpcode, 0xFF, sizeof( mnemonic.m_aOpcode ));
+				keywords.m_aMnemonics.push_back( mnemonic );
+				iKeyword = keywords.m_aKeywords.emplace( opcode.sMnemonic, (int) keywords.m_aMnemonics.size() - 1 ).first;
+			}
+
+			short & nOpcode = keywords.m_aMnemonics[ iKeyword->second ].m_aOpcode[ iCpu ][ opcode.nAddressMode ];
+			if (nOpcode < 0)
+				nOpcode = (short) iOpcode;
+		}
+	}
+
+	for ( const SourceAsmDirective_t & directive : g_aSourceAsmDirectives )
+		keywords.m_aKeywords.emplace( directive.m_pName, -directive.m_eDirective );
+
+	return keywords;
+}
+
+//===========================================================================
+static const SourceAsmKeywords_t & _SourceAsmGetKeywords ()
+{
+	static const SourceAsmKeywords_t keywords = _SourceAsmHashKeywords();
+	return keywords;
+}
+
+
+// Assembler ________________________________________________________________
+
+	struct SourceAsmStatement_t
+	{
+		const char          *m_pLabel    ; // points into the source, not terminated
+		const char          *m_pOperand  ;
+		int                  m_nLabel    ;
+		int                  m_nOperand  ;
+		int                  m_iMnemonic ; // -1 if none
+		SourceAsmDirective_e m_eDirective;
+		int                  m_iFile     ;
+		int                  m_nLine     ;
+		int                  m_iExpansion; // macro call #, 0 = none
+		bool                 m_bAbsolute ; // LDA: forces absolute
+		BYTE                 m_iOpmode   ; // picked in pass 1
+	};
+
+	struct SourceAsmMacro_t
+	{
+		std::vector<std::string> m_aLines;
+	};
+
+	struct SourceAsmSymbol_Value_t
+	{
+		int  m_nValue;
+		int  m_iPass ; // defined in
+		bool m_bEquate;
+	};
+
+	class SourceAssembler_t
+	{
+	public:
+		SourceAssembler_t( SourceAsmResult_t & result, const WORD nOrigin );
+
+		bool Assemble( const std::string & sText, const std::string & sFileName );
+
+	private:
+		// Pass 0
+		void LoadText   ( const char *pText, const char *pEnd, const int iFile, const int nDepth );
+		bool LoadLine   ( const char *pLine, const char *pEnd, const int iFile, const int nLine, const int iExpansion, const int nDepth );
+		void LoadPut    ( const SourceAsmStatement_t & statement, const int nDepth );
+		void LoadMacro  ( const SourceAsmMacro_t & macro, const char *pArgs, const char *pEnd, const int iFile, const int nLine, const int nDepth );
+
+		// Pass 1 & 2
+		void Pass       ( const int iPass );
+		void Define     ( const SourceAsmStatement_t & statement, const int nValue, const bool bEquate );
+		void Instruction( SourceAsmStatement_t & statement );
+		void Directive  ( const SourceAsmStatement_t & statement );
+		void Emit       ( const BYTE nByte );
+
+		// Expressions
+		bool Eval       ( const char *pBegin, const char *pEnd, int & nValue_, bool & bKnown_ );
+		bool EvalItem   ( const char *pBegin, const char *pEnd, int & nValue_, bool & bKnown_ ); // with Merlin's leading < >
+		bool EvalKnown  ( const char *pBegin, const char *pEnd, int & nValue_ );
+		bool ParseBinary( const char *& p, const char *pEnd, const int nMinPrecedence, int & nValue_, bool & bKnown_ );
+		bool ParseUnary ( const char *& p, const char *pEnd, int & nValue_, bool & bKnown_ );
+		bool ParseString( const char *p, const char *pEnd, const bool bInvertLast );
+
+		std::string Qualify( const char *pName, const int nLen ) const;
+		void Error( const char *pFormat, ... ) ATTRIBUTE_FORMAT_PRINTF(2, 3);
+
+		SourceAsmResult_t                                        & m_result;
+		const SourceAsmKeywords_t                                & m_keywords;
+		const WORD                                                 m_nOrigin;
+
+		std::deque<std::string>                                    m_aTexts     ; // PUT files & macro expansions: statements point into these
+		std::vector<SourceAsmStatement_t>                          m_aStatements;
+		std::unordered_map<std::string, SourceAsmMacro_t>          m_aMacros    ;
+		SourceAsmMacro_t                                          *m_pDefining  ; // MAC ... EOM
+		int                                                        m_nExpansions;
+		std::unordered_map<std::string, SourceAsmSymbol_Value_t>   m_aSymbols   ;
+
+		int          m_iPass  ;
+		int          m_nPC    ;
+		bool         m_b65C02 ;
+		std::string  m_sScope ; // last global label, for :local labels
+		int          m_iFile  ; // for Error()
+		int          m_nLine  ;
+		const SourceAsmStatement_t *m_pStatement;
+	};
+
+
+// Text _____________________________________________________________________
+
+//===========================================================================
+static inline bool _IsSpace( const char c )
+{
+	return (c == ' ') || (c == '\t');
+}
+
+//===========================================================================
+static inline bool _IsSymbolChar( const char c )
+{
+	return isalnum( (unsigned char) c ) || (c == '_') || (c == '.');
+}
+
+//===========================================================================
+static inline int _HexDigit( const char c )
+{
+	if ((c >= '0') && (c <= '9')) return c - '0';
+	if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+	if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+	return -1;
+}
+
+// Returns the end of a quoted string starting at p, ie. after the closing quote (or only the 1st character: Merlin's #'A)
+//===========================================================================
+static const char *_SkipQuoted( const char *p, const char *pEnd )
+{
+	const char cQuote = *p;
+	const char *pClose = (const char*) memchr( p + 1, cQuote, pEnd - p - 1 );
+	if (pClose)
+		return pClose + 1;
+	return MIN( p + 2, pEnd );
+}
+
+// Operand ends at the first space outside quotes
+//===========================================================================
+static const char *_SkipOperand( const char *p, const char *pEnd )
+{
+	while ((p < pEnd) && !_IsSpace( *p ))
+	{
+		if ((*p == '\'') || (*p == '"'))
+			p = _SkipQuoted( p, pEnd );
+		else
+			p++;
+	}
+	return p;
+}
+
+// Returns the matching ')' of the '(' at p, or pEnd
+//===========================================================================
+static const char *_FindCloseParen( const char *p, const char *pEnd )
+{
+	int nDepth = 0;
+	while (p < pEnd)
+	{
+		if ((*p == '\'') || (*p == '"'))
+		{
+			p = _SkipQuoted( p, pEnd );
+			continue;
+		}
+		if (*p == '(')
+			nDepth++;
+		else
+		if ((*p == ')') && (--nDepth == 0))
+			return p;
+		p++;
+	}
+	return pEnd;
+}
+
+// Returns the next ',' (or cSeparator) outside quotes & parentheses, or pEnd
+//===========================================================================
+static const char *_FindSeparator( const char *p, const char *pEnd, const char cSeparator = ',' )
+{
+	int nDepth = 0;
+	while (p < pEnd)
+	{
+		const char c = *p;
+		if ((c == '\'') || (c == '"'))
+		{
+			p = _SkipQuoted( p, pEnd );
+			continue;
+		}
+		if (c == '(')
+			nDepth++;
+		else
+		if (c == ')')
+			nDepth--;
+		else
+		if ((c == cSeparator) && !nDepth)
+			return p;
+		p++;
+	}
+	return pEnd;
+}
+
+//===========================================================================
+static bool _EndsWith( const char *pBegin, const char *pEnd, const char *pSuffix )
+{
+	const size_t nLen = strlen( pSuffix );
+	if ((size_t)(pEnd - pBegin) < nLen)
+		return false;
+	return _strnicmp( pEnd - nLen, pSuffix, nLen ) == 0;
+}
+
+//===========================================================================
+static bool _ReadFile( const std::string & sPathName, std::string & sText_ )
+{
+	FILE *hFile = fopen( sPathName.c_str(), "rb" );
+	if (! hFile)
+		return false;
+
+	char aBuffer[ 4096 ];
+	size_t nSize;
+	while ((nSize = fread( aBuffer, 1, sizeof( aBuffer ), hFile )) > 0)
+		sText_.append( aBuffer, nSize );
+
+	fclose( hFile );
+	return true;
+}
+
+
+// Pass 0: Statements _______________________________________________________
+
+//===========================================================================
+SourceAssembler_t::SourceAssembler_t( SourceAsmResult_t & result, const WORD nOrigin )
+	: m_result( result )
+	, m_keywords( _SourceAsmGetKeywords() )
+	, m_nOrigin( nOrigin )
+	, m_pDefining( NULL )
+	, m_nExpansions( 0 )
+	, m_iPass( 0 )
+	, m_nPC( nOrigin )
+	, m_b65C02( true )
+	, m_iFile( 0 )
+	, m_nLine( 0 )
+	, m_pStatement( NULL )
+{
+}
+
+//===========================================================================
+void SourceAssembler_t::Error( const char *pFormat, ... )
+{
+	if (m_result.aErrors.size() >= SRC_ASM_MAX_ERRORS)
+		return;
+
+	va_list va;
+	va_start( va, pFormat );
+	const std::string sMessage = StrFormatV( pFormat, va );
+	va_end( va );
+
+	const int iFile = m_pStatement ? m_pStatement->m_iFile : m_iFile;
+	const int nLine = m_pStatement ? m_pStatement->m_nLine : m_nLine;
+	m_result.aErrors.push_back( StrFormat( "%s(%d): %s", m_result.aFiles[ iFile ].c_str(), nLine, sMessage.c_str() ));
+}
+
+// Lines end with LF, CR+LF, or CR (Apple)
+//===========================================================================
+void SourceAssembler_t::LoadText( const char *pText, const char *pEnd, const int iFile, const int nDepth )
+{
+	int nLine = 0;
+	const char *p = pText;
+	while (p < pEnd)
+	{
+		const char *pEol = p;
+		while ((pEol < pEnd) && (*pEol != '\n') && (*pEol != '\r'))
+			pEol++;
+
+		if (! LoadLine( p, pEol, iFile, ++nLine, 0, nDepth ))
+			return; // END
+
+		if ((pEol < pEnd) && (*pEol == '\r'))
+			pEol++;
+		if ((pEol < pEnd) && (*pEol == '\n'))
+			pEol++;
+		p = pEol;
+	}
+}
+
+// Returns false on END
+//===========================================================================
+bool SourceAssembler_t::LoadLine( const char *pLine, const char *pEnd, const int iFile, const int nLine, const int iExpansion, const int nDepth )
+{
+	m_result.nSourceLines++;
+	m_iFile = iFile;
+	m_nLine = nLine;
+
+	if ((pLine == pEnd) || (*pLine == '*') || (*pLine == ';'))
+		return true;
+
+	// Fields
+	SourceAsmStatement_t statement;
+	memset( &statement, 0, sizeof( statement ));
+	statement.m_iMnemonic  = -1;
+	statement.m_eDirective = SRC_DIR_NONE;
+	statement.m_iFile      = iFile;
+	statement.m_nLine      = nLine;
+	statement.m_iExpansion = iExpansion;
+
+	const char *p = pLine;
+	while ((p < pEnd) && !_IsSpace( *p ))
+		p++;
+	statement.m_pLabel = pLine;
+	statement.m_nLabel = (int)(p - pLine);
+	if (statement.m_nLabel > 1 && pLine[ statement.m_nLabel - 1 ] == ':')
+		statement.m_nLabel--;
+
+	while ((p < pEnd) && _IsSpace( *p ))
+		p++;
+	const char *pOpcode = p;
+	if ((p < pEnd) && (*p != ';'))
+	{
+		while ((p < pEnd) && !_IsSpace( *p ))
+			p++;
+	}
+	const int nOpcode = (int)(p - pOpcode);
+
+	while ((p < pEnd) && _IsSpace( *p ))
+		p++;
+	statement.m_pOperand = p;
+	if ((p < pEnd) && (*p != ';'))
+		statement.m_nOperand = (int)(_SkipOperand( p, pEnd ) - p);
+
+	// Inside MAC ... EOM: keep the lines as they are
+	if (m_pDefining)
+	{
+		if ((nOpcode == 3) && ((_strnicmp( pOpcode, "EOM", 3 ) == 0) || (strncmp( pOpcode, "<<<", 3 ) == 0)))
+			m_pDefining = NULL;
+		else
+			m_pDefining->m_aLines.push_back( std::string( pLine, pEnd ));
+		return true;
+	}
+
+	if (! nOpcode)
+	{
+		if (statement.m_nLabel)
+			m_aStatements.push_back( statement );
+		return true;
+	}
+
+	std::string sKeyword( pOpcode, nOpcode );
+	for ( char & c : sKeyword )
+		c = toupper( c );
+	if ((sKeyword.size() == 4) && (sKeyword[ 3 ] == ':'))
+	{
+		statement.m_bAbsolute = true;
+		sKeyword.pop_back();
+	}
+
+	const std::unordered_map<std::string, int>::const_iterator iKeyword = m_keywords.m_aKeywords.find( sKeyword );
+
+	const std::string sLabel( statement.m_pLabel, statement.m_nLabel );
+	if (iKeyword == m_keywords.m_aKeywords.end())
+	{
+		std::unordered_map<std::string, SourceAsmMacro_t>::const_iterator iMacro = m_aMacros.find( std::string( pOpcode, nOpcode ));
+		if (iMacro == m_aMacros.end())
+		{
+			Error( "Unknown opcode: %.*s", nOpcode, pOpcode );
+			return true;
+		}
+
+		if (statement.m_nLabel)
+			m_aStatements.push_back( statement );
+		LoadMacro( iMacro->second, statement.m_pOperand, statement.m_pOperand + statement.m_nOperand, iFile, nLine, nDepth );
+		return true;
+	}
+
+	if (iKeyword->second >= 0)
+	{
+		statement.m_iMnemonic = iKeyword->second;
+		m_aStatements.push_back( statement );
+		return true;
+	}
+
+	statement.m_eDirective = (SourceAsmDirective_e) -iKeyword->second;
+	switch (statement.m_eDirective)
+	{
+		case SRC_DIR_PUT:
+			if (statement.m_nLabel)
+				m_aStatements.push_back( statement );
+			LoadPut( statement, nDepth );
+			return true;
+
+		case SRC_DIR_MAC:
+			if (! statement.m_nLabel)
+				Error( "MAC needs a name" );
+			else
+			if (iExpansion)
+				Error( "MAC inside a macro" );
+			else
+			if (m_aMacros.count( sLabel ))
+				Error( "Macro defined twice: %s", sLabel.c_str() );
+			else
+				m_pDefining = &m_aMacros[ sLabel ];
+			return true;
+
+		case SRC_DIR_EOM:
+			Error( "EOM without MAC" );
+			return true;
+
+		case SRC_DIR_PMC:
+		{
+			const char *pName = statement.m_pOperand;
+			const char *pNameEnd = pName;
+			const char *pOperandEnd = pName + statement.m_nOperand;
+			while ((pNameEnd < pOperandEnd) && (*pNameEnd != '.') && (*pNameEnd != '/') && (*pNameEnd != ';'))
+				pNameEnd++;
+
+			std::unordered_map<std::string, SourceAsmMacro_t>::const_iterator iMacro = m_aMacros.find( std::string( pName, pNameEnd ));
+			if (iMacro == m_aMacros.end())
+			{
+				Error( "Unknown macro: %.*s", (int)(pNameEnd - pName), pName );
+				return true;
+			}
+
+			if (statement.m_nLabel)
+				m_aStatements.push_back( statement );
+			if ((pNameEnd < pOperandEnd) && (*pNameEnd != ';'))
+				pNameEnd++;
+			LoadMacro( iMacro->second, pNameEnd, pOperandEnd, iFile, nLine, nDepth );
+			return true;
+		}
+
+		case SRC_DIR_END:
+			if (statement.m_nLabel)
+				m_aStatements.push_back( statement );
+			return false;
+
+		default:
+			m_aStatements.push_back( statement );
+			return true;
+	}
+}
+
+// Relative to the file with the PUT
+//===========================================================================
+void SourceAssembler_t::LoadPut( const SourceAsmStatement_t & statement, const int nDepth )
+{
+	if (nDepth >= SRC_ASM_MAX_DEPTH)
+	{
+		Error( "PUT nested too deep" );
+		return;
+	}
+
+	std::string sName( statement.m_pOperand, statement.m_nOperand );
+	if ((sName.size() >= 2) && ((sName[ 0 ] == '"') || (sName[ 0 ] == '\'')) && (sName.back() == sName[ 0 ]))
+		sName = sName.substr( 1, sName.size() - 2 );
+	if (sName.empty())
+	{
+		Error( "PUT needs a file name" );
+		return;
+	}
+
+	std::string sPathName = sName;
+	if ((sName[ 0 ] != '/') && (sName[ 0 ] != '\\') && ((sName.size() < 2) || (sName[ 1 ] != ':')))
+	{
+		const std::string & sParent = m_result.aFiles[ statement.m_iFile ];
+		const size_t iSeparator = sParent.find_last_of( "/\\" );
+		if (iSeparator != std::string::npos)
+			sPathName = sParent.substr( 0, iSeparator + 1 ) + sName;
+	}
+
+	std::string & sText = m_aTexts.emplace_back();
+	if (! _ReadFile( sPathName, sText ) && ! _ReadFile( sPathName + ".s", sText ))
+	{
+		Error( "Couldn't read: %s", sPathName.c_str() );
+		return;
+	}
+
+	m_result.aFiles.push_back( sPathName );
+	LoadText( sText.data(), sText.data() + sText.size(), (int) m_result.aFiles.size() - 1, nDepth + 1 );
+	m_iFile = statement.m_iFile;
+	m_nLine = statement.m_nLine;
+}
+
+// Arguments are separated by ';', and replace ]1 .. ]9 in the body
+//===========================================================================
+void SourceAssembler_t::LoadMacro( const SourceAsmMacro_t & macro, const char *pArgs, const char *pEnd, const int iFile, const int nLine, const int nDepth )
+{
+	if (nDepth >= SRC_ASM_MAX_DEPTH)
+	{
+		Error( "Macro calls nested too deep" );
+		return;
+	}
+
+	const char *aArgs[ SRC_ASM_MAX_ARGS ];
+	int         aArgLen[ SRC_ASM_MAX_ARGS ] = { 0 };
+	int         nArgs = 0;
+	while ((pArgs < pEnd) && (nArgs < SRC_ASM_MAX_ARGS))
+	{
+		const char *pArgEnd = _FindSeparator( pArgs, pEnd, ';' );
+		aArgs[ nArgs ] = pArgs;
+		aArgLen[ nArgs ] = (int)(pArgEnd - pArgs);
+		nArgs++;
+		pArgs = (pArgEnd < pEnd) ? pArgEnd + 1 : pEnd;
+	}
+
+	const int iExpansion = ++m_nExpansions;
+	for ( const std::string & sBody : macro.m_aLines )
+	{
+		std::string & sLine = m_aTexts.emplace_back();
+		sLine.reserve( sBody.size() + 16 );
+		for ( size_t iChar = 0; iChar < sBody.size(); iChar++ )
+		{
+			const char c = sBody[ iChar ];
+			if ((c == ']') && (iChar + 1 < sBody.size()) && (sBody[ iChar + 1 ] >= '1') && (sBody[ iChar + 1 ] <= '9'))
+			{
+				const int iArg = sBody[ ++iChar ] - '1';
+				if (iArg < nArgs)
+					sLine.append( aArgs[ iArg ], aArgLen[ iArg ] );
+			}
+			else
+				sLine += c;
+		}
+
+		if (! LoadLine( sLine.data(), sLine.data() + sLine.size(), iFile, nLine, iExpansion, nDepth + 1 ))
+			break; // END
+	}
+}
+
+
+// Expressions ______________________________________________________________
+
+// :local -> scope:local (or @call:local in a macro call)
+//===========================================================================
+std::string SourceAssembler_t::Qualify( const char *pName, const int nLen ) const
+{
+	if (*pName != ':')
+		return std::string( pName, nLen );
+
+	std::string sName = m_pStatement && m_pStatement->m_iExpansion
+		? StrFormat( "@%d", m_pStatement->m_iExpansion )
+		: m_sScope;
+	sName.append( pName, nLen );
+	return sName;
+}
+
+//===========================================================================
+bool SourceAssembler_t::ParseUnary( const char *& p, const char *pEnd, int & nValue_, bool & bKnown_ )
+{
+	if (p >= pEnd)
+	{
+		Error( "Expression expected" );
+		return false;
+	}
+
+	const char c = *p;
+	if ((c == '-') || (c == '~') || (c == '<') || (c == '>'))
+	{
+		p++;
+		if (! ParseUnary( p, pEnd, nValue_, bKnown_ ))
+			return false;
+		switch (c)
+		{
+			case '-': nValue_ = -nValue_              ; break;
+			case '~': nValue_ = ~nValue_ & 0xFFFF     ; break;
+			case '<': nValue_ =  nValue_       & 0xFF ; break;
+			case '>': nValue_ = (nValue_ >> 8) & 0xFF ; break;
+		}
+		return true;
+	}
+
+	bKnown_ = true;
+	nValue_ = 0;
+
+	if (c == '(')
+	{
+		p++;
+		if (! ParseBinary( p, pEnd, 0, nValue_, bKnown_ ))
+			return false;
+		if ((p >= pEnd) || (*p != ')'))
+		{
+			Error( "Missing )" );
+			return false;
+		}
+		p++;
+		return true;
+	}
+
+	if (c == '$')
+	{
+		const char *pDigits = ++p;
+		while ((p < pEnd) && (_HexDigit( *p ) >= 0))
+			nValue_ = (nValue_ << 4) | _HexDigit( *p++ );
+		if (p == pDigits)
+		{
+			Error( "Hex digits expected" );
+			return false;
+		}
+		return true;
+	}
+
+	if (c == '%')
+	{
+		const char *pDigits = ++p;
+		while ((p < pEnd) && ((*p == '0') || (*p == '1')))
+			nValue_ = (nValue_ << 1) | (*p++ - '0');
+		if (p == pDigits)
+		{
+			Error( "Binary digits expected" );
+			return false;
+		}
+		return true;
+	}
+
+	if (isdigit( (unsigned char) c ))
+	{
+		while ((p < pEnd) && isdigit( (unsigned char) *p ))
+			nValue_ = nValue_ * 10 + (*p++ - '0');
+		return true;
+	}
+
+	if ((c == '\'') || (c == '"'))
+	{
+		if (p + 1 >= pEnd)
+		{
+			Error( "Character expected" );
+			return false;
+		}
+		nValue_ = (BYTE) p[ 1 ] | ((c == '"') ? 0x80 : 0x00);
+		p += 2;
+		if ((p < pEnd) && (*p == c))
+			p++;
+		return true;
+	}
+
+	if (c == '*')
+	{
+		p++;
+		nValue_ = m_nPC;
+		return true;
+	}
+
+	if ((c == ':') || (c == '_') || isalpha( (unsigned char) c ))
+	{
+		const char *pName = p++;
+		while ((p < pEnd) && _IsSymbolChar( *p ))
+			p++;
+
+		std::unordered_map<std::string, SourceAsmSymbol_Value_t>::const_iterator iSymbol = m_aSymbols.find( Qualify( pName, (int)(p - pName) ));
+		if (iSymbol != m_aSymbols.end())
+		{
+			nValue_ = iSymbol->second.m_nValue;
+			return true;
+		}
+
+		bKnown_ = false;
+		if (m_iPass == 2)
+		{
+			Error( "Undefined symbol: %.*s", (int)(p - pName), pName );
+			return false;
+		}
+		return true;
+	}
+
+	Error( "Bad expression: %.*s", (int)(pEnd - p), p );
+	return false;
+}
+
+//===========================================================================
+static int _BinaryPrecedence( const char *p, const char *pEnd, int & nLen_ )
+{
+	nLen_ = 1;
+	switch (*p)
+	{
+		case '|': return 1;
+		case '^':
+		case '!': return 2;
+		case '&': return 3;
+		case '<':
+		case '>':
+			if ((p + 1 < pEnd) && (p[ 1 ] == *p))
+			{
+				nLen_ = 2;
+				return 4;
+			}
+			return 0;
+		case '+':
+		case '-': return 5;
+		case '*':
+		case '/': return 6;
+		default : return 0;
+	}
+}
+
+// Precedence climbing
+//===========================================================================
+bool SourceAssembler_t::ParseBinary( const char *& p, const char *pEnd, const int nMinPrecedence, int & nValue_, bool & bKnown_ )
+{
+	if (! ParseUnary( p, pEnd, nValue_, bKnown_ ))
+		return false;
+
+	while (p < pEnd)
+	{
+		int nLen;
+		const int nPrecedence = _BinaryPrecedence( p, pEnd, nLen );
+		if (! nPrecedence || (nPrecedence < nMinPrecedence))
+			break;
+
+		const char cOperator = *p;
+		p += nLen;
+
+		int  nRHS;
+		bool bKnownRHS;
+		if (! ParseBinary( p, pEnd, nPrecedence + 1, nRHS, bKnownRHS ))
+			return false;
+
+		switch (cOperator)
+		{
+			case '|': nValue_ |= nRHS; break;
+			case '^':
+			case '!': nValue_ ^= nRHS; break;
+			case '&': nValue_ &= nRHS; break;
+			case '<': nValue_ <<= (nRHS & 31); break;
+			case '>': nValue_ >>= (nRHS & 31); break;
+			case '+': nValue_ += nRHS; break;
+			case '-': nValue_ -= nRHS; break;
+			case '*': nValue_ *= nRHS; break;
+			case '/':
+				if (! nRHS)
+				{
+					if (bKnownRHS)
+					{
+						Error( "Division by zero" );
+						return false;
+					}
+					nRHS = 1; // pass 1, the value isn't used
+				}
+				nValue_ /= nRHS;
+				break;
+		}
+		bKnown_ = bKnown_ && bKnownRHS;
+	}
+
+	return true;
+}
+
+//===========================================================================
+bool SourceAssembler_t::Eval( const char *pBegin, const char *pEnd, int & nValue_, bool & bKnown_ )
+{
+	const char *p = pBegin;
+	if (! ParseBinary( p, pEnd, 1, nValue_, bKnown_ ))
+		return false;
+
+	if (p != pEnd)
+	{
+		Error( "Bad expression: %.*s", (int)(pEnd - pBegin), pBegin );
+		return false;
+	}
+	return true;
+}
+
+//===========================================================================
+bool SourceAssembler_t::EvalItem( const char *pBegin, const char *pEnd, int & nValue_, bool & bKnown_ )
+{
+	if ((pBegin < pEnd) && ((*pBegin == '<') || (*pBegin == '>')))
+	{
+		if (! Eval( pBegin + 1, pEnd, nValue_, bKnown_ ))
+			return false;
+		nValue_ = (*pBegin == '<') ? (nValue_ & 0xFF) : ((nValue_ >> 8) & 0xFF);
+		return true;
+	}
+	return Eval( pBegin, pEnd, nValue_, bKnown_ );
+}
+
+// For ORG & DS: the value decides the addresses, so it can't be a forward reference
+//===========================================================================
+bool SourceAssembler_t::EvalKnown( const char *pBegin, const char *pEnd, int & nValue_ )
+{
+	bool bKnown;
+	if (! Eval( pBegin, pEnd, nValue_, bKnown ))
+		return false;
+
+	if (! bKnown)
+	{
+		Error( "Symbol must be defined before it is used here: %.*s", (int)(pEnd - pBegin), pBegin );
+		return false;
+	}
+	return true;
+}
+
+
+// Pass 1 & 2 _______________________________________________________________
+
+//===========================================================================
+void SourceAssembler_t::Emit( const BYTE nByte )
+{
+	if (m_nPC > _6502_MEM_END)
+	{
+		Error( "Code past $FFFF" );
+		m_nPC &= _6502_MEM_END;
+	}
+
+	if (m_iPass == 2)
+	{
+		if (m_result.aSegments.empty() ||
+			(m_result.aSegments.back().nAddress + m_result.aSegments.back().aBytes.size() != (size_t) m_nPC))
+		{
+			m_result.aSegments.push_back( SourceAsmSegment_t() );
+			m_result.aSegments.back().nAddress = (WORD) m_nPC;
+		}
+		m_result.aSegments.back().aBytes.push_back( nByte );
+
+		if (m_result.nStartAddress < 0)
+			m_result.nStartAddress = m_nPC;
+		m_result.nBytes++;
+	}
+
+	m_nPC++;
+}
+
+//===========================================================================
+void SourceAssembler_t::Define( const SourceAsmStatement_t & statement, const int nValue, const bool bEquate )
+{
+	const std::string sName = Qualify( statement.m_pLabel, statement.m_nLabel );
+	const bool bGlobal = (*statement.m_pLabel != ':');
+
+	const char c = *statement.m_pLabel;
+	if (! (isalpha( (unsigned char) c ) || (c == '_') || (c == ':')))
+	{
+		Error( "Bad label: %s", sName.c_str() );
+		return;
+	}
+
+	SourceAsmSymbol_Value_t & symbol = m_aSymbols[ sName ];
+	if (m_iPass == 1)
+	{
+		if (symbol.m_iPass)
+			Error( "Symbol defined twice: %s", sName.c_str() );
+		symbol.m_nValue  = nValue;
+		symbol.m_iPass   = 1;
+		symbol.m_bEquate = bEquate;
+	}
+	else
+	{
+		if ((symbol.m_nValue != nValue) && !bEquate && m_result.aErrors.empty()) // else a line with an error emitted nothing
+			Error( "Symbol moved between passes: %s", sName.c_str() );
+		symbol.m_nValue = nValue;
+		symbol.m_iPass  = 2;
+
+		if (bGlobal)
+		{
+			SourceAsmSymbol_t entry;
+			entry.sName    = sName;
+			entry.nAddress = (WORD) nValue;
+			entry.bEquate  = bEquate;
+			m_result.aSymbols.push_back( entry );
+		}
+	}
+
+	if (bGlobal && !bEquate)
+		m_sScope = sName;
+}
+
+//===========================================================================
+void SourceAssembler_t::Instruction( SourceAsmStatement_t & statement )
+{
+	const SourceAsmMnemonic_t & mnemonic = m_keywords.m_aMnemonics[ statement.m_iMnemonic ];
+	const short *aOpcode = mnemonic.m_aOpcode[ m_b65C02 ? 1 : 0 ];
+
+	const char *p    = statement.m_pOperand;
+	const char *pEnd = p + statement.m_nOperand;
+
+	// Operand syntax -> the addressing modes it can be
+	int  iModeZP   = -1; // preferred when the value fits in a byte
+	int  iModeAbs  = -1;
+	int  nValue    = 0;
+	bool bKnown    = true;
+	bool bGotValue = true;
+
+	if ((p == pEnd) || ((pEnd - p == 1) && (toupper( *p ) == 'A') && (aOpcode[ AM_IMPLIED ] >= 0)))
+	{
+		iModeAbs  = AM_IMPLIED;
+		bGotValue = false;
+	}
+	else
+	if (*p == '#')
+	{
+		iModeAbs = AM_M;
+		if (! EvalItem( p + 1, pEnd, nValue, bKnown ))
+			return;
+		nValue &= 0xFF;
+	}
+	else
+	if ((*p == '(') && _EndsWith( p, pEnd, ",X)" ))
+	{
+		iModeZP  = AM_IZX;
+		iModeAbs = AM_IAX;
+		if (! Eval( p + 1, pEnd - 3, nValue, bKnown ))
+			return;
+	}
+	else
+	if ((*p == '(') && _EndsWith( p, pEnd, "),Y" ) && (_FindCloseParen( p, pEnd ) == pEnd - 3))
+	{
+		iModeZP = AM_NZY;
+		if (! Eval( p + 1, pEnd - 3, nValue, bKnown ))
+			return;
+	}
+	else
+	if ((*p == '(') && (_FindCloseParen( p, pEnd ) == pEnd - 1))
+	{
+		iModeZP  = AM_NZ;
+		iModeAbs = AM_NA;
+		if (! Eval( p + 1, pEnd - 1, nValue, bKnown ))
+			return;
+	}
+	else
+	if (_EndsWith( p, pEnd, ",X" ))
+	{
+		iModeZP  = AM_ZX;
+		iModeAbs = AM_AX;
+		if (! Eval( p, pEnd - 2, nValue, bKnown ))
+			return;
+	}
+	else
+	if (_EndsWith( p, pEnd, ",Y" ))
+	{
+		iModeZP  = AM_ZY;
+		iModeAbs = AM_AY;
+		if (! Eval( p, pEnd - 2, nValue, bKnown ))
+			return;
+	}
+	else
+	{
+		iModeZP  = (aOpcode[ AM_R ] >= 0) ? AM_R : AM_Z;
+		iModeAbs = (aOpcode[ AM_R ] >= 0) ? AM_R : AM_A;
+		if (! Eval( p, pEnd, nValue, bKnown ))
+			return;
+	}
+
+	if (m_iPass == 1)
+	{
+		const bool bHaveZP  = (iModeZP  >= 0) && (aOpcode[ iModeZP  ] >= 0);
+		const bool bHaveAbs = (iModeAbs >= 0) && (aOpcode[ iModeAbs ] >= 0);
+		const bool bFitsZP  = bKnown && (nValue >= 0) && (nValue <= 0xFF) && !statement.m_bAbsolute;
+
+		if (bHaveZP && (bFitsZP || !bHaveAbs))
+			statement.m_iOpmode = (BYTE) iModeZP;
+		else
+		if (bHaveAbs)
+			statement.m_iOpmode = (BYTE) iModeAbs;
+		else
+		{
+			Error( "Addressing mode not available: %s %.*s", mnemonic.m_pName, statement.m_nOperand, statement.m_pOperand );
+			return;
+		}
+	}
+
+	const int iOpmode = statement.m_iOpmode;
+	const int nBytes  = g_aOpmodes[ iOpmode ].m_nBytes;
+
+	if (m_iPass == 2)
+	{
+		if (iOpmode == AM_R)
+		{
+			nValue -= m_nPC + 2;
+			if ((nValue < -128) || (nValue > 127))
+			{
+				Error( "Branch out of range: %.*s", statement.m_nOperand, statement.m_pOperand );
+				return;
+			}
+		}
+		else
+		if ((nBytes == 2) && bGotValue && (iOpmode != AM_M) && ((nValue < 0) || (nValue > 0xFF)))
+		{
+			Error( "Zero page address expected: %.*s", statement.m_nOperand, statement.m_pOperand );
+			return;
+		}
+	}
+
+	Emit( (BYTE) aOpcode[ iOpmode ] );
+	if (nBytes > 1)
+		Emit( (BYTE)(nValue >> 0) );
+	if (nBytes > 2)
+		Emit( (BYTE)(nValue >> 8) );
+}
+
+//===========================================================================
+bool SourceAssembler_t::ParseString( const char *p, const char *pEnd, const bool bInvertLast )
+{
+	if (p >= pEnd)
+	{
+		Error( "String expected" );
+		return false;
+	}
+
+	const char cDelimiter = *p++;
+	const char *pClose = (const char*) memchr( p, cDelimiter, pEnd - p );
+	if (! pClose)
+	{
+		Error( "Missing closing %c", cDelimiter );
+		return false;
+	}
+
+	const BYTE nHighBit = (cDelimiter < '\'') ? 0x80 : 0x00;
+	for ( ; p < pClose; p++ )
+	{
+		BYTE nByte = (BYTE)(*p & 0x7F) | nHighBit;
+		if (bInvertLast && (p + 1 == pClose))
+			nByte ^= 0x80;
+		Emit( nByte );
+	}
+
+	// Merlin: hex bytes can follow, ie. ASC "TEXT"8D00
+	for ( p = pClose + 1; p + 1 < pEnd; p += 2 )
+	{
+		if (*p == ',')
+			p++;
+		if ((p + 1 >= pEnd) || (_HexDigit( p[ 0 ] ) < 0) || (_HexDigit( p[ 1 ] ) < 0))
+		{
+			Error( "Hex digits expected: %.*s", (int)(pEnd - p), p );
+			return false;
+		}
+		Emit( (BYTE)((_HexDigit( p[ 0 ] ) << 4) | _HexDigit( p[ 1 ] )) );
+	}
+	if (p != pEnd)
+	{
+		Error( "Hex digits expected: %.*s", (int)(pEnd - p), p );
+		return false;
+	}
+	return true;
+}
+
+//===========================================================================
+void SourceAssembler_t::Directive( const SourceAsmStatement_t & statement )
+{
+	const char *p    = statement.m_pOperand;
+	const char *pEnd = p + statement.m_nOperand;
+
+	switch (statement.m_eDirective)
+	{
+		case SRC_DIR_NONE:
+		case SRC_DIR_IGNORE:
+		case SRC_DIR_ORG: // see Pass()
+		case SRC_DIR_EQU:
+			break;
+
+		case SRC_DIR_DFB:
+		case SRC_DIR_DA:
+		case SRC_DIR_DDB:
+			if (p == pEnd)
+			{
+				Error( "Value expected" );
+				break;
+			}
+			while (p < pEnd)
+			{
+				const char *pItemEnd = _FindSeparator( p, pEnd );
+				int  nValue;
+				bool bKnown;
+				if (! EvalItem( p, pItemEnd, nValue, bKnown ))
+					break;
+
+				if (statement.m_eDirective == SRC_DIR_DFB)
+					Emit( (BYTE) nValue );
+				else
+				if (statement.m_eDirective == SRC_DIR_DA)
+				{
+					Emit( (BYTE)(nValue >> 0) );
+					Emit( (BYTE)(nValue >> 8) );
+				}
+				else
+				{
+					Emit( (BYTE)(nValue >> 8) );
+					Emit( (BYTE)(nValue >> 0) );
+				}
+				p = (pItemEnd < pEnd) ? pItemEnd + 1 : pEnd;
+			}
+			break;
+
+		case SRC_DIR_HEX:
+			while (p < pEnd)
+			{
+				if (*p == ',')
+				{
+					p++;
+					continue;
+				}
+				if ((p + 1 >= pEnd) || (_HexDigit( p[ 0 ] ) < 0) || (_HexDigit( p[ 1 ] ) < 0))
+				{
+					Error( "Hex digits expected: %.*s", (int)(pEnd - p), p );
+					break;
+				}
+				Emit( (BYTE)((_HexDigit( p[ 0 ] ) << 4) | _HexDigit( p[ 1 ] )) );
+				p += 2;
+			}
+			break;
+
+		case SRC_DIR_ASC:
+		case SRC_DIR_DCI:
+			ParseString( p, pEnd, statement.m_eDirective == SRC_DIR_DCI );
+			break;
+
+		case SRC_DIR_DS:
+		{
+			const char *pCountEnd = _FindSeparator( p, pEnd );
+			int nCount;
+			if ((pCountEnd - p == 1) && (*p == '\\'))
+				nCount = (0x100 - (m_nPC & 0xFF)) & 0xFF;
+			else
+			if (! EvalKnown( p, pCountEnd, nCount ))
+				break;
+
+			int  nFill  = 0;
+			bool bKnown = true;
+			if ((pCountEnd < pEnd) && ! Eval( pCountEnd + 1, pEnd, nFill, bKnown ))
+				break;
+
+			if ((nCount < 0) || (m_nPC + nCount > _6502_MEM_END + 1))
+			{
+				Error( "Bad DS size: %d", nCount );
+				break;
+			}
+			for ( int iByte = 0; iByte < nCount; iByte++ )
+				Emit( (BYTE) nFill );
+			break;
+		}
+
+		case SRC_DIR_XC:
+			m_b65C02 = (pEnd - p != 3) || (_strnicmp( p, "OFF", 3 ) != 0);
+			break;
+
+		default:
+			_ASSERT(0); // handled in pass 0
+			break;
+	}
+}
+
+//===========================================================================
+void SourceAssembler_t::Pass( const int iPass )
+{
+	m_iPass  = iPass;
+	m_nPC    = m_nOrigin;
+	m_b65C02 = (GetMainCpu() != CPU_6502);
+	m_sScope.clear();
+
+	for ( SourceAsmStatement_t & statement : m_aStatements )
+	{
+		m_pStatement = &statement;
+		const int nPC    = m_nPC;
+		const int nBytes = m_result.nBytes;
+
+		if (statement.m_eDirective == SRC_DIR_ORG)
+		{
+			int nAddress;
+			if (EvalKnown( statement.m_pOperand, statement.m_pOperand + statement.m_nOperand, nAddress ))
+				m_nPC = nAddress & _6502_MEM_END;
+			if (statement.m_nLabel)
+				Define( statement, m_nPC, false );
+		}
+		else
+		if (statement.m_eDirective == SRC_DIR_EQU)
+		{
+			int  nValue;
+			bool bKnown;
+			if (! statement.m_nLabel)
+				Error( "EQU needs a label" );
+			else
+			if (Eval( statement.m_pOperand, statement.m_pOperand + statement.m_nOperand, nValue, bKnown ) && bKnown)
+				Define( statement, nValue, true );
+		}
+		else
+		{
+			if (statement.m_nLabel)
+				Define( statement, m_nPC, false );
+
+			if (statement.m_iMnemonic >= 0)
+				Instruction( statement );
+			else
+				Directive( statement );
+		}
+
+		if ((m_iPass == 2) && (m_result.nBytes != nBytes))
+		{
+			SourceAsmLine_t line;
+			line.nAddress = (WORD) nPC;
+			line.nBytes   = (WORD) MIN( m_result.nBytes - nBytes, 0xFFFF );
+			line.iFile    = statement.m_iFile;
+			line.nLine    = statement.m_nLine;
+			m_result.aLines.push_back( line );
+		}
+
+		if (m_result.aErrors.size() >= SRC_ASM_MAX_ERRORS)
+			break;
+	}
+
+	m_pStatement = NULL;
+}
+
+//===========================================================================
+bool SourceAssembler_t::Assemble( const std::string & sText, const std::string & sFileName )
+{
+	m_result.Clear();
+	m_result.aFiles.push_back( sFileName );
+
+	m_aStatements.reserve( 1024 );
+	LoadText( sText.data(), sText.data() + sText.size(), 0, 0 );
+	if (m_pDefining)
+		Error( "MAC without EOM" );
+	if (! m_result.aErrors.empty())
+		return false;
+
+	Pass( 1 );
+	if (! m_result.aErrors.empty())
+		return false;
+
+	Pass( 2 );
+	return m_result.aErrors.empty();
+}
+
+
+// Interface ________________________________________________________________
+
+//===========================================================================
+bool SourceAssemble ( const std::string & sText, const std::string & sFileName, SourceAsmResult_t & result_, const WORD nOrigin )
+{
+	SourceAssembler_t assembler( result_, nOrigin );
+	return assembler.Assemble( sText, sFileName );
+}
+
+//===========================================================================
+bool SourceAssembleFile ( const std::string & sPathName, SourceAsmResult_t & result_, const WORD nOrigin )
+{
+	std::string sText;
+	if (! _ReadFile( sPathName, sText ))
+	{
+		result_.Clear();
+		result_.aErrors.push_back( "Couldn't read: " + sPathName );
+		return false;
+	}
+
+	return SourceAssemble( sText, sPathName, result_, nOrigin );
+}
+
+//===========================================================================
+void SourceAssemblerWriteMemory ( const SourceAsmResult_t & result )
+{
+	for ( const SourceAsmSegment_t & segment : result.aSegments )
+	{
+		for ( size_t iByte = 0; iByte < segment.aBytes.size(); iByte++ )
+			WriteByteToMemory( (WORD)(segment.nAddress + iByte), segment.aBytes[ iByte ] );
+	}
+}
+
+// Equates first, so a label wins when both have the same address
+//===========================================================================
+int SourceAssemblerAddSymbols ( const SourceAsmResult_t & result, const SymbolTable_Index_e eSymbolTable )
+{
+	_CmdSymbolsClear( eSymbolTable );
+
+	for ( int iEquates = 1; iEquates >= 0; iEquates-- )
+	{
+		for ( const SourceAsmSymbol_t & symbol : result.aSymbols )
+		{
+			if (symbol.bEquate == (iEquates != 0))
+				SymbolTableInsert( eSymbolTable, symbol.nAddress, symbol.sName );
+		}
+	}
+
+	return (int) g_aSymbols[ eSymbolTable ].size();
+}
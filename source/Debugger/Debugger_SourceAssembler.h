@@ -0,0 +1,64 @@
+#pragma once
+
+// Source Assembler _______________________________________________________________________________
+
+	// Two-pass assembler for whole 6502/65C02 source files (Merlin syntax, see Debugger_SourceAssembler.cpp).
+	// The output is kept apart from the emulator, so it can be checked before it is written to memory.
+
+	struct SourceAsmSegment_t // bytes from one ORG
+	{
+		WORD              nAddress;
+		std::vector<BYTE> aBytes  ;
+	};
+
+	struct SourceAsmLine_t // line table: the source line of each address range
+	{
+		WORD nAddress;
+		WORD nBytes  ;
+		int  iFile   ; // SourceAsmResult_t::aFiles[]
+		int  nLine   ; // 1 based; for macro expansions, the line of the call
+	};
+
+	struct SourceAsmSymbol_t // global labels & equates
+	{
+		std::string sName   ;
+		WORD        nAddress;
+		bool        bEquate ;
+	};
+
+	struct SourceAsmResult_t
+	{
+		std::vector<std::string>        aFiles   ; // [0] is the main source, then PUT files
+		std::vector<SourceAsmSegment_t> aSegments;
+		std::vector<SourceAsmLine_t>    aLines   ;
+		std::vector<SourceAsmSymbol_t>  aSymbols ;
+		std::vector<std::string>        aErrors  ; // "file(line): message"
+		int                             nSourceLines ; // including PUT files & macro expansions
+		int                             nBytes       ;
+		int                             nStartAddress; // of the first byte, -1 if none
+
+		SourceAsmResult_t()
+		{
+			Clear();
+		}
+
+		void Clear()
+		{
+			aFiles.clear();
+			aSegments.clear();
+			aLines.clear();
+			aSymbols.clear();
+			aErrors.clear();
+			nSourceLines  = 0;
+			nBytes        = 0;
+			nStartAddress = -1;
+		}
+	};
+
+	// sFileName: for messages & the path of PUT files
+	// nOrigin: address of the code before the first ORG
+	bool SourceAssemble     ( const std::string & sText, const std::string & sFileName, SourceAsmResult_t & result_, const WORD nOrigin = 0x0800 );
+	bool SourceAssembleFile ( const std::string & sPathName, SourceAsmResult_t & result_, const WORD nOrigin = 0x0800 );
+
+	void SourceAssemblerWriteMemory( const SourceAsmResult_t & result ); // as the A command does
+	int  SourceAssemblerAddSymbols ( const SourceAsmResult_t & result, const SymbolTable_Index_e eSymbolTable ); // replaces the table
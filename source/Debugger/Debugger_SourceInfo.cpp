@@ -0,0 +1,788 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2010, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Source Level Debug Info
+ *
+ * . cc65 debug info (ld65 --dbgfile), version 2:
+ *     keyword<tab>attribute=value,...   one record per line
+ *   file (name), seg (start), span (seg, start, size), line (file, line, type, span list),
+ *   scope (name, parent, span list), sym (name, val, type) are used; the rest is skipped.
+ *   A span list is "id+id+...", addresses are seg.start + span.start.
+ * . Assembler listing (Merlin):
+ *     xxxx: b1 b2 b3   n  label  opcode  operand
+ *   An optional bank (bb/xxxx:) is ignored. The listing itself is the source shown.
+ * . ASM command: the line table & global labels of the assembled source.
+ *   A global label is the scope of the code up to the next label.
+ *
+ * Overlapping spans (a macro call & its body, a C line & its assembler lines, nested scopes)
+ * are cut into non-overlapping ranges, each owned by the best span covering it:
+ *   lines : C, then assembler, then macro lines; then the smallest
+ *   scopes: the smallest; then the deepest
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+#include "Debugger_SourceInfo.h"
+
+#include "../Memory.h"
+
+#include <set>
+
+// Globals __________________________________________________________________
+
+	SourceInfo_t g_SourceInfo;
+
+
+// Ranges ___________________________________________________________________
+
+	struct SourceInfoSpan_t
+	{
+		uint32_t nFirst;
+		uint32_t nLast ; // inclusive
+		uint64_t nRank ; // lower wins
+		int      iItem ;
+	};
+
+// Sweep the span ends in address order; the best open span owns each range up to the next end
+//===========================================================================
+static void _SourceInfoBuildRanges ( const std::vector<SourceInfoSpan_t> & aSpans, std::vector<SourceInfoRange_t> & aRanges_ )
+{
+	aRanges_.clear();
+
+	std::vector< std::pair<uint32_t, int> > aEvents; // address, +(i+1) open / -(i+1) close
+	aEvents.reserve( aSpans.size() * 2 );
+	for ( size_t iSpan = 0; iSpan < aSpans.size(); iSpan++ )
+	{
+		aEvents.push_back( std::make_pair( aSpans[ iSpan ].nFirst    ,  (int)(iSpan + 1) ));
+		aEvents.push_back( std::make_pair( aSpans[ iSpan ].nLast + 1 , -(int)(iSpan + 1) ));
+	}
+	std::sort( aEvents.begin(), aEvents.end() );
+
+	std::set< std::pair<uint64_t, int> > aOpen;
+	uint32_t nAddress = 0;
+	size_t   iEvent   = 0;
+	while (iEvent < aEvents.size())
+	{
+		const uint32_t nNext = aEvents[ iEvent ].first;
+		if (! aOpen.empty() && (nNext > nAddress))
+		{
+			const int iItem = aSpans[ aOpen.begin()->second ].iItem;
+			if (! aRanges_.empty() && (aRanges_.back().iItem == iItem) && (aRanges_.back().nLast + 1u == nAddress))
+				aRanges_.back().nLast = (WORD)(nNext - 1);
+			else
+			{
+				SourceInfoRange_t range;
+				range.nFirst = (WORD) nAddress;
+				range.nLast  = (WORD)(nNext - 1);
+				range.iItem  = iItem;
+				aRanges_.push_back( range );
+			}
+		}
+
+		for ( ; (iEvent < aEvents.size()) && (aEvents[ iEvent ].first == nNext); iEvent++ )
+		{
+			const int iSpan = abs( aEvents[ iEvent ].second ) - 1;
+			const std::pair<uint64_t, int> key( aSpans[ iSpan ].nRank, iSpan );
+			if (aEvents[ iEvent ].second > 0)
+				aOpen.insert( key );
+			else
+				aOpen.erase( key );
+		}
+		nAddress = nNext;
+	}
+}
+
+//===========================================================================
+static const SourceInfoRange_t * _SourceInfoFindRange ( const std::vector<SourceInfoRange_t> & aRanges, const WORD nAddress )
+{
+	std::vector<SourceInfoRange_t>::const_iterator iRange = std::upper_bound( aRanges.begin(), aRanges.end(), nAddress,
+		[]( const WORD nAddress, const SourceInfoRange_t & range ) { return nAddress < range.nFirst; } );
+
+	if (iRange == aRanges.begin())
+		return NULL;
+	--iRange;
+	return (nAddress <= iRange->nLast) ? &*iRange : NULL;
+}
+
+
+// Text _____________________________________________________________________
+
+//===========================================================================
+static bool _SourceInfoReadFile ( const std::string & sPathName, std::string & sText_ )
+{
+	FILE *hFile = fopen( sPathName.c_str(), "rb" );
+	if (! hFile)
+		return false;
+
+	char aBuffer[ 4096 ];
+	size_t nSize;
+	while ((nSize = fread( aBuffer, 1, sizeof( aBuffer ), hFile )) > 0)
+		sText_.append( aBuffer, nSize );
+
+	fclose( hFile );
+	return true;
+}
+
+// LF, CR LF or CR
+//===========================================================================
+static void _SourceInfoSplitLines ( const std::string & sText, std::vector<std::string> & aLines_ )
+{
+	aLines_.clear();
+
+	size_t iStart = 0;
+	while (iStart < sText.size())
+	{
+		size_t iEnd = sText.find_first_of( "\r\n", iStart );
+		if (iEnd == std::string::npos)
+			iEnd = sText.size();
+		aLines_.push_back( sText.substr( iStart, iEnd - iStart ));
+
+		if ((iEnd + 1 < sText.size()) && (sText[ iEnd ] == '\r') && (sText[ iEnd + 1 ] == '\n'))
+			iEnd++;
+		iStart = iEnd + 1;
+	}
+}
+
+//===========================================================================
+static std::string _SourceInfoBaseName ( const std::string & sPathName )
+{
+	const size_t iSeparator = sPathName.find_last_of( "/\\" );
+	return (iSeparator == std::string::npos) ? sPathName : sPathName.substr( iSeparator + 1 );
+}
+
+// Relative to the debug info file
+//===========================================================================
+static std::string _SourceInfoPathName ( const std::string & sName, const std::string & sParent )
+{
+	if (sName.empty() || (sName[ 0 ] == '/') || (sName[ 0 ] == '\\') || ((sName.size() >= 2) && (sName[ 1 ] == ':')))
+		return sName;
+
+	const size_t iSeparator = sParent.find_last_of( "/\\" );
+	return (iSeparator == std::string::npos) ? sName : sParent.substr( 0, iSeparator + 1 ) + sName;
+}
+
+
+// cc65 .dbg ________________________________________________________________
+
+	struct SourceInfoDbgAttr_t
+	{
+		std::string sKey  ;
+		std::string sValue; // without quotes
+	};
+
+	struct SourceInfoDbgSpan_t
+	{
+		int      iSeg  ;
+		uint32_t nStart;
+		uint32_t nSize ;
+	};
+
+	struct SourceInfoDbgLine_t
+	{
+		int              idFile;
+		int              nLine ;
+		int              nRank ; // C, assembler, macro
+		std::vector<int> aSpans;
+	};
+
+	struct SourceInfoDbgScope_t
+	{
+		std::string      sName  ;
+		int              idParent;
+		std::vector<int> aSpans ;
+		bool             bValid ;
+	};
+
+//===========================================================================
+static void _DbgParseAttributes ( const std::string & sLine, const size_t iStart, std::vector<SourceInfoDbgAttr_t> & aAttrs_ )
+{
+	aAttrs_.clear();
+
+	size_t i = iStart;
+	while (i < sLine.size())
+	{
+		while ((i < sLine.size()) && ((sLine[ i ] == ' ') || (sLine[ i ] == '\t') || (sLine[ i ] == ',')))
+			i++;
+
+		const size_t iEqual = sLine.find( '=', i );
+		if (iEqual == std::string::npos)
+			break;
+
+		SourceInfoDbgAttr_t attr;
+		attr.sKey = sLine.substr( i, iEqual - i );
+		i = iEqual + 1;
+
+		if ((i < sLine.size()) && (sLine[ i ] == '"'))
+		{
+			for ( i++; (i < sLine.size()) && (sLine[ i ] != '"'); i++ )
+			{
+				if ((sLine[ i ] == '\\') && (i + 1 < sLine.size()))
+					i++;
+				attr.sValue += sLine[ i ];
+			}
+			i++;
+		}
+		else
+		{
+			const size_t iComma = sLine.find( ',', i );
+			const size_t iEnd   = (iComma == std::string::npos) ? sLine.size() : iComma;
+			attr.sValue = sLine.substr( i, iEnd - i );
+			i = iEnd;
+		}
+
+		aAttrs_.push_back( attr );
+	}
+}
+
+//===========================================================================
+static const std::string * _DbgFind ( const std::vector<SourceInfoDbgAttr_t> & aAttrs, const char *pKey )
+{
+	for ( const SourceInfoDbgAttr_t & attr : aAttrs )
+	{
+		if (attr.sKey == pKey)
+			return &attr.sValue;
+	}
+	return NULL;
+}
+
+// Decimal or 0x hex
+//===========================================================================
+static long _DbgInt ( const std::vector<SourceInfoDbgAttr_t> & aAttrs, const char *pKey, const long nDefault )
+{
+	const std::string *pValue = _DbgFind( aAttrs, pKey );
+	return pValue ? strtol( pValue->c_str(), NULL, 0 ) : nDefault;
+}
+
+// id+id+...
+//===========================================================================
+static void _DbgList ( const std::vector<SourceInfoDbgAttr_t> & aAttrs, const char *pKey, std::vector<int> & aIds_ )
+{
+	aIds_.clear();
+
+	const std::string *pValue = _DbgFind( aAttrs, pKey );
+	if (! pValue)
+		return;
+
+	const char *p = pValue->c_str();
+	while (*p)
+	{
+		char *pEnd;
+		aIds_.push_back( (int) strtol( p, &pEnd, 10 ));
+		if ((pEnd == p) || (*pEnd != '+'))
+			break;
+		p = pEnd + 1;
+	}
+}
+
+//===========================================================================
+template <typename T>
+static T & _DbgAt ( std::vector<T> & aItems, const long id, const T & empty )
+{
+	if (id >= (long) aItems.size())
+		aItems.resize( id + 1, empty );
+	return aItems[ id ];
+}
+
+
+// Interface ________________________________________________________________
+
+//===========================================================================
+SourceInfo_t::SourceInfo_t ()
+{
+	Clear();
+}
+
+//===========================================================================
+void SourceInfo_t::Clear ()
+{
+	m_aFiles.clear();
+	m_aLines.clear();
+	m_aScopes.clear();
+	m_aSymbols.clear();
+	m_aLineRanges.clear();
+	m_aScopeRanges.clear();
+	m_aBytes.clear();
+	m_aLineIndex.clear();
+}
+
+//===========================================================================
+int SourceInfo_t::AddFile ( const std::string & sName, const std::string & sPathName )
+{
+	SourceInfoFile_t file;
+	file.sName     = sName;
+	file.sPathName = sPathName;
+	file.bRead     = false;
+	m_aFiles.push_back( file );
+	return (int) m_aFiles.size() - 1;
+}
+
+//===========================================================================
+int SourceInfo_t::AddLine ( const int iFile, const int nLine )
+{
+	const uint64_t nKey = ((uint64_t)(uint32_t) iFile << 32) | (uint32_t) nLine;
+	std::map<uint64_t, int>::const_iterator iLine = m_aLineIndex.find( nKey );
+	if (iLine != m_aLineIndex.end())
+		return iLine->second;
+
+	SourceInfoLine_t line;
+	line.iFile = iFile;
+	line.nLine = nLine;
+	m_aLines.push_back( line );
+	m_aLineIndex[ nKey ] = (int) m_aLines.size() - 1;
+	return (int) m_aLines.size() - 1;
+}
+
+//===========================================================================
+bool SourceInfo_t::LoadDbg ( const std::string & sText, const std::string & sPathName, std::string & sError_ )
+{
+	std::vector<std::string> aText;
+	_SourceInfoSplitLines( sText, aText );
+
+	if (aText.empty() || (aText[ 0 ].compare( 0, 8, "version\t" ) != 0))
+	{
+		sError_ = "Not a cc65 debug info file: " + sPathName;
+		return false;
+	}
+
+	SourceInfo_t info;
+
+	std::vector<int>                  aFileIds ; // .dbg id -> m_aFiles[]
+	std::vector<long>                 aSegStart;
+	std::vector<SourceInfoDbgSpan_t>  aSpans   ;
+	std::vector<SourceInfoDbgLine_t>  aLines   ;
+	std::vector<SourceInfoDbgScope_t> aScopes  ;
+
+	const SourceInfoDbgSpan_t  noSpan  = { -1, 0, 0 };
+	const SourceInfoDbgScope_t noScope = { "", -1, std::vector<int>(), false };
+
+	std::vector<SourceInfoDbgAttr_t> aAttrs;
+	for ( const std::string & sLine : aText )
+	{
+		const size_t iTab = sLine.find( '\t' );
+		if (iTab == std::string::npos)
+			continue;
+
+		const std::string sKeyword = sLine.substr( 0, iTab );
+		if ((sKeyword != "version") && (sKeyword != "file") && (sKeyword != "seg") && (sKeyword != "span") &&
+			(sKeyword != "line") && (sKeyword != "scope") && (sKeyword != "sym"))
+			continue;
+
+		_DbgParseAttributes( sLine, iTab + 1, aAttrs );
+		const long id = _DbgInt( aAttrs, "id", -1 );
+
+		if (sKeyword == "version")
+		{
+			if (_DbgInt( aAttrs, "major", 0 ) != 2)
+			{
+				sError_ = "Unsupported cc65 debug info version: " + sPathName;
+				return false;
+			}
+		}
+		else
+		if (id < 0)
+			continue;
+		else
+		if (sKeyword == "file")
+		{
+			const std::string *pName = _DbgFind( aAttrs, "name" );
+			const std::string  sName = pName ? *pName : std::string();
+			_DbgAt( aFileIds, id, -1 ) = info.AddFile( _SourceInfoBaseName( sName ), _SourceInfoPathName( sName, sPathName ));
+		}
+		else
+		if (sKeyword == "seg")
+		{
+			_DbgAt( aSegStart, id, -1L ) = _DbgInt( aAttrs, "start", 0 );
+		}
+		else
+		if (sKeyword == "span")
+		{
+			SourceInfoDbgSpan_t & span = _DbgAt( aSpans, id, noSpan );
+			span.iSeg   = (int)      _DbgInt( aAttrs, "seg"  , -1 );
+			span.nStart = (uint32_t) _DbgInt( aAttrs, "start",  0 );
+			span.nSize  = (uint32_t) _DbgInt( aAttrs, "size" ,  0 );
+		}
+		else
+		if (sKeyword == "line")
+		{
+			// type: 0 assembler, 1 external (C), 2 macro
+			const long iType = _DbgInt( aAttrs, "type", 0 );
+
+			SourceInfoDbgLine_t line;
+			line.idFile = (int) _DbgInt( aAttrs, "file", -1 );
+			line.nLine  = (int) _DbgInt( aAttrs, "line",  0 );
+			line.nRank  = (iType == 1) ? 0 : (iType == 0) ? 1 : 2;
+			_DbgList( aAttrs, "span", line.aSpans );
+
+			if (! line.aSpans.empty() && (line.idFile >= 0) && (line.nLine > 0))
+				aLines.push_back( line );
+		}
+		else
+		if (sKeyword == "scope")
+		{
+			SourceInfoDbgScope_t & scope = _DbgAt( aScopes, id, noScope );
+			const std::string *pName = _DbgFind( aAttrs, "name" );
+			scope.sName    = pName ? *pName : std::string();
+			scope.idParent = (int) _DbgInt( aAttrs, "parent", -1 );
+			scope.bValid   = true;
+			_DbgList( aAttrs, "span", scope.aSpans );
+		}
+		else
+		if (sKeyword == "sym")
+		{
+			const std::string *pName = _DbgFind( aAttrs, "name" );
+			const std::string *pType = _DbgFind( aAttrs, "type" );
+			const std::string *pVal  = _DbgFind( aAttrs, "val"  );
+			if (pName && pVal && ! pName->empty() && ((*pName)[ 0 ] != '@') && (! pType || (*pType != "imp")))
+			{
+				SourceInfoSymbol_t symbol;
+				symbol.sName    = *pName;
+				symbol.nAddress = (WORD) strtol( pVal->c_str(), NULL, 0 );
+				info.m_aSymbols.push_back( symbol );
+			}
+		}
+	}
+
+	// span id -> address
+	std::vector<SourceInfoSpan_t> aSpansOut;
+	const auto AddSpans = [&]( const std::vector<int> & aIds, const uint64_t nRank, const int iItem )
+	{
+		for ( const int idSpan : aIds )
+		{
+			if ((idSpan < 0) || (idSpan >= (int) aSpans.size()))
+				continue;
+
+			const SourceInfoDbgSpan_t & span = aSpans[ idSpan ];
+			if ((span.iSeg < 0) || (span.iSeg >= (int) aSegStart.size()) || (aSegStart[ span.iSeg ] < 0) || ! span.nSize)
+				continue;
+
+			SourceInfoSpan_t out;
+			out.nFirst = (uint32_t) aSegStart[ span.iSeg ] + span.nStart;
+			out.nLast  = out.nFirst + span.nSize - 1;
+			if (out.nLast > _6502_MEM_END)
+				continue;
+			out.nRank  = nRank | ((uint64_t) span.nSize << 16);
+			out.iItem  = iItem;
+			aSpansOut.push_back( out );
+		}
+	};
+
+	for ( const SourceInfoDbgLine_t & line : aLines )
+	{
+		if ((line.idFile >= (int) aFileIds.size()) || (aFileIds[ line.idFile ] < 0))
+			continue;
+
+		AddSpans( line.aSpans, (uint64_t) line.nRank << 40, info.AddLine( aFileIds[ line.idFile ], line.nLine ));
+	}
+	_SourceInfoBuildRanges( aSpansOut, info.m_aLineRanges );
+
+	if (info.m_aLineRanges.empty())
+	{
+		sError_ = "No line info (assemble with -g): " + sPathName;
+		return false;
+	}
+
+	// scopes: .dbg id -> m_aScopes[], named outer::inner
+	std::vector<int> aScopeIds( aScopes.size(), -1 );
+	for ( size_t idScope = 0; idScope < aScopes.size(); idScope++ )
+	{
+		if (! aScopes[ idScope ].bValid)
+			continue;
+
+		SourceInfoScope_t scope;
+		scope.iParent = -1;
+		info.m_aScopes.push_back( scope );
+		aScopeIds[ idScope ] = (int) info.m_aScopes.size() - 1;
+	}
+
+	aSpansOut.clear();
+	for ( size_t idScope = 0; idScope < aScopes.size(); idScope++ )
+	{
+		if (aScopeIds[ idScope ] < 0)
+			continue;
+
+		std::string sName = aScopes[ idScope ].sName;
+		int nDepth = 0;
+		for ( int idParent = aScopes[ idScope ].idParent;
+			(idParent >= 0) && (idParent < (int) aScopes.size()) && aScopes[ idParent ].bValid && (nDepth < 64);
+			idParent = aScopes[ idParent ].idParent, nDepth++ )
+		{
+			if (! aScopes[ idParent ].sName.empty())
+				sName = aScopes[ idParent ].sName + "::" + sName;
+		}
+
+		SourceInfoScope_t & scope = info.m_aScopes[ aScopeIds[ idScope ] ];
+		scope.sName = sName;
+		const int idParent = aScopes[ idScope ].idParent;
+		if ((idParent >= 0) && (idParent < (int) aScopeIds.size()))
+			scope.iParent = aScopeIds[ idParent ];
+
+		AddSpans( aScopes[ idScope ].aSpans, 0xFFFF - nDepth, aScopeIds[ idScope ] );
+	}
+	_SourceInfoBuildRanges( aSpansOut, info.m_aScopeRanges );
+
+	*this = std::move( info );
+	return true;
+}
+
+//===========================================================================
+bool SourceInfo_t::LoadListing ( const std::string & sText, const std::string & sPathName, std::string & sError_ )
+{
+	SourceInfo_t info;
+	const int iFile = info.AddFile( _SourceInfoBaseName( sPathName ), sPathName );
+
+	SourceInfoFile_t & file = info.m_aFiles[ iFile ];
+	_SourceInfoSplitLines( sText, file.aText );
+	file.bRead = true;
+
+	std::vector<SourceInfoSpan_t> aSpans;
+	for ( size_t iLine = 0; iLine < file.aText.size(); iLine++ )
+	{
+		const std::string & sLine = file.aText[ iLine ];
+		const char *p = sLine.c_str();
+
+		while ((*p == ' ') || (*p == '\t'))
+			p++;
+
+		// xxxx: or bb/xxxx:
+		const char *pAddress = p;
+		while (isxdigit( (unsigned char) *p ))
+			p++;
+		if ((*p == '/') && (p > pAddress))
+		{
+			pAddress = ++p;
+			while (isxdigit( (unsigned char) *p ))
+				p++;
+		}
+
+		int nAddress = -1;
+		if ((*p == ':') && (p > pAddress) && (p - pAddress <= 4))
+		{
+			nAddress = (int) strtol( pAddress, NULL, 16 );
+			p++;
+		}
+
+		// Bytes, one space apart
+		SourceAsmSegment_t bytes;
+		bytes.nAddress = (WORD) nAddress;
+		while ((nAddress >= 0) && (bytes.aBytes.size() < 4) && (p[ 0 ] == ' ') &&
+			isxdigit( (unsigned char) p[ 1 ] ) && isxdigit( (unsigned char) p[ 2 ] ) && ((p[ 3 ] == ' ') || (p[ 3 ] == '\t') || ! p[ 3 ]))
+		{
+			bytes.aBytes.push_back( (BYTE) strtol( std::string( p + 1, 2 ).c_str(), NULL, 16 ));
+			p += 3;
+		}
+
+		if (! bytes.aBytes.empty() && (nAddress + bytes.aBytes.size() - 1 <= _6502_MEM_END))
+		{
+			SourceInfoSpan_t span;
+			span.nFirst = nAddress;
+			span.nLast  = nAddress + (uint32_t) bytes.aBytes.size() - 1;
+			span.nRank  = (uint64_t) bytes.aBytes.size() << 16 | (iLine & 0xFFFF);
+			span.iItem  = info.AddLine( iFile, (int) iLine + 1 );
+			aSpans.push_back( span );
+			info.m_aBytes.push_back( bytes );
+		}
+
+		// Symbols:   label EQU $address   or   address: ... label DFB ...
+		std::vector<std::string> aTokens;
+		for ( ; *p; )
+		{
+			while ((*p == ' ') || (*p == '\t'))
+				p++;
+			const char *pToken = p;
+			while (*p && (*p != ' ') && (*p != '\t'))
+				p++;
+			if (p > pToken)
+				aTokens.push_back( std::string( pToken, p - pToken ));
+		}
+
+		for ( size_t iToken = 1; iToken < aTokens.size(); iToken++ )
+		{
+			const std::string & sLabel = aTokens[ iToken - 1 ];
+			if (! (isalpha( (unsigned char) sLabel[ 0 ] ) || (sLabel[ 0 ] == '_')))
+				continue;
+
+			SourceInfoSymbol_t symbol;
+			symbol.sName = sLabel.substr( 0, MAX_SYMBOLS_LEN );
+			if ((aTokens[ iToken ] == "EQU") && (iToken + 1 < aTokens.size()) && (aTokens[ iToken + 1 ][ 0 ] == '$'))
+			{
+				symbol.nAddress = (WORD) strtol( aTokens[ iToken + 1 ].c_str() + 1, NULL, 16 );
+				info.m_aSymbols.push_back( symbol );
+				break;
+			}
+			if ((aTokens[ iToken ] == "DFB") && (nAddress >= 0))
+			{
+				symbol.nAddress = (WORD) nAddress;
+				info.m_aSymbols.push_back( symbol );
+				break;
+			}
+		}
+	}
+
+	_SourceInfoBuildRanges( aSpans, info.m_aLineRanges );
+	if (info.m_aLineRanges.empty())
+	{
+		sError_ = "No addresses in listing: " + sPathName;
+		return false;
+	}
+
+	*this = std::move( info );
+	return true;
+}
+
+//===========================================================================
+void SourceInfo_t::LoadAssembly ( const SourceAsmResult_t & result )
+{
+	Clear();
+
+	for ( const std::string & sPathName : result.aFiles )
+		AddFile( _SourceInfoBaseName( sPathName ), sPathName );
+
+	std::vector<SourceInfoSpan_t> aSpans;
+	for ( const SourceAsmLine_t & line : result.aLines )
+	{
+		if (! line.nBytes)
+			continue;
+
+		SourceInfoSpan_t span;
+		span.nFirst = line.nAddress;
+		span.nLast  = line.nAddress + line.nBytes - 1u;
+		span.nRank  = (uint64_t) line.nBytes << 16;
+		span.iItem  = AddLine( line.iFile, line.nLine );
+		if (span.nLast <= _6502_MEM_END)
+			aSpans.push_back( span );
+	}
+	_SourceInfoBuildRanges( aSpans, m_aLineRanges );
+
+	// A label is the scope up to the next label, in its segment (the last of labels at the same address)
+	std::vector<SourceInfoSymbol_t> aLabels;
+	for ( const SourceAsmSymbol_t & symbol : result.aSymbols )
+	{
+		SourceInfoSymbol_t label;
+		label.sName    = symbol.sName;
+		label.nAddress = symbol.nAddress;
+		m_aSymbols.push_back( label );
+		if (! symbol.bEquate)
+			aLabels.push_back( label );
+	}
+	std::stable_sort( aLabels.begin(), aLabels.end(),
+		[]( const SourceInfoSymbol_t & a, const SourceInfoSymbol_t & b ) { return a.nAddress < b.nAddress; } );
+
+	aSpans.clear();
+	for ( size_t iLabel = 0; iLabel < aLabels.size(); iLabel++ )
+	{
+		const uint32_t nAddress = aLabels[ iLabel ].nAddress;
+		const uint32_t nNext    = (iLabel + 1 < aLabels.size()) ? aLabels[ iLabel + 1 ].nAddress : _6502_MEM_END + 1;
+		if (nNext == nAddress)
+			continue;
+
+		for ( const SourceAsmSegment_t & segment : result.aSegments )
+		{
+			const uint32_t nEnd = segment.nAddress + (uint32_t) segment.aBytes.size(); // exclusive
+			if ((nAddress < segment.nAddress) || (nAddress >= nEnd))
+				continue;
+
+			SourceInfoSpan_t span;
+			span.nFirst = nAddress;
+			span.nLast  = std::min( nEnd, nNext ) - 1;
+			span.nRank  = iLabel;
+			span.iItem = (int) m_aScopes.size();
+			aSpans.push_back( span );
+
+			SourceInfoScope_t scope;
+			scope.sName   = aLabels[ iLabel ].sName;
+			scope.iParent = -1;
+			m_aScopes.push_back( scope );
+			break;
+		}
+	}
+	_SourceInfoBuildRanges( aSpans, m_aScopeRanges );
+}
+
+//===========================================================================
+bool SourceInfo_t::LoadFile ( const std::string & sPathName, std::string & sError_ )
+{
+	std::string sText;
+	if (! _SourceInfoReadFile( sPathName, sText ))
+	{
+		sError_ = "Couldn't read: " + sPathName;
+		return false;
+	}
+
+	if (sText.compare( 0, 8, "version\t" ) == 0)
+		return LoadDbg( sText, sPathName, sError_ );
+
+	return LoadListing( sText, sPathName, sError_ );
+}
+
+//===========================================================================
+int SourceInfo_t::WriteMemory () const
+{
+	int nBytes = 0;
+	for ( const SourceAsmSegment_t & bytes : m_aBytes )
+	{
+		for ( size_t iByte = 0; iByte < bytes.aBytes.size(); iByte++ )
+			WriteByteToMemory( (WORD)(bytes.nAddress + iByte), bytes.aBytes[ iByte ] );
+		nBytes += (int) bytes.aBytes.size();
+	}
+	return nBytes;
+}
+
+//===========================================================================
+const SourceInfoRange_t * SourceInfo_t::FindLine ( const WORD nAddress ) const
+{
+	return _SourceInfoFindRange( m_aLineRanges, nAddress );
+}
+
+//===========================================================================
+const SourceInfoRange_t * SourceInfo_t::FindScope ( const WORD nAddress ) const
+{
+	return _SourceInfoFindRange( m_aScopeRanges, nAddress );
+}
+
+//===========================================================================
+const SourceInfoFile_t & SourceInfo_t::GetFile ( const int iFile )
+{
+	SourceInfoFile_t & file = m_aFiles[ iFile ];
+	if (! file.bRead)
+	{
+		std::string sText;
+		if (_SourceInfoReadFile( file.sPathName, sText ))
+			_SourceInfoSplitLines( sText, file.aText );
+		file.bRead = true;
+	}
+	return file;
+}
+
+//===========================================================================
+void SourceInfo_t::SetFileText ( const int iFile, const std::string & sText )
+{
+	_SourceInfoSplitLines( sText, m_aFiles[ iFile ].aText );
+	m_aFiles[ iFile ].bRead = true;
+}
+
+//===========================================================================
+bool SourceInfoSameLine ( const SourceInfoLine_t & a, const SourceInfoLine_t & b )
+{
+	return (a.iFile == b.iFile) && (a.nLine == b.nLine);
+}
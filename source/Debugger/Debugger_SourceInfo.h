@@ -0,0 +1,91 @@
+#pragma once
+
+// Source Level Debugging _________________________________________________________________________
+
+	// Where the code came from: the source file & line, and the scope, of each address.
+	// Loaded from a cc65 debug info file (ld65 --dbgfile), an assembler listing (Merlin), or the ASM command.
+	// Lookups are a binary search in sorted, non-overlapping address ranges, built once when loading:
+	// where spans overlap, the innermost wins (and a C line over an assembler line over a macro line).
+
+	struct SourceInfoFile_t
+	{
+		std::string              sName    ; // as shown
+		std::string              sPathName; // to read the text from
+		std::vector<std::string> aText    ; // read on first use
+		bool                     bRead    ;
+	};
+
+	struct SourceInfoLine_t
+	{
+		int iFile; // SourceInfo_t::GetFile()
+		int nLine; // 1 based
+	};
+
+	struct SourceInfoScope_t
+	{
+		std::string sName  ; // qualified, outer::inner
+		int         iParent; // -1 if none
+	};
+
+	struct SourceInfoSymbol_t
+	{
+		std::string sName   ;
+		WORD        nAddress;
+	};
+
+	struct SourceInfoRange_t // nFirst .. nLast -> line or scope
+	{
+		WORD nFirst;
+		WORD nLast ;
+		int  iItem ;
+	};
+
+	class SourceInfo_t
+	{
+	public:
+		SourceInfo_t();
+
+		void Clear();
+		bool IsEmpty() const { return m_aLineRanges.empty(); }
+
+		// On failure, sError_ is set & the previous info is kept
+		bool LoadDbg    ( const std::string & sText, const std::string & sPathName, std::string & sError_ );
+		bool LoadListing( const std::string & sText, const std::string & sPathName, std::string & sError_ );
+		void LoadAssembly( const SourceAsmResult_t & result );
+		bool LoadFile   ( const std::string & sPathName, std::string & sError_ ); // .dbg, else a listing
+
+		// Listing only: the bytes on each line, written to memory with WriteMemory()
+		int  WriteMemory() const;
+
+		const SourceInfoRange_t * FindLine ( const WORD nAddress ) const; // iItem: GetLine(), NULL if none
+		const SourceInfoRange_t * FindScope( const WORD nAddress ) const; // iItem: GetScope()
+
+		const SourceInfoLine_t  & GetLine ( const int iLine  ) const { return m_aLines [ iLine  ]; }
+		const SourceInfoScope_t & GetScope( const int iScope ) const { return m_aScopes[ iScope ]; }
+		const SourceInfoFile_t  & GetFile ( const int iFile  ); // reads the text
+		void                      SetFileText( const int iFile, const std::string & sText );
+
+		int GetNumFiles () const { return (int) m_aFiles .size(); }
+		int GetNumLines () const { return (int) m_aLines .size(); }
+		int GetNumScopes() const { return (int) m_aScopes.size(); }
+		int GetNumRanges() const { return (int)(m_aLineRanges.size() + m_aScopeRanges.size()); }
+
+		const std::vector<SourceInfoSymbol_t> & GetSymbols() const { return m_aSymbols; }
+
+	private:
+		int  AddFile( const std::string & sName, const std::string & sPathName );
+		int  AddLine( const int iFile, const int nLine );
+
+		std::vector<SourceInfoFile_t>    m_aFiles      ;
+		std::vector<SourceInfoLine_t>    m_aLines      ;
+		std::vector<SourceInfoScope_t>   m_aScopes     ;
+		std::vector<SourceInfoSymbol_t>  m_aSymbols    ;
+		std::vector<SourceInfoRange_t>   m_aLineRanges ;
+		std::vector<SourceInfoRange_t>   m_aScopeRanges;
+		std::vector<SourceAsmSegment_t>  m_aBytes      ; // listing
+		std::map<uint64_t, int>          m_aLineIndex  ; // file & line -> m_aLines[]
+	};
+
+	extern SourceInfo_t g_SourceInfo;
+
+	bool SourceInfoSameLine( const SourceInfoLine_t & a, const SourceInfoLine_t & b );
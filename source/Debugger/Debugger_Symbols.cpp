@@ -33,6 +33,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "../Windows/AppleWin.h"
 #include "../Core.h"
 
+#include <array>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
 	// 2.6.2.13 Added: Can now enable/disable selected symbol table(s) !
 	// Allow the user to disable/enable symbol tables
 	// xxx1xxx symbol table is active (are displayed in disassembly window, etc.)
@@ -73,6 +78,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	SymbolTable_t g_aSymbols[ NUM_SYMBOL_TABLES ];
 	int           g_nSymbolsLoaded = 0;  // on Last Load
 
+	// Lookup index for each symbol table, kept in sync with g_aSymbols[]
+	// Only modify the tables through SymbolTableInsert(), SymbolTableErase(), _CmdSymbolsClear()
+	struct SymbolIndex_t
+	{
+		typedef std::array<std::string const*, 256> Page_t;
+
+		std::unique_ptr<Page_t>               aPages[ 256 ]; // Address -> Symbol (node in the table), a page allocated on its first insert
+		std::unordered_map<std::string, WORD> mName;    // Upper-case Symbol -> lowest Address with that name
+	};
+
+	static SymbolIndex_t g_aSymbolIndex[ NUM_SYMBOL_TABLES ];
+
 // Utils _ ________________________________________________________________________________________
 
 	std::string _CmdSymbolsInfoHeader( int iTable, int nDisplaySize = 0 );
@@ -82,6 +99,96 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 // Private ________________________________________________________________________________________
 
+//===========================================================================
+static std::string _SymbolIndexKey( const char* pSymbol )
+{
+	std::string sKey( pSymbol );
+	for (char& c : sKey)
+		c = (char) toupper( (unsigned char) c );
+	return sKey;
+}
+
+// Re-point the name index to the lowest remaining address with this name (if any)
+// Only needed when an address owning the index entry is removed or renamed, which is rare
+//===========================================================================
+static void _SymbolIndexRescanName( const SymbolTable_t& aSymbols, SymbolIndex_t& index, const std::string& sKey )
+{
+	index.mName.erase( sKey );
+
+	for (SymbolTable_t::const_iterator iSymbol = aSymbols.begin(); iSymbol != aSymbols.end(); ++iSymbol)
+	{
+		if (!_stricmp( iSymbol->second.c_str(), sKey.c_str() ))
+		{
+			index.mName[ sKey ] = iSymbol->first;
+			break;
+		}
+	}
+}
+
+//===========================================================================
+static std::string const* _SymbolIndexFindName( const SymbolIndex_t& index, WORD nAddress )
+{
+	const SymbolIndex_t::Page_t* pPage = index.aPages[ nAddress >> 8 ].get();
+	return pPage ? (*pPage)[ nAddress & 0xFF ] : NULL;
+}
+
+// @param sKey see _SymbolIndexKey()
+//===========================================================================
+static bool _SymbolIndexFindAddress( const SymbolIndex_t& index, const std::string& sKey, WORD * pAddress_ )
+{
+	std::unordered_map<std::string, WORD>::const_iterator iName = index.mName.find( sKey );
+	if (iName == index.mName.end())
+		return false;
+
+	if (pAddress_)
+	{
+		*pAddress_ = iName->second;
+	}
+	return true;
+}
+
+//===========================================================================
+static void _SymbolIndexErase( SymbolTable_t& aSymbols, SymbolIndex_t& index, WORD nAddress )
+{
+	SymbolTable_t::iterator iSymbol = aSymbols.find( nAddress );
+	if (iSymbol == aSymbols.end())
+		return;
+
+	const std::string sKey = _SymbolIndexKey( iSymbol->second.c_str() );
+
+	(*index.aPages[ nAddress >> 8 ])[ nAddress & 0xFF ] = NULL;
+	aSymbols.erase( iSymbol );
+
+	std::unordered_map<std::string, WORD>::iterator iName = index.mName.find( sKey );
+	if ((iName != index.mName.end()) && (iName->second == nAddress))
+		_SymbolIndexRescanName( aSymbols, index, sKey );
+}
+
+//===========================================================================
+static void _SymbolIndexInsert( SymbolTable_t& aSymbols, SymbolIndex_t& index, WORD nAddress, const std::string& sName )
+{
+	// Renaming an existing address: drop the old name first
+	_SymbolIndexErase( aSymbols, index, nAddress );
+
+	SymbolTable_t::iterator iSymbol = aSymbols.emplace( nAddress, sName ).first;
+
+	std::unique_ptr<SymbolIndex_t::Page_t>& pPage = index.aPages[ nAddress >> 8 ];
+	if (!pPage)
+	{
+		pPage.reset( new SymbolIndex_t::Page_t );
+		pPage->fill( NULL );
+	}
+	(*pPage)[ nAddress & 0xFF ] = &iSymbol->second;
+
+	// Duplicate names resolve to the lowest address, same as a linear scan of the map
+	const std::string sKey = _SymbolIndexKey( sName.c_str() );
+	std::unordered_map<std::string, WORD>::iterator iName = index.mName.find( sKey );
+	if (iName == index.mName.end())
+		index.mName.emplace( sKey, nAddress );
+	else if (nAddress < iName->second)
+		iName->second = nAddress;
+}
+
 //===========================================================================
 void _PrintCurrentPath()
 {
@@ -148,20 +255,17 @@ std::string const* FindSymbolFromAddress (WORD nAddress, int * iTable_ )
 
 	while (iTable-- > 0)
 	{
-		if (! g_aSymbols[iTable].size())
-			continue;
-
 		if (! (g_bDisplaySymbolTables & (1 << iTable)))
 			continue;
 
-		std::map<WORD, std::string>::iterator iSymbols = g_aSymbols[iTable].find(nAddress);
-		if (g_aSymbols[iTable].find(nAddress) != g_aSymbols[iTable].end())
+		std::string const* pSymbol = _SymbolIndexFindName( g_aSymbolIndex[iTable], nAddress );
+		if (pSymbol)
 		{
 			if (iTable_)
 			{
 				*iTable_ = iTable;
 			}
-			return &iSymbols->second;
+			return pSymbol;
 		}
 	}	
 	return NULL;
@@ -170,6 +274,8 @@ std::string const* FindSymbolFromAddress (WORD nAddress, int * iTable_ )
 //===========================================================================
 bool FindAddressFromSymbol ( const char* pSymbol, WORD * pAddress_, int * iTable_ )
 {
+	const std::string sKey = _SymbolIndexKey( pSymbol );
+
 	// Bugfix/User feature: User symbols should be searched first
 	for (int iTable = NUM_SYMBOL_TABLES; iTable-- > 0; )
 	{
@@ -179,27 +285,31 @@ bool FindAddressFromSymbol ( const char* pSymbol, WORD * pAddress_, int * iTable
 		if (! (g_bDisplaySymbolTables & (1 << iTable)))
 			continue;
 
-		SymbolTable_t :: iterator  iSymbol = g_aSymbols[iTable].begin();
-		while (iSymbol != g_aSymbols[iTable].end())
+		if (_SymbolIndexFindAddress( g_aSymbolIndex[iTable], sKey, pAddress_ ))
 		{
-			if (!_stricmp( iSymbol->second.c_str(), pSymbol))
+			if (iTable_)
 			{
-				if (pAddress_)
-				{
-					*pAddress_ = iSymbol->first;
-				}
-				if (iTable_)
-				{
-					*iTable_ = iTable;
-				}
-				return true;
+				*iTable_ = iTable;
 			}
-			iSymbol++;
+			return true;
 		}
 	}
 	return false;
 }
 
+//===========================================================================
+void SymbolTableInsert ( SymbolTable_Index_e eSymbolTable, WORD nAddress, const std::string& sName )
+{
+	_SymbolIndexInsert( g_aSymbols[ eSymbolTable ], g_aSymbolIndex[ eSymbolTable ], nAddress, sName );
+	DisasmCacheInvalidate();
+}
+
+//===========================================================================
+void SymbolTableErase ( SymbolTable_Index_e eSymbolTable, WORD nAddress )
+{
+	_SymbolIndexErase( g_aSymbols[ eSymbolTable ], g_aSymbolIndex[ eSymbolTable ], nAddress );
+	DisasmCacheInvalidate();
+}
 
 
 // Symbols ________________________________________________________________________________________
@@ -551,6 +661,72 @@ Update_t _CmdSymbolsListTables (int nArgs, int bSymbolTables )
 }
 
 
+// Cut the next line off the text (tokenized in place), and move pNextLine_ past its end of line
+//===========================================================================
+static char* _NextSymbolLine( char *& pNextLine_ )
+{
+	char *szLine = pNextLine_;
+	char *pEOL   = strpbrk( szLine, "\r\n" );
+	if (pEOL)
+	{
+		pNextLine_ = pEOL + strspn( pEOL, "\r\n" );
+		*pEOL = 0;
+	}
+	else
+	{
+		pNextLine_ = szLine + strlen( szLine );
+	}
+	return szLine;
+}
+
+// Parse one line of a symbol file, see ParseSymbolTable() for the supported formats
+// Equivalent to sscanf( "%x %51s" ) and sscanf( "%51s %x" ) respectively
+//===========================================================================
+static void _ParseSymbolLine( char *szLine, uint32_t & nAddress_, char *sName_ )
+{
+	char *pEnd;
+
+	if (strchr( szLine, '$' ) == NULL)
+	{
+		// 1) AppleWin: address name
+		const char *pAddress = SkipWhiteSpace( szLine );
+		if (!isxdigit( (unsigned char) *pAddress ))
+			return;
+
+		nAddress_ = (uint32_t) strtoul( pAddress, &pEnd, 16 );
+
+		const char *pName    = SkipWhiteSpace( pEnd );
+		const char *pNameEnd = SkipUntilWhiteSpace( pName );
+		const size_t nLen    = std::min<size_t>( pNameEnd - pName, MAX_SYMBOLS_LEN );
+		memcpy( sName_, pName, nLen );
+		sName_[ nLen ] = 0;
+	}
+	else
+	{
+		// 2) ACME: name =$address ; comment
+		char *p = strchr( szLine, ';' );		// Optional
+		if (p) *p = 0;
+
+		const char *pName    = SkipWhiteSpace( szLine );
+		const char *pNameEnd = pName;
+		while (*pNameEnd && !isspace( (unsigned char) *pNameEnd ) && (*pNameEnd != '=') && (*pNameEnd != '$'))
+			pNameEnd++;
+
+		const size_t nLen = std::min<size_t>( pNameEnd - pName, MAX_SYMBOLS_LEN );
+		memcpy( sName_, pName, nLen );
+		sName_[ nLen ] = 0;
+
+		const char *pAddress = SkipWhiteSpace( pNameEnd );
+		if (*pAddress == '=')	// Optional
+			pAddress = SkipWhiteSpace( pAddress + 1 );
+		if (*pAddress == '$')
+			pAddress = SkipWhiteSpace( pAddress + 1 );
+
+		if (isxdigit( (unsigned char) *pAddress ))
+			nAddress_ = (uint32_t) strtoul( pAddress, &pEnd, 16 );
+	}
+}
+
 //===========================================================================
 int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSymbolTableWrite, int nSymbolOffset )
 {
@@ -563,10 +739,7 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 	if (pPathFileName.empty())
 		return nSymbolsLoaded;
 
-	std::string sFormat1 = StrFormat( "%%x %%%ds", MAX_SYMBOLS_LEN ); // i.e. "%x %51s"
-	std::string sFormat2 = StrFormat( "%%%ds %%x", MAX_SYMBOLS_LEN ); // i.e. "%51s %x"
-
-	FILE *hFile = fopen( pPathFileName.c_str(), "rt" );
+	FILE *hFile = fopen( pPathFileName.c_str(), "rb" );
 
 	if ( !hFile && g_bSymbolsDisplayMissingFile )
 	{
@@ -575,11 +748,30 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 		_PrintCurrentPath();
 		nSymbolsLoaded = -1; // HACK: ERROR: FILE NOT EXIST
 	}
+
+	// Read the whole file in one go and tokenize it in place: single pass, no per-line sscanf()
+	std::vector<char> aFile;
+	if ( hFile )
+	{
+		fseek( hFile, 0, SEEK_END );
+		const long nFileSize = ftell( hFile );
+		fseek( hFile, 0, SEEK_SET );
+
+		if (nFileSize > 0)
+		{
+			aFile.resize( nFileSize + 1 );
+			aFile.resize( fread( &aFile[0], 1, nFileSize, hFile ) + 1 );
+			aFile.back() = 0;
+		}
+		fclose( hFile );
+		hFile = NULL;
+	}
 	
 	bool bDupSymbolHeader = false;
-	if ( hFile )
+	char *pNextLine = aFile.empty() ? NULL : &aFile[0];
+	if ( pNextLine )
 	{
-		while ( !feof(hFile) )
+		while ( *pNextLine )
 		{
 			// Support 2 types of symbols files:
 			// 1) AppleWin:
@@ -592,38 +784,8 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 			uint32_t nAddress = _6502_MEM_END + 1; // default to invalid address
 			char  sName[ MAX_SYMBOLS_LEN+1 ]  = "";
 
-			const int MAX_LINE = 256;
-			char  szLine[ MAX_LINE ] = "";
-
-			if ( !fgets(szLine, MAX_LINE-1, hFile) )	// Get next line
-			{
-				//ConsolePrint("<<EOF");
-				break;
-			}
-
-			if (strstr(szLine, "$") == NULL)
-			{
-				sscanf(szLine, sFormat1.c_str(), &nAddress, sName);
-			}
-			else
-			{
-				char* p = strstr(szLine, "=");	// Optional
-				if (p) *p = ' ';
-				p = strstr(szLine, "$");
-				if (p) *p = ' ';
-				p = strstr(szLine, ";");		// Optional
-				if (p) *p = 0;
-				p = strstr(szLine, " ");		// 1st space between name & value
-				if (p)
-				{
-					int nLen = (int) (p - szLine);
-					if (nLen > MAX_SYMBOLS_LEN)
-					{
-						memset(&szLine[MAX_SYMBOLS_LEN], ' ', nLen - MAX_SYMBOLS_LEN);	// sscanf fails for nAddress if string too long
-					}
-				}
-				sscanf(szLine, sFormat2.c_str(), sName, &nAddress);
-			}
+			char *szLine = _NextSymbolLine( pNextLine );
+			_ParseSymbolLine( szLine, nAddress, sName );
 
 			// SymbolOffset
 			nAddress += nSymbolOffset;
@@ -746,10 +908,9 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 	
 			// else // It is not a bug to have duplicate addresses by different names
 
-			g_aSymbols[ eSymbolTableWrite ] [ (WORD) nAddress ] = sName;
+			SymbolTableInsert( eSymbolTableWrite, (WORD) nAddress, sName );
 			nSymbolsLoaded++; // TODO: FIXME: BUG: This is the total symbols read, not added
 		}
-		fclose(hFile);
 	}
 
 	return nSymbolsLoaded;
@@ -875,6 +1036,10 @@ Update_t CmdSymbolsLoad (int nArgs)
 Update_t _CmdSymbolsClear( SymbolTable_Index_e eSymbolTable )
 {
 	g_aSymbols[ eSymbolTable ].clear();
+	for (std::unique_ptr<SymbolIndex_t::Page_t>& pPage : g_aSymbolIndex[ eSymbolTable ].aPages)
+		pPage.reset();
+	g_aSymbolIndex[ eSymbolTable ].mName.clear();
+	DisasmCacheInvalidate();
 	
 	return UPDATE_SYMBOLS;
 }
@@ -910,7 +1075,7 @@ void SymbolUpdate ( SymbolTable_Index_e eSymbolTable, const char *pSymbolName, W
 					ConsoleBufferPush( " Removing symbol." );
 				}
 
-				g_aSymbols[ eSymbolTable ].erase( nAddressPrev );
+				SymbolTableErase( eSymbolTable, nAddressPrev );
 
 				if (bUpdateSymbol)
 				{
@@ -941,7 +1106,7 @@ void SymbolUpdate ( SymbolTable_Index_e eSymbolTable, const char *pSymbolName, W
 				// TODO: Probably should check if same name?
 			}
 #endif
-			g_aSymbols[ eSymbolTable ][ nAddress ] = pSymbolName;
+			SymbolTableInsert( eSymbolTable, nAddress, pSymbolName );
 
 			// 2.9.1.26: When adding symbols list the address first then the name for readability
 			// Tell user symbol was added
@@ -1126,6 +1291,79 @@ Update_t CmdSymbolsCommand (int nArgs)
 	return _CmdSymbolsCommon( nArgs, bSymbolTable ); // BUGFIX 2.6.2.12 Hard-coded to SYMMAIN
 }
 
+// Time loading a generated symbol table and looking up every symbol by name and address
+// The text is generated in memory and loaded into a scratch table: the symbol tables & files are left alone
+//===========================================================================
+Update_t SymbolsBenchmark (int nSymbols)
+{
+	nSymbols = std::max( 1, std::min<int>( nSymbols, _6502_MEM_LEN ) );
+
+	std::string sText;
+	for (int iSymbol = 0; iSymbol < nSymbols; iSymbol++)
+	{
+		// Alternate both supported formats
+		if (iSymbol & 1)
+			sText += StrFormat( "%04X BENCH_%05d\n", iSymbol, iSymbol );
+		else
+			sText += StrFormat( "bench_%05d =$%04X ; comment\n", iSymbol, iSymbol );
+	}
+	std::vector<char> aText( sText.begin(), sText.end() );
+	aText.push_back( 0 );
+
+	SymbolTable_t aSymbols;
+	SymbolIndex_t index;
+
+	typedef std::chrono::steady_clock clock_t;
+	const clock_t::time_point tStart = clock_t::now();
+
+	int nLoaded = 0;
+	char *pNextLine = &aText[0];
+	while (*pNextLine)
+	{
+		uint32_t nAddress = _6502_MEM_END + 1; // default to invalid address
+		char  sName[ MAX_SYMBOLS_LEN+1 ]  = "";
+
+		_ParseSymbolLine( _NextSymbolLine( pNextLine ), nAddress, sName );
+		if ( (nAddress > _6502_MEM_END) || (sName[0] == 0) )
+			continue;
+
+		_SymbolIndexInsert( aSymbols, index, (WORD) nAddress, sName );
+		nLoaded++;
+	}
+
+	const clock_t::time_point tLoaded = clock_t::now();
+
+	// Both ways must give back what was generated
+	int nFound = 0;
+	for (int iSymbol = 0; iSymbol < nSymbols; iSymbol++)
+	{
+		const std::string sName = StrFormat( "BENCH_%05d", iSymbol );
+
+		WORD nAddress;
+		if (_SymbolIndexFindAddress( index, _SymbolIndexKey( sName.c_str() ), &nAddress ) && (nAddress == iSymbol))
+			nFound++;
+
+		std::string const* pSymbol = _SymbolIndexFindName( index, (WORD) iSymbol );
+		if (pSymbol && !_stricmp( pSymbol->c_str(), sName.c_str() ))
+			nFound++;
+	}
+
+	const clock_t::time_point tFound = clock_t::now();
+
+	typedef std::chrono::microseconds interval_t;
+	ConsolePrintFormat( " Symbols loaded: " CHC_NUM_DEC "%d" CHC_DEFAULT " in " CHC_NUM_DEC "%d" CHC_DEFAULT " us"
+		, nLoaded
+		, (int) std::chrono::duration_cast<interval_t>( tLoaded - tStart ).count()
+	);
+	ConsolePrintFormat( " Lookups found : " CHC_NUM_DEC "%d" CHC_ARG_SEP "/" CHC_NUM_DEC "%d" CHC_DEFAULT " in " CHC_NUM_DEC "%d" CHC_DEFAULT " us"
+		, nFound
+		, nSymbols * 2
+		, (int) std::chrono::duration_cast<interval_t>( tFound - tLoaded ).count()
+	);
+
+	return ConsoleUpdate();
+}
+
 //===========================================================================
 Update_t CmdSymbolsSave (int nArgs)
 {
@@ -2,6 +2,7 @@
 // Variables
 	extern 	SymbolTable_t g_aSymbols[ NUM_SYMBOL_TABLES ];
 	extern bool g_bSymbolsDisplayMissingFile;
+	extern int  g_bDisplaySymbolTables;
 
 // Prototypes
 
@@ -22,3 +23,9 @@
 	void SymbolUpdate(SymbolTable_Index_e eSymbolTable, const char* pSymbolName, WORD nAddrss, bool bRemoveSymbol, bool bUpdateSymbol);
 	std::string const* FindSymbolFromAddress(WORD nAdress, int* iTable_ = NULL);
 	std::string const& GetSymbol(WORD nAddress, int nBytes, std::string& strAddressBuf);
+
+	// Symbol Table / Index -- use these instead of modifying g_aSymbols[] directly
+	void SymbolTableInsert(SymbolTable_Index_e eSymbolTable, WORD nAddress, const std::string& sName);
+	void SymbolTableErase(SymbolTable_Index_e eSymbolTable, WORD nAddress);
+
+	Update_t SymbolsBenchmark(int nSymbols);
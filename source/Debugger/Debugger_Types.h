@@ -242,7 +242,10 @@
 			bTemp = false;
 			bHit = false;
 			bStop = false;
+			bLog = false;
+			bCondition = false;
 			nHitCount = 0;
+			nHitTarget = 0;
 
 			addrPrefix.Clear();
 		};
@@ -256,7 +259,10 @@
 		bool                 bTemp     ; // If true then remove BP when hit or stepping cancelled (eg. G xxxx)
 		bool                 bHit      ; // true when the breakpoint has just been hit
 		bool                 bStop     ; // true if the debugger stops when it is hit
+		bool                 bLog      ; // true if a hit is logged to the console (tracepoint)
+		bool                 bCondition; // true if g_aBreakpointConditions[] must also evaluate true
 		uint32_t             nHitCount ; // number of times the breakpoint was hit
+		uint32_t             nHitTarget; // only stop once nHitCount reaches this (0 = always)
 		AddressPrefix_t      addrPrefix;
 	};
 
@@ -329,6 +335,7 @@
 	{
 // Assembler
 		  CMD_ASSEMBLE
+		, CMD_ASSEMBLE_SOURCE
 // CPU
 		, CMD_CURSOR_JUMP_PC // Shift
 		, CMD_CURSOR_SET_PC  // Ctrl
@@ -351,10 +358,12 @@
 //		, CMD_STACK_RETURN
 		, CMD_STEP_OVER
 		, CMD_STEP_OUT
+		, CMD_STEP_OVER_SOURCE
 // CPU - Meta Info
 		, CMD_TRACE
 		, CMD_TRACE_FILE
 		, CMD_TRACE_LINE
+		, CMD_TRACE_SOURCE
 		, CMD_UNASSEMBLE
 // Bookmarks
 		, CMD_BOOKMARK
@@ -389,6 +398,10 @@
 //		, CMD_BREAKPOINT_LOAD
 		, CMD_BREAKPOINT_SAVE
 		, CMD_BREAKPOINT_CHANGE
+		, CMD_BREAKPOINT_ADD_COND  // break on: <expression> is true
+		, CMD_BREAKPOINT_ADD_TRACE // log  on: <expression> is true
+		, CMD_BREAKPOINT_CONDITION
+		, CMD_BREAKPOINT_HIT_COUNT
 // Benchmark / Timing
 //		, CMD_BENCHMARK_START
 //		, CMD_BENCHMARK_STOP
@@ -634,6 +647,7 @@
 
 // Assembler
 	Update_t CmdAssemble              (int nArgs);
+	Update_t CmdAssembleSource        (int nArgs);
 
 // Disassembler Data
 	Update_t CmdDisasmDataDefCode     (int nArgs);
@@ -672,9 +686,11 @@
 	Update_t CmdLBR                (int nArgs);
 	Update_t CmdStepOver           (int nArgs);
 	Update_t CmdStepOut            (int nArgs);
+	Update_t CmdStepOverSource     (int nArgs);
 	Update_t CmdTrace              (int nArgs);  // alias for CmdStepIn
 	Update_t CmdTraceFile          (int nArgs);
 	Update_t CmdTraceLine          (int nArgs);
+	Update_t CmdTraceSource        (int nArgs);
 	Update_t CmdUnassemble         (int nArgs); // code dump, aka, Unassemble
 // Bookmarks
 	Update_t CmdBookmark           (int nArgs);
@@ -703,6 +719,10 @@
 	Update_t CmdBreakpointList     (int nArgs);
 //	Update_t CmdBreakpointLoad     (int nArgs);
 	Update_t CmdBreakpointSave     (int nArgs);
+	Update_t CmdBreakpointAddCond  (int nArgs);
+	Update_t CmdBreakpointAddTrace (int nArgs);
+	Update_t CmdBreakpointCondition(int nArgs);
+	Update_t CmdBreakpointHitCount (int nArgs);
 // Benchmark
 	Update_t CmdBenchmark          (int nArgs);
 	Update_t CmdBenchmarkStart     (int nArgs); //Update_t CmdSetupBenchmark (int nArgs);
@@ -1416,6 +1436,8 @@ const	DisasmData_t* pDisasmData; // If != NULL then bytes are marked up as data
 		, PARAM_BP_CHANGE_TEMP_OFF // t
 		, PARAM_BP_CHANGE_STOP_ON  // S
 		, PARAM_BP_CHANGE_STOP_OFF // s
+		, PARAM_BP_CHANGE_LOG_ON   // L
+		, PARAM_BP_CHANGE_LOG_OFF  // l
 	, _PARAM_BP_CHANGE_END
 	,  PARAM_BP_CHANGE_NUM = _PARAM_BP_CHANGE_END - _PARAM_BP_CHANGE_BEGIN
 
@@ -1574,8 +1596,6 @@ const	DisasmData_t* pDisasmData; // If != NULL then bytes are marked up as data
 		NO_SOURCE_LINE = -1
 	};
 
-	typedef std::map<WORD, int> SourceAssembly_t; // Address -> Line #  &  FileName
-
 
 // Symbols ________________________________________________________________________________________
 
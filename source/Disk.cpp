@@ -110,6 +110,14 @@ int    Disk2InterfaceCard::GetCurrentTrack      (void) { return ImagePhaseToTrac
 float Disk2InterfaceCard::GetPhase(const int drive) { return m_floppyDrive[drive].m_phasePrecise; }
 int   Disk2InterfaceCard::GetTrack(const int drive)  { return ImagePhaseToTrack(m_floppyDrive[drive].m_disk.m_imagehandle, m_floppyDrive[drive].m_phasePrecise, false); }
 
+UINT Disk2InterfaceCard::GetImageBufferSize(void)
+{
+	UINT size = 0;
+	for (UINT i = DRIVE_1; i < NUM_DRIVES; i++)
+		size += ImageGetImageBufferSize(m_floppyDrive[i].m_disk.m_imagehandle);
+	return size;
+}
+
 std::string Disk2InterfaceCard::FormatIntFracString(float phase, bool hex)
 {
 	const UINT phaseInt = (UINT)phase;
@@ -1125,7 +1133,7 @@ void __stdcall Disk2InterfaceCard::ReadWrite(WORD pc, WORD addr, BYTE bWrite, BY
 		if (m_bLogDisk_NibblesRW)
   #endif
 		{
-			LOG_DISK("read %04X = %02X\r\n", pFloppy->m_byte, m_floppyLatch);
+			LOG_DISK_TRACE("read %04X = %02X\r\n", pFloppy->m_byte, m_floppyLatch);
 		}
 
 		m_formatTrack.DecodeLatchNibbleRead(m_floppyLatch);
@@ -1153,9 +1161,9 @@ void __stdcall Disk2InterfaceCard::ReadWrite(WORD pc, WORD addr, BYTE bWrite, BY
   #endif
 		{
 			if (!bIsSyncFF)
-				LOG_DISK("write %04X = %02X (cy=+%d)\r\n", pFloppy->m_byte, m_floppyLatch, uCycleDelta);
+				LOG_DISK_TRACE("write %04X = %02X (cy=+%d)\r\n", pFloppy->m_byte, m_floppyLatch, uCycleDelta);
 			else
-				LOG_DISK("write %04X = %02X (cy=+%d) sync #%d\r\n", pFloppy->m_byte, m_floppyLatch, uCycleDelta, m_uSyncFFCount);
+				LOG_DISK_TRACE("write %04X = %02X (cy=+%d) sync #%d\r\n", pFloppy->m_byte, m_floppyLatch, uCycleDelta, m_uSyncFFCount);
 		}
 #endif
 	}
@@ -1452,7 +1460,7 @@ void Disk2InterfaceCard::DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemain
 #if LOG_DISK_NIBBLES_READ
 				if (m_dbgLatchDelayedCnt >= 3)
 				{
-					LOG_DISK("read: latch held due to 0: PC=%04X, cnt=%02X\r\n", regs.pc, m_dbgLatchDelayedCnt);
+					LOG_DISK_TRACE("read: latch held due to 0: PC=%04X, cnt=%02X\r\n", regs.pc, m_dbgLatchDelayedCnt);
 				}
 #endif
 			}
@@ -1463,7 +1471,7 @@ void Disk2InterfaceCard::DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemain
 #if LOG_DISK_NIBBLES_READ
 			if (newLatchData)
 			{
-				LOG_DISK("read skipped latch data: %04X = %02X\r\n", floppy.m_byte, m_floppyLatch);
+				LOG_DISK_TRACE("read skipped latch data: %04X = %02X\r\n", floppy.m_byte, m_floppyLatch);
 				newLatchData = false;
 			}
 #endif
@@ -1489,7 +1497,7 @@ void Disk2InterfaceCard::DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemain
 		if (m_bLogDisk_NibblesRW)
 #endif
 		{
-			LOG_DISK("read %04X = %02X\r\n", floppy.m_byte, m_floppyLatch);
+			LOG_DISK_TRACE("read %04X = %02X\r\n", floppy.m_byte, m_floppyLatch);
 		}
 	}
 #endif
@@ -1514,7 +1522,7 @@ void Disk2InterfaceCard::DataLoadWriteWOZ(WORD pc, WORD addr, UINT bitCellRemain
 
 	m_writeStarted = true;
 #if LOG_DISK_WOZ_LOADWRITE
-	LOG_DISK("load shiftReg with %02X (was: %02X)\n", m_floppyLatch, m_shiftReg);
+	LOG_DISK_TRACE("load shiftReg with %02X (was: %02X)\n", m_floppyLatch, m_shiftReg);
 #endif
 	m_shiftReg = m_floppyLatch;
 
@@ -1544,7 +1552,7 @@ void Disk2InterfaceCard::DataShiftWriteWOZ(WORD pc, WORD addr, ULONG uExecutedCy
 		return;
 
 #if LOG_DISK_WOZ_SHIFTWRITE
-	LOG_DISK("T$%02X, bitOffset=%04X: %02X (%d bits)\n", drive.m_phase/2, floppy.m_bitOffset, m_shiftReg, bitCellRemainder);
+	LOG_DISK_TRACE("T$%02X, bitOffset=%04X: %02X (%d bits)\n", drive.m_phase/2, floppy.m_bitOffset, m_shiftReg, bitCellRemainder);
 #endif
 
 	for (UINT i = 0; i < bitCellRemainder; i++)
@@ -222,6 +222,12 @@ UINT ImageGetImageSize(ImageInfo* const pImageInfo)
 	return pImageInfo ? pImageInfo->uImageSize : 0;
 }
 
+// Memory held for the image (0 for track based images read from the file, and for HDD images)
+UINT ImageGetImageBufferSize(ImageInfo* const pImageInfo)
+{
+	return (pImageInfo && pImageInfo->pImageBuffer) ? pImageInfo->uImageSize : 0;
+}
+
 bool ImageIsWOZ(ImageInfo* const pImageInfo)
 {
 	return pImageInfo ? (pImageInfo->pImageType->GetType() == eImageWOZ1 || pImageInfo->pImageType->GetType() == eImageWOZ2) : false;
@@ -41,6 +41,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Log.h"
 #include "Memory.h"
 #include "Interface.h"
+#include "ProDOS_HostVolume.h"
 
 ImageInfo::ImageInfo()
 {
@@ -56,6 +57,7 @@ ImageInfo::ImageInfo()
 	memset(&zipFileInfo, 0, sizeof(zipFileInfo));
 	uNumEntriesInZip = 0;
 	uNumValidImagesInZip = 0;
+	pHostVolume = NULL;
 	uNumTracks = 0;
 	pImageBuffer = NULL;
 	pWOZTrackMap = NULL;
@@ -115,9 +117,22 @@ bool CImageBase::WriteImageHeader(ImageInfo* pImageInfo, LPBYTE pHdr, const UINT
 bool CImageBase::ReadTrack(ImageInfo* pImageInfo, const int nTrack, LPBYTE pTrackBuffer, const UINT uTrackSize)
 {
 	const long offset = pImageInfo->uOffset + nTrack * uTrackSize;
-	memcpy(pTrackBuffer, &pImageInfo->pImageBuffer[offset], uTrackSize);
 
-	return true;
+	if (pImageInfo->pImageBuffer)
+	{
+		memcpy(pTrackBuffer, &pImageInfo->pImageBuffer[offset], uTrackSize);
+		return true;
+	}
+
+	// Image buffer released after detection: read the track from the file
+	if (pImageInfo->hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	SetFilePointer(pImageInfo->hFile, offset, NULL, FILE_BEGIN);
+
+	DWORD dwBytesRead;
+	BOOL bRes = ReadFile(pImageInfo->hFile, pTrackBuffer, uTrackSize, &dwBytesRead, NULL);
+	return bRes && dwBytesRead == uTrackSize;
 }
 
 //-------------------------------------
@@ -125,7 +140,8 @@ bool CImageBase::ReadTrack(ImageInfo* pImageInfo, const int nTrack, LPBYTE pTrac
 bool CImageBase::WriteTrack(ImageInfo* pImageInfo, const int nTrack, LPBYTE pTrackBuffer, const UINT uTrackSize)
 {
 	const long offset = pImageInfo->uOffset + nTrack * uTrackSize;
-	memcpy(&pImageInfo->pImageBuffer[offset], pTrackBuffer, uTrackSize);
+	if (pImageInfo->pImageBuffer)
+		memcpy(&pImageInfo->pImageBuffer[offset], pTrackBuffer, uTrackSize);
 
 	return WriteImageData(pImageInfo, pTrackBuffer, uTrackSize, offset);
 }
@@ -152,6 +168,10 @@ bool CImageBase::ReadBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBloc
 	{
 		memcpy(pBlockBuffer, &pImageInfo->pImageBuffer[Offset], HD_BLOCK_SIZE);
 	}
+	else if (pImageInfo->FileType == eFileHostDir)
+	{
+		return pImageInfo->pHostVolume->ReadBlock(nBlock, pBlockBuffer);
+	}
 	else
 	{
 		_ASSERT(0);
@@ -165,6 +185,9 @@ bool CImageBase::ReadBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBloc
 
 bool CImageBase::WriteBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBlockBuffer)
 {
+	if (pImageInfo->FileType == eFileHostDir)
+		return pImageInfo->pHostVolume->WriteBlock(nBlock, pBlockBuffer);
+
 	long offset = pImageInfo->uOffset + nBlock * HD_BLOCK_SIZE;
 	const bool bGrowImageBuffer = (UINT)offset+HD_BLOCK_SIZE > pImageInfo->uImageSize;
 
@@ -707,6 +730,7 @@ public:
 	virtual bool AllowCreate(void) { return true; }
 	virtual UINT GetImageSizeForCreate(void) { m_uNumTracksInImage = TRACKS_STANDARD; return TRACK_DENIBBLIZED_SIZE * TRACKS_STANDARD; }
 
+	virtual bool ReadTracksFromFile(void) { return true; }
 	virtual eImageType GetType(void) { return eImageDO; }
 	virtual const char* GetCreateExtensions(void) { return ".do;.dsk"; }
 	virtual const char* GetRejectExtensions(void) { return ".nib;.iie;.po;.prg"; }
@@ -772,6 +796,7 @@ public:
 		WriteTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
 	}
 
+	virtual bool ReadTracksFromFile(void) { return true; }
 	virtual eImageType GetType(void) { return eImagePO; }
 	virtual const char* GetCreateExtensions(void) { return ".po"; }
 	virtual const char* GetRejectExtensions(void) { return ".do;.iie;.nib;.prg;.woz"; }
@@ -839,6 +864,7 @@ public:
 	virtual bool AllowCreate(void) { return true; }
 	virtual UINT GetImageSizeForCreate(void) { m_uNumTracksInImage = TRACKS_STANDARD; return NIB1_TRACK_SIZE * TRACKS_STANDARD; }
 
+	virtual bool ReadTracksFromFile(void) { return true; }
 	virtual eImageType GetType(void) { return eImageNIB1; }
 	virtual const char* GetCreateExtensions(void) { return ".nib"; }
 	virtual const char* GetRejectExtensions(void) { return ".do;.iie;.po;.prg;.woz"; }
@@ -878,6 +904,7 @@ public:
 		WriteTrack(pImageInfo, track, pTrackImageBuffer, nNibbles);
 	}
 
+	virtual bool ReadTracksFromFile(void) { return true; }
 	virtual eImageType GetType(void) { return eImageNIB2; }
 	virtual const char* GetCreateExtensions(void) { return ".nb2"; }
 	virtual const char* GetRejectExtensions(void) { return ".do;.iie;.po;.prg;.woz;.2mg;.2img"; }
@@ -1886,11 +1913,13 @@ ImageError_e CImageHelperBase::CheckNormalFile(LPCTSTR pszImageFilename, ImageIn
 		bool bTempDetectBuffer;
 		const UINT uDetectSize = GetMinDetectSize(dwSize, &bTempDetectBuffer);
 
-		pImageInfo->pImageBuffer = new BYTE [dwSize];
+		// A temp detect buffer only needs the header (eg. a 32MB HDD image is read a block at a time from the file)
+		const UINT uReadSize = bTempDetectBuffer ? std::min((UINT)dwSize, uDetectSize) : dwSize;
+		pImageInfo->pImageBuffer = new BYTE [bTempDetectBuffer ? uDetectSize : dwSize];
 
 		DWORD dwBytesRead;
-		BOOL bRes = ReadFile(hFile, pImageInfo->pImageBuffer, dwSize, &dwBytesRead, NULL);
-		if (!bRes || dwSize != dwBytesRead)
+		BOOL bRes = ReadFile(hFile, pImageInfo->pImageBuffer, uReadSize, &dwBytesRead, NULL);
+		if (!bRes || uReadSize != dwBytesRead)
 		{
 			delete [] pImageInfo->pImageBuffer;
 			pImageInfo->pImageBuffer = NULL;
@@ -1960,12 +1989,34 @@ ImageError_e CImageHelperBase::CheckNormalFile(LPCTSTR pszImageFilename, ImageIn
 		return eIMAGE_ERROR_UNSUPPORTED;
 	}
 
+	// Track based images are nibblized a track at a time from the file, so don't keep the whole image in memory
+	if (pImageType->ReadTracksFromFile())
+	{
+		delete [] pImageInfo->pImageBuffer;
+		pImageInfo->pImageBuffer = NULL;
+	}
+
 	SetImageInfo(pImageInfo, eFileNormal, dwOffset, pImageType, dwSize);
 	return eIMAGE_ERROR_NONE;
 }
 
 //-------------------------------------
 
+// A host directory, seen as a ProDOS volume (HardDisk only)
+ImageError_e CImageHelperBase::CheckHostDirectory(LPCTSTR pszImageFilename, ImageInfo* pImageInfo)
+{
+	CImageBase* pImageType = GetImageForHostDirectory();
+	if (!pImageType)
+		return eIMAGE_ERROR_UNSUPPORTED;
+
+	pImageInfo->pHostVolume = new ProDOSHostVolume(pszImageFilename, pImageInfo->bWriteProtected);
+
+	SetImageInfo(pImageInfo, eFileHostDir, 0, pImageType, pImageInfo->pHostVolume->GetNumBlocks() * HD_BLOCK_SIZE);
+	return eIMAGE_ERROR_NONE;
+}
+
+//-------------------------------------
+
 void CImageHelperBase::SetImageInfo(ImageInfo* pImageInfo, FileType_e fileType, uint32_t dwOffset, CImageBase* pImageType, uint32_t dwSize)
 {
 	pImageInfo->FileType = fileType;
@@ -1987,7 +2038,11 @@ ImageError_e CImageHelperBase::Open(	LPCTSTR pszImageFilename,
 	ImageError_e Err;
     const size_t uStrLen = strlen(pszImageFilename);
 
-    if (uStrLen > GZ_SUFFIX_LEN && _stricmp(pszImageFilename+uStrLen-GZ_SUFFIX_LEN, GZ_SUFFIX) == 0)
+    if (ProDOSHostVolume::IsHostDirectory(pszImageFilename))
+	{
+		Err = CheckHostDirectory(pszImageFilename, pImageInfo);
+	}
+    else if (uStrLen > GZ_SUFFIX_LEN && _stricmp(pszImageFilename+uStrLen-GZ_SUFFIX_LEN, GZ_SUFFIX) == 0)
 	{
 		Err = CheckGZipFile(pszImageFilename, pImageInfo);
 	}
@@ -2029,6 +2084,9 @@ void CImageHelperBase::Close(ImageInfo* pImageInfo)
 
 	delete [] pImageInfo->pImageBuffer;
 	pImageInfo->pImageBuffer = NULL;
+
+	delete pImageInfo->pHostVolume;	// writes back any pending changes
+	pImageInfo->pHostVolume = NULL;
 }
 
 //-------------------------------------
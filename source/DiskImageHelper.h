@@ -16,8 +16,9 @@ enum eDetectResult {eMismatch, ePossibleMatch, eMatch};
 
 class CImageBase;
 class CImageHelperBase;
+class ProDOSHostVolume;
 
-enum FileType_e {eFileNormal, eFileGZip, eFileZip};
+enum FileType_e {eFileNormal, eFileGZip, eFileZip, eFileHostDir};
 
 struct ImageInfo
 {
@@ -33,6 +34,8 @@ struct ImageInfo
 	zip_fileinfo	zipFileInfo;
 	UINT			uNumEntriesInZip;
 	UINT			uNumValidImagesInZip;
+	// HardDisk only
+	ProDOSHostVolume* pHostVolume;		// eFileHostDir
 	// Floppy only
 	UINT			uNumTracks;
 	BYTE*			pImageBuffer;
@@ -70,6 +73,7 @@ public:
 	virtual bool AllowRW(void) { return true; }			// All but: APL and PRG
 	virtual bool AllowCreate(void) { return false; }	// WE CREATE ONLY DOS ORDER (DO) OR 6656-NIBBLE (NIB) FORMAT FILES
 	virtual UINT GetImageSizeForCreate(void) { _ASSERT(0); return (UINT)-1; }
+	virtual bool ReadTracksFromFile(void) { return false; }	// Only:    DO, PO, NIB1 and NIB2 (so no need to keep the whole image in memory)
 
 	virtual eImageType GetType(void) = 0;
 	virtual const char* GetCreateExtensions(void) = 0;
@@ -384,11 +388,13 @@ public:
 	virtual CImageBase* GetImageForCreation(const char* pszExt, uint32_t* pCreateImageSize) = 0;
 	virtual UINT GetMaxImageSize(void) = 0;
 	virtual UINT GetMinDetectSize(const UINT uImageSize, bool* pTempDetectBuffer) = 0;
+	virtual CImageBase* GetImageForHostDirectory(void) { return NULL; }
 
 protected:
 	ImageError_e CheckGZipFile(LPCTSTR pszImageFilename, ImageInfo* pImageInfo);
 	ImageError_e CheckZipFile(LPCTSTR pszImageFilename, ImageInfo* pImageInfo, std::string& strFilenameInZip);
 	ImageError_e CheckNormalFile(LPCTSTR pszImageFilename, ImageInfo* pImageInfo, const bool bCreateIfNecessary);
+	ImageError_e CheckHostDirectory(LPCTSTR pszImageFilename, ImageInfo* pImageInfo);
 	void GetCharLowerExt(char* pszExt, LPCTSTR pszImageFilename, const UINT uExtSize);
 	void GetCharLowerExt2(char* pszExt, LPCTSTR pszImageFilename, const UINT uExtSize);
 	void SetImageInfo(ImageInfo* pImageInfo, FileType_e fileType, uint32_t dwOffset, CImageBase* pImageType, uint32_t dwSize);
@@ -452,4 +458,5 @@ public:
 	virtual CImageBase* GetImageForCreation(const char* pszExt, uint32_t* pCreateImageSize);
 	virtual UINT GetMaxImageSize(void);
 	virtual UINT GetMinDetectSize(const UINT uImageSize, bool* pTempDetectBuffer);
+	virtual CImageBase* GetImageForHostDirectory(void) { return GetImage(eImageHDV); }
 };
@@ -1,6 +1,6 @@
 #pragma once
 
-#define LOG_DISK_ENABLED 0	// Master enable
+#define LOG_DISK_ENABLED 1	// Master enable: if 0, compiled out, else enabled at runtime with LOG_CATEGORY_DISK at LOG_LEVEL_DEBUG
 
 #define LOG_DISK_TRACKS 1
 #define LOG_DISK_MOTOR 1
@@ -11,7 +11,7 @@
 #define LOG_DISK_NIBBLES_READ 1
 #define LOG_DISK_NIBBLES_WRITE 1
 #define LOG_DISK_NIBBLES_WRITE_TRACK_GAPS 1	// Gap1, Gap2 & Gap3 info when writing a track
-#define LOG_DISK_NIBBLES_USE_RUNTIME_VAR 1
+#define LOG_DISK_NIBBLES_USE_RUNTIME_VAR 0	// else nibbles are logged at LOG_LEVEL_TRACE
 #define LOG_DISK_WOZ_LOADWRITE 1
 #define LOG_DISK_WOZ_SHIFTWRITE 1
 #define LOG_DISK_WOZ_READTRACK 1
@@ -20,14 +20,18 @@
 // __VA_ARGS__ not supported on MSVC++ .NET 7.x
 #if (LOG_DISK_ENABLED)
 	#if !defined(_VC71)
-		#define LOG_DISK(format, ...) LOG(format, __VA_ARGS__)
+		#define LOG_DISK(...) LOG_CATEGORY(LOG_CATEGORY_DISK, LOG_LEVEL_DEBUG, __VA_ARGS__)
+		#define LOG_DISK_TRACE(...) LOG_CATEGORY(LOG_CATEGORY_DISK, LOG_LEVEL_TRACE, __VA_ARGS__)	// per nibble/bit
 	#else
 		#define LOG_DISK	 LogOutput
+		#define LOG_DISK_TRACE	 LogOutput
 	#endif
 #else
 	#if !defined(_VC71)
 		#define LOG_DISK(...)
+		#define LOG_DISK_TRACE(...)
 	#else
 		#define LOG_DISK(x)
+		#define LOG_DISK_TRACE(x)
 	#endif
 #endif
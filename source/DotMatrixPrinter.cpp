@@ -0,0 +1,607 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2014, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Epson FX & ImageWriter II emulation, rasterising to page bitmaps
+ *
+ * Refs:
+ * . Epson FX-80 User's Manual (ESC/P)
+ * . ImageWriter II Technical Reference Manual
+ *
+ * Both are 9-pin heads with 1/72" between pins. Positions are kept in pixels (DPI) as doubles, since
+ * the horizontal densities (eg. 107 or 136 dpi) aren't multiples of each other.
+ */
+
+#include "StdAfx.h"
+
+#include "DotMatrixPrinter.h"
+#include "NTSC_CharSet.h"
+
+#include "zlib.h"
+
+//===========================================================================
+
+PrinterPage::PrinterPage(const UINT width, const UINT height)
+	: m_width(width),
+	m_height(height),
+	m_pitch((width + 7) / 8),
+	m_bBlank(true)
+{
+	m_bits.resize(m_pitch * m_height, 0);
+}
+
+void PrinterPage::SetDots(const int x, const int y, const int size)
+{
+	const int x0 = std::max(x, 0);
+	const int x1 = std::min(x + size, (int)m_width);
+	const int y0 = std::max(y, 0);
+	const int y1 = std::min(y + size, (int)m_height);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	for (int row = y0; row < y1; row++)
+	{
+		BYTE* pRow = &m_bits[row * m_pitch];
+		for (int col = x0; col < x1; col++)
+			pRow[col >> 3] |= 0x80 >> (col & 7);
+	}
+
+	m_bBlank = false;
+}
+
+bool PrinterPage::GetPixel(const UINT x, const UINT y) const
+{
+	if (x >= m_width || y >= m_height)
+		return false;
+	return (m_bits[y * m_pitch + (x >> 3)] & (0x80 >> (x & 7))) != 0;
+}
+
+uint32_t PrinterPage::GetCRC(void) const
+{
+	return crc32(0, m_bits.data(), (uInt)m_bits.size());
+}
+
+bool PrinterPage::SavePBM(const std::string& pathname) const
+{
+	FILE* file = fopen(pathname.c_str(), "wb");
+	if (!file)
+		return false;
+
+	fprintf(file, "P4\n%u %u\n", m_width, m_height);
+	const bool bRes = fwrite(m_bits.data(), 1, m_bits.size(), file) == m_bits.size();
+	return (fclose(file) == 0) && bRes;
+}
+
+static void WritePNGChunk(FILE* file, const char* type, const BYTE* data, const UINT length)
+{
+	const BYTE header[8] = { BYTE(length >> 24), BYTE(length >> 16), BYTE(length >> 8), BYTE(length), BYTE(type[0]), BYTE(type[1]), BYTE(type[2]), BYTE(type[3]) };
+	uLong crc = crc32(0, header + 4, 4);
+	if (length)
+		crc = crc32(crc, data, length);	// NB. crc32() returns 0 for a NULL buffer
+	const BYTE trailer[4] = { BYTE(crc >> 24), BYTE(crc >> 16), BYTE(crc >> 8), BYTE(crc) };
+
+	fwrite(header, 1, sizeof(header), file);
+	fwrite(data, 1, length, file);
+	fwrite(trailer, 1, sizeof(trailer), file);
+}
+
+// 1-bit greyscale, so the rows are the PBM rows inverted (0 = black), each prefixed by filter type 0
+bool PrinterPage::SavePNG(const std::string& pathname) const
+{
+	std::vector<BYTE> raw((m_pitch + 1) * m_height);
+	for (UINT y = 0; y < m_height; y++)
+	{
+		BYTE* pDst = &raw[y * (m_pitch + 1)];
+		const BYTE* pSrc = &m_bits[y * m_pitch];
+		*pDst++ = 0;
+		for (UINT i = 0; i < m_pitch; i++)
+			pDst[i] = ~pSrc[i];
+	}
+
+	uLongf compressedLength = compressBound((uLong)raw.size());
+	std::vector<BYTE> compressed(compressedLength);
+	if (compress2(compressed.data(), &compressedLength, raw.data(), (uLong)raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+		return false;
+
+	FILE* file = fopen(pathname.c_str(), "wb");
+	if (!file)
+		return false;
+
+	const BYTE signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	fwrite(signature, 1, sizeof(signature), file);
+
+	const BYTE ihdr[13] =
+	{
+		BYTE(m_width >> 24), BYTE(m_width >> 16), BYTE(m_width >> 8), BYTE(m_width),
+		BYTE(m_height >> 24), BYTE(m_height >> 16), BYTE(m_height >> 8), BYTE(m_height),
+		1,	// bit depth
+		0,	// greyscale
+		0, 0, 0	// deflate, adaptive filtering, no interlace
+	};
+	WritePNGChunk(file, "IHDR", ihdr, sizeof(ihdr));
+	WritePNGChunk(file, "IDAT", compressed.data(), (UINT)compressedLength);
+	WritePNGChunk(file, "IEND", NULL, 0);
+
+	const bool bRes = ferror(file) == 0;
+	return (fclose(file) == 0) && bRes;
+}
+
+//===========================================================================
+
+static const BYTE ESC = 0x1B;
+
+DotMatrixPrinter::DotMatrixPrinter(const Emulation_e emulation)
+	: m_emulation(emulation),
+	m_page(PAGE_WIDTH, PAGE_HEIGHT),
+	m_x(0),
+	m_y(0),
+	m_bLastWasCR(false),
+	m_bEscape(false),
+	m_control(0),
+	m_graphicsCount(0),
+	m_graphicsStep(0)
+{
+	Reset();
+}
+
+void DotMatrixPrinter::Reset(void)
+{
+	m_leftMargin = 0;
+	m_lineSpacing = DPI / 6.0;
+	m_pageLength = PAGE_HEIGHT;
+	m_pitch = (m_emulation == EMULATION_EPSON) ? 10 : 80;	// pica
+	m_bCondensed = false;
+	m_bDoubleWidth = false;
+	m_bDoubleWidthLine = false;
+	m_bBold = false;
+	m_bDoubleStrike = false;
+	m_bUnderline = false;
+	m_bReverseFeed = false;
+	SetCharWidth();
+
+	m_x = m_leftMargin;
+}
+
+std::vector<PrinterPage> DotMatrixPrinter::TakeEjectedPages(void)
+{
+	std::vector<PrinterPage> pages;
+	pages.swap(m_ejected);
+	return pages;
+}
+
+//===========================================================================
+
+void DotMatrixPrinter::Write(const BYTE value)
+{
+	if (m_graphicsCount)
+	{
+		PrintGraphics(value);
+		return;
+	}
+
+	if (m_bEscape)
+	{
+		// the command byte is ASCII, the Epson parameters are binary
+		m_command.push_back(m_command.empty() ? (value & 0x7F) : value);
+
+		if (m_emulation == EMULATION_EPSON)
+		{
+			const int length = GetEpsonParamLength();
+			if (length < 0 ? (m_command.size() > 1 && m_command.back() == 0) : (m_command.size() > (UINT)length))
+				WriteEpsonEscape();
+			else
+				return;
+		}
+		else
+		{
+			const int length = GetImageWriterParamLength();
+			if (length < 0 ? (m_command.back() == '.') : (m_command.size() > (UINT)length))
+				WriteImageWriterEscape();
+			else
+				return;
+		}
+
+		m_bEscape = false;
+		m_command.clear();
+		return;
+	}
+
+	const BYTE ch = value & 0x7F;
+
+	if (m_control)
+	{
+		// ImageWriter US n: feed n lines, n = '1'..'?'
+		m_control = 0;
+		for (UINT i = 0; i < (UINT)(ch & 0x0F); i++)
+			LineFeed(m_lineSpacing);
+		return;
+	}
+
+	const bool bWasCR = m_bLastWasCR;
+	m_bLastWasCR = false;
+
+	switch (ch)
+	{
+	case ESC:
+		m_bEscape = true;
+		break;
+	case 0x0D:	// CR
+		CarriageReturn();
+		m_bLastWasCR = true;
+		break;
+	case 0x0A:	// LF
+		if (!bWasCR)
+		{
+			m_bDoubleWidthLine = false;
+			LineFeed(m_lineSpacing);
+			SetCharWidth();
+		}
+		break;
+	case 0x0C:	// FF
+		FormFeed();
+		break;
+	case 0x08:	// BS
+		m_x = std::max(m_leftMargin, m_x - m_charWidth);
+		break;
+	case 0x09:	// HT
+		Tab();
+		break;
+	case 0x0E:	// SO
+		if (m_emulation == EMULATION_EPSON)
+			m_bDoubleWidthLine = true;
+		else
+			m_bDoubleWidth = true;
+		SetCharWidth();
+		break;
+	case 0x0F:	// SI
+		if (m_emulation == EMULATION_EPSON)
+			m_bCondensed = true;
+		else
+			m_bDoubleWidth = false;
+		SetCharWidth();
+		break;
+	case 0x12:	// DC2
+		if (m_emulation == EMULATION_EPSON)
+		{
+			m_bCondensed = false;
+			SetCharWidth();
+		}
+		break;
+	case 0x14:	// DC4
+		if (m_emulation == EMULATION_EPSON)
+		{
+			m_bDoubleWidthLine = false;
+			SetCharWidth();
+		}
+		break;
+	case 0x1F:	// US
+		if (m_emulation == EMULATION_IMAGEWRITER)
+			m_control = ch;
+		break;
+	default:
+		if (ch >= 0x20 && ch < 0x7F)
+			PrintChar(ch);
+		break;
+	}
+}
+
+void DotMatrixPrinter::FormFeed(void)
+{
+	if (!m_page.IsBlank())
+	{
+		m_ejected.push_back(m_page);
+		m_page = PrinterPage(PAGE_WIDTH, (UINT)(m_pageLength + 0.5));
+	}
+
+	m_x = m_leftMargin;
+	m_y = 0;
+}
+
+//===========================================================================
+
+// Number of parameter bytes after the command byte, or -1 if NUL terminated
+int DotMatrixPrinter::GetEpsonParamLength(void) const
+{
+	switch (m_command[0])
+	{
+	case '!': case '-': case '3': case 'A': case 'J': case 'j': case 'l': case 'Q': case 'W':
+	case 'S': case 'U': case 'R': case 'x': case 'k': case 'p': case 's': case 'N': case 'a':
+	case 't': case 'q': case 'r': case '/': case 'i': case 'w':
+		return 1;
+	case 'C':	// ESC C n: lines, ESC C 0 n: inches
+		return (m_command.size() > 1 && m_command[1] == 0) ? 2 : 1;
+	case 'K': case 'L': case 'Y': case 'Z': case '$': case '\\': case '?': case 'e': case 'f':
+		return 2;
+	case '*':
+		return 3;
+	case 'D': case 'B':	// tab stops
+		return -1;
+	default:
+		return 0;
+	}
+}
+
+void DotMatrixPrinter::WriteEpsonEscape(void)
+{
+	const BYTE n = (m_command.size() > 1) ? m_command[1] : 0;
+	const UINT n16 = (m_command.size() > 2) ? n + (m_command[2] << 8) : n;
+
+	switch (m_command[0])
+	{
+	case '@': Reset(); break;
+	case 'E': m_bBold = true; break;
+	case 'F': m_bBold = false; break;
+	case 'G': m_bDoubleStrike = true; break;
+	case 'H': m_bDoubleStrike = false; break;
+	case '-': m_bUnderline = (n & 1) != 0; break;
+	case 'M': m_pitch = 12; SetCharWidth(); break;
+	case 'P': m_pitch = 10; SetCharWidth(); break;
+	case 'W': m_bDoubleWidth = (n & 1) != 0; SetCharWidth(); break;
+	case '!':	// master select
+		m_pitch = (n & 0x01) ? 12 : 10;
+		m_bCondensed = (n & 0x04) != 0;
+		m_bBold = (n & 0x08) != 0;
+		m_bDoubleStrike = (n & 0x10) != 0;
+		m_bDoubleWidth = (n & 0x20) != 0;
+		m_bUnderline = (n & 0x80) != 0;
+		SetCharWidth();
+		break;
+	case '0': m_lineSpacing = DPI / 8.0; break;
+	case '1': m_lineSpacing = DPI * 7 / 72.0; break;
+	case '2': m_lineSpacing = DPI / 6.0; break;
+	case '3': m_lineSpacing = DPI * n / 216.0; break;
+	case 'A': m_lineSpacing = DPI * n / 72.0; break;
+	case 'J': LineFeed(DPI * n / 216.0); break;
+	case 'j': m_y = std::max(0.0, m_y - DPI * n / 216.0); break;
+	case 'C':
+		if (n)
+			m_pageLength = n * m_lineSpacing;
+		else if (m_command[2])
+			m_pageLength = (double)DPI * m_command[2];
+		break;
+	case 'l':
+		m_leftMargin = n * m_charWidth;
+		m_x = std::max(m_x, m_leftMargin);
+		break;
+	case '$': m_x = m_leftMargin + DPI * n16 / 60.0; break;
+	case '\\': m_x = std::max(m_leftMargin, m_x + DPI * (int16_t)n16 / 120.0); break;
+	case 'K': StartGraphics(n16, 60); break;
+	case 'L': StartGraphics(n16, 120); break;
+	case 'Y': StartGraphics(n16, 120); break;
+	case 'Z': StartGraphics(n16, 240); break;
+	case '*':
+		{
+			static const UINT dpi[] = { 60, 120, 120, 240, 80, 72, 90 };
+			const UINT count = m_command[2] + (m_command[3] << 8);
+			StartGraphics(count, dpi[n < sizeof(dpi) / sizeof(dpi[0]) ? n : 0]);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+// Number of parameter bytes after the command byte, or -1 if terminated by '.'
+int DotMatrixPrinter::GetImageWriterParamLength(void) const
+{
+	switch (m_command[0])
+	{
+	case 's': case 'K': case 'a': case 'l':
+		return 1;
+	case 'T': case 'Z': case 'D':
+		return 2;
+	case 'L': case 'g':
+		return 3;
+	case 'F': case 'G': case 'S': case 'H':
+		return 4;
+	case 'V':
+		return 5;
+	case '(': case ')': case 'u':	// tab stops: "nnn,nnn."
+		return -1;
+	default:
+		return 0;
+	}
+}
+
+UINT DotMatrixPrinter::GetDecimal(const UINT first, const UINT digits) const
+{
+	UINT value = 0;
+	for (UINT i = first; i < first + digits && i < m_command.size(); i++)
+	{
+		const BYTE c = m_command[i] & 0x7F;
+		value = value * 10 + ((c >= '0' && c <= '9') ? c - '0' : 0);	// some drivers pad with spaces
+	}
+	return value;
+}
+
+void DotMatrixPrinter::WriteImageWriterEscape(void)
+{
+	switch (m_command[0])
+	{
+	case 'c': Reset(); break;
+	case 'n': m_pitch = 72; SetCharWidth(); break;	// extended
+	case 'N': m_pitch = 80; SetCharWidth(); break;	// pica
+	case 'E': m_pitch = 96; SetCharWidth(); break;	// elite
+	case 'e': m_pitch = 107; SetCharWidth(); break;	// semi-condensed
+	case 'q': m_pitch = 120; SetCharWidth(); break;	// condensed
+	case 'Q': m_pitch = 136; SetCharWidth(); break;	// ultra-condensed
+	case 'p': m_pitch = 144; SetCharWidth(); break;	// pica proportional (printed fixed pitch)
+	case 'P': m_pitch = 160; SetCharWidth(); break;	// elite proportional (printed fixed pitch)
+	case '!': m_bBold = true; break;
+	case '"': m_bBold = false; break;
+	case 'X': m_bUnderline = true; break;
+	case 'Y': m_bUnderline = false; break;
+	case 'A': m_lineSpacing = DPI * 24 / 144.0; break;
+	case 'B': m_lineSpacing = DPI * 18 / 144.0; break;
+	case 'T': m_lineSpacing = DPI * GetDecimal(1, 2) / 144.0; break;
+	case 'f': m_bReverseFeed = false; break;
+	case 'r': m_bReverseFeed = true; break;
+	case 'H': m_pageLength = DPI * GetDecimal(1, 4) / 144.0; break;
+	case 'L':
+		m_leftMargin = GetDecimal(1, 3) * 8.0 * DPI / m_pitch;
+		m_x = std::max(m_x, m_leftMargin);
+		break;
+	case 'F': m_x = m_leftMargin + (double)DPI * GetDecimal(1, 4) / m_pitch; break;
+	case 'G': case 'S': StartGraphics(GetDecimal(1, 4), m_pitch); break;
+	case 'g': StartGraphics(GetDecimal(1, 3) * 8, m_pitch); break;
+	case 'V':	// repeat the graphics byte nnnn times
+		{
+			const UINT count = GetDecimal(1, 4);
+			StartGraphics(count, m_pitch);
+			for (UINT i = 0; i < count; i++)
+				PrintGraphics(m_command[5]);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+//===========================================================================
+
+void DotMatrixPrinter::SetCharWidth(void)
+{
+	if (m_emulation == EMULATION_EPSON)
+	{
+		const double cpi = m_bCondensed ? (m_pitch == 12 ? 20.0 : 17.16) : m_pitch;
+		m_charWidth = DPI / cpi;
+	}
+	else
+	{
+		m_charWidth = 8.0 * DPI / m_pitch;	// 8 dots per character cell
+	}
+
+	if (m_bDoubleWidth || m_bDoubleWidthLine)
+		m_charWidth *= 2;
+}
+
+void DotMatrixPrinter::PrintColumn(const double x, const double y, const BYTE dots)
+{
+	for (UINT pin = 0; pin < 8; pin++)
+	{
+		if (dots & (1 << pin))
+			m_page.SetDots((int)(x + 0.5), (int)(y + pin * PIN_PITCH + 0.5), PIN_PITCH);
+	}
+}
+
+void DotMatrixPrinter::PrintChar(const BYTE ch)
+{
+	if (m_x + m_charWidth > PAGE_WIDTH + 0.5)
+		CarriageReturn();
+
+	// 7 columns of the //e font in the 8 column cell; each row is LSB = leftmost dot
+	const unsigned char* glyph = csbits_enhanced2e[0][0x80 | ch];
+	const double step = m_charWidth / 8;
+
+	for (UINT col = 0; col < 7; col++)
+	{
+		BYTE dots = 0;
+		for (UINT row = 0; row < 8; row++)
+		{
+			if (glyph[row] & (1 << col))
+				dots |= 1 << row;
+		}
+		if (!dots)
+			continue;
+
+		const double x = m_x + col * step;
+		PrintColumn(x, m_y, dots);
+		if (m_bDoubleWidth || m_bDoubleWidthLine)
+			PrintColumn(x + step / 2, m_y, dots);
+		if (m_bBold)
+			PrintColumn(x + DPI / 120.0, m_y, dots);
+		if (m_bDoubleStrike)
+			PrintColumn(x, m_y + PIN_PITCH / 2.0, dots);
+	}
+
+	if (m_bUnderline)
+	{
+		// 9th pin
+		for (double x = m_x; x < m_x + m_charWidth; x += PIN_PITCH)
+			m_page.SetDots((int)(x + 0.5), (int)(m_y + 8 * PIN_PITCH + 0.5), PIN_PITCH);
+	}
+
+	m_x += m_charWidth;
+}
+
+void DotMatrixPrinter::StartGraphics(const UINT count, const UINT dpi)
+{
+	m_graphicsCount = count;
+	m_graphicsStep = (double)DPI / dpi;
+}
+
+void DotMatrixPrinter::PrintGraphics(const BYTE dots)
+{
+	if (m_emulation == EMULATION_EPSON)
+	{
+		// MSB = top pin
+		BYTE reversed = 0;
+		for (UINT pin = 0; pin < 8; pin++)
+		{
+			if (dots & (0x80 >> pin))
+				reversed |= 1 << pin;
+		}
+		PrintColumn(m_x, m_y, reversed);
+	}
+	else
+	{
+		PrintColumn(m_x, m_y, dots);
+	}
+
+	m_x += m_graphicsStep;
+	m_graphicsCount--;
+}
+
+void DotMatrixPrinter::CarriageReturn(void)
+{
+	m_x = m_leftMargin;
+	m_bDoubleWidthLine = false;
+	SetCharWidth();
+	LineFeed(m_lineSpacing);
+}
+
+void DotMatrixPrinter::LineFeed(const double distance)
+{
+	if (m_bReverseFeed)
+	{
+		m_y = std::max(0.0, m_y - distance);
+		return;
+	}
+
+	m_y += distance;
+	if (m_y + 0.5 >= m_pageLength)
+	{
+		const double x = m_x;
+		const double y = m_y - m_pageLength;
+		FormFeed();
+		m_x = x;
+		m_y = std::max(0.0, y);
+	}
+}
+
+void DotMatrixPrinter::Tab(void)
+{
+	// default tab stops: every 8 characters
+	const double tabWidth = 8 * m_charWidth;
+	const double column = floor((m_x - m_leftMargin) / tabWidth + 0.001) + 1;
+	m_x = m_leftMargin + column * tabWidth;
+}
@@ -0,0 +1,129 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2014, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <vector>
+
+// A 1 bit per pixel page, in the PBM (P4) layout: rows of MSB-first bytes, 1 = black
+class PrinterPage
+{
+public:
+	PrinterPage(const UINT width, const UINT height);
+
+	void SetDots(const int x, const int y, const int size);	// size x size square, clipped to the page
+	bool GetPixel(const UINT x, const UINT y) const;
+	bool IsBlank(void) const { return m_bBlank; }
+	UINT GetWidth(void) const { return m_width; }
+	UINT GetHeight(void) const { return m_height; }
+	uint32_t GetCRC(void) const;
+
+	bool SavePBM(const std::string& pathname) const;
+	bool SavePNG(const std::string& pathname) const;
+
+private:
+	UINT m_width;
+	UINT m_height;
+	UINT m_pitch;
+	std::vector<BYTE> m_bits;
+	bool m_bBlank;
+};
+
+// Epson FX (ESC/P) & ImageWriter II command interpreter, rasterising to US Letter pages
+//
+// . text uses the //e character generator (5x7) as the printer's draft font
+// . bit-image graphics: Epson ESC K/L/Y/Z/*, ImageWriter ESC G/S/g/V
+// . like the usual Apple II setup of both printers (LF after CR), CR feeds a line and an LF straight after a CR is ignored
+// . unsupported commands are parsed (so their parameters aren't printed) and ignored
+class DotMatrixPrinter
+{
+public:
+	enum Emulation_e { EMULATION_EPSON, EMULATION_IMAGEWRITER };
+
+	static const UINT DPI = 360;
+	static const UINT PAGE_WIDTH = DPI * 17 / 2;	// 8.5"
+	static const UINT PAGE_HEIGHT = DPI * 11;		// 11"
+	static const UINT PIN_PITCH = DPI / 72;			// both heads: 1/72" between pins
+
+	DotMatrixPrinter(const Emulation_e emulation);
+
+	void Write(const BYTE value);
+	void FormFeed(void);	// ejects the page, if anything was printed on it
+	void Reset(void);		// power-on settings (the current page is kept)
+
+	Emulation_e GetEmulation(void) const { return m_emulation; }
+	bool IsPageBlank(void) const { return m_page.IsBlank(); }
+	bool HasEjectedPages(void) const { return !m_ejected.empty(); }
+	std::vector<PrinterPage> TakeEjectedPages(void);
+
+	// head position, in pixels
+	double GetX(void) const { return m_x; }
+	double GetY(void) const { return m_y; }
+
+private:
+	void WriteEpsonEscape(void);
+	void WriteImageWriterEscape(void);
+	int GetEpsonParamLength(void) const;
+	int GetImageWriterParamLength(void) const;
+	UINT GetDecimal(const UINT first, const UINT digits) const;
+
+	void PrintChar(const BYTE ch);
+	void PrintColumn(const double x, const double y, const BYTE dots);	// bit 0 = top pin
+	void StartGraphics(const UINT count, const UINT dpi);
+	void PrintGraphics(const BYTE dots);
+	void CarriageReturn(void);
+	void LineFeed(const double distance);
+	void Tab(void);
+	void SetCharWidth(void);
+
+	Emulation_e m_emulation;
+	PrinterPage m_page;
+	std::vector<PrinterPage> m_ejected;
+
+	double m_x;
+	double m_y;
+	double m_leftMargin;
+	double m_lineSpacing;
+	double m_pageLength;
+	double m_charWidth;
+	bool m_bLastWasCR;
+
+	// type styles
+	UINT m_pitch;			// Epson: characters per inch (10 or 12); ImageWriter: dots per inch
+	bool m_bCondensed;		// Epson
+	bool m_bDoubleWidth;
+	bool m_bDoubleWidthLine;	// Epson SO: until the end of the line
+	bool m_bBold;
+	bool m_bDoubleStrike;	// Epson
+	bool m_bUnderline;
+	bool m_bReverseFeed;	// ImageWriter
+
+	// command parsing
+	bool m_bEscape;
+	std::vector<BYTE> m_command;	// after the ESC
+	BYTE m_control;					// pending control code with a parameter (ImageWriter US)
+
+	// bit-image graphics
+	UINT m_graphicsCount;
+	double m_graphicsStep;
+};
@@ -355,6 +355,14 @@ const std::string& HarddiskInterfaceCard::HarddiskGetFullPathName(const int iDri
 	return ImageGetPathname(m_hardDiskDrive[iDrive].m_imagehandle);
 }
 
+UINT HarddiskInterfaceCard::GetImageBufferSize(void)
+{
+	UINT size = 0;
+	for (UINT i = 0; i < NUM_HARDDISKS; i++)
+		size += ImageGetImageBufferSize(m_hardDiskDrive[i].m_imagehandle);
+	return size;
+}
+
 const std::string& HarddiskInterfaceCard::DiskGetBaseName(const int iDrive)
 {
 	return m_hardDiskDrive[iDrive].m_imagename;
@@ -702,7 +710,7 @@ BYTE HarddiskInterfaceCard::CmdExecute(HardDiskDrive* pHDD, const ULONG nExecute
 				while (remaining)
 				{
 					memdirty[dstAddr >> 8] = 0xFF;
-					LPBYTE page = memwrite[dstAddr >> 8];
+					LPBYTE page = MemGetWritePage(dstAddr >> 8);	// NB. not memwrite[], as the page may have a debugger write trap
 					if (!page)	// I/O space or ROM
 					{
 						if (g_nAppMode == MODE_STEPPING)
@@ -1152,7 +1160,7 @@ BYTE HarddiskInterfaceCard::SmartPortCmdStatus(HardDiskDrive* pHDD, const ULONG
 		const BYTE endPage = (statusListAddr + (WORD)status.size()) >> 8;	// OK if endPage wraps to 0x00
 		do
 		{
-			if (!memwrite[page])	// I/O space or ROM
+			if (!MemGetWritePage(page))	// I/O space or ROM
 			{
 				if (g_nAppMode == MODE_STEPPING)
 					DebuggerBreakOnDmaToOrFromIoMemory(page<<8, true);
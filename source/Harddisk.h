@@ -104,6 +104,7 @@ public:
 	virtual void Destroy(void);
 	const std::string& GetFullName(const int iDrive);
 	const std::string& HarddiskGetFullPathName(const int iDrive);
+	UINT GetImageBufferSize(void);
 	void GetFilenameAndPathForSaveState(std::string& filename, std::string& path);
 	bool Select(const int iDrive);
 	bool Insert(const int iDrive, const std::string& pathname);
@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Keyboard.h"
 #include "Windows/AppleWin.h"
 #include "Core.h"
+#include "CPU.h"
 #include "Interface.h"
 #include "Utilities.h"
 #include "Pravets.h"
@@ -52,6 +53,7 @@ static bool  g_bTK3KModeKey   = false; //TK3000 //e |Mode| key
 static bool  g_bCapsLock = true; //Caps lock key for Apple2 and Lat/Cyr lock for Pravets8
 static BYTE  keycode         = 0;	// Current Apple keycode
 static BOOL  keywaiting      = 0;
+static UINT64 g_uKeybReadCount = 0;	// # of $C000 reads, eg. to detect the guest waiting for a key
 static bool  g_bAltGrSendsWM_CHAR = false;
 
 //
@@ -261,92 +263,73 @@ void KeybQueueKeypress (WPARAM key, Keystroke_e bASCII)
 
 //===========================================================================
 
-static HGLOBAL hglb = NULL;
-static LPTSTR lptstr = NULL;
-static bool g_bPasteFromClipboard = false;
-static bool g_bClipboardActive = false;
+// Text to type in, from the clipboard or eg. the program loader
+// . the whole text is copied up-front, so the clipboard is only opened once per paste
+// . one char is delivered per strobe clear, ie. as fast as the guest reads the keyboard
+// . the emulator runs at full speed while the guest is waiting for these keys (see KeybIsPasting())
+static std::string g_strPasteText;
+static size_t g_nPasteTextPos = 0;
+static unsigned __int64 g_uKeybLastReadCycle = 0;
 
-void ClipboardInitiatePaste()
+void KeybPasteText(const std::string& text)
 {
-	if (g_bClipboardActive)
-		return;
-
-	g_bPasteFromClipboard = true;
-}
+	if (g_nPasteTextPos)
+	{
+		g_strPasteText.erase(0, g_nPasteTextPos);
+		g_nPasteTextPos = 0;
+	}
 
-static void ClipboardDone()
-{
-	if (g_bClipboardActive)
+	g_strPasteText.reserve(g_strPasteText.size() + text.size());
+	for (size_t i = 0; i < text.size(); i++)
 	{
-		g_bClipboardActive = false;
-		GlobalUnlock(hglb);
-		CloseClipboard();
+		if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n')
+			continue;
+		g_strPasteText += (text[i] == '\n') ? '\r' : text[i];
 	}
 }
 
-static void ClipboardInit()
+void ClipboardInitiatePaste()
 {
-	ClipboardDone();
-
 	if (!IsClipboardFormatAvailable(CF_TEXT))
 		return;
-	
+
 	if (!OpenClipboard(GetFrame().g_hFrameWindow))
 		return;
-	
-	hglb = GetClipboardData(CF_TEXT);
-	if (hglb == NULL)
-	{	
-		CloseClipboard();
-		return;
-	}
 
-	lptstr = (char*) GlobalLock(hglb);
-	if (lptstr == NULL)
-	{	
-		CloseClipboard();
-		return;
+	HGLOBAL hglb = GetClipboardData(CF_TEXT);
+	if (hglb)
+	{
+		const char* lptstr = (const char*) GlobalLock(hglb);
+		if (lptstr)
+		{
+			KeybPasteText(lptstr);
+			GlobalUnlock(hglb);
+		}
 	}
 
-	g_bPasteFromClipboard = false;
-	g_bClipboardActive = true;
+	CloseClipboard();
 }
 
-static char ClipboardCurrChar(bool bIncPtr)
+bool KeybIsPasting(void)
 {
-	char nKey;
-	int nInc = 1;
-
-	if((lptstr[0] == 0x0D) && (lptstr[1] == 0x0A))
-	{
-		nKey = 0x0D;
-		nInc = 2;
-	}
-	else
-	{
-		nKey = lptstr[0];
-	}
-
-	if(bIncPtr)
-		lptstr += nInc;
-
-	return nKey;
+	return g_nPasteTextPos < g_strPasteText.size() &&
+		(g_nCumulativeCycles - g_uKeybLastReadCycle) < KEYB_PASTE_IDLE_CYCLES;
 }
 
-static BYTE ClipboardReadOrPeek(bool incPtr)
+static BYTE PasteTextReadOrPeek(bool incPtr)
 {
-	if (g_bPasteFromClipboard)
-		ClipboardInit();
+	if (g_nPasteTextPos >= g_strPasteText.size())
+		return 0;
 
-	if (g_bClipboardActive)
+	const BYTE key = 0x80 | g_strPasteText[g_nPasteTextPos];
+
+	if (incPtr && ++g_nPasteTextPos >= g_strPasteText.size())
 	{
-		if (*lptstr == 0)
-			ClipboardDone();
-		else
-			return 0x80 | ClipboardCurrChar(incPtr);
+		g_strPasteText.clear();
+		g_nPasteTextPos = 0;
 	}
 
-	return 0;
+	return key;
 }
 
 //===========================================================================
@@ -417,21 +400,30 @@ static bool IsAKD(void)
 BYTE KeybReadData (void)
 {
 	LogFileTimeUntilFirstKeyRead();
+	g_uKeybReadCount++;
+	g_uKeybLastReadCycle = g_nCumulativeCycles;
 
-	BYTE res = ClipboardReadOrPeek(false);
+	BYTE res = PasteTextReadOrPeek(false);
 	if (res)
 		return res;
 
 	return keycode | (keywaiting ? 0x80 : 0);
 }
 
+// Free running: the boot cache's "key" trigger & the program loader each keep the count from when they
+// started waiting, rather than KeybReadData() calling into every module that waits for the guest's prompt
+UINT64 KeybGetReadCount(void)
+{
+	return g_uKeybReadCount;
+}
+
 //===========================================================================
 
 BYTE KeybClearStrobe(void)
 {
 	keywaiting = 0;
 
-	return ClipboardReadOrPeek(true);
+	return PasteTextReadOrPeek(true);
 }
 
 BYTE KeybReadFlag (void)
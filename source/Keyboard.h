@@ -2,7 +2,11 @@
 
 enum	Keystroke_e {NOT_ASCII=0, ASCII};
 
+#define KEYB_PASTE_IDLE_CYCLES 1000000	// guest not reading the keyboard for this long: no longer waiting for pasted keys
+
 void    ClipboardInitiatePaste();
+void    KeybPasteText(const std::string& text);
+bool    KeybIsPasting(void);
 
 void    KeybReset();
 void    KeybSetAltGrSendsWM_CHAR(bool state);
@@ -20,5 +24,6 @@ void    KeybAnyKeyDown(UINT message, WPARAM wparam, bool bIsExtended);
 BYTE    KeybClearStrobe(void);
 BYTE    KeybReadData (void);
 BYTE    KeybReadFlag (void);
+UINT64  KeybGetReadCount(void);
 void    KeybSaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 void    KeybLoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT version);
@@ -152,7 +152,7 @@ BYTE __stdcall LanguageCardUnit::IO(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValu
 	{
 		// NB. Always SetMemMode() - locally may be same, but card may've changed
 		SetMemMode((GetMemMode() & ~MF_LANGCARD_MASK) | (memmode & MF_LANGCARD_MASK));
-		MemUpdatePaging(0);	// Initialize=0
+		MemUpdatePagingLanguageCard();	// only $D000-FFFF can change
 	}
 
 	return bWrite ? 0 : MemReadFloatingBus(nExecutedCycles);
@@ -430,7 +430,7 @@ BYTE __stdcall Saturn128K::IO(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULO
 	{
 		// NB. Always SetMemMode() - locally may be same, but card or bank may've changed
 		SetMemMode((GetMemMode() & ~MF_LANGCARD_MASK) | (memmode & MF_LANGCARD_MASK));
-		MemUpdatePaging(0);	// Initialize=0
+		MemUpdatePagingLanguageCard();	// only $D000-FFFF can change
 	}
 
 	return bWrite ? 0 : MemReadFloatingBus(nExecutedCycles);
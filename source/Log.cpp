@@ -29,19 +29,226 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "StdAfx.h"
 
 #include "Log.h"
+#include "CPU.h"
 
+#include <cinttypes>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <time.h>
 
 FILE* g_fh = NULL;
+std::atomic<uint8_t> g_logLevel[NUM_LOG_CATEGORIES];
 
 #ifdef _WIN32
 #define LOG_FILENAME "AppleWin.log"
+#define LOG_NULL_DEVICE "NUL"
 #else
 // save to /tmp as otherwise it creates a file in the current folder which can be a bit everywhere
 // especially if the program is installed to /usr
 #define LOG_FILENAME "/tmp/AppleWin.log"
+#define LOG_NULL_DEVICE "/dev/null"
 #endif
 
+//---------------------------------------------------------------------------
+
+namespace
+{
+	const size_t kRecordText = 232;		// sizeof(LogRecord) == 256
+	const size_t kNumRecords = 16384;	// power of 2
+	const size_t kMaxMessage = 4096;	// longer messages are truncated
+	const std::chrono::milliseconds kWriterPeriod(10);
+
+	// A bounded multi-producer queue (D. Vyukov): a slot is free for position 'pos' when sequence == pos,
+	// and holds the record for 'pos' when sequence == pos + 1
+	struct LogRecord
+	{
+		std::atomic<size_t> sequence;
+		uint64_t cycles;
+		int64_t nanoseconds;	// since LogInit()
+		uint8_t category;
+		uint8_t level;
+		uint16_t length;
+		char text[kRecordText];
+	};
+
+	const char* const kCategoryNames[NUM_LOG_CATEGORIES] = { "general", "disk", "serial", "network", "sound", "video", "debugger" };
+	const char* const kLevelNames[] = { "off", "error", "warning", "info", "debug", "trace" };
+
+	std::vector<LogRecord> s_records;	// never freed: a late producer may still be writing during LogDone()
+	std::atomic<size_t> s_enqueuePos(0);
+	std::atomic<size_t> s_writtenPos(0);	// records up to here are in the file
+	std::atomic<uint64_t> s_dropped(0);
+
+	LogLevel s_configuredLevel[NUM_LOG_CATEGORIES] = {
+		LOG_LEVEL_INFO, LOG_LEVEL_WARNING, LOG_LEVEL_WARNING, LOG_LEVEL_WARNING, LOG_LEVEL_WARNING, LOG_LEVEL_WARNING, LOG_LEVEL_WARNING
+	};
+
+	std::string s_filename;
+	size_t s_maxFileSize = 16 * 1024 * 1024;
+	UINT s_maxFiles = 3;	// AppleWin.log.1 .. .3
+
+	std::chrono::steady_clock::time_point s_start;
+	std::thread s_writer;
+	std::mutex s_mutex;
+	std::condition_variable s_wakeUp;
+	bool s_stop = false;
+
+	void PublishLevels(const bool enabled)
+	{
+		for (size_t i = 0; i < NUM_LOG_CATEGORIES; ++i)
+			g_logLevel[i].store(enabled ? s_configuredLevel[i] : LOG_LEVEL_OFF, std::memory_order_relaxed);
+	}
+
+	// Claim enough consecutive slots for the message, or drop it
+	void Enqueue(const LogCategory category, const LogLevel level, const char* text, size_t length)
+	{
+		if (s_records.empty())
+			return;
+
+		const uint64_t cycles = g_nCumulativeCycles;
+		const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_start).count();
+
+		const size_t slots = length ? (length + kRecordText - 1) / kRecordText : 1;
+		size_t pos = s_enqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			// slots are freed in order: if the last one is free, so are the others
+			const size_t last = pos + slots - 1;
+			const size_t sequence = s_records[last & (kNumRecords - 1)].sequence.load(std::memory_order_acquire);
+			const ptrdiff_t diff = (ptrdiff_t)sequence - (ptrdiff_t)last;
+			if (diff == 0)
+			{
+				if (s_enqueuePos.compare_exchange_weak(pos, pos + slots, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				s_dropped.fetch_add(1, std::memory_order_relaxed);	// full
+				return;
+			}
+			else
+			{
+				pos = s_enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		for (size_t i = 0; i < slots; ++i)
+		{
+			LogRecord& record = s_records[(pos + i) & (kNumRecords - 1)];
+			const size_t chunk = std::min(length, kRecordText);
+			record.cycles = cycles;
+			record.nanoseconds = nanoseconds;
+			record.category = (uint8_t)category;
+			record.level = (uint8_t)level;
+			record.length = (uint16_t)chunk;
+			memcpy(record.text, text, chunk);
+			text += chunk;
+			length -= chunk;
+			record.sequence.store(pos + i + 1, std::memory_order_release);
+		}
+	}
+
+	void EnqueueV(const LogCategory category, const LogLevel level, const char* format, va_list args)
+	{
+		char buffer[kMaxMessage];
+		const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+		if (length > 0)
+			Enqueue(category, level, buffer, std::min((size_t)length, sizeof(buffer) - 1));
+	}
+
+	std::string RotatedFilename(const UINT n)
+	{
+		return s_filename + "." + std::to_string(n);
+	}
+
+	// The FILE* is kept (freopen) as some code writes to g_fh directly
+	void RotateFile(void)
+	{
+		fflush(g_fh);
+		if (!freopen(LOG_NULL_DEVICE, "w", g_fh))	// close the log file, needed to rename it on Windows
+			return;
+
+		remove(RotatedFilename(s_maxFiles).c_str());
+		for (UINT n = s_maxFiles; n > 1; --n)
+			rename(RotatedFilename(n - 1).c_str(), RotatedFilename(n).c_str());
+		rename(s_filename.c_str(), RotatedFilename(1).c_str());
+
+		if (freopen(s_filename.c_str(), "wt", g_fh))
+		{
+			setvbuf(g_fh, NULL, _IOFBF, 64 * 1024);
+			fprintf(g_fh, "*** Logging continued from %s\n", RotatedFilename(1).c_str());
+		}
+	}
+
+	void Drain(size_t& readPos, bool& atLineStart, uint64_t& dropped, size_t& fileSize)
+	{
+		const size_t start = readPos;
+		for (;;)
+		{
+			LogRecord& record = s_records[readPos & (kNumRecords - 1)];
+			if (record.sequence.load(std::memory_order_acquire) != readPos + 1)
+				break;	// empty, or still being written
+
+			if (atLineStart)
+			{
+				char prefix[80];
+				const int length = snprintf(prefix, sizeof(prefix), "%12.6f %12" PRIu64 " %-8s %c ",
+					record.nanoseconds / 1e9, record.cycles, kCategoryNames[record.category], toupper(kLevelNames[record.level][0]));
+				fwrite(prefix, 1, length, g_fh);
+				fileSize += length;
+			}
+			fwrite(record.text, 1, record.length, g_fh);
+			fileSize += record.length;
+			atLineStart = record.length && record.text[record.length - 1] == '\n';
+
+			record.sequence.store(readPos + kNumRecords, std::memory_order_release);
+			++readPos;
+		}
+
+		const uint64_t nowDropped = s_dropped.load(std::memory_order_relaxed);
+		if (nowDropped != dropped)
+		{
+			const int length = fprintf(g_fh, "%s*** %" PRIu64 " records dropped\n", atLineStart ? "" : "\n", nowDropped - dropped);
+			fileSize += std::max(length, 0);
+			atLineStart = true;
+			dropped = nowDropped;
+		}
+
+		if (readPos != start)
+		{
+			fflush(g_fh);
+			if (fileSize > s_maxFileSize && s_maxFiles && atLineStart)
+			{
+				RotateFile();
+				fileSize = 0;
+			}
+		}
+		s_writtenPos.store(readPos, std::memory_order_release);
+	}
+
+	void Writer(size_t readPos)
+	{
+		bool atLineStart = true;
+		uint64_t dropped = s_dropped.load();
+		long position = ftell(g_fh);
+		size_t fileSize = position > 0 ? (size_t)position : 0;
+
+		std::unique_lock<std::mutex> lock(s_mutex);
+		for (;;)
+		{
+			const bool stop = s_wakeUp.wait_for(lock, kWriterPeriod, [] { return s_stop; });
+
+			lock.unlock();
+			Drain(readPos, atLineStart, dropped, fileSize);
+			lock.lock();
+
+			if (stop)
+				break;
+		}
+	}
+}
 
 //---------------------------------------------------------------------------
 
@@ -59,21 +266,39 @@ inline std::string GetTimeStamp()
 	return std::string(ct, 24);
 }
 
-void LogInit(void)
+void LogInit(const char* filename)
 {
 	if (g_fh)
 		return;
 
-	g_fh = fopen(LOG_FILENAME, "a+t");	    // Open log file (append & text mode)
+	s_filename = filename ? filename : LOG_FILENAME;
+	g_fh = fopen(s_filename.c_str(), "a+t");	    // Open log file (append & text mode)
 	if (!g_fh)
 	{
-		LogOutput("Failed to open logfile '%s'\n", LOG_FILENAME);
+		LogOutput("Failed to open logfile '%s'\n", s_filename.c_str());
 		return;
 	}
 
-	setvbuf(g_fh, NULL, _IONBF, 0);			// No buffering (so implicit fflush after every fprintf)
+	setvbuf(g_fh, NULL, _IOFBF, 64 * 1024);	// Flushed by the log thread after each batch of records
 
 	fprintf(g_fh, "*** Logging started: %s\n", GetTimeStamp().c_str());
+	fprintf(g_fh, "*** seconds, cycles, category, level (Error/Warning/Info/Debug/Trace)\n");
+	fflush(g_fh);
+
+	if (s_records.empty())
+	{
+		s_records = std::vector<LogRecord>(kNumRecords);
+		for (size_t i = 0; i < kNumRecords; ++i)
+			s_records[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	const size_t readPos = s_enqueuePos.load();
+	s_writtenPos.store(readPos);
+	s_start = std::chrono::steady_clock::now();
+
+	s_stop = false;
+	s_writer = std::thread(Writer, readPos);
+
+	PublishLevels(true);
 }
 
 void LogDone(void)
@@ -81,11 +306,99 @@ void LogDone(void)
 	if (!g_fh)
 		return;
 
+	PublishLevels(false);
+
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_stop = true;
+	}
+	s_wakeUp.notify_one();
+	s_writer.join();
+
 	fprintf(g_fh,"*** Logging ended\n\n");
 	fclose(g_fh);
 	g_fh = NULL;
 }
 
+void LogFlush(void)
+{
+	if (!g_fh)
+		return;
+
+	const size_t target = s_enqueuePos.load();
+	s_wakeUp.notify_one();
+	while ((ptrdiff_t)(s_writtenPos.load(std::memory_order_acquire) - target) < 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+//---------------------------------------------------------------------------
+
+void LogSetLevel(const LogCategory category, const LogLevel level)
+{
+	s_configuredLevel[category] = level;
+	if (g_fh)
+		g_logLevel[category].store(level, std::memory_order_relaxed);
+}
+
+LogLevel LogGetLevel(const LogCategory category)
+{
+	return s_configuredLevel[category];
+}
+
+bool LogSetLevels(const std::string& levels)
+{
+	size_t begin = 0;
+	while (begin < levels.size())
+	{
+		size_t end = levels.find(',', begin);
+		if (end == std::string::npos)
+			end = levels.size();
+
+		const std::string item = levels.substr(begin, end - begin);
+		const size_t equal = item.find('=');
+		if (equal == std::string::npos)
+			return false;
+
+		const std::string name = item.substr(0, equal);
+		const std::string value = item.substr(equal + 1);
+
+		int level = -1;
+		for (size_t i = 0; i < sizeof(kLevelNames) / sizeof(kLevelNames[0]); ++i)
+		{
+			if (value == kLevelNames[i])
+				level = (int)i;
+		}
+		if (level < 0)
+			return false;
+
+		bool found = false;
+		for (int i = 0; i < NUM_LOG_CATEGORIES; ++i)
+		{
+			if (name == "all" || name == kCategoryNames[i])
+			{
+				LogSetLevel((LogCategory)i, (LogLevel)level);
+				found = true;
+			}
+		}
+		if (!found)
+			return false;
+
+		begin = end + 1;
+	}
+	return true;
+}
+
+void LogSetRotation(const size_t maxFileSize, const UINT maxFiles)
+{
+	s_maxFileSize = maxFileSize;
+	s_maxFiles = maxFiles;
+}
+
+uint64_t LogGetDroppedRecords(void)
+{
+	return s_dropped.load(std::memory_order_relaxed);
+}
+
 //---------------------------------------------------------------------------
 
 void LogOutput(const char* format, ...)
@@ -102,13 +415,26 @@ void LogOutput(const char* format, ...)
 
 void LogFileOutput(const char* format, ...)
 {
-	if (!g_fh)
+	if (!LogIsEnabled(LOG_CATEGORY_GENERAL, LOG_LEVEL_INFO))
+		return;
+
+	va_list args;
+	va_start(args, format);
+
+	EnqueueV(LOG_CATEGORY_GENERAL, LOG_LEVEL_INFO, format, args);
+
+	va_end(args);
+}
+
+void LogCategoryOutput(const LogCategory category, const LogLevel level, const char* format, ...)
+{
+	if (!LogIsEnabled(category, level))
 		return;
 
 	va_list args;
 	va_start(args, format);
 
-	vfprintf(g_fh, format, args);
+	EnqueueV(category, level, format, args);
 
 	va_end(args);
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
+#include <string>
 
 #include "StrFormat.h"
 
@@ -12,10 +15,62 @@
 	#endif
 #endif
 
-extern FILE* g_fh;	// File handle for log file
+extern FILE* g_fh;	// File handle for log file (direct writes bypass the log thread)
 
-void LogInit(void);
+// Log file output is asynchronous:
+// . each call formats a record into a lock-free ring (no I/O on the calling thread)
+// . a thread drains the ring into the (buffered) file, which is rotated when it gets too big
+// . lines are prefixed with the time since LogInit() and the emulated cycle count
+// . if the ring is full, records are dropped (and counted) rather than stall emulation
+
+enum LogCategory
+{
+	LOG_CATEGORY_GENERAL,	// LogFileOutput()
+	LOG_CATEGORY_DISK,
+	LOG_CATEGORY_SERIAL,
+	LOG_CATEGORY_NETWORK,
+	LOG_CATEGORY_SOUND,
+	LOG_CATEGORY_VIDEO,
+	LOG_CATEGORY_DEBUGGER,
+	NUM_LOG_CATEGORIES
+};
+
+enum LogLevel
+{
+	LOG_LEVEL_OFF,
+	LOG_LEVEL_ERROR,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_DEBUG,
+	LOG_LEVEL_TRACE
+};
+
+// Levels above this are compiled out
+#ifndef LOG_LEVEL_MAX
+#define LOG_LEVEL_MAX LOG_LEVEL_TRACE
+#endif
+
+extern std::atomic<uint8_t> g_logLevel[NUM_LOG_CATEGORIES];	// all LOG_LEVEL_OFF while the log file is closed
+
+inline bool LogIsEnabled(const LogCategory category, const LogLevel level)
+{
+	return level <= g_logLevel[category].load(std::memory_order_relaxed);
+}
+
+// When disabled: one load & branch, and the arguments are not evaluated
+#define LOG_CATEGORY(category, level, ...) \
+	do { if ((level) <= LOG_LEVEL_MAX && LogIsEnabled(category, level)) LogCategoryOutput(category, level, __VA_ARGS__); } while (0)
+
+void LogInit(const char* filename = NULL);	// NULL: default log file
 void LogDone(void);
+void LogFlush(void);	// wait until all records logged so far are in the file
+
+void LogSetLevel(const LogCategory category, const LogLevel level);	// can be called before LogInit()
+LogLevel LogGetLevel(const LogCategory category);
+bool LogSetLevels(const std::string& levels);	// eg. "disk=debug,network=trace" or "all=info"
+void LogSetRotation(const size_t maxFileSize, const UINT maxFiles);
+uint64_t LogGetDroppedRecords(void);
 
 void LogOutput(const char* format, ...) ATTRIBUTE_FORMAT_PRINTF(1, 2);
 void LogFileOutput(const char* format, ...) ATTRIBUTE_FORMAT_PRINTF(1, 2);
+void LogCategoryOutput(const LogCategory category, const LogLevel level, const char* format, ...) ATTRIBUTE_FORMAT_PRINTF(3, 4);
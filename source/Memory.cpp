@@ -72,6 +72,25 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #define ALIGNED_FREE(ptr) delete [] ptr
 #endif
 
+// RamWorks III banks (up to 16MB) are one reserved region: the OS only commits a page when it is first written
+// (reads of a never written page all map to the same zero page), so a large card costs little until it is used.
+#ifdef _WIN32
+#define RAMWORKS_ALLOC(size) (LPBYTE)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)
+#define RAMWORKS_FREE(ptr, size) VirtualFree(ptr, 0, MEM_RELEASE)
+#else
+static LPBYTE RAMWORKS_ALLOC(const size_t size)
+{
+	void* const ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (ptr == MAP_FAILED)
+		return NULL;
+#ifdef MADV_NOHUGEPAGE
+	madvise(ptr, size, MADV_NOHUGEPAGE);	// else a write can commit a whole (multi-page) folio
+#endif
+	return (LPBYTE)ptr;
+}
+#define RAMWORKS_FREE(ptr, size) munmap(ptr, size)
+#endif
+
 
 // UTAIIe:5-28 (GH#419)
 // . Sather uses INTCXROM instead of SLOTCXROM' (used by the Apple//e Tech Ref Manual), so keep to this
@@ -184,6 +203,14 @@ SOFT SWITCH STATUS FLAGS
 //		. writes will still set the dirty flag (but can be ignored)
 //		. UpdatePaging() ignores this, as it only copies back to the physical 64K mem block when memshadow changes (for that 256-byte page)
 //
+// memwriteTrap (debugger write watchpoints)
+// - 1 pointer entry per 256-byte page
+// - for a page containing a watched byte, memwrite is set to NULL and the real write pointer is moved here
+//		. so the CPU's _WRITE macros take their (already existing) slow path for this page only, and call MemWriteTrap()
+//		. all other pages keep the fast path, so watchpoints cost nothing unless their page is written to
+// - re-applied at the end of UpdatePaging(), since that rebuilds memwrite
+// - never used for the stack page (_PUSH writes directly to 'mem') or for $C000-$CFFF (I/O & slot ROM)
+//
 // memdirty
 // - 1 byte entry per 256-byte page
 // - set when a write occurs to a 256-byte page
@@ -224,6 +251,7 @@ SOFT SWITCH STATUS FLAGS
 
 LPBYTE			memshadow[_6502_NUM_PAGES];
 LPBYTE			memwrite[_6502_NUM_PAGES];
+LPBYTE			memwriteTrap[_6502_NUM_PAGES];
 BYTE			memreadPageType[_6502_NUM_PAGES];
 
 static const UINT kNumIOFunctionPointers = APPLE_TOTAL_IO_SIZE / 16;	// Split into 16-byte units
@@ -256,10 +284,18 @@ LPBYTE  memVidHD = NULL;	// For Apple II/II+ writes to aux mem (on VidHD card).
 
 static CNoSlotClock* g_NoSlotClock = new CNoSlotClock;
 
+static BYTE		g_memWriteTrapMap[_6502_MEM_LEN / 8];		// 1 bit per watched byte
+static WORD		g_memWriteTrapPageCount[_6502_NUM_PAGES];	// # of watched bytes per page
+static UINT		g_memWriteTrapNumPages = 0;					// # of pages with a watched byte
+bool			g_memWriteTrapHit = false;					// Set by MemWriteTrap(), stops the CPU at the end of the current opcode
+static MemWriteTrapHit_t g_memWriteTrapLastHit;
+
 #ifdef RAMWORKS
 static UINT		g_uMaxExBanks = 1;				// user requested ram banks (default to 1 aux bank: so total = 128KB)
 static UINT		g_uActiveBank = 0;				// 0 = aux 64K for: //e extended 80 Col card, or //c -- also RamWorks III aux card
 static LPBYTE	RWpages[kMaxExMemoryBanks];		// pointers to RW memory banks
+static LPBYTE	g_pRamWorksBanks = NULL;		// RWpages[1..] all point into this region
+static UINT		g_uRamWorksBanks = 0;			// # of banks in g_pRamWorksBanks
 #endif
 
 static const UINT kNumAnnunciators = 4;
@@ -277,6 +313,21 @@ static void FreeMemImage(void);
 static bool g_isMemCacheValid = true;	// flag for is 'mem' valid - set in UpdatePaging() and valid for regular (not alternate) CPU emulation
 static bool g_forceAltCpuEmulation = false;	// set by cmd line
 
+// Bank switching by pointer:
+// . a bank switch only updates the affected pages' memshadow/memwrite pointers (see MemUpdatePagingLanguageCard(), UpdatePagingForAuxBank())
+// . but with the 'mem' cache, every page whose memshadow changed is also copied (and the dirty ones written back)
+//   - eg. 4K for a LC bank, 12K for a Saturn bank, up to 48K for a RamWorks bank
+// . so when software is switching banks heavily, the cache is dropped and the alt CPU emulation is used instead (it reads via memshadow)
+// . once the switching has quietened down, the cache is rebuilt, since the regular CPU emulation is faster for everything else
+static bool g_isMemCacheSupported = true;		// false if 'mem' can never be used (//e without 64K aux, or alt CPU emulation forced)
+static bool g_bankSwitchByPointer = true;		// allow dropping the cache for heavy bank switching
+static UINT g_bankSwitchPagesCopied = 0;		// memshadow pages changed by UpdatePaging() in the current window
+static UINT g_bankSwitchWindowCycles = 0;
+static UINT g_bankSwitchQuietWindows = 0;
+static const UINT kBankSwitchWindowCycles = 17030;		// ~1 video frame
+static const UINT kBankSwitchMaxPagesPerWindow = 1024;	// 256K copied per video frame, eg. ~5 RamWorks or ~64 LC bank switches
+static const UINT kBankSwitchQuietWindows = 60;			// ~1 second below the limit before going back to the cache
+
 //=============================================================================
 
 // Default memory types on a VM restart
@@ -502,10 +553,11 @@ void WriteByteToMemory(uint16_t addr, uint8_t data)
 		return;
 	}
 
-	if (memwrite[addr >> 8] == NULL)	// Can be NULL (eg. ROM)
+	LPBYTE page = MemGetWritePage(addr >> 8);
+	if (page == NULL)	// Can be NULL (eg. ROM)
 		return;
 
-	*(memwrite[addr >> 8] + (addr & 0xff)) = data;
+	*(page + (addr & 0xff)) = data;
 }
 
 void CopyBytesFromMemoryPage(uint8_t* pDst, uint16_t srcAddr, size_t size)
@@ -539,6 +591,138 @@ void ForceAltCpuEmulation(void)
 	g_forceAltCpuEmulation = true;
 }
 
+//===========================================================================
+
+// Write traps for the debugger's memory write breakpoints (see memwriteTrap, above)
+
+static bool MemIsWriteTrapPage(const UINT page)
+{
+	return page != _6502_STACK_PAGE && (page < (APPLE_IO_BEGIN >> 8) || page > (FIRMWARE_EXPANSION_END >> 8));
+}
+
+// Swap memwrite[] <-> memwriteTrap[] for all pages with a watched byte
+// . bRestore=true : undo the traps, eg. before the set of watched bytes changes
+// . bRestore=false: (re)apply the traps, eg. after UpdatePaging() has rebuilt memwrite[]
+static void MemWriteTrapUpdatePages(const bool bRestore)
+{
+	for (UINT page = 0; page < _6502_NUM_PAGES; page++)
+	{
+		if (bRestore)
+		{
+			if (memwriteTrap[page])
+				memwrite[page] = memwriteTrap[page];
+			memwriteTrap[page] = NULL;
+		}
+		else
+		{
+			memwriteTrap[page] = NULL;
+			if (g_memWriteTrapPageCount[page] && memwrite[page])	// NB. memwrite==NULL for ROM, so no need to trap
+			{
+				memwriteTrap[page] = memwrite[page];
+				memwrite[page] = NULL;
+			}
+		}
+	}
+
+	z80_paging_changed();
+}
+
+bool MemCanWriteTrap(const WORD addr, const UINT len)
+{
+	if (len == 0)
+		return false;
+
+	const UINT end = std::min((UINT)addr + len, (UINT)_6502_MEM_LEN);
+	for (UINT page = addr >> 8; page <= ((end - 1) >> 8); page++)
+	{
+		if (!MemIsWriteTrapPage(page))
+			return false;
+	}
+
+	return true;
+}
+
+void MemWriteTrapAdd(const WORD addr, const UINT len)
+{
+	_ASSERT(MemCanWriteTrap(addr, len));
+
+	MemWriteTrapUpdatePages(true);
+
+	const UINT end = std::min((UINT)addr + len, (UINT)_6502_MEM_LEN);
+	for (UINT a = addr; a < end; a++)
+	{
+		const BYTE mask = 1 << (a & 7);
+		if ((g_memWriteTrapMap[a >> 3] & mask) || !MemIsWriteTrapPage(a >> 8))
+			continue;
+
+		g_memWriteTrapMap[a >> 3] |= mask;
+		if (g_memWriteTrapPageCount[a >> 8]++ == 0)
+			g_memWriteTrapNumPages++;
+	}
+
+	MemWriteTrapUpdatePages(false);
+}
+
+void MemWriteTrapClear(void)
+{
+	if (g_memWriteTrapNumPages)
+	{
+		MemWriteTrapUpdatePages(true);
+
+		memset(g_memWriteTrapMap, 0, sizeof(g_memWriteTrapMap));
+		memset(g_memWriteTrapPageCount, 0, sizeof(g_memWriteTrapPageCount));
+		g_memWriteTrapNumPages = 0;
+	}
+
+	g_memWriteTrapHit = false;
+}
+
+bool MemWriteTrapIsActive(void)
+{
+	return g_memWriteTrapNumPages != 0;
+}
+
+// Returns true (once) if a watched byte has been written since the last call
+bool MemWriteTrapGetHit(MemWriteTrapHit_t& hit)
+{
+	if (!g_memWriteTrapHit)
+		return false;
+
+	hit = g_memWriteTrapLastHit;
+	g_memWriteTrapHit = false;
+	return true;
+}
+
+// Called by the CPU's _WRITE macros when memwrite[addr>>8] is NULL (and not I/O)
+void MemWriteTrap(const WORD addr, const BYTE value, const ULONG uExecutedCycles)
+{
+	LPBYTE page = memwriteTrap[addr >> 8];
+	if (!page)	// ROM
+		return;
+
+	*(page + (addr & 0xFF)) = value;
+	if (memVidHD)	// GH#997
+		*(memVidHD + addr) = value;
+
+	if (g_memWriteTrapMap[addr >> 3] & (1 << (addr & 7)))
+	{
+		CpuCalcCycles(uExecutedCycles);
+
+		// NB. Last hit wins: eg. NMOS read-modify-write opcodes write the byte twice
+		g_memWriteTrapLastHit.addr = addr;
+		g_memWriteTrapLastHit.value = value;
+		g_memWriteTrapLastHit.pc = regs.pc;
+		g_memWriteTrapLastHit.cycle = g_nCumulativeCycles;
+		g_memWriteTrapHit = true;
+	}
+}
+
+// For DMA (eg. HDD) and the debugger, which need the real write pointer even if the page is trapped
+LPBYTE MemGetWritePage(const BYTE page)
+{
+	return memwrite[page] ? memwrite[page] : memwriteTrap[page];
+}
+
 uint8_t ReadByteFromROM(uint16_t addr)
 {
 	if (addr < APPLE_IO_BEGIN)					// $0000-BFFF
@@ -615,6 +799,7 @@ static BYTE __stdcall IOWrite_C01x(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULON
 
 static BYTE __stdcall IORead_C02x(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles)
 {
+	TapeWrite(pc, addr, bWrite, d, nExecutedCycles);	// $C020 TAPEOUT is toggled by any access (the monitor's WRITE uses LDY)
 	return IO_Null(pc, addr, bWrite, d, nExecutedCycles);
 }
 
@@ -1104,6 +1289,8 @@ BYTE __stdcall IO_F8xx(WORD programcounter, WORD address, BYTE write, BYTE value
 		LPBYTE page = memwrite[address >> 8];
 		if (page)
 			*(page+(address & 0xFF)) = value;
+		else if (memwriteTrap[address >> 8])
+			MemWriteTrap(address, value, nCycles);
 		return 0;
 	}
 }
@@ -1320,6 +1507,12 @@ static void ResetPaging(BOOL initialize)
 //===========================================================================
 
 static void UpdatePagingForAltRW(void);
+static void UpdatePagingForAltRWLanguageCard(void);
+static void UpdatePagingLanguageCardTables(void);
+static void UpdateShadowedPages(BOOL initialize, LPBYTE* oldshadow, const UINT firstPage, const UINT lastPage);
+#ifdef RAMWORKS
+static void UpdatePagingForAuxBank(LPBYTE oldAux);
+#endif
 
 void MemUpdatePaging(BOOL initialize)
 {
@@ -1333,9 +1526,14 @@ static void UpdatePaging(BOOL initialize)
 		// Importantly from:
 		// . MemReset() -> ResetPaging(TRUE)
 		// . MemInitializeFromSnapshot() -> MemUpdatePaging(TRUE);
-		g_isMemCacheValid = !(IsAppleIIe(GetApple2Type()) && (GetCardMgr().QueryAux() == CT_Empty || GetCardMgr().QueryAux() == CT_80Col));
+		g_isMemCacheSupported = !(IsAppleIIe(GetApple2Type()) && (GetCardMgr().QueryAux() == CT_Empty || GetCardMgr().QueryAux() == CT_80Col));
 		if (g_forceAltCpuEmulation)
-			g_isMemCacheValid = false;
+			g_isMemCacheSupported = false;
+
+		g_isMemCacheValid = g_isMemCacheSupported;
+		g_bankSwitchPagesCopied = 0;
+		g_bankSwitchWindowCycles = 0;
+		g_bankSwitchQuietWindows = 0;
 	}
 
 	modechanging = 0;
@@ -1395,6 +1593,44 @@ static void UpdatePaging(BOOL initialize)
 														: pCxRomInternal+uRomOffset;			// C800..CFFF - Internal ROM
 	}
 
+	UpdatePagingLanguageCardTables();
+
+	if (SW_80STORE)
+	{
+		for (loop = 0x04; loop < 0x08; loop++)
+		{
+			memshadow[loop] = SW_PAGE2	? memaux+(loop << 8)
+										: memmain+(loop << 8);
+			memwrite[loop]  = mem+(loop << 8);
+		}
+
+		if (SW_HIRES)
+		{
+			for (loop = 0x20; loop < 0x40; loop++)
+			{
+				memshadow[loop] = SW_PAGE2	? memaux+(loop << 8)
+											: memmain+(loop << 8);
+				memwrite[loop]  = mem+(loop << 8);
+			}
+		}
+	}
+
+	UpdateShadowedPages(initialize, oldshadow, 0x00, 0xFF);
+
+	if (!g_isMemCacheValid)
+		UpdatePagingForAltRW();
+
+	if (g_memWriteTrapNumPages)
+		MemWriteTrapUpdatePages(false);
+
+	z80_paging_changed();	// Z80 SoftCard's page table is built from memwrite[]
+}
+
+// $D000-FFFF: ROM, or the LC's RAM (main, aux or a Saturn 16K bank)
+static void UpdatePagingLanguageCardTables(void)
+{
+	UINT loop;
+
 	const int selectedrompage = (SW_ALTROM0 ? 1 : 0) | (SW_ALTROM1 ? 2 : 0);
 #ifdef _DEBUG
 	if (selectedrompage) { _ASSERT(IsCopamBase64A(GetApple2Type())); }
@@ -1424,27 +1660,11 @@ static void UpdatePaging(BOOL initialize)
 																	: g_pMemMainLanguageCard+((loop-0xC0)<<8)
 										: NULL;
 	}
+}
 
-	if (SW_80STORE)
-	{
-		for (loop = 0x04; loop < 0x08; loop++)
-		{
-			memshadow[loop] = SW_PAGE2	? memaux+(loop << 8)
-										: memmain+(loop << 8);
-			memwrite[loop]  = mem+(loop << 8);
-		}
-
-		if (SW_HIRES)
-		{
-			for (loop = 0x20; loop < 0x40; loop++)
-			{
-				memshadow[loop] = SW_PAGE2	? memaux+(loop << 8)
-											: memmain+(loop << 8);
-				memwrite[loop]  = mem+(loop << 8);
-			}
-		}
-	}
-
+// Pages [firstPage, lastPage] of memshadow[] may have changed
+static void UpdateShadowedPages(BOOL initialize, LPBYTE* oldshadow, const UINT firstPage, const UINT lastPage)
+{
 	if (g_isMemCacheValid)
 	{
 		// MOVE MEMORY BACK AND FORTH AS NECESSARY BETWEEN THE SHADOW AREAS AND
@@ -1458,7 +1678,7 @@ static void UpdatePaging(BOOL initialize)
 		// . Page1 (stack) : memdirty[1] is NOT set when the 6502 CPU writes to this page with JSR, PHA, etc.
 		// Ultimately this is an optimisation (due to Page1 writes not setting memdirty[1]) and Page0 could be optimised to also not set memdirty[0].
 
-		for (UINT page = _6502_ZERO_PAGE; page < _6502_NUM_PAGES; page++)
+		for (UINT page = firstPage; page <= lastPage; page++)
 		{
 			if (initialize || (oldshadow[page] != memshadow[page]))
 			{
@@ -1470,12 +1690,126 @@ static void UpdatePaging(BOOL initialize)
 				}
 
 				memcpy(mem+(page << 8),memshadow[page],_6502_PAGE_SIZE);
+
+				if (!initialize)
+					g_bankSwitchPagesCopied++;
 			}
 		}
 	}
-	else
+	else if (!initialize && g_isMemCacheSupported)
 	{
-		UpdatePagingForAltRW();
+		for (UINT page = firstPage; page <= lastPage; page++)
+		{
+			if (oldshadow[page] != memshadow[page])
+				g_bankSwitchPagesCopied++;	// would have been copied
+		}
+	}
+}
+
+// Bank switches: only the pages that can be affected are updated (rather than all the paging tables)
+// . not when a paging update is pending (modechanging), or for write traps (which replace memwrite[] entries)
+
+// LC & Saturn: bank, card or LC mode change
+void MemUpdatePagingLanguageCard(void)
+{
+	if (modechanging || g_memWriteTrapNumPages || !g_isMemCacheSupported)
+	{
+		UpdatePaging(FALSE);
+		return;
+	}
+
+	LPBYTE oldshadow[256];
+	memcpy(oldshadow+0xD0, memshadow+0xD0, 0x30*sizeof(LPBYTE));
+
+	UpdatePagingLanguageCardTables();
+	UpdateShadowedPages(FALSE, oldshadow, 0xD0, 0xFF);
+
+	if (!g_isMemCacheValid)
+		UpdatePagingForAltRWLanguageCard();
+
+	z80_paging_changed();
+}
+
+#ifdef RAMWORKS
+static void RemapAuxPages(LPBYTE oldAux, const UINT firstPage, const UINT lastPage)
+{
+	for (UINT page = firstPage; page <= lastPage; page++)
+	{
+		const uintptr_t writeOffset = (uintptr_t)memwrite[page] - (uintptr_t)oldAux;
+		if (writeOffset < _6502_MEM_LEN)
+			memwrite[page] = memaux + writeOffset;
+
+		const uintptr_t shadowOffset = (uintptr_t)memshadow[page] - (uintptr_t)oldAux;
+		if (shadowOffset >= _6502_MEM_LEN)
+			continue;
+
+		LPBYTE oldshadow = memshadow[page];
+		memshadow[page] = memaux + shadowOffset;
+		g_bankSwitchPagesCopied++;
+
+		if (g_isMemCacheValid)	// as UpdateShadowedPages()
+		{
+			if ((*(memdirty+page) & 1) || (page <= _6502_STACK_PAGE))
+			{
+				*(memdirty+page) &= ~1;
+				memcpy(oldshadow, mem+(page << 8), _6502_PAGE_SIZE);
+			}
+
+			memcpy(mem+(page << 8), memshadow[page], _6502_PAGE_SIZE);
+		}
+	}
+}
+
+// RamWorks bank select: the pages mapped to aux memory now point into the new bank - nothing else changes
+static void UpdatePagingForAuxBank(LPBYTE oldAux)
+{
+	if (modechanging || g_memWriteTrapNumPages || !g_isMemCacheSupported)
+	{
+		UpdatePaging(FALSE);
+		return;
+	}
+
+	if (oldAux == memaux)
+		return;
+
+	// Only these pages can be mapped to aux memory (see UpdatePaging())
+	if (SW_ALTZP)
+	{
+		RemapAuxPages(oldAux, 0x00, 0x01);
+		RemapAuxPages(oldAux, 0xD0, 0xFF);
+	}
+
+	if (SW_AUXREAD || SW_AUXWRITE)
+	{
+		RemapAuxPages(oldAux, 0x02, 0xBF);
+	}
+	else if (SW_80STORE && SW_PAGE2)
+	{
+		RemapAuxPages(oldAux, 0x04, 0x07);
+		RemapAuxPages(oldAux, 0x20, 0x3F);
+	}
+
+	z80_paging_changed();
+}
+#endif
+
+static BYTE GetAltRWAuxMemType(void)
+{
+	return (GetCardMgr().QueryAux() == CT_Empty) ? MEM_FloatingBus : MEM_Normal;
+}
+
+// $D000-FFFF (NB. for the //e's 80-col(1KiB) card, UpdatePagingForAltRW() then remaps the aux pages)
+static void UpdatePagingForAltRWLanguageCard(void)
+{
+	const BYTE memType = GetAltRWAuxMemType();
+
+	for (UINT page = 0xD0; page < 0x100; page++)
+		memreadPageType[page] = (SW_HIGHRAM && SW_ALTZP) ? memType : MEM_Normal;
+
+	if (SW_WRITERAM && SW_HIGHRAM)
+	{
+		for (UINT page = 0xD0; page < 0x100; page++)
+			memwrite[page] = memshadow[page];
 	}
 }
 
@@ -1484,7 +1818,7 @@ static void UpdatePagingForAltRW(void)
 {
 	UINT page;
 
-	const BYTE memType = (GetCardMgr().QueryAux() == CT_Empty) ? MEM_FloatingBus : MEM_Normal;
+	const BYTE memType = GetAltRWAuxMemType();
 
 	for (page = 0x00; page < 0x02; page++)
 		memreadPageType[page] = SW_ALTZP ? memType : MEM_Normal;
@@ -1501,9 +1835,6 @@ static void UpdatePagingForAltRW(void)
 		memreadPageType[page] = MEM_IORead;
 	}
 
-	for (page = 0xD0; page < 0x100; page++)
-		memreadPageType[page] = (SW_HIGHRAM && SW_ALTZP) ? memType : MEM_Normal;
-
 	if (SW_80STORE)
 	{
 		for (page = 0x04; page < 0x08; page++)
@@ -1524,11 +1855,7 @@ static void UpdatePagingForAltRW(void)
 			memwrite[page] = memshadow[page];
 	}
 
-	if (SW_WRITERAM && SW_HIGHRAM)
-	{
-		for (page = 0xD0; page < 0x100; page++)
-			memwrite[page] = memshadow[page];
-	}
+	UpdatePagingForAltRWLanguageCard();
 
 	if (SW_80STORE)
 	{
@@ -1584,6 +1911,39 @@ static void UpdatePagingForAltRW(void)
 	}
 }
 
+//===========================================================================
+
+#ifdef RAMWORKS
+static void FreeRamWorksBanks(void)
+{
+	if (g_pRamWorksBanks)
+		RAMWORKS_FREE(g_pRamWorksBanks, (size_t)g_uRamWorksBanks * _6502_MEM_LEN);
+
+	g_pRamWorksBanks = NULL;
+	g_uRamWorksBanks = 0;
+
+	for (UINT i=1; i<kMaxExMemoryBanks; i++)
+		RWpages[i] = NULL;
+}
+
+// Banks 1..(numBanks-1): bank 0 is memaux
+static void AllocRamWorksBanks(const UINT numBanks)
+{
+	FreeRamWorksBanks();
+
+	if (numBanks < 2)
+		return;
+
+	g_pRamWorksBanks = RAMWORKS_ALLOC((size_t)(numBanks - 1) * _6502_MEM_LEN);
+	if (!g_pRamWorksBanks)
+		return;		// no RamWorks banks: same as a failed allocation of the 1st bank
+
+	g_uRamWorksBanks = numBanks - 1;
+	for (UINT i=1; i<numBanks; i++)
+		RWpages[i] = g_pRamWorksBanks + (size_t)(i - 1) * _6502_MEM_LEN;
+}
+#endif
+
 //
 // ----- ALL GLOBALLY ACCESSIBLE FUNCTIONS ARE BELOW THIS LINE -----
 //
@@ -1603,14 +1963,7 @@ void MemDestroy()
 	delete [] pCxRomPeripheral;
 
 #ifdef RAMWORKS
-	for (UINT i=1; i<kMaxExMemoryBanks; i++)
-	{
-		if (RWpages[i])
-		{
-			ALIGNED_FREE(RWpages[i]);
-			RWpages[i] = NULL;
-		}
-	}
+	FreeRamWorksBanks();
 	RWpages[0]=NULL;
 #endif
 
@@ -1772,6 +2125,64 @@ static void BackMainImage(void)
 
 //-------------------------------------
 
+// Go back to the regular CPU emulation: 'mem' is rebuilt from the memshadow pages (which are up-to-date, as the alt CPU emulation reads & writes them directly)
+static void RebuildMemCache(void)
+{
+	_ASSERT(g_isMemCacheSupported && !g_isMemCacheValid);
+
+	UpdatePaging(TRUE);		// NB. also resets the bank switch counters
+	memset(memdirty, 0, _6502_NUM_PAGES);
+}
+
+// Called at the end of each CpuExecute(), since the CPU emulation can only change between execution batches
+void MemUpdateBankSwitchMode(const ULONG uExecutedCycles)
+{
+	if (!g_isMemCacheSupported || !g_bankSwitchByPointer)
+		return;
+
+	g_bankSwitchWindowCycles += uExecutedCycles;
+	if (g_bankSwitchWindowCycles < kBankSwitchWindowCycles)
+		return;
+
+	const UINT pagesCopied = g_bankSwitchPagesCopied;
+	g_bankSwitchWindowCycles = 0;
+	g_bankSwitchPagesCopied = 0;
+
+	if (g_isMemCacheValid)
+	{
+		if (pagesCopied > kBankSwitchMaxPagesPerWindow)
+		{
+			BackMainImage();
+			g_isMemCacheValid = false;
+			g_bankSwitchQuietWindows = 0;
+			UpdatePaging(FALSE);	// just sets up the alt CPU emulation's page tables
+		}
+	}
+	else
+	{
+		// Hysteresis: need a run of windows well below the limit
+		if (pagesCopied > kBankSwitchMaxPagesPerWindow / 4)
+			g_bankSwitchQuietWindows = 0;
+		else if (++g_bankSwitchQuietWindows >= kBankSwitchQuietWindows)
+			RebuildMemCache();
+	}
+}
+
+void MemSetBankSwitchByPointer(const bool enable)
+{
+	g_bankSwitchByPointer = enable;
+
+	if (!enable && MemIsBankSwitchByPointer())
+		RebuildMemCache();
+}
+
+bool MemIsBankSwitchByPointer(void)
+{
+	return g_isMemCacheSupported && !g_isMemCacheValid;
+}
+
+//-------------------------------------
+
 // Used by:
 // . Savestate: MemSaveSnapshotMemory(), MemLoadSnapshotAux()
 // . VidHD    : SaveSnapshot(), LoadSnapshot()
@@ -2018,11 +2429,7 @@ void MemInitialize()
 	if (GetCardMgr().QueryAux() == CT_RamWorksIII)
 	{
 		// allocate memory for RamWorks III - up to 16MB
-		UINT i = 1;
-		while ((i < g_uMaxExBanks) && (RWpages[i] = ALIGNED_ALLOC(_6502_MEM_LEN)))
-			i++;
-		while (i < kMaxExMemoryBanks)
-			RWpages[i++] = NULL;
+		AllocRamWorksBanks(g_uMaxExBanks);
 	}
 #endif
 
@@ -2547,9 +2954,10 @@ BYTE __stdcall MemSetPaging(WORD programcounter, WORD address, BYTE write, BYTE
 			case 0x73: // Ramworks III set aux page number
 				if ((value < g_uMaxExBanks) && RWpages[value])
 				{
+					LPBYTE oldAux = memaux;
 					g_uActiveBank = value;
 					memaux = RWpages[g_uActiveBank];
-					UpdatePaging(FALSE);	// Initialize=FALSE
+					UpdatePagingForAuxBank(oldAux);
 				}
 				break;
 #endif
@@ -3054,11 +3462,12 @@ static SS_CARDTYPE MemLoadSnapshotAuxCommon(YamlLoadHelper& yamlLoadHelper, cons
 
 		//
 
+		if (numAuxBanks > 1 && !RWpages[numAuxBanks - 1])
+			AllocRamWorksBanks(numAuxBanks);	// every bank is loaded below
+
 		for (UINT bank = 1; bank <= g_uMaxExBanks; bank++)
 		{
 			LPBYTE pBank = MemGetBankPtr(bank, false);
-			if (!pBank)
-				pBank = RWpages[bank - 1] = ALIGNED_ALLOC(_6502_MEM_LEN);
 
 			// "Auxiliary Memory Bankxx"
 			std::string auxMemName = MemGetSnapshotAuxMemStructName() + ByteToHexStr(bank - 1);
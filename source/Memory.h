@@ -45,10 +45,12 @@ extern iofunction IORead[256];
 extern iofunction IOWrite[256];
 extern LPBYTE     memshadow[0x100];
 extern LPBYTE     memwrite[0x100];
+extern LPBYTE     memwriteTrap[0x100];
 extern BYTE       memreadPageType[0x100];
 extern LPBYTE     mem;
 extern LPBYTE     memdirty;
 extern LPBYTE     memVidHD;
+extern bool       g_memWriteTrapHit;
 
 #ifdef RAMWORKS
 const UINT kMaxExMemoryBanks = 256;	// 256 * aux mem(64K) + main mem(64K) = 16MB + 64K
@@ -85,6 +87,7 @@ BYTE    MemReadFloatingBusFromNTSC(void);
 void    MemReset ();
 void    MemResetPaging ();
 void    MemUpdatePaging(BOOL initialize);
+void    MemUpdatePagingLanguageCard(void);
 LPVOID	MemGetSlotParameters (UINT uSlot);
 void	MemAnnunciatorReset(void);
 bool    MemGetAnnunciator(UINT annunciator);
@@ -122,4 +125,23 @@ void WriteByteToMemory(uint16_t addr, uint8_t data);
 void CopyBytesFromMemoryPage(uint8_t* pDst, uint16_t srcAddr, size_t size);
 bool IsZeroPageFloatingBus(void);
 void ForceAltCpuEmulation(void);
+void MemUpdateBankSwitchMode(const ULONG uExecutedCycles);
+void MemSetBankSwitchByPointer(const bool enable);
+bool MemIsBankSwitchByPointer(void);
+
+struct MemWriteTrapHit_t
+{
+	WORD addr;
+	BYTE value;
+	WORD pc;				// NB. PC after the opcode's operand bytes have been fetched
+	unsigned __int64 cycle;
+};
+
+bool MemCanWriteTrap(const WORD addr, const UINT len);
+void MemWriteTrapAdd(const WORD addr, const UINT len);
+void MemWriteTrapClear(void);
+bool MemWriteTrapIsActive(void);
+bool MemWriteTrapGetHit(MemWriteTrapHit_t& hit);
+void MemWriteTrap(const WORD addr, const BYTE value, const ULONG uExecutedCycles);
+LPBYTE MemGetWritePage(const BYTE page);
 uint8_t ReadByteFromROM(uint16_t addr);
@@ -902,6 +902,9 @@ void MockingboardCard::CheckCumulativeCycles(void)
 void MockingboardCard::SetCumulativeCycles(void)
 {
 	m_lastCumulativeCycle = g_nCumulativeCycles;
+
+	for (UINT i = 0; i < NUM_SUBUNITS_PER_MB; i++)
+		m_MBSubUnit[i].sy6522.SetCumulativeCycles();
 }
 
 // Called by ContinueExecution() at the end of every execution period (~1000 cycles or ~3 cycles when MODE_STEPPING)
@@ -917,23 +920,12 @@ void MockingboardCard::Update(const ULONG executedCycles)
 // . CpuExecute() every ~1000 cycles @ 1MHz (or ~3 cycles when MODE_STEPPING)
 // . MB_SyncEventCallback() on a TIMER1/2 underflow
 // . IORead() / IOWrite() (for both normal & full-speed)
+// NB. The 6522 TIMER1/2 counters aren't updated here: SY6522 computes them on demand from g_nCumulativeCycles
 void MockingboardCard::UpdateCycles(ULONG executedCycles)
 {
 	CpuCalcCycles(executedCycles);
-	UINT64 uCycles = g_nCumulativeCycles - m_lastCumulativeCycle;
-	_ASSERT(uCycles >= 0);
-	if (uCycles == 0)
-		return;
-
+	_ASSERT(g_nCumulativeCycles >= m_lastCumulativeCycle);
 	m_lastCumulativeCycle = g_nCumulativeCycles;
-	_ASSERT(uCycles < 0x10000 || g_nAppMode == MODE_BENCHMARK);
-	USHORT nClocks = (USHORT)uCycles;
-
-	for (UINT i = 0; i < NUM_SUBUNITS_PER_MB; i++)
-	{
-		m_MBSubUnit[i].sy6522.UpdateTimer1(nClocks);
-		m_MBSubUnit[i].sy6522.UpdateTimer2(nClocks);
-	}
 }
 
 //-----------------------------------------------------------------------------
@@ -948,9 +940,8 @@ int MockingboardCard::MB_SyncEventCallback(int id, int /*cycles*/, ULONG uExecut
 
 int MockingboardCard::MB_SyncEventCallbackInternal(int id, int /*cycles*/, ULONG uExecutedCycles)
 {
-	//UpdateCycles(uExecutedCycles);	// Underflow: so keep TIMER1/2 counters in sync
 	// Update all MBs, so that m_lastCumulativeCycle remains in sync for all
-	GetCardMgr().GetMockingboardCardMgr().UpdateCycles(uExecutedCycles);	// Underflow: so keep TIMER1/2 counters in sync
+	GetCardMgr().GetMockingboardCardMgr().UpdateCycles(uExecutedCycles);	// Underflow: so TIMER1/2 counters are computed at this cycle
 
 	MB_SUBUNIT* pMB = &m_MBSubUnit[(id & 0xf) / SY6522::kNumTimersPer6522];
 
@@ -54,8 +54,8 @@ void MockingboardCardManager::ReinitializeClock(void)
 {
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).ReinitializeClock();
+		if (m_cards[i])
+			m_cards[i]->ReinitializeClock();
 	}
 }
 
@@ -74,8 +74,8 @@ void MockingboardCardManager::MuteControl(bool mute)
 {
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).MuteControl(mute);
+		if (m_cards[i])
+			m_cards[i]->MuteControl(mute);
 	}
 
 	if (mute)
@@ -100,8 +100,8 @@ void MockingboardCardManager::SetCumulativeCycles(void)
 {
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).SetCumulativeCycles();
+		if (m_cards[i])
+			m_cards[i]->SetCumulativeCycles();
 	}
 }
 
@@ -109,8 +109,8 @@ void MockingboardCardManager::UpdateCycles(ULONG executedCycles)
 {
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).UpdateCycles(executedCycles);
+		if (m_cards[i])
+			m_cards[i]->UpdateCycles(executedCycles);
 	}
 }
 
@@ -120,8 +120,8 @@ void MockingboardCardManager::UpdateIRQ(void)
 	bool irq = false;
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			irq |= dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).Is6522IRQ();
+		if (m_cards[i])
+			irq |= m_cards[i]->Is6522IRQ();
 	}
 
 	if (irq)
@@ -137,8 +137,8 @@ bool MockingboardCardManager::IsActiveToPreventFullSpeed(void)
 
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			if (dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).IsActiveToPreventFullSpeed())
+		if (m_cards[i])
+			if (m_cards[i]->IsActiveToPreventFullSpeed())
 				return true;	// if any card is true then the condition for active is true
 	}
 
@@ -162,8 +162,8 @@ void MockingboardCardManager::SetVolume(uint32_t volume, uint32_t volumeMax)
 
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).SetVolume(volume, volumeMax);
+		if (m_cards[i])
+			m_cards[i]->SetVolume(volume, volumeMax);
 	}
 }
 
@@ -186,8 +186,8 @@ void MockingboardCardManager::CheckCumulativeCycles(void)
 {
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).CheckCumulativeCycles();
+		if (m_cards[i])
+			m_cards[i]->CheckCumulativeCycles();
 	}
 }
 
@@ -195,8 +195,8 @@ void MockingboardCardManager::Get6522IrqDescription(std::string& desc)
 {
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
-			dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).Get6522IrqDescription(desc);
+		if (m_cards[i])
+			m_cards[i]->Get6522IrqDescription(desc);
 	}
 }
 #endif
@@ -222,9 +222,9 @@ void MockingboardCardManager::Update(const ULONG executedCycles)
 	bool present = false;
 	for (UINT i = SLOT0; i < NUM_SLOTS; i++)
 	{
-		if (IsMockingboard(i))
+		if (m_cards[i])
 		{
-			active |= dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(i)).IsAnyTimer1Active();
+			active |= m_cards[i]->IsAnyTimer1Active();
 			present = true;
 		}
 	}
@@ -311,10 +311,10 @@ UINT MockingboardCardManager::GenerateAllSoundData(void)
 
 	for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
 	{
-		if (!IsMockingboard(slot))
+		if (!m_cards[slot])
 			continue;
 
-		MockingboardCard& MB = dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(slot));
+		MockingboardCard& MB = *m_cards[slot];
 
 		MB.SetNumSamplesError(m_numSamplesError);
 		nNumSamples = MB.MB_Update();
@@ -396,8 +396,8 @@ void MockingboardCardManager::MixAllAndCopyToRingBuffer(UINT nNumSamples)
 
 	for (UINT slot = SLOT0; slot < NUM_SLOTS; slot++)
 	{
-		if (IsMockingboard(slot))
-			slotAYVoiceBuffers[slot] = dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(slot)).GetVoiceBuffers();
+		if (m_cards[slot])
+			slotAYVoiceBuffers[slot] = m_cards[slot]->GetVoiceBuffers();
 	}
 
 	for (UINT i = 0; i < nNumSamples; i++)
@@ -15,6 +15,8 @@ public:
 		m_userVolume = 0;
 		m_outputToRiff = false;
 		m_enableExtraCardTypes = false;
+		for (UINT i = SLOT0; i < NUM_SLOTS; i++)
+			m_cards[i] = NULL;
 
 		// NB. Cmd line has already been processed
 		LogFileOutput("MBCardMgr::ctor() g_bDisableDirectSound=%d, g_bDisableDirectSoundMockingboard=%d\n", g_bDisableDirectSound, g_bDisableDirectSoundMockingboard);
@@ -23,6 +25,8 @@ public:
 	{}
 
 	bool IsMockingboard(UINT slot);
+	void InsertCard(UINT slot, MockingboardCard* pCard) { m_cards[slot] = pCard; }
+	void RemoveCard(UINT slot) { m_cards[slot] = NULL; }
 	void ReinitializeClock(void);
 	void InitializeForLoadingSnapshot(void);
 	void MuteControl(bool mute);
@@ -71,4 +75,8 @@ private:
 	uint32_t m_userVolume;	// GUI's slide volume
 	bool m_outputToRiff;
 	bool m_enableExtraCardTypes;
+
+	// Mockingboard card per slot, or NULL (maintained by CardManager)
+	// . avoids QuerySlot() + dynamic_cast for every slot on each 6522 access & execution period
+	MockingboardCard* m_cards[NUM_SLOTS];
 };
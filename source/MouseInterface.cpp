@@ -120,6 +120,33 @@ Etc.
 // [*1] "A mode byte of $08 (mouse off but VBL interrupt on) will generate VBL interrupts."
 // Ref. Apple II Technical Notes - Mouse #3: "Mode Byte of the SetMouse Routine"
 
+// Screen holes (+slot)
+#define SCREENHOLE_X_LO		0x0478
+#define SCREENHOLE_Y_LO		0x04F8
+#define SCREENHOLE_X_HI		0x0578
+#define SCREENHOLE_Y_HI		0x05F8
+#define SCREENHOLE_PAGE		0x0678		// firmware: ROM page of the routine
+#define SCREENHOLE_COMMAND	0x06F8		// firmware: command byte
+#define SCREENHOLE_STATUS	0x0778
+
+// Firmware fast path
+// The entry code (in ROM page 0) saves the command & routine's ROM page in the screen holes, pushes a byte and
+// switches to the routine's ROM page with STA PRB,Y at $Cn78. The routine then continues at $Cn7B in the new page.
+// Instead, this does the routine's work without switching the page, and returns through $Cn88 (CLC : RTS) in page 0.
+#define FW_SWITCH_PAGE		0x78		// STA $C082,Y : PLA : BEQ $Cn88
+#define FW_RETURN_OK		0x88		// CLC : RTS
+#define FW_PAGE_READ		0x0C		// pushes 2
+#define FW_PAGE_POS_CLAMP	0x0E		// pushes 1
+
+static const BYTE g_fwSwitchPage[] = { 0x99, 0x82, 0xC0, 0x68, 0xF0, 0x0A };
+static const BYTE g_fwReturnOk[] = { 0x18, 0x60 };
+
+// High rate input
+static const size_t kMaxInputQueue = 4096;
+static const unsigned __int64 kMaxInputLatency = 2 * 17030;	// cycles: 2 video frames
+
+bool CMouseInterface::ms_bFirmwareFastPathDefault = true;
+
 //===========================================================================
 
 void M6821_Listener_B( void* objTo, BYTE byData )
@@ -137,7 +164,11 @@ void M6821_Listener_A( void* objTo, BYTE byData )
 CMouseInterface::CMouseInterface(UINT slot) :
 	Card(CT_MouseInterface, slot),
 	m_pSlotRom(NULL),
-	m_syncEvent(slot, 0, SyncEventCallback)	// use slot# as "unique" id for MouseInterfaces
+	m_syncEvent(slot, 0, SyncEventCallback),	// use slot# as "unique" id for MouseInterfaces
+	m_inputHostAnchor(0),
+	m_inputCycleAnchor(0),
+	m_bFirmwareFastPath(ms_bFirmwareFastPathDefault),
+	m_bFirmwareFastPathSupported(false)
 {
 	if (m_slot != 4)	// fixme
 		ThrowErrorInvalidSlot();
@@ -173,6 +204,10 @@ void CMouseInterface::InitializeROM(void)
 
 	m_pSlotRom = new BYTE [FW_SIZE];
 	memcpy(m_pSlotRom, pData, FW_SIZE);
+
+	m_bFirmwareFastPathSupported =
+		memcmp(m_pSlotRom + FW_SWITCH_PAGE, g_fwSwitchPage, sizeof(g_fwSwitchPage)) == 0 &&
+		memcmp(m_pSlotRom + FW_RETURN_OK, g_fwReturnOk, sizeof(g_fwReturnOk)) == 0;
 }
 
 void CMouseInterface::InitializeIO(LPBYTE pCxRomPeripheral)
@@ -217,6 +252,8 @@ void CMouseInterface::Reset(const bool /* powerCycle */)
 
 	m_bButtons[0] = m_bButtons[1] = false;
 
+	m_inputQueue.clear();
+
 	//
 
 	Clear();
@@ -262,6 +299,10 @@ BYTE __stdcall CMouseInterface::IOWrite(WORD PC, WORD uAddr, BYTE bWrite, BYTE u
 
 	BYTE byRS;
 	byRS = uAddr & 3;
+
+	if (pMouseIF->m_bFirmwareFastPath && pMouseIF->FirmwareFastPath(PC, byRS, uValue))
+		return 0;
+
 	pMouseIF->m_6821.Write( byRS, uValue );
 
 	return 0;
@@ -339,21 +380,7 @@ void CMouseInterface::OnCommand()
 		break;
 	case MOUSE_READ:				// Read
 		m_nDataLen = 6;
-		m_byState &= STAT_MOVEMENT_SINCE_READMOUSE;
-		m_nX = m_iX;
-		m_nY = m_iY;
-		if ( m_bBtn0 )	m_byState |= STAT_PREV_BUTTON0;	// Previous Button 0
-		if ( m_bBtn1 )	m_byState |= STAT_PREV_BUTTON1;	// Previous Button 1
-		m_bBtn0 = m_bButtons[0];
-		m_bBtn1 = m_bButtons[1];
-		if ( m_bBtn0 )	m_byState |= STAT_CURR_BUTTON0;	// Current Button 0
-		if ( m_bBtn1 )	m_byState |= STAT_CURR_BUTTON1;	// Current Button 1
-		m_byBuff[1] = m_nX & 0xFF;
-		m_byBuff[2] = ( m_nX >> 8 ) & 0xFF;
-		m_byBuff[3] = m_nY & 0xFF;
-		m_byBuff[4] = ( m_nY >> 8 ) & 0xFF;
-		m_byBuff[5] = m_byState;					// button 0/1 interrupt status
-		m_byState &= ~STAT_MOVEMENT_SINCE_READMOUSE;
+		ReadMouse();
 #ifdef _DEBUG_SPURIOUS_IRQ
 		LogOutput("[MOUSE_READ] Old=%02X New=%02X\n", byOldState, m_byState);
 #endif
@@ -417,6 +444,25 @@ void CMouseInterface::OnCommand()
 	m_6821.SetPA( m_byBuff[1] );
 }
 
+void CMouseInterface::ReadMouse()
+{
+	m_byState &= STAT_MOVEMENT_SINCE_READMOUSE;
+	m_nX = m_iX;
+	m_nY = m_iY;
+	if ( m_bBtn0 )	m_byState |= STAT_PREV_BUTTON0;	// Previous Button 0
+	if ( m_bBtn1 )	m_byState |= STAT_PREV_BUTTON1;	// Previous Button 1
+	m_bBtn0 = m_bButtons[0];
+	m_bBtn1 = m_bButtons[1];
+	if ( m_bBtn0 )	m_byState |= STAT_CURR_BUTTON0;	// Current Button 0
+	if ( m_bBtn1 )	m_byState |= STAT_CURR_BUTTON1;	// Current Button 1
+	m_byBuff[1] = m_nX & 0xFF;
+	m_byBuff[2] = ( m_nX >> 8 ) & 0xFF;
+	m_byBuff[3] = m_nY & 0xFF;
+	m_byBuff[4] = ( m_nY >> 8 ) & 0xFF;
+	m_byBuff[5] = m_byState;					// button 0/1 interrupt status
+	m_byState &= ~STAT_MOVEMENT_SINCE_READMOUSE;
+}
+
 void CMouseInterface::OnWrite()
 {
 	int nMin, nMax;
@@ -483,9 +529,15 @@ void CMouseInterface::OnMouseEvent(bool bEventVBL)
 	}
 }
 
-int CMouseInterface::SyncEventCallback(int id, int cycles, ULONG /*uExecutedCycles*/)
+int CMouseInterface::SyncEventCallback(int id, int cycles, ULONG uExecutedCycles)
 {
-	GetCardMgr().GetMouseCard()->OnMouseEvent(true);
+	CMouseInterface* pMouseIF = GetCardMgr().GetMouseCard();
+	if (!pMouseIF->m_inputQueue.empty())
+	{
+		CpuCalcCycles(uExecutedCycles);
+		pMouseIF->DeliverQueuedInput();
+	}
+	pMouseIF->OnMouseEvent(true);
 	return NTSC_GetCyclesUntilVBlank(cycles);
 }
 
@@ -601,6 +653,138 @@ void CMouseInterface::SetButton(eBUTTON Button, eBUTTONSTATE State)
 	OnMouseEvent();
 }
 
+//===========================================================================
+
+void CMouseInterface::QueuePositionRel(long dX, long dY, double hostTime)
+{
+	InputEvent event = { 0, dX, dY, -1, false };
+	QueueInput(event, hostTime);
+}
+
+void CMouseInterface::QueueButton(eBUTTON Button, eBUTTONSTATE State, double hostTime)
+{
+	InputEvent event = { 0, 0, 0, Button, State == BUTTON_DOWN };
+	QueueInput(event, hostTime);
+}
+
+// Keep the host's timing between events, from an anchor (host time, cycle).
+// The anchor is reset when the queue is empty and an event would be late or too far ahead (the clocks drift apart).
+void CMouseInterface::QueueInput(InputEvent& event, double hostTime)
+{
+	const unsigned __int64 now = g_nCumulativeCycles;
+
+	const double cycle = m_inputCycleAnchor + (hostTime - m_inputHostAnchor) * g_fCurrentCLK6502;
+	if (m_inputQueue.empty() && (cycle < (double)now || cycle > (double)(now + kMaxInputLatency)))
+	{
+		m_inputHostAnchor = hostTime;
+		m_inputCycleAnchor = now;
+		event.cycle = now;
+	}
+	else
+	{
+		event.cycle = (unsigned __int64) std::max(cycle, (double)now);
+		event.cycle = std::min(event.cycle, now + kMaxInputLatency);
+		if (!m_inputQueue.empty())
+			event.cycle = std::max(event.cycle, m_inputQueue.back().cycle);
+	}
+
+	if (m_inputQueue.size() >= kMaxInputQueue)
+	{
+		// Merge into the last move
+		InputEvent& last = m_inputQueue.back();
+		if (event.button < 0 && last.button < 0)
+		{
+			last.dX += event.dX;
+			last.dY += event.dY;
+			return;
+		}
+	}
+
+	m_inputQueue.push_back(event);
+}
+
+// At VBL: apply what's due. Stop after a button change, so that the guest sees it where it happened.
+void CMouseInterface::DeliverQueuedInput(void)
+{
+	const unsigned __int64 now = g_nCumulativeCycles;
+
+	while (!m_inputQueue.empty() && m_inputQueue.front().cycle <= now)
+	{
+		const InputEvent event = m_inputQueue.front();
+		m_inputQueue.pop_front();
+
+		if (event.button < 0)
+		{
+			m_iX += event.dX;
+			ClampX();
+			m_iY += event.dY;
+			ClampY();
+		}
+		else
+		{
+			m_bButtons[event.button] = event.down;
+			break;
+		}
+	}
+}
+
+//===========================================================================
+
+bool CMouseInterface::FirmwareFastPath(WORD PC, BYTE byRS, BYTE byData)
+{
+	const WORD slotRom = (WORD)((0xC0 + m_slot) << 8);
+	if (!m_bFirmwareFastPathSupported || PC != slotRom + FW_SWITCH_PAGE + 3 || byRS != 2)
+		return false;
+
+	// In page 0, writing to PRB (not DDRB)
+	mc6821_t mc6821;
+	BYTE byIA, byIB;
+	m_6821.Get6821(mc6821, byIA, byIB);
+	if ((m_by6821B & 0x0E) != 0 || !(mc6821.crb & BIT2))
+		return false;
+
+	const WORD stack = _6502_STACK_BEGIN | (BYTE)(regs.sp + 1);
+	const BYTE pushed = ReadByteFromMemory(stack);
+	const BYTE page = byData & 0x0E;
+	const BYTE command = ReadByteFromMemory(SCREENHOLE_COMMAND + m_slot);
+
+	if (page == FW_PAGE_READ && pushed == 2)		// READMOUSE
+	{
+		ReadMouse();
+		WriteByteToMemory(SCREENHOLE_X_LO + m_slot, m_byBuff[1]);
+		WriteByteToMemory(SCREENHOLE_X_HI + m_slot, m_byBuff[2]);
+		WriteByteToMemory(SCREENHOLE_Y_LO + m_slot, m_byBuff[3]);
+		WriteByteToMemory(SCREENHOLE_Y_HI + m_slot, m_byBuff[4]);
+		WriteByteToMemory(SCREENHOLE_STATUS + m_slot, m_byBuff[5]);
+	}
+	else if (page == FW_PAGE_POS_CLAMP && pushed == 1 && command == MOUSE_POS)		// POSMOUSE
+	{
+		m_nX = (ReadByteFromMemory(SCREENHOLE_X_HI + m_slot) << 8) | ReadByteFromMemory(SCREENHOLE_X_LO + m_slot);
+		m_nY = (ReadByteFromMemory(SCREENHOLE_Y_HI + m_slot) << 8) | ReadByteFromMemory(SCREENHOLE_Y_LO + m_slot);
+		SetPositionAbs(m_nX, m_nY);
+	}
+	else if (page == FW_PAGE_POS_CLAMP && pushed == 1 && (command & 0xF0) == MOUSE_CLAMP)	// CLAMPMOUSE: not slot specific
+	{
+		const int nMin = (ReadByteFromMemory(SCREENHOLE_X_HI) << 8) | ReadByteFromMemory(SCREENHOLE_X_LO);
+		const int nMax = (ReadByteFromMemory(SCREENHOLE_Y_HI) << 8) | ReadByteFromMemory(SCREENHOLE_Y_LO);
+		if (command & 1)	// Clamp Y
+			SetClampY(nMin, nMax);
+		else				// Clamp X
+			SetClampX(nMin, nMax);
+	}
+	else
+	{
+		return false;
+	}
+
+	// As the firmware's exit: screen holes cleared, and staying in page 0 where the pushed byte, now 0, is pulled
+	// by PLA : BEQ $Cn88 (CLC : RTS). So the registers are left as by the firmware (A=0, Z=1, C=0).
+	WriteByteToMemory(SCREENHOLE_PAGE + m_slot, 0);
+	WriteByteToMemory(SCREENHOLE_COMMAND + m_slot, 0);
+	WriteByteToMemory(stack, 0);
+	return true;
+}
+
 #define SS_YAML_VALUE_CARD_MOUSE "Mouse Card"
 
 #define SS_YAML_KEY_MC6821 "MC6821"
@@ -5,6 +5,8 @@
 #include "Card.h"
 #include "SynchronousEventManager.h"
 
+#include <deque>
+
 class CMouseInterface : public Card
 {
 public:
@@ -23,6 +25,18 @@ public:
 
 	void SetPositionRel(long dx, long dy, int* pOutOfBoundsX, int* pOutOfBoundsY);
 	void SetButton(eBUTTON Button, eBUTTONSTATE State);
+
+	// High rate host input: moves & buttons are queued with their host time (in seconds, any origin)
+	// and delivered at the emulated VBL matching that time, rather than all at the next VBL
+	void QueuePositionRel(long dX, long dY, double hostTime);
+	void QueueButton(eBUTTON Button, eBUTTONSTATE State, double hostTime);
+	size_t GetQueuedInputSize(void) { return m_inputQueue.size(); }
+
+	// READMOUSE, POSMOUSE & CLAMPMOUSE without the firmware's byte by byte PIA handshake
+	// . the default is for the cards created later (eg. on a VM restart)
+	void SetFirmwareFastPath(bool bEnabled) { m_bFirmwareFastPath = bEnabled; }
+	bool GetFirmwareFastPath(void) { return m_bFirmwareFastPath; }
+	static void SetFirmwareFastPathDefault(bool bEnabled) { ms_bFirmwareFastPathDefault = bEnabled; }
 //	bool IsActive() { return m_bActive; }
 	bool IsEnabled() { return m_bEnabled; }	// NB. m_bEnabled == true implies that m_bActive == true
 	bool IsActiveAndEnabled() { return /*IsActive() &&*/ IsEnabled(); }	// todo: just use IsEnabled()
@@ -55,6 +69,21 @@ protected:
 	void OnWrite();
 	void OnMouseEvent(bool bEventVBL=false);
 	void Clear();
+	void ReadMouse();
+
+	struct InputEvent
+	{
+		unsigned __int64 cycle;
+		long dX;
+		long dY;
+		int button;		// -1 for a move
+		bool down;
+	};
+
+	void QueueInput(InputEvent& event, double hostTime);
+	void DeliverQueuedInput(void);
+
+	bool FirmwareFastPath(WORD PC, BYTE byRS, BYTE byData);
 
 	friend void M6821_Listener_A( void* objTo, BYTE byData );
 	friend void M6821_Listener_B( void* objTo, BYTE byData );
@@ -108,4 +137,13 @@ protected:
 	LPBYTE	m_pSlotRom;
 
 	SyncEvent m_syncEvent;
+
+	std::deque<InputEvent> m_inputQueue;
+	double	m_inputHostAnchor;		// host time of...
+	unsigned __int64 m_inputCycleAnchor;	// ...this emulated cycle
+
+	bool	m_bFirmwareFastPath;
+	bool	m_bFirmwareFastPathSupported;	// the firmware's entry code is as expected
+
+	static bool ms_bFirmwareFastPathDefault;
 };
@@ -26,11 +26,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	#include "CPU.h"	// CpuGetCyclesThisVideoFrame()
 	#include "Memory.h" // MemGetMainPtr(), MemGetAuxPtr(), MemGetAnnunciator()
 	#include "Interface.h"  // GetFrameBuffer()
+	#include "Log.h"
 	#include "RGBMonitor.h"
+	#include "StrFormat.h"
 	#include "VidHD.h"
 
 	#include "NTSC_CharSet.h"
 
+#ifndef _WIN32
+	#include <unistd.h>	// getpid()
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
 // Some reference material here from 2000:
 // http://www.kreativekorp.com/miscpages/a2info/munafo.shtml
 //
@@ -138,10 +147,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	#define NTSC_NUM_SEQUENCES  4096
 
 /*extern*/ uint32_t g_nChromaSize = 0; // for NTSC_VideoGetChromaTable()
-	static bgra_t   g_aBnWMonitor                 [NTSC_NUM_SEQUENCES];
-	static bgra_t   g_aHueMonitor[NTSC_NUM_PHASES][NTSC_NUM_SEQUENCES];
-	static bgra_t   g_aBnwColorTV                 [NTSC_NUM_SEQUENCES];
-	static bgra_t   g_aHueColorTV[NTSC_NUM_PHASES][NTSC_NUM_SEQUENCES];
+	struct ChromaTables_t
+	{
+		bgra_t BnWMonitor                 [NTSC_NUM_SEQUENCES];
+		bgra_t HueMonitor[NTSC_NUM_PHASES][NTSC_NUM_SEQUENCES];
+		bgra_t BnwColorTV                 [NTSC_NUM_SEQUENCES];
+		bgra_t HueColorTV[NTSC_NUM_PHASES][NTSC_NUM_SEQUENCES];
+	};
+	static ChromaTables_t g_chromaTablesCache;	// generated (see initChromaPhaseTablesUncached())
+
+	// The live tables point into the chroma tables (see initChromaPhaseTables()), rather than being a copy
+	static const bgra_t   *g_aBnWMonitor                   = g_chromaTablesCache.BnWMonitor;
+	static const bgra_t  (*g_aHueMonitor)[NTSC_NUM_SEQUENCES] = g_chromaTablesCache.HueMonitor;
+	static const bgra_t   *g_aBnwColorTV                   = g_chromaTablesCache.BnwColorTV;
+	static const bgra_t  (*g_aHueColorTV)[NTSC_NUM_SEQUENCES] = g_chromaTablesCache.HueColorTV;
 
 	// g_aBnWMonitor * g_nMonochromeRGB -> g_aBnWMonitorCustom
 	// g_aBnwColorTV * g_nMonochromeRGB -> g_aBnWColorTVCustom
@@ -312,15 +331,16 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static csbits_t csbits;		// charset, optionally followed by alt charset
 
 // Prototypes
-	INLINE void      updateFramebufferTVSingleScanline( uint16_t signal, bgra_t *pTable );
-	INLINE void      updateFramebufferTVDoubleScanline( uint16_t signal, bgra_t *pTable );
-	INLINE void      updateFramebufferMonitorSingleScanline( uint16_t signal, bgra_t *pTable );
-	INLINE void      updateFramebufferMonitorDoubleScanline( uint16_t signal, bgra_t *pTable );
+	INLINE void      updateFramebufferTVSingleScanline( uint16_t signal, const bgra_t *pTable );
+	INLINE void      updateFramebufferTVDoubleScanline( uint16_t signal, const bgra_t *pTable );
+	INLINE void      updateFramebufferMonitorSingleScanline( uint16_t signal, const bgra_t *pTable );
+	INLINE void      updateFramebufferMonitorDoubleScanline( uint16_t signal, const bgra_t *pTable );
 	INLINE void      updatePixels( uint16_t bits );
 	INLINE void      updateVideoScannerHorzEOL();
 	INLINE void      updateVideoScannerAddress();
 
-	static void initChromaPhaseTables();
+	static void initChromaPhaseTables(UINT uTables);
+	static void initFilterReset    (void);
 	static real initFilterChroma   (real z);
 	static real initFilterLuma0    (real z);
 	static real initFilterLuma1    (real z);
@@ -508,7 +528,7 @@ inline void updateFlashRate() // TODO: Flash rate should be constant (regardless
 
 // Original: Prev1(inbetween) = current - 25% of previous AppleII scanline
 // GH#650:   Prev1(inbetween) = 50% of (50% current + 50% of previous AppleII scanline)
-inline void updateFramebufferTVSingleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferTVSingleScanline( uint16_t signal, const bgra_t *pTable )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Prev = getScanlinePreviousInbetween();
@@ -531,7 +551,7 @@ inline void updateFramebufferTVSingleScanline( uint16_t signal, bgra_t *pTable )
 //===========================================================================
 
 // Original: Prev1(inbetween) = 50% current + 50% of previous AppleII scanline
-inline void updateFramebufferTVDoubleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferTVDoubleScanline( uint16_t signal, const bgra_t *pTable )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Prev = getScanlinePreviousInbetween();
@@ -551,7 +571,7 @@ inline void updateFramebufferTVDoubleScanline( uint16_t signal, bgra_t *pTable )
 }
 
 //===========================================================================
-inline void updateFramebufferMonitorSingleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferMonitorSingleScanline( uint16_t signal, const bgra_t *pTable )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Next = getScanlineNextInbetween();
@@ -565,7 +585,7 @@ inline void updateFramebufferMonitorSingleScanline( uint16_t signal, bgra_t *pTa
 }
 
 //===========================================================================
-inline void updateFramebufferMonitorDoubleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferMonitorDoubleScanline( uint16_t signal, const bgra_t *pTable )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Next = getScanlineNextInbetween();
@@ -913,17 +933,122 @@ INLINE uint16_t getVideoScannerAddressSHR()
 
 // Non-Inline _________________________________________________________
 
+// Chroma tables, generated into g_chromaTablesCache (or mmap'ed from the on-disk cache) then pointed to by g_aBnWMonitor etc.
+// . generated in 2 groups, so only those used by the current video type are generated:
+//   - monitor: the color & monochrome monitor video types
+//   - TV: the color & B&W TV video types, and GenerateBaseColors()
+// . they only depend on constants, so keeping the generated copy means:
+//   - a restart (eg. after a config change) just points back to them
+//   - which also undoes any debugger palette load (see CmdNTSC()), as the debugger gets a private copy
+//   - they can be cached on disk (see NTSC_SetChromaTableCache()), and the file is mmap'ed read-only:
+//     so with many instances on a host, the pages are shared
+#define CHROMA_TABLES_MONITOR	1
+#define CHROMA_TABLES_TV		2
+#define CHROMA_TABLES_ALL		(CHROMA_TABLES_MONITOR | CHROMA_TABLES_TV)
+
+static const ChromaTables_t* g_pChromaTables = &g_chromaTablesCache;	// or the mmap'ed on-disk cache
+static ChromaTables_t* g_pChromaTablesDebugger = NULL;	// private copy, as the debugger can change the tables
+static UINT g_uChromaTablesCached = 0;	// CHROMA_TABLES_xxx in g_pChromaTables
+static UINT g_uChromaTablesLive = 0;	// CHROMA_TABLES_xxx pointed to by g_aBnWMonitor etc.
+static size_t g_uChromaTablesMappedSize = 0;	// size of the mmap'ed on-disk cache
+static std::string g_strChromaTableCache;	// on-disk cache, or empty
+
+// YI'Q' to RGB
+//===========================================================================
+static bgra_t initChromaColor (real y, real i, real q, int color, bool bRemoveGrayChroma)
+{
+	double r64,g64,b64;
+	float  r32,g32,b32;
+
+	/*
+		YI'V' to RGB
+
+		[r g b] = [y i v][ 1      1      1    ]
+		                 [0.956  -0.272 -1.105]
+		                 [0.621  -0.647  1.702]
+
+		[r]   [1   0.956  0.621][y]    
+		[g] = [1  -0.272 -0.647][i]
+		[b]   [1  -1.105  1.702][v]
+	*/
+	#define I_TO_R  0.956f
+	#define I_TO_G -0.272f
+	#define I_TO_B -1.105f
+
+	#define Q_TO_R  0.621f
+	#define Q_TO_G -0.647f
+	#define Q_TO_B  1.702f
+
+	r64 = y + (I_TO_R * i) + (Q_TO_R * q);
+	g64 = y + (I_TO_G * i) + (Q_TO_G * q);
+	b64 = y + (I_TO_B * i) + (Q_TO_B * q);
+
+	b32 = clampZeroOne( (float)b64);
+	g32 = clampZeroOne( (float)g64);
+	r32 = clampZeroOne( (float)r64);
+
+#if NTSC_REMOVE_WHITE_RINGING
+	if( color == 15 ) // white
+	{
+		r32 = 1;
+		g32 = 1;
+		b32 = 1;
+	}
+#endif			
+
+#if NTSC_REMOVE_BLACK_GHOSTING
+	if( color == 0 ) // Black
+	{
+		r32 = 0;
+		g32 = 0;
+		b32 = 0;
+	}
+#endif
+
+#if NTSC_REMOVE_GRAY_CHROMA
+	if (bRemoveGrayChroma)
+	{
+		if( color == 5 ) // Gray1 & Gray2
+		{
+			const float g = (float) 0x83 / (float) 0xFF;
+			r32 = g;
+			g32 = g;
+			b32 = g;
+		}
+
+		if( color == 10 ) // Gray2 & Gray1
+		{
+			const float g = (float) 0x78 / (float) 0xFF;
+			r32 = g;
+			g32 = g;
+			b32 = g;
+		}
+	}
+#endif
+
+	bgra_t pixel;
+	pixel.b = (uint8_t)(b32 * 255);
+	pixel.g = (uint8_t)(g32 * 255);
+	pixel.r = (uint8_t)(r32 * 255);
+	pixel.a = 255;
+	return pixel;
+}
+
 // Build the 4 phase chroma lookup table
 // The YI'Q' colors are hard-coded
 //===========================================================================
-static void initChromaPhaseTables (void)
+static void initChromaPhaseTablesUncached (UINT uTables)
 {
+	const bool bMonitor = (uTables & CHROMA_TABLES_MONITOR) != 0;
+	const bool bTV      = (uTables & CHROMA_TABLES_TV) != 0;
+
 	int phase,s,t,n;
 	real z,y0,y1,c,i,q;
 	real phi,zz;
 	float brightness;
-	double r64,g64,b64;
-	float  r32,g32,b32;	
+
+	// Each group only runs its own luma filter, so start from rest to get the same tables whichever groups are generated
+	initFilterReset();
 
 	for (phase = 0; phase < 4; ++phase)
 	{
@@ -943,8 +1068,10 @@ static void initChromaPhaseTables (void)
 					//z = z * 1.25;
 					zz = initFilterSignal(z);
 					c  = initFilterChroma(zz); // "Mostly" correct _if_ CYCLESTART = PI/4 = 45 degrees
-					y0 = initFilterLuma0 (zz);
-					y1 = initFilterLuma1 (zz - c);
+					if (bMonitor)
+						y0 = initFilterLuma0 (zz);
+					if (bTV)
+						y1 = initFilterLuma1 (zz - c);
 
 					c = c * 2.f;
 					i = i + (c * cos(phi) - i) / 8.f;
@@ -954,129 +1081,44 @@ static void initChromaPhaseTables (void)
 				} // k
 			} // samples
 
-			brightness = clampZeroOne( (float)z );
-			g_aBnWMonitor[s].b = (uint8_t)(brightness * 255);
-			g_aBnWMonitor[s].g = (uint8_t)(brightness * 255);
-			g_aBnWMonitor[s].r = (uint8_t)(brightness * 255);
-			g_aBnWMonitor[s].a = 255;
-
-			brightness = clampZeroOne( (float)y1);
-			g_aBnwColorTV[s].b = (uint8_t)(brightness * 255);
-			g_aBnwColorTV[s].g = (uint8_t)(brightness * 255);
-			g_aBnwColorTV[s].r = (uint8_t)(brightness * 255);
-			g_aBnwColorTV[s].a = 255;
-			
-			/*
-				YI'V' to RGB
-
-				[r g b] = [y i v][ 1      1      1    ]
-				                 [0.956  -0.272 -1.105]
-				                 [0.621  -0.647  1.702]
-
-				[r]   [1   0.956  0.621][y]    
-				[g] = [1  -0.272 -0.647][i]
-				[b]   [1  -1.105  1.702][v]
-			*/
-			#define I_TO_R  0.956f
-			#define I_TO_G -0.272f
-			#define I_TO_B -1.105f
-
-			#define Q_TO_R  0.621f
-			#define Q_TO_G -0.647f
-			#define Q_TO_B  1.702f
-
-			r64 = y0 + (I_TO_R * i) + (Q_TO_R * q);
-			g64 = y0 + (I_TO_G * i) + (Q_TO_G * q);
-			b64 = y0 + (I_TO_B * i) + (Q_TO_B * q);
-
-			b32 = clampZeroOne( (float)b64);
-			g32 = clampZeroOne( (float)g64);
-			r32 = clampZeroOne( (float)r64);
-
-			int color = s & 15;
-
-#if NTSC_REMOVE_WHITE_RINGING
-			if( color == 15 ) // white
-			{
-				r32 = 1;
-				g32 = 1;
-				b32 = 1;
-			}
-#endif			
-
-#if NTSC_REMOVE_BLACK_GHOSTING
-			if( color == 0 ) // Black
-			{
-				r32 = 0;
-				g32 = 0;
-				b32 = 0;
-			}
-#endif
+			const int color = s & 15;
 
-#if NTSC_REMOVE_GRAY_CHROMA
-			if( color == 5 ) // Gray1 & Gray2
+			if (bMonitor)
 			{
-				const float g = (float) 0x83 / (float) 0xFF;
-				r32 = g;
-				g32 = g;
-				b32 = g;
-			}
+				brightness = clampZeroOne( (float)z );
+				g_chromaTablesCache.BnWMonitor[s].b = (uint8_t)(brightness * 255);
+				g_chromaTablesCache.BnWMonitor[s].g = (uint8_t)(brightness * 255);
+				g_chromaTablesCache.BnWMonitor[s].r = (uint8_t)(brightness * 255);
+				g_chromaTablesCache.BnWMonitor[s].a = 255;
 
-			if( color == 10 ) // Gray2 & Gray1
-			{
-				const float g = (float) 0x78 / (float) 0xFF;
-				r32 = g;
-				g32 = g;
-				b32 = g;
+				g_chromaTablesCache.HueMonitor[phase][s] = initChromaColor(y0, i, q, color, true);
 			}
-#endif
 
-			g_aHueMonitor[phase][s].b = (uint8_t)(b32 * 255);
-			g_aHueMonitor[phase][s].g = (uint8_t)(g32 * 255);
-			g_aHueMonitor[phase][s].r = (uint8_t)(r32 * 255);
-			g_aHueMonitor[phase][s].a = 255;
-
-			r64 = y1 + (I_TO_R * i) + (Q_TO_R * q);
-			g64 = y1 + (I_TO_G * i) + (Q_TO_G * q);
-			b64 = y1 + (I_TO_B * i) + (Q_TO_B * q);
-
-			b32 = clampZeroOne( (float)b64 );
-			g32 = clampZeroOne( (float)g64 );
-			r32 = clampZeroOne( (float)r64 );
-
-#if NTSC_REMOVE_WHITE_RINGING
-			if( color == 15 ) // white
+			if (bTV)
 			{
-				r32 = 1;
-				g32 = 1;
-				b32 = 1;
-			}
-#endif			
+				brightness = clampZeroOne( (float)y1);
+				g_chromaTablesCache.BnwColorTV[s].b = (uint8_t)(brightness * 255);
+				g_chromaTablesCache.BnwColorTV[s].g = (uint8_t)(brightness * 255);
+				g_chromaTablesCache.BnwColorTV[s].r = (uint8_t)(brightness * 255);
+				g_chromaTablesCache.BnwColorTV[s].a = 255;
 
-#if NTSC_REMOVE_BLACK_GHOSTING
-			if( color == 0 ) // Black
-			{
-				r32 = 0;
-				g32 = 0;
-				b32 = 0;
+				g_chromaTablesCache.HueColorTV[phase][s] = initChromaColor(y1, i, q, color, false);
 			}
-#endif
-
-			g_aHueColorTV[phase][s].b = (uint8_t)(b32 * 255);
-			g_aHueColorTV[phase][s].g = (uint8_t)(g32 * 255);
-			g_aHueColorTV[phase][s].r = (uint8_t)(r32 * 255);
-			g_aHueColorTV[phase][s].a = 255;
 		}
 	}
 
 #if DEBUG_PHASE_ZERO
-	uint8_t *p = (uint8_t*)g_aHueMonitor;
-	*p++ = 0xFF;
-	*p++ = 0x00;
-	*p++ = 0x00;
-	*p++ = 0xFF;
+	if (bMonitor)
+	{
+		uint8_t *p = (uint8_t*)g_chromaTablesCache.HueMonitor;
+		*p++ = 0xFF;
+		*p++ = 0x00;
+		*p++ = 0x00;
+		*p++ = 0xFF;
+	}
 #endif
 
+	g_uChromaTablesCached |= uTables;
 }
 
 /*
@@ -1105,13 +1147,30 @@ double ButterworthLowPass2( double a, double b, double g, double z )
 
 */
 
+// Filter state: the filters run across all the sequences & phases of a table
+struct FilterState_t
+{
+	real x[2 + 1];	// ZEROS + 1
+	real y[2 + 1];	// POLES + 1
+};
+static FilterState_t g_filterChroma, g_filterLuma0, g_filterLuma1, g_filterSignal;
+
+//===========================================================================
+static void initFilterReset (void)
+{
+	memset(&g_filterChroma, 0, sizeof(g_filterChroma));
+	memset(&g_filterLuma0,  0, sizeof(g_filterLuma0));
+	memset(&g_filterLuma1,  0, sizeof(g_filterLuma1));
+	memset(&g_filterSignal, 0, sizeof(g_filterSignal));
+}
+
 // What filter is this ??
 // Filter Order: 2 -> poles for low pass
 //===========================================================================
 static real initFilterChroma (real z)
 {
-	static real x[CHROMA_ZEROS + 1] = {0,0,0};
-	static real y[CHROMA_POLES + 1] = {0,0,0};
+	real* x = g_filterChroma.x;
+	real* y = g_filterChroma.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / CHROMA_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = -x[0] + x[2] + (CHROMA_0*y[0]) + (CHROMA_1*y[1]); // inverted x[0]
@@ -1124,8 +1183,8 @@ static real initFilterChroma (real z)
 //===========================================================================
 static real initFilterLuma0 (real z)
 {
-	static real x[LUMA_ZEROS + 1] = { 0,0,0 };
-	static real y[LUMA_POLES + 1] = { 0,0,0 };
+	real* x = g_filterLuma0.x;
+	real* y = g_filterLuma0.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / LUMA_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = x[0] + x[2] + (2.f*x[1]) + (LUMA_0*y[0]) + (LUMA_1*y[1]);
@@ -1138,8 +1197,8 @@ static real initFilterLuma0 (real z)
 //===========================================================================
 static real initFilterLuma1 (real z)
 {
-	static real x[LUMA_ZEROS + 1] = { 0,0,0};
-	static real y[LUMA_POLES + 1] = { 0,0,0};
+	real* x = g_filterLuma1.x;
+	real* y = g_filterLuma1.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / LUMA_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = x[0] + x[2] + (2.f*x[1]) + (LUMA_0*y[0]) + (LUMA_1*y[1]);
@@ -1152,8 +1211,8 @@ static real initFilterLuma1 (real z)
 //===========================================================================
 static real initFilterSignal (real z)
 {
-	static real x[SIGNAL_ZEROS + 1] = { 0,0,0 };
-	static real y[SIGNAL_POLES + 1] = { 0,0,0 };
+	real* x = g_filterSignal.x;
+	real* y = g_filterSignal.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / SIGNAL_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = x[0] + x[2] + (2.f*x[1]) + (SIGNAL_0*y[0]) + (SIGNAL_1*y[1]);
@@ -1161,6 +1220,184 @@ static real initFilterSignal (real z)
 	return y[2];
 }
 
+// On-disk cache of g_chromaTablesCache (all groups), for a faster cold start:
+// . a header then the raw tables, so the file is the same on every run (and can be mmap'ed)
+#define CHROMA_TABLE_CACHE_VERSION 1	// NB. Bump if initChromaPhaseTablesUncached() changes
+
+struct ChromaTableCacheHeader_t
+{
+	char     magic[8];	// "AWCHROMA"
+	uint32_t version;	// CHROMA_TABLE_CACHE_VERSION
+	uint32_t size;		// sizeof(ChromaTables_t)
+	uint32_t flags;		// NTSC_REMOVE_xxx
+	uint32_t reserved;
+};
+
+static ChromaTableCacheHeader_t getChromaTableCacheHeader (void)
+{
+	ChromaTableCacheHeader_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "AWCHROMA", sizeof(header.magic));
+	header.version = CHROMA_TABLE_CACHE_VERSION;
+	header.size = sizeof(ChromaTables_t);
+	header.flags = (NTSC_REMOVE_WHITE_RINGING << 0) | (NTSC_REMOVE_BLACK_GHOSTING << 1) | (NTSC_REMOVE_GRAY_CHROMA << 2) | (DEBUG_PHASE_ZERO << 3);
+	return header;
+}
+
+//===========================================================================
+static bool loadChromaTableCache (void)
+{
+	const ChromaTableCacheHeader_t expected = getChromaTableCacheHeader();
+
+#ifndef _WIN32
+	// Map the file read-only rather than copy it: the pages are shared by all the instances using the same cache
+	const int fd = open(g_strChromaTableCache.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	const size_t size = sizeof(ChromaTableCacheHeader_t) + sizeof(ChromaTables_t);
+	struct stat st;
+	void* pMapped = (fstat(fd, &st) == 0 && (size_t)st.st_size == size)
+		? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0)
+		: MAP_FAILED;
+	close(fd);
+
+	if (pMapped != MAP_FAILED && memcmp(pMapped, &expected, sizeof(expected)) != 0)
+	{
+		munmap(pMapped, size);
+		pMapped = MAP_FAILED;
+	}
+
+	if (pMapped == MAP_FAILED)
+	{
+		LogFileOutput("NTSC: ignoring out-of-date chroma table cache: %s\n", g_strChromaTableCache.c_str());
+		return false;
+	}
+
+	g_pChromaTables = (const ChromaTables_t*)((const BYTE*)pMapped + sizeof(ChromaTableCacheHeader_t));
+	g_uChromaTablesMappedSize = size;
+	g_uChromaTablesCached = CHROMA_TABLES_ALL;
+	return true;
+#else
+	FILE* fp = fopen(g_strChromaTableCache.c_str(), "rb");
+	if (!fp)
+		return false;
+
+	ChromaTableCacheHeader_t header;
+	std::vector<BYTE> tables(sizeof(ChromaTables_t));
+
+	const bool bRes = fread(&header, sizeof(header), 1, fp) == 1
+		&& memcmp(&header, &expected, sizeof(header)) == 0
+		&& fread(&tables[0], tables.size(), 1, fp) == 1;
+	fclose(fp);
+
+	if (!bRes)
+	{
+		LogFileOutput("NTSC: ignoring out-of-date chroma table cache: %s\n", g_strChromaTableCache.c_str());
+		return false;
+	}
+
+	memcpy(&g_chromaTablesCache, &tables[0], sizeof(g_chromaTablesCache));
+	g_uChromaTablesCached = CHROMA_TABLES_ALL;
+	return true;
+#endif
+}
+
+//===========================================================================
+static void saveChromaTableCache (void)
+{
+	// Write to a temp file then rename, so that concurrent instances never see a partial file
+#ifdef _WIN32
+	const unsigned long pid = GetCurrentProcessId();
+#else
+	const unsigned long pid = getpid();
+#endif
+	const std::string strTemp = g_strChromaTableCache + StrFormat(".%lu.tmp", pid);
+	FILE* fp = fopen(strTemp.c_str(), "wb");
+	if (!fp)
+	{
+		LogFileOutput("NTSC: failed to create chroma table cache: %s\n", strTemp.c_str());
+		return;
+	}
+
+	const ChromaTableCacheHeader_t header = getChromaTableCacheHeader();
+	bool bRes = fwrite(&header, sizeof(header), 1, fp) == 1
+		&& fwrite(&g_chromaTablesCache, sizeof(g_chromaTablesCache), 1, fp) == 1;
+	bRes = (fclose(fp) == 0) && bRes;
+
+	if (!bRes || rename(strTemp.c_str(), g_strChromaTableCache.c_str()) != 0)	// NB. rename() fails on Windows if another instance won the race
+	{
+		remove(strTemp.c_str());
+		return;
+	}
+
+	LogFileOutput("NTSC: saved chroma table cache: %s\n", g_strChromaTableCache.c_str());
+}
+
+// Make the chroma tables for the CHROMA_TABLES_xxx groups available via g_aBnWMonitor etc.
+// . generated (or loaded from the on-disk cache) the first time they are needed
+//===========================================================================
+static void initChromaPhaseTables (UINT uTables)
+{
+	const UINT uMissing = uTables & ~g_uChromaTablesCached;
+	if (uMissing)
+	{
+		if (g_strChromaTableCache.empty())
+		{
+			initChromaPhaseTablesUncached(uMissing);
+		}
+		else if (!loadChromaTableCache())
+		{
+			initChromaPhaseTablesUncached(CHROMA_TABLES_ALL & ~g_uChromaTablesCached);
+			saveChromaTableCache();
+		}
+	}
+
+	const UINT uLive = uTables & ~g_uChromaTablesLive;
+
+	if (uLive & CHROMA_TABLES_MONITOR)
+	{
+		g_aBnWMonitor = g_pChromaTables->BnWMonitor;
+		g_aHueMonitor = g_pChromaTables->HueMonitor;
+	}
+
+	if (uLive & CHROMA_TABLES_TV)
+	{
+		g_aBnwColorTV = g_pChromaTables->BnwColorTV;
+		g_aHueColorTV = g_pChromaTables->HueColorTV;
+	}
+
+	g_uChromaTablesLive |= uLive;
+}
+
+// The debugger can change the live tables (see CmdNTSC()), so point them to a private copy
+//===========================================================================
+static ChromaTables_t* getChromaTablesForDebugger (UINT uTables)
+{
+	initChromaPhaseTables(uTables);
+
+	if (!g_pChromaTablesDebugger)
+		g_pChromaTablesDebugger = new ChromaTables_t;
+
+	if ((uTables & CHROMA_TABLES_MONITOR) && g_aHueMonitor != g_pChromaTablesDebugger->HueMonitor)
+	{
+		memcpy(g_pChromaTablesDebugger->BnWMonitor, g_aBnWMonitor, sizeof(g_pChromaTablesDebugger->BnWMonitor));
+		memcpy(g_pChromaTablesDebugger->HueMonitor, g_aHueMonitor, sizeof(g_pChromaTablesDebugger->HueMonitor));
+		g_aBnWMonitor = g_pChromaTablesDebugger->BnWMonitor;
+		g_aHueMonitor = g_pChromaTablesDebugger->HueMonitor;
+	}
+
+	if ((uTables & CHROMA_TABLES_TV) && g_aHueColorTV != g_pChromaTablesDebugger->HueColorTV)
+	{
+		memcpy(g_pChromaTablesDebugger->BnwColorTV, g_aBnwColorTV, sizeof(g_pChromaTablesDebugger->BnwColorTV));
+		memcpy(g_pChromaTablesDebugger->HueColorTV, g_aHueColorTV, sizeof(g_pChromaTablesDebugger->HueColorTV));
+		g_aBnwColorTV = g_pChromaTablesDebugger->BnwColorTV;
+		g_aHueColorTV = g_pChromaTablesDebugger->HueColorTV;
+	}
+
+	return g_pChromaTablesDebugger;
+}
+
 //===========================================================================
 static void initPixelDoubleMasks (void)
 {
@@ -1899,25 +2136,27 @@ void updateScreenSHR(long cycles6502)
 //===========================================================================
 uint32_t*NTSC_VideoGetChromaTable( bool bHueTypeMonochrome, bool bMonitorTypeColorTV )
 {
+	ChromaTables_t* pTables = getChromaTablesForDebugger(bMonitorTypeColorTV ? CHROMA_TABLES_TV : CHROMA_TABLES_MONITOR);
+
 	if( bHueTypeMonochrome )
 	{
-		g_nChromaSize = sizeof( g_aBnwColorTV );
+		g_nChromaSize = sizeof( pTables->BnwColorTV );
 
 		if( bMonitorTypeColorTV )
-			return (uint32_t*) g_aBnwColorTV;
+			return (uint32_t*) pTables->BnwColorTV;
 		else
-			return (uint32_t*) g_aBnWMonitor;
+			return (uint32_t*) pTables->BnWMonitor;
 	} else {
-		g_nChromaSize = sizeof( g_aHueColorTV );
+		g_nChromaSize = sizeof( pTables->HueColorTV );
 
 		if( bMonitorTypeColorTV )
-			return (uint32_t*) g_aHueColorTV;
+			return (uint32_t*) pTables->HueColorTV;
 		else
 #if ALT_TABLE
 			g_nChromaSize = sizeof(T_NTSC);
 			return (uint32_t*)T_NTSC;
 #endif
-			return (uint32_t*) g_aHueMonitor;
+			return (uint32_t*) pTables->HueMonitor;
 	}
 }
 
@@ -2234,9 +2473,12 @@ void NTSC_SetVideoStyle(void)
 {
 	const bool half = GetVideo().IsVideoStyle(VS_HALF_SCANLINES);
 	const VideoRefreshRate_e refresh = GetVideo().GetVideoRefreshRate();
+	const VideoType_e videoType = GetVideo().GetVideoType();
 	uint8_t r, g, b;
 
-	switch ( GetVideo().GetVideoType() )
+	initChromaPhaseTables((videoType == VT_COLOR_TV || videoType == VT_MONO_TV) ? CHROMA_TABLES_TV : CHROMA_TABLES_MONITOR);
+
+	switch ( videoType )
 	{
 		case VT_COLOR_TV:
 			r = 0xFF;
@@ -2343,7 +2585,8 @@ void NTSC_VideoInit( uint8_t* pFramebuffer ) // wsVideoInit
 	make_csbits();
 	GenerateVideoTables();
 	initPixelDoubleMasks();
-	initChromaPhaseTables();
+	g_uChromaTablesLive = 0;
+	initChromaPhaseTables(CHROMA_TABLES_TV);	// for GenerateBaseColors(), and NTSC_SetVideoStyle() adds any for the video type
 	updateMonochromeTables( 0xFF, 0xFF, 0xFF );
 
 	g_kFrameBufferWidth = GetVideo().GetFrameBufferWidth();
@@ -2456,7 +2699,34 @@ void NTSC_VideoInitAppleType ()
 //===========================================================================
 void NTSC_VideoInitChroma()
 {
-	initChromaPhaseTables();
+	g_uChromaTablesLive = 0;
+	initChromaPhaseTables(CHROMA_TABLES_ALL);
+}
+
+//===========================================================================
+void NTSC_SetChromaTableCache(const std::string& pathname)
+{
+	g_strChromaTableCache = pathname;
+}
+
+//===========================================================================
+void NTSC_GetChromaTablesMemory(size_t& privateSize, size_t& sharedSize)
+{
+	const size_t uGroupSize = sizeof(ChromaTables_t) / 2;	// monitor or TV
+
+	privateSize = sizeof(g_aBnWMonitorCustom) + sizeof(g_aBnWColorTVCustom);
+	sharedSize = g_uChromaTablesMappedSize;
+
+	if (g_pChromaTables == &g_chromaTablesCache)
+	{
+		if (g_uChromaTablesCached & CHROMA_TABLES_MONITOR)
+			privateSize += uGroupSize;
+		if (g_uChromaTablesCached & CHROMA_TABLES_TV)
+			privateSize += uGroupSize;
+	}
+
+	if (g_pChromaTablesDebugger)
+		privateSize += sizeof(ChromaTables_t);
 }
 
 //===========================================================================
@@ -2607,7 +2877,7 @@ static bool IsNTSC(void)
 	return g_videoScannerMaxVert == VIDEO_SCANNER_MAX_VERT;
 }
 
-static void GenerateVideoTables( void )
+static void GenerateVideoTablesUncached( void )
 {
 	eApple2Type currentApple2Type = GetApple2Type();
 	uint32_t currentVideoMode = GetVideo().GetVideoMode();
@@ -2694,6 +2964,40 @@ static void GenerateVideoTables( void )
 	g_nTextPage = currentTextPage;
 }
 
+// The video scanner tables only depend on the refresh rate, so keep a copy for each rate:
+// . a restart (eg. after a config change) then just copies them back
+struct VideoTables_t
+{
+	bool bValid;
+	unsigned short ClockVertOffsetsHGR[VIDEO_SCANNER_MAX_VERT_PAL];
+	unsigned short ClockVertOffsetsTXT[VIDEO_SCANNER_MAX_VERT_PAL/8];
+	unsigned short IIP_HorzClockOffset[5][VIDEO_SCANNER_MAX_HORZ];
+	unsigned short IIE_HorzClockOffset[5][VIDEO_SCANNER_MAX_HORZ];
+};
+static VideoTables_t g_videoTablesCache[2];	// [NTSC, PAL]
+
+static void GenerateVideoTables( void )
+{
+	VideoTables_t& cache = g_videoTablesCache[IsNTSC() ? 0 : 1];
+
+	if (!cache.bValid)
+	{
+		GenerateVideoTablesUncached();
+
+		memcpy(cache.ClockVertOffsetsHGR, g_aClockVertOffsetsHGR, sizeof(g_aClockVertOffsetsHGR));
+		memcpy(cache.ClockVertOffsetsTXT, g_aClockVertOffsetsTXT, sizeof(g_aClockVertOffsetsTXT));
+		memcpy(cache.IIP_HorzClockOffset, APPLE_IIP_HORZ_CLOCK_OFFSET, sizeof(APPLE_IIP_HORZ_CLOCK_OFFSET));
+		memcpy(cache.IIE_HorzClockOffset, APPLE_IIE_HORZ_CLOCK_OFFSET, sizeof(APPLE_IIE_HORZ_CLOCK_OFFSET));
+		cache.bValid = true;
+		return;
+	}
+
+	memcpy(g_aClockVertOffsetsHGR, cache.ClockVertOffsetsHGR, sizeof(g_aClockVertOffsetsHGR));
+	memcpy(g_aClockVertOffsetsTXT, cache.ClockVertOffsetsTXT, sizeof(g_aClockVertOffsetsTXT));
+	memcpy(APPLE_IIP_HORZ_CLOCK_OFFSET, cache.IIP_HorzClockOffset, sizeof(APPLE_IIP_HORZ_CLOCK_OFFSET));
+	memcpy(APPLE_IIE_HORZ_CLOCK_OFFSET, cache.IIE_HorzClockOffset, sizeof(APPLE_IIE_HORZ_CLOCK_OFFSET));
+}
+
 static void GenerateBaseColors(baseColors_t pBaseNtscColors)
 {
 	for (UINT i=0; i<16; i++)
@@ -19,6 +19,8 @@ void NTSC_VideoInit(uint8_t *pFramebuffer);
 void NTSC_VideoReinitialize(uint32_t cyclesThisFrame, bool bInitVideoScannerAddress);
 void NTSC_VideoInitAppleType(void);
 void NTSC_VideoInitChroma(void);
+void NTSC_SetChromaTableCache(const std::string& pathname);
+void NTSC_GetChromaTablesMemory(size_t& privateSize, size_t& sharedSize);
 void NTSC_VideoUpdateCycles(UINT cycles6502);
 void NTSC_VideoRedrawWholeScreen(void);
 
@@ -30,11 +30,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "ParallelPrinter.h"
 #include "Core.h"
+#include "CPU.h"
+#include "Log.h"
 #include "Memory.h"
 #include "Pravets.h"
 #include "Registry.h"
 #include "YamlHelper.h"
 #include "Interface.h"
+#include "StrFormat.h"
 
 #include "../resource/resource.h"
 
@@ -55,7 +58,6 @@ void ParallelPrinterCard::InitializeIO(LPBYTE pCxRomPeripheral)
 //===========================================================================
 bool ParallelPrinterCard::CheckPrint(void)
 {
-	m_inactivity = 0;
 	if (m_file == NULL)
 	{
 		//char filepath[MAX_PATH * 2];
@@ -73,6 +75,14 @@ bool ParallelPrinterCard::CheckPrint(void)
 //===========================================================================
 void ParallelPrinterCard::ClosePrint(void)
 {
+	Flush();
+
+	if (m_dotMatrix)
+	{
+		m_dotMatrix->FormFeed();
+		SavePages();
+	}
+
 	if (m_file != NULL)
 	{
 		fclose(m_file);
@@ -89,6 +99,35 @@ void ParallelPrinterCard::ClosePrint(void)
 	m_inactivity = 0;
 }
 
+//===========================================================================
+void ParallelPrinterCard::Flush(void)
+{
+	if (m_buffer.empty())
+		return;
+
+	if (CheckPrint())
+	{
+		fwrite(&m_buffer[0], 1, m_buffer.size(), m_file);
+		fflush(m_file);
+	}
+
+	m_buffer.clear();
+}
+
+//===========================================================================
+void ParallelPrinterCard::SavePages(void)
+{
+	const std::vector<PrinterPage> pages = m_dotMatrix->TakeEjectedPages();
+
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		const std::string filename = GetPageFilename(++m_pageNumber);
+		const bool bRes = (m_pageFormat == PRINTER_PAGE_PBM) ? pages[i].SavePBM(filename) : pages[i].SavePNG(filename);
+		if (!bRes)
+			LogFileOutput("Printer: failed to save page: %s\n", filename.c_str());
+	}
+}
+
 //===========================================================================
 void ParallelPrinterCard::Destroy(void)
 {
@@ -98,11 +137,21 @@ void ParallelPrinterCard::Destroy(void)
 //===========================================================================
 void ParallelPrinterCard::Update(const ULONG nExecutedCycles)
 {
-	if (m_file == NULL)
+	const bool bPrinting = m_dotMatrix && (!m_dotMatrix->IsPageBlank() || m_dotMatrix->HasEjectedPages());
+	if (m_file == NULL && m_buffer.empty() && !bPrinting)
 		return;
 
+	m_inactivity += nExecutedCycles;
+
+	// pages ejected by a form feed (saved here, rather than while the guest is writing)
+	if (m_dotMatrix && m_dotMatrix->HasEjectedPages())
+		SavePages();
+
+	if (m_inactivity > FLUSH_IDLE_CYCLES)
+		Flush();
+
 //	if ((inactivity += totalcycles) > (Printer_GetIdleLimit () * 1000 * 1000))  //This line seems to give a very big deviation
-	if ((m_inactivity += nExecutedCycles) > (ParallelPrinterCard::GetIdleLimit () * 710000))
+	if (m_inactivity > (ParallelPrinterCard::GetIdleLimit () * 710000))
 	{
 		// inactive, so close the file (next print will overwrite or append to it, according to the settings made)
 		ClosePrint();
@@ -116,28 +165,53 @@ void ParallelPrinterCard::Reset(const bool powerCycle)
 }
 
 //===========================================================================
-BYTE __stdcall ParallelPrinterCard::IORead(WORD, WORD address, BYTE, BYTE, ULONG)
+BYTE ParallelPrinterCard::GetStatus(ULONG nExecutedCycles)
+{
+	BYTE status = STATUS_SELECT | STATUS_NACK;
+
+	if (m_strobeCycle)
+	{
+		CpuCalcCycles(nExecutedCycles);
+		const UINT64 elapsed = g_nCumulativeCycles - m_strobeCycle;
+		if (elapsed < BUSY_CYCLES)
+			status |= STATUS_BUSY;
+		else if (elapsed < BUSY_CYCLES + ACK_CYCLES)
+			status &= ~STATUS_NACK;
+	}
+
+	return status;
+}
+
+//===========================================================================
+BYTE __stdcall ParallelPrinterCard::IORead(WORD, WORD address, BYTE, BYTE, ULONG nExecutedCycles)
 {
 	UINT slot = ((address & 0xff) >> 4) - 8;
 	ParallelPrinterCard* card = (ParallelPrinterCard*)MemGetSlotParameters(slot);
 
-	card->CheckPrint();
-	return 0xFF; // status - TODO?
+	card->m_inactivity = 0;
+	return card->GetStatus(nExecutedCycles);
 }
 
 //===========================================================================
-BYTE __stdcall ParallelPrinterCard::IOWrite(WORD, WORD address, BYTE, BYTE value, ULONG)
+BYTE __stdcall ParallelPrinterCard::IOWrite(WORD, WORD address, BYTE, BYTE value, ULONG nExecutedCycles)
 {
 	UINT slot = ((address & 0xff) >> 4) - 8;
 	ParallelPrinterCard* card = (ParallelPrinterCard*)MemGetSlotParameters(slot);
 
-	if (!card->CheckPrint())
-		return 0;
-
 	// only allow writes to the load output port (i.e., $C090)
 	if ((address & 0xF) != 0)
 		return 0;
 
+	card->m_inactivity = 0;
+	CpuCalcCycles(nExecutedCycles);
+	card->m_strobeCycle = g_nCumulativeCycles;
+
+	if (card->m_dotMatrix)
+	{
+		card->m_dotMatrix->Write(value);	// 8-bit: graphics data & escape parameters
+		return 0;
+	}
+
 	BYTE c = value & 0x7F;
 
 	if (IsPravets(GetApple2Type()))
@@ -147,7 +221,11 @@ BYTE __stdcall ParallelPrinterCard::IOWrite(WORD, WORD address, BYTE, BYTE value
 	}
 
 	if ((card->m_bFilterUnprintable == false) || (c>31) || (c==13) || (c==10) || (c>0x7F)) //c>0x7F is needed for cyrillic characters
-		fwrite(&c, 1, 1, card->m_file);
+	{
+		card->m_buffer.push_back(c);
+		if (card->m_buffer.size() >= BUFFER_SIZE)
+			card->Flush();
+	}
 
 	return 0;
 }
@@ -174,6 +252,33 @@ void ParallelPrinterCard::SetFilename(const std::string& prtFilename)
 	}
 }
 
+void ParallelPrinterCard::SetEmulation(PrinterEmulation_e emulation)
+{
+	if (emulation == m_emulation)
+		return;
+
+	ClosePrint();	// finish the current job with the old emulation
+
+	m_emulation = emulation;
+	if (m_emulation == PRINTER_EMULATION_TEXT)
+		m_dotMatrix.reset();
+	else
+		m_dotMatrix.reset(new DotMatrixPrinter(m_emulation == PRINTER_EMULATION_EPSON ? DotMatrixPrinter::EMULATION_EPSON : DotMatrixPrinter::EMULATION_IMAGEWRITER));
+}
+
+// Printer.txt -> Printer_001.png
+std::string ParallelPrinterCard::GetPageFilename(UINT page)
+{
+	std::string filename = GetFilename();
+
+	const size_t dot = filename.find_last_of('.');
+	const size_t separator = filename.find_last_of("\\/");
+	if (dot != std::string::npos && (separator == std::string::npos || dot > separator))
+		filename.resize(dot);
+
+	return filename + StrFormat("_%03u", page) + (m_pageFormat == PRINTER_PAGE_PBM ? ".pbm" : ".png");
+}
+
 UINT ParallelPrinterCard::GetIdleLimit(void)
 {
 	return m_printerIdleLimit;
@@ -210,6 +315,12 @@ void ParallelPrinterCard::GetRegistryConfig(void)
 
 	if (RegLoadValue(regSection.c_str(), REGVALUE_PRINTER_IDLE_LIMIT, TRUE, &dwTmp))
 		SetIdleLimit(dwTmp);
+
+	if (RegLoadValue(regSection.c_str(), REGVALUE_PRINTER_EMULATION, TRUE, &dwTmp) && dwTmp < NUM_PRINTER_EMULATIONS)
+		SetEmulation((PrinterEmulation_e)dwTmp);
+
+	if (RegLoadValue(regSection.c_str(), REGVALUE_PRINTER_PAGE_FORMAT, TRUE, &dwTmp) && dwTmp < NUM_PRINTER_PAGE_FORMATS)
+		SetPageFormat((PrinterPageFormat_e)dwTmp);
 }
 
 void ParallelPrinterCard::SetRegistryConfig(void)
@@ -221,6 +332,8 @@ void ParallelPrinterCard::SetRegistryConfig(void)
 	RegSaveValue(regSection.c_str(), REGVALUE_PRINTER_APPEND, TRUE, GetPrinterAppend() ? 1 : 0);
 	RegSaveString(regSection.c_str(), REGVALUE_PRINTER_FILENAME, TRUE, GetFilename());
 	RegSaveValue(regSection.c_str(), REGVALUE_PRINTER_IDLE_LIMIT, TRUE, GetIdleLimit());
+	RegSaveValue(regSection.c_str(), REGVALUE_PRINTER_EMULATION, TRUE, GetEmulation());
+	RegSaveValue(regSection.c_str(), REGVALUE_PRINTER_PAGE_FORMAT, TRUE, GetPageFormat());
 }
 
 //===========================================================================
@@ -245,6 +358,8 @@ const std::string& ParallelPrinterCard::GetSnapshotCardName(void)
 
 void ParallelPrinterCard::SaveSnapshot(class YamlSaveHelper& yamlSaveHelper)
 {
+	Flush();	// so that a restored snapshot appends after it
+
 	YamlSaveHelper::Slot slot(yamlSaveHelper, ParallelPrinterCard::GetSnapshotCardName(), m_slot, 1);
 
 	YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
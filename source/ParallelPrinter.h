@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Card.h"
+#include "DotMatrixPrinter.h"
+
+#include <memory>
+#include <vector>
 
 class ParallelPrinterCard : public Card
 {
@@ -11,6 +15,10 @@ public:
 		m_inactivity = 0;
 		m_printerIdleLimit = 10;
 		m_file = NULL;
+		m_strobeCycle = 0;
+		m_pageNumber = 0;
+		m_emulation = PRINTER_EMULATION_TEXT;
+		m_pageFormat = PRINTER_PAGE_PNG;
 
 		m_bDumpToPrinter = false;
 		m_bConvertEncoding = false;
@@ -48,17 +56,50 @@ public:
 	bool GetEnableDumpToRealPrinter(void) { return m_bEnableDumpToRealPrinter; }
 	void SetEnableDumpToRealPrinter(bool value) { m_bEnableDumpToRealPrinter = value; }
 
+	// Text: the characters are written to the print file
+	// Epson/ImageWriter: the page bitmaps are saved next to the print file, as <name>_001.png, <name>_002.png, ...
+	enum PrinterEmulation_e { PRINTER_EMULATION_TEXT = 0, PRINTER_EMULATION_EPSON, PRINTER_EMULATION_IMAGEWRITER, NUM_PRINTER_EMULATIONS };
+	enum PrinterPageFormat_e { PRINTER_PAGE_PNG = 0, PRINTER_PAGE_PBM, NUM_PRINTER_PAGE_FORMATS };
+
+	PrinterEmulation_e GetEmulation(void) { return m_emulation; }
+	void SetEmulation(PrinterEmulation_e emulation);
+	PrinterPageFormat_e GetPageFormat(void) { return m_pageFormat; }
+	void SetPageFormat(PrinterPageFormat_e format) { m_pageFormat = format; }
+	std::string GetPageFilename(UINT page);
+	UINT GetPagesSaved(void) { return m_pageNumber; }
+
+	// Status (any read of $C0n0-$C0nF), Centronics handshake: each strobe makes the printer BUSY, then it pulses /ACK
+	static const BYTE STATUS_BUSY = 1<<7;
+	static const BYTE STATUS_NACK = 1<<6;		// 0: acknowledging
+	static const BYTE STATUS_SELECT = 1<<2;		// on line
+	static const BYTE STATUS_PAPER_EMPTY = 1<<1;
+	static const UINT BUSY_CYCLES = 10;			// the printer latches the byte, ~10us
+	static const UINT ACK_CYCLES = 5;
+
 	void GetRegistryConfig(void);
 	void SetRegistryConfig(void);
 
 private:
 	bool CheckPrint(void);
 	void ClosePrint(void);
+	void Flush(void);
+	void SavePages(void);
+	BYTE GetStatus(ULONG nExecutedCycles);
+
+	static const UINT BUFFER_SIZE = 4096;
+	static const UINT FLUSH_IDLE_CYCLES = 100000;	// ~0.1s
 
 	uint32_t m_inactivity;
 	UINT m_printerIdleLimit;
 	FILE* m_file;
 	std::string m_szPrintFilename;
+	std::vector<BYTE> m_buffer;				// not written to m_file yet
+	UINT64 m_strobeCycle;					// last write to the data port
+
+	PrinterEmulation_e m_emulation;
+	PrinterPageFormat_e m_pageFormat;
+	std::unique_ptr<DotMatrixPrinter> m_dotMatrix;
+	UINT m_pageNumber;						// pages saved
 
 	bool m_bDumpToPrinter;
 	bool m_bConvertEncoding;
@@ -25,6 +25,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  * Author: Michael Pohoreski
  */
 
+#pragma once
+
 // --- ProDOS Consts ---
 
 	const size_t PRODOS_BLOCK_SIZE   = 0x200; // 512 bytes/block
@@ -147,7 +149,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	// | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 | Bits
 	// +---------------------------------------------------------------+
 	// <-----------Year-----------> <----Month----> <-------Day------->  Date
-	uint16_t ProDOS_PackDate ( int year, int month, int day )
+	inline uint16_t ProDOS_PackDate ( int year, int month, int day )
 	{
 		uint16_t date = 0
 			| ((year  & 0x7F) << 9)
@@ -162,7 +164,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	// | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 | Bits
 	// +---------------------------------------------------------------+
 	//  <----0----> <------Hours------> <--0--> <-------Minutes------->  Time
-	uint16_t ProDOS_PackTime (int hours, int minutes)
+	inline uint16_t ProDOS_PackTime (int hours, int minutes)
 	{
 		uint16_t time = 0
 			| ((hours   & 0x1F) << 8)
@@ -229,7 +231,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	}
 
 	// ------------------------------------------------------------------------
-	int ProDOS_BlockGetFirstFree ( uint8_t *pDiskBytes, size_t nDiskSize, ProDOS_VolumeHeader_t *pVolume )
+	inline int ProDOS_BlockGetFirstFree ( uint8_t *pDiskBytes, size_t nDiskSize, ProDOS_VolumeHeader_t *pVolume )
 	{
 		if( !pVolume )
 		{
@@ -259,7 +261,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	}
 
 	// ------------------------------------------------------------------------
-	int ProDOS_BlockGetPathOffset ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, const char *pProDOSPath )
+	inline int ProDOS_BlockGetPathOffset ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, const char *pProDOSPath )
 	{
 		int nOffset    = PRODOS_ROOT_OFFSET; // Block 2 * 0x200 Bytes/Block = 0x400 abs offset
 
@@ -290,7 +292,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	}
 
 	// ------------------------------------------------------------------------
-	int ProDOS_BlockInitFree ( uint8_t *pDiskBytes, size_t nDiskSize, ProDOS_VolumeHeader_t *volume )
+	inline int ProDOS_BlockInitFree ( uint8_t *pDiskBytes, size_t nDiskSize, ProDOS_VolumeHeader_t *volume )
 	{
 		int bitmap = volume->meta.bitmap_block;
 		int offset = bitmap * PRODOS_BLOCK_SIZE;
@@ -304,7 +306,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	}
 
 	// ------------------------------------------------------------------------
-	bool ProDOS_BlockSetUsed ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, int block )
+	inline bool ProDOS_BlockSetUsed ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, int block )
 	{
 		if( !pVolume )
 		{
@@ -355,7 +357,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	// @param  nBase DiskImageOffset of directory
 	// returns DiskImageOffset
 	// ------------------------------------------------------------------------
-	int ProDOS_DirGetFirstFreeEntryOffset ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, int nBase )
+	inline int ProDOS_DirGetFirstFreeEntryOffset ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, int nBase )
 	{
 		int iNextBlock;
 		int iPrevBlock;
@@ -392,7 +394,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 // --- ProDOS Volume Functions ---
 
 	// ------------------------------------------------------------------------
-	void ProDOS_GetVolumeHeader( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolumeHeader_, int iBlock )
+	inline void ProDOS_GetVolumeHeader( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolumeHeader_, int iBlock )
 	{
 		int base = iBlock*PRODOS_BLOCK_SIZE + 4; // skip prev/next dir block double linked list
 		ProDOS_VolumeHeader_t info;
@@ -451,7 +453,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	};
 
 	// ------------------------------------------------------------------------
-	void ProDOS_SetVolumeHeader ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, int iBlock )
+	inline void ProDOS_SetVolumeHeader ( uint8_t *pDiskBytes, ProDOS_VolumeHeader_t *pVolume, int iBlock )
 	{
 		if( !pVolume )
 			return;
@@ -486,7 +488,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 // --- ProDOS File Functions ---
 
 	// ------------------------------------------------------------
-	void ProDOS_GetFileHeader ( uint8_t *pDiskBytes, int nOffset, ProDOS_FileHeader_t *pFileHeader_ )
+	inline void ProDOS_GetFileHeader ( uint8_t *pDiskBytes, int nOffset, ProDOS_FileHeader_t *pFileHeader_ )
 	{
 		ProDOS_FileHeader_t info;
 
@@ -518,7 +520,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	}
 
 	// ------------------------------------------------------------------------
-	void ProDOS_PutFileHeader ( uint8_t *pDiskBytes, int nOffset, ProDOS_FileHeader_t *pMeta )
+	inline void ProDOS_PutFileHeader ( uint8_t *pDiskBytes, int nOffset, ProDOS_FileHeader_t *pMeta )
 	{
 		int base = nOffset;
 
@@ -548,7 +550,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	}
 
 	// ------------------------------------------------------------------------
-	size_t ProDOS_String_CopyUpper( char *pDst, const char *pSrc, int nLen = 0 )
+	inline size_t ProDOS_String_CopyUpper( char *pDst, const char *pSrc, int nLen = 0 )
 	{
 		char *pBeg = pDst;
 		if( !nLen )
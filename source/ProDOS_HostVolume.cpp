@@ -0,0 +1,1125 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2014, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: ProDOS volume synthesised from a host directory
+ *
+ * Block layout:
+ * . 0-1   : ProDOS boot blocks
+ * . 2..   : root directory (at least 4 blocks)
+ * . then  : volume bitmap (16 blocks)
+ * . then  : files & sub-directories, allocated contiguously in the order they're listed
+ *           . seedling: data block
+ *           . sapling : index block, data blocks
+ *           . tree    : master index block, then for each 256 data blocks: index block, data blocks
+ */
+
+#include "StdAfx.h"
+
+#include "ProDOS_HostVolume.h"
+#include "ProDOS_FileSystem.h"
+#include "FrameBase.h"
+#include "Interface.h"
+#include "Log.h"
+#include "../resource/resource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <unordered_set>
+
+#if __cplusplus >= 201703L // Compiler option: /std:c++17
+#include <filesystem>
+#endif
+
+#ifdef __linux__
+#include <sys/xattr.h>
+#endif
+
+#if __cplusplus >= 201703L
+
+namespace
+{
+	const char XATTR_PRODOS_TYPE[] = "user.prodos.type";
+	const BYTE ACCESS_DEFAULT = ACCESS_D | ACCESS_N | ACCESS_B | ACCESS_W | ACCESS_R;	// $E3
+	const BYTE ACCESS_DIR_HEADER = ACCESS_D | ACCESS_N | ACCESS_W | ACCESS_R;				// $C3
+	const BYTE TYPE_BIN = 0x06;
+
+	struct FileTypeExt
+	{
+		const char* ext;
+		BYTE type;
+		WORD aux;
+	};
+
+	// also used to name new host files, so each type/aux pair appears once
+	const FileTypeExt g_fileTypeExts[] =
+	{
+		{ ".bas", 0xFC, 0x0801 },	// Applesoft
+		{ ".int", 0xFA, 0x0000 },	// Integer BASIC
+		{ ".bin", TYPE_BIN, 0x2000 },
+		{ ".sys", 0xFF, 0x2000 },	// SYS
+		{ ".txt", 0x04, 0x0000 },	// TXT (sequential)
+	};
+
+	bool ParseHexType(const std::string& str, BYTE& type, WORD& aux)
+	{
+		if (str.size() != 2 && str.size() != 6)
+			return false;
+
+		for (const char c : str)
+		{
+			if (!isxdigit((unsigned char)c))
+				return false;
+		}
+
+		type = (BYTE)strtoul(str.substr(0, 2).c_str(), NULL, 16);
+		aux = str.size() == 6 ? (WORD)strtoul(str.substr(2).c_str(), NULL, 16) : 0;
+		return true;
+	}
+
+	// upper case, letters/digits/'.' only, starting with a letter, 15 chars max
+	std::string MakeProDOSName(const std::string& str)
+	{
+		std::string name;
+		for (const char c : str)
+		{
+			if (name.size() == PRODOS_MAX_FILENAME)
+				break;
+
+			const char u = (char)toupper((unsigned char)c);
+			name += (isalnum((unsigned char)u) && !(u & 0x80)) ? u : '.';
+		}
+
+		if (name.empty() || !isalpha((unsigned char)name[0]))
+			name = ("A" + name).substr(0, PRODOS_MAX_FILENAME);
+
+		return name;
+	}
+
+	std::string MakeUniqueName(std::unordered_set<std::string>& names, const std::string& name)
+	{
+		std::string unique = name;
+		for (int n = 1; !names.insert(unique).second; n++)
+		{
+			const std::string suffix = StrFormat(".%d", n);
+			unique = name.substr(0, PRODOS_MAX_FILENAME - suffix.size()) + suffix;
+		}
+		return unique;
+	}
+
+	void GetHostDate(const std::filesystem::path& path, WORD& date, WORD& time)
+	{
+		date = 0;
+		time = 0;
+
+		std::error_code ec;
+		const std::filesystem::file_time_type ftime = std::filesystem::last_write_time(path, ec);
+		if (ec)
+			return;
+
+		const std::chrono::system_clock::time_point systime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+			ftime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+		const time_t t = std::chrono::system_clock::to_time_t(systime);
+		const struct tm* tm = localtime(&t);
+		if (!tm)
+			return;
+
+		date = ProDOS_PackDate(tm->tm_year % 100, tm->tm_mon + 1, tm->tm_mday);	// ProDOS 2.4: 40-99 = 1940-1999, 0-39 = 2000-2039
+		time = ProDOS_PackTime(tm->tm_hour, tm->tm_min);
+	}
+
+	// visible regular files & directories, sorted
+	void ListHostDirectory(const std::filesystem::path& path, std::vector<std::string>& names)
+	{
+		std::error_code ec;
+		for (std::filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec))
+		{
+			const std::string name = it->path().filename().string();
+			if (name.empty() || name[0] == '.')
+				continue;
+
+			std::error_code ec2;
+			if (it->is_directory(ec2) || it->is_regular_file(ec2))
+				names.push_back(name);
+		}
+
+		std::sort(names.begin(), names.end());
+	}
+
+	UINT GetNumDataBlocks(const UINT eof)
+	{
+		return std::max<UINT>(1, (UINT)((eof + PRODOS_BLOCK_SIZE - 1) / PRODOS_BLOCK_SIZE));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+ProDOSHostVolume::ProDOSHostVolume(const std::string& pathname, const bool bWriteProtected)
+	: m_root(pathname)
+	, m_bWriteProtected(bWriteProtected)
+	, m_bitmapBlock(0)
+	, m_nextFree(0)
+	, m_bListedAll(false)
+	, m_hostFileNode(-1)
+{
+	memset(m_bootBlocks, 0, sizeof(m_bootBlocks));
+	const BYTE* pBootBlocks = GetFrame().GetResource(IDR_BOOT_SECTOR_PRODOS243, "FIRMWARE", sizeof(m_bootBlocks));
+	if (pBootBlocks)
+		memcpy(m_bootBlocks, pBootBlocks, sizeof(m_bootBlocks));
+
+	const std::filesystem::path rootPath(m_root);
+	std::string volumeName = rootPath.filename().string();
+	if (volumeName.empty())
+		volumeName = rootPath.parent_path().filename().string();	// trailing separator
+
+	Node root = Node();
+	root.name = MakeProDOSName(volumeName.empty() ? "HOST" : volumeName);
+	root.parent = -1;
+	root.isDir = true;
+	root.storageType = PRODOS_KIND_ROOT;
+	root.fileType = TYPE_DIR;
+	root.access = ACCESS_DIR_HEADER;
+	root.isGenerated = true;
+	GetHostDate(m_root, root.date, root.time);
+	ListHostDirectory(m_root, root.pending);
+
+	m_nextFree = PRODOS_ROOT_BLOCK;
+	Allocate(root, std::max<UINT>(MIN_ROOT_BLOCKS, (UINT)(root.pending.size() + ENTRIES_PER_BLOCK) / ENTRIES_PER_BLOCK));
+	m_bitmapBlock = m_nextFree;
+	m_nextFree += BITMAP_BLOCKS;
+
+	m_nodes.push_back(root);
+	RegisterNode(0);
+
+	ListDirectory(0);
+
+	LogFileOutput("ProDOS host volume: /%s = %s (%" SIZE_T_FMT " entries)\n", root.name.c_str(), m_root.c_str(), m_nodes[0].children.size());
+}
+
+ProDOSHostVolume::~ProDOSHostVolume(void)
+{
+	Flush();
+}
+
+//-----------------------------------------------------------------------------
+
+bool ProDOSHostVolume::IsHostDirectory(const std::string& pathname)
+{
+	std::error_code ec;
+	return std::filesystem::is_directory(pathname, ec);
+}
+
+void ProDOSHostVolume::GetFileType(const std::string& hostPath, std::string& name, BYTE& type, WORD& aux, bool& bIsXattr)
+{
+	const std::string hostName = std::filesystem::path(hostPath).filename().string();
+
+	name = hostName;
+	type = TYPE_BIN;
+	aux = 0x0000;
+	bIsXattr = false;
+
+	// NAME#TTAAAA
+	const size_t hash = hostName.rfind('#');
+	if (hash != std::string::npos && hash > 0 && ParseHexType(hostName.substr(hash + 1), type, aux))
+	{
+		name = hostName.substr(0, hash);
+	}
+	else
+	{
+#ifdef __linux__
+		char value[8];
+		const ssize_t size = getxattr(hostPath.c_str(), XATTR_PRODOS_TYPE, value, sizeof(value));
+		if (size > 0 && ParseHexType(std::string(value, size), type, aux))
+		{
+			bIsXattr = true;
+			name = MakeProDOSName(name);
+			return;
+		}
+#endif
+
+		const size_t dot = hostName.rfind('.');
+		if (dot != std::string::npos && dot > 0)
+		{
+			std::string ext = hostName.substr(dot);
+			std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)tolower(c); });
+			for (const FileTypeExt& fileTypeExt : g_fileTypeExts)
+			{
+				if (ext == fileTypeExt.ext)
+				{
+					name = hostName.substr(0, dot);
+					type = fileTypeExt.type;
+					aux = fileTypeExt.aux;
+					break;
+				}
+			}
+		}
+	}
+
+	name = MakeProDOSName(name);
+}
+
+size_t ProDOSHostVolume::GetNumListedDirectories(void) const
+{
+	return std::count_if(m_nodes.begin(), m_nodes.end(), [](const Node& node) { return node.isDir && node.isListed && !node.isDeleted; });
+}
+
+//-----------------------------------------------------------------------------
+
+std::string ProDOSHostVolume::GetHostPath(const int node) const
+{
+	if (m_nodes[node].parent < 0)
+		return m_root;
+
+	return (std::filesystem::path(GetHostPath(m_nodes[node].parent)) / m_nodes[node].hostName).string();
+}
+
+bool ProDOSHostVolume::Allocate(Node& node, const UINT numBlocks)
+{
+	if (m_nextFree + numBlocks > TOTAL_BLOCKS)
+		return false;
+
+	node.keyBlock = (WORD)m_nextFree;
+	node.blocksUsed = (WORD)numBlocks;
+	m_nextFree += numBlocks;
+
+	if (node.isDir)
+	{
+		for (UINT i = 0; i < numBlocks; i++)
+			node.dirBlocks.push_back((WORD)(node.keyBlock + i));
+	}
+
+	return true;
+}
+
+void ProDOSHostVolume::RegisterNode(const int node)
+{
+	const Node& n = m_nodes[node];
+	if (n.isGenerated)
+		m_ranges[n.keyBlock] = node;
+
+	for (const WORD block : n.dirBlocks)
+		m_dirBlocks[block] = node;
+}
+
+int ProDOSHostVolume::AddNode(const int parent, const std::string& hostName, std::unordered_set<std::string>& names)
+{
+	const std::filesystem::path hostPath = std::filesystem::path(GetHostPath(parent)) / hostName;
+
+	std::error_code ec;
+	const std::filesystem::file_status status = std::filesystem::status(hostPath, ec);
+	if (ec)
+		return -1;
+
+	Node node = Node();
+	node.hostName = hostName;
+	node.parent = parent;
+	node.isDir = std::filesystem::is_directory(status);
+	node.access = ACCESS_DEFAULT;
+	node.isGenerated = true;
+	GetHostDate(hostPath, node.date, node.time);
+
+	UINT numBlocks = 0;
+	std::string name;
+
+	if (node.isDir)
+	{
+		ListHostDirectory(hostPath, node.pending);
+		name = MakeProDOSName(hostName);
+		node.storageType = PRODOS_KIND_DIR;
+		node.fileType = TYPE_DIR;
+		numBlocks = (UINT)(node.pending.size() + ENTRIES_PER_BLOCK) / ENTRIES_PER_BLOCK;	// +1 for the header
+		node.eof = numBlocks * PRODOS_BLOCK_SIZE;
+	}
+	else if (std::filesystem::is_regular_file(status))
+	{
+		const uintmax_t size = std::filesystem::file_size(hostPath, ec);
+		if (ec || size > MAX_EOF)
+		{
+			LogFileOutput("ProDOS host volume: skipping %s (too big)\n", hostPath.string().c_str());
+			return -1;
+		}
+
+		GetFileType(hostPath.string(), name, node.fileType, node.aux, node.isXattr);
+		node.eof = (UINT)size;
+
+		const UINT dataBlocks = GetNumDataBlocks(node.eof);
+		if (node.eof <= PRODOS_BLOCK_SIZE)
+		{
+			node.storageType = PRODOS_KIND_SEED;
+			numBlocks = 1;
+		}
+		else if (dataBlocks <= 256)
+		{
+			node.storageType = PRODOS_KIND_SAPL;
+			numBlocks = 1 + dataBlocks;
+		}
+		else
+		{
+			node.storageType = PRODOS_KIND_TREE;
+			numBlocks = 1 + (dataBlocks + 255) / 256 + dataBlocks;
+		}
+	}
+	else
+	{
+		return -1;
+	}
+
+	if (!Allocate(node, numBlocks))
+	{
+		LogFileOutput("ProDOS host volume: skipping %s (volume full)\n", hostPath.string().c_str());
+		return -1;
+	}
+
+	node.name = MakeUniqueName(names, name);
+
+	const UINT slot = (UINT)m_nodes[parent].children.size() + 1;	// after the header
+	node.entryBlock = m_nodes[parent].dirBlocks[slot / ENTRIES_PER_BLOCK];
+	node.entryNumber = (BYTE)(slot % ENTRIES_PER_BLOCK + 1);
+
+	const int index = (int)m_nodes.size();
+	m_nodes.push_back(node);
+	m_nodes[parent].children.push_back(index);
+	RegisterNode(index);
+
+	return index;
+}
+
+void ProDOSHostVolume::ListDirectory(const int dir)
+{
+	if (m_nodes[dir].isListed)
+		return;
+
+	m_nodes[dir].isListed = true;
+
+	const std::vector<std::string> pending = std::move(m_nodes[dir].pending);
+	m_nodes[dir].pending.clear();
+
+	std::unordered_set<std::string> names;
+	for (const std::string& hostName : pending)
+		AddNode(dir, hostName, names);
+}
+
+void ProDOSHostVolume::ListAll(void)
+{
+	if (m_bListedAll)
+		return;
+
+	m_bListedAll = true;
+
+	for (size_t i = 0; i < m_nodes.size(); i++)	// NB. grows while listing
+	{
+		if (m_nodes[i].isDir && !m_nodes[i].isDeleted)
+			ListDirectory((int)i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+int ProDOSHostVolume::GetGeneratedNode(const UINT nBlock) const
+{
+	std::map<WORD, int>::const_iterator it = m_ranges.upper_bound((WORD)nBlock);
+	if (it == m_ranges.begin())
+		return -1;
+
+	--it;
+	const Node& node = m_nodes[it->second];
+	if (!node.isGenerated || nBlock >= (UINT)node.keyBlock + node.blocksUsed)
+		return -1;
+
+	return it->second;
+}
+
+bool ProDOSHostVolume::ReadBlock(const UINT nBlock, LPBYTE pBlockBuffer)
+{
+	if (nBlock >= TOTAL_BLOCKS)
+		return false;
+
+	GetBlock(nBlock, pBlockBuffer);
+	return true;
+}
+
+void ProDOSHostVolume::GetBlock(const UINT nBlock, BYTE* pBlock)
+{
+	const std::unordered_map<WORD, std::vector<BYTE>>::const_iterator it = m_written.find((WORD)nBlock);
+	if (it != m_written.end())
+		memcpy(pBlock, it->second.data(), PRODOS_BLOCK_SIZE);
+	else
+		GenerateBlock(nBlock, pBlock);
+}
+
+void ProDOSHostVolume::GenerateBlock(const UINT nBlock, BYTE* pBlock)
+{
+	memset(pBlock, 0, PRODOS_BLOCK_SIZE);
+
+	if (nBlock < 2)
+	{
+		memcpy(pBlock, &m_bootBlocks[nBlock * PRODOS_BLOCK_SIZE], PRODOS_BLOCK_SIZE);
+		return;
+	}
+
+	if (nBlock >= m_bitmapBlock && nBlock < m_bitmapBlock + BITMAP_BLOCKS)
+	{
+		// Only exact once the whole tree has been allocated
+		ListAll();
+
+		const UINT first = (nBlock - m_bitmapBlock) * PRODOS_BLOCK_SIZE * 8;
+		for (UINT i = 0; i < PRODOS_BLOCK_SIZE * 8; i++)
+		{
+			const UINT block = first + i;
+			if (block >= m_nextFree && block < TOTAL_BLOCKS)
+				pBlock[i / 8] |= 0x80 >> (i % 8);	// 1 = free
+		}
+		return;
+	}
+
+	const int node = GetGeneratedNode(nBlock);
+	if (node < 0)
+		return;	// free
+
+	const std::unordered_map<WORD, std::vector<BYTE>>::const_iterator it = m_cache.find((WORD)nBlock);
+	if (it != m_cache.end())
+	{
+		memcpy(pBlock, it->second.data(), PRODOS_BLOCK_SIZE);
+		return;
+	}
+
+	const UINT index = nBlock - m_nodes[node].keyBlock;
+	if (m_nodes[node].isDir)
+	{
+		ListDirectory(node);
+		GenerateDirBlock(node, index, pBlock);
+		m_cache[(WORD)nBlock].assign(pBlock, pBlock + PRODOS_BLOCK_SIZE);
+	}
+	else
+	{
+		GenerateFileBlock(node, index, pBlock);
+	}
+}
+
+void ProDOSHostVolume::GenerateDirBlock(const int dir, const UINT index, BYTE* pBlock)
+{
+	const Node& d = m_nodes[dir];
+
+	ProDOS_Put16(pBlock, 0, index ? d.dirBlocks[index - 1] : 0);
+	ProDOS_Put16(pBlock, 2, index + 1 < d.dirBlocks.size() ? d.dirBlocks[index + 1] : 0);
+
+	if (index == 0)
+	{
+		ProDOS_VolumeHeader_t header;
+		memset(&header, 0, sizeof(header));
+		header.kind = d.parent < 0 ? PRODOS_KIND_ROOT : PRODOS_KIND_SUB;
+		header.len = (uint8_t)d.name.size();
+		memcpy(header.name, d.name.c_str(), d.name.size());
+		header.date = d.date;
+		header.time = d.time;
+		header.access = ACCESS_DIR_HEADER;
+		header.entry_len = ENTRY_LEN;
+		header.entry_num = ENTRIES_PER_BLOCK;
+		header.file_count = (uint16_t)d.children.size();
+
+		if (d.parent < 0)
+		{
+			header.meta.bitmap_block = (uint16_t)m_bitmapBlock;
+			header.meta.total_blocks = (uint16_t)TOTAL_BLOCKS;
+		}
+		else
+		{
+			// parent_pointer, parent_entry_number, parent_entry_length
+			header.info.res75 = 0x75;
+			header.meta.bitmap_block = d.entryBlock;
+			header.meta.total_blocks = (uint16_t)(d.entryNumber | (ENTRY_LEN << 8));
+		}
+
+		ProDOS_SetVolumeHeader(pBlock, &header, 0);
+	}
+
+	for (UINT i = 0; i < ENTRIES_PER_BLOCK; i++)
+	{
+		const UINT slot = index * ENTRIES_PER_BLOCK + i;
+		if (slot == 0)
+			continue;	// header
+
+		if (slot - 1 >= d.children.size())
+			break;
+
+		const Node& child = m_nodes[d.children[slot - 1]];
+
+		ProDOS_FileHeader_t entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.kind = child.storageType;
+		entry.len = (uint8_t)child.name.size();
+		memcpy(entry.name, child.name.c_str(), child.name.size());
+		entry.type = child.fileType;
+		entry.inode = child.keyBlock;
+		entry.blocks = child.blocksUsed;
+		entry.size = child.eof;
+		entry.date = child.date;
+		entry.time = child.time;
+		entry.access = child.access;
+		entry.aux = child.aux;
+		entry.mod_date = child.date;
+		entry.mod_time = child.time;
+		entry.dir_block = d.keyBlock;	// header_pointer
+
+		ProDOS_PutFileHeader(pBlock, 4 + i * ENTRY_LEN, &entry);
+	}
+}
+
+void ProDOSHostVolume::GenerateFileBlock(const int file, const UINT index, BYTE* pBlock)
+{
+	const Node& f = m_nodes[file];
+	const UINT dataBlocks = GetNumDataBlocks(f.eof);
+	const WORD key = f.keyBlock;
+
+	if (f.storageType == PRODOS_KIND_SEED)
+	{
+		ReadHostData(file, 0, pBlock);
+		return;
+	}
+
+	if (f.storageType == PRODOS_KIND_SAPL)
+	{
+		if (index > 0)
+		{
+			ReadHostData(file, index - 1, pBlock);
+			return;
+		}
+
+		for (UINT i = 0; i < dataBlocks; i++)
+			ProDOS_PutIndexBlock(pBlock, 0, i, key + 1 + i);
+	}
+	else	// PRODOS_KIND_TREE: groups of 257 blocks (index, data...)
+	{
+		if (index == 0)
+		{
+			for (UINT group = 0; group * 256 < dataBlocks; group++)
+				ProDOS_PutIndexBlock(pBlock, 0, group, key + 1 + group * 257);
+		}
+		else
+		{
+			const UINT group = (index - 1) / 257;
+			const UINT pos = (index - 1) % 257;
+			if (pos > 0)
+			{
+				ReadHostData(file, group * 256 + pos - 1, pBlock);
+				return;
+			}
+
+			for (UINT i = 0; i < 256 && group * 256 + i < dataBlocks; i++)
+				ProDOS_PutIndexBlock(pBlock, 0, i, key + 1 + group * 257 + 1 + i);
+		}
+	}
+
+	m_cache[(WORD)(key + index)].assign(pBlock, pBlock + PRODOS_BLOCK_SIZE);
+}
+
+void ProDOSHostVolume::ReadHostData(const int file, const UINT dataBlock, BYTE* pBlock)
+{
+	const UINT offset = dataBlock * PRODOS_BLOCK_SIZE;
+	const UINT eof = m_nodes[file].eof;
+	if (offset >= eof)
+		return;
+
+	if (m_hostFileNode != file)
+	{
+		m_hostFile.close();
+		m_hostFile.clear();
+		m_hostFile.open(GetHostPath(file), std::ios::binary);
+		m_hostFileNode = file;
+	}
+
+	m_hostFile.clear();
+	m_hostFile.seekg(offset);
+	m_hostFile.read((char*)pBlock, std::min<UINT>(PRODOS_BLOCK_SIZE, eof - offset));	// short read (file changed on the host): zeros
+}
+
+void ProDOSHostVolume::CloseHostFile(const int node)
+{
+	if (m_hostFileNode == node)
+	{
+		m_hostFile.close();
+		m_hostFileNode = -1;
+	}
+}
+
+// Move the node's generated blocks to m_written: from now on they're the guest's
+void ProDOSHostVolume::Detach(const int node)
+{
+	if (!m_nodes[node].isGenerated)
+		return;
+
+	if (m_nodes[node].isDir)
+		ListDirectory(node);
+
+	const WORD key = m_nodes[node].keyBlock;
+	for (UINT i = 0; i < m_nodes[node].blocksUsed; i++)
+	{
+		const WORD block = (WORD)(key + i);
+		if (m_written.find(block) == m_written.end())
+		{
+			std::vector<BYTE>& data = m_written[block];
+			data.resize(PRODOS_BLOCK_SIZE);
+			GenerateBlock(block, data.data());
+		}
+		m_cache.erase(block);
+	}
+
+	m_nodes[node].isGenerated = false;
+	m_ranges.erase(key);
+	CloseHostFile(node);
+}
+
+//-----------------------------------------------------------------------------
+
+bool ProDOSHostVolume::WriteBlock(const UINT nBlock, const BYTE* pBlockBuffer)
+{
+	if (m_bWriteProtected || nBlock >= TOTAL_BLOCKS)
+		return false;
+
+	// Freeze the allocation before the guest allocates blocks itself
+	ListAll();
+
+	const int node = GetGeneratedNode(nBlock);
+	if (node >= 0)
+		Detach(node);
+
+	m_written[(WORD)nBlock].assign(pBlockBuffer, pBlockBuffer + PRODOS_BLOCK_SIZE);
+
+	const std::unordered_map<WORD, int>::const_iterator it = m_dirBlocks.find((WORD)nBlock);
+	if (it != m_dirBlocks.end())
+		SyncDirectory(it->second);
+	else
+		m_dirtyBlocks.insert((WORD)nBlock);
+
+	return true;
+}
+
+void ProDOSHostVolume::Flush(void)
+{
+	if (m_written.empty())
+		return;
+
+	for (size_t i = 0; i < m_nodes.size(); i++)	// NB. grows while syncing
+	{
+		if (m_nodes[i].isDir && m_nodes[i].isListed && !m_nodes[i].isDeleted)
+			SyncDirectory((int)i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Follow the directory's chain, (re)registering its blocks
+void ProDOSHostVolume::ReadDirectory(const int dir, std::vector<Entry>& entries)
+{
+	std::vector<WORD> chain;
+	std::unordered_set<WORD> seen;
+	BYTE block[PRODOS_BLOCK_SIZE];
+
+	for (WORD nBlock = m_nodes[dir].keyBlock; nBlock && nBlock < TOTAL_BLOCKS && seen.insert(nBlock).second; nBlock = ProDOS_Get16(block, 2))
+	{
+		GetBlock(nBlock, block);
+
+		for (UINT i = chain.empty() ? 1 : 0; i < ENTRIES_PER_BLOCK; i++)
+		{
+			ProDOS_FileHeader_t header;
+			ProDOS_GetFileHeader(block, 4 + i * ENTRY_LEN, &header);
+			if (header.len == 0)
+				continue;
+
+			if (header.kind != PRODOS_KIND_SEED && header.kind != PRODOS_KIND_SAPL && header.kind != PRODOS_KIND_TREE && header.kind != PRODOS_KIND_DIR)
+				continue;	// deleted, or not a ProDOS 8 file
+
+			Entry entry;
+			entry.storageType = header.kind;
+			entry.name = header.name;
+			entry.fileType = header.type;
+			entry.keyBlock = header.inode;
+			entry.blocksUsed = header.blocks;
+			entry.eof = header.size;
+			entry.aux = header.aux;
+			entry.access = header.access;
+			entries.push_back(entry);
+		}
+
+		chain.push_back(nBlock);
+	}
+
+	for (const WORD nBlock : m_nodes[dir].dirBlocks)
+		m_dirBlocks.erase(nBlock);
+
+	m_nodes[dir].dirBlocks = chain;
+	for (const WORD nBlock : chain)
+		m_dirBlocks[nBlock] = dir;
+}
+
+void ProDOSHostVolume::SyncDirectory(const int dir)
+{
+	ListDirectory(dir);
+
+	std::vector<Entry> entries;
+	ReadDirectory(dir, entries);
+
+	const std::vector<int> oldChildren = m_nodes[dir].children;
+	std::vector<int> matches(entries.size(), -1);
+	std::unordered_set<int> matched;
+
+	// Match the entries to the nodes by key block, then by name
+	std::unordered_map<WORD, int> byKey;
+	for (const int child : oldChildren)
+		byKey[m_nodes[child].keyBlock] = child;
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const std::unordered_map<WORD, int>::const_iterator it = byKey.find(entries[i].keyBlock);
+		if (it != byKey.end() && m_nodes[it->second].isDir == (entries[i].storageType == PRODOS_KIND_DIR) && matched.insert(it->second).second)
+			matches[i] = it->second;
+	}
+
+	std::unordered_map<std::string, int> byName;
+	for (const int child : oldChildren)
+	{
+		if (matched.find(child) == matched.end())
+			byName[m_nodes[child].name] = child;
+	}
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (matches[i] >= 0)
+			continue;
+
+		const std::unordered_map<std::string, int>::const_iterator it = byName.find(entries[i].name);
+		if (it != byName.end() && m_nodes[it->second].isDir == (entries[i].storageType == PRODOS_KIND_DIR) && matched.insert(it->second).second)
+			matches[i] = it->second;
+	}
+
+	// Deleted
+	for (const int child : oldChildren)
+	{
+		if (matched.find(child) == matched.end())
+			RemoveNode(child);
+	}
+
+	// Renamed, rewritten & new
+	std::vector<int> children;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const int child = matches[i] >= 0 ? matches[i] : CreateNode(dir, entries[i]);
+		if (child < 0)
+			continue;
+
+		if (matches[i] >= 0)
+			UpdateNode(child, entries[i]);
+
+		children.push_back(child);
+	}
+
+	m_nodes[dir].children = children;
+}
+
+void ProDOSHostVolume::UpdateNode(const int node, const Entry& entry)
+{
+	const bool bIsDir = m_nodes[node].isDir;
+	const bool bIsXattr = m_nodes[node].isXattr;
+	const bool bRenamed = entry.name != m_nodes[node].name;
+	const bool bRetyped = !bIsDir && (entry.fileType != m_nodes[node].fileType || entry.aux != m_nodes[node].aux);
+
+	// NB. the host name is only rebuilt when needed: "hello world.bas" stays as it is while it's HELLO.WORLD/BAS
+	if (bRenamed || (bRetyped && !bIsXattr))
+	{
+		const std::string hostName = bIsDir ? entry.name : MakeHostName(entry, bIsXattr);
+		if (hostName != m_nodes[node].hostName)
+		{
+			const std::filesystem::path from = GetHostPath(node);
+			const std::filesystem::path to = from.parent_path() / hostName;
+
+			std::error_code ec;
+			if (std::filesystem::exists(to, ec))
+			{
+				LogFileOutput("ProDOS host volume: can't rename %s: %s exists\n", from.string().c_str(), to.string().c_str());
+			}
+			else
+			{
+				CloseHostFile(node);
+				std::filesystem::rename(from, to, ec);
+				if (!ec)
+					m_nodes[node].hostName = hostName;
+			}
+		}
+
+	}
+
+	m_nodes[node].name = entry.name;
+	m_nodes[node].fileType = entry.fileType;
+	m_nodes[node].aux = entry.aux;
+
+	if (bRetyped && bIsXattr)
+		SetXattr(node);
+
+	m_nodes[node].access = entry.access;
+
+	if (bIsDir)
+		return;
+
+	const Node& n = m_nodes[node];
+	bool bChanged = entry.keyBlock != n.keyBlock || entry.storageType != n.storageType || entry.eof != n.eof || entry.blocksUsed != n.blocksUsed;
+
+	if (!bChanged && !m_dirtyBlocks.empty())
+	{
+		std::vector<WORD> dataBlocks, indexBlocks;
+		GetFileBlocks(entry, dataBlocks, indexBlocks);
+		for (const WORD block : dataBlocks)
+			bChanged |= m_dirtyBlocks.find(block) != m_dirtyBlocks.end();
+		for (const WORD block : indexBlocks)
+			bChanged |= m_dirtyBlocks.find(block) != m_dirtyBlocks.end();
+	}
+
+	if (bChanged)
+		WriteHostFile(node, entry);
+}
+
+int ProDOSHostVolume::CreateNode(const int dir, const Entry& entry)
+{
+	Node node = Node();
+	node.name = entry.name;
+	node.parent = dir;
+	node.isDir = entry.storageType == PRODOS_KIND_DIR;
+	node.storageType = entry.storageType;
+	node.fileType = entry.fileType;
+	node.aux = entry.aux;
+	node.access = entry.access;
+	node.keyBlock = entry.keyBlock;
+	node.blocksUsed = entry.blocksUsed;
+	node.eof = entry.eof;
+	node.isListed = true;
+	node.hostName = node.isDir ? entry.name : MakeHostName(entry, false);
+
+	const std::filesystem::path hostPath = std::filesystem::path(GetHostPath(dir)) / node.hostName;
+
+	std::error_code ec;
+	if (std::filesystem::exists(hostPath, ec))
+	{
+		LogFileOutput("ProDOS host volume: can't create %s: it exists\n", hostPath.string().c_str());
+		return -1;
+	}
+
+	const int index = (int)m_nodes.size();
+	m_nodes.push_back(node);
+
+	if (node.isDir)
+	{
+		std::filesystem::create_directory(hostPath, ec);
+		SyncDirectory(index);
+	}
+	else
+	{
+		WriteHostFile(index, entry);
+	}
+
+	return index;
+}
+
+void ProDOSHostVolume::RemoveNode(const int node)
+{
+	const std::filesystem::path hostPath = GetHostPath(node);
+
+	// NB. ProDOS only deletes empty directories: a host directory with skipped files stays
+	std::error_code ec;
+	CloseHostFile(node);
+	if (!std::filesystem::remove(hostPath, ec))
+		LogFileOutput("ProDOS host volume: can't delete %s\n", hostPath.string().c_str());
+
+	MarkDeleted(node);
+}
+
+void ProDOSHostVolume::MarkDeleted(const int node)
+{
+	Node& n = m_nodes[node];
+
+	if (n.isGenerated)
+	{
+		m_ranges.erase(n.keyBlock);
+		for (UINT i = 0; i < n.blocksUsed; i++)
+			m_cache.erase((WORD)(n.keyBlock + i));
+	}
+
+	for (const WORD block : n.dirBlocks)
+		m_dirBlocks.erase(block);
+
+	n.isDeleted = true;
+	n.isGenerated = false;
+
+	const std::vector<int> children = n.children;
+	for (const int child : children)
+		MarkDeleted(child);
+}
+
+//-----------------------------------------------------------------------------
+
+// Data blocks (0 = sparse) & index blocks of a file, as seen by the guest
+void ProDOSHostVolume::GetFileBlocks(const Entry& entry, std::vector<WORD>& dataBlocks, std::vector<WORD>& indexBlocks)
+{
+	const UINT numDataBlocks = GetNumDataBlocks(std::min<UINT>(entry.eof, MAX_EOF));
+	BYTE block[PRODOS_BLOCK_SIZE];
+
+	if (entry.storageType == PRODOS_KIND_SEED)
+	{
+		dataBlocks.push_back(entry.keyBlock);
+		return;
+	}
+
+	std::vector<WORD> indexes;
+	if (entry.storageType == PRODOS_KIND_SAPL)
+	{
+		indexes.push_back(entry.keyBlock);
+	}
+	else
+	{
+		indexBlocks.push_back(entry.keyBlock);
+		GetBlock(entry.keyBlock, block);
+		for (UINT group = 0; group * 256 < numDataBlocks && group < 128; group++)
+			indexes.push_back((WORD)ProDOS_GetIndexBlock(block, 0, group));
+	}
+
+	for (const WORD index : indexes)
+	{
+		if (index)
+		{
+			indexBlocks.push_back(index);
+			GetBlock(index, block);
+		}
+		else
+		{
+			memset(block, 0, sizeof(block));	// sparse
+		}
+
+		for (UINT i = 0; i < 256 && dataBlocks.size() < numDataBlocks; i++)
+			dataBlocks.push_back((WORD)ProDOS_GetIndexBlock(block, 0, i));
+	}
+}
+
+void ProDOSHostVolume::WriteHostFile(const int node, const Entry& entry)
+{
+	// NB. before overwriting the host file the blocks are generated from
+	Detach(node);
+
+	std::vector<WORD> dataBlocks, indexBlocks;
+	GetFileBlocks(entry, dataBlocks, indexBlocks);
+
+	const UINT eof = std::min<UINT>(entry.eof, MAX_EOF);
+	std::vector<BYTE> content(eof, 0);
+	BYTE block[PRODOS_BLOCK_SIZE];
+
+	for (size_t i = 0; i < dataBlocks.size(); i++)
+	{
+		const UINT offset = (UINT)i * PRODOS_BLOCK_SIZE;
+		if (!dataBlocks[i] || dataBlocks[i] >= TOTAL_BLOCKS || offset >= eof)
+			continue;
+
+		GetBlock(dataBlocks[i], block);
+		memcpy(&content[offset], block, std::min<UINT>(PRODOS_BLOCK_SIZE, eof - offset));
+		m_dirtyBlocks.erase(dataBlocks[i]);
+	}
+
+	for (const WORD index : indexBlocks)
+		m_dirtyBlocks.erase(index);
+
+	const std::filesystem::path hostPath = GetHostPath(node);
+	std::ofstream file(hostPath, std::ios::binary | std::ios::trunc);
+	file.write((const char*)content.data(), content.size());
+	if (!file)
+		LogFileOutput("ProDOS host volume: can't write %s\n", hostPath.string().c_str());
+
+	Node& n = m_nodes[node];
+	n.storageType = entry.storageType;
+	n.keyBlock = entry.keyBlock;
+	n.blocksUsed = entry.blocksUsed;
+	n.eof = entry.eof;
+}
+
+std::string ProDOSHostVolume::MakeHostName(const Entry& entry, const bool bIsXattr) const
+{
+	if (bIsXattr)
+		return entry.name;
+
+	for (const FileTypeExt& fileTypeExt : g_fileTypeExts)
+	{
+		if (entry.fileType == fileTypeExt.type && entry.aux == fileTypeExt.aux)
+			return entry.name + fileTypeExt.ext;
+	}
+
+	return StrFormat("%s#%02X%04X", entry.name.c_str(), entry.fileType, entry.aux);
+}
+
+void ProDOSHostVolume::SetXattr(const int node)
+{
+#ifdef __linux__
+	const std::string value = StrFormat("%02X%04X", m_nodes[node].fileType, m_nodes[node].aux);
+	if (setxattr(GetHostPath(node).c_str(), XATTR_PRODOS_TYPE, value.c_str(), value.size(), 0))
+		LogFileOutput("ProDOS host volume: can't set the type of %s\n", GetHostPath(node).c_str());
+#endif
+}
+
+#else
+
+// No std::filesystem: a host directory is never recognised (see IsHostDirectory()), so these are never used
+
+ProDOSHostVolume::ProDOSHostVolume(const std::string& pathname, const bool bWriteProtected)
+	: m_root(pathname)
+	, m_bWriteProtected(bWriteProtected)
+	, m_bitmapBlock(0)
+	, m_nextFree(0)
+	, m_bListedAll(false)
+	, m_hostFileNode(-1)
+{
+	memset(m_bootBlocks, 0, sizeof(m_bootBlocks));
+}
+
+ProDOSHostVolume::~ProDOSHostVolume(void)
+{
+}
+
+bool ProDOSHostVolume::IsHostDirectory(const std::string& pathname)
+{
+	return false;
+}
+
+bool ProDOSHostVolume::ReadBlock(const UINT nBlock, LPBYTE pBlockBuffer)
+{
+	return false;
+}
+
+bool ProDOSHostVolume::WriteBlock(const UINT nBlock, const BYTE* pBlockBuffer)
+{
+	return false;
+}
+
+void ProDOSHostVolume::Flush(void)
+{
+}
+
+size_t ProDOSHostVolume::GetNumListedDirectories(void) const
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,159 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2014, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// A ProDOS volume synthesised from a host directory, for the hard disk card.
+//
+// Blocks are generated on demand:
+// . mounting only lists the root directory; a sub-directory is listed (and its files allocated) when its blocks are first read
+// . the volume bitmap is only exact once everything is listed, so reading it (or the 1st write) lists the whole tree
+// . directory & index blocks are built from the ProDOS_FileSystem.h structures and cached, data blocks are read from the host files
+//
+// File types come from (in order):
+// . a CiderPress style "NAME#TTAAAA" suffix (type & aux in hex)
+// . the "user.prodos.type" extended attribute ("TTAAAA"), on Linux
+// . the extension: .bas, .int, .bin, .sys, .txt
+// . else BIN
+//
+// Blocks written by the guest are kept in memory. Whenever a directory block is written, that directory is synced back
+// to the host: renamed, deleted & new entries, and the files whose entry or data blocks changed are rewritten.
+// New host files are named "NAME#TTAAAA", unless the type matches one of the extensions.
+//
+// Needs std::filesystem (C++17): otherwise IsHostDirectory() is always false, so no host volume is ever created.
+
+class ProDOSHostVolume
+{
+public:
+	ProDOSHostVolume(const std::string& pathname, const bool bWriteProtected);
+	~ProDOSHostVolume(void);	// Flush()
+
+	bool ReadBlock(const UINT nBlock, LPBYTE pBlockBuffer);
+	bool WriteBlock(const UINT nBlock, const BYTE* pBlockBuffer);
+	void Flush(void);
+
+	UINT GetNumBlocks(void) const { return TOTAL_BLOCKS; }
+	size_t GetNumListedDirectories(void) const;
+
+	static bool IsHostDirectory(const std::string& pathname);
+	static void GetFileType(const std::string& hostPath, std::string& name, BYTE& type, WORD& aux, bool& bIsXattr);
+
+	static const UINT TOTAL_BLOCKS = 65535;
+
+private:
+	static const UINT BLOCK_SIZE = 512;
+	static const UINT ENTRY_LEN = 0x27;
+	static const UINT ENTRIES_PER_BLOCK = 13;
+	static const UINT BITMAP_BLOCKS = (TOTAL_BLOCKS + 4095) / 4096;
+	static const UINT MIN_ROOT_BLOCKS = 4;
+	static const UINT MAX_EOF = 0xFFFFFF;
+	static const BYTE TYPE_DIR = 0x0F;
+
+	struct Node
+	{
+		std::string hostName;		// in the parent's host directory
+		std::string name;			// ProDOS
+		int parent;					// -1: root
+		bool isDir;
+		bool isDeleted;
+		bool isXattr;				// type & aux stored in the xattr
+		BYTE storageType;
+		BYTE fileType;
+		WORD aux;
+		BYTE access;
+		UINT eof;
+		WORD date, time;
+		WORD keyBlock;				// 0: not allocated
+		WORD blocksUsed;
+		WORD entryBlock;			// parent directory block & entry number (1-13) of the generated entry
+		BYTE entryNumber;
+		bool isGenerated;			// blocks [keyBlock, keyBlock+blocksUsed) are generated, else they're in m_written
+		// directories
+		bool isListed;
+		std::vector<std::string> pending;	// host entries seen when the parent was listed (the directory is sized from these)
+		std::vector<int> children;			// in entry order
+		std::vector<WORD> dirBlocks;
+	};
+
+	struct Entry
+	{
+		BYTE storageType;
+		std::string name;
+		BYTE fileType;
+		WORD keyBlock;
+		WORD blocksUsed;
+		UINT eof;
+		WORD aux;
+		BYTE access;
+	};
+
+	std::string GetHostPath(const int node) const;
+	bool Allocate(Node& node, const UINT numBlocks);
+	void RegisterNode(const int node);
+	int AddNode(const int parent, const std::string& hostName, std::unordered_set<std::string>& names);
+	void ListDirectory(const int dir);
+	void ListAll(void);
+
+	int GetGeneratedNode(const UINT nBlock) const;
+	void GetBlock(const UINT nBlock, BYTE* pBlock);
+	void GenerateBlock(const UINT nBlock, BYTE* pBlock);
+	void GenerateDirBlock(const int dir, const UINT index, BYTE* pBlock);
+	void GenerateFileBlock(const int file, const UINT index, BYTE* pBlock);
+	void ReadHostData(const int file, const UINT dataBlock, BYTE* pBlock);
+	void CloseHostFile(const int node);
+	void Detach(const int node);
+
+	void ReadDirectory(const int dir, std::vector<Entry>& entries);
+	void SyncDirectory(const int dir);
+	void UpdateNode(const int node, const Entry& entry);
+	int CreateNode(const int dir, const Entry& entry);
+	void RemoveNode(const int node);
+	void MarkDeleted(const int node);
+	void GetFileBlocks(const Entry& entry, std::vector<WORD>& dataBlocks, std::vector<WORD>& indexBlocks);
+	void WriteHostFile(const int node, const Entry& entry);
+	std::string MakeHostName(const Entry& entry, const bool bIsXattr) const;
+	void SetXattr(const int node);
+
+	std::string m_root;
+	bool m_bWriteProtected;
+	std::vector<Node> m_nodes;				// [0] = root
+	std::map<WORD, int> m_ranges;			// 1st block -> node, for the generated blocks
+	std::unordered_map<WORD, int> m_dirBlocks;	// directory block -> directory
+	std::unordered_map<WORD, std::vector<BYTE>> m_cache;	// generated directory & index blocks
+	std::unordered_map<WORD, std::vector<BYTE>> m_written;	// guest blocks
+	std::set<WORD> m_dirtyBlocks;			// written data & index blocks, not synced yet
+	UINT m_bitmapBlock;
+	UINT m_nextFree;
+	bool m_bListedAll;
+	BYTE m_bootBlocks[2 * BLOCK_SIZE];
+
+	std::ifstream m_hostFile;				// last data read
+	int m_hostFileNode;
+};
@@ -0,0 +1,735 @@
+/*
+  AppleWin : An Apple //e emulator for Windows
+
+  Copyright (C) 1994-1996, Michael O'Brien
+  Copyright (C) 1999-2001, Oliver Schmidt
+  Copyright (C) 2002-2005, Tom Charlesworth
+  Copyright (C) 2006-2024, Tom Charlesworth, Michael Pohoreski
+
+  AppleWin is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  AppleWin is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with AppleWin; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+/*
+  ProgramLoader.cpp
+
+  Load a program straight into main memory (via MemGetMainPtr), instead of booting a disk or pasting a listing:
+  . binary (B) & ProDOS system (SYS) programs are copied to their load address, and optionally run by setting PC
+  . Applesoft listings are tokenized here, and tokenized Applesoft programs are relinked;
+    then TXTTAB/VARTAB/etc are fixed up as if the program had been LOADed
+  . tokenized Integer BASIC programs are copied to just below HIMEM, and PP/PV are fixed up
+  . Integer BASIC listings are typed in via the keyboard, as Integer BASIC picks its tokens from the ROM's syntax tables
+  . assembly sources are assembled by the debugger's source assembler, and their labels go to its SYMSRC table
+
+  The type comes from the filename:
+  . CiderPress-style "#TTAAAA" suffix (TT = ProDOS file type, AAAA = aux type, ie. the load address for B files)
+  . else the extension: .bin .sys/.system .bas .int (.bas/.int can be a listing or tokenized) .s/.asm
+*/
+
+#include "StdAfx.h"
+
+#include "ProgramLoader.h"
+
+#include "Core.h"
+#include "CPU.h"
+#include "Keyboard.h"
+#include "Log.h"
+#include "Memory.h"
+#include "StrFormat.h"
+#include "Debugger/Debug.h"
+
+#include <map>
+#include <mutex>
+
+// Applesoft zero page
+#define AS_TXTTAB	0x67	// start of program
+#define AS_VARTAB	0x69	// start of simple variables
+#define AS_ARYTAB	0x6B	// start of arrays
+#define AS_STREND	0x6D	// end of arrays
+#define AS_FRETOP	0x6F	// bottom of strings
+#define AS_MEMSIZ	0x73	// HIMEM
+#define AS_PRGEND	0xAF	// end of program
+
+// Integer BASIC zero page
+#define IB_LOMEM	0x4A
+#define IB_HIMEM	0x4C
+#define IB_PP		0xCA	// start of program
+#define IB_PV		0xCC	// end of variables
+
+#define DEFAULT_BINARY_ADDR		0x0800
+#define DEFAULT_SYSTEM_ADDR		0x2000
+#define DEFAULT_APPLESOFT_ADDR	0x0801
+#define DEFAULT_INTEGER_HIMEM	0x9600
+#define DEFAULT_INTEGER_LOMEM	0x0800
+
+#define KEYBOARD_WAIT_READS		1000	// # of $C000 reads before a queued load (with bWaitForKeyboard) is done
+
+// $80..$EA
+static const char* const g_aApplesoftTokens[] =
+{
+	"END", "FOR", "NEXT", "DATA", "INPUT", "DEL", "DIM", "READ",
+	"GR", "TEXT", "PR#", "IN#", "CALL", "PLOT", "HLIN", "VLIN",
+	"HGR2", "HGR", "HCOLOR=", "HPLOT", "DRAW", "XDRAW", "HTAB", "HOME",
+	"ROT=", "SCALE=", "SHLOAD", "TRACE", "NOTRACE", "NORMAL", "INVERSE", "FLASH",
+	"COLOR=", "POP", "VTAB", "HIMEM:", "LOMEM:", "ONERR", "RESUME", "RECALL",
+	"STORE", "SPEED=", "LET", "GOTO", "RUN", "IF", "RESTORE", "&",
+	"GOSUB", "RETURN", "REM", "STOP", "ON", "WAIT", "LOAD", "SAVE",
+	"DEF", "POKE", "PRINT", "CONT", "LIST", "CLEAR", "GET", "NEW",
+	"TAB(", "TO", "FN", "SPC(", "THEN", "AT", "NOT", "STEP",
+	"+", "-", "*", "/", "^", "AND", "OR", ">",
+	"=", "<", "SGN", "INT", "ABS", "USR", "FRE", "SCRN(",
+	"PDL", "POS", "SQR", "RND", "LOG", "EXP", "COS", "SIN",
+	"TAN", "ATN", "PEEK", "LEN", "STR$", "VAL", "ASC", "CHR$",
+	"LEFT$", "RIGHT$", "MID$",
+};
+
+enum
+{
+	AS_TOKEN_DATA = 0x83,
+	AS_TOKEN_REM = 0xB2,
+	AS_TOKEN_PRINT = 0xBA,
+	AS_TOKEN_AT = 0xC5,
+	AS_TOKEN_ATN = 0xE1,
+};
+
+//===========================================================================
+
+// CiderPress-style "NAME#TTAAAA" suffix
+static bool ProgramLoader_GetFileTypeSuffix(const std::string& name, BYTE& fileType, WORD& auxType)
+{
+	const size_t pos = name.find_last_of('#');
+	if (pos == std::string::npos || name.size() - pos != 7)
+		return false;
+
+	const std::string hex = name.substr(pos + 1);
+	if (hex.find_first_not_of("0123456789ABCDEFabcdef") != std::string::npos)
+		return false;
+
+	const UINT value = strtoul(hex.c_str(), NULL, 16);
+	fileType = (BYTE)(value >> 16);
+	auxType = (WORD)value;
+	return true;
+}
+
+static bool ProgramLoader_HasExtension(const std::string& name, const char* ext)
+{
+	const size_t len = strlen(ext);
+	return name.size() > len && _stricmp(name.c_str() + name.size() - len, ext) == 0;
+}
+
+static bool ProgramLoader_IsText(const std::vector<BYTE>& data)
+{
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		const BYTE c = data[i];
+		if (c != '\t' && c != '\n' && c != '\r' && (c < 0x20 || c > 0x7E))
+			return false;
+	}
+	return !data.empty();
+}
+
+ProgramType_e ProgramLoader_GetType(const std::string& name, const std::vector<BYTE>& data)
+{
+	BYTE fileType;
+	WORD auxType;
+	if (ProgramLoader_GetFileTypeSuffix(name, fileType, auxType))
+	{
+		switch (fileType)
+		{
+		case 0x04: return PROGRAM_APPLESOFT_SOURCE;	// TXT
+		case 0x06: return PROGRAM_BINARY;			// BIN
+		case 0xFA: return PROGRAM_INTEGER;			// INT
+		case 0xFC: return PROGRAM_APPLESOFT;		// BAS
+		case 0xFF: return PROGRAM_SYSTEM;			// SYS
+		default:   return PROGRAM_UNKNOWN;
+		}
+	}
+
+	if (ProgramLoader_HasExtension(name, ".bin"))
+		return PROGRAM_BINARY;
+	if (ProgramLoader_HasExtension(name, ".sys") || ProgramLoader_HasExtension(name, ".system"))
+		return PROGRAM_SYSTEM;
+	if (ProgramLoader_HasExtension(name, ".bas"))
+		return ProgramLoader_IsText(data) ? PROGRAM_APPLESOFT_SOURCE : PROGRAM_APPLESOFT;
+	if (ProgramLoader_HasExtension(name, ".int"))
+		return ProgramLoader_IsText(data) ? PROGRAM_INTEGER_SOURCE : PROGRAM_INTEGER;
+	if (ProgramLoader_HasExtension(name, ".s") || ProgramLoader_HasExtension(name, ".asm"))
+		return PROGRAM_ASSEMBLY_SOURCE;
+
+	return PROGRAM_UNKNOWN;
+}
+
+// NB. ".bin" is also a DOS-order disk image extension, but a binary program can't be bigger than 48K
+bool ProgramLoader_IsProgramFile(const std::string& pathname)
+{
+	BYTE fileType;
+	WORD auxType;
+	if (ProgramLoader_GetFileTypeSuffix(pathname, fileType, auxType))
+		return true;
+
+	if (ProgramLoader_HasExtension(pathname, ".bin"))
+	{
+		FILE* fp = fopen(pathname.c_str(), "rb");
+		if (!fp)
+			return false;
+		fseek(fp, 0, SEEK_END);
+		const long size = ftell(fp);
+		fclose(fp);
+		return size > 0 && size <= APPLE_IO_BEGIN;
+	}
+
+	return ProgramLoader_HasExtension(pathname, ".sys") || ProgramLoader_HasExtension(pathname, ".system")
+		|| ProgramLoader_HasExtension(pathname, ".bas") || ProgramLoader_HasExtension(pathname, ".int")
+		|| ProgramLoader_HasExtension(pathname, ".s") || ProgramLoader_HasExtension(pathname, ".asm");
+}
+
+//===========================================================================
+
+static WORD ProgramLoader_ReadWord(const WORD addr)
+{
+	return *MemGetMainPtr(addr) | (*MemGetMainPtr(addr + 1) << 8);
+}
+
+static void ProgramLoader_WriteWord(const WORD addr, const WORD value)
+{
+	*MemGetMainPtr(addr) = value & 0xFF;
+	*MemGetMainPtr(addr + 1) = value >> 8;
+	memdirty[addr >> 8] = 0xFF;
+}
+
+static bool ProgramLoader_WriteMemory(const WORD addr, const std::vector<BYTE>& data, std::string& strError)
+{
+	if (data.empty())
+	{
+		strError = "Program is empty";
+		return false;
+	}
+
+	if (addr + data.size() > APPLE_IO_BEGIN)
+	{
+		strError = StrFormat("Program doesn't fit in memory: $%04X-$%04X", addr, (UINT)(addr + data.size() - 1));
+		return false;
+	}
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		const WORD a = addr + (WORD)i;
+		*MemGetMainPtr(a) = data[i];
+		memdirty[a >> 8] = 0xFF;
+	}
+
+	return true;
+}
+
+//===========================================================================
+
+// Tokenize like Applesoft's PARSE: spaces are dropped except in strings, DATA & REM; keywords are matched ignoring spaces
+static bool ProgramLoader_TokenizeApplesoftLine(const std::string& line, WORD& lineNumber, std::vector<BYTE>& tokens)
+{
+	size_t i = 0;
+	const size_t n = line.size();
+
+	UINT number = 0;
+	bool bHasNumber = false;
+	for (; i < n; i++)
+	{
+		if (line[i] == ' ')
+			continue;
+		if (line[i] < '0' || line[i] > '9')
+			break;
+		number = number * 10 + (line[i] - '0');
+		bHasNumber = true;
+		if (number > 63999)
+			return false;
+	}
+
+	if (!bHasNumber)
+		return false;
+	lineNumber = (WORD)number;
+
+	bool bData = false;
+	while (i < n)
+	{
+		char c = line[i];
+
+		if (c == '"')
+		{
+			do
+			{
+				tokens.push_back(line[i++]);
+			}
+			while (i < n && line[i] != '"');
+			if (i < n)
+				tokens.push_back(line[i++]);
+			continue;
+		}
+
+		if (bData)
+		{
+			if (c == ':')
+				bData = false;
+			tokens.push_back(c);
+			i++;
+			continue;
+		}
+
+		if (c == ' ')
+		{
+			i++;
+			continue;
+		}
+
+		if (c == '?')
+		{
+			tokens.push_back(AS_TOKEN_PRINT);
+			i++;
+			continue;
+		}
+
+		if (c >= '0' && c <= ';')
+		{
+			tokens.push_back(c);
+			i++;
+			continue;
+		}
+
+		BYTE token = 0;
+		size_t end = i;
+		for (UINT t = 0; t < sizeof(g_aApplesoftTokens) / sizeof(g_aApplesoftTokens[0]) && !token; t++)
+		{
+			const char* keyword = g_aApplesoftTokens[t];
+			size_t j = i;
+			while (*keyword && j < n)
+			{
+				if (line[j] == ' ')
+				{
+					j++;
+					continue;
+				}
+				if (toupper(line[j]) != *keyword)
+					break;
+				keyword++;
+				j++;
+			}
+
+			if (*keyword == 0)
+			{
+				token = 0x80 + t;
+				end = j;
+			}
+		}
+
+		if (token == AS_TOKEN_AT)
+		{
+			// "ATN" wins over "AT", and "ATO" is "A TO" (as Applesoft)
+			size_t j = end;
+			while (j < n && line[j] == ' ')
+				j++;
+			if (j < n && toupper(line[j]) == 'N')
+			{
+				token = AS_TOKEN_ATN;
+				end = j + 1;
+			}
+			else if (j < n && toupper(line[j]) == 'O')
+			{
+				token = 0;
+			}
+		}
+
+		if (!token)
+		{
+			tokens.push_back(toupper(c));
+			i++;
+			continue;
+		}
+
+		tokens.push_back(token);
+		i = end;
+
+		if (token == AS_TOKEN_DATA)
+			bData = true;
+
+		if (token == AS_TOKEN_REM)
+		{
+			while (i < n)
+				tokens.push_back(line[i++]);
+		}
+	}
+
+	return true;
+}
+
+static void ProgramLoader_SplitLines(const std::vector<BYTE>& data, std::vector<std::string>& lines)
+{
+	std::string line;
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		const char c = data[i];
+		if (c == '\r' || c == '\n')
+		{
+			if (c == '\r' && i + 1 < data.size() && data[i + 1] == '\n')
+				i++;
+			lines.push_back(line);
+			line.clear();
+		}
+		else
+		{
+			line += (c == '\t') ? ' ' : c;
+		}
+	}
+
+	if (!line.empty())
+		lines.push_back(line);
+}
+
+static bool ProgramLoader_TokenizeApplesoft(const std::vector<BYTE>& source, const WORD txttab, std::vector<BYTE>& program, std::string& strError)
+{
+	std::vector<std::string> lines;
+	ProgramLoader_SplitLines(source, lines);
+
+	std::map<WORD, std::vector<BYTE>> sortedLines;	// as if typed in: sorted, and a later line replaces an earlier one
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		if (lines[i].find_first_not_of(' ') == std::string::npos)
+			continue;
+
+		WORD lineNumber;
+		std::vector<BYTE> tokens;
+		if (!ProgramLoader_TokenizeApplesoftLine(lines[i], lineNumber, tokens))
+		{
+			strError = StrFormat("Applesoft: bad line number at line %u", (UINT)(i + 1));
+			return false;
+		}
+
+		if (tokens.size() > 239)
+		{
+			strError = StrFormat("Applesoft: line %u is too long", lineNumber);
+			return false;
+		}
+
+		sortedLines[lineNumber] = tokens;
+	}
+
+	WORD addr = txttab;
+	for (std::map<WORD, std::vector<BYTE>>::const_iterator it = sortedLines.begin(); it != sortedLines.end(); ++it)
+	{
+		const WORD next = addr + 2 + 2 + (WORD)it->second.size() + 1;
+		program.push_back(next & 0xFF);
+		program.push_back(next >> 8);
+		program.push_back(it->first & 0xFF);
+		program.push_back(it->first >> 8);
+		program.insert(program.end(), it->second.begin(), it->second.end());
+		program.push_back(0x00);
+		addr = next;
+	}
+
+	program.push_back(0x00);	// end of program
+	program.push_back(0x00);
+	return true;
+}
+
+// Tokenized Applesoft from a file: the line links are for where it was saved from
+static bool ProgramLoader_RelinkApplesoft(std::vector<BYTE>& program, const WORD txttab, std::string& strError)
+{
+	size_t offset = 0;
+	while (offset + 1 < program.size())
+	{
+		if (program[offset] == 0 && program[offset + 1] == 0)
+		{
+			program.resize(offset + 2);
+			return true;
+		}
+
+		size_t end = offset + 4;
+		while (end < program.size() && program[end] != 0)
+			end++;
+		if (end >= program.size())
+			break;
+
+		const WORD next = txttab + (WORD)(end + 1);
+		program[offset] = next & 0xFF;
+		program[offset + 1] = next >> 8;
+		offset = end + 1;
+	}
+
+	if (offset == program.size())	// some files omit the final $0000 link
+	{
+		program.push_back(0x00);
+		program.push_back(0x00);
+		return true;
+	}
+
+	strError = "Applesoft: bad program";
+	return false;
+}
+
+static bool ProgramLoader_LoadApplesoft(std::vector<BYTE> program, const bool bTokenize, std::string& strError)
+{
+	WORD txttab = ProgramLoader_ReadWord(AS_TXTTAB);
+	WORD memsiz = ProgramLoader_ReadWord(AS_MEMSIZ);
+	if (txttab < 0x0801 || txttab >= APPLE_IO_BEGIN)	// Applesoft not initialised (yet)
+		txttab = DEFAULT_APPLESOFT_ADDR;
+	if (memsiz <= txttab || memsiz > APPLE_IO_BEGIN)
+		memsiz = 0x9600;
+
+	if (bTokenize)
+	{
+		std::vector<BYTE> source;
+		source.swap(program);
+		if (!ProgramLoader_TokenizeApplesoft(source, txttab, program, strError))
+			return false;
+	}
+	else if (!ProgramLoader_RelinkApplesoft(program, txttab, strError))
+	{
+		return false;
+	}
+
+	const UINT end = txttab + (UINT)program.size();
+	if (end > memsiz)
+	{
+		strError = StrFormat("Applesoft: program too big ($%04X-$%04X, HIMEM=$%04X)", txttab, end - 1, memsiz);
+		return false;
+	}
+
+	if (!ProgramLoader_WriteMemory(txttab, program, strError))
+		return false;
+
+	*MemGetMainPtr(txttab - 1) = 0x00;
+	memdirty[(txttab - 1) >> 8] = 0xFF;
+	ProgramLoader_WriteWord(AS_TXTTAB, txttab);
+	ProgramLoader_WriteWord(AS_VARTAB, (WORD)end);
+	ProgramLoader_WriteWord(AS_ARYTAB, (WORD)end);
+	ProgramLoader_WriteWord(AS_STREND, (WORD)end);
+	ProgramLoader_WriteWord(AS_PRGEND, (WORD)end);
+	ProgramLoader_WriteWord(AS_FRETOP, memsiz);
+	ProgramLoader_WriteWord(AS_MEMSIZ, memsiz);
+
+	LogFileOutput("ProgramLoader: Applesoft program at $%04X-$%04X\n", txttab, end - 1);
+	return true;
+}
+
+static bool ProgramLoader_LoadInteger(const std::vector<BYTE>& program, std::string& strError)
+{
+	WORD himem = ProgramLoader_ReadWord(IB_HIMEM);
+	WORD lomem = ProgramLoader_ReadWord(IB_LOMEM);
+	if (himem == 0 || himem > APPLE_IO_BEGIN)	// Integer BASIC not initialised (yet)
+		himem = DEFAULT_INTEGER_HIMEM;
+	if (lomem == 0 || lomem >= himem)
+		lomem = DEFAULT_INTEGER_LOMEM;
+
+	if (program.size() > (size_t)(himem - lomem))
+	{
+		strError = StrFormat("Integer BASIC: program too big (%u bytes, LOMEM=$%04X, HIMEM=$%04X)", (UINT)program.size(), lomem, himem);
+		return false;
+	}
+
+	const WORD pp = himem - (WORD)program.size();
+	if (!ProgramLoader_WriteMemory(pp, program, strError))
+		return false;
+
+	ProgramLoader_WriteWord(IB_HIMEM, himem);
+	ProgramLoader_WriteWord(IB_LOMEM, lomem);
+	ProgramLoader_WriteWord(IB_PP, pp);
+	ProgramLoader_WriteWord(IB_PV, lomem);
+
+	LogFileOutput("ProgramLoader: Integer BASIC program at $%04X-$%04X\n", pp, himem - 1);
+	return true;
+}
+
+static bool ProgramLoader_LoadAssembly(const std::string& name, const std::vector<BYTE>& source, const WORD origin, const bool bRun, std::string& strError)
+{
+	SourceAsmResult_t result;
+	if (!SourceAssemble(std::string(source.begin(), source.end()), name, result, origin))
+	{
+		strError = result.aErrors.empty() ? "Assembly failed: " + name : result.aErrors[0];
+		for (size_t i = 1; i < result.aErrors.size(); i++)
+			strError += "\n" + result.aErrors[i];
+		return false;
+	}
+
+	for (size_t i = 0; i < result.aSegments.size(); i++)
+	{
+		if (!ProgramLoader_WriteMemory(result.aSegments[i].nAddress, result.aSegments[i].aBytes, strError))
+			return false;
+	}
+	SourceAssemblerAddSymbols(result, SYMBOLS_SRC_1);
+
+	// for source level debugging: the main file may not be on disk
+	g_SourceInfo.LoadAssembly(result);
+	g_SourceInfo.SetFileText(0, std::string(source.begin(), source.end()));
+
+	LogFileOutput("ProgramLoader: %s assembled, %d bytes in %d segment(s)\n", name.c_str(), result.nBytes, (int)result.aSegments.size());
+	if (bRun && result.nStartAddress >= 0)
+		regs.pc = (WORD)result.nStartAddress;
+	return true;
+}
+
+//===========================================================================
+
+bool ProgramLoader_Load(const std::string& name, const std::vector<BYTE>& data, const int addr, const bool bRun, std::string& strError)
+{
+	const ProgramType_e type = ProgramLoader_GetType(name, data);
+
+	switch (type)
+	{
+	case PROGRAM_BINARY:
+	case PROGRAM_SYSTEM:
+	{
+		BYTE fileType;
+		WORD auxType;
+		WORD loadAddr = (type == PROGRAM_SYSTEM) ? DEFAULT_SYSTEM_ADDR : DEFAULT_BINARY_ADDR;
+		if (addr >= 0)
+			loadAddr = (WORD)addr;
+		else if (type == PROGRAM_BINARY && ProgramLoader_GetFileTypeSuffix(name, fileType, auxType))
+			loadAddr = auxType;
+
+		if (!ProgramLoader_WriteMemory(loadAddr, data, strError))
+			return false;
+
+		LogFileOutput("ProgramLoader: %s at $%04X-$%04X\n", name.c_str(), loadAddr, (UINT)(loadAddr + data.size() - 1));
+		if (bRun)
+			regs.pc = loadAddr;
+		return true;
+	}
+	case PROGRAM_APPLESOFT:
+	case PROGRAM_APPLESOFT_SOURCE:
+		if (!ProgramLoader_LoadApplesoft(data, type == PROGRAM_APPLESOFT_SOURCE, strError))
+			return false;
+		if (bRun)
+			KeybPasteText("RUN\r");
+		return true;
+	case PROGRAM_INTEGER:
+		if (!ProgramLoader_LoadInteger(data, strError))
+			return false;
+		if (bRun)
+			KeybPasteText("RUN\r");
+		return true;
+	case PROGRAM_INTEGER_SOURCE:
+	{
+		std::vector<std::string> lines;
+		ProgramLoader_SplitLines(data, lines);
+
+		std::string text;
+		for (size_t i = 0; i < lines.size(); i++)
+			text += lines[i] + "\r";
+		if (bRun)
+			text += "RUN\r";
+		KeybPasteText(text);
+		return true;
+	}
+	case PROGRAM_ASSEMBLY_SOURCE:
+		return ProgramLoader_LoadAssembly(name, data, addr >= 0 ? (WORD)addr : DEFAULT_BINARY_ADDR, bRun, strError);
+	default:
+		strError = "Unknown program type: " + name;
+		return false;
+	}
+}
+
+static bool ProgramLoader_ReadFile(const std::string& pathname, std::vector<BYTE>& data, std::string& strError)
+{
+	FILE* fp = fopen(pathname.c_str(), "rb");
+	if (!fp)
+	{
+		strError = "Failed to open: " + pathname;
+		return false;
+	}
+
+	BYTE buffer[4096];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+		data.insert(data.end(), buffer, buffer + size);
+
+	fclose(fp);
+	return true;
+}
+
+bool ProgramLoader_LoadFile(const std::string& pathname, const int addr, const bool bRun, std::string& strError)
+{
+	std::vector<BYTE> data;
+	if (!ProgramLoader_ReadFile(pathname, data, strError))
+		return false;
+
+	return ProgramLoader_Load(pathname, data, addr, bRun, strError);
+}
+
+//===========================================================================
+
+struct ProgramLoadRequest
+{
+	std::string name;
+	std::vector<BYTE> data;
+	int addr;
+	bool bRun;
+	bool bWaitForKeyboard;
+	UINT64 keybReadCount;
+};
+
+static std::mutex g_programLoaderMutex;
+static std::vector<ProgramLoadRequest> g_programLoaderQueue;
+
+void ProgramLoader_Queue(const std::string& name, const std::vector<BYTE>& data, const int addr, const bool bRun, const bool bWaitForKeyboard)
+{
+	const ProgramLoadRequest request = { name, data, addr, bRun, bWaitForKeyboard, KeybGetReadCount() };
+
+	std::lock_guard<std::mutex> lock(g_programLoaderMutex);
+	g_programLoaderQueue.push_back(request);
+}
+
+bool ProgramLoader_QueueFile(const std::string& pathname, const int addr, const bool bRun, const bool bWaitForKeyboard, std::string& strError)
+{
+	std::vector<BYTE> data;
+	if (!ProgramLoader_ReadFile(pathname, data, strError))
+		return false;
+
+	if (ProgramLoader_GetType(pathname, data) == PROGRAM_UNKNOWN)
+	{
+		strError = "Unknown program type: " + pathname;
+		return false;
+	}
+
+	ProgramLoader_Queue(pathname, data, addr, bRun, bWaitForKeyboard);
+	return true;
+}
+
+// Called from the emulation thread, between CpuExecute() calls
+void ProgramLoader_Update(void)
+{
+	std::vector<ProgramLoadRequest> ready;
+	{
+		std::lock_guard<std::mutex> lock(g_programLoaderMutex);
+		if (g_programLoaderQueue.empty())
+			return;
+
+		const UINT64 keybReadCount = KeybGetReadCount();
+		std::vector<ProgramLoadRequest>::iterator it = g_programLoaderQueue.begin();
+		while (it != g_programLoaderQueue.end())
+		{
+			if (!it->bWaitForKeyboard || keybReadCount - it->keybReadCount >= KEYBOARD_WAIT_READS)
+			{
+				ready.push_back(*it);
+				it = g_programLoaderQueue.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < ready.size(); i++)
+	{
+		std::string strError;
+		if (!ProgramLoader_Load(ready[i].name, ready[i].data, ready[i].addr, ready[i].bRun, strError))
+			LogFileOutput("ProgramLoader: %s\n", strError.c_str());
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Load programs straight into memory, bypassing disk boot & keyboard paste
+
+enum ProgramType_e
+{
+	PROGRAM_UNKNOWN,
+	PROGRAM_BINARY,				// B: load at an address
+	PROGRAM_SYSTEM,				// SYS: ProDOS system program, load at $2000
+	PROGRAM_APPLESOFT,			// A: tokenized Applesoft
+	PROGRAM_APPLESOFT_SOURCE,	// Applesoft listing (text)
+	PROGRAM_INTEGER,			// I: tokenized Integer BASIC
+	PROGRAM_INTEGER_SOURCE,		// Integer BASIC listing (text)
+	PROGRAM_ASSEMBLY_SOURCE,	// 6502 assembly source (text), see SourceAssemble()
+};
+
+ProgramType_e ProgramLoader_GetType(const std::string& name, const std::vector<BYTE>& data);
+bool ProgramLoader_IsProgramFile(const std::string& pathname);
+
+// addr: -1 for the default load address (binary: from the CiderPress "#06AAAA" filename suffix, else $0800)
+// . assembly source: the address of the code before its first ORG
+bool ProgramLoader_Load(const std::string& name, const std::vector<BYTE>& data, const int addr, const bool bRun, std::string& strError);
+bool ProgramLoader_LoadFile(const std::string& pathname, const int addr, const bool bRun, std::string& strError);
+
+// Thread-safe: the load is done by ProgramLoader_Update() on the emulation thread
+// . bWaitForKeyboard: wait until the guest is polling the keyboard, eg. at the BASIC prompt after booting
+void ProgramLoader_Queue(const std::string& name, const std::vector<BYTE>& data, const int addr, const bool bRun, const bool bWaitForKeyboard);
+bool ProgramLoader_QueueFile(const std::string& pathname, const int addr, const bool bRun, const bool bWaitForKeyboard, std::string& strError);
+void ProgramLoader_Update(void);
@@ -27,8 +27,11 @@ const int SRCOFFS_TOTAL   = (SRCOFFS_DHIRES + 2560);	// 3600
 
 const int MAX_SOURCE_Y = 256;
 static LPBYTE        g_aSourceStartofLine[ MAX_SOURCE_Y ];
+static LPBYTE        g_pSourcePixels = NULL;		// NB. only created when the RGB renderer is first used (most instances never need it)
 #define  SETSOURCEPIXEL(x,y,c)  g_aSourceStartofLine[(y)][(x)] = (c)
 
+static void V_CreateDIBSections(void);
+
 // TC: Tried to remove HiresToPalIndex[] translation table, so get purple bars when hires data is: 0x80 0x80...
 // . V_CreateLookup_HiResHalfPixel_Authentic() uses both ColorMapping (CM_xxx) indices and Color_Palette_Index_e (HGR_xxx)!
 #define DO_OPT_PALETTE 0
@@ -509,6 +512,9 @@ static void MixColorsVertical(int matx, int maty, bool isSWMIXED)
 
 static void CopyMixedSource(int x, int y, int sx, int sy, bgra_t *pVideoAddress)
 {
+	if (!g_pSourcePixels)
+		V_CreateDIBSections();
+
 	const BYTE* const pSrc = g_aSourceStartofLine[ sy ] + sx;
 
 	const int matx = x*14;
@@ -555,6 +561,9 @@ static void CopyMixedSource(int x, int y, int sx, int sy, bgra_t *pVideoAddress)
 // Pre: nSrcAdjustment: for 160-color images, src is +1 compared to dst
 static void CopySource(int w, int h, int sx, int sy, bgra_t *pVideoAddress, const int nSrcAdjustment = 0)
 {
+	if (!g_pSourcePixels)
+		V_CreateDIBSections();
+
 	UINT32* pDst = (UINT32*) pVideoAddress;
 	const BYTE* const pSrc = g_aSourceStartofLine[ sy ] + sx;
 
@@ -1162,12 +1171,14 @@ void UpdateDuochromeCell(int h, int w, bgra_t* pVideoAddress, uint8_t bits, uint
 
 //===========================================================================
 
-static LPBYTE g_pSourcePixels = NULL;
-
 static void V_CreateDIBSections(void)
 {
-	if (!g_pSourcePixels)	// NB. Will be non-zero after a VM restart (GH#809)
-		g_pSourcePixels = new BYTE[SRCOFFS_TOTAL * MAX_SOURCE_Y];
+	// NB. Will be non-zero after a VM restart (GH#809)
+	// . the source image only depends on constants, so keep it rather than redraw it on every restart
+	if (g_pSourcePixels)
+		return;
+
+	g_pSourcePixels = new BYTE[SRCOFFS_TOTAL * MAX_SOURCE_Y];
 
 	// CREATE THE OFFSET TABLE FOR EACH SCAN LINE IN THE SOURCE IMAGE
 	for (int y = 0; y < MAX_SOURCE_Y; y++)
@@ -1185,8 +1196,7 @@ static void V_CreateDIBSections(void)
 
 void VideoInitializeOriginal(baseColors_t pBaseNtscColors)
 {
-	// CREATE THE SOURCE IMAGE AND DRAW INTO THE SOURCE BIT BUFFER
-	V_CreateDIBSections();
+	// NB. The source image is created by CopySource()/CopyMixedSource() on first use
 
 	// Replace the default palette with true NTSC-generated colors
 	memcpy(&PaletteRGB_NTSC[BLACK], *pBaseNtscColors, sizeof(RGBQUAD) * kNumBaseColors);
@@ -1210,6 +1220,13 @@ void VideoSwitchVideocardPalette(RGB_Videocard_e videocard, VideoType_e type)
 
 //===========================================================================
 
+UINT RGB_GetSourceImageSize(void)
+{
+	return g_pSourcePixels ? SRCOFFS_TOTAL * MAX_SOURCE_Y : 0;
+}
+
+//===========================================================================
+
 static UINT g_rgbFlags = 0;
 static UINT g_rgbMode = 0;
 static WORD g_rgbPrevAN3Addr = 0;
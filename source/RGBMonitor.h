@@ -28,6 +28,7 @@ void UpdateHiResRGBCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress);
 const UINT kNumBaseColors = 16;
 typedef bgra_t (*baseColors_t)[kNumBaseColors];
 void VideoInitializeOriginal(baseColors_t pBaseNtscColors);
+UINT RGB_GetSourceImageSize(void);
 void VideoSwitchVideocardPalette(RGB_Videocard_e videocard, VideoType_e type);
 
 void RGB_SetVideoMode(WORD address);
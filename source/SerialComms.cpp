@@ -985,6 +985,11 @@ void CSuperSerialCard::Reset(const bool /* powerCycle */)
 	InternalReset();
 }
 
+void CSuperSerialCard::Update(const ULONG /* nExecutedCycles */)
+{
+	// NB. COM & TCP events are driven by CommThread() & the message pump
+}
+
 //===========================================================================
 
 // dwNewSerialPortItem is the drop-down list item
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "Card.h"
+#include "SynchronousEventManager.h"
+
+#ifndef _WIN32
+#include <memory>
+class SerialBackend;
+#endif
 
 enum {COMMEVT_WAIT=0, COMMEVT_ACK, COMMEVT_TERM, COMMEVT_MAX};
 enum eFWMODE {FWMODE_CIC=0, FWMODE_SIC_P8, FWMODE_PPC, FWMODE_SIC_P8A};	// NB. CIC = SSC
@@ -27,7 +33,7 @@ class CSuperSerialCard : public Card
 public:
 	CSuperSerialCard(UINT slot);
 	virtual ~CSuperSerialCard();
-	virtual void Update(const ULONG nExecutedCycles) {}
+	virtual void Update(const ULONG nExecutedCycles);
 	virtual void InitializeIO(LPBYTE pCxRomPeripheral);
 	virtual void Reset(const bool powerCycle);
 	virtual void Destroy() {}
@@ -40,8 +46,14 @@ public:
 	std::string const& GetSerialPortChoices();
 	DWORD	GetSerialPort() { return m_dwSerialPortItem; }	// Drop-down list item
 	const std::string& GetSerialPortName() { return m_currentSerialPortName; }
+#ifdef _WIN32
 	bool	IsActive() { return (m_hCommHandle != INVALID_HANDLE_VALUE) || (m_hCommListenSocket != INVALID_SOCKET); }
+#else
+	bool	IsActive() { return m_pBackend != NULL; }
+	void	SetTurbo(bool bEnable) { m_bTurbo = bEnable; }	// Ignore the baud rate: transfer as fast as the host allows
+#endif
 	void	SupportDCD(bool bEnable) { m_bCfgSupportDCD = bEnable; }	// Status
+	void	SetSerialPortName(const char* pSerialPortName);
 
 	void	CommTcpSerialAccept();
 	void	CommTcpSerialReceive();
@@ -77,7 +89,6 @@ private:
 	void	CommThUninit();
 	UINT	GetNumSerialPortChoices() { return (UINT) m_vecSerialPortsItems.size(); }
 	void	ScanCOMPorts();
-	void	SetSerialPortName(const char* pSerialPortName);
 	void	SetRegistrySerialPortName(void);
 	void	SaveSnapshotDIPSW(class YamlSaveHelper& yamlSaveHelper, std::string key, SSC_DIPSW& dipsw);
 	void	LoadSnapshotDIPSW(class YamlLoadHelper& yamlLoadHelper, std::string key, SSC_DIPSW& dipsw);
@@ -145,4 +156,23 @@ private:
 	volatile DWORD m_dwModemStatus;	// Updated by CommThread when any of RLSD|DSR|CTS changes / Read by main thread - CommStatus()& CommDipSw()
 
 	UINT m_uRTS;
+
+#ifndef _WIN32
+	// Linux: the host side runs on its own I/O thread (see linux/serialbackend.h)
+	// . the 6551 is paced by the baud rate: a byte takes GetCharacterCycles() to be sent or received
+	static int SyncEventCallback(int id, int cycles, ULONG uExecutedCycles);
+	UINT	GetCharacterCycles(void);
+	void	UpdateTransfers(void);
+	bool	LatchReceivedByte(void);
+	int		GetCyclesToNextTransfer(void);
+	void	ScheduleTransferEvent(void);
+
+	std::shared_ptr<SerialBackend> m_pBackend;
+	SyncEvent m_syncEvent;
+	bool	m_bTurbo;
+	BYTE	m_uRxData;			// 6551 Receive Data Register
+	bool	m_bRxFull;
+	UINT64	m_uRxNextCycle;		// earliest cycle that the next byte can be received
+	UINT64	m_uTxDoneCycle;		// when the byte being sent leaves the shift register
+#endif
 };
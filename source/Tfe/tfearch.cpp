@@ -90,7 +90,7 @@ void TfePcapFreeLibrary(void)
 {
     if (pcap_library) {
         if (!FreeLibrary(pcap_library)) {
-            if(g_fh) fprintf(g_fh, "FreeLibrary WPCAP.DLL failed!\n");
+            LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "FreeLibrary WPCAP.DLL failed!\n");
         }
         pcap_library = NULL;
 
@@ -111,7 +111,7 @@ void TfePcapFreeLibrary(void)
 #define GET_PROC_ADDRESS_AND_TEST( _name_ ) \
     p_##_name_ = (_name_##_t) GetProcAddress(pcap_library, #_name_ ); \
     if (!p_##_name_ ) { \
-        if(g_fh) fprintf(g_fh, "GetProcAddress " #_name_ " failed!\n"); \
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "GetProcAddress " #_name_ " failed!\n"); \
         TfePcapFreeLibrary(); \
         return FALSE; \
     } 
@@ -144,7 +144,7 @@ BOOL TfePcapLoadLibrary(void)
     if (!pcap_library)
     {
         tfe_cannot_use = 1;
-        if(g_fh) fprintf(g_fh, "LoadLibrary WPCAP.DLL failed!\n" );
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "LoadLibrary WPCAP.DLL failed!\n" );
         return FALSE;
     }
 
@@ -265,12 +265,12 @@ int tfe_arch_enumadapter_open(void)
 
     if ((*p_pcap_findalldevs)(&TfePcapAlldevs, TfePcapErrbuf) == -1)
     {
-        if(g_fh) fprintf(g_fh, "ERROR in TfeEnumAdapterOpen: pcap_findalldevs: '%s'\n", TfePcapErrbuf);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "ERROR in TfeEnumAdapterOpen: pcap_findalldevs: '%s'\n", TfePcapErrbuf);
         return 0;
     }
 
 	if (!TfePcapAlldevs) {
-        if(g_fh) fprintf(g_fh, "ERROR in TfeEnumAdapterOpen, finding all pcap devices - "
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "ERROR in TfeEnumAdapterOpen, finding all pcap devices - "
 			"Do we have the necessary privilege rights?\n");
 		return 0;
 	}
@@ -346,27 +346,27 @@ pcap_t * TfePcapOpenAdapter(const std::string & interface_name)
     pcap_t * TfePcapFP = (*p_pcap_open_live)(TfePcapDevice->name, 1700, 1, 20, TfePcapErrbuf);
     if ( TfePcapFP == NULL)
     {
-        if(g_fh) fprintf(g_fh, "ERROR opening adapter: '%s'\n", TfePcapErrbuf);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "ERROR opening adapter: '%s'\n", TfePcapErrbuf);
         tfe_arch_enumadapter_close();
         return NULL;
     }
 
     if ((*p_pcap_setnonblock)(TfePcapFP, 1, TfePcapErrbuf)<0)
     {
-        if(g_fh) fprintf(g_fh, "WARNING: Setting PCAP to non-blocking failed: '%s'\n", TfePcapErrbuf);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING: Setting PCAP to non-blocking failed: '%s'\n", TfePcapErrbuf);
     }
 
 	/* Check the link layer. We support only Ethernet for simplicity. */
 	if((*p_pcap_datalink)(TfePcapFP) != DLT_EN10MB)
 	{
-		if(g_fh) fprintf(g_fh, "ERROR: TFE works only on Ethernet networks.\n");
+		LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "ERROR: TFE works only on Ethernet networks.\n");
 		tfe_arch_enumadapter_close();
         (*p_pcap_close)(TfePcapFP);
         TfePcapFP = NULL;
         return NULL;
 	}
 
-    if(g_fh) fprintf(g_fh, "PCAP: Successfully opened adapter: '%s' (%s)\n", TfePcapDevice->name, TfePcapDevice->description);
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_INFO, "PCAP: Successfully opened adapter: '%s' (%s)\n", TfePcapDevice->name, TfePcapDevice->description);
 
     tfe_arch_enumadapter_close();
     return TfePcapFP;
@@ -386,7 +386,7 @@ void TfePcapCloseAdapter(pcap_t * TfePcapFP)
 void tfe_arch_set_mac( const BYTE mac[6] )
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-    if(g_fh) fprintf( g_fh, "New MAC address set: %02X:%02X:%02X:%02X:%02X:%02X.\n",
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "New MAC address set: %02X:%02X:%02X:%02X:%02X:%02X.\n",
         mac[0], mac[1], mac[2], mac[3], mac[4], mac[5] );
 #endif
 }
@@ -394,7 +394,7 @@ void tfe_arch_set_mac( const BYTE mac[6] )
 void tfe_arch_set_hashfilter(const uint32_t hash_mask[2])
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-    if(g_fh) fprintf( g_fh, "New hash filter set: %08X:%08X.\n",
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "New hash filter set: %08X:%08X.\n",
         hash_mask[1], hash_mask[0]);
 #endif
 }
@@ -404,7 +404,7 @@ void tfe_arch_set_hashfilter(const uint32_t hash_mask[2])
 void tfe_arch_receive_remove_committed_frame(void)
 {
 #ifdef TFE_DEBUG_ARCH
-    if(g_fh) fprintf( g_fh, "tfe_arch_receive_remove_committed_frame().\n" );
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_receive_remove_committed_frame().\n" );
 #endif
 }
 */
@@ -418,15 +418,15 @@ void tfe_arch_recv_ctl( int bBroadcast,   /* broadcast */
                       )
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-	if(g_fh) {
-		fprintf( g_fh, "tfe_arch_recv_ctl() called with the following parameters:" );
-		fprintf( g_fh, "\tbBroadcast   = %s", bBroadcast   ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\tbIA          = %s", bIA          ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\tbMulticast   = %s", bMulticast   ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\tbCorrect     = %s", bCorrect     ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\tbPromiscuous = %s", bPromiscuous ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\tbIAHash      = %s", bIAHash      ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\n" );
+	if (LogIsEnabled(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG)) {
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_recv_ctl() called with the following parameters:" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbBroadcast   = %s", bBroadcast   ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbIA          = %s", bIA          ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbMulticast   = %s", bMulticast   ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbCorrect     = %s", bCorrect     ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbPromiscuous = %s", bPromiscuous ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbIAHash      = %s", bIAHash      ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\n" );
 	}
 #endif
 }
@@ -434,11 +434,11 @@ void tfe_arch_recv_ctl( int bBroadcast,   /* broadcast */
 void tfe_arch_line_ctl(int bEnableTransmitter, int bEnableReceiver )
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-	if(g_fh) {
-		fprintf( g_fh, "tfe_arch_line_ctl() called with the following parameters:" );
-		fprintf( g_fh, "\tbEnableTransmitter = %s", bEnableTransmitter ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\tbEnableReceiver    = %s", bEnableReceiver    ? "TRUE" : "FALSE" );
-		fprintf( g_fh, "\n" );
+	if (LogIsEnabled(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG)) {
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_line_ctl() called with the following parameters:" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbEnableTransmitter = %s", bEnableTransmitter ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbEnableReceiver    = %s", bEnableReceiver    ? "TRUE" : "FALSE" );
+		LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\n" );
 	}
 #endif
 }
@@ -495,7 +495,7 @@ int tfe_arch_receive_frame(pcap_t * TfePcapFP, TFE_PCAP_INTERNAL *pinternal)
     }
 
 #ifdef TFE_DEBUG_ARCH
-    if(g_fh) fprintf( g_fh, "tfe_arch_receive_frame() called, returns %d (%s).\n", ret, error );
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_receive_frame() called, returns %d (%s).\n", ret, error );
 #endif
 
     return ret;
@@ -507,7 +507,7 @@ void tfe_arch_transmit(pcap_t * TfePcapFP,
                       )
 {
 #ifdef TFE_DEBUG_ARCH
-    if(g_fh) fprintf( g_fh, "tfe_arch_transmit() called, with: txlength=%u\n", txlength);
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_transmit() called, with: txlength=%u\n", txlength);
 #endif
 
 #ifdef TFE_DEBUG_PKTDUMP
@@ -515,7 +515,7 @@ void tfe_arch_transmit(pcap_t * TfePcapFP,
 #endif // #ifdef TFE_DEBUG_PKTDUMP
 
     if ((*p_pcap_sendpacket)(TfePcapFP, txframe, txlength) == -1) {
-        if(g_fh) fprintf(g_fh, "WARNING! Could not send packet!\n");
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Could not send packet!\n");
     }
 }
 
@@ -552,7 +552,7 @@ int tfe_arch_receive(pcap_t * TfePcapFP,
     TFE_PCAP_INTERNAL internal = { static_cast<unsigned int>(size), pbuffer, 0 };
 
 #ifdef TFE_DEBUG_ARCH
-    if(g_fh) fprintf( g_fh, "tfe_arch_receive() called, with size=%u.\n", size );
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_receive() called, with size=%u.\n", size );
 #endif
 
     assert((size & 1)==0);
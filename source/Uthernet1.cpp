@@ -275,7 +275,7 @@ void Uthernet1::tfe_sideeffects_write_pp_on_txframe(WORD ppaddress)
             ||  (txlen<MIN_TXLENGTH)
            ) {
 #ifdef TFE_DEBUG_WARN
-            if(g_fh) fprintf(g_fh, "WARNING! Should send %u octets: Not allowed, thus ignoring!\n", txlen);
+            LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Should send %u octets: Not allowed, thus ignoring!\n", txlen);
 #endif
         }
         else {
@@ -283,7 +283,7 @@ void Uthernet1::tfe_sideeffects_write_pp_on_txframe(WORD ppaddress)
             SET_PP_16(TFE_PP_ADDR_SE_BUSST, busst & ~0x180);
 
 #ifdef TFE_DEBUG_FRAMES
-            if(g_fh) fprintf(g_fh, "tfe_arch_transmit() called with:                 "
+            LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_transmit() called with:                 "
                 "length=%4u and buffer %s", txlen,
                 debug_outbuffer(txlen, &tfe_packetpage[TFE_PP_ADDR_TX_FRAMELOC]).c_str()
                 );
@@ -361,13 +361,13 @@ void Uthernet1::tfe_sideeffects_write_pp(WORD ppaddress, int oddaddress)
 
     case TFE_PP_ADDR_SE_RXEVENT:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Written read-only register TFE_PP_ADDR_SE_RXEVENT: IGNORED\n");
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Written read-only register TFE_PP_ADDR_SE_RXEVENT: IGNORED\n");
 #endif
         break;
 
     case TFE_PP_ADDR_SE_BUSST:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Written read-only register TFE_PP_ADDR_SE_BUSST: IGNORED\n");
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Written read-only register TFE_PP_ADDR_SE_BUSST: IGNORED\n");
 #endif
         break;
 
@@ -378,7 +378,7 @@ void Uthernet1::tfe_sideeffects_write_pp(WORD ppaddress, int oddaddress)
 #ifdef TFE_DEBUG_WARN
         /* check if we had a TXCMD, but not all octets were written */
         if (tfe_started_tx && !oddaddress) {
-            if(g_fh) fprintf(g_fh, "WARNING! Early abort of transmitted frame\n");
+            LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Early abort of transmitted frame\n");
         }
         tfe_started_tx = 1;
 #endif
@@ -462,13 +462,13 @@ void Uthernet1::tfe_sideeffects_read_pp(WORD ppaddress)
 
     case TFE_PP_ADDR_TXCMD:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Read write-only register TFE_PP_ADDR_TXCMD: IGNORED\n");
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Read write-only register TFE_PP_ADDR_TXCMD: IGNORED\n");
 #endif
         break;
 
     case TFE_PP_ADDR_TXLENGTH:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Read write-only register TFE_PP_ADDR_TXLENGTH: IGNORED\n");
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Read write-only register TFE_PP_ADDR_TXLENGTH: IGNORED\n");
 #endif
         break;
     }
@@ -554,7 +554,7 @@ BYTE Uthernet1::tfe_read(WORD ioaddress)
     case TFE_ADDR_TXLENGTH:
     case TFE_ADDR_TXLENGTH+1:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Reading write-only TFE register $%02X!\n", ioaddress);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Reading write-only TFE register $%02X!\n", ioaddress);
 #endif
         /* @SRT TODO: Verify with reality */
         retval = GET_TFE_8(ioaddress);
@@ -565,7 +565,7 @@ BYTE Uthernet1::tfe_read(WORD ioaddress)
     case TFE_ADDR_PP_DATA2:
     case TFE_ADDR_PP_DATA2+1:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Reading not supported TFE register $%02X!\n", ioaddress);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Reading not supported TFE register $%02X!\n", ioaddress);
 #endif
         /* @SRT TODO */
         retval = GET_TFE_8(ioaddress);
@@ -586,7 +586,7 @@ BYTE Uthernet1::tfe_read(WORD ioaddress)
 
 
 #ifdef TFE_DEBUG_LOAD
-        if(g_fh) fprintf(g_fh, "reading PP Ptr: $%04X => $%04X.",
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "reading PP Ptr: $%04X => $%04X.",
             tfe_packetpage_ptr, GET_PP_16(tfe_packetpage_ptr) );
 #endif
 
@@ -614,7 +614,7 @@ BYTE Uthernet1::tfe_read(WORD ioaddress)
     };
 
 #ifdef TFE_DEBUG_LOAD
-    if(g_fh) fprintf(g_fh, "read [$%02X] => $%02X.", ioaddress, retval);
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "read [$%02X] => $%02X.", ioaddress, retval);
 #endif
     return retval;
 }
@@ -634,7 +634,7 @@ void Uthernet1::tfe_store(WORD ioaddress, BYTE byte)
     case TFE_ADDR_INTSTQUEUE:
     case TFE_ADDR_INTSTQUEUE+1:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Writing read-only TFE register $%02X!\n", ioaddress);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Writing read-only TFE register $%02X!\n", ioaddress);
 #endif
         /* @SRT TODO: Verify with reality */
         /* do nothing */
@@ -645,7 +645,7 @@ void Uthernet1::tfe_store(WORD ioaddress, BYTE byte)
     case TFE_ADDR_PP_DATA2:
     case TFE_ADDR_PP_DATA2+1:
 #ifdef TFE_DEBUG_WARN
-        if(g_fh) fprintf(g_fh, "WARNING! Writing not supported TFE register $%02X!\n", ioaddress);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! Writing not supported TFE register $%02X!\n", ioaddress);
 #endif
         /* do nothing */
         return;
@@ -690,7 +690,7 @@ void Uthernet1::tfe_store(WORD ioaddress, BYTE byte)
     }
 
 #ifdef TFE_DEBUG_STORE
-    if(g_fh) fprintf(g_fh, "store [$%02X] <= $%02X.", ioaddress, (int)byte);
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "store [$%02X] <= $%02X.", ioaddress, (int)byte);
 #endif
 
     /* now check if we have to do any side-effects */
@@ -701,14 +701,13 @@ void Uthernet1::tfe_store(WORD ioaddress, BYTE byte)
         tfe_packetpage_ptr = GET_TFE_16(TFE_ADDR_PP_PTR);
 
 #ifdef TFE_DEBUG_STORE
-        if(g_fh) fprintf(g_fh, "set PP Ptr to $%04X.", tfe_packetpage_ptr);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "set PP Ptr to $%04X.", tfe_packetpage_ptr);
 #endif
 
         if ((tfe_packetpage_ptr & 1) != 0) {
 
 #ifdef TFE_DEBUG_WARN
-            if(g_fh) fprintf(g_fh,
-                "WARNING! PacketPage register set to odd address $%04X (not allowed!)\n",
+            LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "WARNING! PacketPage register set to odd address $%04X (not allowed!)\n",
                 tfe_packetpage_ptr );
 #endif /* #ifdef TFE_DEBUG_WARN */
 
@@ -735,7 +734,7 @@ void Uthernet1::tfe_store(WORD ioaddress, BYTE byte)
             WORD ppaddress = tfe_packetpage_ptr & (MAX_PACKETPAGE_ARRAY-1);
 
 #ifdef TFE_DEBUG_STORE
-            if(g_fh) fprintf(g_fh, "before writing to PP Ptr: $%04X <= $%04X.",
+            LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "before writing to PP Ptr: $%04X <= $%04X.",
                 ppaddress, GET_PP_16(ppaddress) );
 #endif
             {
@@ -748,7 +747,7 @@ void Uthernet1::tfe_store(WORD ioaddress, BYTE byte)
             tfe_sideeffects_write_pp(ppaddress, ioaddress-TFE_ADDR_PP_DATA);
 
 #ifdef TFE_DEBUG_STORE
-            if(g_fh) fprintf(g_fh, "after  writing to PP Ptr: $%04X <= $%04X.",
+            LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "after  writing to PP Ptr: $%04X <= $%04X.",
                 ppaddress, GET_PP_16(ppaddress) );
 #endif
         }
@@ -764,7 +763,7 @@ void Uthernet1::tfe_store(WORD ioaddress, BYTE byte)
     { \
         int retval = _x_; \
         \
-        if(g_fh) fprintf(g_fh, "%s correct_mac=%u, broadcast=%u, multicast=%u, hashed=%u, hash_index=%u", (retval? "+++ ACCEPTED":"--- rejected"), *pcorrect_mac, *pbroadcast, *pmulticast, *phashed, *phash_index); \
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "%s correct_mac=%u, broadcast=%u, multicast=%u, hashed=%u, hash_index=%u", (retval? "+++ ACCEPTED":"--- rejected"), *pcorrect_mac, *pbroadcast, *pmulticast, *phashed, *phash_index); \
         \
         return retval; \
     }
@@ -792,7 +791,7 @@ int Uthernet1::tfe_should_accept(unsigned char *buffer, int length, int *phashed
     *pmulticast   = 0;
 
 #ifdef TFE_DEBUG_FRAMES
-    if(g_fh) fprintf(g_fh, "tfe_should_accept called with %02X:%02X:%02X:%02X:%02X:%02X, length=%4u and buffer %s",
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_should_accept called with %02X:%02X:%02X:%02X:%02X:%02X, length=%4u and buffer %s",
         tfe_ia_mac[0], tfe_ia_mac[1], tfe_ia_mac[2],
         tfe_ia_mac[3], tfe_ia_mac[4], tfe_ia_mac[5],
         length,
@@ -874,7 +873,7 @@ WORD Uthernet1::tfe_receive(void)
     int  ready;
 
 #ifdef TFE_DEBUG_FRAMES
-    if(g_fh) fprintf( g_fh, "");
+    LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "");
 #endif
 
     do {
@@ -953,7 +952,7 @@ WORD Uthernet1::tfe_receive(void)
 
 #ifdef TFE_DEBUG_FRAMES
     if (ret_val != 0x0004)
-        if(g_fh) fprintf( g_fh, "+++ tfe_receive(): ret_val=%04X", ret_val);
+        LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "+++ tfe_receive(): ret_val=%04X", ret_val);
 #endif
 
     return ret_val;
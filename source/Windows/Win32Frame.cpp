@@ -9,6 +9,7 @@
 #include "Memory.h"
 #include "CardManager.h"
 #include "Debugger/Debug.h"
+#include "Z80VICE/z80.h"
 #include "Tfe/PCapBackend.h"
 #include "DXSoundBuffer.h"
 #include "../resource/resource.h"
@@ -369,6 +370,23 @@ void Win32Frame::Benchmark(void)
 					MB_ICONINFORMATION | MB_SETFOREGROUND);
 		}
 
+	// SAME AGAIN FOR THE Z80 SOFTCARD, RUNNING A CP/M-STYLE LOOP
+	// (REPORTED IN 6502 MHZ, SO IT CAN BE COMPARED WITH THE FIGURE ABOVE)
+	std::string z80mhz = "n/a (no Z80 SoftCard)";
+	if (z80_setup_benchmark())
+	{
+		uint32_t totalz80mhz10 = 0;
+		milliseconds = GetTickCount();
+		while (GetTickCount() == milliseconds);
+		milliseconds = GetTickCount();
+		do {
+			CpuExecute(100000, false);
+			totalz80mhz10++;
+		} while (GetTickCount() - milliseconds < 1000);
+		z80_end_benchmark();
+		z80mhz = StrFormat("%u.%u (Z80, CP/M loop)", (unsigned)(totalz80mhz10 / 10), (unsigned)(totalz80mhz10 % 10));
+	}
+
 	// DO A REALISTIC TEST OF HOW MANY FRAMES PER SECOND WE CAN PRODUCE
 	// WITH FULL EMULATION OF THE CPU, JOYSTICK, AND DISK HAPPENING AT
 	// THE SAME TIME
@@ -408,7 +426,8 @@ void Win32Frame::Benchmark(void)
 		"\n"
 		"Pure Video FPS:\t%u hires, %u text\n"
 		"Pure CPU MHz:\t%u.%u%s (video update)\n"
-		"Pure CPU MHz:\t%u.%u%s (full-speed)\n\n"
+		"Pure CPU MHz:\t%u.%u%s (full-speed)\n"
+		"Pure CPU MHz:\t%s\n\n"
 		"EXPECTED AVERAGE VIDEO GAME\n"
 		"PERFORMANCE: %u FPS",
 		GetAppleWinVersionAndBuild().c_str(),
@@ -417,6 +436,7 @@ void Win32Frame::Benchmark(void)
 		(unsigned)totaltextfps,
 		(unsigned)(totalmhz10[0] / 10), (unsigned)(totalmhz10[0] % 10), (LPCTSTR)(IS_APPLE2 ? " (6502)" : ""),
 		(unsigned)(totalmhz10[1] / 10), (unsigned)(totalmhz10[1] % 10), (LPCTSTR)(IS_APPLE2 ? " (6502)" : ""),
+		z80mhz.c_str(),
 		(unsigned)realisticfps);
 
 	FrameMessageBox(
@@ -28,6 +28,8 @@
 
 #include "../CPU.h"
 #include "../Memory.h"
+#include "../Core.h"
+#include "../CardManager.h"
 #include "../YamlHelper.h"
 
 
@@ -110,6 +112,75 @@ void z80_reset(void)
     im_mode = 0;
 }
 
+/* [AppleWin-TC] CP/M-style benchmark loop: a block move followed by a
+   read-modify-write pass over the moved data, with a CALL/RET per byte. */
+static const BYTE z80_bench_code[] = {
+    0x21, 0x00, 0x20,       /* 0100: LD   HL,$2000 */
+    0x11, 0x00, 0x30,       /* 0103: LD   DE,$3000 */
+    0x01, 0x00, 0x01,       /* 0106: LD   BC,$0100 */
+    0xED, 0xB0,             /* 0109: LDIR          */
+    0x06, 0x40,             /* 010B: LD   B,$40    */
+    0x21, 0x00, 0x20,       /* 010D: LD   HL,$2000 */
+    0x7E,                   /* 0110: LD   A,(HL)   */
+    0xC6, 0x01,             /* 0111: ADD  A,1      */
+    0x77,                   /* 0113: LD   (HL),A   */
+    0x23,                   /* 0114: INC  HL       */
+    0xCD, 0x1C, 0x01,       /* 0115: CALL $011C    */
+    0x10, 0xF6,             /* 0118: DJNZ $0110    */
+    0x18, 0xE4,             /* 011A: JR   $0100    */
+    0xC9                    /* 011C: RET           */
+};
+
+/* Apple $1000-$BFFF is Z80 $0000-$AFFF: the code, the data and the stack */
+#define Z80_BENCH_MEM_BEGIN 0x1000
+#define Z80_BENCH_MEM_SIZE  0xB000
+
+static BYTE z80_bench_saved_mem[Z80_BENCH_MEM_SIZE];
+static z80_regs_t z80_bench_saved_regs;
+static BYTE z80_bench_saved_iff1, z80_bench_saved_iff2, z80_bench_saved_im_mode;
+
+/* false (and nothing touched) without a Z80 SoftCard */
+bool z80_setup_benchmark(void)
+{
+    bool hasZ80Card = false;
+    for (UINT slot = SLOT1; slot < NUM_SLOTS; slot++)
+        hasZ80Card |= GetCardMgr().QuerySlot(slot) == CT_Z80;
+    if (!hasZ80Card)
+        return false;
+
+    for (WORD i = 0; i < Z80_BENCH_MEM_SIZE; i++)
+        z80_bench_saved_mem[i] = ReadByteFromMemory(Z80_BENCH_MEM_BEGIN + i);
+    z80_bench_saved_regs = z80_regs;
+    z80_bench_saved_iff1 = iff1;
+    z80_bench_saved_iff2 = iff2;
+    z80_bench_saved_im_mode = im_mode;
+
+    z80_reset();
+    z80_regs.reg_pc = 0x0100;   /* CP/M TPA */
+    z80_regs.reg_sp = 0x8000;
+
+    /* Z80 $0100 is Apple $1100 (SoftCard remap) */
+    for (WORD i = 0; i < sizeof(z80_bench_code); i++)
+        WriteByteToMemory(0x1100 + i, z80_bench_code[i]);
+
+    SetActiveCpu(CPU_Z80);
+    return true;
+}
+
+/* back to the main CPU, with the memory & Z80 state from before z80_setup_benchmark() */
+void z80_end_benchmark(void)
+{
+    SetActiveCpu(GetMainCpu());
+
+    for (WORD i = 0; i < Z80_BENCH_MEM_SIZE; i++)
+        WriteByteToMemory(Z80_BENCH_MEM_BEGIN + i, z80_bench_saved_mem[i]);
+    z80_regs = z80_bench_saved_regs;
+    z80_reg_pc = z80_regs.reg_pc;
+    iff1 = z80_bench_saved_iff1;
+    iff2 = z80_bench_saved_iff2;
+    im_mode = z80_bench_saved_im_mode;
+}
+
 /*inline*/ static BYTE *z80mem_read_base(int addr)	// [AppleWin-TC]
 {
     BYTE *p = _z80mem_read_base_tab_ptr[addr >> 8];
@@ -134,11 +205,89 @@ void z80_reset(void)
    } while (0)
 
 
+/* [AppleWin-TC] Z80 page table.
+   Each Z80 page points directly at the Apple memory it maps to via the SoftCard's address remap (see z80_RDMEM()),
+   so that normal RAM is accessed without going through z80_RDMEM()/z80_WRMEM() and CpuRead()/CpuWrite().
+   A NULL entry takes the slow path: Apple I/O, $F8xx with a No-Slot-Clock, ROM writes, VidHD and debugger write traps.
+   Reads use the 'mem' cache, or memshadow[] when the cache is invalid (eg. dropped for heavy bank switching, see MemUpdateBankSwitchMode()).
+   The table is rebuilt after Apple paging changes (see z80_paging_changed()), which can only be caused by a slow path access,
+   and when the cache is dropped or rebuilt, which happens between execution batches. */
+
+static BYTE *z80_read_page[0x100];
+static BYTE *z80_write_page[0x100];
+static BYTE z80_apple_page[0x100];				/* SoftCard address remap, for memdirty[] */
+static BYTE *const z80_no_page[0x100] = {};		/* slow path for all pages, eg. when the debugger needs the heatmap */
+static BYTE *const *z80_read_page_ptr = z80_no_page;
+static BYTE *const *z80_write_page_ptr = z80_no_page;
+static bool z80_page_table_valid = false;
+static LPBYTE z80_page_table_vidhd = NULL;
+static bool z80_page_table_mem_cache = true;
+
+static void z80_update_page_table(void)
+{
+    const bool slow_f8xx = IS_APPLE2 && MemHasNoSlotClock();	/* IO_F8xx() */
+    const bool mem_cache = GetIsMemCacheValid();
+
+    for (UINT page = 0; page < 0x100; page++) {
+        const UINT apple_page = (page < 0xB0) ? page + 0x10	/* $0000-$AFFF -> $1000-$BFFF */
+                              : (page < 0xE0) ? page + 0x20	/* $B000-$DFFF -> $D000-$FFFF */
+                              : (page < 0xF0) ? page - 0x20	/* $E000-$EFFF -> $C000-$CFFF */
+                              :                 page - 0xF0;	/* $F000-$FFFF -> $0000-$0FFF */
+        const bool io = (apple_page >= (APPLE_IO_BEGIN >> 8) && apple_page <= (FIRMWARE_EXPANSION_END >> 8))
+                     || (slow_f8xx && apple_page >= 0xF8);
+
+        z80_apple_page[page] = (BYTE)apple_page;
+        z80_read_page[page] = io ? NULL : mem_cache ? mem + (apple_page << 8) : memshadow[apple_page];
+        z80_write_page[page] = (io || memVidHD) ? NULL : memwrite[apple_page];
+    }
+
+    z80_page_table_vidhd = memVidHD;
+    z80_page_table_mem_cache = mem_cache;
+    z80_page_table_valid = true;
+}
+
+void z80_paging_changed(void)
+{
+    z80_page_table_valid = false;
+}
+
+static inline void z80_check_page_table(void)
+{
+    if (!z80_page_table_valid
+        || z80_page_table_vidhd != memVidHD				/* VidHD's aux write can change without a paging change */
+        || z80_page_table_mem_cache != GetIsMemCacheValid())
+        z80_update_page_table();
+}
+
+static inline BYTE z80_load(WORD addr)
+{
+    const BYTE *page = z80_read_page_ptr[addr >> 8];
+    if (page)
+        return page[addr & 0xff];
+
+    const BYTE value = z80_RDMEM(addr);
+    z80_check_page_table();
+    return value;
+}
+
+static inline void z80_store(WORD addr, BYTE value)
+{
+    BYTE *page = z80_write_page_ptr[addr >> 8];
+    if (page) {
+        page[addr & 0xff] = value;
+        memdirty[z80_apple_page[addr >> 8]] = 0xFF;
+        return;
+    }
+
+    z80_WRMEM(addr, value);
+    z80_check_page_table();
+}
+
 #define LOAD(addr) \
-    (*_z80mem_read_tab_ptr[(addr) >> 8])((WORD)(addr))
+    z80_load((WORD)(addr))
 
 #define STORE(addr, value) \
-    (*_z80mem_write_tab_ptr[(addr) >> 8])((WORD)(addr), (BYTE)(value))
+    z80_store((WORD)(addr), (BYTE)(value))
 
 #define IN(addr) \
     (io_read_tab[(addr) >> 8])((WORD)(addr))
@@ -5535,6 +5684,12 @@ DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles)
 	uExecutedCycles = (ULONG) ((double)uExecutedCycles * uZ80ClockMultiplier);
 	maincpu_clk = uExecutedCycles;	// Must be signed int, as cycles can go -ve
 
+	// [AppleWin-TC] Only use the page table when the 6502 would use its regular (non-heatmap) core
+	const bool bUsePageTable = (g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK);
+	z80_read_page_ptr  = bUsePageTable ? z80_read_page  : z80_no_page;
+	z80_write_page_ptr = bUsePageTable ? z80_write_page : z80_no_page;
+	z80_check_page_table();
+
     do {
 
 		// [AppleWin-TC] Z80 IRQs not supported
@@ -35,6 +35,8 @@ extern struct z80_regs_s z80_regs;
 //struct alarm_context_s;
 
 extern void z80_reset(void);
+extern bool z80_setup_benchmark(void);
+extern void z80_end_benchmark(void);
 //extern void z80_mainloop(struct interrupt_cpu_status_s *cpu_int_status,
 //                         struct alarm_context_s *cpu_alarm_context);
 DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles);
@@ -42,6 +44,7 @@ DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles);
 
 BYTE z80_RDMEM(WORD Addr);
 void z80_WRMEM(WORD Addr, BYTE Value);
+void z80_paging_changed(void);
 
 const std::string& Z80_GetSnapshotCardName(void);
 void Z80_SaveSnapshot(class YamlSaveHelper& yamlSaveHelper, const UINT uSlot);
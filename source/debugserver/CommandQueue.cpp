@@ -0,0 +1,473 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2024, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "StdAfx.h"
+
+#include "CommandQueue.h"
+#include "JsonBuilder.h"
+
+// AppleWin includes
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Interface.h"
+#include "Keyboard.h"
+#include "Memory.h"
+#include "SaveState.h"
+#include "Debugger/Debug.h"
+#include "linux/keyboardbuffer.h"
+#include "linux/linuxframe.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+namespace debugserver {
+
+namespace {
+
+const uint32_t MAX_STEP_INSTRUCTIONS = 1000000;
+const uint32_t MAX_CYCLES = 10000000;       // ~10s of emulated time
+const uint32_t MAX_BYTES = 256;             // read/write, same as /api/read
+const uint32_t CYCLES_PER_SLICE = 1000;     // ~1ms, same as CommonFrame::Execute()
+
+std::vector<std::string> Split(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::istringstream stream(line);
+    std::string token;
+    while (stream >> token) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+// What follows the 1st n tokens, eg. a pathname with spaces
+std::string Rest(const std::string& line, size_t n) {
+    size_t pos = 0;
+    for (size_t i = 0; i <= n; i++) {
+        pos = line.find_first_not_of(" \t", pos);
+        if (pos == std::string::npos) {
+            return "";
+        }
+        if (i < n) {
+            pos = line.find_first_of(" \t", pos);
+        }
+    }
+    return line.substr(pos);
+}
+
+// "C600", "$C600" or "0xC600"
+bool ParseHex(std::string str, uint32_t max, uint32_t& value) {
+    if (!str.empty() && str[0] == '$') {
+        str = str.substr(1);
+    } else if (str.size() > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        str = str.substr(2);
+    }
+    if (str.empty() || str.size() > 8 || !std::all_of(str.begin(), str.end(), [](unsigned char c) { return std::isxdigit(c); })) {
+        return false;
+    }
+    value = static_cast<uint32_t>(std::stoul(str, nullptr, 16));
+    return value <= max;
+}
+
+bool ParseCount(const std::string& str, uint32_t max, uint32_t& value) {
+    if (str.empty() || str.size() > 9 || !std::all_of(str.begin(), str.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return false;
+    }
+    value = static_cast<uint32_t>(std::stoul(str));
+    return value <= max;
+}
+
+std::string ToHex(uint32_t value, int digits) {
+    char buf[12];
+    std::snprintf(buf, sizeof(buf), "%0*X", digits, value);
+    return buf;
+}
+
+const char* GetAppModeName() {
+    switch (g_nAppMode) {
+        case MODE_LOGO:      return "Logo";
+        case MODE_PAUSED:    return "Paused";
+        case MODE_RUNNING:   return "Running";
+        case MODE_DEBUG:     return "Debug";
+        case MODE_STEPPING:  return "Stepping";
+        default:             return "Unknown";
+    }
+}
+
+Disk2InterfaceCard* GetDisk2Card(uint32_t slot) {
+    if (slot < SLOT1 || slot > SLOT7 || GetCardMgr().QuerySlot(slot) != CT_Disk2) {
+        return nullptr;
+    }
+    return dynamic_cast<Disk2InterfaceCard*>(&GetCardMgr().GetRef(slot));
+}
+
+bool FileExists(const std::string& pathname) {
+    return std::ifstream(pathname).good();
+}
+
+} // namespace
+
+std::vector<uint64_t> CommandQueue::Submit(const std::vector<std::string>& lines) {
+    std::vector<uint64_t> seqs;
+    seqs.reserve(lines.size());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_aborted = false;
+    for (const std::string& line : lines) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        m_queue.push_back({m_nextSeq, line});
+        seqs.push_back(m_nextSeq++);
+    }
+    m_queued.store(m_queue.size());
+    return seqs;
+}
+
+bool CommandQueue::WaitForResults(const std::vector<uint64_t>& seqs, int timeoutMs, std::vector<Result>& results) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // the results come in order: waiting for the last one is enough
+    const bool complete = seqs.empty() ||
+        (m_finished.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] {
+            return m_aborted || m_executedSeq >= seqs.back();
+        }) && !m_aborted);
+
+    results.clear();
+    for (uint64_t seq : seqs) {
+        auto it = m_results.find(seq);
+        if (it == m_results.end()) {
+            continue;
+        }
+        results.push_back({seq, std::move(it->second)});
+        m_results.erase(it);
+    }
+    return complete && results.size() == seqs.size();
+}
+
+std::vector<CommandQueue::Result> CommandQueue::TakeResults(size_t maxResults) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Result> results;
+    while (!m_results.empty() && results.size() < maxResults) {
+        auto it = m_results.begin();
+        results.push_back({it->first, std::move(it->second)});
+        m_results.erase(it);
+    }
+    return results;
+}
+
+void CommandQueue::Abort() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_aborted = true;
+    }
+    m_finished.notify_all();
+}
+
+size_t CommandQueue::GetQueuedCount() const {
+    return m_queued.load();
+}
+
+size_t CommandQueue::Process(const ExecuteSliceFunction& executeSlice) {
+    if (m_queued.load(std::memory_order_relaxed) == 0) {
+        return 0;
+    }
+
+    std::deque<Command> commands;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        commands.swap(m_queue);
+        m_queued.store(0);
+    }
+
+    // executed without the lock: a long "step" or "cycles" doesn't hold up Submit()
+    std::vector<std::string> results;
+    results.reserve(commands.size());
+    for (const Command& command : commands) {
+        results.push_back(Execute(command, executeSlice));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < commands.size(); i++) {
+            m_results.emplace(commands[i].seq, std::move(results[i]));
+        }
+        while (m_results.size() > MAX_RESULTS) {
+            m_results.erase(m_results.begin());
+        }
+        m_executedSeq = commands.back().seq;
+    }
+    m_executed += commands.size();
+    m_finished.notify_all();
+
+    return commands.size();
+}
+
+std::string CommandQueue::Execute(const Command& command, const ExecuteSliceFunction& executeSlice) {
+    std::string line = command.line;
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+
+    std::string id;
+    if (line.find_first_not_of(" \t") != std::string::npos && line[line.find_first_not_of(" \t")] == '#') {
+        const std::vector<std::string> tokens = Split(line);
+        id = tokens[0].substr(1);
+        line = Rest(line, 1);
+    }
+
+    const std::vector<std::string> args = Split(line);
+    std::string verb = args.empty() ? "" : args[0];
+    std::transform(verb.begin(), verb.end(), verb.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    JsonBuilder json;
+    json.BeginObject()
+        .Add("seq", static_cast<unsigned long long>(command.seq));
+    if (!id.empty()) {
+        json.Add("id", id);
+    }
+    json.Add("command", verb);
+
+    std::string error;
+    uint32_t value = 0;
+
+    if (verb == "pause") {
+        if (g_nAppMode == MODE_RUNNING) {
+            g_nAppMode = MODE_PAUSED;
+            GetFrame().FrameRefreshStatus(DRAW_TITLE);
+        }
+        json.Add("mode", GetAppModeName());
+    }
+    else if (verb == "resume") {
+        if (g_nAppMode == MODE_PAUSED) {
+            g_nAppMode = MODE_RUNNING;
+            GetFrame().FrameRefreshStatus(DRAW_TITLE);
+        } else if (g_nAppMode == MODE_DEBUG || g_nAppMode == MODE_STEPPING) {
+            DebugExitDebugger();
+        }
+        json.Add("mode", GetAppModeName());
+    }
+    else if (verb == "status") {
+        json.Add("mode", GetAppModeName())
+            .AddHex16("pc", regs.pc)
+            .Add("cycles", static_cast<unsigned long long>(g_nCumulativeCycles))
+            .Add("queued", static_cast<unsigned long long>(m_queued.load()));
+    }
+    else if (verb == "step") {
+        uint32_t count = 1;
+        if (args.size() > 2 || (args.size() == 2 && (!ParseCount(args[1], MAX_STEP_INSTRUCTIONS, count) || !count))) {
+            error = "Usage: step [1-" + std::to_string(MAX_STEP_INSTRUCTIONS) + "]";
+        } else {
+            uint32_t instructions = 0;
+            uint64_t cycles = 0;
+            bool breakpoint = false;
+            while (instructions < count && !breakpoint) {
+                cycles += executeSlice(0);  // 0: 1 instruction
+                instructions++;
+                breakpoint = g_nBreakpoints && DebugCheckBreakpointPC(regs.pc);
+            }
+            json.Add("instructions", instructions)
+                .Add("cycles", static_cast<unsigned long long>(cycles))
+                .AddHex16("pc", regs.pc)
+                .Add("breakpoint", breakpoint);
+        }
+    }
+    else if (verb == "cycles") {
+        uint32_t count = 0;
+        if (args.size() != 2 || !ParseCount(args[1], MAX_CYCLES, count) || !count) {
+            error = "Usage: cycles 1-" + std::to_string(MAX_CYCLES);
+        } else {
+            uint64_t cycles = 0;
+            bool breakpoint = false;
+            while (cycles < count && !breakpoint) {
+                if (g_nBreakpoints) {
+                    cycles += executeSlice(0);
+                    breakpoint = DebugCheckBreakpointPC(regs.pc);
+                } else {
+                    cycles += executeSlice(std::min<uint32_t>(CYCLES_PER_SLICE, count - static_cast<uint32_t>(cycles)));
+                }
+            }
+            json.Add("cycles", static_cast<unsigned long long>(cycles))
+                .AddHex16("pc", regs.pc)
+                .Add("breakpoint", breakpoint);
+        }
+    }
+    else if (verb == "read") {
+        uint32_t addr = 0;
+        uint32_t len = 1;
+        if (args.size() < 2 || args.size() > 3 || !ParseHex(args[1], 0xFFFF, addr) ||
+            (args.size() == 3 && (!ParseCount(args[2], MAX_BYTES, len) || !len)) || addr + len > 0x10000) {
+            error = "Usage: read addr [len], up to " + std::to_string(MAX_BYTES) + " bytes below $10000";
+        } else {
+            std::string hex;
+            for (uint32_t i = 0; i < len; i++) {
+                hex += ToHex(ReadByteFromMemory(static_cast<uint16_t>(addr + i)), 2);
+            }
+            json.AddHex16("address", static_cast<uint16_t>(addr))
+                .Add("hex", hex);
+        }
+    }
+    else if (verb == "write") {
+        uint32_t addr = 0;
+        std::vector<uint8_t> data;
+        bool valid = args.size() >= 3 && args.size() - 2 <= MAX_BYTES && ParseHex(args[1], 0xFFFF, addr);
+        for (size_t i = 2; valid && i < args.size(); i++) {
+            valid = ParseHex(args[i], 0xFF, value);
+            data.push_back(static_cast<uint8_t>(value));
+        }
+        if (!valid || addr + data.size() > 0x10000) {
+            error = "Usage: write addr byte [byte...], up to " + std::to_string(MAX_BYTES) + " bytes below $10000";
+        } else {
+            for (size_t i = 0; i < data.size(); i++) {
+                WriteByteToMemory(static_cast<uint16_t>(addr + i), data[i]);
+            }
+            json.AddHex16("address", static_cast<uint16_t>(addr))
+                .Add("length", static_cast<int>(data.size()));
+        }
+    }
+    else if (verb == "regs" || verb == "reg") {
+        // check them all before setting any
+        regsrec newRegs = regs;
+        for (size_t i = 1; i < args.size() && verb == "reg" && error.empty(); i++) {
+            const size_t eq = args[i].find('=');
+            std::string name = args[i].substr(0, eq);
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::toupper(c); });
+            const std::string str = eq == std::string::npos ? "" : args[i].substr(eq + 1);
+
+            if (name == "PC" && ParseHex(str, 0xFFFF, value)) newRegs.pc = static_cast<WORD>(value);
+            else if (name == "A" && ParseHex(str, 0xFF, value)) newRegs.a = static_cast<BYTE>(value);
+            else if (name == "X" && ParseHex(str, 0xFF, value)) newRegs.x = static_cast<BYTE>(value);
+            else if (name == "Y" && ParseHex(str, 0xFF, value)) newRegs.y = static_cast<BYTE>(value);
+            else if (name == "P" && ParseHex(str, 0xFF, value)) newRegs.ps = static_cast<BYTE>(value | AF_RESERVED | AF_BREAK);
+            else if ((name == "S" || name == "SP") && ParseHex(str, 0x1FF, value)) newRegs.sp = static_cast<WORD>(0x100 | (value & 0xFF));
+            else error = "Usage: reg A=xx X=xx Y=xx P=xx S=xx PC=xxxx";
+        }
+        if (verb == "reg" && args.size() < 2) {
+            error = "Usage: reg A=xx X=xx Y=xx P=xx S=xx PC=xxxx";
+        }
+        if (error.empty()) {
+            regs = newRegs;
+            json.AddHex8("A", regs.a)
+                .AddHex8("X", regs.x)
+                .AddHex8("Y", regs.y)
+                .AddHex8("P", regs.ps)
+                .AddHex8("S", static_cast<uint8_t>(regs.sp & 0xFF))
+                .AddHex16("PC", regs.pc);
+        }
+    }
+    else if (verb == "bp") {
+        const std::string action = args.size() > 1 ? args[1] : "";
+        if (args.size() != 3 || (action != "set" && action != "clear") || !ParseHex(args[2], 0xFFFF, value)) {
+            error = "Usage: bp set|clear addr";
+        } else if (action == "set") {
+            if (!DebugSetBreakpointPC(static_cast<WORD>(value))) {
+                error = "All breakpoint slots are in use";
+            }
+        } else {
+            json.Add("found", DebugClearBreakpointPC(static_cast<WORD>(value)));
+        }
+        if (error.empty()) {
+            json.AddHex16("address", static_cast<uint16_t>(value))
+                .Add("breakpoints", g_nBreakpoints);
+        }
+    }
+    else if (verb == "disk") {
+        const std::string action = args.size() > 1 ? args[1] : "";
+        uint32_t slot = 0;
+        uint32_t drive = 0;
+        Disk2InterfaceCard* card = nullptr;
+        if ((action != "insert" && action != "eject") || args.size() < 4 ||
+            !ParseCount(args[2], SLOT7, slot) || !ParseCount(args[3], 2, drive) || drive < 1) {
+            error = "Usage: disk insert slot drive [ro] path, disk eject slot drive";
+        } else if (!(card = GetDisk2Card(slot))) {
+            error = "No Disk II card in slot " + std::to_string(slot);
+        } else if (action == "eject") {
+            card->EjectDisk(drive - 1);
+        } else {
+            const bool writeProtected = args.size() > 5 && args[4] == "ro";
+            const std::string pathname = Rest(line, writeProtected ? 5 : 4);
+            if (pathname.empty()) {
+                error = "Usage: disk insert slot drive [ro] path";
+            } else {
+                const ImageError_e res = card->InsertDisk(drive - 1, pathname, writeProtected, false);
+                if (res != eIMAGE_ERROR_NONE) {
+                    error = "Unable to insert " + pathname + " (image error " + std::to_string(res) + ")";
+                } else {
+                    json.Add("image", card->GetFullDiskFilename(drive - 1));
+                }
+            }
+        }
+    }
+    else if (verb == "key") {
+        if (args.size() != 2 || !ParseHex(args[1], 0xFF, value)) {
+            error = "Usage: key code";
+        } else {
+            addKeyToBuffer(static_cast<BYTE>(value & 0x7F));
+        }
+    }
+    else if (verb == "type") {
+        KeybPasteText(Rest(line, 1));
+    }
+    else if (verb == "save" || verb == "load") {
+        const std::string pathname = Rest(line, 1);
+        if (pathname.empty()) {
+            error = "Usage: " + verb + " path";
+        } else if (verb == "load" && !FileExists(pathname)) {
+            error = "No such file: " + pathname;
+        } else {
+            Snapshot_SetFilename(pathname);
+            if (verb == "save") {
+                Snapshot_SaveState();
+                if (!FileExists(pathname)) {
+                    error = "Unable to save " + pathname;
+                }
+            } else {
+                LinuxFrame* frame = dynamic_cast<LinuxFrame*>(&GetFrame());
+                if (frame) {
+                    frame->LoadSnapshot();  // CommonFrame: also resets the speed
+                } else {
+                    Snapshot_LoadState();
+                }
+                json.Add("mode", GetAppModeName());
+            }
+        }
+    }
+    else {
+        error = verb.empty() ? "No command" : "Unknown command: " + verb;
+    }
+
+    if (error.empty()) {
+        json.Add("ok", true);
+    } else {
+        json.Add("ok", false)
+            .Add("error", error);
+    }
+    json.EndObject();
+
+    return json.ToString();
+}
+
+} // namespace debugserver
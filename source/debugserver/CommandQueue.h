@@ -0,0 +1,115 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2024, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/*
+ * Command Queue
+ * Read-write control of the emulator: commands are queued by the server threads
+ * and executed by the emulation thread between 2 instructions (DebugServer_ProcessCommands)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace debugserver {
+
+// Runs the emulator for about this many cycles (0: 1 instruction), as the frame loop does: see common2::ExecuteSlice()
+typedef std::function<uint32_t(uint32_t cycles)> ExecuteSliceFunction;
+
+/**
+ * CommandQueue - Commands from remote clients, one text line each:
+ *
+ *   [#id] command [args]
+ *
+ * The optional "#id" is echoed back in the result, to correlate requests and responses.
+ * Each command also gets a sequence number from Submit(), used to wait for / collect its result.
+ * Numbers are hex (an optional '$' prefix) except for counts, which are decimal.
+ *
+ *   pause, resume, status
+ *   step [n]                       - n instructions (stops at a PC breakpoint)
+ *   cycles n                       - at least n cycles (stops at a PC breakpoint)
+ *   read addr [len]
+ *   write addr byte [byte...]
+ *   regs                           - or set: reg A=xx X=xx Y=xx P=xx S=xx PC=xxxx
+ *   bp set|clear addr              - PC breakpoints, as "bpx" in the debugger
+ *   disk insert slot drive [ro] path, disk eject slot drive
+ *   key code                       - eg. "key 8D" for RETURN
+ *   type text                      - paste text
+ *   save path, load path           - save-state
+ */
+class CommandQueue {
+public:
+    struct Result {
+        uint64_t seq;
+        std::string json;   // {"seq":..,"id":..,"command":..,"ok":..,...}
+    };
+
+    CommandQueue() = default;
+
+    // Server threads
+    std::vector<uint64_t> Submit(const std::vector<std::string>& lines);
+    // Results in the order of seqs, false on timeout: only the finished ones are returned, the others are left for TakeResults()
+    bool WaitForResults(const std::vector<uint64_t>& seqs, int timeoutMs, std::vector<Result>& results);
+    // Finished results not collected yet, oldest first
+    std::vector<Result> TakeResults(size_t maxResults);
+    // Wake up the waiting threads (server shutting down)
+    void Abort();
+
+    size_t GetQueuedCount() const;
+    uint64_t GetExecutedCount() const { return m_executed.load(); }
+
+    // Emulation thread, between 2 instructions: returns the number of commands executed
+    size_t Process(const ExecuteSliceFunction& executeSlice);
+
+private:
+    struct Command {
+        uint64_t seq;
+        std::string line;
+    };
+
+    std::string Execute(const Command& command, const ExecuteSliceFunction& executeSlice);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_finished;
+    std::deque<Command> m_queue;
+    std::map<uint64_t, std::string> m_results;  // seq -> JSON, not collected yet
+    uint64_t m_nextSeq = 1;
+    uint64_t m_executedSeq = 0;
+    bool m_aborted = false;
+
+    std::atomic<size_t> m_queued{0};    // checked without the lock, for every execution slice
+    std::atomic<uint64_t> m_executed{0};
+
+    // Uncollected results are dropped past this (fire and forget clients)
+    static constexpr size_t MAX_RESULTS = 65536;
+};
+
+} // namespace debugserver
@@ -0,0 +1,164 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2024, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "StdAfx.h"
+
+#include "ControlProvider.h"
+#include "JsonBuilder.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace debugserver {
+
+void ControlProvider::HandleRequest(const HttpRequest& request, HttpResponse& response) {
+    std::string path = request.GetPath();
+
+    if (path == "/api/command" || path == "/command") {
+        HandleApiCommands(request, response, true);
+    }
+    else if (path == "/api/commands" || path == "/commands") {
+        HandleApiCommands(request, response, false);
+    }
+    else if (path == "/api/results" || path == "/results") {
+        HandleApiResults(request, response);
+    }
+    else if (path == "/api/status" || path == "/status") {
+        HandleApiStatus(request, response);
+    }
+    else if (path == "/" || path == "/index.html") {
+        HandleHtmlHelp(request, response);
+    }
+    else {
+        SendErrorResponse(response, 404, "Endpoint not found: " + path);
+    }
+}
+
+void ControlProvider::HandleApiCommands(const HttpRequest& request, HttpResponse& response, bool single) {
+    // /api/command: 1 command in ?cmd= or the body
+    // /api/commands: 1 command per line of the body, executed in order at the same instruction boundary
+    std::vector<std::string> lines;
+    if (single) {
+        lines.push_back(request.HasQueryParam("cmd") ? request.GetQueryParam("cmd") : request.GetBody());
+    }
+    else {
+        std::istringstream body(request.GetBody());
+        std::string line;
+        while (std::getline(body, line)) {
+            lines.push_back(line);
+        }
+    }
+
+    // wait=0: fire and forget, the results are collected with /api/results
+    int waitMs = DEFAULT_WAIT_MS;
+    if (request.HasQueryParam("wait")) {
+        waitMs = std::min(std::max(std::atoi(request.GetQueryParam("wait").c_str()), 0), MAX_WAIT_MS);
+    }
+
+    const std::vector<uint64_t> seqs = m_queue.Submit(lines);
+    if (seqs.empty()) {
+        SendErrorResponse(response, 400, "No command");
+        return;
+    }
+
+    JsonBuilder json;
+    json.BeginObject();
+
+    if (!waitMs) {
+        json.Key("queued").BeginArray();
+        for (uint64_t seq : seqs) {
+            json.Value(static_cast<unsigned long long>(seq));
+        }
+        json.EndArray();
+    }
+    else {
+        std::vector<CommandQueue::Result> results;
+        const bool complete = m_queue.WaitForResults(seqs, waitMs, results);
+
+        json.Add("complete", complete)
+            .Key("results").BeginArray();
+        for (const CommandQueue::Result& result : results) {
+            json.RawValue(result.json);
+        }
+        json.EndArray();
+    }
+
+    json.EndObject();
+
+    // not pretty printed: batches of thousands of results
+    SendJsonResponse(response, json.ToString());
+}
+
+void ControlProvider::HandleApiResults(const HttpRequest& request, HttpResponse& response) {
+    const int maxResults = std::max(std::atoi(request.GetQueryParam("max", "1000").c_str()), 1);
+    const std::vector<CommandQueue::Result> results = m_queue.TakeResults(maxResults);
+
+    JsonBuilder json;
+    json.BeginObject()
+        .Key("results").BeginArray();
+    for (const CommandQueue::Result& result : results) {
+        json.RawValue(result.json);
+    }
+    json.EndArray()
+    .EndObject();
+
+    SendJsonResponse(response, json.ToString());
+}
+
+void ControlProvider::HandleApiStatus(const HttpRequest& request, HttpResponse& response) {
+    JsonBuilder json;
+    json.BeginObject()
+        .Add("queued", static_cast<unsigned long long>(m_queue.GetQueuedCount()))
+        .Add("executed", static_cast<unsigned long long>(m_queue.GetExecutedCount()))
+    .EndObject();
+
+    SendJsonResponse(response, json.ToPrettyString());
+}
+
+void ControlProvider::HandleHtmlHelp(const HttpRequest& request, HttpResponse& response) {
+    SendHtmlResponse(response, R"HTML(<!DOCTYPE html>
+<html>
+<head><title>AppleWin Control</title></head>
+<body>
+<h1>AppleWin Control</h1>
+<pre>
+POST /api/command?[cmd=...][&amp;wait=ms]   - 1 command (cmd or body), waits for its result (default 5000ms)
+POST /api/commands?[wait=ms]              - 1 command per line, executed in order
+GET  /api/results?[max=N]                 - results of the commands sent with wait=0
+GET  /api/status                          - queued and executed commands
+
+[#id] pause | resume | status
+[#id] step [n] | cycles n
+[#id] read addr [len] | write addr byte [byte...]
+[#id] regs | reg A=xx X=xx Y=xx P=xx S=xx PC=xxxx
+[#id] bp set addr | bp clear addr
+[#id] disk insert slot drive [ro] path | disk eject slot drive
+[#id] key code | type text
+[#id] save path | load path
+</pre>
+</body>
+</html>
+)HTML");
+}
+
+} // namespace debugserver
@@ -0,0 +1,60 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2024, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/*
+ * Control Provider
+ * Read-write control of the emulator via HTTP, see CommandQueue for the commands
+ * Port: 65506
+ */
+
+#pragma once
+
+#include "InfoProvider.h"
+#include "CommandQueue.h"
+
+namespace debugserver {
+
+class ControlProvider : public InfoProvider {
+public:
+    explicit ControlProvider(CommandQueue& queue) : m_queue(queue) {}
+    ~ControlProvider() override = default;
+
+    const char* GetName() const override { return "Control"; }
+    uint16_t GetPort() const override { return static_cast<uint16_t>(DebugServerPort::Control); }
+
+    void HandleRequest(const HttpRequest& request, HttpResponse& response) override;
+
+private:
+    // API endpoints
+    void HandleApiCommands(const HttpRequest& request, HttpResponse& response, bool single);
+    void HandleApiResults(const HttpRequest& request, HttpResponse& response);
+    void HandleApiStatus(const HttpRequest& request, HttpResponse& response);
+    void HandleHtmlHelp(const HttpRequest& request, HttpResponse& response);
+
+    CommandQueue& m_queue;
+
+    static constexpr int DEFAULT_WAIT_MS = 5000;
+    static constexpr int MAX_WAIT_MS = 60000;
+};
+
+} // namespace debugserver
@@ -42,6 +42,7 @@ DebugServerManager::DebugServerManager()
     m_cpuProvider = std::make_unique<CPUInfoProvider>();
     m_ioProvider = std::make_unique<IOInfoProvider>();
     m_memoryProvider = std::make_unique<MemoryInfoProvider>();
+    m_controlProvider = std::make_unique<ControlProvider>(m_commandQueue);
 
     // Create stream provider
     m_streamProvider = std::make_unique<DebugStreamProvider>();
@@ -104,6 +105,13 @@ bool DebugServerManager::Start() {
             allStarted = false;
         }
 
+        // Control Server (port 65506)
+        m_controlServer = CreateServer(m_controlProvider.get());
+        if (!m_controlServer->Start()) {
+            m_lastError += "Control server failed: " + m_controlServer->GetLastError() + "\n";
+            allStarted = false;
+        }
+
         // Stream Server (port 65505)
         if (m_streamEnabled) {
             m_streamServer = std::make_unique<TelnetStreamServer>(
@@ -135,6 +143,8 @@ bool DebugServerManager::Start() {
                   << static_cast<int>(DebugServerPort::CPU) << "/" << std::endl;
         std::cout << "  Memory Info:  http://" << m_bindAddress << ":"
                   << static_cast<int>(DebugServerPort::Memory) << "/" << std::endl;
+        std::cout << "  Control:      http://" << m_bindAddress << ":"
+                  << static_cast<int>(DebugServerPort::Control) << "/" << std::endl;
         if (m_streamEnabled && m_streamServer) {
             std::cout << "  Debug Stream: telnet://" << m_bindAddress << ":"
                       << static_cast<int>(DebugServerPort::Stream) << "/" << std::endl;
@@ -149,7 +159,7 @@ bool DebugServerManager::Start() {
 
 void DebugServerManager::Stop() {
     if (!m_running.load() &&
-        !m_machineServer && !m_cpuServer && !m_ioServer && !m_memoryServer && !m_streamServer) {
+        !m_machineServer && !m_cpuServer && !m_ioServer && !m_memoryServer && !m_controlServer && !m_streamServer) {
         return;  // Nothing to stop
     }
 
@@ -174,6 +184,13 @@ void DebugServerManager::Stop() {
         m_memoryServer.reset();
     }
 
+    // Wake up a control request waiting for its results
+    m_commandQueue.Abort();
+    if (m_controlServer) {
+        m_controlServer->Stop();
+        m_controlServer.reset();
+    }
+
     // Stop stream server
     if (m_streamServer) {
         m_streamServer->Stop();
@@ -200,6 +217,7 @@ std::vector<DebugServerManager::ServerStatus> DebugServerManager::GetServerStatu
     addStatus("I/O Info", static_cast<uint16_t>(DebugServerPort::IO), m_ioServer.get());
     addStatus("CPU Info", static_cast<uint16_t>(DebugServerPort::CPU), m_cpuServer.get());
     addStatus("Memory Info", static_cast<uint16_t>(DebugServerPort::Memory), m_memoryServer.get());
+    addStatus("Control", static_cast<uint16_t>(DebugServerPort::Control), m_controlServer.get());
 
     // Add stream server status
     {
@@ -259,3 +277,7 @@ void DebugServer_BroadcastStream(const char* data) {
         debugserver::DebugServerManager::GetInstance().BroadcastStreamData(data);
     }
 }
+
+size_t DebugServer_ProcessCommands(const debugserver::ExecuteSliceFunction& executeSlice) {
+    return debugserver::DebugServerManager::GetInstance().ProcessCommands(executeSlice);
+}
@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "IOInfoProvider.h"
 #include "MemoryInfoProvider.h"
 #include "DebugStreamProvider.h"
+#include "CommandQueue.h"
+#include "ControlProvider.h"
 
 #include <memory>
 #include <vector>
@@ -113,6 +115,10 @@ public:
     // Broadcast data to all connected stream clients
     void BroadcastStreamData(const std::string& data);
 
+    // Commands from the control server, executed by the emulation thread
+    CommandQueue& GetCommandQueue() { return m_commandQueue; }
+    size_t ProcessCommands(const ExecuteSliceFunction& executeSlice) { return m_commandQueue.Process(executeSlice); }
+
 private:
     // Private constructor for singleton
     DebugServerManager();
@@ -137,11 +143,16 @@ private:
     // Stream Provider
     std::unique_ptr<DebugStreamProvider> m_streamProvider;
 
+    // Control: the queue outlives the server, as the emulation thread drains it
+    CommandQueue m_commandQueue;
+    std::unique_ptr<ControlProvider> m_controlProvider;
+
     // HTTP Servers
     std::unique_ptr<HttpServer> m_machineServer;
     std::unique_ptr<HttpServer> m_cpuServer;
     std::unique_ptr<HttpServer> m_ioServer;
     std::unique_ptr<HttpServer> m_memoryServer;
+    std::unique_ptr<HttpServer> m_controlServer;
 
     // Telnet Stream Server
     std::unique_ptr<TelnetStreamServer> m_streamServer;
@@ -173,3 +184,9 @@ bool DebugServer_IsStreamEnabled(void);
 
 // Broadcast data to all connected stream clients
 void DebugServer_BroadcastStream(const char* data);
+
+// Execute the commands queued by the control server (port 65506)
+// Call from the emulation thread, between 2 instructions (cheap when there is nothing queued)
+// "step" & "cycles" run the emulator with executeSlice
+// Returns the number of commands executed
+size_t DebugServer_ProcessCommands(const debugserver::ExecuteSliceFunction& executeSlice);
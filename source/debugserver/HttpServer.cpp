@@ -110,7 +110,11 @@ void HttpServer::Stop() {
 
     m_shouldStop = true;
 
-    // Close the server socket to interrupt accept()
+    // Shut down & close the server socket to interrupt accept()
+    // (closing alone doesn't wake up poll() on Linux, so Stop() would wait for its 100ms timeout)
+    if (m_serverSocket != INVALID_SOCKET_VALUE) {
+        ShutdownSocket(m_serverSocket);
+    }
     CleanupSocket();
 
     // Wait for accept thread to finish
@@ -89,7 +89,8 @@ enum class DebugServerPort : uint16_t {
     IO      = 65502,    // I/O info (soft switches, slot cards)
     CPU     = 65503,    // CPU info (registers, flags, breakpoints)
     Memory  = 65504,    // Memory info (dumps, memory flags)
-    Stream  = 65505     // Debug stream (Telnet, JSON Lines output)
+    Stream  = 65505,    // Debug stream (Telnet, JSON Lines output)
+    Control = 65506     // Control (commands executed by the emulation thread)
 };
 
 } // namespace debugserver
@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 // AppleWin includes
 #include "Memory.h"
 #include "CPU.h"
+#include "ProgramLoader.h"
 
 namespace debugserver {
 
@@ -51,6 +52,9 @@ void MemoryInfoProvider::HandleRequest(const HttpRequest& request, HttpResponse&
     else if (path == "/api/textscreen" || path == "/textscreen") {
         HandleApiTextScreen(request, response);
     }
+    else if (path == "/api/load" || path == "/load") {
+        HandleApiLoad(request, response);
+    }
     else if (path == "/" || path == "/index.html") {
         HandleHtmlDashboard(request, response);
     }
@@ -145,6 +149,47 @@ void MemoryInfoProvider::HandleApiRead(const HttpRequest& request, HttpResponse&
     SendJsonResponse(response, json.ToPrettyString());
 }
 
+void MemoryInfoProvider::HandleApiLoad(const HttpRequest& request, HttpResponse& response) {
+    // Program is loaded by the emulation thread (ProgramLoader_Update), so just queue it here
+    std::string addrStr = request.GetQueryParam("addr", "");
+    const bool run = request.GetQueryParam("run", "0") != "0";
+
+    int addr = -1;
+    if (!addrStr.empty()) {
+        if (addrStr[0] == '$') addrStr = addrStr.substr(1);
+        addr = static_cast<int>(std::stoul(addrStr, nullptr, 16) & 0xFFFF);
+    }
+
+    std::string name;
+    if (request.HasQueryParam("file")) {
+        name = request.GetQueryParam("file");
+        std::string error;
+        if (!ProgramLoader_QueueFile(name, addr, run, false, error)) {
+            SendErrorResponse(response, 400, error);
+            return;
+        }
+    }
+    else {
+        name = request.GetQueryParam("name", "");
+        const std::string& body = request.GetBody();
+        const std::vector<BYTE> data(body.begin(), body.end());
+        if (ProgramLoader_GetType(name, data) == PROGRAM_UNKNOWN) {
+            SendErrorResponse(response, 400, "Unknown program type (name=PROG.BIN, .SYS, .BAS, .INT or PROG#TTAAAA): " + name);
+            return;
+        }
+        ProgramLoader_Queue(name, data, addr, run, false);
+    }
+
+    JsonBuilder json;
+    json.BeginObject()
+        .Add("queued", true)
+        .Add("name", name)
+        .Add("run", run)
+    .EndObject();
+
+    SendJsonResponse(response, json.ToPrettyString());
+}
+
 void MemoryInfoProvider::HandleApiZeroPage(const HttpRequest& request, HttpResponse& response) {
     auto dump = GetHexDump(0x0000, 16, 16);
 
@@ -51,6 +51,7 @@ private:
     void HandleApiZeroPage(const HttpRequest& request, HttpResponse& response);
     void HandleApiStack(const HttpRequest& request, HttpResponse& response);
     void HandleApiTextScreen(const HttpRequest& request, HttpResponse& response);
+    void HandleApiLoad(const HttpRequest& request, HttpResponse& response);
     void HandleHtmlDashboard(const HttpRequest& request, HttpResponse& response);
 
     // Helper structure for hex dump
@@ -59,6 +59,7 @@ namespace debugserver {
     constexpr int SOCKET_ERROR_VALUE = SOCKET_ERROR;
     constexpr int SEND_FLAGS = 0;  // Windows doesn't need special flags
     inline int CloseSocket(socket_t s) { return closesocket(s); }
+    inline int ShutdownSocket(socket_t s) { return shutdown(s, SD_BOTH); }
     inline int GetLastSocketError() { return WSAGetLastError(); }
 #else
     using socket_t = int;
@@ -68,6 +69,7 @@ namespace debugserver {
     // Without this, writing to a closed socket kills the process
     constexpr int SEND_FLAGS = MSG_NOSIGNAL;
     inline int CloseSocket(socket_t s) { return close(s); }
+    inline int ShutdownSocket(socket_t s) { return shutdown(s, SHUT_RDWR); }
     inline int GetLastSocketError() { return errno; }
 #endif
 
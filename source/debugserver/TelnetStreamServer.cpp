@@ -123,10 +123,18 @@ void TelnetStreamServer::Stop() {
         return;
     }
 
-    m_shouldStop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(m_stopMutex);
+        m_shouldStop.store(true);
+    }
+    m_stopCondition.notify_all();
     m_running.store(false);
 
-    // Close server socket to unblock accept()
+    // Shut down & close server socket to unblock accept()
+    // (closing alone doesn't wake up poll() on Linux, so Stop() would wait for its 100ms timeout)
+    if (m_serverSocket != INVALID_SOCKET_VALUE) {
+        ShutdownSocket(m_serverSocket);
+    }
     CleanupSocket();
 
     // Wait for accept thread to finish
@@ -442,12 +450,10 @@ void TelnetStreamServer::BroadcastLoop() {
         if (intervalMs < 10) intervalMs = 10;  // Minimum 10ms
         if (intervalMs > 10000) intervalMs = 10000;  // Maximum 10 seconds
 
-        // Sleep in small increments to allow quick shutdown
-        int elapsed = 0;
-        while (elapsed < intervalMs && !m_shouldStop.load()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            elapsed += 10;
-        }
+        // Sleep until the next broadcast, or until Stop() is called
+        std::unique_lock<std::mutex> lock(m_stopMutex);
+        m_stopCondition.wait_for(lock, std::chrono::milliseconds(intervalMs),
+                                 [this] { return m_shouldStop.load(); });
     }
 }
 
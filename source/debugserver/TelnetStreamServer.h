@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <vector>
 #include <functional>
 
@@ -162,6 +163,8 @@ private:
     std::thread m_broadcastThread;
     std::atomic<bool> m_periodicBroadcastEnabled;
     std::atomic<int> m_broadcastIntervalMs;
+    std::mutex m_stopMutex;
+    std::condition_variable m_stopCondition;    // wakes up the broadcast thread on Stop()
 
     // Callback for new client connections
     OnClientConnected m_onClientConnected;
@@ -4,6 +4,7 @@
 #include "frontends/common2/utils.h"
 #include "linux/version.h"
 
+#include "Log.h"
 #include "Memory.h"
 
 #include <getopt.h>
@@ -46,6 +47,29 @@ namespace
     constexpr int NO_VIDEO_UPDATE = 1024;
     constexpr int EV_DEVICE_NAME = 1025;
 
+    constexpr int BOOT_CACHE = 1027;
+    constexpr int BOOT_CACHE_TRIGGER = 1028;
+
+    constexpr int LOAD_PROGRAM = 1029;
+    constexpr int LOAD_ADDR = 1030;
+    constexpr int LOAD_RUN = 1031;
+
+    constexpr int NTSC_CACHE = 1032;
+
+    constexpr int SERIAL_PORT = 1033;
+    constexpr int SERIAL_TURBO = 1034;
+
+    constexpr int TAPE_RECORD = 1035;
+    constexpr int NO_TAPE_FAST_LOAD = 1036;
+    constexpr int NO_TAPE_TURBO = 1037;
+    constexpr int NO_BANK_SWITCH_BY_POINTER = 1038;
+
+    constexpr int LOG_LEVEL = 1039;
+    constexpr int NO_MOUSE_FAST_PATH = 1040;
+    constexpr int MEMORY_REPORT = 1041;
+    constexpr int SCRIPT = 1042;
+    constexpr int FRAME_HASHES = 1043;
+
     struct OptionData_t
     {
         const char *name;
@@ -168,24 +192,47 @@ namespace common2
             {"Emulator",
              {
                  {"log",                     no_argument,          'l',              "Log to AppleWin.log"},
+                 {"log-level",               required_argument,    LOG_LEVEL,        "Log levels (implies --log) e.g. disk=debug,network=trace"},
                  {"paused",                  no_argument,          PAUSED,           "Start paused"},
                  {"fixed-speed",             no_argument,          FIXED_SPEED,      "Fixed (non-adaptive) speed"},
                  {"headless",                no_argument,          HEADLESS,         "Headless: disable video (freewheel)"},
                  {"benchmark",               no_argument,          'b',              "Benchmark emulator"},
+                 {"script",                  required_argument,    SCRIPT,           "Run a debugger script, exit with its status (use with --headless)"},
+                 {"frame-hashes",            required_argument,    FRAME_HASHES,     "Write the frame buffer and video memory hashes of every frame"},
                  {"no-squaring",             no_argument,          NO_SQUARING,      "Gamepad range is (already) a square"},
+                 {"no-mouse-fast-path",      no_argument,          NO_MOUSE_FAST_PATH, "Run the mouse card firmware's PIA handshake for every call"},
                  {"nat",                     required_argument,    SLIRP_NAT,        "SLIRP PortFwd (e.g. 0,tcp,,8080,,http)"},
              }},
+            {"Serial",
+             {
+                 {"serial",                  required_argument,    SERIAL_PORT,      "SSC in slot 2: pty[:link], unix:path, tcp[:[addr:]port] or fd:n"},
+                 {"serial-turbo",            no_argument,          SERIAL_TURBO,     "SSC ignores the baud rate"},
+             }},
+            {"Tape",
+             {
+                 {"tape-record",             required_argument,    TAPE_RECORD,      "Record TAPEOUT to a .wav file (written on exit)"},
+                 {"no-tape-fast-load",       no_argument,          NO_TAPE_FAST_LOAD, "Play the tape in real time for the monitor READ"},
+                 {"no-tape-turbo",           no_argument,          NO_TAPE_TURBO,    "Do not run at full speed while the tape is in use"},
+             }},
             {"Disk",
              {
                  {"d1",                      required_argument,    '1',              "Disk in S6D1 drive"},
                  {"d2",                      required_argument,    '2',              "Disk in S6D2 drive"},
-                 {"h1",                      required_argument,    DISK_H1,          "Hard Disk in 1st drive"},
-                 {"h2",                      required_argument,    DISK_H2,          "Hard Disk in 1st drive"},
+                 {"h1",                      required_argument,    DISK_H1,          "Hard Disk in 1st drive (image or host directory)"},
+                 {"h2",                      required_argument,    DISK_H2,          "Hard Disk in 2nd drive (image or host directory)"},
              }},
             {"Snapshot",
              {
                  {"state-filename",          required_argument,    'f',              "Set snapshot filename"},
                  {"load-state",              required_argument,    's',              "Load snapshot from file"},
+                 {"boot-cache",              required_argument,    BOOT_CACHE,       "Directory to cache the booted state of the disk images"},
+                 {"boot-cache-trigger",      required_argument,    BOOT_CACHE_TRIGGER, "When to cache: pc=<hex>, key or cycles=<n>", "key"},
+             }},
+            {"Program",
+             {
+                 {"load",                    required_argument,    LOAD_PROGRAM,     "Load program once booted (.bin .sys .bas .int .s or NAME#TTAAAA)"},
+                 {"load-addr",               required_argument,    LOAD_ADDR,        "Load address (hex) of a binary program, or origin of a .s source"},
+                 {"load-run",                no_argument,          LOAD_RUN,         "Run the program once loaded"},
              }},
             {"Memory",
              {
@@ -193,6 +240,9 @@ namespace common2
                  {"rom",                     required_argument,    ROM,              "Custom 12k/16k ROM"},
                  {"f8rom",                   required_argument,    F8ROM,            "Custom 2k ROM"},
                  {"videorom",                required_argument,    VIDEOROM,         "Custom Video ROM"},
+                 {"ntsc-cache",              required_argument,    NTSC_CACHE,       "File to cache the generated NTSC color tables"},
+                 {"no-bank-switch-by-pointer", no_argument,        NO_BANK_SWITCH_BY_POINTER, "Always copy pages on bank switches (RamWorks, LC, Saturn)"},
+                 {"memory-report",           no_argument,          MEMORY_REPORT,    "Print the resident memory by subsystem on exit"},
              }},
             {"Audio",
              {
@@ -279,6 +329,17 @@ namespace common2
                 options.log = true;
                 break;
             }
+            case LOG_LEVEL:
+            {
+                options.log = true;
+                if (!LogSetLevels(optarg))
+                {
+                    throw std::runtime_error(
+                        std::string("Invalid log levels: ") + optarg +
+                        " (general|disk|serial|network|sound|video|debugger|all = off|error|warning|info|debug|trace)");
+                }
+                break;
+            }
             case '1':
             {
                 options.disk1 = optarg;
@@ -301,6 +362,31 @@ namespace common2
                 options.loadSnapshot = true;
                 break;
             }
+            case BOOT_CACHE:
+            {
+                options.bootCacheDirectory = optarg;
+                break;
+            }
+            case BOOT_CACHE_TRIGGER:
+            {
+                options.bootCacheTrigger = optarg;
+                break;
+            }
+            case LOAD_PROGRAM:
+            {
+                options.loadProgram = optarg;
+                break;
+            }
+            case LOAD_ADDR:
+            {
+                options.loadProgramAddress = std::stoi(optarg, nullptr, 16);
+                break;
+            }
+            case LOAD_RUN:
+            {
+                options.loadProgramRun = true;
+                break;
+            }
             case 'r':
             {
                 options.registryOptions.emplace_back(optarg);
@@ -331,6 +417,11 @@ namespace common2
                 options.paddleSquaring = false;
                 break;
             }
+            case NO_MOUSE_FAST_PATH:
+            {
+                options.mouseFastPath = false;
+                break;
+            }
             case SLIRP_NAT:
             {
                 options.natPortFwds.emplace_back(optarg);
@@ -370,6 +461,51 @@ namespace common2
                 options.customRomVideo = optarg;
                 break;
             }
+            case NTSC_CACHE:
+            {
+                options.ntscCache = optarg;
+                break;
+            }
+            case SERIAL_PORT:
+            {
+                options.serialPort = optarg;
+                break;
+            }
+            case SERIAL_TURBO:
+            {
+                options.serialTurbo = true;
+                break;
+            }
+            case TAPE_RECORD:
+            {
+                options.tapeRecord = optarg;
+                break;
+            }
+            case NO_TAPE_FAST_LOAD:
+            {
+                options.tapeFastLoad = false;
+                break;
+            }
+            case NO_TAPE_TURBO:
+            {
+                options.tapeTurbo = false;
+                break;
+            }
+            case NO_BANK_SWITCH_BY_POINTER:
+            {
+                options.bankSwitchByPointer = false;
+                break;
+            }
+            case MEMORY_REPORT:
+            {
+                options.memoryReport = true;
+                break;
+            }
+            case FRAME_HASHES:
+            {
+                options.frameHashes = optarg;
+                break;
+            }
             case NO_AUDIO:
             {
                 options.noAudio = true;
@@ -445,6 +581,11 @@ namespace common2
                 options.paddleDeviceName = optarg;
                 break;
             }
+            case SCRIPT:
+            {
+                options.script = optarg;
+                break;
+            }
             default:
             {
                 printHelp(allOptions);
@@ -1,15 +1,22 @@
 #include "StdAfx.h"
 #include "frontends/common2/commoncontext.h"
+#include "frontends/common2/memoryreport.h"
 #include "frontends/common2/programoptions.h"
 #include "frontends/common2/utils.h"
 #include "linux/linuxframe.h"
 
+#include "BootCache.h"
+#include "ProgramLoader.h"
+
+#include <iostream>
+
 namespace common2
 {
 
     CommonInitialisation::CommonInitialisation(
         const std::shared_ptr<LinuxFrame> &frame, const std::shared_ptr<Paddle> &paddle, const EmulatorOptions &options)
         : Initialisation(frame, paddle)
+        , myMemoryReport(options.memoryReport)
     {
         applyOptions(options);
         myFrame->Begin();
@@ -18,9 +25,29 @@ namespace common2
         {
             myFrame->LoadSnapshot();
         }
+        else
+        {
+            BootCache_Startup();
+        }
+
+        if (!options.loadProgram.empty())
+        {
+            // wait until the guest is at its prompt (polling the keyboard), else the boot would overwrite it
+            std::string error;
+            if (!ProgramLoader_QueueFile(
+                    options.loadProgram, options.loadProgramAddress, options.loadProgramRun, true, error))
+            {
+                throw std::runtime_error(error);
+            }
+        }
     }
     CommonInitialisation::~CommonInitialisation()
     {
+        if (myMemoryReport)
+        {
+            // before End(): once the emulator is shut down, most of it is gone
+            MemoryReport().print(std::cout);
+        }
         myFrame->End();
     }
 
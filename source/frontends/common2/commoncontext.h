@@ -11,5 +11,8 @@ namespace common2
             const std::shared_ptr<LinuxFrame> &frame, const std::shared_ptr<Paddle> &paddle,
             const EmulatorOptions &options);
         ~CommonInitialisation();
+
+    private:
+        const bool myMemoryReport;
     };
 } // namespace common2
@@ -1,35 +1,83 @@
 #include "StdAfx.h"
 #include "frontends/common2/commonframe.h"
 #include "frontends/common2/programoptions.h"
+#include "frontends/common2/videooracle.h"
+#include "linux/cassettetape.h"
 
 #include <thread>
 
+#include "BootCache.h"
 #include "CardManager.h"
 #include "Core.h"
 #include "CPU.h"
 #include "Debugger/Debug.h"
 #include "Interface.h"
+#include "Keyboard.h"
 #include "Log.h"
 #include "NTSC.h"
+#include "ProgramLoader.h"
 #include "Speaker.h"
 
 #include "apple2roms_data.h"
+#include "debugserver/DebugServerManager.h"
 
 namespace common2
 {
 
+    uint32_t ExecuteSlice(const uint32_t cycles, const bool videoUpdate)
+    {
+        const bool bootCachePending = BootCache_IsPending();
+        const uint32_t executedCycles =
+            bootCachePending ? BootCache_Execute(cycles, videoUpdate) : CpuExecute(cycles, videoUpdate);
+
+        GetCardMgr().Update(executedCycles);
+        SpkrUpdate(executedCycles);
+
+        g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executedCycles) % NTSC_GetCyclesPerFrame();
+
+        if (bootCachePending)
+        {
+            BootCache_Update();
+        }
+        ProgramLoader_Update();
+
+        return executedCycles;
+    }
+
+    uint32_t ExecuteSliceWithVideo(const uint32_t cycles)
+    {
+        return ExecuteSlice(cycles, true);
+    }
+
     CommonFrame::CommonFrame(const EmulatorOptions &options)
         : LinuxFrame(options.autoBoot)
         , mySpeed(options.fixedSpeed)
         , mySynchroniseWithTimer(options.syncWithTimer)
         , myAllowVideoUpdate(!options.noVideoUpdate)
+        , mySerialPort(options.serialPort)
+        , mySerialTurbo(options.serialTurbo)
     {
         myLastSync = std::chrono::steady_clock::now();
+        if (!options.frameHashes.empty())
+        {
+            myFrameHashes = std::make_unique<FrameHashWriter>(options.frameHashes);
+        }
+    }
+
+    CommonFrame::~CommonFrame() = default;
+
+    void CommonFrame::UpdateFrameHashes()
+    {
+        if (myFrameHashes)
+        {
+            myFrameHashes->update(false);
+        }
     }
 
     void CommonFrame::Begin()
     {
         LinuxFrame::Begin();
+        applySerialOptions(mySerialPort, mySerialTurbo);
         ResetSpeed();
         ResetHardware();
 
@@ -70,7 +118,7 @@ namespace common2
 
     bool CommonFrame::CanDoFullSpeed()
     {
-        return (g_dwSpeed == SPEED_MAX) ||
+        return (g_dwSpeed == SPEED_MAX) || KeybIsPasting() || CassetteTape::instance().isActive() ||
                (GetCardMgr().GetDisk2CardMgr().IsConditionForFullSpeed() && !Spkr_IsActive() &&
                 !GetCardMgr().GetMockingboardCardMgr().IsActiveToPreventFullSpeed()) ||
                IsDebugSteppingAtFullSpeed();
@@ -78,6 +126,15 @@ namespace common2
 
     void CommonFrame::ExecuteOneFrame(const int64_t microseconds)
     {
+        ProgramLoader_Update();
+
+        // remote commands also run when not executing (paused, debugger)
+        const AppMode_e mode = g_nAppMode;
+        if (DebugServer_ProcessCommands(ExecuteSliceWithVideo) && g_nAppMode != mode)
+        {
+            ResetSpeed(); // resumed: don't catch up on the time spent paused
+        }
+
         // when running in adaptive speed
         // the value msNextFrame is only a hint for when the next frame will arrive
         switch (g_nAppMode)
@@ -120,7 +177,6 @@ namespace common2
     void CommonFrame::Execute(const uint32_t cyclesToExecute)
     {
         const bool bVideoUpdate = myAllowVideoUpdate && !g_bFullSpeed;
-        const UINT dwClksPerFrame = NTSC_GetCyclesPerFrame();
 
         // do it in the same batches as AppleWin (1 ms)
         const uint32_t fExecutionPeriodClks = g_fCurrentCLK6502 * (1.0 / 1000.0); // 1 ms
@@ -131,13 +187,18 @@ namespace common2
         {
             _ASSERT(cyclesToExecute >= totalCyclesExecuted);
             const uint32_t thisCyclesToExecute = std::min(fExecutionPeriodClks, cyclesToExecute - totalCyclesExecuted);
-            const uint32_t executedCycles = CpuExecute(thisCyclesToExecute, bVideoUpdate);
-            totalCyclesExecuted += executedCycles;
+            totalCyclesExecuted += ExecuteSlice(thisCyclesToExecute, bVideoUpdate);
 
-            GetCardMgr().Update(executedCycles);
-            SpkrUpdate(executedCycles);
+            if (myFrameHashes)
+            {
+                myFrameHashes->update(!bVideoUpdate);
+            }
 
-            g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executedCycles) % dwClksPerFrame;
+            // remote commands, at an instruction boundary every ms
+            if (DebugServer_ProcessCommands(ExecuteSliceWithVideo) && g_nAppMode != MODE_RUNNING)
+            {
+                break; // paused
+            }
 
         } while (totalCyclesExecuted < cyclesToExecute);
     }
@@ -192,6 +253,7 @@ namespace common2
     void CommonFrame::LoadSnapshot()
     {
         LinuxFrame::LoadSnapshot();
+        applySerialOptions(mySerialPort, mySerialTurbo);
         ResetSpeed();
         ResetHardware();
     }
@@ -7,14 +7,26 @@
 
 #include "frontends/common2/speed.h"
 
+#include <memory>
+#include <string>
+
 namespace common2
 {
     struct EmulatorOptions;
+    class FrameHashWriter;
+
+    // One slice of CommonFrame::Execute() (about 1 ms, 0: 1 instruction): the CPU (or the boot cache), the cards,
+    // the speaker and the frame cycle count. Also for whatever else runs the emulator (debug server, scripts).
+    uint32_t ExecuteSlice(const uint32_t cycles, const bool videoUpdate);
+
+    // ExecuteSlice() with the video, for DebugServer_ProcessCommands()
+    uint32_t ExecuteSliceWithVideo(const uint32_t cycles);
 
     class CommonFrame : public LinuxFrame
     {
     public:
         CommonFrame(const EmulatorOptions &options);
+        ~CommonFrame();
 
         void Begin() override;
 
@@ -35,6 +47,9 @@ namespace common2
 
         void LoadSnapshot() override;
 
+        // --frame-hashes, after executing cycles (with video update) outside of ExecuteOneFrame()
+        void UpdateFrameHashes();
+
     protected:
         virtual void SetFullSpeed(const bool value);
         virtual bool CanDoFullSpeed();
@@ -51,7 +66,10 @@ namespace common2
 
     private:
         const bool myAllowVideoUpdate;
+        const std::string mySerialPort; // re-applied by Begin() & LoadSnapshot()
+        const bool mySerialTurbo;
         CConfigNeedingRestart myHardwareConfig;
+        std::unique_ptr<FrameHashWriter> myFrameHashes;
     };
 
 } // namespace common2
@@ -0,0 +1,442 @@
+#include "StdAfx.h"
+#include "frontends/common2/memoryinspector.h"
+
+#include "Core.h"
+#include "Memory.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+
+    constexpr size_t BLOCK_SIZE = 64; // bytes per uint64_t of candidate bits
+
+    // 8 bytes of 0/1 -> 8 bits (byte i -> bit i)
+    inline uint64_t packFlags(const uint8_t *flags)
+    {
+        uint64_t x;
+        memcpy(&x, flags, sizeof(x));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        x = __builtin_bswap64(x);
+#endif
+        return (x * 0x0102040810204080ULL) >> 56;
+    }
+
+    // the compiler vectorises the per-byte comparison, the packing is 8 multiplications
+    template <typename Predicate> uint64_t compareBlock(const uint8_t *current, const uint8_t *last, Predicate predicate)
+    {
+        uint8_t flags[BLOCK_SIZE];
+        for (size_t i = 0; i < BLOCK_SIZE; ++i)
+        {
+            flags[i] = predicate(current[i], last[i]) ? 1 : 0;
+        }
+
+        uint64_t bits = 0;
+        for (size_t i = 0; i < BLOCK_SIZE; i += 8)
+        {
+            bits |= packFlags(flags + i) << i;
+        }
+        return bits;
+    }
+
+    // unchanged: the result for a block that hasn't changed since the last scan (all or none), or -1 to compare
+    template <typename Predicate>
+    void narrow(
+        const std::vector<uint8_t *> &banks, std::vector<uint64_t> &candidates, std::vector<uint8_t> &scanValues,
+        const int unchanged, Predicate predicate)
+    {
+        constexpr size_t blocksPerBank = common2::MemoryInspector::BANK_SIZE / BLOCK_SIZE;
+        for (size_t w = 0; w < candidates.size(); ++w)
+        {
+            uint64_t bits = candidates[w];
+            if (!bits)
+            {
+                continue;
+            }
+
+            const uint8_t *current = banks[w / blocksPerBank] + (w % blocksPerBank) * BLOCK_SIZE;
+            uint8_t *last = scanValues.data() + w * BLOCK_SIZE;
+            if (unchanged >= 0 && !memcmp(current, last, BLOCK_SIZE))
+            {
+                // most of the memory: no need to compare byte by byte (or to update the values)
+                candidates[w] = unchanged ? bits : 0;
+                continue;
+            }
+
+            bits &= compareBlock(current, last, predicate);
+
+            candidates[w] = bits;
+            if (bits)
+            {
+                memcpy(last, current, BLOCK_SIZE);
+            }
+        }
+    }
+
+    bool matchMasked(const uint8_t *p, const uint8_t *pattern, const uint8_t *mask, const size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            if ((p[i] ^ pattern[i]) & mask[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+namespace common2
+{
+
+    void MemoryInspector::refreshBanks() const
+    {
+        myBanks.clear();
+
+        // flush the 'mem' cache once, then the raw banks
+        myBanks.push_back(MemGetBankPtr(0, true));
+
+        if (IsAppleIIeOrAbove(GetApple2Type()) && !IsIIeWithoutAuxMem())
+        {
+            const UINT auxBanks = GetRamWorksMemorySize();
+            for (UINT bank = 1; bank <= auxBanks; ++bank)
+            {
+                uint8_t *ptr = MemGetBankPtr(bank, false);
+                if (!ptr)
+                {
+                    break;
+                }
+                myBanks.push_back(ptr);
+            }
+        }
+    }
+
+    const uint8_t *MemoryInspector::getPtr(const size_t offset) const
+    {
+        return myBanks[offset / BANK_SIZE] + (offset % BANK_SIZE);
+    }
+
+    size_t MemoryInspector::getNumberOfBanks() const
+    {
+        refreshBanks();
+        return myBanks.size();
+    }
+
+    size_t MemoryInspector::getSize() const
+    {
+        return getNumberOfBanks() * BANK_SIZE;
+    }
+
+    uint8_t MemoryInspector::read(const size_t offset) const
+    {
+        return offset < myBanks.size() * BANK_SIZE ? *getPtr(offset) : 0;
+    }
+
+    void MemoryInspector::update()
+    {
+        refreshBanks();
+        const size_t size = myBanks.size() * BANK_SIZE;
+
+        ++myGeneration;
+        if (myPrevious.size() != size)
+        {
+            // new configuration: everything has changed
+            myPrevious.resize(size);
+            myPageGenerations.assign(size / PAGE_SIZE, myGeneration);
+            for (size_t bank = 0; bank < myBanks.size(); ++bank)
+            {
+                memcpy(myPrevious.data() + bank * BANK_SIZE, myBanks[bank], BANK_SIZE);
+            }
+            return;
+        }
+
+        for (size_t page = 0; page < myPageGenerations.size(); ++page)
+        {
+            const size_t offset = page * PAGE_SIZE;
+            const uint8_t *current = getPtr(offset);
+            uint8_t *previous = myPrevious.data() + offset;
+            if (memcmp(current, previous, PAGE_SIZE))
+            {
+                memcpy(previous, current, PAGE_SIZE);
+                myPageGenerations[page] = myGeneration;
+            }
+        }
+    }
+
+    uint64_t MemoryInspector::getGeneration() const
+    {
+        return myGeneration;
+    }
+
+    uint64_t MemoryInspector::getPageGeneration(const size_t offset) const
+    {
+        const size_t page = offset / PAGE_SIZE;
+        return page < myPageGenerations.size() ? myPageGenerations[page] : 0;
+    }
+
+    void MemoryInspector::takeSnapshot()
+    {
+        refreshBanks();
+        mySnapshot.resize(myBanks.size() * BANK_SIZE);
+        for (size_t bank = 0; bank < myBanks.size(); ++bank)
+        {
+            memcpy(mySnapshot.data() + bank * BANK_SIZE, myBanks[bank], BANK_SIZE);
+        }
+    }
+
+    bool MemoryInspector::hasSnapshot() const
+    {
+        return !mySnapshot.empty();
+    }
+
+    uint8_t MemoryInspector::readSnapshot(const size_t offset) const
+    {
+        return offset < mySnapshot.size() ? mySnapshot[offset] : 0;
+    }
+
+    std::vector<MemoryInspector::Range> MemoryInspector::diffSnapshot(const size_t maxRanges) const
+    {
+        refreshBanks();
+        std::vector<Range> ranges;
+
+        const size_t size = std::min(mySnapshot.size(), myBanks.size() * BANK_SIZE);
+        for (size_t page = 0; page < size / PAGE_SIZE && ranges.size() < maxRanges; ++page)
+        {
+            const size_t offset = page * PAGE_SIZE;
+            const uint8_t *current = getPtr(offset);
+            const uint8_t *snapshot = mySnapshot.data() + offset;
+            if (!memcmp(current, snapshot, PAGE_SIZE))
+            {
+                continue;
+            }
+
+            for (size_t i = 0; i < PAGE_SIZE; ++i)
+            {
+                if (current[i] == snapshot[i])
+                {
+                    continue;
+                }
+
+                // extend the previous range if contiguous (also across pages)
+                if (!ranges.empty() && ranges.back().end == offset + i)
+                {
+                    ranges.back().end = offset + i + 1;
+                }
+                else if (ranges.size() < maxRanges)
+                {
+                    ranges.push_back({offset + i, offset + i + 1});
+                }
+                else
+                {
+                    break;
+                }
+            }
+        }
+
+        return ranges;
+    }
+
+    bool MemoryInspector::parsePattern(const std::string &text, std::vector<uint8_t> &pattern, std::vector<uint8_t> &mask)
+    {
+        pattern.clear();
+        mask.clear();
+
+        const size_t quote = text.find('"');
+        if (quote != std::string::npos)
+        {
+            const size_t end = text.find('"', quote + 1);
+            for (size_t i = quote + 1; i < text.size() && i != end; ++i)
+            {
+                pattern.push_back(text[i] & 0x7F);
+                mask.push_back(0x7F);
+            }
+            return !pattern.empty();
+        }
+
+        std::string nibbles;
+        for (const char c : text)
+        {
+            if (isxdigit(static_cast<unsigned char>(c)) || c == '?')
+            {
+                nibbles.push_back(c);
+            }
+            else if (!isspace(static_cast<unsigned char>(c)))
+            {
+                return false;
+            }
+        }
+
+        if (nibbles.empty() || nibbles.size() % 2)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < nibbles.size(); i += 2)
+        {
+            uint8_t value = 0;
+            uint8_t bits = 0;
+            for (size_t j = 0; j < 2; ++j)
+            {
+                const char c = nibbles[i + j];
+                value <<= 4;
+                bits <<= 4;
+                if (c != '?')
+                {
+                    value |= isdigit(static_cast<unsigned char>(c)) ? c - '0' : (toupper(c) - 'A' + 10);
+                    bits |= 0x0F;
+                }
+            }
+            pattern.push_back(value);
+            mask.push_back(bits);
+        }
+        return true;
+    }
+
+    std::vector<size_t> MemoryInspector::search(
+        const std::vector<uint8_t> &pattern, const std::vector<uint8_t> &mask, const size_t maxResults) const
+    {
+        refreshBanks();
+        std::vector<size_t> results;
+
+        const size_t size = pattern.size();
+        if (!size || size > BANK_SIZE || mask.size() != size)
+        {
+            return results;
+        }
+
+        const bool exact = std::all_of(mask.begin(), mask.end(), [](const uint8_t m) { return m == 0xFF; });
+
+        // the anchor is the 1st exact byte: memchr() finds the possible matches, then they are checked with the mask
+        const auto anchorIt = std::find(mask.begin(), mask.end(), 0xFF);
+        const size_t anchor = anchorIt - mask.begin();
+
+        for (size_t bank = 0; bank < myBanks.size() && results.size() < maxResults; ++bank)
+        {
+            const uint8_t *begin = myBanks[bank];
+            const uint8_t *end = begin + BANK_SIZE - size + 1; // last possible start + 1
+            const uint8_t *p = begin;
+
+            while (p < end && results.size() < maxResults)
+            {
+                const uint8_t *match;
+                if (exact)
+                {
+                    match = static_cast<const uint8_t *>(memmem(p, end - p + size - 1, pattern.data(), size));
+                }
+                else if (anchor < size)
+                {
+                    match = static_cast<const uint8_t *>(memchr(p + anchor, pattern[anchor], end - p));
+                    if (match)
+                    {
+                        match -= anchor;
+                        if (!matchMasked(match, pattern.data(), mask.data(), size))
+                        {
+                            p = match + 1;
+                            continue;
+                        }
+                    }
+                }
+                else
+                {
+                    match = p;
+                    while (match < end && !matchMasked(match, pattern.data(), mask.data(), size))
+                    {
+                        ++match;
+                    }
+                    if (match == end)
+                    {
+                        match = nullptr;
+                    }
+                }
+
+                if (!match)
+                {
+                    break;
+                }
+
+                results.push_back(bank * BANK_SIZE + (match - begin));
+                p = match + 1;
+            }
+        }
+
+        return results;
+    }
+
+    void MemoryInspector::scanStart()
+    {
+        takeSnapshot(); // refreshes the banks
+
+        const size_t size = myBanks.size() * BANK_SIZE;
+        myCandidates.assign(size / BLOCK_SIZE, ~uint64_t(0));
+        myScanValues = mySnapshot;
+    }
+
+    void MemoryInspector::scan(const Scan type, const uint8_t value)
+    {
+        refreshBanks();
+        if (myScanValues.size() != myBanks.size() * BANK_SIZE)
+        {
+            // configuration changed
+            myCandidates.clear();
+            myScanValues.clear();
+            return;
+        }
+
+        switch (type)
+        {
+        case Scan::Equal:
+            narrow(myBanks, myCandidates, myScanValues, -1, [value](uint8_t c, uint8_t) { return c == value; });
+            break;
+        case Scan::NotEqual:
+            narrow(myBanks, myCandidates, myScanValues, -1, [value](uint8_t c, uint8_t) { return c != value; });
+            break;
+        case Scan::Changed:
+            narrow(myBanks, myCandidates, myScanValues, 0, [](uint8_t c, uint8_t l) { return c != l; });
+            break;
+        case Scan::Unchanged:
+            narrow(myBanks, myCandidates, myScanValues, 1, [](uint8_t c, uint8_t l) { return c == l; });
+            break;
+        case Scan::Increased:
+            narrow(myBanks, myCandidates, myScanValues, 0, [](uint8_t c, uint8_t l) { return c > l; });
+            break;
+        case Scan::Decreased:
+            narrow(myBanks, myCandidates, myScanValues, 0, [](uint8_t c, uint8_t l) { return c < l; });
+            break;
+        }
+    }
+
+    size_t MemoryInspector::getNumberOfCandidates() const
+    {
+        size_t count = 0;
+        for (const uint64_t bits : myCandidates)
+        {
+            count += __builtin_popcountll(bits);
+        }
+        return count;
+    }
+
+    std::vector<size_t> MemoryInspector::getCandidates(const size_t maxResults) const
+    {
+        std::vector<size_t> results;
+        for (size_t w = 0; w < myCandidates.size() && results.size() < maxResults; ++w)
+        {
+            uint64_t bits = myCandidates[w];
+            while (bits && results.size() < maxResults)
+            {
+                const int i = __builtin_ctzll(bits);
+                results.push_back(w * BLOCK_SIZE + i);
+                bits &= bits - 1;
+            }
+        }
+        return results;
+    }
+
+    uint8_t MemoryInspector::readScanValue(const size_t offset) const
+    {
+        return offset < myScanValues.size() ? myScanValues[offset] : 0;
+    }
+
+} // namespace common2
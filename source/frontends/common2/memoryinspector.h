@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace common2
+{
+
+    // The physical RAM as a single linear space of 64K banks
+    // bank 0 = main, bank 1 = aux, banks 2+ = RamWorks III (up to 8MB)
+    //
+    // - change tracking: a generation counter per page, bumped by update() (once per frame)
+    // - snapshot: keep a copy to diff against later
+    // - search: byte patterns with a per-byte mask (0xFF = exact, 0x00 = any)
+    // - cheat finder: start with every byte as a candidate, then narrow down by value or by change since the last scan
+    class MemoryInspector
+    {
+    public:
+        static constexpr size_t BANK_SIZE = 0x10000;
+        static constexpr size_t PAGE_SIZE = 0x100;
+
+        enum class Scan
+        {
+            Equal,     // == value
+            NotEqual,  // != value
+            Changed,   // since the last scan
+            Unchanged,
+            Increased,
+            Decreased,
+        };
+
+        struct Range
+        {
+            size_t begin;
+            size_t end; // exclusive
+        };
+
+        size_t getNumberOfBanks() const;
+        size_t getSize() const;
+        uint8_t read(const size_t offset) const; // current value, in the banks as of the last call (eg. update())
+
+        // change tracking
+        void update();
+        uint64_t getGeneration() const;
+        uint64_t getPageGeneration(const size_t offset) const; // 0 if never changed (or before the 1st update)
+
+        // snapshot diff
+        void takeSnapshot();
+        bool hasSnapshot() const;
+        uint8_t readSnapshot(const size_t offset) const;
+        std::vector<Range> diffSnapshot(const size_t maxRanges) const;
+
+        // search (matches don't span banks)
+        // text: hex bytes with ? for any nibble ("A9 ?? 8D"), or "quoted" Apple II text (either high bit)
+        static bool parsePattern(const std::string &text, std::vector<uint8_t> &pattern, std::vector<uint8_t> &mask);
+        std::vector<size_t> search(
+            const std::vector<uint8_t> &pattern, const std::vector<uint8_t> &mask, const size_t maxResults) const;
+
+        // cheat finder
+        void scanStart();
+        void scan(const Scan type, const uint8_t value = 0);
+        size_t getNumberOfCandidates() const;
+        std::vector<size_t> getCandidates(const size_t maxResults) const;
+        uint8_t readScanValue(const size_t offset) const;
+
+    private:
+        mutable std::vector<uint8_t *> myBanks; // refreshed by each call: the banks can be reallocated/resized
+
+        uint64_t myGeneration = 0;
+        std::vector<uint8_t> myPrevious;
+        std::vector<uint64_t> myPageGenerations;
+
+        std::vector<uint8_t> mySnapshot;
+
+        std::vector<uint64_t> myCandidates; // 1 bit per byte
+        std::vector<uint8_t> myScanValues;  // values at the last scan
+
+        void refreshBanks() const;
+        const uint8_t *getPtr(const size_t offset) const;
+    };
+
+} // namespace common2
@@ -0,0 +1,259 @@
+#include "StdAfx.h"
+#include "frontends/common2/memoryreport.h"
+
+#include "Card.h"
+#include "CardManager.h"
+#include "Core.h"
+#include "Disk.h"
+#include "Harddisk.h"
+#include "Interface.h"
+#include "Memory.h"
+#include "NTSC.h"
+#include "RGBMonitor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+
+    // Rss of the mapping [begin, end) in /proc/self/smaps, if the block is a mapping of its own
+    // (mincore() also reports the shared zero page behind never written anonymous memory as resident)
+    bool getMappingRss(const uintptr_t begin, const uintptr_t end, size_t &rss)
+    {
+        FILE *fp = fopen("/proc/self/smaps", "r");
+        if (!fp)
+        {
+            return false;
+        }
+
+        bool found = false;
+        bool inside = false;
+        char line[512];
+        while (fgets(line, sizeof(line), fp))
+        {
+            unsigned long from, to;
+            if (sscanf(line, "%lx-%lx ", &from, &to) == 2)
+            {
+                inside = from == begin && to <= end;
+            }
+            else if (inside && strncmp(line, "Rss:", 4) == 0)
+            {
+                rss = std::strtoul(line + 4, nullptr, 10) * 1024;
+                found = true;
+                break;
+            }
+        }
+        fclose(fp);
+        return found;
+    }
+
+    // bytes of [ptr, ptr + size) backed by memory
+    size_t getResidentSize(const void *ptr, const size_t size)
+    {
+        if (!ptr || !size)
+        {
+            return 0;
+        }
+
+        const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(pageSize - 1);
+        const uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+
+        size_t rss;
+        if (begin == reinterpret_cast<uintptr_t>(ptr) && getMappingRss(begin, (end + pageSize - 1) & ~(pageSize - 1), rss))
+        {
+            return std::min(rss, size);
+        }
+
+        std::vector<unsigned char> pages((end - begin + pageSize - 1) / pageSize);
+        if (mincore(reinterpret_cast<void *>(begin), end - begin, pages.data()) != 0)
+        {
+            return size;
+        }
+
+        size_t resident = 0;
+        for (size_t i = 0; i < pages.size(); ++i)
+        {
+            if (pages[i] & 1)
+            {
+                // only count the part of the 1st & last pages inside the block
+                const uintptr_t pageBegin = std::max(begin + i * pageSize, reinterpret_cast<uintptr_t>(ptr));
+                const uintptr_t pageEnd = std::min(begin + (i + 1) * pageSize, end);
+                resident += pageEnd - pageBegin;
+            }
+        }
+        return resident;
+    }
+
+    // "VmRSS:      9216 kB" -> bytes
+    size_t getStatusValue(const std::string &status, const char *key)
+    {
+        const size_t pos = status.find(key);
+        if (pos == std::string::npos)
+        {
+            return 0;
+        }
+        return std::strtoul(status.c_str() + pos + strlen(key), nullptr, 10) * 1024;
+    }
+
+    std::string readStatus()
+    {
+        std::string status;
+        FILE *fp = fopen("/proc/self/status", "r");
+        if (fp)
+        {
+            char buffer[4096];
+            size_t n;
+            while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+            {
+                status.append(buffer, n);
+            }
+            fclose(fp);
+        }
+        return status;
+    }
+
+} // namespace
+
+namespace common2
+{
+
+    MemoryReport::MemoryReport()
+    {
+        // memory
+        add("memory", "main", MemGetBankPtr(0, false), _6502_MEM_LEN);
+        add("memory", "aux", MemGetBankPtr(1, false), _6502_MEM_LEN);
+        add("memory", "'mem' image", mem, _6502_MEM_LEN, true);
+        add("memory", "Cx ROM", MemGetCxRomPeripheral(), 4 * 1024);
+
+        const UINT numAuxBanks = GetRamWorksMemorySize();
+        if (numAuxBanks > 1 && MemGetBankPtr(2, false))
+        {
+            // one region (see AllocRamWorksBanks())
+            add("memory", "RamWorks banks", MemGetBankPtr(2, false), (numAuxBanks - 1) * _6502_MEM_LEN);
+        }
+
+        // video
+        Video &video = GetVideo();
+        if (video.GetFrameBuffer())
+        {
+            const size_t size = size_t(video.GetFrameBufferWidth()) * video.GetFrameBufferHeight() * sizeof(bgra_t);
+            add("video", "frame buffer", video.GetFrameBuffer(), size);
+        }
+        addEstimated("video", "RGB source image", RGB_GetSourceImageSize(), false);
+
+        size_t chromaPrivate, chromaShared;
+        NTSC_GetChromaTablesMemory(chromaPrivate, chromaShared);
+        addEstimated("video", "NTSC chroma tables", chromaPrivate, false);
+        if (chromaShared)
+        {
+            addEstimated("video", "NTSC chroma tables (mmap'ed cache)", chromaShared, true);
+        }
+
+        // disks
+        size_t floppy = 0;
+        size_t hardDisk = 0;
+        CardManager &cardManager = GetCardMgr();
+        for (UINT slot = SLOT0; slot < NUM_SLOTS; ++slot)
+        {
+            switch (cardManager.QuerySlot(slot))
+            {
+            case CT_Disk2:
+                floppy += dynamic_cast<Disk2InterfaceCard &>(cardManager.GetRef(slot)).GetImageBufferSize();
+                break;
+            case CT_GenericHDD:
+                hardDisk += dynamic_cast<HarddiskInterfaceCard &>(cardManager.GetRef(slot)).GetImageBufferSize();
+                break;
+            default:
+                break;
+            }
+        }
+        addEstimated("disk", "floppy image buffers", floppy, false);
+        addEstimated("disk", "hard disk image buffers", hardDisk, false);
+
+        const std::string status = readStatus();
+        myResident = getStatusValue(status, "VmRSS:");
+        myAnonymous = getStatusValue(status, "RssAnon:");
+        myFile = getStatusValue(status, "RssFile:") + getStatusValue(status, "RssShmem:");
+    }
+
+    void MemoryReport::add(
+        const std::string &subsystem, const std::string &name, const void *ptr, const size_t size,
+        const bool fileBacked)
+    {
+        if (ptr)
+        {
+            myBlocks.push_back({subsystem, name, size, getResidentSize(ptr, size), fileBacked});
+        }
+    }
+
+    void MemoryReport::addEstimated(
+        const std::string &subsystem, const std::string &name, const size_t size, const bool fileBacked)
+    {
+        myBlocks.push_back({subsystem, name, size, size, fileBacked});
+    }
+
+    const std::vector<MemoryReport::Block> &MemoryReport::getBlocks() const
+    {
+        return myBlocks;
+    }
+
+    size_t MemoryReport::getResident() const
+    {
+        return myResident;
+    }
+
+    size_t MemoryReport::getAnonymous() const
+    {
+        return myAnonymous;
+    }
+
+    size_t MemoryReport::getFile() const
+    {
+        return myFile;
+    }
+
+    size_t MemoryReport::getOther() const
+    {
+        size_t blocks = 0;
+        for (const Block &block : myBlocks)
+        {
+            if (!block.fileBacked)
+            {
+                blocks += block.resident;
+            }
+        }
+        return myAnonymous > blocks ? myAnonymous - blocks : 0;
+    }
+
+    void MemoryReport::print(std::ostream &os) const
+    {
+        const auto kB = [](const size_t bytes) { return (bytes + 1023) / 1024; };
+
+        os << "Memory report (kB)" << std::endl;
+        os << std::left << std::setw(10) << "subsystem" << std::setw(38) << "block" << std::right << std::setw(10)
+           << "size" << std::setw(10) << "resident" << std::endl;
+
+        for (const Block &block : myBlocks)
+        {
+            os << std::left << std::setw(10) << block.subsystem << std::setw(38) << block.name << std::right
+               << std::setw(10) << kB(block.size) << std::setw(10) << kB(block.resident)
+               << (block.fileBacked ? "  (file)" : "") << std::endl;
+        }
+
+        os << std::left << std::setw(48) << "other anonymous (heap, stacks, .data/.bss)" << std::right
+           << std::setw(20) << kB(getOther()) << std::endl;
+        os << std::left << std::setw(48) << "file backed (code, libraries, mmap'ed files)" << std::right
+           << std::setw(20) << kB(myFile) << std::endl;
+        os << std::left << std::setw(48) << "total (VmRSS)" << std::right << std::setw(20) << kB(myResident)
+           << std::endl;
+    }
+
+} // namespace common2
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace common2
+{
+
+    // Where the resident memory of this instance goes (--memory-report)
+    //
+    // - blocks: the large allocations of each subsystem, with how much of each is actually resident
+    //   (RamWorks banks and the frame buffer are only backed by memory once written)
+    // - totals: from /proc/self/status, "other" is what is not accounted for by the blocks
+    class MemoryReport
+    {
+    public:
+        struct Block
+        {
+            std::string subsystem;
+            std::string name;
+            size_t size;
+            size_t resident;
+            bool fileBacked; // in RssFile, not RssAnon (the mmap'ed chroma table cache is shared by all the instances)
+        };
+
+        MemoryReport(); // takes the measurements
+
+        const std::vector<Block> &getBlocks() const;
+        size_t getResident() const;  // VmRSS
+        size_t getAnonymous() const; // RssAnon
+        size_t getFile() const;      // RssFile + RssShmem
+        size_t getOther() const;     // RssAnon not in the private blocks
+
+        void print(std::ostream &os) const;
+
+    private:
+        std::vector<Block> myBlocks;
+        size_t myResident = 0;
+        size_t myAnonymous = 0;
+        size_t myFile = 0;
+
+        void add(
+            const std::string &subsystem, const std::string &name, const void *ptr, const size_t size,
+            const bool fileBacked = false);
+        // no pointer to the block: assumed resident
+        void addEstimated(
+            const std::string &subsystem, const std::string &name, const size_t size, const bool fileBacked);
+    };
+
+} // namespace common2
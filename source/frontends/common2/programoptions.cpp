@@ -10,6 +10,12 @@
 #include "Speaker.h"
 #include "Riff.h"
 #include "CardManager.h"
+#include "BootCache.h"
+#include "NTSC.h"
+#include "SerialComms.h"
+#include "Memory.h"
+#include "MouseInterface.h"
+#include "linux/cassettetape.h"
 
 namespace common2
 {
@@ -107,6 +113,57 @@ namespace common2
         }
 
         Paddle::setSquaring(options.paddleSquaring);
+
+        if (!options.ntscCache.empty())
+        {
+            NTSC_SetChromaTableCache(options.ntscCache);
+        }
+
+        MemSetBankSwitchByPointer(options.bankSwitchByPointer);
+
+        CMouseInterface::SetFirmwareFastPathDefault(options.mouseFastPath);
+        CMouseInterface *pMouse = GetCardMgr().GetMouseCard();
+        if (pMouse)
+        {
+            pMouse->SetFirmwareFastPath(options.mouseFastPath);
+        }
+
+        CassetteTape &tape = CassetteTape::instance();
+        tape.setFastLoad(options.tapeFastLoad);
+        tape.setTurbo(options.tapeTurbo);
+        if (!options.tapeRecord.empty())
+        {
+            tape.startRecording(options.tapeRecord);
+        }
+
+        if (!options.bootCacheDirectory.empty())
+        {
+            if (!BootCache_SetTrigger(options.bootCacheTrigger))
+            {
+                throw std::runtime_error("Invalid boot cache trigger: " + options.bootCacheTrigger);
+            }
+            BootCache_SetDirectory(options.bootCacheDirectory);
+        }
+    }
+
+    void applySerialOptions(const std::string &serialPort, const bool serialTurbo)
+    {
+        // not saved to the registry: an fd:<n> only exists in this process
+        CSuperSerialCard *pSSC = GetCardMgr().GetSSC();
+        if (!serialPort.empty())
+        {
+            if (!pSSC)
+            {
+                GetCardMgr().Insert(SLOT2, CT_SSC, false);
+                MemInitializeIO();
+                pSSC = GetCardMgr().GetSSC();
+            }
+            pSSC->SetSerialPortName(serialPort.c_str());
+        }
+        if (pSSC)
+        {
+            pSSC->SetTurbo(serialTurbo);
+        }
     }
 
 } // namespace common2
@@ -29,19 +29,34 @@ namespace common2
         std::string snapshotFilename;
         bool loadSnapshot = false;
 
+        std::string bootCacheDirectory;
+        std::string bootCacheTrigger = "key";
+
+        std::string loadProgram;
+        int loadProgramAddress = -1; // -1 = default for the program type
+        bool loadProgramRun = false;
+
+        std::string ntscCache;
+
         int memclear;
+        bool bankSwitchByPointer = true; // drop the 'mem' cache when bank switching is heavy
+        bool memoryReport = false;       // see MemoryReport
+        std::string frameHashes;         // see FrameHashWriter
 
         bool log = false;
 
         bool benchmark = false;
         bool headless = false;
         bool noVideoUpdate = false; // only for applen
+        std::string script;         // see ScriptEngine
 
         bool paddleSquaring = true; // turn the x/y range to a square
         // on my PC it is something like
         // "/dev/input/by-id/usb-©Microsoft_Corporation_Controller_1BBE3DB-event-joystick"
         std::string paddleDeviceName;
 
+        bool mouseFastPath = true; // READMOUSE, POSMOUSE & CLAMPMOUSE without the firmware's PIA handshake
+
         std::filesystem::path configurationFile;
         bool useQtIni = false; // use Qt .ini file (read only)
 
@@ -72,8 +87,18 @@ namespace common2
         std::vector<std::string> registryOptions;
 
         std::vector<std::string> natPortFwds;
+
+        std::string serialPort; // see SerialBackend::create()
+        bool serialTurbo = false;
+
+        std::string tapeRecord;
+        bool tapeFastLoad = true;
+        bool tapeTurbo = true;
     };
 
     void applyOptions(const EmulatorOptions &options);
 
+    // --serial & --serial-turbo: after every LinuxFrame::Begin() & save-state load, as they re-create the cards
+    void applySerialOptions(const std::string &serialPort, const bool serialTurbo);
+
 } // namespace common2
@@ -0,0 +1,748 @@
+#include "StdAfx.h"
+#include "frontends/common2/scriptengine.h"
+#include "frontends/common2/commonframe.h"
+#include "frontends/common2/videooracle.h"
+
+#include "Core.h"
+#include "CPU.h"
+#include "Keyboard.h"
+#include "Memory.h"
+#include "Debugger/Debug.h"
+#include "Debugger/Debugger_Console.h"
+#include "linux/keyboardbuffer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+
+    std::ostream *theConsoleOutput = nullptr;
+
+    void consoleToOutput(const conchar_t *text)
+    {
+        std::string line;
+        for (size_t i = 0; i < CONSOLE_WIDTH && text[i]; ++i)
+        {
+            line += ConsoleChar_GetChar(text[i]);
+        }
+        line.erase(line.find_last_not_of(' ') + 1);
+        *theConsoleOutput << line << std::endl;
+    }
+
+    std::string lower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+        return text;
+    }
+
+    std::string trim(const std::string &text)
+    {
+        const size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos)
+        {
+            return std::string();
+        }
+        const size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    // "text" at pos (with \r, \n, \" and \\), pos is moved past the closing quote
+    std::string parseString(const std::string &text, size_t &pos)
+    {
+        std::string result;
+        for (++pos; pos < text.size() && text[pos] != '"'; ++pos)
+        {
+            char c = text[pos];
+            if (c == '\\' && pos + 1 < text.size())
+            {
+                c = text[++pos];
+                c = c == 'r' ? '\r' : c == 'n' ? '\n' : c;
+            }
+            result += c;
+        }
+        if (pos >= text.size())
+        {
+            throw std::runtime_error("missing \"");
+        }
+        ++pos;
+        return result;
+    }
+
+    bool isIdentifier(const char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    bool isReserved(const std::string &name)
+    {
+        static const char *const reserved[] = {"pc", "a", "x", "y", "sp", "p", "cycles"};
+        const std::string key = lower(name);
+        return std::any_of(std::begin(reserved), std::end(reserved), [&key](const char *r) { return key == r; });
+    }
+
+} // namespace
+
+namespace common2
+{
+
+    // precedence climbing over the C operators
+    class ExpressionParser
+    {
+    public:
+        ExpressionParser(ScriptEngine &engine, const std::string &text) : myEngine(engine), myText(text)
+        {
+        }
+
+        int64_t parse(const int precedence = 1)
+        {
+            int64_t left = unary();
+            while (true)
+            {
+                skipSpaces();
+                const std::string op = binaryOperator();
+                const int opPrecedence = getPrecedence(op);
+                if (!opPrecedence || opPrecedence < precedence)
+                {
+                    return left;
+                }
+                myPos += op.size();
+                const int64_t right = parse(opPrecedence + 1);
+                left = apply(op, left, right);
+            }
+        }
+
+        size_t getPosition() const
+        {
+            return myPos;
+        }
+
+    private:
+        ScriptEngine &myEngine;
+        const std::string &myText;
+        size_t myPos = 0;
+
+        void skipSpaces()
+        {
+            while (myPos < myText.size() && std::isspace(static_cast<unsigned char>(myText[myPos])))
+            {
+                ++myPos;
+            }
+        }
+
+        bool accept(const char c)
+        {
+            skipSpaces();
+            if (myPos < myText.size() && myText[myPos] == c)
+            {
+                ++myPos;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(const char c)
+        {
+            if (!accept(c))
+            {
+                throw std::runtime_error(std::string("expected '") + c + "'");
+            }
+        }
+
+        std::string binaryOperator() const
+        {
+            static const char *const operators[] = {"||", "&&", "==", "!=", "<=", ">=", "<<", ">>", "|", "^", "&",
+                                                    "<",  ">",  "+",  "-",  "*",  "/",  "%"};
+            for (const char *op : operators)
+            {
+                if (myText.compare(myPos, strlen(op), op) == 0)
+                {
+                    return op;
+                }
+            }
+            return std::string();
+        }
+
+        static int getPrecedence(const std::string &op)
+        {
+            static const std::map<std::string, int> precedences = {
+                {"||", 1}, {"&&", 2}, {"|", 3},  {"^", 4},  {"&", 5},  {"==", 6}, {"!=", 6}, {"<", 7},  {"<=", 7},
+                {">", 7},  {">=", 7}, {"<<", 8}, {">>", 8}, {"+", 9},  {"-", 9},  {"*", 10}, {"/", 10}, {"%", 10},
+            };
+            const auto it = precedences.find(op);
+            return it == precedences.end() ? 0 : it->second;
+        }
+
+        static int64_t apply(const std::string &op, const int64_t left, const int64_t right)
+        {
+            switch (op[0])
+            {
+            case '|':
+                return op.size() == 2 ? (left || right) : (left | right);
+            case '&':
+                return op.size() == 2 ? (left && right) : (left & right);
+            case '^':
+                return left ^ right;
+            case '=':
+                return left == right;
+            case '!':
+                return left != right;
+            case '<':
+                return op == "<<" ? left << right : op == "<=" ? left <= right : left < right;
+            case '>':
+                return op == ">>" ? left >> right : op == ">=" ? left >= right : left > right;
+            case '+':
+                return left + right;
+            case '-':
+                return left - right;
+            case '*':
+                return left * right;
+            default:
+                if (!right)
+                {
+                    throw std::runtime_error("division by zero");
+                }
+                return op == "/" ? left / right : left % right;
+            }
+        }
+
+        int64_t unary()
+        {
+            if (accept('-'))
+            {
+                return -unary();
+            }
+            if (accept('~'))
+            {
+                return ~unary();
+            }
+            if (accept('!'))
+            {
+                return !unary();
+            }
+            return primary();
+        }
+
+        int64_t number(const int base)
+        {
+            const size_t begin = myPos;
+            while (myPos < myText.size() && std::isxdigit(static_cast<unsigned char>(myText[myPos])))
+            {
+                ++myPos;
+            }
+            const std::string digits = myText.substr(begin, myPos - begin);
+            size_t used = 0;
+            int64_t value = 0;
+            try
+            {
+                value = std::stoll(digits, &used, base);
+            }
+            catch (const std::exception &)
+            {
+            }
+            if (digits.empty() || used != digits.size() || (myPos < myText.size() && isIdentifier(myText[myPos])))
+            {
+                throw std::runtime_error("invalid number: " + myText.substr(begin));
+            }
+            return value;
+        }
+
+        std::string identifier()
+        {
+            const size_t begin = myPos;
+            while (myPos < myText.size() && isIdentifier(myText[myPos]))
+            {
+                ++myPos;
+            }
+            return myText.substr(begin, myPos - begin);
+        }
+
+        int64_t primary()
+        {
+            skipSpaces();
+            if (myPos >= myText.size())
+            {
+                throw std::runtime_error("missing expression");
+            }
+
+            const char c = myText[myPos];
+            if (accept('('))
+            {
+                const int64_t value = parse();
+                expect(')');
+                return value;
+            }
+            if (accept('$'))
+            {
+                return number(16);
+            }
+            if (myText.compare(myPos, 2, "0x") == 0 || myText.compare(myPos, 2, "0X") == 0)
+            {
+                myPos += 2;
+                return number(16);
+            }
+            if (std::isdigit(static_cast<unsigned char>(c)))
+            {
+                return number(10);
+            }
+            if (!isIdentifier(c))
+            {
+                throw std::runtime_error("unexpected: " + myText.substr(myPos));
+            }
+
+            const std::string name = identifier();
+            if (accept('('))
+            {
+                return function(lower(name));
+            }
+            return variable(name);
+        }
+
+        int64_t function(const std::string &name)
+        {
+            int64_t value = 0;
+            if (name == "screen")
+            {
+                skipSpaces();
+                if (myPos >= myText.size() || myText[myPos] != '"')
+                {
+                    throw std::runtime_error("screen(\"text\")");
+                }
+                const std::string text = parseString(myText, myPos);
+                for (const std::string &line : decodeTextScreen())
+                {
+                    value = value || line.find(text) != std::string::npos;
+                }
+            }
+            else if (name == "peek" || name == "peekw")
+            {
+                const uint16_t address = static_cast<uint16_t>(parse());
+                value = name == "peek" ? ReadByteFromMemory(address) : ReadWordFromMemory(address);
+            }
+            else
+            {
+                throw std::runtime_error("unknown function: " + name);
+            }
+            expect(')');
+            return value;
+        }
+
+        int64_t variable(const std::string &name)
+        {
+            const auto it = myEngine.myVariables.find(name);
+            if (it != myEngine.myVariables.end())
+            {
+                return it->second;
+            }
+
+            const std::string reg = lower(name);
+            if (reg == "cycles")
+            {
+                return static_cast<int64_t>(g_nCumulativeCycles);
+            }
+
+            myEngine.myUsesRegisters = true;
+            if (reg == "pc")
+                return regs.pc;
+            if (reg == "a")
+                return regs.a;
+            if (reg == "x")
+                return regs.x;
+            if (reg == "y")
+                return regs.y;
+            if (reg == "sp")
+                return regs.sp;
+            if (reg == "p")
+                return regs.ps;
+
+            throw std::runtime_error("unknown variable: " + name);
+        }
+    };
+
+    ScriptEngine::ScriptEngine(std::ostream &out) : myOut(out)
+    {
+    }
+
+    ScriptEngine::~ScriptEngine()
+    {
+        if (theConsoleOutput == &myOut)
+        {
+            ConsoleDisplaySetHook(nullptr);
+            theConsoleOutput = nullptr;
+        }
+    }
+
+    bool ScriptEngine::load(const std::string &filename)
+    {
+        std::ifstream file(filename);
+        if (!file)
+        {
+            myOut << "script: cannot read " << filename << std::endl;
+            return false;
+        }
+        std::stringstream text;
+        text << file.rdbuf();
+        return parse(text.str());
+    }
+
+    bool ScriptEngine::parse(const std::string &text)
+    {
+        myLines.clear();
+
+        std::vector<size_t> blocks; // open if / while / repeat
+        std::istringstream input(text);
+        std::string raw;
+        size_t number = 0;
+        while (std::getline(input, raw))
+        {
+            ++number;
+            const std::string line = trim(raw);
+            if (line.empty() || line[0] == '#' || line.compare(0, 2, "//") == 0)
+            {
+                continue;
+            }
+
+            Line parsed;
+            parsed.number = number;
+            const size_t end = line.find_first_of(" \t");
+            parsed.keyword = lower(line.substr(0, end));
+            parsed.rest = end == std::string::npos ? std::string() : trim(line.substr(end));
+
+            const std::string &keyword = parsed.keyword;
+            if (keyword == "if" || keyword == "while" || keyword == "repeat")
+            {
+                blocks.push_back(myLines.size());
+            }
+            else if (keyword == "else" || keyword == "end")
+            {
+                if (blocks.empty() || (keyword == "else" && myLines[blocks.back()].keyword != "if"))
+                {
+                    myOut << "script: line " << number << ": " << keyword << " without if / while / repeat" << std::endl;
+                    return false;
+                }
+                myLines[blocks.back()].jump = myLines.size();
+                parsed.jump = blocks.back();
+                blocks.back() = myLines.size(); // an else is closed by the end
+                if (keyword == "end")
+                {
+                    blocks.pop_back();
+                }
+            }
+            myLines.push_back(parsed);
+        }
+
+        if (!blocks.empty())
+        {
+            myOut << "script: line " << myLines[blocks.back()].number << ": missing end" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int ScriptEngine::run()
+    {
+        theConsoleOutput = &myOut;
+        ConsoleDisplaySetHook(consoleToOutput);
+
+        myRepeats.clear();
+        myFailures = 0;
+
+        int status = PASSED;
+        size_t ip = 0;
+        while (ip < myLines.size())
+        {
+            const Line &line = myLines[ip];
+            try
+            {
+                if (!execute(line, ip, status))
+                {
+                    break;
+                }
+            }
+            catch (const std::exception &e)
+            {
+                myOut << "script: line " << line.number << ": " << e.what() << std::endl;
+                status = ERROR;
+                break;
+            }
+        }
+
+        ConsoleDisplaySetHook(nullptr);
+        theConsoleOutput = nullptr;
+
+        if (status == PASSED && myFailures)
+        {
+            status = FAILED;
+        }
+        myOut << "script: " << myFailures << " failure(s), exit status " << status << std::endl;
+        return status;
+    }
+
+    // false to stop
+    bool ScriptEngine::execute(const Line &line, size_t &ip, int &status)
+    {
+        const std::string &keyword = line.keyword;
+        const size_t next = ip + 1;
+        ip = next;
+
+        if (keyword == "set")
+        {
+            const size_t equal = line.rest.find('=');
+            const std::string name = trim(line.rest.substr(0, equal));
+            if (equal == std::string::npos || name.empty() || !std::all_of(name.begin(), name.end(), isIdentifier) ||
+                std::isdigit(static_cast<unsigned char>(name[0])) || isReserved(name))
+            {
+                throw std::runtime_error("set name = expr (not a register)");
+            }
+            myVariables[name] = evaluate(line.rest.substr(equal + 1));
+        }
+        else if (keyword == "if")
+        {
+            if (!evaluate(line.rest))
+            {
+                ip = line.jump + 1; // past the else or the end
+            }
+        }
+        else if (keyword == "else")
+        {
+            ip = line.jump + 1; // end of the if part
+        }
+        else if (keyword == "while")
+        {
+            if (!evaluate(line.rest))
+            {
+                ip = line.jump + 1;
+            }
+        }
+        else if (keyword == "repeat")
+        {
+            const int64_t count = evaluate(line.rest);
+            if (count > 0)
+            {
+                myRepeats.push_back({next - 1, count});
+            }
+            else
+            {
+                ip = line.jump + 1;
+            }
+        }
+        else if (keyword == "end")
+        {
+            const Line &opening = myLines[line.jump];
+            if (opening.keyword == "while")
+            {
+                ip = line.jump;
+            }
+            else if (opening.keyword == "repeat" && --myRepeats.back().remaining > 0)
+            {
+                ip = line.jump + 1;
+            }
+            else if (opening.keyword == "repeat")
+            {
+                myRepeats.pop_back();
+            }
+        }
+        else if (keyword == "run")
+        {
+            const int64_t cycles = evaluate(line.rest);
+            for (int64_t executed = 0; executed < cycles;)
+            {
+                executed += executeSlice(static_cast<uint32_t>(std::min<int64_t>(SLICE_CYCLES, cycles - executed)));
+            }
+        }
+        else if (keyword == "until")
+        {
+            if (!runUntil(line))
+            {
+                status = FAILED;
+                return false;
+            }
+        }
+        else if (keyword == "expect" || keyword == "assert")
+        {
+            check(line, keyword == "assert", status);
+            return status == PASSED;
+        }
+        else if (keyword == "print")
+        {
+            std::string text;
+            std::string rest = line.rest;
+            while (!(rest = trim(rest)).empty())
+            {
+                if (!text.empty())
+                {
+                    text += ' ';
+                }
+                if (rest[0] == '"')
+                {
+                    size_t pos = 0;
+                    text += parseString(rest, pos);
+                    rest.erase(0, pos);
+                }
+                else
+                {
+                    text += std::to_string(evaluate(rest, &rest));
+                }
+            }
+            myOut << text << std::endl;
+        }
+        else if (keyword == "screen")
+        {
+            for (const std::string &row : decodeTextScreen())
+            {
+                myOut << row << std::endl;
+            }
+        }
+        else if (keyword == "type")
+        {
+            size_t pos = 0;
+            if (line.rest.empty() || line.rest[0] != '"')
+            {
+                throw std::runtime_error("type \"text\"");
+            }
+            KeybPasteText(parseString(line.rest, pos));
+        }
+        else if (keyword == "key")
+        {
+            addKeyToBuffer(static_cast<BYTE>(evaluate(line.rest) & 0x7f));
+        }
+        else if (keyword == "exit")
+        {
+            status = line.rest.empty() ? (myFailures ? FAILED : PASSED) : static_cast<int>(evaluate(line.rest));
+            return false;
+        }
+        else
+        {
+            debuggerCommand(line.keyword + (line.rest.empty() ? "" : " " + line.rest));
+        }
+        return true;
+    }
+
+    uint32_t ScriptEngine::executeSlice(const uint32_t cycles)
+    {
+        const uint32_t executed = ExecuteSlice(cycles, true);
+        if (mySliceCallback)
+        {
+            mySliceCallback();
+        }
+        return executed;
+    }
+
+    // whatever is left after the expression goes to *rest (an error if rest is null)
+    int64_t ScriptEngine::evaluate(const std::string &text, std::string *rest)
+    {
+        myUsesRegisters = false;
+        ExpressionParser parser(*this, text);
+        const int64_t value = parser.parse();
+        const std::string remaining = trim(text.substr(parser.getPosition()));
+        if (rest)
+        {
+            *rest = remaining;
+        }
+        else if (!remaining.empty())
+        {
+            throw std::runtime_error("unexpected: " + remaining);
+        }
+        return value;
+    }
+
+    // false on a timeout
+    bool ScriptEngine::runUntil(const Line &line)
+    {
+        std::string rest;
+        bool done = evaluate(line.rest, &rest);
+        const bool step = myUsesRegisters;
+
+        int64_t timeout = -1;
+        if (!rest.empty())
+        {
+            const size_t end = rest.find_first_of(" \t");
+            if (lower(rest.substr(0, end)) != "within" || end == std::string::npos)
+            {
+                throw std::runtime_error("until expr [within cycles]");
+            }
+            timeout = evaluate(rest.substr(end));
+        }
+
+        int64_t executed = 0;
+        while (!done && (timeout < 0 || executed < timeout))
+        {
+            executed += executeSlice(step ? 0 : SLICE_CYCLES); // 0: 1 instruction
+            done = evaluate(line.rest, &rest);
+        }
+
+        if (!done)
+        {
+            ++myFailures;
+            myOut << "script: line " << line.number << ": until " << line.rest << ": timed out" << std::endl;
+        }
+        return done;
+    }
+
+    void ScriptEngine::check(const Line &line, const bool fatal, int &status)
+    {
+        std::string rest;
+        const int64_t value = evaluate(line.rest, &rest);
+
+        std::string message;
+        if (!rest.empty())
+        {
+            size_t pos = 0;
+            if (rest[0] == '"')
+            {
+                message = parseString(rest, pos);
+            }
+            if (!pos || pos < rest.size())
+            {
+                throw std::runtime_error(line.keyword + " expr [\"message\"]");
+            }
+        }
+
+        if (!value)
+        {
+            ++myFailures;
+            myOut << "script: line " << line.number << ": " << line.keyword << " failed: "
+                  << (message.empty() ? line.rest : message) << std::endl;
+            if (fatal)
+            {
+                status = FAILED;
+            }
+        }
+    }
+
+    void ScriptEngine::debuggerCommand(const std::string &command)
+    {
+        strncpy(g_pConsoleInput, command.c_str(), CONSOLE_WIDTH - 2);
+        g_pConsoleInput[CONSOLE_WIDTH - 2] = 0;
+        g_nConsoleInputChars = static_cast<int>(strlen(g_pConsoleInput));
+        DebuggerProcessCommand(false);
+        ConsoleFlush(); // no "press SPACE" when the output is long
+        ConsoleInputReset();
+    }
+
+    void ScriptEngine::setSliceCallback(const std::function<void()> &callback)
+    {
+        mySliceCallback = callback;
+    }
+
+    size_t ScriptEngine::getFailures() const
+    {
+        return myFailures;
+    }
+
+    bool ScriptEngine::getVariable(const std::string &name, int64_t &value) const
+    {
+        const auto it = myVariables.find(name);
+        if (it == myVariables.end())
+        {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+} // namespace common2
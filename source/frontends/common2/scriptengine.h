@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace common2
+{
+
+    // Debugger scripts for unattended runs (--script, usually with --headless)
+    // The CPU is driven directly by the script, so it runs unthrottled.
+    //
+    //   # comment (or //)
+    //   set n = 0                          variables are 64 bit integers
+    //   if expr / else / end
+    //   while expr / end
+    //   repeat expr / end
+    //   run cycles                         execute a number of cycles
+    //   until expr [within cycles]         execute until expr is true (a timeout is a failure)
+    //   expect expr ["message"]            a failure is counted, the script goes on
+    //   assert expr ["message"]            a failure stops the script
+    //   print "text" expr ...
+    //   screen                             print the text screen (UTF-8)
+    //   type "text"                        paste (\r, \n, \" and \\ escapes)
+    //   key expr                           one key
+    //   exit [expr]                        stop with this exit status
+    //   anything else                      a debugger command (e.g. "bpx 300", "bload file 2000")
+    //
+    // expressions: C operators, numbers ($hex, 0xhex, decimal), registers (pc a x y sp p),
+    // cycles, variables, peek(addr), peekw(addr) and screen("text") (1 if on the text screen, see decodeTextScreen())
+    //
+    // an "until" on a register is checked after every instruction, otherwise every SLICE_CYCLES
+    class ScriptEngine
+    {
+    public:
+        static constexpr int PASSED = 0;
+        static constexpr int FAILED = 1; // expect / assert / until timeout
+        static constexpr int ERROR = 2;  // cannot read or parse the script
+
+        static constexpr uint32_t SLICE_CYCLES = 1000;
+
+        explicit ScriptEngine(std::ostream &out);
+        ~ScriptEngine();
+
+        bool load(const std::string &filename);
+        bool parse(const std::string &text); // false on a syntax error (printed)
+
+        int run(); // exit status
+
+        // called after each slice of cycles (e.g. CommonFrame::UpdateFrameHashes())
+        void setSliceCallback(const std::function<void()> &callback);
+
+        size_t getFailures() const;
+        bool getVariable(const std::string &name, int64_t &value) const;
+
+    private:
+        struct Line
+        {
+            size_t number;       // in the file
+            std::string keyword; // lower case
+            std::string rest;
+            size_t jump = 0; // if -> else / end, else -> end, while / repeat -> end, end -> opening line
+        };
+
+        struct Repeat
+        {
+            size_t line;
+            int64_t remaining;
+        };
+
+        std::ostream &myOut;
+        std::function<void()> mySliceCallback;
+        std::vector<Line> myLines;
+        std::map<std::string, int64_t> myVariables;
+        std::vector<Repeat> myRepeats;
+        size_t myFailures = 0;
+        bool myUsesRegisters = false; // set by the last evaluate()
+
+        friend class ExpressionParser;
+
+        bool execute(const Line &line, size_t &ip, int &status);
+        int64_t evaluate(const std::string &text, std::string *rest = nullptr);
+        bool runUntil(const Line &line);
+        uint32_t executeSlice(const uint32_t cycles);
+        void check(const Line &line, const bool fatal, int &status);
+        void debuggerCommand(const std::string &command);
+    };
+
+} // namespace common2
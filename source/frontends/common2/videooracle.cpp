@@ -0,0 +1,368 @@
+#include "StdAfx.h"
+#include "frontends/common2/videooracle.h"
+
+#include "Core.h"
+#include "Interface.h"
+#include "Memory.h"
+#include "NTSC.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+
+    constexpr int TEXT_ROWS = 24;
+    constexpr int MIXED_TEXT_ROW = 20; // the 4 text rows at the bottom in mixed mode
+    constexpr int HIRES_LINES = 192;
+
+    // MouseText $40-$5F: the nearest Unicode symbol
+    const char32_t mouseText[32] = {
+        0xF8FF, 0x2318, 0x2196, 0x231B, 0x2713, 0x2714, 0x25D9, 0x25D8, // apples, pointer, hourglass, checks, running man
+        0x2190, 0x2026, 0x2193, 0x2191, 0x2594, 0x21B5, 0x2588, 0x21E4, // arrows, ellipsis, top bar, return, block, scroll
+        0x21E5, 0x2913, 0x2912, 0x2500, 0x2514, 0x2192, 0x2592, 0x2591, // scroll, line, corner, arrow, checkerboards
+        0x2590, 0x258C, 0x2595, 0x25C6, 0x2550, 0x253C, 0x258F, 0x2581, // folder, bars, diamond, double line, cross
+    };
+
+    // Pravets character ROMs: KOI-7 N2 Cyrillic instead of $60-$7F
+    const char32_t koi7[32] = {
+        0x042E, 0x0410, 0x0411, 0x0426, 0x0414, 0x0415, 0x0424, 0x0413, // Ю А Б Ц Д Е Ф Г
+        0x0425, 0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, // Х И Й К Л М Н О
+        0x041F, 0x042F, 0x0420, 0x0421, 0x0422, 0x0423, 0x0416, 0x0412, // П Я Р С Т У Ж В
+        0x042C, 0x042B, 0x0417, 0x0428, 0x042D, 0x0429, 0x0427, 0x042A, // Ь Ы З Ш Э Щ Ч Ъ
+    };
+
+    void appendUTF8(std::string &text, const char32_t c)
+    {
+        if (c < 0x80)
+        {
+            text += static_cast<char>(c);
+        }
+        else if (c < 0x800)
+        {
+            text += static_cast<char>(0xC0 | (c >> 6));
+            text += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else
+        {
+            text += static_cast<char>(0xE0 | (c >> 12));
+            text += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            text += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    // see the character ROM layouts (NTSC_CharSet.cpp)
+    char32_t decodeCharacter(const uint8_t ch, const eApple2Type type, const bool altCharSet)
+    {
+        const bool pravets = IsPravets(type);
+        const bool lowerCase = IsAppleIIeOrAbove(type) || pravets;
+
+        uint8_t c = ch & 0x7F;
+        if (ch < 0x40)
+        {
+            // inverse
+            c = ch < 0x20 ? ch + 0x40 : ch;
+        }
+        else if (ch < 0x80)
+        {
+            if (altCharSet && ch < 0x60 && IsEnhancedIIEorIIC())
+            {
+                return mouseText[ch - 0x40];
+            }
+            if (!altCharSet)
+            {
+                // flash: the same characters as inverse
+                c = ch < 0x60 ? ch : ch - 0x40;
+            }
+        }
+        else if (c < 0x20)
+        {
+            c += 0x40;
+        }
+
+        if (c >= 0x60)
+        {
+            if (pravets)
+            {
+                return koi7[c - 0x60];
+            }
+            if (!lowerCase)
+            {
+                c -= 0x40; // ][ and ][+: no lower case
+            }
+        }
+        return c == 0x7F ? 0x2592 : c; // $7F/$FF: a checkerboard on the //e
+    }
+
+    int textRowOffset(const int row)
+    {
+        return ((row & 7) << 7) + ((row >> 3) * 40);
+    }
+
+    int hiresLineOffset(const int line)
+    {
+        return ((line & 7) << 10) + (((line >> 3) & 7) << 7) + ((line >> 6) * 40);
+    }
+
+    // as NFrame::VideoPresentScreen()
+    int displayedPage(Video &video)
+    {
+        return (video.VideoGetSWPAGE2() && !video.VideoGetSW80STORE()) ? 1 : 0;
+    }
+
+    int firstTextRow(Video &video)
+    {
+        if (video.GetVideoMode() & VF_SHR)
+        {
+            return TEXT_ROWS;
+        }
+        return video.VideoGetSWTEXT() ? 0 : video.VideoGetSWMIXED() ? MIXED_TEXT_ROW : TEXT_ROWS;
+    }
+
+    void appendBytes(std::vector<uint8_t> &buffer, const uint8_t *data, const size_t size)
+    {
+        buffer.insert(buffer.end(), data, data + size);
+    }
+
+    // xxHash64
+    constexpr uint64_t PRIME1 = 11400714785074694791ULL;
+    constexpr uint64_t PRIME2 = 14029467366897019727ULL;
+    constexpr uint64_t PRIME3 = 1609587929392839161ULL;
+    constexpr uint64_t PRIME4 = 9650029242287828579ULL;
+    constexpr uint64_t PRIME5 = 2870177450012600261ULL;
+
+    inline uint64_t rotl(const uint64_t x, const int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64_t read64(const uint8_t *p)
+    {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value)); // little endian hosts only
+        return value;
+    }
+
+    inline uint32_t read32(const uint8_t *p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t xxhRound(uint64_t acc, const uint64_t input)
+    {
+        acc += input * PRIME2;
+        acc = rotl(acc, 31);
+        return acc * PRIME1;
+    }
+
+    inline uint64_t mergeRound(uint64_t acc, const uint64_t value)
+    {
+        acc ^= xxhRound(0, value);
+        return acc * PRIME1 + PRIME4;
+    }
+
+} // namespace
+
+namespace common2
+{
+
+    std::vector<std::string> decodeTextScreen()
+    {
+        Video &video = GetVideo();
+        const eApple2Type type = GetApple2Type();
+        const int page = displayedPage(video);
+        const uint8_t *main = MemGetMainPtr(0x400 << page);
+        const uint8_t *aux = MemGetAuxPtr(0x400 << page);
+        const bool col80 = video.VideoGetSW80COL() && IsAppleIIeOrAbove(type);
+        const bool altCharSet = video.VideoGetSWAltCharSet() && IsAppleIIeOrAbove(type);
+
+        std::vector<std::string> rows(TEXT_ROWS);
+        for (int row = firstTextRow(video); row < TEXT_ROWS; ++row)
+        {
+            const int offset = textRowOffset(row);
+            std::string &text = rows[row];
+            for (int column = 0; column < 40; ++column)
+            {
+                if (col80)
+                {
+                    appendUTF8(text, decodeCharacter(aux[offset + column], type, altCharSet));
+                }
+                appendUTF8(text, decodeCharacter(main[offset + column], type, altCharSet));
+            }
+        }
+        return rows;
+    }
+
+    uint64_t hashFrameBuffer(const bool redraw)
+    {
+        Video &video = GetVideo();
+        const uint8_t *frameBuffer = video.GetFrameBuffer();
+        if (!frameBuffer)
+        {
+            return 0;
+        }
+
+        if (redraw)
+        {
+            NTSC_VideoRedrawWholeScreen();
+        }
+        const size_t size = size_t(video.GetFrameBufferWidth()) * video.GetFrameBufferHeight() * sizeof(bgra_t);
+        return hash64(frameBuffer, size);
+    }
+
+    uint64_t hashVideoMemory()
+    {
+        Video &video = GetVideo();
+        const uint32_t mode = video.GetVideoMode();
+        const int page = displayedPage(video);
+        const bool text = video.VideoGetSWTEXT();
+        const bool col80 = video.VideoGetSW80COL();
+        const bool doubleRes = !text && video.VideoGetSWDHIRES() && col80;
+        const int textRow = firstTextRow(video);
+
+        static std::vector<uint8_t> buffer; // not to allocate every frame
+        buffer.clear();
+
+        // only what changes the picture, in the same order every time
+        const uint8_t normalisedMode[] = {
+            static_cast<uint8_t>(!!(mode & VF_SHR)),
+            static_cast<uint8_t>(text),
+            static_cast<uint8_t>(textRow),
+            static_cast<uint8_t>(!text && video.VideoGetSWHIRES()),
+            static_cast<uint8_t>(doubleRes),
+            static_cast<uint8_t>(col80 && textRow < TEXT_ROWS),
+            static_cast<uint8_t>(video.VideoGetSWAltCharSet() && textRow < TEXT_ROWS),
+        };
+        appendBytes(buffer, normalisedMode, sizeof(normalisedMode));
+
+        if (mode & VF_SHR)
+        {
+            appendBytes(buffer, MemGetAuxPtr(0x2000), 0x8000);
+            return hash64(buffer.data(), buffer.size());
+        }
+
+        if (!text && video.VideoGetSWHIRES())
+        {
+            const uint8_t *main = MemGetMainPtr(0x2000 << page);
+            const uint8_t *aux = MemGetAuxPtr(0x2000 << page);
+            const int lines = textRow * 8;
+            for (int line = 0; line < std::min(lines, HIRES_LINES); ++line)
+            {
+                if (doubleRes)
+                {
+                    appendBytes(buffer, aux + hiresLineOffset(line), 40);
+                }
+                appendBytes(buffer, main + hiresLineOffset(line), 40);
+            }
+        }
+
+        const uint8_t *main = MemGetMainPtr(0x400 << page);
+        const uint8_t *aux = MemGetAuxPtr(0x400 << page);
+        const int firstRow = (!text && !video.VideoGetSWHIRES()) ? 0 : textRow; // lores: the text page
+        for (int row = firstRow; row < TEXT_ROWS; ++row)
+        {
+            if (row < textRow ? doubleRes : col80)
+            {
+                appendBytes(buffer, aux + textRowOffset(row), 40);
+            }
+            appendBytes(buffer, main + textRowOffset(row), 40);
+        }
+
+        return hash64(buffer.data(), buffer.size());
+    }
+
+    uint64_t hash64(const void *data, const size_t size, const uint64_t seed)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        const uint8_t *const end = p + size;
+        uint64_t h;
+
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + PRIME1 + PRIME2;
+            uint64_t v2 = seed + PRIME2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME1;
+            const uint8_t *const limit = end - 32;
+            do
+            {
+                v1 = xxhRound(v1, read64(p));
+                v2 = xxhRound(v2, read64(p + 8));
+                v3 = xxhRound(v3, read64(p + 16));
+                v4 = xxhRound(v4, read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = mergeRound(h, v1);
+            h = mergeRound(h, v2);
+            h = mergeRound(h, v3);
+            h = mergeRound(h, v4);
+        }
+        else
+        {
+            h = seed + PRIME5;
+        }
+
+        h += size;
+
+        for (; p + 8 <= end; p += 8)
+        {
+            h ^= xxhRound(0, read64(p));
+            h = rotl(h, 27) * PRIME1 + PRIME4;
+        }
+        if (p + 4 <= end)
+        {
+            h ^= uint64_t(read32(p)) * PRIME1;
+            h = rotl(h, 23) * PRIME2 + PRIME3;
+            p += 4;
+        }
+        for (; p < end; ++p)
+        {
+            h ^= (*p) * PRIME5;
+            h = rotl(h, 11) * PRIME1;
+        }
+
+        h ^= h >> 33;
+        h *= PRIME2;
+        h ^= h >> 29;
+        h *= PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    FrameHashWriter::FrameHashWriter(const std::string &filename)
+        : myFile(filename)
+        , myLastCyclesThisFrame(g_dwCyclesThisFrame)
+    {
+        if (!myFile)
+        {
+            throw std::runtime_error("Cannot write frame hashes to: " + filename);
+        }
+        myFile << std::hex << std::setfill('0');
+    }
+
+    void FrameHashWriter::update(const bool redraw)
+    {
+        // g_dwCyclesThisFrame wraps at the start of a frame
+        if (g_dwCyclesThisFrame < myLastCyclesThisFrame)
+        {
+            const uint64_t videoMemory = hashVideoMemory();
+            const uint64_t frameBuffer = hashFrameBuffer(redraw);
+            myFile << std::setw(8) << myFrames << ' ' << std::setw(16) << frameBuffer << ' ' << std::setw(16)
+                   << videoMemory << '\n';
+            ++myFrames;
+        }
+        myLastCyclesThisFrame = g_dwCyclesThisFrame;
+    }
+
+    uint64_t FrameHashWriter::getFrames() const
+    {
+        return myFrames;
+    }
+
+} // namespace common2
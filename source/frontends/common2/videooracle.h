@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace common2
+{
+
+    // What the guest shows, for golden tests without screenshots
+    //
+    // - text: the displayed text page as 24 rows of UTF-8 (40 or 80 columns, the 4 text rows in mixed mode,
+    //   inverse & flash as normal characters, MouseText, the alternate character set, Pravets Cyrillic)
+    // - frame buffer hash: the last frame as drawn, so it depends on the video type (NTSC, RGB, monochrome...)
+    // - video memory hash: the video mode and the bytes it shows (no screen holes), independent of the video type
+    //   (a write after the beam has passed shows in the frame buffer hash of the next frame)
+    //
+    // Hashes are 64 bit xxHash.
+    std::vector<std::string> decodeTextScreen(); // rows not in text mode are empty
+    // redraw: the CPU has not drawn the frame (full speed, --no-video-update), draw it all first
+    // (like any whole screen redraw, this also moves the text flash on by a frame)
+    uint64_t hashFrameBuffer(const bool redraw = false);
+    uint64_t hashVideoMemory();
+    uint64_t hash64(const void *data, const size_t size, const uint64_t seed = 0);
+
+    // --frame-hashes: "frame framebuffer videomemory" (hex) for each emulated frame
+    class FrameHashWriter
+    {
+    public:
+        explicit FrameHashWriter(const std::string &filename);
+
+        // after executing some cycles, writes a line if a frame has completed since the last call
+        void update(const bool redraw);
+
+        uint64_t getFrames() const;
+
+    private:
+        std::ofstream myFile;
+        uint64_t myFrames = 0;
+        uint32_t myLastCyclesThisFrame = 0;
+    };
+
+} // namespace common2
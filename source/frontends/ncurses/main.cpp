@@ -13,6 +13,7 @@
 #include "frontends/common2/programoptions.h"
 #include "frontends/common2/argparser.h"
 #include "frontends/common2/commoncontext.h"
+#include "frontends/common2/scriptengine.h"
 #include "frontends/ncurses/world.h"
 #include "frontends/ncurses/nframe.h"
 #include "frontends/ncurses/evdevpaddle.h"
@@ -129,17 +130,24 @@ namespace
         g_bDisableDirectSoundMockingboard = true;
         na2::SetCtrlCHandler(options.headless);
 
+        int exitCode = 0;
         if (options.benchmark)
         {
             const auto redraw = [&frame]() { frame->VideoRedrawScreen(); };
             VideoBenchmark(redraw, redraw);
         }
+        else if (!options.script.empty())
+        {
+            common2::ScriptEngine script(std::cout);
+            script.setSliceCallback([&frame]() { frame->UpdateFrameHashes(); });
+            exitCode = script.load(options.script) ? script.run() : common2::ScriptEngine::ERROR;
+        }
         else
         {
             EnterMessageLoop(options, *frame);
         }
 
-        return 0;
+        return exitCode;
     }
 
 } // namespace
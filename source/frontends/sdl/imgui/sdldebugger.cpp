@@ -134,6 +134,24 @@ namespace
         debuggerTextColored(iColor, buffer.data());
     }
 
+    std::string expandTabs(const std::string &text)
+    {
+        const size_t tabSize = 8;
+        std::string result;
+        for (const char ch : text)
+        {
+            if (ch == '\t')
+            {
+                result.append(tabSize - result.size() % tabSize, ' ');
+            }
+            else
+            {
+                result += ch;
+            }
+        }
+        return result;
+    }
+
     void displayDisassemblyLine(const DisasmLine_t &line, const int bDisasmFormatFlags)
     {
         const char *pMnemonic = g_aOpcodes[line.iOpcode].sMnemonic;
@@ -359,6 +377,11 @@ namespace sa2
 
                     ImGui::EndTabItem();
                 }
+                if (myCycleTabItems.beginTabItem("Source"))
+                {
+                    drawSource(frame);
+                    ImGui::EndTabItem();
+                }
                 if (myCycleTabItems.beginTabItem("Console"))
                 {
                     drawConsole();
@@ -431,31 +454,26 @@ namespace sa2
             ImGui::TableSetupColumn("Cycles", 0, 6);
             ImGui::TableHeadersRow();
 
+            // formatted lines and row addresses are only recomputed when memory, symbols, etc. change
+            DisasmCacheUpdate();
+
             ImGuiListClipper clipper;
             clipper.Begin(1000);
-            int row = 0;
-            WORD nAddress = g_nDisasmTopAddress;
             while (clipper.Step())
             {
-                for (; row < clipper.DisplayStart; ++row)
-                {
-                    int iOpcode, iOpmode, nOpbyte;
-                    _6502_GetOpmodeOpbyte(nAddress, iOpmode, nOpbyte, nullptr);
-                    nAddress += nOpbyte;
-                }
-                IM_ASSERT(row == clipper.DisplayStart && "Clipper position mismatch");
-                for (; row < clipper.DisplayEnd; ++row)
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
                 {
+                    const WORD nAddress = DisasmCacheGetRowAddress(g_nDisasmTopAddress, row);
                     ImGui::PushID(nAddress);
-                    DisasmLine_t line;
-                    std::string const *pSymbol = FindSymbolFromAddress(nAddress);
-                    const int bDisasmFormatFlags = GetDisassemblyLine(nAddress, line);
+                    const DisasmCacheLine_t &cached = DisasmCacheGetLine(nAddress);
+                    const DisasmLine_t &line = cached.line;
+                    std::string const *pSymbol = cached.pSymbol;
+                    const int bDisasmFormatFlags = cached.bDisasmFormatFlags;
 
                     ImGui::TableNextRow();
 
-                    bool breakpointActive;
-                    bool breakpointEnabled;
-                    GetBreakpointInfo(nAddress, breakpointActive, breakpointEnabled);
+                    const bool breakpointActive = cached.bBreakpointActive;
+                    const bool breakpointEnabled = cached.bBreakpointEnable;
 
                     float red = 0.0;
                     int state = 0;
@@ -584,7 +602,6 @@ namespace sa2
                         }
                     }
 
-                    nAddress += line.nOpbyte;
                     ImGui::PopID();
                 }
             }
@@ -656,6 +673,85 @@ namespace sa2
         ImGui::EndDisabled();
     }
 
+    void ImGuiDebugger::drawSource(SDLFrame *frame)
+    {
+        ImGui::BeginDisabled(g_nAppMode != MODE_DEBUG || g_SourceInfo.IsEmpty());
+        if (ImGui::Button("Step into"))
+        {
+            debuggerCommand(frame, "TS");
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Step over"))
+        {
+            debuggerCommand(frame, "PS");
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+
+        const SourceInfoRange_t *pLine = g_SourceInfo.FindLine(regs.pc);
+        if (!pLine)
+        {
+            mySourceLine = -1;
+            if (g_SourceInfo.IsEmpty())
+            {
+                ImGui::TextUnformatted("No source: load one with SOURCE file.dbg, SOURCE listing or ASM file.s");
+            }
+            else
+            {
+                ImGui::Text("%04X: no source", regs.pc);
+            }
+            return;
+        }
+
+        const SourceInfoLine_t &line = g_SourceInfo.GetLine(pLine->iItem);
+        const SourceInfoFile_t &file = g_SourceInfo.GetFile(line.iFile);
+        const SourceInfoRange_t *pScope = g_SourceInfo.FindScope(regs.pc);
+        const char *scope = pScope ? g_SourceInfo.GetScope(pScope->iItem).sName.c_str() : "";
+        ImGui::Text("%s:%d  %s", file.sName.c_str(), line.nLine, scope);
+
+        const ImGuiTableFlags flags =
+            ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_ScrollY;
+        if (ImGui::BeginTable("Source", 2, flags))
+        {
+            ImGui::PushStyleCompact();
+            ImGui::TableSetupScrollFreeze(0, 1); // Make top row always visible
+            ImGui::TableSetupColumn("Line", 0, 1);
+            ImGui::TableSetupColumn("Source", 0, 20);
+            ImGui::TableHeadersRow();
+
+            const int current = line.nLine - 1;
+            if (pLine->iItem != mySourceLine)
+            {
+                // keep the PC line in view, a third of the way down
+                const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+                ImGui::SetScrollY(std::max(0.0f, rowHeight * current - ImGui::GetWindowHeight() / 3));
+                mySourceLine = pLine->iItem;
+            }
+
+            ImGuiListClipper clipper;
+            clipper.Begin(int(file.aText.size()));
+            while (clipper.Step())
+            {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+                {
+                    ImGui::TableNextRow();
+                    if (row == current)
+                    {
+                        const ImU32 currentBgColor = ImGui::GetColorU32(ImVec4(0, 0, 1, 1));
+                        ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, currentBgColor);
+                    }
+
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%d", row + 1);
+                    ImGui::TableNextColumn();
+                    debuggerTextColored(FG_SOURCE, expandTabs(file.aText[row]).c_str());
+                }
+            }
+            ImGui::PopStyleCompact();
+            ImGui::EndTable();
+        }
+    }
+
     void ImGuiDebugger::drawBreakpoints()
     {
         if (ImGui::BeginTable("Breakpoints", 10, ImGuiTableFlags_RowBg))
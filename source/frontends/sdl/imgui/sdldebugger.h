@@ -23,6 +23,7 @@ namespace sa2
     private:
         bool mySyncCursor = true;
         bool myScrollConsole = true;
+        int mySourceLine = -1; // of the PC, last shown
 
         int64_t myBaseDebuggerCycles;
         std::unordered_map<uint32_t, int64_t> myAddressCycles;
@@ -35,6 +36,7 @@ namespace sa2
         void debuggerCommand(SDLFrame *frame, const char *s);
 
         void drawDisassemblyTable(SDLFrame *frame);
+        void drawSource(SDLFrame *frame);
         void drawConsole();
         void drawBreakpoints();
         void drawRegisters();
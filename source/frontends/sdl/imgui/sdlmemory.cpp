@@ -6,14 +6,44 @@
 #include "Memory.h"
 #include "StrFormat.h"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
-#include <iomanip>
+
+namespace
+{
+
+    const size_t MAX_RESULTS = 256;
+    const uint64_t RECENT_FRAMES = 60; // highlight pages changed in the last second
+
+    const ImVec4 COLOR_RECENT(1.0f, 1.0f, 0.0f, 1.0f);
+    const ImVec4 COLOR_SNAPSHOT(1.0f, 0.3f, 0.3f, 1.0f);
+
+    std::string formatOffset(const size_t offset)
+    {
+        const size_t bankSize = common2::MemoryInspector::BANK_SIZE;
+        return StrFormat("%02X:%04X", (unsigned)(offset / bankSize), (unsigned)(offset % bankSize));
+    }
+
+} // namespace
 
 namespace sa2
 {
 
-    void ImGuiMemory::drawSingleView(const size_t address)
+    void ImGuiMemory::addView(const size_t offset)
+    {
+        const size_t bankSize = common2::MemoryInspector::BANK_SIZE;
+        myMemoryViews.push_back({int(offset / bankSize), offset % bankSize & ~size_t(0x0F)});
+    }
+
+    void ImGuiMemory::drawSingleView(const View &view)
     {
+        const bool physical = view.bank >= 0 && size_t(view.bank) < myInspector.getNumberOfBanks();
+        const size_t bankOffset = physical ? view.bank * common2::MemoryInspector::BANK_SIZE : 0;
+        const uint64_t generation = myInspector.getGeneration();
+        const bool snapshot = physical && myInspector.hasSnapshot();
+        const float spacing = ImGui::CalcTextSize(" ").x;
+
         const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp |
                                       ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY;
         if (ImGui::BeginTable("table1", 3, flags))
@@ -24,30 +54,54 @@ namespace sa2
             {
                 for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
                 {
-                    const size_t base = (address + row * myBytesPerRow) & _6502_MEM_END;
+                    const size_t base = (view.address + row * myBytesPerRow) & _6502_MEM_END;
                     const std::string addr = StrFormat("%04X", (unsigned)base);
 
-                    std::ostringstream hex;
-                    hex << std::setfill('0') << std::hex << std::uppercase;
+                    // page level: a row is highlighted if any of its pages changed recently
+                    bool recent = false;
+                    if (physical)
+                    {
+                        const uint64_t first = myInspector.getPageGeneration(bankOffset + base);
+                        const uint64_t last =
+                            myInspector.getPageGeneration(bankOffset + ((base + myBytesPerRow - 1) & _6502_MEM_END));
+                        recent = (first && generation - first < RECENT_FRAMES) ||
+                                 (last && generation - last < RECENT_FRAMES);
+                    }
+
+                    ImGui::TableNextColumn();
+                    if (recent)
+                    {
+                        ImGui::PushStyleColor(ImGuiCol_Text, COLOR_RECENT);
+                    }
+                    ImGui::Selectable(addr.c_str(), false, ImGuiSelectableFlags_SpanAllColumns);
+                    if (recent)
+                    {
+                        ImGui::PopStyleColor();
+                    }
 
+                    // byte level: different from the snapshot
+                    ImGui::TableNextColumn();
                     std::ostringstream text;
                     for (size_t k = 0; k < myBytesPerRow; ++k)
                     {
                         if (k)
                         {
-                            hex << ' ';
+                            ImGui::SameLine(0.0f, spacing);
+                        }
+                        const size_t address = (base + k) & _6502_MEM_END;
+                        const uint8_t value =
+                            physical ? myInspector.read(bankOffset + address) : ReadByteFromMemory(address);
+                        if (snapshot && myInspector.readSnapshot(bankOffset + address) != value)
+                        {
+                            ImGui::TextColored(COLOR_SNAPSHOT, "%02X", value);
+                        }
+                        else
+                        {
+                            ImGui::Text("%02X", value);
                         }
-                        const int value = static_cast<int>(mem[(base + k) & _6502_MEM_END]);
-                        hex << std::setw(2) << value;
                         text << getPrintableChar(value);
                     }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Selectable(addr.c_str(), false, ImGuiSelectableFlags_SpanAllColumns);
-
-                    ImGui::TableNextColumn();
-                    ImGui::TextUnformatted(hex.str().c_str());
-
                     ImGui::TableNextColumn();
                     ImGui::TextUnformatted(text.str().c_str());
                 }
@@ -56,36 +110,170 @@ namespace sa2
         }
     }
 
+    void ImGuiMemory::drawSearch()
+    {
+        if (ImGui::CollapsingHeader("Search"))
+        {
+            char buffer[256];
+            strncpy(buffer, mySearchPattern.c_str(), sizeof(buffer) - 1);
+            buffer[sizeof(buffer) - 1] = 0;
+            if (ImGui::InputText("pattern", buffer, sizeof(buffer)))
+            {
+                mySearchPattern = buffer;
+            }
+            ImGui::SameLine();
+            std::vector<uint8_t> pattern, mask;
+            const bool valid = common2::MemoryInspector::parsePattern(mySearchPattern, pattern, mask);
+            ImGui::BeginDisabled(!valid);
+            if (ImGui::Button("Find"))
+            {
+                mySearchResults = myInspector.search(pattern, mask, MAX_RESULTS);
+            }
+            ImGui::EndDisabled();
+            ImGui::TextDisabled("hex bytes, ? for any nibble (A9 ?? 8D), or \"text\"");
+
+            ImGui::Text("%d result(s)", int(mySearchResults.size()));
+            for (const size_t offset : mySearchResults)
+            {
+                if (ImGui::Selectable(formatOffset(offset).c_str()))
+                {
+                    addView(offset);
+                }
+            }
+        }
+    }
+
+    void ImGuiMemory::drawSnapshot()
+    {
+        if (ImGui::CollapsingHeader("Snapshot"))
+        {
+            if (ImGui::Button("Take snapshot"))
+            {
+                myInspector.takeSnapshot();
+                myDiffRanges.clear();
+            }
+            ImGui::SameLine();
+            ImGui::BeginDisabled(!myInspector.hasSnapshot());
+            if (ImGui::Button("Diff"))
+            {
+                myDiffRanges = myInspector.diffSnapshot(MAX_RESULTS);
+            }
+            ImGui::EndDisabled();
+
+            ImGui::Text("%d changed range(s)", int(myDiffRanges.size()));
+            for (const auto &range : myDiffRanges)
+            {
+                const std::string label =
+                    StrFormat("%s +%d", formatOffset(range.begin).c_str(), int(range.end - range.begin));
+                if (ImGui::Selectable(label.c_str()))
+                {
+                    addView(range.begin);
+                }
+            }
+        }
+    }
+
+    void ImGuiMemory::drawCheatFinder()
+    {
+        if (ImGui::CollapsingHeader("Cheat finder"))
+        {
+            if (ImGui::Button("New scan"))
+            {
+                myInspector.scanStart();
+                myScanStarted = true;
+            }
+
+            ImGui::BeginDisabled(!myScanStarted);
+            ImGui::SameLine();
+            ImGui::PushItemWidth(ImGui::GetFontSize() * 3);
+            ImGui::InputScalar(
+                "value", ImGuiDataType_U8, &myScanValue, nullptr, nullptr, "%02X", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::PopItemWidth();
+
+            using Scan = common2::MemoryInspector::Scan;
+            const std::pair<const char *, Scan> buttons[] = {
+                {"Equal", Scan::Equal},         {"Not equal", Scan::NotEqual},   {"Changed", Scan::Changed},
+                {"Unchanged", Scan::Unchanged}, {"Increased", Scan::Increased}, {"Decreased", Scan::Decreased},
+            };
+            for (size_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); ++i)
+            {
+                if (i)
+                {
+                    ImGui::SameLine();
+                }
+                if (ImGui::Button(buttons[i].first))
+                {
+                    myInspector.scan(buttons[i].second, myScanValue);
+                }
+            }
+            ImGui::EndDisabled();
+
+            if (myScanStarted)
+            {
+                ImGui::Text("%d candidate(s)", int(myInspector.getNumberOfCandidates()));
+                for (const size_t offset : myInspector.getCandidates(MAX_RESULTS))
+                {
+                    const std::string label = StrFormat(
+                        "%s %02X -> %02X", formatOffset(offset).c_str(), myInspector.readScanValue(offset),
+                        myInspector.read(offset));
+                    if (ImGui::Selectable(label.c_str()))
+                    {
+                        addView(offset);
+                    }
+                }
+            }
+        }
+    }
+
     void ImGuiMemory::draw()
     {
         if (ImGui::Begin("Memory viewer", &show))
         {
+            myInspector.update();
+
             ImGui::PushItemWidth(ImGui::GetFontSize() * 5);
             ImGui::InputScalar(
                 "address", ImGuiDataType_U16, &myNewAddress, nullptr, nullptr, "%04X",
                 ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::SameLine();
+            ImGui::InputInt("bank", &myNewBank);
             ImGui::PopItemWidth();
+            myNewBank = std::max(-1, std::min(myNewBank, int(myInspector.getNumberOfBanks()) - 1));
             ImGui::SameLine();
             if (ImGui::Button("Add"))
             {
-                myMemoryAddresses.push_back(myNewAddress);
+                myMemoryViews.push_back({myNewBank, myNewAddress});
                 myNewAddress = (myNewAddress + 0x0100) & _6502_MEM_END;
             }
+            ImGui::TextDisabled("bank -1 = as seen by the CPU, 0 = main, 1 = aux, 2+ = RamWorks");
 
             ImGui::SliderInt("Width", &myBytesPerRow, 8, 32);
 
-            auto it = myMemoryAddresses.begin();
+            drawSearch();
+            drawSnapshot();
+            drawCheatFinder();
+
+            auto it = myMemoryViews.begin();
             int id = 0;
-            while (it != myMemoryAddresses.end())
+            while (it != myMemoryViews.end())
             {
                 ImGui::PushID(++id);
                 ImGui::BeginChild("pippo", ImVec2(0, 200), ImGuiChildFlags_Borders | ImGuiChildFlags_ResizeY);
                 if (ImGui::Button("Remove"))
                 {
-                    it = myMemoryAddresses.erase(it);
+                    it = myMemoryViews.erase(it);
                 }
                 else
                 {
+                    ImGui::SameLine();
+                    if (it->bank < 0)
+                    {
+                        ImGui::TextUnformatted("CPU");
+                    }
+                    else
+                    {
+                        ImGui::Text("Bank %02X", it->bank);
+                    }
                     drawSingleView(*it);
                     ++it;
                 }
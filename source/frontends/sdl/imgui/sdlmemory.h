@@ -1,5 +1,9 @@
+#include "frontends/common2/memoryinspector.h"
+
 #include <cstdint>
 #include <list>
+#include <string>
+#include <vector>
 
 namespace sa2
 {
@@ -12,12 +16,32 @@ namespace sa2
         void draw();
 
     private:
+        struct View
+        {
+            int bank;       // -1 = as seen by the CPU, else physical (0 = main, 1 = aux, 2+ = RamWorks)
+            size_t address; // in the bank
+        };
+
         uint16_t myNewAddress = 0;
+        int myNewBank = -1;
         int myBytesPerRow = 16;
         int myNumberOfRows = 32;
-        std::list<size_t> myMemoryAddresses;
+        std::list<View> myMemoryViews;
+
+        common2::MemoryInspector myInspector;
+
+        std::string mySearchPattern;
+        std::vector<size_t> mySearchResults;
+        std::vector<common2::MemoryInspector::Range> myDiffRanges;
+
+        bool myScanStarted = false;
+        uint8_t myScanValue = 0;
 
-        void drawSingleView(const size_t address);
+        void addView(const size_t offset);
+        void drawSingleView(const View &view);
+        void drawSearch();
+        void drawSnapshot();
+        void drawCheatFinder();
     };
 
 } // namespace sa2
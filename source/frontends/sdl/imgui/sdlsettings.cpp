@@ -568,6 +568,32 @@ namespace sa2
                         {
                             card->SetConvertEncoding(convertEncoding);
                         }
+
+                        ImGui::Separator();
+                        const char *emulations[] = {"Text", "Epson FX", "ImageWriter II"};
+                        const ParallelPrinterCard::PrinterEmulation_e emulation = card->GetEmulation();
+                        for (int i = 0; i < ParallelPrinterCard::NUM_PRINTER_EMULATIONS; ++i)
+                        {
+                            if (ImGui::RadioButton(emulations[i], emulation == i))
+                            {
+                                card->SetEmulation(ParallelPrinterCard::PrinterEmulation_e(i));
+                            }
+                            ImGui::SameLine();
+                        }
+                        ImGui::NewLine();
+
+                        const char *formats[] = {"PNG", "PBM"};
+                        const ParallelPrinterCard::PrinterPageFormat_e format = card->GetPageFormat();
+                        for (int i = 0; i < ParallelPrinterCard::NUM_PRINTER_PAGE_FORMATS; ++i)
+                        {
+                            if (ImGui::RadioButton(formats[i], format == i))
+                            {
+                                card->SetPageFormat(ParallelPrinterCard::PrinterPageFormat_e(i));
+                            }
+                            ImGui::SameLine();
+                        }
+                        ImGui::NewLine();
+                        ImGui::LabelText("Pages saved", "%u", card->GetPagesSaved());
                     }
 
                     ImGui::EndTabItem();
@@ -727,6 +753,12 @@ namespace sa2
                         ImGui::TextUnformatted("Drop a .wav file.");
                     }
 
+                    if (tape.isRecording())
+                    {
+                        ImGui::Separator();
+                        ImGui::LabelText("Recording", "%" SIZE_T_FMT " edges", tape.getRecordedEdges());
+                    }
+
                     ImGui::EndTabItem();
                 }
 
@@ -12,6 +12,7 @@
 #include "frontends/common2/commoncontext.h"
 #include "frontends/common2/argparser.h"
 #include "frontends/common2/programoptions.h"
+#include "frontends/common2/scriptengine.h"
 #include "frontends/common2/timer.h"
 #include "frontends/sdl/gamepad.h"
 #include "frontends/sdl/sdirectsound.h"
@@ -53,14 +54,14 @@ namespace
 
 } // namespace
 
-void run_sdl(int argc, char *const argv[])
+int run_sdl(int argc, char *const argv[])
 {
     common2::EmulatorOptions options;
 
     const bool run = getEmulatorOptions(argc, argv, common2::OptionsType::sa2, "SDL2", options);
 
     if (!run)
-        return;
+        return 0;
 
     std::cerr << std::fixed << std::setprecision(2);
 
@@ -91,6 +92,8 @@ void run_sdl(int argc, char *const argv[])
     const int fps = getRefreshRate();
     std::cerr << "Video refresh rate: " << fps << " Hz, " << 1000.0 / fps << " ms" << std::endl;
 
+    int exitCode = 0;
+
 #ifdef EMULATOR_RUN
     if (options.benchmark)
     {
@@ -110,6 +113,13 @@ void run_sdl(int argc, char *const argv[])
 
         VideoBenchmark(redraw, refresh);
     }
+    else if (!options.script.empty())
+    {
+        // as applen: the script drives the CPU, no event loop
+        common2::ScriptEngine script(std::cout);
+        script.setSliceCallback([&frame]() { frame->UpdateFrameHashes(); });
+        exitCode = script.load(options.script) ? script.run() : common2::ScriptEngine::ERROR;
+    }
     else
     {
         common2::Timer global;
@@ -164,6 +174,8 @@ void run_sdl(int argc, char *const argv[])
         std::cerr << "CPU:     " << cpuTimer << std::endl;
     }
 #endif
+
+    return exitCode;
 }
 
 int main(int argc, char *argv[])
@@ -180,7 +192,7 @@ int main(int argc, char *argv[])
 
     try
     {
-        run_sdl(argc, argv);
+        exit = run_sdl(argc, argv);
     }
     catch (const std::exception &e)
     {
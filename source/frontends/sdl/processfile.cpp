@@ -9,6 +9,7 @@
 #include "Disk.h"
 #include "Core.h"
 #include "Harddisk.h"
+#include "ProgramLoader.h"
 
 #include <algorithm>
 #include <cstring>
@@ -139,6 +140,14 @@ namespace sa2
         {
             insertTape(frame, filename);
         }
+        else if (ProgramLoader_IsProgramFile(filename))
+        {
+            std::string error;
+            if (!ProgramLoader_LoadFile(filename, -1, true, error))
+            {
+                frame->FrameMessageBox(error.c_str(), "ERROR", MB_OK);
+            }
+        }
         else
         {
             insertDisk(frame, filename, dragAndDropSlot, dragAndDropDrive);
@@ -165,6 +165,8 @@ namespace sa2
         , myDragAndDropSlot(SLOT6)
         , myDragAndDropDrive(DRIVE_1)
         , myScrollLockFullSpeed(false)
+        , myMouseTargetX(0)
+        , myMouseTargetY(0)
         , myPortFwds(getPortFwds(options.natPortFwds))
     {
     }
@@ -330,7 +332,8 @@ namespace sa2
             {
                 const eBUTTONSTATE state = (event.state == SDL_PRESSED) ? BUTTON_DOWN : BUTTON_UP;
                 const eBUTTON button = (event.button == SDL_BUTTON_LEFT) ? BUTTON0 : BUTTON1;
-                cardManager.GetMouseCard()->SetButton(button, state);
+                // SDL timestamps are in ms
+                cardManager.GetMouseCard()->QueueButton(button, state, event.timestamp / 1000.0);
                 break;
             }
             }
@@ -350,9 +353,11 @@ namespace sa2
 
         if (cardManager.IsMouseCardInstalled() && cardManager.GetMouseCard()->IsActiveAndEnabled())
         {
+            CMouseInterface *mouseCard = cardManager.GetMouseCard();
+
             int iX, iMinX, iMaxX;
             int iY, iMinY, iMaxY;
-            cardManager.GetMouseCard()->GetXY(iX, iMinX, iMaxX, iY, iMinY, iMaxY);
+            mouseCard->GetXY(iX, iMinX, iMaxX, iY, iMinY, iMaxY);
 
             int width, height;
             SDL_GetWindowSize(myWindow.get(), &width, &height);
@@ -396,13 +401,16 @@ namespace sa2
                 const int newX = lround(x * sizeX) + iMinX;
                 const int newY = lround(y * sizeY) + iMinY;
 
-                dx = newX - iX;
-                dy = newY - iY;
+                const bool pending = mouseCard->GetQueuedInputSize() > 0;
+                dx = newX - (pending ? myMouseTargetX : iX);
+                dy = newY - (pending ? myMouseTargetY : iY);
+
+                myMouseTargetX = newX;
+                myMouseTargetY = newY;
             }
 
-            int outOfBoundsX;
-            int outOfBoundsY;
-            cardManager.GetMouseCard()->SetPositionRel(dx, dy, &outOfBoundsX, &outOfBoundsY);
+            // delivered to the guest at the VBL matching the event's time
+            mouseCard->QueuePositionRel(dx, dy, motion.timestamp / 1000.0);
         }
     }
 
@@ -78,6 +78,10 @@ namespace sa2
 
         bool myScrollLockFullSpeed;
 
+        // absolute mouse: the last position queued, as the card's position lags behind while there is queued input
+        int myMouseTargetX;
+        int myMouseTargetY;
+
         std::vector<PortFwd> myPortFwds;
 
         std::shared_ptr<SDL_Window> myWindow;
@@ -7,9 +7,66 @@
 #include "Memory.h"
 #include "Pravets.h"
 #include "CPU.h"
+#include "Log.h"
 
+#include <algorithm>
+#include <fstream>
 #include <limits>
 
+namespace
+{
+
+    // The monitor's READ routine, up to JSR RDBYTE : CMP CHKSUM (the checksum byte)
+    struct MonitorRead
+    {
+        WORD read;         // READ: JSR RD2BIT
+        WORD tapeIn;       // RDBIT: PC after LDA TAPEIN
+        WORD rd2bitReturn; // pushed by RD2BIT's JSR RDBIT
+        WORD checksum;     // JSR RDBYTE : CMP CHKSUM
+        BYTE code[46];
+    };
+
+    const MonitorRead ourMonitorReads[] = {
+        // Apple ][, ][+ and //e
+        {0xFEFD, 0xFD01, 0xFCFC, 0xFF26,
+         {0x20, 0xFA, 0xFC, 0xA9, 0x16, 0x20, 0xC9, 0xFC, 0x85, 0x2E, 0x20, 0xFA, 0xFC, 0xA0, 0x24, 0x20,
+          0xFD, 0xFC, 0xB0, 0xF9, 0x20, 0xFD, 0xFC, 0xA0, 0x3B, 0x20, 0xEC, 0xFC, 0x81, 0x3C, 0x45, 0x2E,
+          0x85, 0x2E, 0x20, 0xBA, 0xFC, 0xA0, 0x35, 0x90, 0xF0, 0x20, 0xEC, 0xFC, 0xC5, 0x2E}},
+        // Enhanced //e: moved to the internal $C5 ROM
+        {0xC5D1, 0xC59F, 0xC59A, 0xC5FA,
+         {0x20, 0x98, 0xC5, 0xA9, 0x16, 0x20, 0x67, 0xC5, 0x85, 0x2E, 0x20, 0x98, 0xC5, 0xA0, 0x24, 0x20,
+          0x9B, 0xC5, 0xB0, 0xF9, 0x20, 0x9B, 0xC5, 0xA0, 0x3B, 0x20, 0x8A, 0xC5, 0x81, 0x3C, 0x45, 0x2E,
+          0x85, 0x2E, 0x20, 0xBA, 0xFC, 0xA0, 0x35, 0x90, 0xF0, 0x20, 0x8A, 0xC5, 0xC5, 0x2E}},
+    };
+
+    // zero page
+    constexpr WORD A1L = 0x3C;
+    constexpr WORD A2L = 0x3E;
+    constexpr WORD CHKSUM = 0x2E;
+    constexpr WORD LASTIN = 0x2F;
+
+    // Monitor tape format: header 770Hz, sync 2500Hz + 2000Hz half cycles, '0' 2000Hz, '1' 1000Hz
+    constexpr double ourSyncHalfCycle = 400.0; // us: shorter than a header half cycle (650us)
+    constexpr double ourOneFullCycle = 750.0;  // us: between a '0' (500us) and a '1' (1000us)
+    constexpr size_t ourMinHeader = 64;        // half cycles of header before the sync
+
+    WORD getStackWord(const BYTE sp)
+    {
+        const BYTE lo = ReadByteFromMemory(_6502_STACK_BEGIN + BYTE(sp + 1));
+        const BYTE hi = ReadByteFromMemory(_6502_STACK_BEGIN + BYTE(sp + 2));
+        return lo | (hi << 8);
+    }
+
+    void writeLE(std::ofstream &file, const uint32_t value, const size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            file.put(char((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+} // namespace
+
 CassetteTape &CassetteTape::instance()
 {
     static CassetteTape tape;
@@ -27,6 +84,7 @@ void CassetteTape::setData(const std::string &filename, const std::vector<tape_d
 void CassetteTape::eject()
 {
     myData.clear();
+    myIsPlaying = false;
 }
 
 void CassetteTape::rewind()
@@ -93,6 +151,7 @@ BYTE CassetteTape::getValue(const ULONG nExecutedCycles)
         myIsPlaying = true;
         myBaseCycles = g_nCumulativeCycles;
     }
+    myLastReadCycle = g_nCumulativeCycles;
 
     size_t pos;
     const tape_data_t val = getCurrentWave(pos);
@@ -110,17 +169,294 @@ void CassetteTape::getTapeInfo(TapeInfo &info) const
     info.frequency = myFrequency;
 }
 
+void CassetteTape::toggleOutput(const ULONG nExecutedCycles)
+{
+    if (myIsRecording)
+    {
+        CpuCalcCycles(nExecutedCycles);
+        myEdges.push_back(g_nCumulativeCycles);
+    }
+}
+
+void CassetteTape::startRecording(const std::string &filename)
+{
+    myRecordingFilename = filename;
+    myEdges.clear();
+    myIsRecording = true;
+}
+
+bool CassetteTape::stopRecording()
+{
+    if (!myIsRecording)
+    {
+        return true;
+    }
+    myIsRecording = false;
+
+    if (myRecordingFilename.empty())
+    {
+        return true;
+    }
+
+    // 8 bit mono PCM
+    constexpr int frequency = 44100;
+    const std::vector<tape_data_t> samples = renderRecording(frequency);
+
+    std::ofstream file(myRecordingFilename, std::ios::binary);
+    file.write("RIFF", 4);
+    writeLE(file, 36 + samples.size(), 4);
+    file.write("WAVEfmt ", 8);
+    writeLE(file, 16, 4);        // fmt chunk size
+    writeLE(file, 1, 2);         // PCM
+    writeLE(file, 1, 2);         // channels
+    writeLE(file, frequency, 4); // sample rate
+    writeLE(file, frequency, 4); // byte rate
+    writeLE(file, 1, 2);         // block align
+    writeLE(file, 8, 2);         // bits per sample
+    file.write("data", 4);
+    writeLE(file, samples.size(), 4);
+    for (const tape_data_t sample : samples)
+    {
+        file.put(char(sample + 128)); // 8 bit wav is unsigned
+    }
+
+    if (!file)
+    {
+        LogFileOutput("Tape: failed to write %s\n", myRecordingFilename.c_str());
+        return false;
+    }
+
+    LogFileOutput("Tape: %" SIZE_T_FMT " edges written to %s\n", myEdges.size(), myRecordingFilename.c_str());
+    return true;
+}
+
+bool CassetteTape::isRecording() const
+{
+    return myIsRecording;
+}
+
+size_t CassetteTape::getRecordedEdges() const
+{
+    return myEdges.size();
+}
+
+std::vector<CassetteTape::tape_data_t> CassetteTape::renderRecording(const int frequency) const
+{
+    std::vector<tape_data_t> samples;
+
+    tape_data_t level = myAmplitude;
+    double seconds = 0.0;
+    for (size_t i = 0; i < myEdges.size(); ++i)
+    {
+        // the last level is held for the longest gap
+        const double gap = i + 1 < myEdges.size() ? (myEdges[i + 1] - myEdges[i]) / g_fCurrentCLK6502 : myMaxGap;
+        seconds += std::min(gap, myMaxGap);
+        samples.resize(size_t(seconds * frequency), level);
+        level = -level;
+    }
+
+    return samples;
+}
+
+void CassetteTape::setFastLoad(const bool enabled)
+{
+    myFastLoad = enabled;
+}
+
+void CassetteTape::setTurbo(const bool enabled)
+{
+    myTurbo = enabled;
+}
+
+bool CassetteTape::isActive() const
+{
+    if (!myTurbo)
+    {
+        return false;
+    }
+
+    if (myIsPlaying && g_nCumulativeCycles - myLastReadCycle < myIdleCycles)
+    {
+        const double position = (g_nCumulativeCycles - myBaseCycles) / g_fCurrentCLK6502 * myFrequency;
+        if (position < myData.size())
+        {
+            return true;
+        }
+    }
+
+    return myIsRecording && !myEdges.empty() && g_nCumulativeCycles - myEdges.back() < myIdleCycles;
+}
+
+// Sample positions (from pos) where the level flips: the level after edges[i] is bit ^ ((i + 1) & 1)
+void CassetteTape::getEdges(size_t pos, BYTE bit, std::vector<size_t> &edges) const
+{
+    for (; pos < myData.size(); ++pos)
+    {
+        const tape_data_t val = myData[pos];
+        // same hysteresis as getBitValue()
+        const BYTE newBit = val > myThreshold ? 0 : val < -myThreshold ? 1 : bit;
+        if (newBit != bit)
+        {
+            edges.push_back(pos);
+            bit = newBit;
+        }
+    }
+}
+
+// Decode [start, end] from the current position, and leave the tape at the checksum byte
+bool CassetteTape::decodeBlock(const uint16_t start, const uint16_t end, const ULONG nExecutedCycles)
+{
+    if (myData.empty())
+    {
+        return false;
+    }
+
+    CpuCalcCycles(nExecutedCycles);
+    if (!myIsPlaying)
+    {
+        myIsPlaying = true;
+        myBaseCycles = g_nCumulativeCycles;
+    }
+
+    size_t pos;
+    getCurrentWave(pos);
+
+    std::vector<size_t> edges;
+    getEdges(pos, myLastBit, edges);
+
+    const double microsPerSample = 1000000.0 / myFrequency;
+    const auto halfCycle = [&edges, microsPerSample](const size_t i)
+    { return (edges[i + 1] - edges[i]) * microsPerSample; };
+
+    // header, then the 1st (short) half cycle of the sync bit
+    size_t i = 0;
+    size_t header = 0;
+    for (; i + 1 < edges.size(); ++i)
+    {
+        if (halfCycle(i) >= ourSyncHalfCycle)
+        {
+            ++header;
+        }
+        else if (header >= ourMinHeader)
+        {
+            break;
+        }
+        else
+        {
+            header = 0;
+        }
+    }
+    i += 2; // sync bit
+
+    // NXTA1 stops after A1 == A2: at least 1 byte
+    const size_t count = start <= end ? end - start + 1 : 1;
+    std::vector<BYTE> data(count);
+    for (BYTE &byte : data)
+    {
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            if (i + 2 >= edges.size())
+            {
+                return false;
+            }
+            const double fullCycle = halfCycle(i) + halfCycle(i + 1);
+            byte = (byte << 1) | (fullCycle > ourOneFullCycle ? 1 : 0);
+            i += 2;
+        }
+    }
+
+    BYTE checksum = 0xFF;
+    for (size_t j = 0; j < count; ++j)
+    {
+        WriteByteToMemory(start + j, data[j]);
+        checksum ^= data[j];
+    }
+
+    // as if READ had just stored the last byte
+    const WORD next = start + count;
+    WriteByteToMemory(A1L, next & 0xFF);
+    WriteByteToMemory(A1L + 1, next >> 8);
+    WriteByteToMemory(CHKSUM, checksum);
+
+    // wind the tape forward to the edge starting the checksum byte
+    myLastBit = myLastBit ^ ((i + 1) & 1);
+    WriteByteToMemory(LASTIN, myLastBit ? 0x80 : 0x00);
+    myBaseCycles = g_nCumulativeCycles - int64_t((edges[i] + 1) * g_fCurrentCLK6502 / myFrequency);
+
+    LogFileOutput("Tape: fast load $%04X-$%04X\n", start, WORD(next - 1));
+    return true;
+}
+
+bool CassetteTape::fastLoad(const WORD pc, const ULONG nExecutedCycles)
+{
+    if (!myFastLoad)
+    {
+        return false;
+    }
+
+    // only the first RD2BIT, called straight from READ: JSR RD2BIT (READ) -> JSR RDBIT (RD2BIT) -> LDA TAPEIN
+    const MonitorRead *monitor = nullptr;
+    for (const MonitorRead &candidate : ourMonitorReads)
+    {
+        if (pc == candidate.tapeIn && getStackWord(regs.sp) == candidate.rd2bitReturn &&
+            getStackWord(regs.sp + 2) == candidate.read + 2)
+        {
+            monitor = &candidate;
+            break;
+        }
+    }
+
+    if (!monitor)
+    {
+        myFastLoadFailed = false;
+        return false;
+    }
+
+    if (myFastLoadFailed)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(monitor->code); ++i)
+    {
+        if (ReadByteFromMemory(monitor->read + i) != monitor->code[i])
+        {
+            myFastLoadFailed = true;
+            return false;
+        }
+    }
+
+    const uint16_t start = ReadWordFromMemory(A1L);
+    const uint16_t end = ReadWordFromMemory(A2L);
+    if (!decodeBlock(start, end, nExecutedCycles))
+    {
+        myFastLoadFailed = true; // play it in real time
+        return false;
+    }
+
+    // drop both return addresses and carry on with the checksum
+    regs.sp = _6502_STACK_BEGIN | BYTE(regs.sp + 4);
+    regs.pc = monitor->checksum;
+    regs.x = 0;
+    regs.y = 0x35; // LDY #$35 : BCC RD3
+    return true;
+}
+
 BYTE __stdcall TapeRead(WORD pc, WORD address, BYTE, BYTE, ULONG nExecutedCycles) // $C060 TAPEIN
 {
     if (g_Apple2Type == A2TYPE_PRAVETS8A)
         return GetPravets().GetKeycode(MemReadFloatingBus(nExecutedCycles));
 
-    const BYTE highBit = CassetteTape::instance().getValue(nExecutedCycles);
+    CassetteTape &tape = CassetteTape::instance();
+    tape.fastLoad(pc, nExecutedCycles);
+
+    const BYTE highBit = tape.getValue(nExecutedCycles);
 
     return MemReadFloatingBus(highBit, nExecutedCycles);
 }
 
 BYTE __stdcall TapeWrite(WORD, WORD address, BYTE, BYTE, ULONG nExecutedCycles) // $C020 TAPEOUT
 {
+    CassetteTape::instance().toggleOutput(nExecutedCycles);
     return 0;
 }
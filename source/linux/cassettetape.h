@@ -24,11 +24,31 @@ public:
     void eject();
     void rewind();
 
+    // TAPEOUT: every access toggles the output, the edges are timestamped with g_nCumulativeCycles
+    void toggleOutput(const ULONG nExecutedCycles);
+    void startRecording(const std::string &filename); // empty filename: only keep the recording in memory
+    bool stopRecording();                             // writes the .wav (if any): false on error
+    bool isRecording() const;
+    size_t getRecordedEdges() const;
+    std::vector<tape_data_t> renderRecording(const int frequency) const;
+
+    // Monitor READ ($FEFD, or $C5D1 in the enhanced //e): decode the whole block straight from the samples,
+    // instead of playing them in real time
+    // . called on every TAPEIN read, true if the CPU has been redirected to read the checksum byte
+    bool fastLoad(const WORD pc, const ULONG nExecutedCycles);
+    void setFastLoad(const bool enabled);
+
+    // TAPEIN is being polled while a tape is playing (or TAPEOUT is being recorded): safe to run at full speed
+    bool isActive() const;
+    void setTurbo(const bool enabled);
+
     static CassetteTape &instance();
 
 private:
     BYTE getBitValue(const tape_data_t val);
     tape_data_t getCurrentWave(size_t &pos) const;
+    void getEdges(size_t pos, BYTE bit, std::vector<size_t> &edges) const;
+    bool decodeBlock(const uint16_t start, const uint16_t end, const ULONG nExecutedCycles);
 
     std::vector<tape_data_t> myData;
 
@@ -38,5 +58,17 @@ private:
     BYTE myLastBit = 1;     // negative wave
     std::string myFilename; // just for info
 
+    bool myFastLoad = true;
+    bool myTurbo = true;
+    bool myFastLoadFailed = false; // don't decode again on every TAPEIN read of the same READ
+    uint64_t myLastReadCycle = 0;  // last TAPEIN access
+
+    std::vector<uint64_t> myEdges; // TAPEOUT toggles (cycles)
+    std::string myRecordingFilename;
+    bool myIsRecording = false;
+
     static constexpr tape_data_t myThreshold = 5;
+    static constexpr tape_data_t myAmplitude = 96;         // recording
+    static constexpr double myMaxGap = 1.0;                // seconds: longer silences are shortened in recordings
+    static constexpr uint64_t myIdleCycles = 1000000;      // no TAPEIN/TAPEOUT access for this long: tape idle
 };
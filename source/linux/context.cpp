@@ -4,6 +4,7 @@
 #include "linux/linuxframe.h"
 #include "linux/registryclass.h"
 #include "linux/paddle.h"
+#include "linux/cassettetape.h"
 
 #include "Configuration/PropertySheet.h"
 #include "Debugger/Debug.h"
@@ -62,6 +63,7 @@ Initialisation::~Initialisation()
     Paddle::instance.reset();
 
     RiffFinishWriteFile();
+    CassetteTape::instance().stopRecording();
 
     CloseHandle(g_hCustomRomF8);
     g_hCustomRomF8 = INVALID_HANDLE_VALUE;
@@ -2,6 +2,7 @@
 #include "Keyboard.h"
 
 #include "Core.h"
+#include "CPU.h"
 #include "YamlHelper.h"
 
 namespace
@@ -9,6 +10,13 @@ namespace
     std::queue<BYTE> keys;
     bool g_bCapsLock = true; // Caps lock key for Apple2 and Lat/Cyr lock for Pravets8
     BYTE keycode = 0;
+    UINT64 keyReadCount = 0; // # of $C000 reads
+    unsigned __int64 keyLastReadCycle = 0;
+
+    // pasted text is queued with the typed keys: it is pending until the last pasted key has been popped
+    UINT64 keyPushCount = 0;
+    UINT64 keyPopCount = 0;
+    UINT64 pasteEndCount = 0;
 
     void setKeyCode()
     {
@@ -22,6 +30,7 @@ namespace
 void addKeyToBuffer(BYTE key)
 {
     keys.push(key);
+    ++keyPushCount;
 }
 
 void addTextToBuffer(const char *text)
@@ -39,6 +48,37 @@ void addTextToBuffer(const char *text)
         // skip non ASCII characters
         ++text;
     }
+    pasteEndCount = keyPushCount;
+}
+
+void KeybPasteText(const std::string &text)
+{
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\r' || text[i] == '\n')
+        {
+            if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n')
+            {
+                ++i;
+            }
+            addKeyToBuffer(0x0d);
+        }
+        else if (text[i] >= 0x20 && text[i] <= 0x7e)
+        {
+            addKeyToBuffer(text[i]);
+        }
+    }
+    pasteEndCount = keyPushCount;
+}
+
+bool KeybIsPasting()
+{
+    return keyPopCount < pasteEndCount && (g_nCumulativeCycles - keyLastReadCycle) < KEYB_PASTE_IDLE_CYCLES;
+}
+
+UINT64 KeybGetReadCount()
+{
+    return keyReadCount;
 }
 
 void KeybSetAltGrSendsWM_CHAR(bool state)
@@ -62,6 +102,8 @@ BYTE KeybGetKeycode()
 BYTE KeybReadData()
 {
     LogFileTimeUntilFirstKeyRead();
+    ++keyReadCount;
+    keyLastReadCycle = g_nCumulativeCycles;
 
     setKeyCode();
 
@@ -108,6 +150,7 @@ void KeybLoadSnapshot(YamlLoadHelper &yamlLoadHelper, UINT version)
         keywaiting = yamlLoadHelper.LoadBool(SS_YAML_KEY_KEYWAITING);
 
     keys = std::queue<BYTE>();
+    keyPopCount = keyPushCount;
     addKeyToBuffer(keycode);
 
     yamlLoadHelper.PopMap();
@@ -144,6 +187,7 @@ BYTE KeybClearStrobe(void)
     {
         const BYTE result = keys.front();
         keys.pop();
+        ++keyPopCount;
         return result | 0x80;
     }
 }
@@ -1,29 +1,710 @@
 #include "StdAfx.h"
 
 #include "SerialComms.h"
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Interface.h"
+#include "Log.h"
+#include "Memory.h"
+#include "Registry.h"
 #include "YamlHelper.h"
+#include "linux/serialbackend.h"
+
+#include "../resource/resource.h"
+
+// Linux version of the Super Serial Card
+// . same 6551 ACIA as SerialComms.cpp, but the host side is a SerialBackend (pty, Unix socket, TCP or fd)
+// . SerialBackend's I/O thread only fills/drains lock-free queues: all 6551 state lives on the emulator thread
+// . RX/TX are paced by the baud rate (via a SyncEvent), unless in turbo mode
+
+// Default: 9600-8-N-1
+SSC_DIPSW CSuperSerialCard::m_DIPSWDefault =
+{
+    // DIPSW1:
+    CBR_9600,       // Use 9600, as a 1MHz Apple II can only handle up to 9600 bps [Ref.1]
+    FWMODE_CIC,
+
+    // DIPSW2:
+    ONESTOPBIT,
+    8,              // ByteSize
+    NOPARITY,
+    false,          // SW2-5: LF(0x0A). SSC-24: In Comms mode, SSC automatically discards LF immediately following CR
+    true,           // SW2-6: Interrupts. SSC-47: Passes interrupt requests from ACIA to the Apple II. NB. Can't be read from software
+};
+
+//===========================================================================
 
 CSuperSerialCard::CSuperSerialCard(UINT slot)
     : Card(CT_SSC, slot)
+    , m_pExpansionRom(NULL)
+    , m_bCfgSupportDCD(false)
+    , m_syncEvent(slot, 0, SyncEventCallback) // use slot# as "unique" id for SSCs
+    , m_bTurbo(false)
 {
+    if (m_slot != 2) // fixme
+        ThrowErrorInvalidSlot();
+
+    m_dwSerialPortItem = 0;
+
+    InternalReset();
+
+    char serialPortName[256];
+    std::string regSection = RegGetConfigSlotSection(m_slot);
+    RegLoadString(regSection.c_str(), REGVALUE_SERIAL_PORT_NAME, TRUE, serialPortName, sizeof(serialPortName), "");
+
+    SetSerialPortName(serialPortName);
 }
 
 CSuperSerialCard::~CSuperSerialCard()
 {
+    if (m_syncEvent.m_active)
+        g_SynchronousEventMgr.Remove(m_syncEvent.m_id);
+
+    CloseComm();
+
+    delete[] m_pExpansionRom;
+    m_pExpansionRom = NULL;
 }
 
-void CSuperSerialCard::SetSerialPortName(const char *pSerialPortName)
+void CSuperSerialCard::InternalReset()
+{
+    GetDIPSW();
+
+    // SY6551 datasheet: Hardware reset sets Command register to 0
+    // SY6551 datasheet: Hardware reset sets Control register to 0 - the DIPSW settings are not used by h/w to setup this register
+    UpdateCommandAndControlRegs(0, 0); // Baud=External clock! 8-N-1
+
+    m_vbTxIrqPending = false;
+    m_vbRxIrqPending = false;
+    m_vbTxEmpty = true;
+
+    m_uRxData = 0;
+    m_bRxFull = false;
+    m_uRxNextCycle = 0;
+    m_uTxDoneCycle = 0;
+
+    m_uDTR = DTR_CONTROL_DISABLE;
+    m_uRTS = RTS_CONTROL_DISABLE;
+    m_dwModemStatus = m_kDefaultModemStatus;
+}
+
+//===========================================================================
+
+void CSuperSerialCard::GetDIPSW()
 {
+    SetDIPSWDefaults();
 }
 
-void CSuperSerialCard::Reset(const bool /* powerCycle */)
+void CSuperSerialCard::SetDIPSWDefaults()
+{
+    m_DIPSWCurrent = m_DIPSWDefault;
+}
+
+UINT CSuperSerialCard::BaudRateToIndex(UINT uBaudRate)
+{
+    switch (uBaudRate)
+    {
+    case CBR_110: return 0x05;
+    case CBR_300: return 0x06;
+    case CBR_600: return 0x07;
+    case CBR_1200: return 0x08;
+    case CBR_2400: return 0x0A;
+    case CBR_4800: return 0x0C;
+    case CBR_9600: return 0x0E;
+    case CBR_19200: return 0x0F;
+    case CBR_115200: return 0x00;
+    }
+
+    LogFileOutput("SSC: BaudRateToIndex(): unsupported rate: %d\n", uBaudRate);
+    return BaudRateToIndex(m_kDefaultBaudRate); // nominally use AppleWin default
+}
+
+//===========================================================================
+
+// NB. a socket or pty has no line settings: they are only used to pace the transfers
+void CSuperSerialCard::UpdateCommState()
+{
+}
+
+bool CSuperSerialCard::CheckComm()
+{
+    // NB. the backend is opened by SetSerialPortName(), and stays open across Apple II resets
+    return IsActive();
+}
+
+void CSuperSerialCard::CloseComm()
+{
+    m_pBackend.reset();
+}
+
+//===========================================================================
+
+BYTE __stdcall CSuperSerialCard::SSC_IORead(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles)
+{
+    UINT uSlot = ((uAddr & 0xff) >> 4) - 8;
+    CSuperSerialCard *pSSC = (CSuperSerialCard *)MemGetSlotParameters(uSlot);
+
+    switch (uAddr & 0xf)
+    {
+    case 0x1: return pSSC->CommDipSw(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0x2: return pSSC->CommDipSw(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0x8: return pSSC->CommReceive(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0x9: return pSSC->CommStatus(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0xA: return pSSC->CommCommand(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0xB: return pSSC->CommControl(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    }
+
+    return IO_Null(PC, uAddr, bWrite, uValue, nExecutedCycles);
+}
+
+BYTE __stdcall CSuperSerialCard::SSC_IOWrite(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles)
+{
+    UINT uSlot = ((uAddr & 0xff) >> 4) - 8;
+    CSuperSerialCard *pSSC = (CSuperSerialCard *)MemGetSlotParameters(uSlot);
+
+    switch (uAddr & 0xf)
+    {
+    case 0x8: return pSSC->CommTransmit(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0x9: return pSSC->CommProgramReset(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0xA: return pSSC->CommCommand(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    case 0xB: return pSSC->CommControl(PC, uAddr, bWrite, uValue, nExecutedCycles);
+    }
+
+    return IO_Null(PC, uAddr, bWrite, uValue, nExecutedCycles);
+}
+
+//===========================================================================
+
+// 6551 ACIA Command Register ($C08A+s0)
+enum
+{
+    CMD_PARITY_MASK = 3 << 6,
+    CMD_PARITY_ODD = 0 << 6,   // Odd parity
+    CMD_PARITY_EVEN = 1 << 6,  // Even parity
+    CMD_PARITY_MARK = 2 << 6,  // Mark parity
+    CMD_PARITY_SPACE = 3 << 6, // Space parity
+    CMD_PARITY_ENA = 1 << 5,
+    CMD_ECHO_MODE = 1 << 4,
+    CMD_TX_MASK = 3 << 2,
+    CMD_TX_IRQ_DIS_RTS_HIGH = 0 << 2,
+    CMD_TX_IRQ_ENA_RTS_LOW = 1 << 2,
+    CMD_TX_IRQ_DIS_RTS_LOW = 2 << 2,
+    CMD_TX_IRQ_DIS_RTS_LOW_BRK = 3 << 2, // Transmit BRK
+    CMD_RX_IRQ_DIS = 1 << 1,             // 1=IRQ interrupt disabled
+    CMD_DTR = 1 << 0,                    // Data Terminal Ready: Enable(1) or disable(0) receiver and all interrupts (!DTR low)
+};
+
+BYTE __stdcall CSuperSerialCard::CommProgramReset(WORD, WORD, BYTE, BYTE, ULONG)
+{
+    // Command: top-3 parity bits unaffected
+    UpdateCommandReg(m_uCommandByte & (CMD_PARITY_MASK | CMD_PARITY_ENA));
+
+    // Control: all bits unaffected
+    // Status: all bits unaffects, except Overrun(bit2) is cleared
+
+    return 0;
+}
+
+//===========================================================================
+
+void CSuperSerialCard::UpdateCommandAndControlRegs(BYTE uCommandByte, BYTE uControlByte)
+{
+    // UpdateCommandReg() first to initialise m_uParity, before calling UpdateControlReg()
+    UpdateCommandReg(uCommandByte);
+    UpdateControlReg(uControlByte);
+}
+
+void CSuperSerialCard::UpdateCommandReg(BYTE command)
+{
+    m_uCommandByte = command;
+
+    if (m_uCommandByte & CMD_PARITY_ENA)
+    {
+        switch (m_uCommandByte & CMD_PARITY_MASK)
+        {
+        case CMD_PARITY_ODD: m_uParity = ODDPARITY; break;
+        case CMD_PARITY_EVEN: m_uParity = EVENPARITY; break;
+        case CMD_PARITY_MARK: m_uParity = MARKPARITY; break;
+        case CMD_PARITY_SPACE: m_uParity = SPACEPARITY; break;
+        }
+    }
+    else
+    {
+        m_uParity = NOPARITY;
+    }
+
+    if (m_uCommandByte & CMD_ECHO_MODE) // Receiver mode echo (0=no echo, 1=echo)
+    {
+        LogFileOutput("SSC: CommCommand(): unsupported Echo mode. Command=0x%02X\n", m_uCommandByte);
+    }
+
+    switch (m_uCommandByte & CMD_TX_MASK) // transmitter interrupt control
+    {
+    // Note: the RTS signal must be set 'low' in order to receive any incoming data from the serial device [Ref.1]
+    case CMD_TX_IRQ_DIS_RTS_HIGH: // set RTS high and transmit no interrupts (transmitter is off [Ref.3])
+        m_uRTS = RTS_CONTROL_DISABLE;
+        break;
+    case CMD_TX_IRQ_ENA_RTS_LOW: // set RTS low and transmit interrupts
+        m_uRTS = RTS_CONTROL_ENABLE;
+        break;
+    case CMD_TX_IRQ_DIS_RTS_LOW: // set RTS low and transmit no interrupts
+        m_uRTS = RTS_CONTROL_ENABLE;
+        break;
+    case CMD_TX_IRQ_DIS_RTS_LOW_BRK: // set RTS low and transmit break signals instead of interrupts
+        m_uRTS = RTS_CONTROL_ENABLE;
+        LogFileOutput("SSC: CommCommand(): unsupported TX mode. Command=0x%02X\n", m_uCommandByte);
+        break;
+    }
+
+    if (m_DIPSWCurrent.bInterrupts && m_uCommandByte & CMD_DTR)
+    {
+        // Assume enabling Rx IRQ if STATUS.ST_RX_FULL *does not* trigger an IRQ
+        // Assume enabling Tx IRQ if STATUS.ST_TX_EMPTY *does not* trigger an IRQ
+        m_bTxIrqEnabled = (m_uCommandByte & CMD_TX_MASK) == CMD_TX_IRQ_ENA_RTS_LOW;
+        m_bRxIrqEnabled = (m_uCommandByte & CMD_RX_IRQ_DIS) == 0;
+    }
+    else
+    {
+        m_bTxIrqEnabled = false;
+        m_bRxIrqEnabled = false;
+    }
+
+    // Data Terminal Ready (DTR) setting (0=set DTR high (indicates 'not ready')) (GH#386)
+    m_uDTR = (m_uCommandByte & CMD_DTR) ? DTR_CONTROL_ENABLE : DTR_CONTROL_DISABLE;
+}
+
+BYTE __stdcall CSuperSerialCard::CommCommand(WORD, WORD, BYTE write, BYTE value, ULONG nExecutedCycles)
+{
+    if (!CheckComm())
+        return 0;
+
+    if (write && (value != m_uCommandByte))
+    {
+        CpuCalcCycles(nExecutedCycles);
+        UpdateCommandReg(value);
+        ScheduleTransferEvent(); // DTR may have (re-)enabled the receiver
+    }
+
+    return m_uCommandByte;
+}
+
+//===========================================================================
+
+void CSuperSerialCard::UpdateControlReg(BYTE control)
+{
+    m_uControlByte = control;
+
+    // UPDATE THE BAUD RATE
+    switch (m_uControlByte & 0x0F)
+    {
+    case 0x00: m_uBaudRate = CBR_115200; break; // Internal clk: undoc'd 115.2K (or 16x external clock)
+    case 0x01: // fall through [50 bps]
+    case 0x02: // fall through [75 bps]
+    case 0x03: // fall through [109.92 bps]
+    case 0x04: // fall through [134.58 bps]
+    case 0x05: m_uBaudRate = CBR_110; break; // [150 bps]
+    case 0x06: m_uBaudRate = CBR_300; break;
+    case 0x07: m_uBaudRate = CBR_600; break;
+    case 0x08: m_uBaudRate = CBR_1200; break;
+    case 0x09: // fall through [1800 bps]
+    case 0x0A: m_uBaudRate = CBR_2400; break;
+    case 0x0B: // fall through [3600 bps]
+    case 0x0C: m_uBaudRate = CBR_4800; break;
+    case 0x0D: // fall through [7200 bps]
+    case 0x0E: m_uBaudRate = CBR_9600; break;
+    case 0x0F: m_uBaudRate = CBR_19200; break;
+    }
+
+    // UPDATE THE BYTE SIZE
+    switch (m_uControlByte & 0x60)
+    {
+    case 0x00: m_uByteSize = 8; break;
+    case 0x20: m_uByteSize = 7; break;
+    case 0x40: m_uByteSize = 6; break;
+    case 0x60: m_uByteSize = 5; break;
+    }
+
+    // UPDATE THE NUMBER OF STOP BITS
+    if (m_uControlByte & 0x80)
+    {
+        if ((m_uByteSize == 8) && (m_uParity != NOPARITY))
+            m_uStopBits = ONESTOPBIT;
+        else if ((m_uByteSize == 5) && (m_uParity == NOPARITY))
+            m_uStopBits = ONE5STOPBITS;
+        else
+            m_uStopBits = TWOSTOPBITS;
+    }
+    else
+    {
+        m_uStopBits = ONESTOPBIT;
+    }
+}
+
+BYTE __stdcall CSuperSerialCard::CommControl(WORD, WORD, BYTE write, BYTE value, ULONG)
+{
+    if (!CheckComm())
+        return 0;
+
+    if (write && (value != m_uControlByte))
+    {
+        // NB. a new baud rate only applies to the next byte
+        UpdateControlReg(value);
+    }
+
+    return m_uControlByte;
+}
+
+//===========================================================================
+
+// Cycles to send (or receive) one byte: start bit + data bits + parity bit + stop bits
+UINT CSuperSerialCard::GetCharacterCycles(void)
+{
+    const double stopBits = m_uStopBits == ONESTOPBIT ? 1.0 : m_uStopBits == ONE5STOPBITS ? 1.5 : 2.0;
+    const double bits = 1 + m_uByteSize + (m_uParity != NOPARITY ? 1 : 0) + stopBits;
+    return (UINT)(g_fCurrentCLK6502 * bits / m_uBaudRate);
+}
+
+// Move the next received byte (if any) into the Receive Data Register
+bool CSuperSerialCard::LatchReceivedByte(void)
+{
+    if (m_bRxFull || !m_pBackend)
+        return false;
+
+    // If receiver is disabled then transmitting device should not send data
+    if ((m_uCommandByte & CMD_DTR) == 0)
+        return false;
+
+    if (!m_bTurbo && g_nCumulativeCycles < m_uRxNextCycle)
+        return false;
+
+    if (!m_pBackend->receive(m_uRxData))
+        return false;
+
+    if (m_uByteSize < 8)
+        m_uRxData &= (1 << m_uByteSize) - 1;
+
+    m_bRxFull = true;
+    m_uRxNextCycle = g_nCumulativeCycles + GetCharacterCycles();
+
+    if (m_bRxIrqEnabled)
+    {
+        CpuIrqAssert(IS_SSC);
+        m_vbRxIrqPending = true;
+    }
+
+    return true;
+}
+
+// Pre: g_nCumulativeCycles is up to date
+void CSuperSerialCard::UpdateTransfers(void)
+{
+    if (!m_vbTxEmpty && (m_bTurbo || g_nCumulativeCycles >= m_uTxDoneCycle))
+        TransmitDone();
+
+    LatchReceivedByte();
+}
+
+// 0 if there's nothing in flight
+int CSuperSerialCard::GetCyclesToNextTransfer(void)
+{
+    UINT64 next = 0;
+
+    if (!m_vbTxEmpty)
+        next = m_uTxDoneCycle;
+
+    if (!m_bRxFull && (m_uCommandByte & CMD_DTR) && m_pBackend && m_pBackend->hasReceived())
+    {
+        const UINT64 rxCycle = m_bTurbo ? 0 : m_uRxNextCycle;
+        next = next ? std::min(next, rxCycle) : rxCycle;
+        if (!next)
+            next = g_nCumulativeCycles;
+    }
+
+    if (!next)
+        return 0;
+
+    return next > g_nCumulativeCycles ? (int)(next - g_nCumulativeCycles) : 1;
+}
+
+void CSuperSerialCard::ScheduleTransferEvent(void)
+{
+    if (m_syncEvent.m_active)
+        g_SynchronousEventMgr.Remove(m_syncEvent.m_id);
+
+    const int cycles = GetCyclesToNextTransfer();
+    if (cycles)
+    {
+        m_syncEvent.SetCycles(cycles);
+        g_SynchronousEventMgr.Insert(&m_syncEvent);
+    }
+}
+
+int CSuperSerialCard::SyncEventCallback(int id, int /*cycles*/, ULONG uExecutedCycles)
+{
+    CSuperSerialCard *pSSC = GetCardMgr().GetSSC();
+    _ASSERT(pSSC && pSSC->m_slot == (UINT)id);
+
+    CpuCalcCycles(uExecutedCycles);
+    pSSC->UpdateTransfers();
+    return pSSC->GetCyclesToNextTransfer(); // 0 = don't re-arm
+}
+
+// Called once per emulated chunk: picks up what the I/O thread has received while the line was idle
+void CSuperSerialCard::Update(const ULONG /* nExecutedCycles */)
+{
+    if (m_pBackend && !m_syncEvent.m_active)
+        ScheduleTransferEvent();
+}
+
+//===========================================================================
+
+BYTE __stdcall CSuperSerialCard::CommReceive(WORD, WORD, BYTE, BYTE, ULONG nExecutedCycles)
+{
+    if (!CheckComm())
+        return 0;
+
+    CpuCalcCycles(nExecutedCycles);
+    UpdateTransfers();
+
+    if (!m_bRxFull)
+        return 0;
+
+    m_bRxFull = false;
+    const BYTE result = m_uRxData;
+
+    if (m_bTurbo)
+        LatchReceivedByte(); // next byte is ready straight away (asserts the IRQ again)
+    ScheduleTransferEvent();
+
+    return result;
+}
+
+//===========================================================================
+
+void CSuperSerialCard::TransmitDone(void)
+{
+    _ASSERT(m_vbTxEmpty == false);
+    m_vbTxEmpty = true;
+
+    if (m_bTxIrqEnabled) // GH#522
+    {
+        CpuIrqAssert(IS_SSC);
+        m_vbTxIrqPending = true;
+    }
+}
+
+BYTE __stdcall CSuperSerialCard::CommTransmit(WORD, WORD, BYTE, BYTE value, ULONG nExecutedCycles)
+{
+    if (!CheckComm())
+        return 0;
+
+    // If transmitter is disabled then: Is data just discarded or does it get transmitted if transmitter is later enabled?
+    if ((m_uCommandByte & CMD_TX_MASK) == CMD_TX_IRQ_DIS_RTS_HIGH) // Transmitter disable, so just discard for now
+        return 0;
+
+    BYTE data = value;
+    if (m_uByteSize < 8)
+        data &= (1 << m_uByteSize) - 1;
+
+    if (!m_pBackend->transmit(data))
+        LogFileOutput("SSC: CommTransmit(): TX queue full: byte dropped\n");
+
+    CpuCalcCycles(nExecutedCycles);
+    m_vbTxEmpty = false;
+
+    if (m_bTurbo)
+    {
+        TransmitDone();
+    }
+    else
+    {
+        m_uTxDoneCycle = g_nCumulativeCycles + GetCharacterCycles();
+        ScheduleTransferEvent();
+    }
+
+    return 0;
+}
+
+//===========================================================================
+
+// 6551 ACIA Status Register ($C089+s0)
+enum
+{
+    ST_IRQ = 1 << 7,
+    ST_DSR = 1 << 6,
+    ST_DCD = 1 << 5,
+    ST_TX_EMPTY = 1 << 4,
+    ST_RX_FULL = 1 << 3,
+    ST_OVERRUN_ERR = 1 << 2,
+    ST_FRAMING_ERR = 1 << 1,
+    ST_PARITY_ERR = 1 << 0,
+};
+
+BYTE __stdcall CSuperSerialCard::CommStatus(WORD, WORD, BYTE, BYTE, ULONG nExecutedCycles)
+{
+    if (!CheckComm())
+        return ST_DSR | ST_DCD | ST_TX_EMPTY;
+
+    CpuCalcCycles(nExecutedCycles);
+    UpdateTransfers();
+
+    // A connected client (or a pty) is a cable with all the modem lines asserted
+    const DWORD modemStatus = m_pBackend->isConnected() ? (MS_RLSD_ON | MS_DSR_ON | MS_CTS_ON) : m_kDefaultModemStatus;
+
+    BYTE IRQ = 0;
+    if (m_bTxIrqEnabled)
+    {
+        IRQ |= m_vbTxIrqPending ? ST_IRQ : 0;
+        m_vbTxIrqPending = false; // Ensure 2 reads of STATUS reg only return ST_IRQ for first read
+    }
+    if (m_bRxIrqEnabled)
+    {
+        IRQ |= m_vbRxIrqPending ? ST_IRQ : 0;
+        m_vbRxIrqPending = false; // Ensure 2 reads of STATUS reg only return ST_IRQ for first read
+    }
+
+    BYTE DSR = (modemStatus & MS_DSR_ON) ? 0x00 : ST_DSR;  // DSR is active low (see SY6551 datasheet) (GH#386)
+    BYTE DCD = (modemStatus & MS_RLSD_ON) ? 0x00 : ST_DCD; // DCD is active low (see SY6551 datasheet) (GH#386)
+
+    BYTE TX_EMPTY = m_vbTxEmpty ? ST_TX_EMPTY : 0;
+    BYTE RX_FULL = m_bRxFull ? ST_RX_FULL : 0;
+
+    BYTE uStatus = IRQ | DSR | DCD | TX_EMPTY | RX_FULL;
+
+    CpuIrqDeassert(IS_SSC); // Read status reg always clears IRQ
+
+    return uStatus;
+}
+
+//===========================================================================
+
+BYTE __stdcall CSuperSerialCard::CommDipSw(WORD, WORD addr, BYTE, BYTE, ULONG)
 {
+    BYTE sw = 0;
+
+    switch (addr & 0xf)
+    {
+    case 1: // DIPSW1
+        sw = (BaudRateToIndex(m_DIPSWCurrent.uBaudRate) << 4) | m_DIPSWCurrent.eFirmwareMode;
+        break;
+
+    case 2: // DIPSW2
+        // Comms mode: SSC-23
+        BYTE SW2_1 = m_DIPSWCurrent.uStopBits == TWOSTOPBITS ? 1 : 0; // SW2-1 (Stop bits: 1-ON(0); 2-OFF(1))
+        BYTE SW2_2 = m_DIPSWCurrent.uByteSize == 7 ? 1 : 0;           // SW2-2 (Data bits: 8-ON(0); 7-OFF(1))
+
+        // SW2-3 (Parity: odd-ON(0); even-OFF(1))
+        // SW2-4 (Parity: none-ON(0); SW2-3 don't care)
+        BYTE SW2_3, SW2_4;
+        switch (m_DIPSWCurrent.uParity)
+        {
+        case ODDPARITY:
+            SW2_3 = 0;
+            SW2_4 = 1;
+            break;
+        case EVENPARITY:
+            SW2_3 = 1;
+            SW2_4 = 1;
+            break;
+        default:
+            SW2_3 = 0;
+            SW2_4 = 0;
+            break;
+        }
+
+        BYTE SW2_5 = m_DIPSWCurrent.bLinefeed ? 0 : 1; // SW2-5 (LF: yes-ON(0); no-OFF(1))
+
+        BYTE CTS = 1; // Default to CTS being false. (Support CTS in DIPSW: GH#311)
+        if (CheckComm())
+            CTS = m_pBackend->isConnected() ? 0 : 1; // CTS active low (see SY6551 datasheet)
+
+        // SSC-54:
+        sw = SW2_1 << 7 | // b7 : SW2-1
+             0 << 6 |     // b6 : -
+             SW2_2 << 5 | // b5 : SW2-2
+             0 << 4 |     // b4 : -
+             SW2_3 << 3 | // b3 : SW2-3
+             SW2_4 << 2 | // b2 : SW2-4
+             SW2_5 << 1 | // b1 : SW2-5
+             CTS << 0;    // b0 : CTS
+        break;
+    }
+
+    return sw;
 }
 
+//===========================================================================
+
 void CSuperSerialCard::InitializeIO(LPBYTE pCxRomPeripheral)
 {
+    const UINT SSC_FW_SIZE = 2 * 1024;
+    const UINT SSC_SLOT_FW_SIZE = 256;
+    const UINT SSC_SLOT_FW_OFFSET = 7 * 256;
+
+    BYTE *pData = GetFrame().GetResource(IDR_SSC_FW, "FIRMWARE", SSC_FW_SIZE);
+    if (pData == NULL)
+        return;
+
+    memcpy(pCxRomPeripheral + m_slot * SSC_SLOT_FW_SIZE, pData + SSC_SLOT_FW_OFFSET, SSC_SLOT_FW_SIZE);
+
+    // Expansion ROM
+    if (m_pExpansionRom == NULL)
+    {
+        m_pExpansionRom = new BYTE[SSC_FW_SIZE];
+        memcpy(m_pExpansionRom, pData, SSC_FW_SIZE);
+    }
+
+    RegisterIoHandler(m_slot, &CSuperSerialCard::SSC_IORead, &CSuperSerialCard::SSC_IOWrite, NULL, NULL, this, m_pExpansionRom);
+}
+
+//===========================================================================
+
+void CSuperSerialCard::Reset(const bool /* powerCycle */)
+{
+    // NB. unlike Windows, keep the host side open: a terminal attached to the pty or socket survives an Apple II reset
+    if (m_syncEvent.m_active)
+        g_SynchronousEventMgr.Remove(m_syncEvent.m_id);
+
+    InternalReset();
+}
+
+//===========================================================================
+
+// Called by ctor & LoadSnapshot(): see SerialBackend::create() for the syntax
+void CSuperSerialCard::SetSerialPortName(const char *pSerialPortName)
+{
+    if (m_pBackend && m_currentSerialPortName == pSerialPortName)
+        return; // keep the connection
+
+    CloseComm();
+    m_currentSerialPortName = pSerialPortName;
+
+    if (m_currentSerialPortName.empty())
+        return;
+
+    try
+    {
+        m_pBackend = SerialBackend::create(m_currentSerialPortName);
+    }
+    catch (const std::exception &e)
+    {
+        LogFileOutput("%s\n", e.what());
+        GetFrame().FrameMessageBox(e.what(), "AppleWin Error", MB_OK);
+    }
+}
+
+void CSuperSerialCard::SetRegistrySerialPortName(void)
+{
+    if (!SerialBackend::isPersistent(GetSerialPortName()))
+        return; // keep the last port that can be re-opened
+
+    std::string regSection = RegGetConfigSlotSection(m_slot);
+    RegSaveString(regSection.c_str(), REGVALUE_SERIAL_PORT_NAME, TRUE, GetSerialPortName());
 }
 
+//===========================================================================
+
 // Unit version history:
 // 2: Added: Support DCD flag
 //    Removed: redundant data (encapsulated in Command & Control bytes)
@@ -52,18 +733,54 @@ static const UINT kUNIT_VERSION = 2;
 #define SS_YAML_KEY_SERIALPORTNAME "Serial Port Name"
 #define SS_YAML_KEY_SUPPORT_DCD "Support DCD"
 
+const std::string &CSuperSerialCard::GetSnapshotCardName()
+{
+    static const std::string name(SS_YAML_VALUE_CARD_SSC);
+    return name;
+}
+
+void CSuperSerialCard::SaveSnapshotDIPSW(YamlSaveHelper &yamlSaveHelper, std::string key, SSC_DIPSW &dipsw)
+{
+    YamlSaveHelper::Label label(yamlSaveHelper, "%s:\n", key.c_str());
+    yamlSaveHelper.SaveUint(SS_YAML_KEY_BAUDRATE, dipsw.uBaudRate);
+    yamlSaveHelper.SaveUint(SS_YAML_KEY_FWMODE, dipsw.eFirmwareMode);
+    yamlSaveHelper.SaveUint(SS_YAML_KEY_STOPBITS, dipsw.uStopBits);
+    yamlSaveHelper.SaveUint(SS_YAML_KEY_BYTESIZE, dipsw.uByteSize);
+    yamlSaveHelper.SaveUint(SS_YAML_KEY_PARITY, dipsw.uParity);
+    yamlSaveHelper.SaveBool(SS_YAML_KEY_LINEFEED, dipsw.bLinefeed);
+    yamlSaveHelper.SaveBool(SS_YAML_KEY_INTERRUPTS, dipsw.bInterrupts);
+}
+
+void CSuperSerialCard::SaveSnapshot(YamlSaveHelper &yamlSaveHelper)
+{
+    YamlSaveHelper::Slot slot(yamlSaveHelper, GetSnapshotCardName(), m_slot, kUNIT_VERSION);
+
+    YamlSaveHelper::Label unit(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
+    SaveSnapshotDIPSW(yamlSaveHelper, SS_YAML_KEY_DIPSWDEFAULT, m_DIPSWDefault);
+    SaveSnapshotDIPSW(yamlSaveHelper, SS_YAML_KEY_DIPSWCURRENT, m_DIPSWCurrent);
+    yamlSaveHelper.SaveHexUint8(SS_YAML_KEY_CONTROL, m_uControlByte);
+    yamlSaveHelper.SaveHexUint8(SS_YAML_KEY_COMMAND, m_uCommandByte);
+    yamlSaveHelper.SaveBool(SS_YAML_KEY_TXIRQPENDING, m_vbTxIrqPending);
+    yamlSaveHelper.SaveBool(SS_YAML_KEY_RXIRQPENDING, m_vbRxIrqPending);
+    yamlSaveHelper.SaveBool(SS_YAML_KEY_WRITTENTX, m_vbTxEmpty);
+    yamlSaveHelper.SaveBool(SS_YAML_KEY_SUPPORT_DCD, m_bCfgSupportDCD);
+    const std::string &serialPortName = GetSerialPortName();
+    yamlSaveHelper.SaveString(
+        SS_YAML_KEY_SERIALPORTNAME, SerialBackend::isPersistent(serialPortName) ? serialPortName : std::string());
+}
+
 void CSuperSerialCard::LoadSnapshotDIPSW(YamlLoadHelper &yamlLoadHelper, std::string key, SSC_DIPSW &dipsw)
 {
     if (!yamlLoadHelper.GetSubMap(key))
         throw std::runtime_error("Card: Expected key: " + key);
 
-    yamlLoadHelper.LoadUint(SS_YAML_KEY_BAUDRATE);
-    yamlLoadHelper.LoadUint(SS_YAML_KEY_FWMODE);
-    yamlLoadHelper.LoadUint(SS_YAML_KEY_STOPBITS);
-    yamlLoadHelper.LoadUint(SS_YAML_KEY_BYTESIZE);
-    yamlLoadHelper.LoadUint(SS_YAML_KEY_PARITY);
-    yamlLoadHelper.LoadBool(SS_YAML_KEY_LINEFEED);
-    yamlLoadHelper.LoadBool(SS_YAML_KEY_INTERRUPTS);
+    dipsw.uBaudRate = yamlLoadHelper.LoadUint(SS_YAML_KEY_BAUDRATE);
+    dipsw.eFirmwareMode = (eFWMODE)yamlLoadHelper.LoadUint(SS_YAML_KEY_FWMODE);
+    dipsw.uStopBits = yamlLoadHelper.LoadUint(SS_YAML_KEY_STOPBITS);
+    dipsw.uByteSize = yamlLoadHelper.LoadUint(SS_YAML_KEY_BYTESIZE);
+    dipsw.uParity = yamlLoadHelper.LoadUint(SS_YAML_KEY_PARITY);
+    dipsw.bLinefeed = yamlLoadHelper.LoadBool(SS_YAML_KEY_LINEFEED);
+    dipsw.bInterrupts = yamlLoadHelper.LoadBool(SS_YAML_KEY_INTERRUPTS);
 
     yamlLoadHelper.PopMap();
 }
@@ -73,9 +790,8 @@ bool CSuperSerialCard::LoadSnapshot(YamlLoadHelper &yamlLoadHelper, UINT version
     if (version < 1 || version > kUNIT_VERSION)
         ThrowErrorInvalidVersion(version);
 
-    SSC_DIPSW dipsw;
-    LoadSnapshotDIPSW(yamlLoadHelper, SS_YAML_KEY_DIPSWDEFAULT, dipsw);
-    LoadSnapshotDIPSW(yamlLoadHelper, SS_YAML_KEY_DIPSWCURRENT, dipsw);
+    LoadSnapshotDIPSW(yamlLoadHelper, SS_YAML_KEY_DIPSWDEFAULT, m_DIPSWDefault);
+    LoadSnapshotDIPSW(yamlLoadHelper, SS_YAML_KEY_DIPSWCURRENT, m_DIPSWCurrent);
 
     if (version == 1) // Consume redundant/obsolete data
     {
@@ -91,27 +807,33 @@ bool CSuperSerialCard::LoadSnapshot(YamlLoadHelper &yamlLoadHelper, UINT version
     }
     else if (version >= 2)
     {
-        yamlLoadHelper.LoadBool(SS_YAML_KEY_SUPPORT_DCD);
+        SupportDCD(yamlLoadHelper.LoadBool(SS_YAML_KEY_SUPPORT_DCD));
     }
 
-    yamlLoadHelper.LoadUint(SS_YAML_KEY_COMMAND);
-    yamlLoadHelper.LoadUint(SS_YAML_KEY_CONTROL);
+    UINT uCommandByte = yamlLoadHelper.LoadUint(SS_YAML_KEY_COMMAND);
+    UINT uControlByte = yamlLoadHelper.LoadUint(SS_YAML_KEY_CONTROL);
+    UpdateCommandAndControlRegs(uCommandByte, uControlByte);
 
-    yamlLoadHelper.LoadBool(SS_YAML_KEY_TXIRQPENDING);
-    yamlLoadHelper.LoadBool(SS_YAML_KEY_RXIRQPENDING);
-    yamlLoadHelper.LoadBool(SS_YAML_KEY_WRITTENTX);
+    m_vbTxIrqPending = yamlLoadHelper.LoadBool(SS_YAML_KEY_TXIRQPENDING);
+    m_vbRxIrqPending = yamlLoadHelper.LoadBool(SS_YAML_KEY_RXIRQPENDING);
+    m_vbTxEmpty = yamlLoadHelper.LoadBool(SS_YAML_KEY_WRITTENTX);
 
-    yamlLoadHelper.LoadString(SS_YAML_KEY_SERIALPORTNAME);
+    if (m_vbTxIrqPending || m_vbRxIrqPending) // GH#677
+        CpuIrqAssert(IS_SSC);
 
-    return true;
-}
+    // the byte being sent (if any) completes straight away
+    m_uTxDoneCycle = g_nCumulativeCycles;
+    m_uRxNextCycle = g_nCumulativeCycles;
 
-void CSuperSerialCard::SaveSnapshot(YamlSaveHelper &)
-{
-}
+    // an fd:<n> in an older save-state was a descriptor of the process that saved it: keep the current port
+    std::string serialPortName = yamlLoadHelper.LoadString(SS_YAML_KEY_SERIALPORTNAME);
+    if (SerialBackend::isPersistent(serialPortName))
+    {
+        SetSerialPortName(serialPortName.c_str());
+        SetRegistrySerialPortName();
+    }
 
-const std::string &CSuperSerialCard::GetSnapshotCardName()
-{
-    static const std::string name(SS_YAML_VALUE_CARD_SSC);
-    return name;
+    ScheduleTransferEvent();
+
+    return true;
 }
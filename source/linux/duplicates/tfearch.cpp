@@ -62,18 +62,17 @@ void TfePcapCloseAdapter(pcap_t *TfePcapFP)
 void tfe_arch_set_mac(const BYTE mac[6])
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-    if (g_fh)
-        fprintf(
-            g_fh, "New MAC address set: %02X:%02X:%02X:%02X:%02X:%02X.\n", mac[0], mac[1], mac[2], mac[3], mac[4],
-            mac[5]);
+    LOG_CATEGORY(
+        LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "New MAC address set: %02X:%02X:%02X:%02X:%02X:%02X.\n", mac[0], mac[1],
+        mac[2], mac[3], mac[4], mac[5]);
 #endif
 }
 
 void tfe_arch_set_hashfilter(const uint32_t hash_mask[2])
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-    if (g_fh)
-        fprintf(g_fh, "New hash filter set: %08X:%08X.\n", hash_mask[1], hash_mask[0]);
+    LOG_CATEGORY(
+        LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "New hash filter set: %08X:%08X.\n", hash_mask[1], hash_mask[0]);
 #endif
 }
 
@@ -87,16 +86,18 @@ void tfe_arch_recv_ctl(
 )
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-    if (g_fh)
+    if (LogIsEnabled(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG))
     {
-        fprintf(g_fh, "tfe_arch_recv_ctl() called with the following parameters:");
-        fprintf(g_fh, "\tbBroadcast   = %s", bBroadcast ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\tbIA          = %s", bIA ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\tbMulticast   = %s", bMulticast ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\tbCorrect     = %s", bCorrect ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\tbPromiscuous = %s", bPromiscuous ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\tbIAHash      = %s", bIAHash ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\n");
+        LogCategoryOutput(
+            LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_recv_ctl() called with the following parameters:");
+        LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbBroadcast   = %s", bBroadcast ? "TRUE" : "FALSE");
+        LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbIA          = %s", bIA ? "TRUE" : "FALSE");
+        LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbMulticast   = %s", bMulticast ? "TRUE" : "FALSE");
+        LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbCorrect     = %s", bCorrect ? "TRUE" : "FALSE");
+        LogCategoryOutput(
+            LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbPromiscuous = %s", bPromiscuous ? "TRUE" : "FALSE");
+        LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbIAHash      = %s", bIAHash ? "TRUE" : "FALSE");
+        LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\n");
     }
 #endif
 }
@@ -104,12 +105,15 @@ void tfe_arch_recv_ctl(
 void tfe_arch_line_ctl(int bEnableTransmitter, int bEnableReceiver)
 {
 #if defined(TFE_DEBUG_ARCH) || defined(TFE_DEBUG_FRAMES)
-    if (g_fh)
+    if (LogIsEnabled(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG))
     {
-        fprintf(g_fh, "tfe_arch_line_ctl() called with the following parameters:");
-        fprintf(g_fh, "\tbEnableTransmitter = %s", bEnableTransmitter ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\tbEnableReceiver    = %s", bEnableReceiver ? "TRUE" : "FALSE");
-        fprintf(g_fh, "\n");
+        LogCategoryOutput(
+            LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "tfe_arch_line_ctl() called with the following parameters:");
+        LogCategoryOutput(
+            LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbEnableTransmitter = %s", bEnableTransmitter ? "TRUE" : "FALSE");
+        LogCategoryOutput(
+            LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\tbEnableReceiver    = %s", bEnableReceiver ? "TRUE" : "FALSE");
+        LogCategoryOutput(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "\n");
     }
 #endif
 }
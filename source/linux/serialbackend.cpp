@@ -0,0 +1,507 @@
+#include "StdAfx.h"
+
+#include "linux/serialbackend.h"
+
+#include "Log.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+
+    constexpr int ourDefaultTcpPort = 1977; // same as AppleWin's TCP serial port
+
+    void throwErrno(const std::string &what)
+    {
+        throw std::runtime_error("SSC: " + what + ": " + strerror(errno));
+    }
+
+    void closeFD(int &fd)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    void setNonBlocking(const int fd)
+    {
+        const int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    int listenOn(const int domain, const sockaddr *address, const socklen_t length, const std::string &name)
+    {
+        int fd = socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            throwErrno("socket(" + name + ")");
+        }
+
+        if (domain == AF_INET)
+        {
+            const int on = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        }
+
+        if (bind(fd, address, length) || listen(fd, 1))
+        {
+            const int error = errno;
+            closeFD(fd);
+            errno = error;
+            throwErrno("bind(" + name + ")");
+        }
+        return fd;
+    }
+
+    std::shared_ptr<SerialBackend> createPty(const std::string &link)
+    {
+        int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (master < 0)
+        {
+            throwErrno("posix_openpt()");
+        }
+
+        char name[256];
+        if (grantpt(master) || unlockpt(master) || ptsname_r(master, name, sizeof(name)))
+        {
+            const int error = errno;
+            closeFD(master);
+            errno = error;
+            throwErrno("ptsname()");
+        }
+
+        // no echo, no line editing, no CR/LF translation: the guest sees exactly what is typed
+        termios attributes;
+        if (tcgetattr(master, &attributes) == 0)
+        {
+            cfmakeraw(&attributes);
+            tcsetattr(master, TCSANOW, &attributes);
+        }
+
+        const int slave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+        setNonBlocking(master);
+
+        if (!link.empty())
+        {
+            unlink(link.c_str());
+            if (symlink(name, link.c_str()))
+            {
+                LogFileOutput("SSC: cannot create symlink %s -> %s: %s\n", link.c_str(), name, strerror(errno));
+            }
+        }
+
+        return std::make_shared<SerialBackend>(-1, master, slave, name, link);
+    }
+
+    std::shared_ptr<SerialBackend> createUnix(const std::string &path)
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path))
+        {
+            throw std::runtime_error("SSC: invalid socket path: '" + path + "'");
+        }
+        strcpy(address.sun_path, path.c_str());
+
+        unlink(path.c_str()); // stale socket from a previous run
+        const int fd = listenOn(AF_UNIX, (const sockaddr *)&address, sizeof(address), path);
+        return std::make_shared<SerialBackend>(fd, -1, -1, path, path);
+    }
+
+    std::shared_ptr<SerialBackend> createTcp(const std::string &arg)
+    {
+        // [<address>:]<port>
+        std::string host = "0.0.0.0";
+        int port = ourDefaultTcpPort;
+        if (!arg.empty())
+        {
+            const size_t colon = arg.rfind(':');
+            if (colon != std::string::npos)
+            {
+                host = arg.substr(0, colon);
+            }
+            port = std::stoi(arg.substr(colon == std::string::npos ? 0 : colon + 1));
+        }
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+        {
+            throw std::runtime_error("SSC: invalid address: '" + host + "'");
+        }
+
+        const std::string name = "tcp:" + host + ":" + std::to_string(port);
+        const int fd = listenOn(AF_INET, (const sockaddr *)&address, sizeof(address), name);
+        return std::make_shared<SerialBackend>(fd, -1, -1, name, std::string());
+    }
+
+} // namespace
+
+//===========================================================================
+
+SerialQueue::SerialQueue(const size_t capacity)
+    : myHead(0)
+    , myTail(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    myData.resize(size);
+    myMask = size - 1;
+}
+
+bool SerialQueue::push(const uint8_t value)
+{
+    const size_t head = myHead.load();
+    if (head - myTail.load() == myData.size())
+    {
+        return false;
+    }
+    myData[head & myMask] = value;
+    myHead.store(head + 1);
+    return true;
+}
+
+bool SerialQueue::pop(uint8_t &value)
+{
+    const size_t tail = myTail.load();
+    if (myHead.load() == tail)
+    {
+        return false;
+    }
+    value = myData[tail & myMask];
+    myTail.store(tail + 1);
+    return true;
+}
+
+size_t SerialQueue::size() const
+{
+    const size_t tail = myTail.load();
+    return myHead.load() - tail;
+}
+
+//===========================================================================
+
+std::shared_ptr<SerialBackend> SerialBackend::create(const std::string &spec)
+{
+    const size_t colon = spec.find(':');
+    const std::string type = spec.substr(0, colon);
+    const std::string arg = colon == std::string::npos ? std::string() : spec.substr(colon + 1);
+
+    if (type == "pty")
+    {
+        return createPty(arg);
+    }
+    else if (type == "unix")
+    {
+        return createUnix(arg);
+    }
+    else if (type == "tcp")
+    {
+        return createTcp(arg);
+    }
+    else if (type == "fd" && !arg.empty())
+    {
+        // duplicated: the caller keeps its descriptor, and the card can be re-created (eg. on a config reload)
+        const int fd = fcntl(std::stoi(arg), F_DUPFD_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            throwErrno("fd:" + arg);
+        }
+        setNonBlocking(fd);
+        return std::make_shared<SerialBackend>(-1, fd, -1, spec, std::string());
+    }
+
+    throw std::runtime_error("SSC: invalid serial port: '" + spec + "'");
+}
+
+bool SerialBackend::isPersistent(const std::string &spec)
+{
+    return spec.compare(0, 3, "fd:") != 0;
+}
+
+SerialBackend::SerialBackend(
+    const int listenFD, const int streamFD, const int holdFD, const std::string &name, const std::string &removePath)
+    : myName(name)
+    , myRemovePath(removePath)
+    , myListenFD(listenFD)
+    , myHoldFD(holdFD)
+    , myStreamFD(streamFD)
+    , myRxQueue(ourQueueSize)
+    , myTxQueue(ourQueueSize)
+    , myIsSocket(false)
+    , myConnected(streamFD >= 0)
+    , myNotified(false)
+    , myStop(false)
+{
+    myWakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (myWakeFD < 0)
+    {
+        throwErrno("eventfd()");
+    }
+
+    struct stat st;
+    myIsSocket = myStreamFD >= 0 && fstat(myStreamFD, &st) == 0 && S_ISSOCK(st.st_mode);
+
+    myThread = std::thread(&SerialBackend::run, this);
+    LogFileOutput("SSC: serial port on %s\n", myName.c_str());
+}
+
+SerialBackend::~SerialBackend()
+{
+    myStop = true;
+    wake();
+    myThread.join();
+
+    closeStream();
+    int fd = myListenFD;
+    closeFD(fd);
+    fd = myHoldFD;
+    closeFD(fd);
+    closeFD(myWakeFD);
+
+    if (!myRemovePath.empty())
+    {
+        unlink(myRemovePath.c_str());
+    }
+}
+
+const std::string &SerialBackend::getName() const
+{
+    return myName;
+}
+
+bool SerialBackend::isConnected() const
+{
+    return myConnected;
+}
+
+bool SerialBackend::hasReceived() const
+{
+    return !myRxQueue.empty();
+}
+
+bool SerialBackend::receive(uint8_t &data)
+{
+    if (!myRxQueue.pop(data))
+    {
+        return false;
+    }
+
+    // the I/O thread only stops reading when the queue is full
+    if (myRxQueue.size() == myRxQueue.capacity() - 1)
+    {
+        notify();
+    }
+    return true;
+}
+
+bool SerialBackend::transmit(const uint8_t data)
+{
+    if (!myTxQueue.push(data))
+    {
+        return false;
+    }
+
+    // the I/O thread only stops writing when the queue is empty
+    if (myTxQueue.size() == 1)
+    {
+        notify();
+    }
+    return true;
+}
+
+void SerialBackend::wake()
+{
+    const uint64_t one = 1;
+    const ssize_t res = write(myWakeFD, &one, sizeof(one));
+    (void)res; // can only fail if the counter overflows, in which case a wake-up is pending anyway
+}
+
+void SerialBackend::notify()
+{
+    // one syscall per I/O thread iteration at most
+    if (!myNotified.exchange(true))
+    {
+        wake();
+    }
+}
+
+void SerialBackend::closeStream()
+{
+    if (myStreamFD >= 0)
+    {
+        closeFD(myStreamFD);
+        myTxPending.clear();
+        myConnected = false;
+        if (myListenFD >= 0)
+        {
+            LogFileOutput("SSC: client disconnected from %s\n", myName.c_str());
+        }
+    }
+}
+
+bool SerialBackend::readStream()
+{
+    uint8_t buffer[4096];
+    const size_t space = std::min(myRxQueue.capacity() - myRxQueue.size(), sizeof(buffer));
+    if (!space)
+    {
+        return true;
+    }
+
+    const ssize_t received = read(myStreamFD, buffer, space);
+    if (received > 0)
+    {
+        for (ssize_t i = 0; i < received; ++i)
+        {
+            myRxQueue.push(buffer[i]);
+        }
+        return true;
+    }
+
+    // 0 = EOF
+    return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+}
+
+bool SerialBackend::writeStream()
+{
+    uint8_t data;
+    while (myTxPending.size() < 4096 && myTxQueue.pop(data))
+    {
+        myTxPending.push_back(data);
+    }
+
+    if (myTxPending.empty())
+    {
+        return true;
+    }
+
+    // MSG_NOSIGNAL: a peer that went away must not SIGPIPE the emulator
+    const ssize_t sent = myIsSocket ? send(myStreamFD, myTxPending.data(), myTxPending.size(), MSG_NOSIGNAL)
+                                    : write(myStreamFD, myTxPending.data(), myTxPending.size());
+    if (sent > 0)
+    {
+        myTxPending.erase(myTxPending.begin(), myTxPending.begin() + sent);
+        return true;
+    }
+
+    return sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+}
+
+void SerialBackend::run()
+{
+    while (!myStop)
+    {
+        // NB. clear before looking at the queues, see notify()
+        myNotified = false;
+
+        if (myStreamFD < 0)
+        {
+            // nobody is listening: the line just drops what the guest sends
+            uint8_t data;
+            while (myTxQueue.pop(data))
+            {
+            }
+        }
+
+        pollfd fds[2];
+        nfds_t count = 0;
+        fds[count++] = {myWakeFD, POLLIN, 0};
+
+        if (myStreamFD >= 0)
+        {
+            short events = 0;
+            if (!myRxQueue.full())
+            {
+                events |= POLLIN;
+            }
+            if (!myTxPending.empty() || !myTxQueue.empty())
+            {
+                events |= POLLOUT;
+            }
+            // if both queues are blocked, leave the stream out, else a hang-up would spin this loop
+            if (events)
+            {
+                fds[count++] = {myStreamFD, events, 0};
+            }
+        }
+        else if (myListenFD >= 0)
+        {
+            fds[count++] = {myListenFD, POLLIN, 0};
+        }
+
+        if (poll(fds, count, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LogFileOutput("SSC: poll() failed: %s\n", strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            uint64_t value;
+            const ssize_t res = read(myWakeFD, &value, sizeof(value));
+            (void)res;
+        }
+
+        if (count < 2 || !fds[1].revents)
+        {
+            continue;
+        }
+
+        if (myStreamFD >= 0)
+        {
+            bool ok = true;
+            if (fds[1].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                ok = readStream();
+            }
+            if (ok && (fds[1].revents & POLLOUT))
+            {
+                ok = writeStream();
+            }
+            if (!ok)
+            {
+                closeStream();
+            }
+        }
+        else
+        {
+            // one client at a time: the next one waits in the backlog
+            const int fd = accept4(myListenFD, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0)
+            {
+                const int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // fails harmlessly on a Unix socket
+                myStreamFD = fd;
+                myIsSocket = true;
+                myConnected = true;
+                LogFileOutput("SSC: client connected to %s\n", myName.c_str());
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Single producer / single consumer byte queue, no locks
+// . push() must only be called by one thread and pop() by one (other) thread
+class SerialQueue
+{
+public:
+    explicit SerialQueue(const size_t capacity); // rounded up to a power of 2
+
+    bool push(const uint8_t value); // false if full
+    bool pop(uint8_t &value);       // false if empty
+
+    size_t size() const;
+    size_t capacity() const
+    {
+        return myData.size();
+    }
+    bool empty() const
+    {
+        return size() == 0;
+    }
+    bool full() const
+    {
+        return size() == capacity();
+    }
+
+private:
+    std::vector<uint8_t> myData;
+    size_t myMask;
+
+    std::atomic<size_t> myHead; // next write: only changed by the producer
+    std::atomic<size_t> myTail; // next read: only changed by the consumer
+};
+
+// Host side of the Super Serial Card
+// . a dedicated thread waits (poll) on the host file descriptors and moves the bytes to/from the queues
+// . the emulator thread only touches the queues: receive(), transmit()
+//
+// Supported specs:
+// . pty[:<link>]                a pseudo-terminal (optionally symlinked as <link>)
+// . unix:<path>                 listen on a Unix domain socket
+// . tcp[:[<address>:]<port>]    listen on a TCP port (default 1977)
+// . fd:<n>                      an already connected stream (eg. one end of a socketpair), duplicated
+class SerialBackend
+{
+public:
+    static std::shared_ptr<SerialBackend> create(const std::string &spec); // throws std::runtime_error
+
+    // false for fd:<n>: the descriptor is inherited and only exists in this process,
+    // so the spec must not be saved to the registry or a save-state
+    static bool isPersistent(const std::string &spec);
+
+    // takes ownership of the file descriptors (-1 if not used)
+    // . listenFD: accept one client at a time
+    // . streamFD: connected stream
+    // . holdFD: kept open until destruction (the pty slave, so the master never sees a hang-up)
+    // . removePath: deleted on destruction (socket or symlink)
+    SerialBackend(
+        const int listenFD, const int streamFD, const int holdFD, const std::string &name,
+        const std::string &removePath);
+    ~SerialBackend();
+
+    SerialBackend(const SerialBackend &) = delete;
+    SerialBackend &operator=(const SerialBackend &) = delete;
+
+    const std::string &getName() const; // eg. /dev/pts/3 or the socket path
+
+    bool isConnected() const;
+
+    // emulator thread
+    bool receive(uint8_t &data); // false if nothing has been received
+    bool hasReceived() const;
+    bool transmit(const uint8_t data); // false if the TX queue is full (the byte is dropped)
+
+private:
+    static constexpr size_t ourQueueSize = 64 * 1024;
+
+    void run();
+    void wake();
+    void notify();
+    void closeStream();
+    bool readStream();
+    bool writeStream();
+
+    const std::string myName;
+    const std::string myRemovePath;
+    const int myListenFD; // -1 if none
+    const int myHoldFD;   // -1 if none
+    int myStreamFD;       // -1 if no client is connected
+    int myWakeFD;         // eventfd: stop / TX queue not empty / RX queue not full
+
+    SerialQueue myRxQueue; // host -> guest
+    SerialQueue myTxQueue; // guest -> host
+    std::vector<uint8_t> myTxPending; // popped from the TX queue, but not yet written (I/O thread only)
+    bool myIsSocket;                  // else a pty / pipe: write() instead of send()
+
+    std::atomic<bool> myConnected;
+    std::atomic<bool> myNotified; // a wake-up is pending: cleared by the I/O thread before it looks at the queues
+    std::atomic<bool> myStop;
+    std::thread myThread;
+};
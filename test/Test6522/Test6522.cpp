@@ -0,0 +1,292 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "Mockingboard.h"
+#include "Registry.h"
+#include "SaveState.h"
+
+#include <fstream>
+#include <iostream>
+
+// Runs a 6522 timer program on the full emulator (65C02 + Mockingboard in slot 4) and checks that
+// what the guest sees (and what the debugger & save-state see) does not depend on how the host
+// slices the execution into CpuExecute() chunks.
+// The reference hashes were recorded with the original 6522 implementation, which updated the
+// timer counters eagerly at the end of every chunk.
+
+namespace
+{
+
+	// Program @ $0800. Latches are patched in at $08-$0C.
+	const BYTE g_program[] =
+	{
+		0x78,               // 0800: SEI
+		0xA9, 0x9E,         // 0801: LDA #<irq
+		0x8D, 0xFE, 0x03,   // 0803: STA $03FE
+		0xA9, 0x08,         // 0806: LDA #>irq
+		0x8D, 0xFF, 0x03,   // 0808: STA $03FF
+		0xA9, 0x00,         // 080B: LDA #$00
+		0x85, 0x06,         // 080D: STA $06         ; irq index
+		0x85, 0x07,         // 080F: STA $07         ; loop index
+		0xA9, 0x7F,         // 0811: LDA #$7F
+		0x8D, 0x0E, 0xC4,   // 0813: STA $C40E       ; IER: disable all
+		0xA9, 0x40,         // 0816: LDA #$40
+		0x8D, 0x0B, 0xC4,   // 0818: STA $C40B       ; ACR: T1 free-running
+		0xA9, 0xC0,         // 081B: LDA #$C0
+		0x8D, 0x0E, 0xC4,   // 081D: STA $C40E       ; IER: enable T1
+		0xA5, 0x08,         // 0820: LDA $08
+		0x8D, 0x04, 0xC4,   // 0822: STA $C404       ; T1L_L
+		0xA5, 0x09,         // 0825: LDA $09
+		0x8D, 0x05, 0xC4,   // 0827: STA $C405       ; T1C_H: start T1
+		0xA9, 0x34,         // 082A: LDA #$34
+		0x8D, 0x08, 0xC4,   // 082C: STA $C408       ; T2L_L
+		0xA9, 0x12,         // 082F: LDA #$12
+		0x8D, 0x09, 0xC4,   // 0831: STA $C409       ; T2C_H: start T2 (no IRQ)
+		0x58,               // 0834: CLI
+		// loop1:
+		0xA6, 0x07,         // 0835: LDX $07
+		0xAD, 0x05, 0xC4,   // 0837: LDA $C405       ; T1C_H
+		0x9D, 0x00, 0x10,   // 083A: STA $1000,X
+		0xAD, 0x08, 0xC4,   // 083D: LDA $C408       ; T2C_L
+		0x9D, 0x00, 0x11,   // 0840: STA $1100,X
+		0xAD, 0x0D, 0xC4,   // 0843: LDA $C40D       ; IFR
+		0x9D, 0x00, 0x12,   // 0846: STA $1200,X
+		0xE6, 0x07,         // 0849: INC $07
+		0xD0, 0xE8,         // 084B: BNE loop1
+		0xA5, 0x0A,         // 084D: LDA $0A
+		0x8D, 0x06, 0xC4,   // 084F: STA $C406       ; T1L_L (new latch: used on next underflow)
+		0xA5, 0x0B,         // 0852: LDA $0B
+		0x8D, 0x07, 0xC4,   // 0854: STA $C407       ; T1L_H
+		// loop2:
+		0xA6, 0x07,         // 0857: LDX $07
+		0xAD, 0x04, 0xC4,   // 0859: LDA $C404       ; T1C_L (clears IFR.T1)
+		0x9D, 0x00, 0x13,   // 085C: STA $1300,X
+		0xAD, 0x09, 0xC4,   // 085F: LDA $C409       ; T2C_H
+		0x9D, 0x00, 0x16,   // 0862: STA $1600,X
+		0xE6, 0x07,         // 0865: INC $07
+		0xD0, 0xEE,         // 0867: BNE loop2
+		0x78,               // 0869: SEI
+		0xA9, 0x00,         // 086A: LDA #$00
+		0x8D, 0x0B, 0xC4,   // 086C: STA $C40B       ; ACR: T1 one-shot
+		0xA5, 0x0C,         // 086F: LDA $0C
+		0x8D, 0x04, 0xC4,   // 0871: STA $C404
+		0xA9, 0x00,         // 0874: LDA #$00
+		0x8D, 0x05, 0xC4,   // 0876: STA $C405       ; start T1 (polled)
+		0xA9, 0x05,         // 0879: LDA #$05
+		0x8D, 0x08, 0xC4,   // 087B: STA $C408
+		0xA9, 0x00,         // 087E: LDA #$00
+		0x8D, 0x09, 0xC4,   // 0880: STA $C409       ; start T2 (polled)
+		// loop3:
+		0xA6, 0x07,         // 0883: LDX $07
+		0xAD, 0x0D, 0xC4,   // 0885: LDA $C40D       ; IFR
+		0x9D, 0x00, 0x17,   // 0888: STA $1700,X
+		0xAD, 0x05, 0xC4,   // 088B: LDA $C405       ; T1C_H
+		0x9D, 0x00, 0x18,   // 088E: STA $1800,X
+		0xAD, 0x08, 0xC4,   // 0891: LDA $C408       ; T2C_L (clears IFR.T2)
+		0x9D, 0x00, 0x19,   // 0894: STA $1900,X
+		0xE6, 0x07,         // 0897: INC $07
+		0xD0, 0xE8,         // 0899: BNE loop3
+		// done:
+		0x4C, 0x9B, 0x08,   // 089B: JMP done
+		// irq:
+		0x8A,               // 089E: TXA
+		0x48,               // 089F: PHA
+		0xA6, 0x06,         // 08A0: LDX $06
+		0xAD, 0x04, 0xC4,   // 08A2: LDA $C404       ; T1C_L (clears IFR.T1)
+		0x9D, 0x00, 0x14,   // 08A5: STA $1400,X
+		0xAD, 0x05, 0xC4,   // 08A8: LDA $C405       ; T1C_H
+		0x9D, 0x00, 0x15,   // 08AB: STA $1500,X
+		0xE6, 0x06,         // 08AE: INC $06
+		0x68,               // 08B0: PLA
+		0xAA,               // 08B1: TAX
+		0xA5, 0x45,         // 08B2: LDA $45
+		0x40,               // 08B4: RTI
+	};
+
+	const WORD kProgramAddr = 0x0800;
+	const WORD kDoneAddr = 0x089B;
+	const WORD kResultsAddr = 0x1000;
+	const UINT kResultsSize = 0x0A00;
+	const UINT kMaxCycles = 4000000;
+
+	struct TimerTest
+	{
+		SS_CARDTYPE card;
+		WORD latch1;	// T1 free-running (IRQ)
+		WORD latch2;	// T1 free-running (IRQ), written to latch only while T1 is running
+		BYTE latch3;	// T1 one-shot (polled)
+	};
+
+	struct Result
+	{
+		uint64_t guest;	// the results area in guest memory
+		uint64_t host;	// per-chunk debugger view of the 6522s + save-state timers
+	};
+
+	uint64_t Hash(uint64_t hash, const void* data, size_t size)
+	{
+		const BYTE* p = (const BYTE*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= p[i];
+			hash *= 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
+	const uint64_t kHashInit = 0xcbf29ce484222325ULL;
+
+	uint64_t HashSaveStateTimers(const std::string& pathname)
+	{
+		uint64_t hash = kHashInit;
+		std::ifstream file(pathname);
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.find("Timer") != std::string::npos)
+				hash = Hash(hash, line.data(), line.size());
+		}
+		return hash;
+	}
+
+	// chunk == 0: pseudo-random chunk sizes
+	Result RunTimerTest(const TimerTest& test, const UINT chunk)
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+		registry->putDWord(RegGetConfigSlotSection(SLOT4), REGVALUE_CARD_TYPE, test.card);
+		const testcommon::TestEmulator emulator(registry);
+
+		for (UINT i = 0; i < sizeof(g_program); i++)
+			WriteByteToMemory(kProgramAddr + i, g_program[i]);
+		for (UINT i = 0; i < kResultsSize; i++)
+			WriteByteToMemory(kResultsAddr + i, 0x00);
+		WriteByteToMemory(0x08, test.latch1 & 0xff);
+		WriteByteToMemory(0x09, test.latch1 >> 8);
+		WriteByteToMemory(0x0A, test.latch2 & 0xff);
+		WriteByteToMemory(0x0B, test.latch2 >> 8);
+		WriteByteToMemory(0x0C, test.latch3);
+		regs.pc = kProgramAddr;
+
+		MockingboardCard& card = dynamic_cast<MockingboardCard&>(GetCardMgr().GetRef(SLOT4));
+		const std::string snapshot = "test6522.aws.yaml";
+		Snapshot_SetFilename(snapshot);
+
+		Result result = { kHashInit, kHashInit };
+		UINT64 seed = 1;
+		UINT cycles = 0;
+		UINT chunks = 0;
+		const UINT64 startCycles = g_nCumulativeCycles;
+
+		while (cycles < kMaxCycles && (regs.pc < kDoneAddr || regs.pc > kDoneAddr + 2))
+		{
+			UINT n = chunk;
+			if (!n)
+			{
+				seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+				n = 1 + (UINT)((seed >> 33) % 3000);
+			}
+			cycles += CpuExecute(n, false);
+
+			MockingboardCard::DEBUGGER_MB_CARD mb;
+			card.GetSnapshotForDebugger(&mb);
+			for (UINT i = 0; i < NUM_SUBUNITS_PER_MB; i++)
+			{
+				result.host = Hash(result.host, mb.subUnit[i].regsSY6522, sizeof(mb.subUnit[i].regsSY6522));
+				result.host = Hash(result.host, &mb.subUnit[i].timer1Active, sizeof(bool));
+				result.host = Hash(result.host, &mb.subUnit[i].timer2Active, sizeof(bool));
+			}
+			const UINT64 elapsed = g_nCumulativeCycles - startCycles;
+			result.host = Hash(result.host, &elapsed, sizeof(elapsed));
+
+			if ((++chunks % 64) == 0)
+			{
+				Snapshot_SaveState();
+				const uint64_t timers = HashSaveStateTimers(snapshot);
+				result.host = Hash(result.host, &timers, sizeof(timers));
+			}
+		}
+
+		std::remove(snapshot.c_str());
+
+		if (cycles >= kMaxCycles)
+		{
+			result.guest = 0;	// didn't complete
+		}
+		else
+		{
+			for (UINT i = 0; i < kResultsSize; i++)
+			{
+				const BYTE b = ReadByteFromMemory(kResultsAddr + i);
+				result.guest = Hash(result.guest, &b, 1);
+			}
+		}
+
+		return result;
+	}
+
+}
+
+//-------------------------------------
+
+struct TimerTestExpected
+{
+	TimerTest test;
+	uint64_t guest;
+	uint64_t host[3];	// one per chunk size in g_chunks[]
+};
+
+const UINT g_chunks[] = { 1000, 37, 0 };
+
+const TimerTestExpected g_timerTests[] =
+{
+	{ { CT_MockingboardC, 0x0100, 0x0180, 0x20 }, 0x00bd92a938aa30daULL, { 0xc62100fa1355831bULL, 0x3e4eafe88973fa9dULL, 0x514a41278df71368ULL } },
+	{ { CT_MockingboardC, 0x0200, 0x0140, 0x03 }, 0xd62143148d21cff5ULL, { 0xbbb0a139858233d4ULL, 0xb0f074988eef7e66ULL, 0xbb7151a45f677deeULL } },
+	{ { CT_MockingboardC, 0x00FF, 0x0101, 0x00 }, 0xbc6fd1e53579b689ULL, { 0xf7c2c76cbc0901a7ULL, 0x6473666f3ae8cb9aULL, 0xdc957510af49efa7ULL } },
+	{ { CT_MegaAudio,     0x0100, 0x0180, 0x20 }, 0x072bd879d4ecbc2bULL, { 0x2bad2479f7ec256aULL, 0x517babe0bc0fb209ULL, 0x5199ee5447e3658bULL } },
+	{ { CT_MegaAudio,     0x0200, 0x0140, 0x01 }, 0xf69723fcb1b58820ULL, { 0xeb2e604af382d887ULL, 0xad4015f113818de1ULL, 0xdccee8dcfdd9eadaULL } },
+};
+
+int Timer_test(void)
+{
+	int res = 0;
+
+	for (const TimerTestExpected& expected : g_timerTests)
+	{
+		for (UINT i = 0; i < sizeof(g_chunks) / sizeof(g_chunks[0]); i++)
+		{
+			const Result result = RunTimerTest(expected.test, g_chunks[i]);
+			printf("card=%d latches=%04X,%04X,%02X chunk=%u: guest=%016llx host=%016llx\n",
+				expected.test.card, expected.test.latch1, expected.test.latch2, expected.test.latch3, g_chunks[i],
+				(unsigned long long)result.guest, (unsigned long long)result.host);
+
+			if (result.guest != expected.guest || result.host != expected.host[i])
+				res = 1;
+		}
+	}
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Timer_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -0,0 +1,324 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "Registry.h"
+
+#include <chrono>
+#include <vector>
+
+// Bank switching microbenchmark: a 6502 loop flips between 2 banks (RamWorks III, //e LC, Saturn 128K) 1M times.
+// . with the 'mem' cache (bank switching by pointer disabled) each flip also copies the switched pages
+// . by pointer, the heavy switching drops the cache: each flip only updates the switched pages' pointers
+// Data written to each bank must read back the same in both modes, and the cache must come back once the switching stops.
+// The timings are only printed: the test checks behaviour, not speed.
+// Also: a Z80 SoftCard must read the current memory while the cache is dropped.
+
+namespace
+{
+
+	const WORD kProgramAddr = 0x0300;
+	const UINT kChunk = 17030;	// ~1 video frame, as the frontends run
+	const UINT kFlipsPerOuterLoop = 256 * 256 * 2;
+	const BYTE kFlipOuterLoops = 8;	// 1M flips
+	const BYTE kCopyOuterLoops = 1;
+	const UINT kZ80Slot = 4;
+
+	struct BankSwitchCard
+	{
+		const char* name;
+		eApple2Type type;
+		UINT slot;			// SLOT_AUX or SLOT0
+		SS_CARDTYPE card;
+		std::vector<BYTE> setup;	// map the banks in (read & write)
+		std::vector<BYTE> bankA;	// select bank A
+		std::vector<BYTE> bankB;	// select bank B
+		std::vector<BYTE> restore;
+		WORD addr;			// in the switched banks
+	};
+
+	void Append(std::vector<BYTE>& program, const std::vector<BYTE>& code)
+	{
+		program.insert(program.end(), code.begin(), code.end());
+	}
+
+	void AppendBranch(std::vector<BYTE>& program, const BYTE opcode, const size_t target)
+	{
+		program.push_back(opcode);
+		program.push_back((BYTE)(target - (program.size() + 1)));
+	}
+
+	// Returns the address of the final JMP *
+	WORD AppendDone(std::vector<BYTE>& program)
+	{
+		const WORD done = (WORD)(kProgramAddr + program.size());
+		Append(program, { 0x4C, (BYTE)(done & 0xFF), (BYTE)(done >> 8) });
+		return done;
+	}
+
+	// Write $5A to bank A & $A5 to bank B, then read them back into $FB & $FC
+	std::vector<BYTE> VerifyProgram(const BankSwitchCard& test, WORD& done)
+	{
+		const BYTE lo = test.addr & 0xFF, hi = test.addr >> 8;
+		std::vector<BYTE> program;
+		Append(program, test.setup);
+		Append(program, test.bankA);
+		Append(program, { 0xA9, 0x5A, 0x8D, lo, hi });		// LDA #$5A; STA addr
+		Append(program, test.bankB);
+		Append(program, { 0xA9, 0xA5, 0x8D, lo, hi });		// LDA #$A5; STA addr
+		Append(program, test.bankA);
+		Append(program, { 0xAD, lo, hi, 0x85, 0xFB });		// LDA addr; STA $FB
+		Append(program, test.bankB);
+		Append(program, { 0xAD, lo, hi, 0x85, 0xFC });		// LDA addr; STA $FC
+		Append(program, test.bankA);
+		Append(program, test.restore);
+		done = AppendDone(program);
+		return program;
+	}
+
+	// Flip A/B 256*256 times per outer loop (count in $FA)
+	std::vector<BYTE> FlipProgram(const BankSwitchCard& test, WORD& done)
+	{
+		std::vector<BYTE> program;
+		Append(program, test.setup);
+		Append(program, { 0xA0, 0x00, 0xA2, 0x00 });	// LDY #0; LDX #0
+		const size_t loop = program.size();
+		Append(program, test.bankA);
+		Append(program, test.bankB);
+		program.push_back(0xCA);						// DEX
+		AppendBranch(program, 0xD0, loop);				// BNE loop
+		program.push_back(0x88);						// DEY
+		AppendBranch(program, 0xD0, loop);				// BNE loop
+		Append(program, { 0xC6, 0xFA });				// DEC $FA
+		AppendBranch(program, 0xD0, loop);				// BNE loop
+		Append(program, test.bankA);
+		Append(program, test.restore);
+		done = AppendDone(program);
+		return program;
+	}
+
+	bool Run(const std::vector<BYTE>& program, const WORD done, const UINT maxCycles, double& seconds)
+	{
+		for (UINT i = 0; i < program.size(); i++)
+			WriteByteToMemory(kProgramAddr + i, program[i]);
+		regs.pc = kProgramAddr;
+
+		const auto start = std::chrono::steady_clock::now();
+		UINT cycles = 0;
+		while (cycles < maxCycles && regs.pc != done)
+			cycles += CpuExecute(kChunk, false);
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return regs.pc == done;
+	}
+
+	int Verify(const BankSwitchCard& test, const char* mode)
+	{
+		WORD done;
+		const std::vector<BYTE> program = VerifyProgram(test, done);
+		WriteByteToMemory(0xFB, 0);
+		WriteByteToMemory(0xFC, 0);
+
+		double seconds;
+		if (!Run(program, done, 100000, seconds))
+		{
+			printf("%s (%s): verify didn't complete\n", test.name, mode);
+			return 1;
+		}
+
+		if (ReadByteFromMemory(0xFB) != 0x5A || ReadByteFromMemory(0xFC) != 0xA5)
+		{
+			printf("%s (%s): banks read back $%02X,$%02X\n", test.name, mode, ReadByteFromMemory(0xFB), ReadByteFromMemory(0xFC));
+			return 1;
+		}
+
+		return 0;
+	}
+
+	int Flip(const BankSwitchCard& test, const BYTE outerLoops, double& nsPerFlip)
+	{
+		WORD done;
+		const std::vector<BYTE> program = FlipProgram(test, done);
+		WriteByteToMemory(0xFA, outerLoops);
+
+		double seconds;
+		if (!Run(program, done, outerLoops * 256 * 256 * 40, seconds))
+		{
+			printf("%s: flip loop didn't complete\n", test.name);
+			return 1;
+		}
+
+		nsPerFlip = seconds * 1e9 / (outerLoops * kFlipsPerOuterLoop);
+		return 0;
+	}
+
+	int TestBankSwitch(const BankSwitchCard& test)
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry(test.type);
+		if (test.slot == SLOT_AUX)
+		{
+			registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_CARD_TYPE, test.card);
+			registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_AUX_NUM_BANKS, 2);
+		}
+		const testcommon::TestEmulator emulator(registry, common2::EmulatorOptions(), false, [&test]()
+		{
+			if (test.slot == SLOT0)
+				SetExpansionMemType(test.card, false);	// as the -s0 switch: slot 0 is otherwise reset to the machine's default
+		});
+
+		int res = 0;
+
+		if (!GetIsMemCacheValid())
+		{
+			printf("%s: not starting with the cache\n", test.name);
+			res = 1;
+		}
+
+		// always copying
+		MemSetBankSwitchByPointer(false);
+		res |= Verify(test, "copy");
+
+		double nsCopy = 0;
+		res |= Flip(test, kCopyOuterLoops, nsCopy);
+		if (MemIsBankSwitchByPointer())
+		{
+			printf("%s: switched to pointers while disabled\n", test.name);
+			res = 1;
+		}
+
+		// by pointer
+		MemSetBankSwitchByPointer(true);
+
+		double nsPointer = 0;
+		res |= Flip(test, kFlipOuterLoops, nsPointer);
+		if (!MemIsBankSwitchByPointer())
+		{
+			printf("%s: still copying pages\n", test.name);
+			res = 1;
+		}
+		res |= Verify(test, "pointer");
+
+		// quiet: back to the cache, with the banks' contents intact
+		double seconds;
+		const std::vector<BYTE> idle = { 0x4C, kProgramAddr & 0xFF, kProgramAddr >> 8 };
+		Run(idle, 0xFFFF, 2 * 1020484, seconds);	// ~2s
+		if (MemIsBankSwitchByPointer() || !GetIsMemCacheValid())
+		{
+			printf("%s: didn't go back to the cache\n", test.name);
+			res = 1;
+		}
+		res |= Verify(test, "cache");
+
+		printf("%s: %u flips copying %.0f ns/flip, %u flips by pointer %.0f ns/flip: %s\n",
+			test.name, kCopyOuterLoops * kFlipsPerOuterLoop, nsCopy, kFlipOuterLoops * kFlipsPerOuterLoop, nsPointer,
+			res ? "FAILED" : "OK");
+
+		return res;
+	}
+
+	// Without the cache 'mem' is stale, so the Z80's page table must map memshadow[] instead
+	int TestZ80(const BankSwitchCard& test)
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry(test.type);
+		registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_CARD_TYPE, test.card);
+		registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_AUX_NUM_BANKS, 2);
+		registry->putDWord(RegGetConfigSlotSection(kZ80Slot), REGVALUE_CARD_TYPE, CT_Z80);
+		const testcommon::TestEmulator emulator(registry);
+		g_nAppMode = MODE_RUNNING;	// the Z80 only uses its page table when running
+
+		int res = 0;
+
+		// drop the cache
+		double nsPointer = 0;
+		res |= Flip(test, 1, nsPointer);
+		if (!MemIsBankSwitchByPointer())
+		{
+			printf("Z80: the cache wasn't dropped\n");
+			return 1;
+		}
+
+		// Z80 $0000 (Apple $1000): LD A,($1000); LD ($1001),A; LD ($E400),A (back to the 6502); JR $
+		const std::vector<BYTE> z80 = { 0x3A, 0x00, 0x10, 0x32, 0x01, 0x10, 0x32, 0x00, (BYTE)(0xE0 + kZ80Slot), 0x18, 0xFE };
+		for (UINT i = 0; i < z80.size(); i++)
+			WriteByteToMemory(0x1000 + i, z80[i]);
+
+		// 6502: LDA #$77; STA $2000 (Z80 $1000); STA $C400 (to the Z80)
+		std::vector<BYTE> program = { 0xA9, 0x77, 0x8D, 0x00, 0x20, 0x8D, 0x00, (BYTE)(0xC0 + kZ80Slot) };
+		const WORD done = AppendDone(program);
+
+		double seconds;
+		if (!Run(program, done, 100000, seconds))
+		{
+			printf("Z80: didn't switch back to the 6502\n");
+			res = 1;
+		}
+		else if (ReadByteFromMemory(0x2001) != 0x77)
+		{
+			printf("Z80: read $%02X, not $77 (cache %s)\n", ReadByteFromMemory(0x2001), GetIsMemCacheValid() ? "valid" : "dropped");
+			res = 1;
+		}
+
+		printf("Z80 without the cache: %s\n", res ? "FAILED" : "OK");
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int BankSwitch_test(void)
+{
+	int res = 0;
+
+	// 80STORE+PAGE2+HIRES maps aux $0400-07FF & $2000-3FFF, so the program at $0300 and ZP stay in main
+	const BankSwitchCard ramWorks = { "RamWorks III", A2TYPE_APPLE2EENHANCED, SLOT_AUX, CT_RamWorksIII,
+		{ 0x8D, 0x01, 0xC0, 0x2C, 0x55, 0xC0, 0x2C, 0x57, 0xC0 },	// STA $C001; BIT $C055; BIT $C057
+		{ 0xA9, 0x00, 0x8D, 0x73, 0xC0 },	// LDA #0; STA $C073
+		{ 0xA9, 0x01, 0x8D, 0x73, 0xC0 },	// LDA #1; STA $C073
+		{ 0x2C, 0x56, 0xC0, 0x2C, 0x54, 0xC0, 0x8D, 0x00, 0xC0 },	// BIT $C056; BIT $C054; STA $C000
+		0x2000 };
+	res |= TestBankSwitch(ramWorks);
+
+	const BankSwitchCard languageCard = { "//e LC", A2TYPE_APPLE2EENHANCED, SLOT_AUX, CT_Extended80Col,
+		{},
+		{ 0x2C, 0x8B, 0xC0, 0x2C, 0x8B, 0xC0 },	// BIT $C08B x2: bank 1, read & write RAM
+		{ 0x2C, 0x83, 0xC0, 0x2C, 0x83, 0xC0 },	// BIT $C083 x2: bank 2, read & write RAM
+		{ 0x2C, 0x82, 0xC0 },					// BIT $C082: ROM
+		0xD000 };
+	res |= TestBankSwitch(languageCard);
+
+	const BankSwitchCard saturn = { "Saturn 128K", A2TYPE_APPLE2PLUS, SLOT0, CT_Saturn128K,
+		{ 0x2C, 0x8B, 0xC0, 0x2C, 0x8B, 0xC0 },	// BIT $C08B x2: read & write RAM
+		{ 0x2C, 0x84, 0xC0 },					// BIT $C084: 16K bank 0
+		{ 0x2C, 0x85, 0xC0 },					// BIT $C085: 16K bank 1
+		{ 0x2C, 0x82, 0xC0 },					// BIT $C082: ROM
+		0xE000 };
+	res |= TestBankSwitch(saturn);
+
+	res |= TestZ80(ramWorks);
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = BankSwitch_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -16,6 +16,7 @@ SynchronousEventManager g_SynchronousEventMgr;
 // From Memory.cpp
 LPBYTE         memshadow[0x100];	// init() just sets to mem pointers
 LPBYTE         memwrite[0x100];		// init() just sets to mem pointers
+LPBYTE         memwriteTrap[0x100];	// all NULL: no write traps
 BYTE           memreadPageType[0x100];
 LPBYTE         mem          = NULL;	// TODO: Init
 LPBYTE         memdirty     = NULL;	// TODO: Init
@@ -40,6 +41,18 @@ BYTE MemReadFloatingBus(const ULONG uExecutedCycles)
 	return 0;
 }
 
+bool g_memWriteTrapHit = false;
+
+void MemWriteTrap(const WORD addr, const BYTE value, const ULONG uExecutedCycles)
+{
+	LPBYTE page = memwriteTrap[addr >> 8];
+	if (!page)
+		return;
+
+	*(page + (addr & 0xFF)) = value;
+	g_memWriteTrapHit = true;
+}
+
 regsrec regs;
 
 bool g_irqOnLastOpcodeCycle = false;
@@ -1421,6 +1434,48 @@ int SyncEvents_test(void)
 
 //-------------------------------------
 
+int WriteTrap_test(void)
+{
+	// Write trap on page $04: the CPU must stop at the end of the opcode that writes to it
+	reset();
+	mem[0x300] = 0x8D;	// STA $0280
+	mem[0x301] = 0x80;
+	mem[0x302] = 0x02;
+	mem[0x303] = 0x8D;	// STA $0480
+	mem[0x304] = 0x80;
+	mem[0x305] = 0x04;
+	mem[0x306] = 0xEA;	// NOP
+	regs.a = 0x5A;
+	mem[0x480] = 0x00;
+
+	memwriteTrap[0x04] = memwrite[0x04];
+	memwrite[0x04] = NULL;
+
+	uint32_t cycles = TestCpu6502(100);
+	if (cycles != 4+4) return 1;
+	if (regs.pc != 0x306) return 1;
+	if (!g_memWriteTrapHit) return 1;
+	if (mem[0x480] != 0x5A) return 1;
+	if (mem[0x280] != 0x5A) return 1;
+
+	reset();
+	g_memWriteTrapHit = false;
+	regs.a = 0xA5;
+	cycles = TestCpu65C02(100);
+	if (cycles != 4+4) return 1;
+	if (regs.pc != 0x306) return 1;
+	if (!g_memWriteTrapHit) return 1;
+	if (mem[0x480] != 0xA5) return 1;
+
+	memwrite[0x04] = memwriteTrap[0x04];
+	memwriteTrap[0x04] = NULL;
+	g_memWriteTrapHit = false;
+
+	return 0;
+}
+
+//-------------------------------------
+
 int DoTest(void)
 {
 	int res = 1;
@@ -1450,6 +1505,8 @@ int DoTest(void)
 
 	res = SyncEvents_test();
 	if (res) return res;
+	res = WriteTrap_test();
+	if (res) return res;
 
 	return res;
 }
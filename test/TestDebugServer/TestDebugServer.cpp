@@ -0,0 +1,261 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "debugserver/DebugServerManager.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Interface.h"
+#include "Memory.h"
+#include "NTSC.h"
+#include "Registry.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Control server (port 65506) over loopback: the commands are executed by the emulation thread (here: main) between
+// 2 instructions, the client runs on its own thread, as a remote client would.
+// . a batch: results in order with their correlation ids, breakpoints, registers & memory
+// . throughput: batches of 1000 commands must reach kMinCommandsPerSecond
+// . fire and forget: results collected later from /api/results
+
+namespace
+{
+
+	const uint16_t kPort = static_cast<uint16_t>(debugserver::DebugServerPort::Control);
+	const UINT kBatches = 20;
+	const UINT kBatchSize = 1000;
+	const UINT kRoundTrips = 200;
+	const double kMinCommandsPerSecond = 2000.0;
+
+	// The body of the response, empty on error
+	std::string Http(const std::string& method, const std::string& target, const std::string& body)
+	{
+		const int fd = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(kPort);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+		{
+			if (fd >= 0)
+				close(fd);
+			return "";
+		}
+
+		const std::string request = method + " " + target + " HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: " +
+			std::to_string(body.size()) + "\r\n\r\n" + body;
+		for (size_t sent = 0; sent < request.size(); )
+		{
+			const ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+			if (n <= 0)
+				break;
+			sent += n;
+		}
+
+		std::string response;
+		char buffer[4096];
+		ssize_t n;
+		while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+			response.append(buffer, n);
+		close(fd);
+
+		const size_t headerEnd = response.find("\r\n\r\n");
+		return headerEnd == std::string::npos ? "" : response.substr(headerEnd + 4);
+	}
+
+	size_t Count(const std::string& text, const std::string& what)
+	{
+		size_t count = 0;
+		for (size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + what.size()))
+			count++;
+		return count;
+	}
+
+	// The result with this correlation id
+	std::string Result(const std::string& results, const std::string& id)
+	{
+		const size_t begin = results.find("\"id\":\"" + id + "\"");
+		return begin == std::string::npos ? "" : results.substr(begin, results.find('}', begin) - begin);
+	}
+
+	//-------------------------------------
+
+	int TestBatch(void)
+	{
+		// $0300: LDA #$42, STA $06, loop: INX, JMP loop
+		const std::string results = Http("POST", "/api/commands",
+			"#p pause\n"
+			"#w write 0300 A9 42 85 06 E8 4C 04 03\n"
+			"#r reg PC=0300 X=00\n"
+			"#s step 2\n"
+			"#m read 0006\n"
+			"#b bp set $0305\n"
+			"#c cycles 100000\n"
+			"#x bp clear 0305\n"
+			"#y regs\n"
+			"#u bogus 1 2 3\n"
+			"#e resume\n");
+
+		int res = 0;
+
+		if (results.find("\"complete\":true") == std::string::npos || Count(results, "\"seq\":") != 11 ||
+			results.find("\"id\":\"p\"") > results.find("\"id\":\"e\""))
+		{
+			printf("batch: not all the results, in order: %s\n", results.c_str());
+			return 1;
+		}
+
+		struct Expected { const char* id; const char* text; };
+		const Expected expected[] = {
+			{ "p", "\"mode\":\"Paused\"" },
+			{ "w", "\"length\":8" },
+			{ "s", "\"pc\":\"$0304\"" },
+			{ "m", "\"hex\":\"42\"" },
+			{ "c", "\"breakpoint\":true" },
+			{ "c", "\"pc\":\"$0305\"" },
+			{ "x", "\"found\":true" },
+			{ "y", "\"PC\":\"$0305\"" },
+			{ "u", "\"ok\":false" },
+			{ "u", "Unknown command: bogus" },
+			{ "e", "\"mode\":\"Running\"" },
+		};
+		for (const Expected& e : expected)
+		{
+			if (Result(results, e.id).find(e.text) == std::string::npos)
+			{
+				printf("batch: #%s: no %s in %s\n", e.id, e.text, Result(results, e.id).c_str());
+				res = 1;
+			}
+		}
+
+		return res;
+	}
+
+	int TestThroughput(void)
+	{
+		std::string batch;
+		for (UINT i = 0; i < kBatchSize; i += 2)
+			batch += "write 2000 " + std::to_string(i % 100) + "\nread 2000\n";
+
+		const auto start = std::chrono::steady_clock::now();
+		size_t ok = 0;
+		for (UINT i = 0; i < kBatches; i++)
+			ok += Count(Http("POST", "/api/commands", batch), "\"ok\":true");
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		const double rate = kBatches * kBatchSize / seconds;
+
+		const auto startSingle = std::chrono::steady_clock::now();
+		size_t okSingle = 0;
+		for (UINT i = 0; i < kRoundTrips; i++)
+			okSingle += Count(Http("POST", "/api/command", "status"), "\"ok\":true");
+		const double singleRate = kRoundTrips / std::chrono::duration<double>(std::chrono::steady_clock::now() - startSingle).count();
+
+		printf("throughput: %.0f commands/s in batches of %u (target %.0f), %.0f round trips/s\n", rate, kBatchSize, kMinCommandsPerSecond, singleRate);
+
+		if (ok != kBatches * kBatchSize || okSingle != kRoundTrips)
+		{
+			printf("throughput: %" SIZE_T_FMT " + %" SIZE_T_FMT " commands ok\n", ok, okSingle);
+			return 1;
+		}
+
+		return rate < kMinCommandsPerSecond ? 1 : 0;
+	}
+
+	int TestFireAndForget(void)
+	{
+		const std::string queued = Http("POST", "/api/commands?wait=0", "#a1 read 0300 4\n#a2 status\n#a3 key 8D\n");
+		if (queued.find("\"queued\":[") == std::string::npos)
+		{
+			printf("fire and forget: %s\n", queued.c_str());
+			return 1;
+		}
+
+		std::string results;
+		const auto start = std::chrono::steady_clock::now();
+		while (Count(results, "\"seq\":") < 3 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+		{
+			results += Http("GET", "/api/results", "");
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		if (Result(results, "a1").find("\"hex\":\"A9428506\"") == std::string::npos ||
+			Result(results, "a2").find("\"ok\":true") == std::string::npos || Result(results, "a3").find("\"ok\":true") == std::string::npos)
+		{
+			printf("fire and forget: %s\n", results.c_str());
+			return 1;
+		}
+
+		return 0;
+	}
+
+}
+
+//-------------------------------------
+
+int DebugServer_test(void)
+{
+	const testcommon::TestEmulator emulator(testcommon::CreateRegistry(), common2::EmulatorOptions(), true);
+	g_nAppMode = MODE_RUNNING;
+
+	if (!DebugServer_IsRunning())
+	{
+		printf("debug server not running (ports in use?)\n");
+		return 1;
+	}
+
+	std::atomic<bool> done(false);
+	int res = 0;
+	std::thread client([&]() {
+		res |= TestBatch();
+		res |= TestThroughput();
+		res |= TestFireAndForget();
+		done = true;
+	});
+
+	// the emulation thread: as CommonFrame::Execute()
+	while (!done)
+	{
+		if (g_nAppMode == MODE_RUNNING)
+		{
+			const UINT executed = CpuExecute(1000, true);
+			GetCardMgr().Update(executed);
+			g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executed) % NTSC_GetCyclesPerFrame();
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		DebugServer_ProcessCommands(common2::ExecuteSliceWithVideo);
+	}
+	client.join();
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = DebugServer_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -0,0 +1,456 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+
+#include "DiskImage.h"
+#include "DiskImageHelper.h"
+#include "Log.h"
+#include "ProDOS_FileSystem.h"
+#include "ProDOS_HostVolume.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <vector>
+
+// A host directory mounted as a ProDOS volume through the hard disk image API:
+// the generated blocks are walked like ProDOS would, then guest side changes are written back to the host.
+
+namespace
+{
+
+	struct DirEntry
+	{
+		ProDOS_FileHeader_t header;
+		WORD block;
+		int offset;
+	};
+
+	typedef std::map<std::string, DirEntry> Directory;
+
+	const size_t kManyFiles = 3000;
+	const double kMaxMountMs = 500.0;
+
+	ImageInfo* g_pImage = NULL;
+
+	std::vector<BYTE> Pattern(const size_t size, const int seed)
+	{
+		std::vector<BYTE> data(size);
+		for (size_t i = 0; i < size; i++)
+			data[i] = (BYTE)((i * 13 + seed) ^ (i >> 9));
+		return data;
+	}
+
+	void WriteHostFile(const std::filesystem::path& path, const std::vector<BYTE>& data)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write((const char*)data.data(), data.size());
+	}
+
+	std::vector<BYTE> ReadHostFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<BYTE>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	bool Mount(const std::filesystem::path& path)
+	{
+		bool bWriteProtected = false;
+		std::string strFilenameInZip;
+		return ImageOpen(path.string(), &g_pImage, &bWriteProtected, false, strFilenameInZip, false) == eIMAGE_ERROR_NONE;
+	}
+
+	void Unmount(void)
+	{
+		ImageClose(g_pImage);
+		g_pImage = NULL;
+	}
+
+	void ReadBlock(const UINT block, BYTE* buffer)
+	{
+		if (!ImageReadBlock(g_pImage, block, buffer))
+			memset(buffer, 0, PRODOS_BLOCK_SIZE);
+	}
+
+	Directory ReadDirectory(const WORD keyBlock)
+	{
+		Directory dir;
+		BYTE block[PRODOS_BLOCK_SIZE];
+
+		for (WORD nBlock = keyBlock, first = 1; nBlock; first = 0)
+		{
+			ReadBlock(nBlock, block);
+			for (int i = first; i < 13; i++)
+			{
+				DirEntry entry;
+				entry.block = nBlock;
+				entry.offset = 4 + i * 0x27;
+				ProDOS_GetFileHeader(block, entry.offset, &entry.header);
+				if (entry.header.kind != PRODOS_KIND_DEL)
+					dir[entry.header.name] = entry;
+			}
+			nBlock = ProDOS_Get16(block, 2);
+		}
+
+		return dir;
+	}
+
+	std::vector<BYTE> ReadFile(const ProDOS_FileHeader_t& header)
+	{
+		std::vector<WORD> dataBlocks;
+		BYTE block[PRODOS_BLOCK_SIZE];
+		BYTE index[PRODOS_BLOCK_SIZE];
+
+		if (header.kind == PRODOS_KIND_SEED)
+		{
+			dataBlocks.push_back(header.inode);
+		}
+		else
+		{
+			std::vector<WORD> indexes;
+			if (header.kind == PRODOS_KIND_SAPL)
+			{
+				indexes.push_back(header.inode);
+			}
+			else
+			{
+				ReadBlock(header.inode, block);
+				for (int i = 0; i < 128 && ProDOS_GetIndexBlock(block, 0, i); i++)
+					indexes.push_back((WORD)ProDOS_GetIndexBlock(block, 0, i));
+			}
+
+			for (const WORD nIndex : indexes)
+			{
+				ReadBlock(nIndex, index);
+				for (int i = 0; i < 256 && ProDOS_GetIndexBlock(index, 0, i); i++)
+					dataBlocks.push_back((WORD)ProDOS_GetIndexBlock(index, 0, i));
+			}
+		}
+
+		std::vector<BYTE> data;
+		for (const WORD nBlock : dataBlocks)
+		{
+			ReadBlock(nBlock, block);
+			data.insert(data.end(), block, block + PRODOS_BLOCK_SIZE);
+		}
+		data.resize(std::min<size_t>(data.size(), header.size));
+		return data;
+	}
+
+	int CheckFile(const Directory& dir, const char* name, const BYTE kind, const BYTE type, const WORD aux, const std::vector<BYTE>& content)
+	{
+		const Directory::const_iterator it = dir.find(name);
+		if (it == dir.end())
+		{
+			printf("%s: not found\n", name);
+			return 1;
+		}
+
+		const ProDOS_FileHeader_t& header = it->second.header;
+		if (header.kind != kind || header.type != type || header.aux != aux || header.size != content.size())
+		{
+			printf("%s: kind=%X type=$%02X aux=$%04X eof=%u\n", name, header.kind, header.type, header.aux, header.size);
+			return 1;
+		}
+
+		if (ReadFile(header) != content)
+		{
+			printf("%s: bad content\n", name);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	WORD GetFirstFreeBlock(const ProDOS_VolumeHeader_t& volume)
+	{
+		BYTE block[PRODOS_BLOCK_SIZE];
+		for (UINT nBlock = 0; nBlock < volume.meta.total_blocks; nBlock++)
+		{
+			if ((nBlock % 4096) == 0)
+				ReadBlock(volume.meta.bitmap_block + nBlock / 4096, block);
+			if (block[(nBlock % 4096) / 8] & (0x80 >> (nBlock % 8)))
+				return (WORD)nBlock;
+		}
+		return 0;
+	}
+
+	void UpdateEntry(const DirEntry& entry, const ProDOS_FileHeader_t& header)
+	{
+		BYTE block[PRODOS_BLOCK_SIZE];
+		ReadBlock(entry.block, block);
+		ProDOS_FileHeader_t copy = header;
+		ProDOS_PutFileHeader(block, entry.offset, &copy);
+		ImageWriteBlock(g_pImage, entry.block, block);
+	}
+
+	//-------------------------------------
+
+	int TestMount(const std::filesystem::path& root)
+	{
+		int res = 0;
+
+		std::filesystem::create_directories(root / "sub" / "deeper");
+		WriteHostFile(root / "HELLO.bas", Pattern(300, 1));
+		WriteHostFile(root / "data#062000", Pattern(5000, 2));
+		WriteHostFile(root / "big file.bin", Pattern(200000, 3));
+		WriteHostFile(root / "empty.txt", {});
+		WriteHostFile(root / ".hidden", Pattern(10, 4));
+		for (int i = 0; i < 40; i++)
+			WriteHostFile(root / "sub" / StrFormat("f%02d", i), Pattern(100 + i, i));
+		WriteHostFile(root / "sub" / "deeper" / "readme.txt", Pattern(700, 5));
+
+		if (!Mount(root))
+		{
+			printf("mount: failed\n");
+			return 1;
+		}
+
+		ProDOSHostVolume* pVolume = g_pImage->pHostVolume;
+		if (ImageGetImageSize(g_pImage) != ProDOSHostVolume::TOTAL_BLOCKS * HD_BLOCK_SIZE || pVolume->GetNumListedDirectories() != 1)
+		{
+			printf("mount: size=%u, %zu listed directories\n", ImageGetImageSize(g_pImage), pVolume->GetNumListedDirectories());
+			res = 1;
+		}
+
+		BYTE block[PRODOS_BLOCK_SIZE];
+		ReadBlock(PRODOS_ROOT_BLOCK, block);
+		ProDOS_VolumeHeader_t volume;
+		ProDOS_GetVolumeHeader(block, &volume, 0);
+		if (volume.kind != PRODOS_KIND_ROOT || strcmp(volume.name, "TESTHOSTVOLUME") || volume.file_count != 5 || volume.entry_len != 0x27 || volume.entry_num != 13)
+		{
+			printf("volume: kind=%X name=%s files=%u\n", volume.kind, volume.name, volume.file_count);
+			res = 1;
+		}
+
+		Directory rootDir = ReadDirectory(PRODOS_ROOT_BLOCK);
+		res |= CheckFile(rootDir, "HELLO", PRODOS_KIND_SEED, 0xFC, 0x0801, Pattern(300, 1));
+		res |= CheckFile(rootDir, "DATA", PRODOS_KIND_SAPL, 0x06, 0x2000, Pattern(5000, 2));
+		res |= CheckFile(rootDir, "BIG.FILE", PRODOS_KIND_TREE, 0x06, 0x2000, Pattern(200000, 3));
+		res |= CheckFile(rootDir, "EMPTY", PRODOS_KIND_SEED, 0x04, 0x0000, {});
+
+		// sub-directories are only listed when read
+		const DirEntry& sub = rootDir["SUB"];
+		if (sub.header.kind != PRODOS_KIND_DIR || sub.header.type != 0x0F || sub.header.blocks != 4)
+		{
+			printf("SUB: kind=%X type=$%02X blocks=%u\n", sub.header.kind, sub.header.type, sub.header.blocks);
+			res = 1;
+		}
+
+		const Directory subDir = ReadDirectory(sub.header.inode);
+		if (subDir.size() != 41 || pVolume->GetNumListedDirectories() != 2)
+		{
+			printf("SUB: %zu entries, %zu listed directories\n", subDir.size(), pVolume->GetNumListedDirectories());
+			res = 1;
+		}
+		res |= CheckFile(subDir, "F39", PRODOS_KIND_SEED, 0x06, 0x0000, Pattern(139, 39));
+
+		ReadBlock(sub.header.inode, block);
+		ProDOS_VolumeHeader_t subHeader;
+		ProDOS_GetVolumeHeader(block, &subHeader, 0);
+		if (subHeader.kind != PRODOS_KIND_SUB || subHeader.info.res75 != 0x75 || subHeader.meta.bitmap_block != sub.block || (subHeader.meta.total_blocks & 0xFF) != (sub.offset - 4) / 0x27 + 1)
+		{
+			printf("SUB header: kind=%X parent=%04X/%02X\n", subHeader.kind, subHeader.meta.bitmap_block, subHeader.meta.total_blocks & 0xFF);
+			res = 1;
+		}
+
+		// the bitmap lists everything: boot, root, bitmap, HELLO, DATA, BIG.FILE, EMPTY, SUB, F00-F39, DEEPER, README
+		const WORD firstFree = GetFirstFreeBlock(volume);
+		if (pVolume->GetNumListedDirectories() != 3 || firstFree != 2 + 4 + 16 + 1 + 11 + (1 + 2 + 391) + 1 + 4 + 40 + 1 + 3)
+		{
+			printf("bitmap: 1st free block %u, %zu listed directories\n", firstFree, pVolume->GetNumListedDirectories());
+			res = 1;
+		}
+
+		Unmount();
+		printf("mount: %s\n", res ? "FAILED" : "OK");
+		return res;
+	}
+
+	int TestWriteBack(const std::filesystem::path& root)
+	{
+		int res = 0;
+
+		if (!Mount(root))
+		{
+			printf("write back: mount failed\n");
+			return 1;
+		}
+
+		BYTE block[PRODOS_BLOCK_SIZE];
+		ReadBlock(PRODOS_ROOT_BLOCK, block);
+		ProDOS_VolumeHeader_t volume;
+		ProDOS_GetVolumeHeader(block, &volume, 0);
+		Directory rootDir = ReadDirectory(PRODOS_ROOT_BLOCK);
+
+		// rename
+		ProDOS_FileHeader_t header = rootDir["HELLO"].header;
+		strcpy(header.name, "GREETING");
+		header.len = 8;
+		UpdateEntry(rootDir["HELLO"], header);
+
+		// rewrite a block in place (same EOF)
+		const std::vector<BYTE> newData = Pattern(5000, 7);
+		header = rootDir["DATA"].header;
+		ReadBlock(header.inode, block);
+		const WORD dataBlock = (WORD)ProDOS_GetIndexBlock(block, 0, 0);
+		ImageWriteBlock(g_pImage, dataBlock, (LPBYTE)&newData[0]);
+		std::vector<BYTE> expected = Pattern(5000, 2);
+		std::copy(newData.begin(), newData.begin() + PRODOS_BLOCK_SIZE, expected.begin());
+		UpdateEntry(rootDir["DATA"], header);
+
+		// delete
+		header = rootDir["EMPTY"].header;
+		header.kind = PRODOS_KIND_DEL;
+		UpdateEntry(rootDir["EMPTY"], header);
+
+		// create: TXT, then BIN with an unusual address
+		const char text[] = "HELLO FROM PRODOS";
+		for (int i = 0; i < 2; i++)
+		{
+			const WORD key = GetFirstFreeBlock(volume);
+			memset(block, 0, sizeof(block));
+			memcpy(block, text, sizeof(text) - 1);
+			ImageWriteBlock(g_pImage, key, block);
+
+			ReadBlock(volume.meta.bitmap_block + key / 4096, block);
+			block[(key % 4096) / 8] &= ~(0x80 >> (key % 8));
+			ImageWriteBlock(g_pImage, volume.meta.bitmap_block + key / 4096, block);
+
+			header = rootDir["BIG.FILE"].header;
+			strcpy(header.name, i ? "PROG" : "NOTES");
+			header.len = (uint8_t)strlen(header.name);
+			header.kind = PRODOS_KIND_SEED;
+			header.type = i ? 0x06 : 0x04;
+			header.aux = i ? 0x0300 : 0x0000;
+			header.inode = key;
+			header.blocks = 1;
+			header.size = sizeof(text) - 1;
+			DirEntry entry;	// after SUB
+			entry.block = PRODOS_ROOT_BLOCK;
+			entry.offset = 4 + (6 + i) * 0x27;
+			UpdateEntry(entry, header);
+		}
+
+		Unmount();
+
+		const std::vector<BYTE> textData(text, text + sizeof(text) - 1);
+		if (!std::filesystem::exists(root / "GREETING.bas") || std::filesystem::exists(root / "HELLO.bas"))
+		{
+			printf("write back: rename failed\n");
+			res = 1;
+		}
+		if (ReadHostFile(root / "data#062000") != expected)
+		{
+			printf("write back: DATA not rewritten\n");
+			res = 1;
+		}
+		if (std::filesystem::exists(root / "empty.txt"))
+		{
+			printf("write back: EMPTY not deleted\n");
+			res = 1;
+		}
+		if (ReadHostFile(root / "NOTES.txt") != textData || ReadHostFile(root / "PROG#060300") != textData)
+		{
+			printf("write back: new files not created\n");
+			res = 1;
+		}
+
+		// and back again
+		if (!Mount(root))
+		{
+			printf("write back: remount failed\n");
+			return 1;
+		}
+
+		rootDir = ReadDirectory(PRODOS_ROOT_BLOCK);
+		res |= CheckFile(rootDir, "GREETING", PRODOS_KIND_SEED, 0xFC, 0x0801, Pattern(300, 1));
+		res |= CheckFile(rootDir, "DATA", PRODOS_KIND_SAPL, 0x06, 0x2000, expected);
+		res |= CheckFile(rootDir, "NOTES", PRODOS_KIND_SEED, 0x04, 0x0000, textData);
+		res |= CheckFile(rootDir, "PROG", PRODOS_KIND_SEED, 0x06, 0x0300, textData);
+		Unmount();
+
+		printf("write back: %s\n", res ? "FAILED" : "OK");
+		return res;
+	}
+
+	int TestManyFiles(const std::filesystem::path& root)
+	{
+		int res = 0;
+
+		std::filesystem::create_directories(root);
+		for (size_t i = 0; i < kManyFiles; i++)
+			WriteHostFile(root / StrFormat("file%04zu.txt", i), Pattern(i % 1000, (int)i));
+		for (int i = 0; i < 100; i++)
+		{
+			std::filesystem::create_directories(root / StrFormat("dir%03d", i));
+			for (int j = 0; j < 20; j++)
+				WriteHostFile(root / StrFormat("dir%03d", i) / StrFormat("f%02d", j), Pattern(j, i));
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const bool bMounted = Mount(root);
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (!bMounted)
+		{
+			printf("many files: mount failed\n");
+			return 1;
+		}
+
+		const Directory rootDir = ReadDirectory(PRODOS_ROOT_BLOCK);
+		if (rootDir.size() != kManyFiles + 100 || g_pImage->pHostVolume->GetNumListedDirectories() != 1 || ms > kMaxMountMs)
+		{
+			printf("many files: %zu entries, %zu listed directories\n", rootDir.size(), g_pImage->pHostVolume->GetNumListedDirectories());
+			res = 1;
+		}
+		res |= CheckFile(rootDir, "FILE2999", PRODOS_KIND_SAPL, 0x04, 0x0000, Pattern(999, 2999));
+		Unmount();
+
+		printf("many files: %zu files mounted in %.1f ms: %s\n", kManyFiles + 100 * 21, ms, res ? "FAILED" : "OK");
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int HostVolume_test(void)
+{
+	const testcommon::TestEmulator emulator(testcommon::CreateRegistry());
+
+	const std::filesystem::path temp = std::filesystem::temp_directory_path();
+	const std::filesystem::path root = temp / "testhostvolume";
+	const std::filesystem::path many = temp / "testhostvolume_many";
+	std::filesystem::remove_all(root);
+	std::filesystem::remove_all(many);
+
+	int res = 0;
+	res |= TestMount(root);
+	res |= TestWriteBack(root);
+	res |= TestManyFiles(many);
+
+	std::filesystem::remove_all(root);
+	std::filesystem::remove_all(many);
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = HostVolume_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
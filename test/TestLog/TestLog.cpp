@@ -0,0 +1,275 @@
+#include "StdAfx.h"
+
+#include "CPU.h"
+#include "DiskLog.h"
+#include "Log.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+// The asynchronous log: records from several threads end up complete and in order in the file, disabled categories
+// and levels are filtered out, the file is rotated. The cost on the emulation thread is timed for heavy disk logging
+// (LOG_DISK_TRACE, one record per nibble) against the old unbuffered fprintf.
+
+namespace
+{
+
+	const double kMaxDisabledNs = 20.0;	// a load and a branch
+
+	std::string LogFilename(void)
+	{
+		return (std::filesystem::temp_directory_path() / ("AppleWinTestLog." + std::to_string(getpid()) + ".log")).string();
+	}
+
+	void RemoveLogFiles(const std::string& filename)
+	{
+		std::error_code ec;
+		std::filesystem::remove(filename, ec);
+		for (int i = 1; i <= 3; i++)
+			std::filesystem::remove(filename + "." + std::to_string(i), ec);
+	}
+
+	std::vector<std::string> ReadLines(const std::string& filename)
+	{
+		std::vector<std::string> lines;
+		std::ifstream stream(filename);
+		std::string line;
+		while (std::getline(stream, line))
+			lines.push_back(line);
+		return lines;
+	}
+
+	// strip "seconds cycles category level "
+	std::string Message(const std::string& line, std::string& category)
+	{
+		std::istringstream stream(line);
+		std::string seconds, cycles, level;
+		stream >> seconds >> cycles >> category >> level;
+		std::string message;
+		std::getline(stream, message);
+		return message.empty() ? message : message.substr(1);
+	}
+
+	double Elapsed(const std::chrono::steady_clock::time_point& start)
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	int TestRecords(const std::string& filename)
+	{
+		int res = 0;
+
+		LogSetLevels("general=info,disk=debug,network=warning");
+		LogInit(filename.c_str());
+
+		g_nCumulativeCycles = 1234567;
+		const int count = 5000;
+		for (int i = 0; i < count; i++)
+		{
+			LOG_DISK("record %d\n", i);
+			LOG_DISK_TRACE("disabled %d\n", i);	// above debug
+			LOG_CATEGORY(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "disabled %d\n", i);	// above warning
+		}
+
+		LogFileOutput("partial ");
+		LogFileOutput("line\n");
+		const std::string longMessage(1000, 'x');	// several records
+		LogFileOutput("%s\n", longMessage.c_str());
+
+		LogFlush();
+
+		const std::vector<std::string> lines = ReadLines(filename);
+		int next = 0;
+		bool partial = false, longOk = false;
+		for (const std::string& line : lines)
+		{
+			std::string category;
+			const std::string message = Message(line, category);
+			if (line.find("disabled") != std::string::npos)
+			{
+				printf("records: disabled record logged: %s\n", line.c_str());
+				res = 1;
+			}
+			else if (category == "disk" && message == "record " + std::to_string(next))
+			{
+				if (line.find(" 1234567 ") == std::string::npos)
+				{
+					printf("records: no cycles: %s\n", line.c_str());
+					res = 1;
+				}
+				++next;
+			}
+			partial |= category == "general" && message == "partial line";
+			longOk |= category == "general" && message == longMessage;
+		}
+
+		if (next != count || !partial || !longOk || LogGetDroppedRecords())
+		{
+			printf("records: %d / %d in order, partial line: %d, long message: %d, dropped: %d\n", next, count, partial, longOk, (int)LogGetDroppedRecords());
+			res = 1;
+		}
+
+		LogDone();
+		RemoveLogFiles(filename);
+		return res;
+	}
+
+	int TestThreads(const std::string& filename)
+	{
+		LogSetLevels("all=info");
+		LogInit(filename.c_str());
+
+		const int threads = 4;
+		const int count = 2000;	// all fit in the ring: nothing dropped
+		std::vector<std::thread> producers;
+		for (int t = 0; t < threads; t++)
+		{
+			producers.emplace_back([t]() {
+				for (int i = 0; i < count; i++)
+					LOG_CATEGORY(LOG_CATEGORY_SERIAL, LOG_LEVEL_INFO, "thread %d record %d\n", t, i);
+			});
+		}
+		for (std::thread& producer : producers)
+			producer.join();
+
+		LogFlush();
+
+		std::vector<int> next(threads, 0);
+		for (const std::string& line : ReadLines(filename))
+		{
+			int t, i;
+			const size_t pos = line.find("thread ");
+			if (pos != std::string::npos && sscanf(line.c_str() + pos, "thread %d record %d", &t, &i) == 2 && t >= 0 && t < threads && i == next[t])
+				++next[t];
+		}
+
+		int res = 0;
+		for (int t = 0; t < threads; t++)
+		{
+			if (next[t] != count)
+			{
+				printf("threads: thread %d: %d / %d records in order\n", t, next[t], count);
+				res = 1;
+			}
+		}
+
+		LogDone();
+		RemoveLogFiles(filename);
+		return res;
+	}
+
+	int TestRotation(const std::string& filename)
+	{
+		LogSetLevels("all=info");
+		LogSetRotation(64 * 1024, 2);
+		LogInit(filename.c_str());
+
+		for (int i = 0; i < 2000; i++)
+		{
+			LogFileOutput("rotation record %d ........................................\n", i);
+			if (i % 500 == 0)
+				LogFlush();	// let the writer see the size grow
+		}
+		LogFlush();
+		LogDone();
+
+		int res = 0;
+		const std::vector<std::string> last = ReadLines(filename);
+		if (!std::filesystem::exists(filename + ".1") || !std::filesystem::exists(filename + ".2") || std::filesystem::exists(filename + ".3") ||
+			last.empty() || last[0].find("Logging continued") == std::string::npos ||
+			std::filesystem::file_size(filename + ".1") > 2 * 64 * 1024)
+		{
+			printf("rotation: files not rotated\n");
+			res = 1;
+		}
+
+		LogSetRotation(16 * 1024 * 1024, 3);
+		RemoveLogFiles(filename);
+		return res;
+	}
+
+	int TestBenchmark(const std::string& filename)
+	{
+		const int count = 10000;	// < ring size: no drops, this is the cost on the emulation thread
+		const int disabledCount = 10000000;
+
+		// old: synchronous and unbuffered
+		FILE* file = fopen(filename.c_str(), "wt");
+		setvbuf(file, NULL, _IONBF, 0);
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; i++)
+			fprintf(file, "read %04X = %02X\r\n", i & 0x1FFF, i & 0xFF);
+		const double syncNs = Elapsed(start) / count;
+		fclose(file);
+		RemoveLogFiles(filename);
+
+		LogSetLevels("disk=trace");
+		LogInit(filename.c_str());
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; i++)
+			LOG_DISK_TRACE("read %04X = %02X\r\n", i & 0x1FFF, i & 0xFF);
+		const double asyncNs = Elapsed(start) / count;
+		LogFlush();
+		LogDone();
+		RemoveLogFiles(filename);
+
+		LogSetLevels("disk=warning");
+		LogInit(filename.c_str());
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < disabledCount; i++)
+			LOG_DISK_TRACE("read %04X = %02X\r\n", i & 0x1FFF, i & 0xFF);
+		const double disabledNs = Elapsed(start) / disabledCount;
+		LogDone();
+		RemoveLogFiles(filename);
+
+		printf("disk nibble log: unbuffered fprintf %.0f ns, async %.0f ns, disabled %.2f ns (target %.0f)\n", syncNs, asyncNs, disabledNs, kMaxDisabledNs);
+
+		if (asyncNs > syncNs || disabledNs > kMaxDisabledNs)
+		{
+			printf("benchmark: too slow\n");
+			return 1;
+		}
+		return 0;
+	}
+
+}
+
+//-------------------------------------
+
+int Log_test(void)
+{
+	const std::string filename = LogFilename();
+
+	int res = 0;
+	res |= TestRecords(filename);
+	res |= TestThreads(filename);
+	res |= TestRotation(filename);
+	res |= TestBenchmark(filename);
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Log_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
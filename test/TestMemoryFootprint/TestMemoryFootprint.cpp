@@ -0,0 +1,275 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "frontends/common2/memoryreport.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "DiskImage.h"
+#include "Memory.h"
+#include "NTSC.h"
+#include "Registry.h"
+
+#include "zlib.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Memory footprint of an instance, as seen by --memory-report:
+// . a plain headless enhanced //e should stay under 10MB resident (only printed: it depends on the build, eg. sanitizers)
+// . an 8MB RamWorks III only costs the banks that the guest has written to
+// . a .dsk image is nibblized from the file a track at a time: no image buffer, same tracks as from a .gz (fully buffered)
+
+namespace
+{
+
+	const size_t kMaxResident = 10 * 1024 * 1024;
+	const UINT kAuxBanks = 128;	// 8MB
+	const UINT kFrames = 120;
+	const UINT kDskSize = 35 * 16 * 256;
+
+	void RunFrames(const UINT frames)
+	{
+		for (UINT i = 0; i < frames; i++)
+		{
+			UINT cycles = 0;
+			while (cycles < NTSC_GetCyclesPerFrame())
+			{
+				const UINT executed = CpuExecute(1000, true);
+				GetCardMgr().Update(executed);
+				g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executed) % NTSC_GetCyclesPerFrame();
+				cycles += executed;
+			}
+		}
+	}
+
+	const common2::MemoryReport::Block* FindBlock(const common2::MemoryReport& report, const std::string& name)
+	{
+		for (const common2::MemoryReport::Block& block : report.getBlocks())
+		{
+			if (block.name == name)
+				return &block;
+		}
+		return NULL;
+	}
+
+	int CheckReport(const common2::MemoryReport& report)
+	{
+		size_t privateBlocks = 0;
+		for (const common2::MemoryReport::Block& block : report.getBlocks())
+		{
+			if (block.resident > block.size)
+			{
+				printf("report: %s: resident > size\n", block.name.c_str());
+				return 1;
+			}
+			if (!block.fileBacked)
+				privateBlocks += block.resident;
+		}
+
+		if (privateBlocks + report.getOther() != report.getAnonymous() || report.getAnonymous() > report.getResident())
+		{
+			printf("report: blocks do not add up\n");
+			return 1;
+		}
+
+		return 0;
+	}
+
+	//-------------------------------------
+
+	int TestPlainIIe(void)
+	{
+		const testcommon::TestEmulator emulator(testcommon::CreateRegistry());
+		RunFrames(kFrames);
+
+		const common2::MemoryReport report;
+		report.print(std::cout);
+
+		int res = CheckReport(report);
+
+		const common2::MemoryReport::Block* pRGB = FindBlock(report, "RGB source image");
+		if (!pRGB || pRGB->size)
+		{
+			printf("plain //e: RGB source image allocated\n");
+			res = 1;
+		}
+
+		printf("plain //e: %" SIZE_T_FMT " kB resident (target %" SIZE_T_FMT " kB)\n", report.getResident() / 1024, kMaxResident / 1024);
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	int TestRamWorks(void)
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+		registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_CARD_TYPE, CT_RamWorksIII);
+		registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_AUX_NUM_BANKS, kAuxBanks);
+		const testcommon::TestEmulator emulator(registry);
+		RunFrames(kFrames);
+
+		int res = 0;
+
+		const common2::MemoryReport::Block* pBanks = FindBlock(common2::MemoryReport(), "RamWorks banks");
+		const size_t before = pBanks ? pBanks->resident : 0;
+		if (!pBanks || pBanks->size != (kAuxBanks - 1) * _6502_MEM_LEN || before > 4 * _6502_MEM_LEN)
+		{
+			printf("RamWorks: %" SIZE_T_FMT " kB resident before use\n", before / 1024);
+			res = 1;
+		}
+
+		// never written banks read as 0, then 1 byte per bank in 10 banks
+		bool zero = true;
+		for (UINT bank = 2; bank <= kAuxBanks; bank++)
+			zero = zero && MemGetBankPtr(bank, false)[0x1234] == 0;
+
+		for (UINT bank = 10; bank < 20; bank++)
+			MemGetBankPtr(bank, false)[0x8000] = (BYTE)bank;
+
+		const common2::MemoryReport report;
+		const size_t after = FindBlock(report, "RamWorks banks")->resident;
+		const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		if (!zero || after > before + 10 * pageSize || after < 10 * pageSize)
+		{
+			printf("RamWorks: %" SIZE_T_FMT " kB resident after writing to 10 banks\n", after / 1024);
+			res = 1;
+		}
+
+		printf("RamWorks: %u banks, %" SIZE_T_FMT " kB resident (%" SIZE_T_FMT " kB after writing to 10 banks)\n",
+			kAuxBanks, before / 1024, after / 1024);
+
+		res |= CheckReport(report);
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	std::vector<BYTE> Pattern(const int seed)
+	{
+		std::vector<BYTE> data(kDskSize);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = (BYTE)((i * 7 + seed) ^ (i >> 8));
+		return data;
+	}
+
+	ImageInfo* Open(const std::filesystem::path& path)
+	{
+		ImageInfo* pImage = NULL;
+		bool bWriteProtected = false;
+		std::string strFilenameInZip;
+		if (ImageOpen(path.string(), &pImage, &bWriteProtected, false, strFilenameInZip) != eIMAGE_ERROR_NONE)
+			return NULL;
+		return pImage;
+	}
+
+	std::vector<BYTE> ReadTrack(ImageInfo* pImage, const int track)
+	{
+		std::vector<BYTE> nibbles(NIBBLES_PER_TRACK);
+		int nNibbles = 0;
+		UINT bitCount = 0;
+		ImageReadTrack(pImage, (float)(track * 2), nibbles.data(), &nNibbles, &bitCount, false);
+		nibbles.resize(nNibbles);
+		return nibbles;
+	}
+
+	int TestDiskImage(void)
+	{
+		const std::filesystem::path temp = std::filesystem::temp_directory_path() / "testmemoryfootprint";
+		std::filesystem::remove_all(temp);
+		std::filesystem::create_directories(temp);
+
+		const std::vector<BYTE> data = Pattern(1);
+		{
+			std::ofstream file(temp / "a.dsk", std::ios::binary);
+			file.write((const char*)data.data(), data.size());
+			const std::vector<BYTE> other = Pattern(2);
+			std::ofstream otherFile(temp / "b.dsk", std::ios::binary);
+			otherFile.write((const char*)other.data(), other.size());
+		}
+		gzFile gz = gzopen((temp / "a.dsk.gz").string().c_str(), "wb");
+		gzwrite(gz, data.data(), data.size());
+		gzclose(gz);
+
+		int res = 0;
+
+		ImageInfo* pFile = Open(temp / "a.dsk");
+		ImageInfo* pOther = Open(temp / "b.dsk");
+		ImageInfo* pBuffered = Open(temp / "a.dsk.gz");
+		if (!pFile || !pOther || !pBuffered)
+		{
+			printf("disk: failed to open the images\n");
+			res = 1;
+		}
+		else
+		{
+			if (ImageGetImageBufferSize(pFile) != 0 || ImageGetImageBufferSize(pBuffered) != kDskSize)
+			{
+				printf("disk: image buffers %u (.dsk) and %u (.gz)\n", ImageGetImageBufferSize(pFile), ImageGetImageBufferSize(pBuffered));
+				res = 1;
+			}
+
+			for (int track = 0; track < 35; track++)
+			{
+				if (ReadTrack(pFile, track) != ReadTrack(pBuffered, track))
+				{
+					printf("disk: track %d differs\n", track);
+					res = 1;
+					break;
+				}
+			}
+
+			// a track written back is read back from the file
+			std::vector<BYTE> nibbles = ReadTrack(pOther, 17);
+			ImageWriteTrack(pFile, 17.0f * 2, nibbles.data(), (int)nibbles.size());
+			if (ReadTrack(pFile, 17) != nibbles || ReadTrack(pFile, 16) != ReadTrack(pBuffered, 16))
+			{
+				printf("disk: track written to the file\n");
+				res = 1;
+			}
+		}
+
+		ImageClose(pFile);
+		ImageClose(pOther);
+		ImageClose(pBuffered);
+
+		std::filesystem::remove_all(temp);
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int MemoryFootprint_test(void)
+{
+	int res = 0;
+	res |= TestPlainIIe();		// 1st: nothing else allocated yet
+	res |= TestRamWorks();
+	res |= TestDiskImage();
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = MemoryFootprint_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
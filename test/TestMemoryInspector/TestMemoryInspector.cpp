@@ -0,0 +1,275 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "frontends/common2/memoryinspector.h"
+
+#include "Card.h"
+#include "Core.h"
+#include "Memory.h"
+#include "Registry.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+// Memory inspector on a full 8MB RamWorks III: page change tracking, snapshot diff, masked search and the cheat finder.
+// The cheat finder's scans are timed, as they have to be fast enough to be interactive.
+
+namespace
+{
+
+	const UINT kAuxBanks = 128;	// 8MB
+	const size_t kBankSize = common2::MemoryInspector::BANK_SIZE;
+	const double kMaxSparseScanMs = 1.0;
+	const double kMaxFullScanMs = 50.0;	// every byte a candidate: memory bandwidth bound
+
+	BYTE& Byte(const size_t offset)
+	{
+		return MemGetBankPtr((UINT)(offset / kBankSize), false)[offset % kBankSize];
+	}
+
+	double Elapsed(const std::chrono::steady_clock::time_point& start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	int TestChanges(common2::MemoryInspector& inspector)
+	{
+		inspector.update();
+		const uint64_t first = inspector.getGeneration();
+
+		WriteByteToMemory(0x2345, ReadByteFromMemory(0x2345) + 1);	// via the 'mem' cache
+		const size_t aux = 100 * kBankSize + 0x8000;
+		Byte(aux) += 1;
+
+		const auto start = std::chrono::steady_clock::now();
+		inspector.update();
+		const double ms = Elapsed(start);
+
+		const uint64_t second = inspector.getGeneration();
+		if (second != first + 1 ||
+			inspector.getPageGeneration(0x2345) != second || inspector.getPageGeneration(aux) != second ||
+			inspector.getPageGeneration(0x2245) == second || inspector.getPageGeneration(aux + 0x100) == second)
+		{
+			printf("changes: page generations not updated\n");
+			return 1;
+		}
+
+		printf("changes: update %.3f ms\n", ms);
+		return 0;
+	}
+
+	int TestSnapshot(common2::MemoryInspector& inspector)
+	{
+		inspector.takeSnapshot();
+
+		const size_t bank50 = 50 * kBankSize + 0x3FFF;	// across 2 pages
+		for (size_t i = 0; i < 3; i++)
+			Byte(bank50 + i) ^= 0xFF;
+		WriteByteToMemory(0x0800, ReadByteFromMemory(0x0800) ^ 0x01);
+
+		const std::vector<common2::MemoryInspector::Range> ranges = inspector.diffSnapshot(100);
+		if (ranges.size() != 2 ||
+			ranges[0].begin != 0x0800 || ranges[0].end != 0x0801 ||
+			ranges[1].begin != bank50 || ranges[1].end != bank50 + 3 ||
+			inspector.readSnapshot(bank50) != (inspector.read(bank50) ^ 0xFF))
+		{
+			printf("snapshot: %" SIZE_T_FMT " ranges\n", ranges.size());
+			return 1;
+		}
+
+		return 0;
+	}
+
+	int TestSearch(common2::MemoryInspector& inspector)
+	{
+		const char text[] = "APPLEWIN";
+		const std::vector<uint8_t> pattern(text, text + 8);
+		const std::vector<size_t> expected = { 77 * kBankSize + 0x1234, 90 * kBankSize + 0x0800, kAuxBanks * kBankSize + kBankSize - 8 };
+
+		for (size_t i = 0; i < expected.size(); i++)
+			memcpy(&Byte(expected[i]), text, 8);
+
+		// not across banks
+		memcpy(&Byte(3 * kBankSize - 4), text, 8);
+
+		int res = 0;
+
+		const std::vector<uint8_t> exact(8, 0xFF);
+		if (inspector.search(pattern, exact, 100) != expected)
+		{
+			printf("search: exact\n");
+			res = 1;
+		}
+
+		std::vector<uint8_t> wildcards(exact);
+		wildcards[0] = wildcards[2] = 0x00;	// ?P?LEWIN
+		if (inspector.search(pattern, wildcards, 100) != expected)
+		{
+			printf("search: wildcards\n");
+			res = 1;
+		}
+
+		const char lower[] = "applewin";
+		const std::vector<uint8_t> caseless(8, 0xDF);	// no exact byte to anchor on
+		if (inspector.search(std::vector<uint8_t>(lower, lower + 8), caseless, 100) != expected)
+		{
+			printf("search: case insensitive\n");
+			res = 1;
+		}
+
+		if (inspector.search(pattern, exact, 2).size() != 2)
+		{
+			printf("search: max results\n");
+			res = 1;
+		}
+
+		std::vector<uint8_t> parsed, parsedMask;
+		if (!common2::MemoryInspector::parsePattern("41 ?0 50 4c 45 57 49 4?", parsed, parsedMask) ||
+			parsedMask != std::vector<uint8_t>({ 0xFF, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 }) ||
+			inspector.search(parsed, parsedMask, 100) != expected ||
+			!common2::MemoryInspector::parsePattern("\"applewin\"", parsed, parsedMask) ||	// lower case: no match
+			!inspector.search(parsed, parsedMask, 100).empty() ||
+			!common2::MemoryInspector::parsePattern("\"APPLEWIN\"", parsed, parsedMask) ||
+			inspector.search(parsed, parsedMask, 100) != expected ||
+			common2::MemoryInspector::parsePattern("4", parsed, parsedMask) ||
+			common2::MemoryInspector::parsePattern("4G", parsed, parsedMask))
+		{
+			printf("search: parsed patterns\n");
+			res = 1;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		inspector.search(pattern, wildcards, 100);
+		printf("search: %.3f ms\n", Elapsed(start));
+
+		return res;
+	}
+
+	int CheckCandidates(common2::MemoryInspector& inspector, const char* name, const std::set<size_t>& expected)
+	{
+		const std::vector<size_t> candidates = inspector.getCandidates(expected.size() + 1);
+		if (inspector.getNumberOfCandidates() != expected.size() || std::set<size_t>(candidates.begin(), candidates.end()) != expected)
+		{
+			printf("cheat finder: %s: %" SIZE_T_FMT " candidates instead of %" SIZE_T_FMT "\n", name, inspector.getNumberOfCandidates(), expected.size());
+			return 1;
+		}
+		return 0;
+	}
+
+	int TestCheatFinder(common2::MemoryInspector& inspector)
+	{
+		int res = 0;
+
+		// the counter (bank 3), a byte going down (bank 9), random increases everywhere
+		const size_t counter = 3 * kBankSize + 0x4000;
+		const size_t down = 9 * kBankSize + 0x0100;
+		Byte(counter) = 5;
+		Byte(down) = 9;
+
+		inspector.scanStart();
+		if (inspector.getNumberOfCandidates() != inspector.getSize())
+		{
+			printf("cheat finder: start\n");
+			res = 1;
+		}
+
+		std::mt19937 random(1234);
+		std::set<size_t> increased = { counter };
+		Byte(counter) = 6;
+		Byte(down) = 8;
+		for (UINT i = 0; i < 1000; i++)
+		{
+			const size_t offset = kBankSize + random() % (kAuxBanks * kBankSize);	// aux banks: not touched by the CPU
+			if (offset == down || Byte(offset) == 0xFF)
+				continue;
+			Byte(offset) += 1;
+			increased.insert(offset);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		inspector.scan(common2::MemoryInspector::Scan::Increased);
+		const double fullMs = Elapsed(start);
+		res |= CheckCandidates(inspector, "increased", increased);
+
+		Byte(counter) = 7;
+		start = std::chrono::steady_clock::now();
+		inspector.scan(common2::MemoryInspector::Scan::Changed);
+		const double sparseMs = Elapsed(start);
+		res |= CheckCandidates(inspector, "changed", { counter });
+
+		inspector.scan(common2::MemoryInspector::Scan::Equal, 7);
+		res |= CheckCandidates(inspector, "equal", { counter });
+		inspector.scan(common2::MemoryInspector::Scan::Unchanged);
+		res |= CheckCandidates(inspector, "unchanged", { counter });
+		inspector.scan(common2::MemoryInspector::Scan::NotEqual, 7);
+		res |= CheckCandidates(inspector, "not equal", {});
+
+		// from the start again: the one going down
+		inspector.scanStart();
+		Byte(down) = 7;
+		inspector.scan(common2::MemoryInspector::Scan::Decreased);
+		res |= CheckCandidates(inspector, "decreased", { down });
+
+		printf("cheat finder: %" SIZE_T_FMT " bytes, full scan %.3f ms (target %.0f), narrowed scan %.3f ms (target %.0f)\n",
+			inspector.getSize(), fullMs, kMaxFullScanMs, sparseMs, kMaxSparseScanMs);
+
+		if (fullMs > kMaxFullScanMs || sparseMs > kMaxSparseScanMs)
+		{
+			printf("cheat finder: too slow\n");
+			res = 1;
+		}
+
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int MemoryInspector_test(void)
+{
+	const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+	registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_CARD_TYPE, CT_RamWorksIII);
+	registry->putDWord(RegGetConfigSlotSection(SLOT_AUX), REGVALUE_AUX_NUM_BANKS, kAuxBanks);
+	const testcommon::TestEmulator emulator(registry);
+
+	int res = 0;
+
+	common2::MemoryInspector inspector;
+	if (inspector.getNumberOfBanks() != 1 + kAuxBanks)
+	{
+		printf("%" SIZE_T_FMT " banks\n", inspector.getNumberOfBanks());
+		res = 1;
+	}
+	else
+	{
+		res |= TestChanges(inspector);
+		res |= TestSnapshot(inspector);
+		res |= TestSearch(inspector);
+		res |= TestCheatFinder(inspector);
+	}
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = MemoryInspector_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -0,0 +1,372 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "NTSC.h"
+#include "MouseInterface.h"
+#include "Registry.h"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+// AppleMouse card in slot 4 of an enhanced //e.
+// . firmware fast path: a script of INITMOUSE, SETMOUSE, POSMOUSE, CLAMPMOUSE & READMOUSE calls must leave the same
+//   screen holes, registers and card state as the real firmware, in a fraction of the cycles
+// . high rate input: a guest program logs the position & buttons read at each VBL, while a scripted 1kHz trajectory is
+//   fed at a 30Hz host frame rate (2 VBLs per host frame). The moves must be spread over both VBLs.
+
+namespace
+{
+
+	const UINT kSlot = 4;
+	const BYTE kCn = 0xC0 + kSlot;
+	const WORD kProgramAddr = 0x0300;
+	const WORD kLogX = 0x4000;	// lo, hi at +$100
+	const WORD kLogStatus = 0x4200;
+	const BYTE kLogCount = 0xFA;
+	const UINT kLogs = 256;
+
+	const UINT kHostFrameCycles = 2 * 17030;	// 30Hz host
+	const UINT kTrajectoryMs = 1000;
+	const UINT kButtonMs = 600;
+
+	enum FirmwareEntry { SETMOUSE = 0x12, SERVEMOUSE, READMOUSE, CLEARMOUSE, POSMOUSE, CLAMPMOUSE, HOMEMOUSE, INITMOUSE };
+
+	// As the frame's execution loop, with the video scanner updated ($C019)
+	UINT Execute(const UINT cycles)
+	{
+		const UINT executed = CpuExecute(cycles, true);
+		GetCardMgr().Update(executed);
+		g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executed) % NTSC_GetCyclesPerFrame();
+		return executed;
+	}
+
+	WORD Entry(const FirmwareEntry entry)
+	{
+		return (WORD)((kCn << 8) | ReadByteFromMemory((kCn << 8) | entry));
+	}
+
+	void Load(const std::vector<BYTE>& program)
+	{
+		for (size_t i = 0; i < program.size(); i++)
+			WriteByteToMemory((WORD)(kProgramAddr + i), program[i]);
+		regs.pc = kProgramAddr;
+	}
+
+	// LDX #$Cn : LDY #$n0 : JSR entry
+	void AppendCall(std::vector<BYTE>& program, const FirmwareEntry entry)
+	{
+		const WORD address = Entry(entry);
+		const BYTE call[] = { 0xA2, kCn, 0xA0, (BYTE)(kSlot << 4), 0x20, (BYTE)(address & 0xFF), (BYTE)(address >> 8) };
+		program.insert(program.end(), call, call + sizeof(call));
+	}
+
+	// Single steps, returns the cycles
+	UINT Call(const FirmwareEntry entry, const BYTE a)
+	{
+		std::vector<BYTE> program = { 0xA9, a };	// LDA #a
+		AppendCall(program, entry);
+		const WORD done = (WORD)(kProgramAddr + program.size());
+		program.insert(program.end(), { 0x4C, (BYTE)(done & 0xFF), (BYTE)(done >> 8) });	// JMP *
+		Load(program);
+
+		UINT cycles = 0;
+		while (regs.pc != done && cycles < 1000000)
+			cycles += Execute(0);
+		return cycles;
+	}
+
+	void SetScreenHoles(const WORD base, const int x, const int y)
+	{
+		WriteByteToMemory(0x0478 + base, x & 0xFF);
+		WriteByteToMemory(0x0578 + base, (x >> 8) & 0xFF);
+		WriteByteToMemory(0x04F8 + base, y & 0xFF);
+		WriteByteToMemory(0x05F8 + base, (y >> 8) & 0xFF);
+	}
+
+	// Screen holes (slot & slot independent), registers and the card's position & clamps
+	void Record(std::vector<int>& trace, CMouseInterface* mouse)
+	{
+		for (WORD hole = 0x0478; hole < 0x0800; hole += 0x80)
+		{
+			trace.push_back(ReadByteFromMemory(hole));
+			trace.push_back(ReadByteFromMemory(hole + kSlot));
+		}
+		trace.push_back(regs.ps);
+		trace.push_back(regs.a);
+		trace.push_back(regs.x);
+		trace.push_back(regs.y);
+
+		int x, minX, maxX, y, minY, maxY;
+		mouse->GetXY(x, minX, maxX, y, minY, maxY);
+		trace.insert(trace.end(), { x, minX, maxX, y, minY, maxY });
+	}
+
+	std::shared_ptr<common2::PTreeRegistry> CreateRegistry(void)
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+		registry->putDWord(RegGetConfigSlotSection(kSlot), REGVALUE_CARD_TYPE, CT_MouseInterface);
+		return registry;
+	}
+
+	int RunScript(const bool fastPath, std::vector<int>& trace, UINT& readCycles)
+	{
+		const testcommon::TestEmulator emulator(CreateRegistry());
+
+		// as --no-mouse-fast-path: for the card re-created by a restart too
+		CMouseInterface::SetFirmwareFastPathDefault(fastPath);
+		emulator.GetFrame().Restart();
+		CMouseInterface* mouse = GetCardMgr().GetMouseCard();
+		if (mouse->GetFirmwareFastPath() != fastPath)
+		{
+			printf("fast path: not kept over a restart\n");
+			return 1;
+		}
+
+		Call(INITMOUSE, 0);
+		Call(SETMOUSE, 0x01);
+		Record(trace, mouse);
+
+		SetScreenHoles(kSlot, 300, 100);
+		Call(POSMOUSE, 0);
+		Record(trace, mouse);
+
+		readCycles = Call(READMOUSE, 0);
+		Record(trace, mouse);
+
+		SetScreenHoles(0, 10, 500);		// min, max
+		Call(CLAMPMOUSE, 0);
+		Record(trace, mouse);
+		SetScreenHoles(0, 20, 150);
+		Call(CLAMPMOUSE, 1);
+		Record(trace, mouse);
+
+		int outOfBoundsX, outOfBoundsY;
+		mouse->SetPositionRel(1000, -1000, &outOfBoundsX, &outOfBoundsY);
+		Call(READMOUSE, 0);
+		Record(trace, mouse);
+
+		mouse->SetButton(BUTTON0, BUTTON_DOWN);
+		Call(READMOUSE, 0);
+		Record(trace, mouse);
+		mouse->SetButton(BUTTON0, BUTTON_UP);
+		mouse->SetPositionRel(-7, 5, &outOfBoundsX, &outOfBoundsY);
+		Call(READMOUSE, 0);
+		Record(trace, mouse);
+		Call(READMOUSE, 0);
+		Record(trace, mouse);
+
+		SetScreenHoles(kSlot, 5, 7);	// outside the clamps
+		Call(POSMOUSE, 0);
+		Call(READMOUSE, 0);
+		Record(trace, mouse);
+
+		return 0;
+	}
+
+	int TestFirmwareFastPath(void)
+	{
+		std::vector<int> firmware, fastPath;
+		UINT firmwareCycles, fastPathCycles;
+		if (RunScript(false, firmware, firmwareCycles) || RunScript(true, fastPath, fastPathCycles))
+			return 1;
+
+		printf("READMOUSE: firmware %u cycles, fast path %u cycles\n", firmwareCycles, fastPathCycles);
+
+		if (firmware != fastPath)
+		{
+			for (size_t i = 0; i < firmware.size() && i < fastPath.size(); i++)
+			{
+				if (firmware[i] != fastPath[i])
+				{
+					printf("fast path: trace differs at %d (record %d): firmware %d, fast path %d\n",
+						(int)i, (int)(i / 26), firmware[i], fastPath[i]);
+				}
+			}
+			return 1;
+		}
+
+		if (fastPathCycles * 4 > firmwareCycles)
+		{
+			printf("fast path: too slow\n");
+			return 1;
+		}
+
+		return 0;
+	}
+
+	// Log X & status at each VBL, kLogs times
+	std::vector<BYTE> LoggerProgram(WORD& done)
+	{
+		std::vector<BYTE> program;
+		AppendCall(program, INITMOUSE);
+		program.insert(program.end(), { 0xA9, 0x01 });	// LDA #1
+		AppendCall(program, SETMOUSE);
+		program.insert(program.end(), { 0xA9, 0x00, 0x85, kLogCount });	// LDA #0 : STA count
+
+		const WORD loop = (WORD)(kProgramAddr + program.size());
+		program.insert(program.end(), {
+			0xAD, 0x19, 0xC0, 0x10, 0xFB,		// LDA RDVBLBAR : BPL * (wait for the end of VBL)
+			0xAD, 0x19, 0xC0, 0x30, 0xFB,		// LDA RDVBLBAR : BMI * (wait for VBL)
+		});
+		AppendCall(program, READMOUSE);
+		program.insert(program.end(), {
+			0xA4, kLogCount,												// LDY count
+			0xAD, 0x78 + kSlot, 0x04, 0x99, kLogX & 0xFF, kLogX >> 8,			// LDA X lo : STA logX,Y
+			0xAD, 0x78 + kSlot, 0x05, 0x99, kLogX & 0xFF, (kLogX >> 8) + 1,	// LDA X hi : STA logX+$100,Y
+			0xAD, 0x78 + kSlot, 0x07, 0x99, kLogStatus & 0xFF, kLogStatus >> 8,	// LDA status : STA logStatus,Y
+			0xE6, kLogCount,												// INC count
+			0xF0, 0x03,														// BEQ done
+			0x4C, (BYTE)(loop & 0xFF), (BYTE)(loop >> 8),					// JMP loop
+		});
+		done = (WORD)(kProgramAddr + program.size());
+		program.insert(program.end(), { 0x4C, (BYTE)(done & 0xFF), (BYTE)(done >> 8) });	// done: JMP *
+		return program;
+	}
+
+	// Returns the positions logged, and the 1st logged position with the button down
+	int RunTrajectory(const bool queued, std::vector<int>& positions, int& buttonX)
+	{
+		const testcommon::TestEmulator emulator(CreateRegistry());
+
+		CMouseInterface* mouse = GetCardMgr().GetMouseCard();
+
+		WORD done;
+		Load(LoggerProgram(done));
+		Execute(kHostFrameCycles);	// init, and sync to VBL
+
+		// 1 move per ms: +1 in X, the button goes down at kButtonMs
+		const double hostFrame = kHostFrameCycles / g_fCurrentCLK6502;
+		UINT ms = 0;
+		for (UINT frameCount = 1; regs.pc != done && frameCount < 1000; frameCount++)
+		{
+			// the host frame's events, delivered before running the next one
+			long dx = 0;
+			bool button = false;
+			for (; ms < kTrajectoryMs && ms / 1000.0 < frameCount * hostFrame; ms++)
+			{
+				if (queued)
+				{
+					mouse->QueuePositionRel(1, 0, ms / 1000.0);
+					if (ms == kButtonMs)
+						mouse->QueueButton(BUTTON0, BUTTON_DOWN, ms / 1000.0);
+				}
+				else
+				{
+					dx++;
+					button |= ms == kButtonMs;
+				}
+			}
+			if (!queued)
+			{
+				int outOfBoundsX, outOfBoundsY;
+				mouse->SetPositionRel(dx, 0, &outOfBoundsX, &outOfBoundsY);
+				if (button)
+					mouse->SetButton(BUTTON0, BUTTON_DOWN);
+			}
+
+			Execute(kHostFrameCycles);
+		}
+
+		const bool completed = regs.pc == done;
+		buttonX = -1;
+		for (UINT i = 0; i < kLogs; i++)
+		{
+			const int x = ReadByteFromMemory(kLogX + i) | (ReadByteFromMemory(kLogX + 0x100 + i) << 8);
+			positions.push_back(x);
+			if (buttonX < 0 && (ReadByteFromMemory(kLogStatus + i) & 0x80))
+				buttonX = x;
+		}
+
+		if (!completed)
+		{
+			printf("trajectory: the guest didn't log %u positions\n", kLogs);
+			return 1;
+		}
+		return 0;
+	}
+
+	void Steps(const std::vector<int>& positions, int& minStep, int& maxStep)
+	{
+		minStep = INT_MAX;
+		maxStep = 0;
+		// while moving: from the 1st move to the button press (the moves queued behind it are delivered 1 VBL later)
+		for (size_t i = 1; i < positions.size(); i++)
+		{
+			if (positions[i - 1] == 0 || positions[i] > (int)kButtonMs)
+				continue;
+			minStep = std::min(minStep, positions[i] - positions[i - 1]);
+			maxStep = std::max(maxStep, positions[i] - positions[i - 1]);
+		}
+	}
+
+	int TestHighRateInput(void)
+	{
+		int res = 0;
+
+		std::vector<int> frames, queued;
+		int framesButtonX, queuedButtonX;
+		res |= RunTrajectory(false, frames, framesButtonX);
+		res |= RunTrajectory(true, queued, queuedButtonX);
+		if (res)
+			return res;
+
+		int framesMin, framesMax, queuedMin, queuedMax;
+		Steps(frames, framesMin, framesMax);
+		Steps(queued, queuedMin, queuedMax);
+
+		printf("trajectory: X step per VBL: per host frame %d..%d (button at X=%d), queued %d..%d (button at X=%d, pressed at %u)\n",
+			framesMin, framesMax, framesButtonX, queuedMin, queuedMax, queuedButtonX, kButtonMs);
+
+		// 1ms per move: 16 or 17 per VBL at 59.94Hz
+		if (queuedMin < 16 || queuedMax > 17 || queued.back() != (int)kTrajectoryMs)
+		{
+			printf("trajectory: queued moves not spread over the VBLs\n");
+			res = 1;
+		}
+
+		// seen at the VBL following the press, where it happened
+		if (queuedButtonX < (int)kButtonMs - 17 || queuedButtonX > (int)kButtonMs + 1)
+		{
+			printf("trajectory: button not seen where it was pressed\n");
+			res = 1;
+		}
+
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int Mouse_test(void)
+{
+	int res = 0;
+	res |= TestFirmwareFastPath();
+	res |= TestHighRateInput();
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Mouse_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
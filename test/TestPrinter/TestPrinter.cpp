@@ -0,0 +1,479 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "DotMatrixPrinter.h"
+#include "Memory.h"
+#include "ParallelPrinter.h"
+#include "Registry.h"
+
+#include "zlib.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Print jobs as Apple II software sends them (hi-res screen dumps, word processor text, Print Shop style graphics)
+// through the parallel card, polling the status like a print driver. The saved pages must match the interpreter's
+// bitmaps, the graphics are checked dot by dot against their source and the text pages against golden CRCs.
+
+namespace
+{
+
+	const WORD kProgramAddr = 0x0300;
+	const WORD kDoneAddr = 0x0325;
+	const WORD kDataAddr = 0x2000;
+	const WORD kMaxData = 0x7000;
+	const UINT kChunk = 10000;
+	const UINT kMaxCycles = 20000000;
+
+	const BYTE ESC = 0x1B;
+
+	// Send [$2000, ($FD)) to the printer in slot 1, waiting for BUSY to clear after each byte ($FA != 0 if it was seen)
+	const BYTE kProgram[] =
+	{
+		0xA2, 0x01,			// 0300: LDX #1
+		0xA0, 0x00,			// 0302: LDY #0
+		0xB1, 0xFB,			// 0304: loop: LDA ($FB),Y
+		0x8D, 0x90, 0xC0,	// 0306: STA $C090
+		0xAD, 0x91, 0xC0,	// 0309: wait: LDA $C091
+		0x10, 0x05,			// 030C: BPL ready
+		0x86, 0xFA,			// 030E: STX $FA
+		0x4C, 0x09, 0x03,	// 0310: JMP wait
+		0xE6, 0xFB,			// 0313: ready: INC $FB
+		0xD0, 0x02,			// 0315: BNE +2
+		0xE6, 0xFC,			// 0317: INC $FC
+		0xA5, 0xFB,			// 0319: LDA $FB
+		0xC5, 0xFD,			// 031B: CMP $FD
+		0xD0, 0xE5,			// 031D: BNE loop
+		0xA5, 0xFC,			// 031F: LDA $FC
+		0xC5, 0xFE,			// 0321: CMP $FE
+		0xD0, 0xDF,			// 0323: BNE loop
+		0x4C, 0x25, 0x03,	// 0325: done: JMP done
+	};
+
+	struct PrintJob
+	{
+		const char* name;
+		ParallelPrinterCard::PrinterEmulation_e emulation;
+		ParallelPrinterCard::PrinterPageFormat_e format;
+		std::vector<BYTE> data;
+		UINT pages;
+		std::vector<uint32_t> crcs;	// golden, empty: not checked
+	};
+
+	//-------------------------------------
+
+	// 280x192 1-bit test image: diagonals, a frame & a checkerboard block
+	bool Pattern(const UINT x, const UINT y)
+	{
+		if (x == 0 || y == 0 || x == 279 || y == 191)
+			return true;
+		if (x >= 100 && x < 180 && y >= 60 && y < 132)
+			return ((x / 4) + (y / 4)) & 1;
+		return ((x + y) % 23) == 0 || ((x + 2 * (191 - y)) % 37) == 0;
+	}
+
+	// Epson hi-res dump: ESC A 8 (8/72" line feed = the 8 pins), then for each band: ESC K 280 columns (MSB = top), CR
+	std::vector<BYTE> EpsonScreenDump(void)
+	{
+		std::vector<BYTE> data = { ESC, '@', ESC, 'A', 8 };
+		for (UINT band = 0; band < 192 / 8; band++)
+		{
+			data.insert(data.end(), { ESC, 'K', 280 & 0xFF, 280 >> 8 });
+			for (UINT x = 0; x < 280; x++)
+			{
+				BYTE column = 0;
+				for (UINT pin = 0; pin < 8; pin++)
+					column |= Pattern(x, band * 8 + pin) ? (0x80 >> pin) : 0;
+				data.push_back(column);
+			}
+			data.push_back(0x0D);
+		}
+		data.push_back(0x0C);
+		return data;
+	}
+
+	// ImageWriter graphics, like Print Shop: 72 dpi (ESC n), 16/144" line feed (ESC T16), ESC G0280 (LSB = top), CR LF
+	std::vector<BYTE> ImageWriterGraphics(void)
+	{
+		std::vector<BYTE> data = { ESC, 'n', ESC, 'T', '1', '6' };
+		for (UINT band = 0; band < 192 / 8; band++)
+		{
+			data.insert(data.end(), { ESC, 'G', '0', '2', '8', '0' });
+			for (UINT x = 0; x < 280; x++)
+			{
+				BYTE column = 0;
+				for (UINT pin = 0; pin < 8; pin++)
+					column |= Pattern(x, band * 8 + pin) ? (1 << pin) : 0;
+				data.push_back(column);
+			}
+			data.insert(data.end(), { 0x0D, 0x0A });
+		}
+		data.push_back(0x0C);
+		return data;
+	}
+
+	void AddText(std::vector<BYTE>& data, const std::string& text, const bool highBit = true)
+	{
+		for (size_t i = 0; i < text.size(); i++)
+			data.push_back(highBit ? (text[i] | 0x80) : text[i]);
+	}
+
+	// Word processor output: styles, CR line endings (Apple II text has the high bit set), 70 lines -> 2 pages
+	std::vector<BYTE> EpsonText(void)
+	{
+		std::vector<BYTE> data = { ESC, '@' };
+		data.insert(data.end(), { ESC, 'E' });
+		AddText(data, "QUARTERLY REPORT");
+		data.insert(data.end(), { ESC, 'F', 0x0D, 0x0D });
+		data.insert(data.end(), { 0x0E });
+		AddText(data, "Wide");
+		data.insert(data.end(), { 0x0D, ESC, '-', 1 });
+		AddText(data, "underlined");
+		data.insert(data.end(), { ESC, '-', 0, 0x09 });
+		AddText(data, "tab");
+		data.insert(data.end(), { 0x0D, 0x0F });
+		AddText(data, "condensed text, 17 characters per inch");
+		data.insert(data.end(), { 0x12, 0x0D });
+		for (UINT line = 5; line <= 70; line++)
+		{
+			AddText(data, "Line " + std::to_string(line) + ": the quick brown fox jumps over the lazy dog");
+			data.push_back(0x0D);
+		}
+		data.push_back(0x0C);
+		return data;
+	}
+
+	std::vector<BYTE> ImageWriterText(void)
+	{
+		std::vector<BYTE> data = { ESC, 'c', ESC, 'N' };
+		data.insert(data.end(), { ESC, '!' });
+		AddText(data, "Dear Sir,", false);
+		data.insert(data.end(), { ESC, '"', 0x0D, 0x0A, 0x0D, 0x0A });	// CR LF: a single line feed each
+		data.insert(data.end(), { ESC, 'X' });
+		AddText(data, "Elite", false);
+		data.insert(data.end(), { ESC, 'Y', ESC, 'E', ' ' });
+		AddText(data, "12 cpi, then ", false);
+		data.insert(data.end(), { ESC, 'q' });
+		AddText(data, "condensed", false);
+		data.insert(data.end(), { 0x0D, ESC, 'N', 0x0E });
+		AddText(data, "DOUBLE", false);
+		data.insert(data.end(), { 0x0F, 0x1F, '3' });	// 3 line feeds
+		AddText(data, "Yours faithfully", false);
+		data.push_back(0x0D);
+		return data;	// no FF: ejected when the job goes idle
+	}
+
+	//-------------------------------------
+
+	bool ReadFile(const std::filesystem::path& path, std::vector<BYTE>& data)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	// the saved pixels must be the page's
+	bool CheckPBM(const std::filesystem::path& path, const PrinterPage& page)
+	{
+		std::vector<BYTE> data;
+		if (!ReadFile(path, data))
+			return false;
+
+		const std::string header = "P4\n" + std::to_string(page.GetWidth()) + " " + std::to_string(page.GetHeight()) + "\n";
+		const UINT pitch = (page.GetWidth() + 7) / 8;
+		if (data.size() != header.size() + pitch * page.GetHeight() || memcmp(data.data(), header.data(), header.size()))
+			return false;
+
+		for (UINT y = 0; y < page.GetHeight(); y++)
+		{
+			for (UINT x = 0; x < page.GetWidth(); x++)
+			{
+				const bool dot = (data[header.size() + y * pitch + x / 8] & (0x80 >> (x & 7))) != 0;
+				if (dot != page.GetPixel(x, y))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	UINT GetBE32(const BYTE* p)
+	{
+		return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	}
+
+	bool CheckPNG(const std::filesystem::path& path, const PrinterPage& page)
+	{
+		std::vector<BYTE> data;
+		if (!ReadFile(path, data))
+			return false;
+
+		const BYTE signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		if (data.size() < 8 || memcmp(data.data(), signature, sizeof(signature)))
+			return false;
+
+		std::vector<BYTE> idat;
+		UINT width = 0, height = 0;
+		for (size_t pos = 8; pos + 12 <= data.size(); )
+		{
+			const UINT length = GetBE32(&data[pos]);
+			if (pos + 12 + length > data.size())
+				return false;
+			const BYTE* type = &data[pos + 4];
+			const BYTE* chunk = &data[pos + 8];
+			if (crc32(crc32(0, type, 4), chunk, length) != GetBE32(chunk + length))
+				return false;
+			if (!memcmp(type, "IHDR", 4))
+			{
+				width = GetBE32(chunk);
+				height = GetBE32(chunk + 4);
+				if (chunk[8] != 1 || chunk[9] != 0)
+					return false;
+			}
+			else if (!memcmp(type, "IDAT", 4))
+			{
+				idat.insert(idat.end(), chunk, chunk + length);
+			}
+			pos += 12 + length;
+		}
+
+		if (width != page.GetWidth() || height != page.GetHeight())
+			return false;
+
+		const UINT pitch = (width + 7) / 8;
+		std::vector<BYTE> raw((pitch + 1) * height);
+		uLongf rawLength = (uLongf)raw.size();
+		if (uncompress(raw.data(), &rawLength, idat.data(), (uLong)idat.size()) != Z_OK || rawLength != raw.size())
+			return false;
+
+		for (UINT y = 0; y < height; y++)
+		{
+			if (raw[y * (pitch + 1)] != 0)
+				return false;
+			for (UINT x = 0; x < width; x++)
+			{
+				const bool dot = (raw[y * (pitch + 1) + 1 + x / 8] & (0x80 >> (x & 7))) == 0;	// 0 = black
+				if (dot != page.GetPixel(x, y))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// every dot of the source image, at the graphics density & 1/72" pins
+	int CheckGraphics(const char* name, const PrinterPage& page, const double step)
+	{
+		const UINT offset = DotMatrixPrinter::PIN_PITCH / 2;
+		for (UINT y = 0; y < 192; y++)
+		{
+			for (UINT x = 0; x < 280; x++)
+			{
+				const UINT px = (UINT)(x * step + 0.5) + offset;
+				const UINT py = y * DotMatrixPrinter::PIN_PITCH + offset;
+				if (page.GetPixel(px, py) != Pattern(x, y))
+				{
+					printf("%s: dot (%u,%u) is %s\n", name, x, y, Pattern(x, y) ? "missing" : "unexpected");
+					return 1;
+				}
+			}
+		}
+		return 0;
+	}
+
+	//-------------------------------------
+
+	// the printer's files go to dir
+	int PrintOnEmulator(const PrintJob& job, const std::filesystem::path& dir, std::vector<PrinterPage>& pages)
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+		registry->putDWord(RegGetConfigSlotSection(SLOT1), REGVALUE_CARD_TYPE, CT_GenericPrinter);
+		registry->putString(RegGetConfigSlotSection(SLOT1), REGVALUE_PRINTER_FILENAME, (dir / "Printer.txt").string());
+		registry->putDWord(RegGetConfigSlotSection(SLOT1), REGVALUE_PRINTER_EMULATION, job.emulation);
+		registry->putDWord(RegGetConfigSlotSection(SLOT1), REGVALUE_PRINTER_PAGE_FORMAT, job.format);
+		const testcommon::TestEmulator emulator(registry);
+
+		ParallelPrinterCard* card = GetCardMgr().GetParallelPrinterCard();
+		if (!card || card->GetEmulation() != job.emulation)
+		{
+			printf("%s: printer card not configured\n", job.name);
+			return 1;
+		}
+
+		// the interpreter on its own, for the reference pages
+		if (job.emulation != ParallelPrinterCard::PRINTER_EMULATION_TEXT)
+		{
+			DotMatrixPrinter printer(job.emulation == ParallelPrinterCard::PRINTER_EMULATION_EPSON ? DotMatrixPrinter::EMULATION_EPSON : DotMatrixPrinter::EMULATION_IMAGEWRITER);
+			for (size_t i = 0; i < job.data.size(); i++)
+				printer.Write(job.data[i]);
+			printer.FormFeed();
+			pages = printer.TakeEjectedPages();
+		}
+
+		_ASSERT(job.data.size() <= kMaxData);
+		for (UINT i = 0; i < sizeof(kProgram); i++)
+			WriteByteToMemory(kProgramAddr + i, kProgram[i]);
+		for (UINT i = 0; i < job.data.size(); i++)
+			WriteByteToMemory(kDataAddr + i, job.data[i]);
+		const WORD end = (WORD)(kDataAddr + job.data.size());
+		WriteByteToMemory(0xFA, 0);
+		WriteByteToMemory(0xFB, kDataAddr & 0xFF);
+		WriteByteToMemory(0xFC, kDataAddr >> 8);
+		WriteByteToMemory(0xFD, end & 0xFF);
+		WriteByteToMemory(0xFE, end >> 8);
+		regs.pc = kProgramAddr;
+
+		UINT cycles = 0;
+		while (cycles < kMaxCycles && regs.pc != kDoneAddr)
+		{
+			const UINT executed = CpuExecute(kChunk, false);
+			GetCardMgr().Update(executed);	// as the frontends do once per chunk
+			cycles += executed;
+		}
+
+		int res = 0;
+
+		if (regs.pc != kDoneAddr)
+		{
+			printf("%s: didn't complete (the driver is spinning on BUSY)\n", job.name);
+			res = 1;
+		}
+		if (ReadByteFromMemory(0xFA) == 0)
+		{
+			printf("%s: BUSY was never seen\n", job.name);
+			res = 1;
+		}
+
+		const std::filesystem::path textFile = dir / "Printer.txt";
+		if (job.emulation == ParallelPrinterCard::PRINTER_EMULATION_TEXT)
+		{
+			// buffered until the printer is idle
+			if (std::filesystem::exists(textFile) && std::filesystem::file_size(textFile) > 0)
+			{
+				printf("%s: written before going idle\n", job.name);
+				res = 1;
+			}
+			GetCardMgr().Update(200000);	// ~0.2s
+
+			std::vector<BYTE> written;
+			std::vector<BYTE> expected;
+			for (size_t i = 0; i < job.data.size(); i++)
+				expected.push_back(job.data[i] & 0x7F);
+			if (!ReadFile(textFile, written) || written != expected)
+			{
+				printf("%s: %" SIZE_T_FMT " bytes written instead of %" SIZE_T_FMT "\n", job.name, written.size(), expected.size());
+				res = 1;
+			}
+		}
+		else
+		{
+			GetCardMgr().Update(card->GetIdleLimit() * 1000000);	// end of the job: the last page is ejected
+
+			if (std::filesystem::exists(textFile) || card->GetPagesSaved() != pages.size() || pages.size() != job.pages)
+			{
+				printf("%s: %" SIZE_T_FMT " pages, %u saved\n", job.name, pages.size(), card->GetPagesSaved());
+				res = 1;
+			}
+
+			for (UINT i = 0; i < card->GetPagesSaved() && i < pages.size(); i++)
+			{
+				const std::filesystem::path pageFile = card->GetPageFilename(i + 1);
+				const bool bRes = (job.format == ParallelPrinterCard::PRINTER_PAGE_PBM) ? CheckPBM(pageFile, pages[i]) : CheckPNG(pageFile, pages[i]);
+				if (!bRes)
+				{
+					printf("%s: %s doesn't match the page\n", job.name, pageFile.string().c_str());
+					res = 1;
+				}
+
+				if (!job.crcs.empty() && (i >= job.crcs.size() || pages[i].GetCRC() != job.crcs[i]))
+				{
+					printf("%s: page %u CRC 0x%08X\n", job.name, i + 1, pages[i].GetCRC());
+					res = 1;
+				}
+			}
+		}
+
+		printf("%s: %" SIZE_T_FMT " bytes, %u cycles, %" SIZE_T_FMT " pages: %s\n", job.name, job.data.size(), cycles, pages.size(), res ? "FAILED" : "OK");
+		return res;
+	}
+
+	int RunPrintJob(const PrintJob& job, std::vector<PrinterPage>& pages)
+	{
+		const std::filesystem::path dir = std::filesystem::temp_directory_path() / "testprinter";
+		std::error_code ec;
+		std::filesystem::remove_all(dir, ec);
+		std::filesystem::create_directories(dir);
+
+		const int res = PrintOnEmulator(job, dir, pages);	// End(): the files are closed
+
+		std::filesystem::remove_all(dir, ec);
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int Printer_test(void)
+{
+	int res = 0;
+	std::vector<PrinterPage> pages;
+
+	{
+		PrintJob job = { "Text", ParallelPrinterCard::PRINTER_EMULATION_TEXT, ParallelPrinterCard::PRINTER_PAGE_PNG, {}, 0, {} };
+		AddText(job.data, "HELLO, WORLD\r10 PRINT \"HI\"\r");
+		res |= RunPrintJob(job, pages);
+	}
+
+	{
+		const PrintJob job = { "Epson screen dump", ParallelPrinterCard::PRINTER_EMULATION_EPSON, ParallelPrinterCard::PRINTER_PAGE_PNG, EpsonScreenDump(), 1, {} };
+		res |= RunPrintJob(job, pages);
+		if (!pages.empty())
+			res |= CheckGraphics(job.name, pages[0], DotMatrixPrinter::DPI / 60.0);
+	}
+
+	{
+		const PrintJob job = { "ImageWriter graphics", ParallelPrinterCard::PRINTER_EMULATION_IMAGEWRITER, ParallelPrinterCard::PRINTER_PAGE_PBM, ImageWriterGraphics(), 1, {} };
+		res |= RunPrintJob(job, pages);
+		if (!pages.empty())
+			res |= CheckGraphics(job.name, pages[0], DotMatrixPrinter::DPI / 72.0);
+	}
+
+	{
+		const PrintJob job = { "Epson text", ParallelPrinterCard::PRINTER_EMULATION_EPSON, ParallelPrinterCard::PRINTER_PAGE_PBM, EpsonText(), 2, { 0xA10385E4, 0xCD457AB7 } };
+		res |= RunPrintJob(job, pages);
+	}
+
+	{
+		const PrintJob job = { "ImageWriter text", ParallelPrinterCard::PRINTER_EMULATION_IMAGEWRITER, ParallelPrinterCard::PRINTER_PAGE_PNG, ImageWriterText(), 1, { 0xB09D69D7 } };
+		res |= RunPrintJob(job, pages);
+	}
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Printer_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
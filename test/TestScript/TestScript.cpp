@@ -0,0 +1,195 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "frontends/common2/scriptengine.h"
+#include "frontends/common2/videooracle.h"
+
+#include "Card.h"
+#include "Core.h"
+#include "Memory.h"
+#include "Registry.h"
+
+#include <sstream>
+
+// Debugger scripts: the language on its own, then a boot to the Applesoft prompt driven by a script
+// (no disk controller, so the //e drops into BASIC)
+
+namespace
+{
+
+	int Run(const char* name, common2::ScriptEngine& engine, const std::ostringstream& out, const std::string& text, const int expected)
+	{
+		const int status = engine.parse(text) ? engine.run() : common2::ScriptEngine::ERROR;
+		if (status != expected)
+		{
+			printf("%s: exit status %d instead of %d\n%s", name, status, expected, out.str().c_str());
+			return 1;
+		}
+		return 0;
+	}
+
+	int Run(const char* name, const std::string& text, const int expected)
+	{
+		std::ostringstream out;
+		common2::ScriptEngine engine(out);
+		return Run(name, engine, out, text, expected);
+	}
+
+	int TestLanguage(void)
+	{
+		int res = 0;
+
+		std::ostringstream out;
+		common2::ScriptEngine engine(out);
+		const char script[] =
+			"# loops and variables\n"
+			"set total = 0\n"
+			"set i = 0\n"
+			"while i < 10\n"
+			"  set i = i + 1\n"
+			"  if i % 2 == 0\n"
+			"    set total = total + i\n"
+			"  else\n"
+			"    repeat 2\n"
+			"      set total = total + 100\n"
+			"    end\n"
+			"  end\n"
+			"end\n"
+			"repeat 0\n"
+			"  set total = -1\n"
+			"end\n"
+			"set bits = ($F0 | 0x0F) & ~1 ^ (1 << 4)\n"
+			"expect total == 1030 \"total\"\n"
+			"print \"total\" total\n";
+		if (!engine.parse(script) || engine.run() != common2::ScriptEngine::PASSED)
+		{
+			printf("language: %s", out.str().c_str());
+			res = 1;
+		}
+		int64_t total = 0, bits = 0;
+		if (!engine.getVariable("total", total) || total != 1030 || !engine.getVariable("bits", bits) || bits != 0xEE ||
+			out.str().find("total 1030\n") == std::string::npos)
+		{
+			printf("language: total %lld, bits %lld\n", (long long)total, (long long)bits);
+			res = 1;
+		}
+
+		// expect goes on, assert stops, exit sets the status
+		std::ostringstream expectOut;
+		common2::ScriptEngine expectEngine(expectOut);
+		res |= Run("expect", expectEngine, expectOut, "expect 1 == 2\nexpect 0 \"second\"\nset after = 1\n", common2::ScriptEngine::FAILED);
+		const std::string output = expectOut.str();
+		int64_t after = 0;
+		if (output.find("failed: 1 == 2") == std::string::npos || output.find("failed: second") == std::string::npos ||
+			!expectEngine.getVariable("after", after))
+		{
+			printf("expect: %s", output.c_str());
+			res = 1;
+		}
+		std::ostringstream assertOut;
+		common2::ScriptEngine assertEngine(assertOut);
+		res |= Run("assert", assertEngine, assertOut, "assert 0\nset after = 1\n", common2::ScriptEngine::FAILED);
+		if (assertEngine.getVariable("after", after))
+		{
+			printf("assert: did not stop\n");
+			res = 1;
+		}
+		res |= Run("exit", "exit 7\nexpect 0\n", 7);
+		res |= Run("exit status", "expect 0\nexit\n", common2::ScriptEngine::FAILED);
+
+		// script errors
+		res |= Run("missing end", "while 1\n", common2::ScriptEngine::ERROR);
+		res |= Run("else", "else\nend\n", common2::ScriptEngine::ERROR);
+		res |= Run("unknown variable", "expect nothing == 1\n", common2::ScriptEngine::ERROR);
+		res |= Run("syntax", "set n = (1 + 2\n", common2::ScriptEngine::ERROR);
+		res |= Run("register", "set pc = 1\n", common2::ScriptEngine::ERROR);
+		res |= Run("division", "set n = 1 / 0\n", common2::ScriptEngine::ERROR);
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	int TestBoot(void)
+	{
+		int res = 0;
+
+		const char script[] =
+			"until screen(\"]\") within 10000000\n"
+			"run 200000\n"	// the prompt is shown before BASIC waits for a key
+			"type \"PRINT 6*7\\r\"\n"
+			"until screen(\"42\") within 5000000\n"
+			"expect peekw($FFFC) == $FA62 \"reset vector\"\n"
+			"// a debugger command\n"
+			"F 300 30F AA\n"
+			"expect peek($300) == $AA && peek($30F) == $AA\n"
+			"echo hello\n"
+			"// stopped on an instruction: GETLN calls RDKEY for the next key\n"
+			"set start = cycles\n"
+			"type \"1\"\n"
+			"until pc == $FD0C within 1000000\n"
+			"expect cycles > start && pc == $FD0C\n"
+			"until screen(\"NEVER\") within 100000\n"
+			"set after = 1\n";
+
+		std::ostringstream out;
+		common2::ScriptEngine engine(out);
+		res |= Run("boot", engine, out, script, common2::ScriptEngine::FAILED);	// the last until times out
+
+		const std::string output = out.str();
+		int64_t after = 0;
+		if (engine.getFailures() != 1 || engine.getVariable("after", after) || output.find("timed out") == std::string::npos ||
+			output.find("hello") == std::string::npos)
+		{
+			printf("boot: %s", output.c_str());
+			res = 1;
+		}
+
+		bool prompt = false;
+		for (const std::string& line : common2::decodeTextScreen())
+			prompt = prompt || line.find("42") != std::string::npos;
+		if (!prompt)
+		{
+			for (const std::string& line : common2::decodeTextScreen())
+				printf("%s\n", line.c_str());
+			res = 1;
+		}
+
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int Script_test(void)
+{
+	const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+	registry->putDWord(RegGetConfigSlotSection(SLOT6), REGVALUE_CARD_TYPE, CT_Empty);
+	const testcommon::TestEmulator emulator(registry);
+
+	int res = 0;
+	res |= TestLanguage();
+	res |= TestBoot();
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Script_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -0,0 +1,371 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "Registry.h"
+#include "SaveState.h"
+#include "SerialComms.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include <linux/sockios.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// End-to-end test of the Linux Super Serial Card: the SSC in slot 2 is connected to one end of a socketpair
+// (via the "fd:<n>" serial port), the test plays the remote terminal on the other end.
+
+namespace
+{
+
+	// Polled: receive a byte, store it @ $1000,X and send it back with bit 5 flipped. Count @ $06.
+	const BYTE g_echoProgram[] =
+	{
+		0xA9, 0x1E,         // 0800: LDA #$1E
+		0x8D, 0xAB, 0xC0,   // 0802: STA $C0AB       ; Control: 9600 baud, 8 bits, 1 stop bit
+		0xA9, 0x0B,         // 0805: LDA #$0B
+		0x8D, 0xAA, 0xC0,   // 0807: STA $C0AA       ; Command: no parity, RTS low, no IRQs, DTR
+		0xA2, 0x00,         // 080A: LDX #$00
+		// loop:
+		0xAD, 0xA9, 0xC0,   // 080C: LDA $C0A9       ; Status
+		0x29, 0x08,         // 080F: AND #$08        ; RX full?
+		0xF0, 0xF9,         // 0811: BEQ loop
+		0xAD, 0xA8, 0xC0,   // 0813: LDA $C0A8
+		0x9D, 0x00, 0x10,   // 0816: STA $1000,X
+		0x49, 0x20,         // 0819: EOR #$20
+		0xA8,               // 081B: TAY
+		// txwait:
+		0xAD, 0xA9, 0xC0,   // 081C: LDA $C0A9
+		0x29, 0x10,         // 081F: AND #$10        ; TX empty?
+		0xF0, 0xF9,         // 0821: BEQ txwait
+		0x8C, 0xA8, 0xC0,   // 0823: STY $C0A8
+		0xE8,               // 0826: INX
+		0xE4, 0x06,         // 0827: CPX $06
+		0xD0, 0xE1,         // 0829: BNE loop
+		// flush:
+		0xAD, 0xA9, 0xC0,   // 082B: LDA $C0A9
+		0x29, 0x10,         // 082E: AND #$10
+		0xF0, 0xF9,         // 0830: BEQ flush
+		// done:
+		0x4C, 0x32, 0x08,   // 0832: JMP done
+	};
+
+	// IRQ driven: the handler stores each byte @ $1000,Y (index @ $07), the main loop waits for the count @ $06.
+	const BYTE g_irqProgram[] =
+	{
+		0x78,               // 0800: SEI
+		0xA9, 0x30,         // 0801: LDA #<irq
+		0x8D, 0xFE, 0x03,   // 0803: STA $03FE
+		0xA9, 0x08,         // 0806: LDA #>irq
+		0x8D, 0xFF, 0x03,   // 0808: STA $03FF
+		0xA9, 0x00,         // 080B: LDA #$00
+		0x85, 0x07,         // 080D: STA $07
+		0xA9, 0x1E,         // 080F: LDA #$1E
+		0x8D, 0xAB, 0xC0,   // 0811: STA $C0AB       ; Control: 9600 baud, 8 bits, 1 stop bit
+		0xA9, 0x09,         // 0814: LDA #$09
+		0x8D, 0xAA, 0xC0,   // 0816: STA $C0AA       ; Command: no parity, RTS low, RX IRQ, DTR
+		0x58,               // 0819: CLI
+		// wait:
+		0xA5, 0x07,         // 081A: LDA $07
+		0xC5, 0x06,         // 081C: CMP $06
+		0xD0, 0xFA,         // 081E: BNE wait
+		// done:
+		0x4C, 0x20, 0x08,   // 0820: JMP done
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		// irq:
+		0xAD, 0xA9, 0xC0,   // 0830: LDA $C0A9       ; Status (clears the IRQ)
+		0x29, 0x08,         // 0833: AND #$08
+		0xF0, 0x0A,         // 0835: BEQ out
+		0xAD, 0xA8, 0xC0,   // 0837: LDA $C0A8
+		0xA4, 0x07,         // 083A: LDY $07
+		0x99, 0x00, 0x10,   // 083C: STA $1000,Y
+		0xE6, 0x07,         // 083F: INC $07
+		// out:
+		0xA5, 0x45,         // 0841: LDA $45
+		0x40,               // 0843: RTI
+	};
+
+	const WORD kProgramAddr = 0x0800;
+	const WORD kBufferAddr = 0x1000;
+	const BYTE kCount = 64;
+	const UINT kChunk = 1000;
+	const UINT kMaxCycles = 4000000;
+
+	struct SerialTest
+	{
+		const char* name;
+		const BYTE* program;
+		size_t size;
+		WORD doneAddr;
+		bool echo;
+		bool turbo;
+	};
+
+	// wait until the emulator's I/O thread has read everything, so turbo timings don't depend on the host's scheduler
+	void WaitUntilSent(const int fd)
+	{
+		for (int i = 0; i < 2000; i++)
+		{
+			int pending = 0;
+			if (ioctl(fd, SIOCOUTQ, &pending) || pending == 0)
+				return;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	void Receive(const int fd, std::vector<BYTE>& data, const int timeout)
+	{
+		pollfd pfd = { fd, POLLIN, 0 };
+		while (poll(&pfd, 1, timeout) > 0)
+		{
+			BYTE buffer[256];
+			const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+			if (n <= 0)
+				break;
+			data.insert(data.end(), buffer, buffer + n);
+			if (data.size() >= kCount)
+				break;
+		}
+	}
+
+	int RunSerialTest(const SerialTest& test)
+	{
+		int sv[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv))
+		{
+			perror("socketpair");
+			return 1;
+		}
+		const int remote = sv[1];
+
+		common2::EmulatorOptions options;
+		options.serialPort = "fd:" + std::to_string(sv[0]);	// as --serial
+		options.serialTurbo = test.turbo;
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+		registry->putDWord(RegGetConfigSlotSection(SLOT2), REGVALUE_CARD_TYPE, CT_Empty);
+		const testcommon::TestEmulator emulator(registry, options);
+
+		CSuperSerialCard* pSSC = GetCardMgr().GetSSC();
+		if (!pSSC || !pSSC->IsActive())
+		{
+			printf("%s: SSC not connected\n", test.name);
+			close(sv[0]);
+			close(remote);
+			return 1;
+		}
+
+		for (UINT i = 0; i < test.size; i++)
+			WriteByteToMemory(kProgramAddr + i, test.program[i]);
+		for (UINT i = 0; i < kCount; i++)
+			WriteByteToMemory(kBufferAddr + i, 0x00);
+		WriteByteToMemory(0x06, kCount);
+		regs.pc = kProgramAddr;
+
+		std::vector<BYTE> sent;
+		for (UINT i = 0; i < kCount; i++)
+			sent.push_back((BYTE)(0x40 + i));
+		if (send(remote, sent.data(), sent.size(), 0) != (ssize_t)sent.size())
+			perror("send");
+		WaitUntilSent(remote);
+
+		std::vector<BYTE> echoed;
+		UINT cycles = 0;
+		const UINT64 startCycles = g_nCumulativeCycles;
+
+		while (cycles < kMaxCycles && (regs.pc < test.doneAddr || regs.pc > test.doneAddr + 2))
+		{
+			const UINT executed = CpuExecute(kChunk, false);
+			GetCardMgr().Update(executed);	// as the frontends do once per chunk
+			cycles += executed;
+			if (test.echo)
+				Receive(remote, echoed, 0);
+		}
+
+		const UINT64 elapsed = g_nCumulativeCycles - startCycles;
+		if (test.echo)
+			Receive(remote, echoed, 2000);
+
+		int res = 0;
+
+		if (cycles >= kMaxCycles)
+		{
+			printf("%s: didn't complete\n", test.name);
+			res = 1;
+		}
+
+		for (UINT i = 0; i < kCount; i++)
+		{
+			if (ReadByteFromMemory(kBufferAddr + i) != sent[i])
+			{
+				printf("%s: guest received 0x%02X instead of 0x%02X @ %u\n", test.name, ReadByteFromMemory(kBufferAddr + i), sent[i], i);
+				res = 1;
+				break;
+			}
+		}
+
+		if (test.echo)
+		{
+			bool ok = echoed.size() == kCount;
+			for (UINT i = 0; ok && i < kCount; i++)
+				ok = echoed[i] == (sent[i] ^ 0x20);
+			if (!ok)
+			{
+				printf("%s: host received %zu bytes (expected %u)\n", test.name, echoed.size(), kCount);
+				res = 1;
+			}
+		}
+
+		// 9600 baud 8-N-1: 10 bits per byte (the 1st byte may already be on the wire when the receiver is enabled)
+		// NB. turbo is bounded by the guest: the //e's IRQ handler alone takes ~300 cycles
+		const UINT64 byteCycles = (UINT64)(g_fCurrentCLK6502 * 10 / 9600);
+		const UINT64 minPaced = (kCount - 1) * byteCycles;
+		if (!test.turbo && elapsed < minPaced)
+		{
+			printf("%s: too fast for 9600 baud: %llu cycles < %llu\n", test.name, (unsigned long long)elapsed, (unsigned long long)minPaced);
+			res = 1;
+		}
+		if (test.turbo && elapsed >= minPaced / 2)
+		{
+			printf("%s: turbo is paced: %llu cycles\n", test.name, (unsigned long long)elapsed);
+			res = 1;
+		}
+
+		printf("%s: %llu cycles: %s\n", test.name, (unsigned long long)elapsed, res ? "FAILED" : "OK");
+
+		close(sv[0]);
+		close(remote);
+		return res;
+	}
+
+	std::string ReadFile(const std::string& filename)
+	{
+		std::ifstream file(filename);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// --serial survives a restart, and an fd:<n> is written neither to the registry nor to a save-state
+	int TestRestart(void)
+	{
+		int sv[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv))
+		{
+			perror("socketpair");
+			return 1;
+		}
+		const std::string port = "fd:" + std::to_string(sv[0]);
+
+		common2::EmulatorOptions options;
+		options.serialPort = port;
+		options.serialTurbo = true;
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+		registry->putDWord(RegGetConfigSlotSection(SLOT2), REGVALUE_CARD_TYPE, CT_Empty);
+		const testcommon::TestEmulator emulator(registry, options);
+		testcommon::TestFrame& frame = emulator.GetFrame();
+
+		frame.Restart();
+
+		int res = 0;
+		CSuperSerialCard* pSSC = GetCardMgr().GetSSC();
+		if (!pSSC || !pSSC->IsActive() || pSSC->GetSerialPortName() != port)
+		{
+			printf("restart: --serial lost\n");
+			res = 1;
+		}
+
+		const std::string snapshot = "testserial.aws.yaml";
+		Snapshot_SetFilename(snapshot);
+		Snapshot_SaveState();
+		if (ReadFile(snapshot).find(port) != std::string::npos)
+		{
+			printf("restart: %s in the save-state\n", port.c_str());
+			res = 1;
+		}
+
+		// a save-state from before has the fd: spec, which must not re-open whatever descriptor has that number now
+		const std::string text = ReadFile(snapshot);
+		const std::string key = "Serial Port Name: ";
+		const size_t pos = text.find(key);
+		if (pos == std::string::npos)
+		{
+			printf("restart: no port in the save-state\n");
+			res = 1;
+		}
+		else
+		{
+			std::ofstream(snapshot) << text.substr(0, pos + key.size()) << "fd:0" << text.substr(text.find('\n', pos));
+			frame.LoadSnapshot();
+			pSSC = GetCardMgr().GetSSC();
+			if (!pSSC || pSSC->GetSerialPortName() != port)
+			{
+				printf("restart: fd: loaded from the save-state\n");
+				res = 1;
+			}
+		}
+		std::remove(snapshot.c_str());
+
+		char name[256] = "";
+		RegLoadString(RegGetConfigSlotSection(SLOT2).c_str(), REGVALUE_SERIAL_PORT_NAME, TRUE, name, sizeof(name), "");
+		if (name[0])
+		{
+			printf("restart: %s in the registry\n", name);
+			res = 1;
+		}
+
+		printf("restart: %s\n", res ? "FAILED" : "OK");
+
+		close(sv[0]);
+		close(sv[1]);
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+const SerialTest g_serialTests[] =
+{
+	{ "echo",		g_echoProgram, sizeof(g_echoProgram), 0x0832, true,  false },
+	{ "echo-turbo",	g_echoProgram, sizeof(g_echoProgram), 0x0832, true,  true  },
+	{ "irq",		g_irqProgram,  sizeof(g_irqProgram),  0x0820, false, false },
+	{ "irq-turbo",	g_irqProgram,  sizeof(g_irqProgram),  0x0820, false, true  },
+};
+
+int Serial_test(void)
+{
+	int res = 0;
+
+	for (const SerialTest& test : g_serialTests)
+		res |= RunSerialTest(test);
+	res |= TestRestart();
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Serial_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -0,0 +1,513 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "Debugger/Debug.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "ProgramLoader.h"
+#include "Registry.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+// Source assembler: Monitor routines against the ROM, every addressing mode against hand assembled bytes,
+// macros & PUT files run in the emulator, errors, and a 10000 line source against the time target
+
+namespace
+{
+
+	const double kMaxAssembleMs = 100.0;
+	const int kSpeedLines = 10000;
+
+	void PrintErrors(const char* name, const SourceAsmResult_t& result)
+	{
+		for (const std::string& error : result.aErrors)
+			printf("%s: %s\n", name, error.c_str());
+	}
+
+	std::vector<BYTE> Bytes(const SourceAsmResult_t& result)
+	{
+		std::vector<BYTE> bytes;
+		for (const SourceAsmSegment_t& segment : result.aSegments)
+			bytes.insert(bytes.end(), segment.aBytes.begin(), segment.aBytes.end());
+		return bytes;
+	}
+
+	int CompareBytes(const char* name, const std::vector<BYTE>& bytes, const std::vector<BYTE>& expected)
+	{
+		if (bytes == expected)
+			return 0;
+
+		printf("%s: %u bytes instead of %u\n", name, (UINT)bytes.size(), (UINT)expected.size());
+		for (size_t i = 0; i < bytes.size() || i < expected.size(); i++)
+		{
+			const int got = i < bytes.size() ? bytes[i] : -1;
+			const int want = i < expected.size() ? expected[i] : -1;
+			if (got != want)
+			{
+				printf("%s: byte %u is %02X instead of %02X\n", name, (UINT)i, got, want);
+				break;
+			}
+		}
+		return 1;
+	}
+
+	int WriteFile(const std::filesystem::path& path, const char* text)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << text;
+		return file ? 0 : 1;
+	}
+
+	//-------------------------------------
+
+	// Apple //e Monitor routines, assembled to the same bytes as the ROM
+	int TestRom(void)
+	{
+		const char source[] =
+			"* Monitor excerpts\n"
+			"A5H      EQU   $45\n"
+			"XREG     EQU   $46\n"
+			"YREG     EQU   $47\n"
+			"STATUS   EQU   $48\n"
+			"SPNT     EQU   $49\n"
+			"SPKR     =     $C030\n"
+			"COUT     EQU   $FDED\n"
+			"\n"
+			"         ORG   $FBDD\n"
+			"BELL1    LDA   #$40\n"
+			"         JSR   WAIT        forward reference\n"
+			"         LDY   #$C0\n"
+			"BELL2    LDA   #$0C\n"
+			"         JSR   WAIT\n"
+			"         LDA   SPKR\n"
+			"         DEY\n"
+			"         BNE   BELL2\n"
+			"RTS2B    RTS\n"
+			"\n"
+			"         ORG   $FCA8\n"
+			"WAIT     SEC\n"
+			"WAIT2    PHA\n"
+			":WAIT3   SBC   #1          ; local to WAIT2\n"
+			"         BNE   :WAIT3\n"
+			"         PLA\n"
+			"         SBC   #1\n"
+			"         BNE   WAIT2\n"
+			"         RTS\n"
+			"\n"
+			"         ORG   $FF2D\n"
+			"PRERR    LDA   #\"E\"\n"
+			"         JSR   COUT\n"
+			"         LDA   #\"R\"\n"
+			"         JSR   COUT\n"
+			"         JSR   COUT\n"
+			"BELL     LDA   #$87\n"
+			"         JMP   COUT\n"
+			"IOREST   LDA   STATUS\n"
+			"         PHA\n"
+			"         LDA   A5H\n"
+			"         LDX   XREG\n"
+			"         LDY   YREG\n"
+			"         PLP\n"
+			"         RTS\n"
+			"IOSAVE   STA   A5H\n"
+			"         STX   XREG\n"
+			"         STY   YREG\n"
+			"         PHP\n"
+			"         PLA\n"
+			"         STA   STATUS\n"
+			"         TSX\n"
+			"         STX   SPNT\n"
+			"         CLD\n"
+			"         RTS\n";
+
+		SourceAsmResult_t result;
+		if (!SourceAssemble(source, "monitor.s", result))
+		{
+			PrintErrors("rom", result);
+			return 1;
+		}
+
+		int res = 0;
+		if (result.aSegments.size() != 3 || result.nStartAddress != 0xFBDD)
+		{
+			printf("rom: %u segments, start %04X\n", (UINT)result.aSegments.size(), result.nStartAddress);
+			res = 1;
+		}
+
+		for (const SourceAsmSegment_t& segment : result.aSegments)
+		{
+			std::vector<BYTE> rom;
+			for (size_t i = 0; i < segment.aBytes.size(); i++)
+				rom.push_back(ReadByteFromMemory((WORD)(segment.nAddress + i)));
+			const std::string name = StrFormat("rom $%04X", segment.nAddress);
+			res |= CompareBytes(name.c_str(), segment.aBytes, rom);
+		}
+
+		// symbols: globals only, equates included, labels win
+		SourceAssemblerAddSymbols(result, SYMBOLS_SRC_1);
+		const SymbolTable_t& symbols = g_aSymbols[SYMBOLS_SRC_1];
+		if (symbols.size() != 16 || symbols.at(0xFF4A) != "IOSAVE" || symbols.at(0xFCA9) != "WAIT2" || symbols.at(0xC030) != "SPKR" ||
+			!symbols.count(0x0045))
+		{
+			printf("rom: %u symbols\n", (UINT)symbols.size());
+			res = 1;
+		}
+		for (const SourceAsmSymbol_t& symbol : result.aSymbols)
+		{
+			if (symbol.sName.find(':') != std::string::npos)
+			{
+				printf("rom: local symbol %s\n", symbol.sName.c_str());
+				res = 1;
+			}
+		}
+		_CmdSymbolsClear(SYMBOLS_SRC_1);
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	struct Line
+	{
+		const char* text;
+		std::vector<BYTE> bytes;
+	};
+
+	// Hand assembled, at $1000 on a 65C02
+	int TestModes(void)
+	{
+		const Line lines[] =
+		{
+			{ "ZP       EQU   $12", {} },
+			{ "ABS      EQU   $3456", {} },
+			{ "         ORG   $1000", {} },
+			{ "START    LDA   #$01", { 0xA9, 0x01 } },
+			{ "         LDA   ZP", { 0xA5, 0x12 } },
+			{ "         LDA   ZP,X", { 0xB5, 0x12 } },
+			{ "         LDX   ZP,Y", { 0xB6, 0x12 } },
+			{ "         LDA   ZP,Y        no zero page,Y for LDA", { 0xB9, 0x12, 0x00 } },
+			{ "         LDA   ABS", { 0xAD, 0x56, 0x34 } },
+			{ "         lda   ABS,x", { 0xBD, 0x56, 0x34 } },
+			{ "         LDA   ABS,Y", { 0xB9, 0x56, 0x34 } },
+			{ "         LDA   (ZP,X)", { 0xA1, 0x12 } },
+			{ "         LDA   (ZP),Y", { 0xB1, 0x12 } },
+			{ "         LDA   (ZP)", { 0xB2, 0x12 } },
+			{ "         LDA:  ZP", { 0xAD, 0x12, 0x00 } },
+			{ "         JMP   (ABS)", { 0x6C, 0x56, 0x34 } },
+			{ "         JMP   (ABS,X)", { 0x7C, 0x56, 0x34 } },
+			{ "         ASL", { 0x0A } },
+			{ "         ROR   A", { 0x6A } },
+			{ "         INC", { 0x1A } },
+			{ "         STZ   ZP", { 0x64, 0x12 } },
+			{ "         BIT   #$80", { 0x89, 0x80 } },
+			{ "         LDA   FWD         forward: absolute", { 0xAD, 0x20, 0x00 } },
+			{ "LOOP     BRA   LOOP", { 0x80, 0xFE } },
+			{ "         BNE   START", { 0xD0, 0xCF } },
+			{ "         BEQ   :NEXT", { 0xF0, 0x00 } },
+			{ ":NEXT    LDA   #<ABS", { 0xA9, 0x56 } },
+			{ "         LDA   #>ABS+$100  high byte of the whole expression", { 0xA9, 0x35 } },
+			{ "         LDA   #\"A\"", { 0xA9, 0xC1 } },
+			{ "         LDA   #'A'", { 0xA9, 0x41 } },
+			{ "         LDA   #2+3*4", { 0xA9, 0x0E } },
+			{ "         LDA   #(2+3)*4", { 0xA9, 0x14 } },
+			{ "         LDA   #%1010|$F0", { 0xA9, 0xFA } },
+			{ "         LDA   #$FF&~$0F!1", { 0xA9, 0xF1 } },
+			{ "         LDA   #1<<4+1", { 0xA9, 0x20 } },
+			{ "         LDA   #$100-<ABS", { 0xA9, 0xAA } },
+			{ "         LDA   #-1", { 0xA9, 0xFF } },
+			{ "         LDA   #100/7", { 0xA9, 0x0E } },
+			{ "         LDY   *+3", { 0xAC, 0x4E, 0x10 } },
+			{ "         DFB   1,$FF,-1,<ABS,>ABS", { 0x01, 0xFF, 0xFF, 0x56, 0x34 } },
+			{ "         DA    ABS,START", { 0x56, 0x34, 0x00, 0x10 } },
+			{ "         DDB   $1234", { 0x12, 0x34 } },
+			{ "         HEX   0A0B,0c", { 0x0A, 0x0B, 0x0C } },
+			{ "         ASC   \"A B\"8D", { 0xC1, 0xA0, 0xC2, 0x8D } },
+			{ "         ASC   'AB'", { 0x41, 0x42 } },
+			{ "         DCI   'AB'", { 0x41, 0xC2 } },
+			{ "         DS    3,$EA", { 0xEA, 0xEA, 0xEA } },
+			{ "; comment", {} },
+			{ "         LST   OFF", {} },
+			{ "         XC    OFF", {} },
+			{ "         LDA   (ZP,X)      still on a 6502", { 0xA1, 0x12 } },
+			{ "         XC", {} },
+			{ "         STZ   ABS", { 0x9C, 0x56, 0x34 } },
+			{ "FWD      =     $20", {} },
+			{ "         END", {} },
+			{ "         NOT   ASSEMBLED", {} },
+		};
+
+		std::string source;
+		std::vector<BYTE> expected;
+		for (const Line& line : lines)
+		{
+			source += line.text;
+			source += "\r\n";
+			expected.insert(expected.end(), line.bytes.begin(), line.bytes.end());
+		}
+
+		SourceAsmResult_t result;
+		if (!SourceAssemble(source, "modes.s", result))
+		{
+			PrintErrors("modes", result);
+			return 1;
+		}
+
+		int res = CompareBytes("modes", Bytes(result), expected);
+		if (result.aSegments.size() != 1 || result.aSegments[0].nAddress != 0x1000)
+		{
+			printf("modes: %u segments\n", (UINT)result.aSegments.size());
+			res = 1;
+		}
+
+		// line table
+		WORD address = 0x1000;
+		size_t iLine = 0;
+		for (int i = 0; i < (int)(sizeof(lines) / sizeof(lines[0])); i++)
+		{
+			if (lines[i].bytes.empty())
+				continue;
+			const SourceAsmLine_t* pLine = iLine < result.aLines.size() ? &result.aLines[iLine] : NULL;
+			if (!pLine || pLine->nAddress != address || pLine->nBytes != lines[i].bytes.size() || pLine->nLine != i + 1 || pLine->iFile != 0)
+			{
+				printf("modes: line table at %d\n", i + 1);
+				res = 1;
+				break;
+			}
+			address += (WORD)lines[i].bytes.size();
+			iLine++;
+		}
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	// PUT, macros with arguments & :local labels, run in the emulator
+	int TestMacros(void)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "testsourceassembler";
+		std::filesystem::create_directories(directory);
+
+		int res = 0;
+		res |= WriteFile(directory / "macros.s",
+			"* store a byte\n"
+			"MOVB     MAC\n"
+			"         LDA   ]1\n"
+			"         STA   ]2\n"
+			"         EOM\n"
+			"DELAY    MAC\n"
+			"         LDX   #]1\n"
+			":LOOP    DEX\n"
+			"         BNE   :LOOP\n"
+			"         <<<\n");
+		res |= WriteFile(directory / "main.s",
+			"         ORG   $0300\n"
+			"         PUT   macros.s\n"
+			"START    MOVB  #$41;$0400\n"
+			"         MOVB  #\"B\";TEXT+1\n"
+			"         DELAY 3\n"
+			"         DELAY 4\n"
+			"         PMC   MOVB.#$43;TEXT+2\n"
+			"DONE     JMP   DONE\n"
+			"TEXT     EQU   $0400\n");
+
+		SourceAsmResult_t result;
+		if (!SourceAssembleFile((directory / "main.s").string(), result))
+		{
+			PrintErrors("macros", result);
+			std::filesystem::remove_all(directory);
+			return 1;
+		}
+		std::filesystem::remove_all(directory);
+
+		const std::vector<BYTE> expected =
+		{
+			0xA9, 0x41, 0x8D, 0x00, 0x04,
+			0xA9, 0xC2, 0x8D, 0x01, 0x04,
+			0xA2, 0x03, 0xCA, 0xD0, 0xFD,
+			0xA2, 0x04, 0xCA, 0xD0, 0xFD,
+			0xA9, 0x43, 0x8D, 0x02, 0x04,
+			0x4C, 0x19, 0x03,
+		};
+		res |= CompareBytes("macros", Bytes(result), expected);
+
+		if (result.aFiles.size() != 2 || result.aLines.size() != 13 || result.aLines[0].nLine != 3 || result.aLines[0].nBytes != 2 ||
+			result.aLines[12].nLine != 8 || result.nSourceLines != 9 + 10 + 3 * 2 + 2 * 3)
+		{
+			printf("macros: %u files, %u lines, %d source lines\n", (UINT)result.aFiles.size(), (UINT)result.aLines.size(), result.nSourceLines);
+			res = 1;
+		}
+
+		// straight into memory, then run it
+		SourceAssemblerWriteMemory(result);
+		memset(MemGetMainPtr(0x0400), 0xA0, 3);
+		regs.pc = 0x0300;
+		CpuExecute(200, true);
+		if (regs.pc != 0x0319 || *MemGetMainPtr(0x0400) != 0x41 || *MemGetMainPtr(0x0401) != 0xC2 || *MemGetMainPtr(0x0402) != 0x43 || regs.x != 0)
+		{
+			printf("macros: PC=%04X, $0400: %02X %02X %02X\n", regs.pc, *MemGetMainPtr(0x0400), *MemGetMainPtr(0x0401), *MemGetMainPtr(0x0402));
+			res = 1;
+		}
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	int ExpectError(const char* name, const char* source, const char* error)
+	{
+		SourceAsmResult_t result;
+		if (SourceAssemble(source, "errors.s", result) || result.aErrors.empty() || result.aErrors[0].find(error) == std::string::npos)
+		{
+			printf("%s: no \"%s\"\n", name, error);
+			PrintErrors(name, result);
+			return 1;
+		}
+		return 0;
+	}
+
+	int TestErrors(void)
+	{
+		int res = 0;
+		res |= ExpectError("undefined", " LDA NOWHERE\n", "errors.s(1): Undefined symbol: NOWHERE");
+		res |= ExpectError("duplicate", "A1 NOP\n\nA1 NOP\n", "errors.s(3): Symbol defined twice: A1");
+		res |= ExpectError("opcode", " FOO 1\n", "Unknown opcode: FOO");
+		res |= ExpectError("branch", "L BNE L+200\n", "Branch out of range");
+		res |= ExpectError("6502", " XC OFF\n STZ $12\n", "errors.s(2): Addressing mode not available: STZ $12");
+		res |= ExpectError("mode", " STX $1234,X\n", "Addressing mode not available");
+		res |= ExpectError("zero page", " LDA ($1234),Y\n", "Zero page address expected");
+		res |= ExpectError("org", " ORG LATER\nLATER NOP\n", "must be defined before");
+		res |= ExpectError("syntax", " LDA #(1+2\n", "Missing )");
+		res |= ExpectError("mac", "M MAC\n NOP\n", "MAC without EOM");
+		res |= ExpectError("put", " PUT /nonexistent/file.s\n", "Couldn't read");
+		res |= ExpectError("past end", " ORG $FFFF\n NOP\n NOP\n", "Code past $FFFF");
+
+		// all errors are listed, with no code
+		SourceAsmResult_t result;
+		if (SourceAssemble(" LDA NOWHERE\n LDX NEITHER\n", "errors.s", result) || result.aErrors.size() != 2 || !result.aSegments.empty())
+		{
+			printf("errors: %u errors\n", (UINT)result.aErrors.size());
+			res = 1;
+		}
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	int TestProgramLoader(void)
+	{
+		const char source[] =
+			"         LDA   #$AA\n"
+			"         STA   $0410\n"
+			"HERE     JMP   HERE\n";
+
+		std::string error;
+		if (!ProgramLoader_Load("hello.s", std::vector<BYTE>(source, source + sizeof(source) - 1), 0x6000, true, error) ||
+			regs.pc != 0x6000 || *MemGetMainPtr(0x6005) != 0x4C || GetAddressFromSymbol("HERE") != 0x6005)
+		{
+			printf("program loader: %s PC=%04X\n", error.c_str(), regs.pc);
+			return 1;
+		}
+		_CmdSymbolsClear(SYMBOLS_SRC_1);
+
+		const char oops[] = "         NOP\n         LDA   NOWHERE\n";
+		if (ProgramLoader_Load("oops.s", std::vector<BYTE>(oops, oops + sizeof(oops) - 1), -1, false, error) || error.find("oops.s(2)") == std::string::npos)
+		{
+			printf("program loader: error \"%s\"\n", error.c_str());
+			return 1;
+		}
+		return 0;
+	}
+
+	//-------------------------------------
+
+	int TestSpeed(void)
+	{
+		std::string source =
+			"PTR      EQU   $06\n"
+			"ADDW     MAC\n"
+			"         CLC\n"
+			"         LDA   ]1\n"
+			"         ADC   #<]2\n"
+			"         STA   ]1\n"
+			"         LDA   ]1+1\n"
+			"         ADC   #>]2\n"
+			"         STA   ]1+1\n"
+			"         EOM\n"
+			"         ORG   $0800\n";
+		int lines = 11;
+		for (int i = 0; lines < kSpeedLines; i++)
+		{
+			source += StrFormat(
+				"L%d      LDA   (PTR),Y     ; line %d\n"
+				"         BEQ   L%d\n"
+				"         JSR   L%d\n"
+				"         ADDW  PTR;$%04X\n"
+				"         DFB   L%d-L%d,$%02X\n",
+				i, lines, i + 1, (i * 7) % (i + 1), i & 0xFFF, i + 1, i, i & 0xFF);
+			lines += 5;
+		}
+		source += StrFormat("L%d      RTS\n", (lines - 11) / 5);
+
+		SourceAsmResult_t result;
+		double best = 1e9;
+		for (int pass = 0; pass < 3; pass++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			if (!SourceAssemble(source, "speed.s", result))
+			{
+				PrintErrors("speed", result);
+				return 1;
+			}
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		printf("speed: %d lines (%d with macros), %d bytes in %.1f ms (target %.0f)\n", lines + 1, result.nSourceLines, result.nBytes, best, kMaxAssembleMs);
+		return best > kMaxAssembleMs ? 1 : 0;
+	}
+
+}
+
+//-------------------------------------
+
+int SourceAssembler_test(void)
+{
+	const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+	registry->putDWord(RegGetConfigSlotSection(SLOT6), REGVALUE_CARD_TYPE, CT_Empty);
+	const testcommon::TestEmulator emulator(registry);
+
+	int res = 0;
+	res |= TestRom();
+	res |= TestModes();
+	res |= TestMacros();
+	res |= TestErrors();
+	res |= TestProgramLoader();
+	res |= TestSpeed();
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = SourceAssembler_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
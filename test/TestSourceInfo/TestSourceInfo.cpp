@@ -0,0 +1,406 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "Debugger/Debug.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "Registry.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+// Source level debugging: a cc65 .dbg with overlapping lines & nested scopes, a Merlin listing,
+// TS & PS on an assembled program, and the lookup time on a large .dbg
+
+namespace
+{
+
+	const int kSpeedLines = 20000;
+	const int kLookups = 1000000;
+	const double kTargetLoadMs = 200.0;		// only printed: the test checks the lookups' results, not the speed
+	const double kTargetLookupsMs = 1000.0;	// a linear search is ~1000x slower
+
+	void DebuggerCommand(const std::string& command)
+	{
+		strncpy(g_pConsoleInput, command.c_str(), CONSOLE_WIDTH - 2);
+		g_pConsoleInput[CONSOLE_WIDTH - 2] = 0;
+		g_nConsoleInputChars = static_cast<int>(strlen(g_pConsoleInput));
+		DebuggerProcessCommand(false);
+		ConsoleFlush();
+		ConsoleInputReset();
+	}
+
+	int WriteFile(const std::filesystem::path& path, const std::string& text)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << text;
+		return file ? 0 : 1;
+	}
+
+	// "file:line", or "" if none
+	std::string LineAt(SourceInfo_t& info, const WORD address)
+	{
+		const SourceInfoRange_t* pRange = info.FindLine(address);
+		if (!pRange)
+			return "";
+		const SourceInfoLine_t& line = info.GetLine(pRange->iItem);
+		return StrFormat("%s:%d", info.GetFile(line.iFile).sName.c_str(), line.nLine);
+	}
+
+	std::string ScopeAt(const SourceInfo_t& info, const WORD address)
+	{
+		const SourceInfoRange_t* pRange = info.FindScope(address);
+		return pRange ? "<" + info.GetScope(pRange->iItem).sName + ">" : "";
+	}
+
+	//-------------------------------------
+
+	// A macro call line over its body, a C line over its assembler line, and nested scopes
+	int TestDbg(void)
+	{
+		const char text[] =
+			"version\tmajor=2,minor=0\n"
+			"info\tcsym=0,file=3,lib=0,line=7,mod=1,scope=3,seg=2,span=8,sym=5,type=0\n"
+			"file\tid=0,name=\"src/main.s\",size=300,mtime=0x60000000,mod=0\n"
+			"file\tid=1,name=\"src/macros.inc\",size=100,mtime=0x60000000,mod=0\n"
+			"file\tid=2,name=\"/build/game.c\",size=100,mtime=0x60000000,mod=0\n"
+			"line\tid=0,file=0,line=10,span=0\n"
+			"line\tid=1,file=0,line=11,span=1\n"
+			"line\tid=2,file=0,line=12,span=2\n"
+			"line\tid=3,file=1,line=3,type=2,count=1,span=3\n"
+			"line\tid=4,file=1,line=4,type=2,count=1,span=4\n"
+			"line\tid=5,file=2,line=7,type=1,span=5\n"
+			"line\tid=6,file=0,line=20,span=6+7\n"
+			"line\tid=7,file=0,line=1\n"
+			"mod\tid=0,name=\"main.o\",file=0\n"
+			"seg\tid=0,name=\"CODE\",start=0x000800,size=0x0020,addrsize=absolute,type=ro,oname=\"game\",ooffs=0\n"
+			"seg\tid=1,name=\"DATA\",start=0x001000,size=0x0010,addrsize=absolute,type=rw,oname=\"game\",ooffs=32\n"
+			"span\tid=0,seg=0,start=0,size=2\n"
+			"span\tid=1,seg=0,start=2,size=3\n"
+			"span\tid=2,seg=0,start=5,size=6\n"
+			"span\tid=3,seg=0,start=5,size=3\n"
+			"span\tid=4,seg=0,start=8,size=3\n"
+			"span\tid=5,seg=0,start=11,size=6\n"
+			"span\tid=6,seg=0,start=11,size=3\n"
+			"span\tid=7,seg=1,start=0,size=4\n"
+			"scope\tid=0,name=\"\",mod=0,size=17,span=0+1+2+5\n"
+			"scope\tid=1,name=\"main\",mod=0,type=scope,size=9,parent=0,span=1+2,sym=1\n"
+			"scope\tid=2,name=\"inner\",mod=0,type=scope,size=6,parent=1,span=2\n"
+			"sym\tid=0,name=\"start\",addrsize=absolute,scope=0,def=0,ref=1,val=0x800,seg=0,type=lab\n"
+			"sym\tid=1,name=\"main\",addrsize=absolute,scope=0,def=1,val=0x802,seg=0,type=lab\n"
+			"sym\tid=2,name=\"@loop\",addrsize=absolute,scope=1,def=2,val=0x805,seg=0,type=lab\n"
+			"sym\tid=3,name=\"COUT\",addrsize=absolute,scope=0,def=3,val=0xFDED,type=equ\n"
+			"sym\tid=4,name=\"_printf\",addrsize=absolute,scope=0,def=4,type=imp,exp=0\n"
+			"type\tid=0,val=\"800920\"\n";
+
+		struct Expected
+		{
+			WORD address;
+			const char* line;
+			const char* scope;
+		};
+		const Expected expected[] =
+		{
+			{ 0x07FF, "", "" },
+			{ 0x0800, "main.s:10", "<>" },
+			{ 0x0801, "main.s:10", "<>" },
+			{ 0x0802, "main.s:11", "<main>" },
+			{ 0x0805, "main.s:12", "<main::inner>" }, // the macro call, not its body
+			{ 0x080A, "main.s:12", "<main::inner>" },
+			{ 0x080B, "game.c:7", "<>" },             // C over assembler
+			{ 0x0810, "game.c:7", "<>" },
+			{ 0x0811, "", "" },
+			{ 0x1000, "main.s:20", "" },
+			{ 0x1003, "main.s:20", "" },
+			{ 0x1004, "", "" },
+		};
+
+		SourceInfo_t info;
+		std::string error;
+		if (!info.LoadDbg(text, "/projects/game/game.dbg", error))
+		{
+			printf("dbg: %s\n", error.c_str());
+			return 1;
+		}
+
+		int res = 0;
+		for (const Expected& test : expected)
+		{
+			const std::string line = LineAt(info, test.address);
+			const std::string scope = ScopeAt(info, test.address);
+			if (line != test.line || scope != test.scope)
+			{
+				printf("dbg: $%04X is %s %s instead of %s %s\n", test.address, line.c_str(), scope.c_str(), test.line, test.scope);
+				res = 1;
+			}
+		}
+
+		if (info.GetNumFiles() != 3 || info.GetNumLines() != 7 || info.GetNumScopes() != 3 || info.GetSymbols().size() != 3 ||
+			info.GetFile(0).sPathName != "/projects/game/src/main.s" || info.GetFile(2).sPathName != "/build/game.c" ||
+			info.GetScope(2).iParent != 1)
+		{
+			printf("dbg: %d files, %d lines, %d scopes, %u symbols, %s\n", info.GetNumFiles(), info.GetNumLines(), info.GetNumScopes(),
+				(UINT)info.GetSymbols().size(), info.GetFile(0).sPathName.c_str());
+			res = 1;
+		}
+
+		// a failed load keeps what was there
+		if (info.LoadDbg("version\tmajor=3,minor=0\n", "new.dbg", error) || error.find("version") == std::string::npos ||
+			info.LoadDbg("hello\n", "new.dbg", error) || LineAt(info, 0x0800) != "main.s:10")
+		{
+			printf("dbg: bad files\n");
+			res = 1;
+		}
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	int TestListing(void)
+	{
+		const char text[] =
+			"                 1 * listing\r\n"
+			"                 2 COUT     EQU   $FDED\r\n"
+			"0300: A9 C1      3 START    LDA   #\"A\"\r\n"
+			"0302: 20 ED FD   4          JSR   COUT\r\n"
+			"0305: 60         5          RTS\r\n"
+			"00/0306: 01 02 03 04   6 TABLE    DFB   1,2,3,4\r\n"
+			"\r\n"
+			"--End assembly, 10 bytes\r\n";
+
+		SourceInfo_t info;
+		std::string error;
+		if (!info.LoadListing(text, "hello.lst", error))
+		{
+			printf("listing: %s\n", error.c_str());
+			return 1;
+		}
+
+		int res = 0;
+		if (LineAt(info, 0x0300) != "hello.lst:3" || LineAt(info, 0x0304) != "hello.lst:4" || LineAt(info, 0x0305) != "hello.lst:5" ||
+			LineAt(info, 0x0309) != "hello.lst:6" || LineAt(info, 0x030A) != "" || info.GetFile(0).aText.size() != 8 ||
+			info.GetFile(0).aText[2].compare(0, 5, "0300:") != 0)
+		{
+			printf("listing: lines %s %s\n", LineAt(info, 0x0300).c_str(), LineAt(info, 0x0309).c_str());
+			res = 1;
+		}
+
+		const std::vector<SourceInfoSymbol_t>& symbols = info.GetSymbols();
+		if (symbols.size() != 2 || symbols[0].sName != "COUT" || symbols[0].nAddress != 0xFDED || symbols[1].sName != "TABLE" ||
+			symbols[1].nAddress != 0x0306)
+		{
+			printf("listing: %u symbols\n", (UINT)symbols.size());
+			res = 1;
+		}
+
+		memset(MemGetMainPtr(0x0300), 0, 10);
+		const BYTE bytes[] = { 0xA9, 0xC1, 0x20, 0xED, 0xFD, 0x60, 0x01, 0x02, 0x03, 0x04 };
+		if (info.WriteMemory() != 10 || memcmp(MemGetMainPtr(0x0300), bytes, sizeof(bytes)) != 0)
+		{
+			printf("listing: bytes\n");
+			res = 1;
+		}
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	// Runs a TS or PS to the end, then checks the line it stopped on
+	int Step(const char* command, const WORD address, const int line)
+	{
+		DebuggerCommand(command);
+		int steps = 0;
+		while (g_nAppMode == MODE_STEPPING && steps++ < 100000)
+			DebugContinueStepping(true);
+
+		const SourceInfoRange_t* pRange = g_SourceInfo.FindLine(regs.pc);
+		const int stopLine = pRange ? g_SourceInfo.GetLine(pRange->iItem).nLine : 0;
+		if (g_nAppMode != MODE_DEBUG || regs.pc != address || stopLine != line)
+		{
+			printf("step: %s stopped at $%04X (line %d) instead of $%04X (line %d)\n", command, regs.pc, stopLine, address, line);
+			return 1;
+		}
+		return 0;
+	}
+
+	int TestStepping(void)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "testsourceinfo";
+		std::filesystem::create_directories(directory);
+		const std::filesystem::path path = directory / "stepping.s";
+
+		int res = WriteFile(path,
+			"         ORG   $0300\n"           // 1
+			"START    LDX   #3\n"              // 2  0300
+			"LOOP     JSR   SUB\n"             // 3  0302
+			"         DEX\n"                   // 4  0305
+			"         BNE   LOOP\n"            // 5  0306
+			"         LDA   #1\n"              // 6  0308
+			"         JSR   $FCA8       ROM\n" // 7  030A
+			"DONE     JMP   DONE\n"            // 8  030D
+			"SUB      INY\n"                   // 9  0310
+			"         RTS\n");                 // 10 0311
+
+		DebugBegin();	// the opcode tables
+		DebuggerCommand("ASM \"" + path.string() + "\"");
+		const bool bLoaded = !g_SourceInfo.IsEmpty() && g_SourceInfo.GetFile(0).aText.size() == 10;	// read from the file
+		std::filesystem::remove_all(directory);
+
+		if (!bLoaded || ScopeAt(g_SourceInfo, 0x0306) != "<LOOP>" || ScopeAt(g_SourceInfo, 0x0311) != "<SUB>")
+		{
+			printf("step: ASM didn't load the line table\n");
+			return 1;
+		}
+
+		regs.pc = 0x0300;
+		regs.sp = 0x01FF;
+		regs.y = 0;
+
+		res |= Step("TS", 0x0302, 3);
+		res |= Step("TS", 0x0310, 9);	// into SUB
+		res |= Step("TS", 0x0311, 10);
+		res |= Step("TS", 0x0305, 4);	// back
+		res |= Step("PS", 0x0306, 5);
+		res |= Step("PS", 0x0302, 3);	// branch back
+		res |= Step("PS", 0x0305, 4);	// over SUB
+		res |= Step("PS", 0x0306, 5);
+		res |= Step("PS", 0x0302, 3);
+		res |= Step("PS", 0x0305, 4);
+		res |= Step("PS", 0x0306, 5);
+		res |= Step("PS", 0x0308, 6);	// X = 0
+		res |= Step("PS", 0x030A, 7);
+		res |= Step("TS", 0x030D, 8);	// no source in the ROM: over it
+		const uint64_t cycles = g_nCumulativeCycles;
+		res |= Step("TS", 0x030D, 8);	// a line that loops on itself
+		if (g_nCumulativeCycles != cycles + 3 || regs.x != 0 || regs.y != 3)
+		{
+			printf("step: X=%02X Y=%02X\n", regs.x, regs.y);
+			res = 1;
+		}
+
+		DebuggerCommand("SOURCE");
+		if (!g_SourceInfo.IsEmpty())
+		{
+			printf("step: SOURCE didn't stop\n");
+			res = 1;
+		}
+		DebuggerCommand("TS");
+		if (g_nAppMode != MODE_DEBUG || regs.pc != 0x030D)
+		{
+			printf("step: TS without source ran\n");
+			res = 1;
+		}
+
+		return res;
+	}
+
+	//-------------------------------------
+
+	int TestSpeed(void)
+	{
+		// lines of 3 bytes from $0800, each procedure of 10 lines in a scope, in a module scope
+		std::string text = "version\tmajor=2,minor=0\nfile\tid=0,name=\"big.s\",size=0,mtime=0,mod=0\n"
+			"seg\tid=0,name=\"CODE\",start=0x000800,size=0xEA60,addrsize=absolute,type=ro,oname=\"big\",ooffs=0\n";
+		for (int i = 0; i < kSpeedLines; i++)
+		{
+			text += StrFormat("line\tid=%d,file=0,line=%d,span=%d\n", i, i + 1, i);
+			text += StrFormat("span\tid=%d,seg=0,start=%d,size=3\n", i, i * 3);
+		}
+		const int procs = kSpeedLines / 10;
+		text += StrFormat("span\tid=%d,seg=0,start=0,size=%d\n", kSpeedLines, kSpeedLines * 3);
+		text += StrFormat("scope\tid=0,name=\"\",mod=0,span=%d\n", kSpeedLines);
+		for (int i = 0; i < procs; i++)
+		{
+			text += StrFormat("span\tid=%d,seg=0,start=%d,size=30\n", kSpeedLines + 1 + i, i * 30);
+			text += StrFormat("scope\tid=%d,name=\"proc%d\",mod=0,type=scope,parent=0,span=%d\n", i + 1, i, kSpeedLines + 1 + i);
+		}
+
+		SourceInfo_t info;
+		std::string error;
+		const auto loadStart = std::chrono::steady_clock::now();
+		if (!info.LoadDbg(text, "big.dbg", error))
+		{
+			printf("speed: %s\n", error.c_str());
+			return 1;
+		}
+		const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+		int res = 0;
+		if (LineAt(info, 0x0800 + 3 * 12345 + 2) != "big.s:12346" || ScopeAt(info, 0x0800 + 3 * 12345) != "<proc1234>")
+		{
+			printf("speed: wrong line or scope\n");
+			res = 1;
+		}
+
+		// every address in $0800.. has a line (the n-th 3 bytes) and a scope, others have neither
+		int found = 0;
+		int wrong = 0;
+		const auto lookupStart = std::chrono::steady_clock::now();
+		for (int i = 0; i < kLookups; i++)
+		{
+			const WORD address = (WORD)(i * 40503u);
+			const SourceInfoRange_t* pLine = info.FindLine(address);
+			const SourceInfoRange_t* pScope = info.FindScope(address);
+			found += (pLine != NULL) + (pScope != NULL);
+
+			const bool inCode = address >= 0x0800 && address < 0x0800 + kSpeedLines * 3;
+			if ((pLine != NULL) != inCode || (pScope != NULL) != inCode
+				|| (pLine && info.GetLine(pLine->iItem).nLine != (address - 0x0800) / 3 + 1))
+				wrong++;
+		}
+		const double lookupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lookupStart).count();
+
+		printf("speed: %d lines loaded in %.1f ms (target %.0f), %d line & scope lookups in %.1f ms (target %.0f), %d found\n",
+			kSpeedLines, loadMs, kTargetLoadMs, kLookups, lookupMs, kTargetLookupsMs, found);
+		if (!found || wrong)
+		{
+			printf("speed: %d wrong lookups\n", wrong);
+			res = 1;
+		}
+
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int SourceInfo_test(void)
+{
+	const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+	registry->putDWord(RegGetConfigSlotSection(SLOT6), REGVALUE_CARD_TYPE, CT_Empty);
+	const testcommon::TestEmulator emulator(registry);
+
+	int res = 0;
+	res |= TestDbg();
+	res |= TestListing();
+	res |= TestStepping();
+	res |= TestSpeed();
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = SourceInfo_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -0,0 +1,225 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "Debugger/Debug.h"
+
+#include "Card.h"
+#include "Core.h"
+#include "Registry.h"
+
+#include <filesystem>
+#include <fstream>
+
+// Symbol tables: what the lookups by name & by address return once a file is loaded, and after the edits
+// (duplicate names, renames, removals, disabled tables), then the same on a large generated file.
+// BENCHMARK SYM must leave the tables & the program directory alone.
+
+namespace
+{
+
+	const int kManySymbols = 20000;
+
+	void WriteFile(const std::filesystem::path& path, const std::string& text)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << text;
+	}
+
+	int ExpectAddress(const char* pSymbol, const bool found, const WORD address, const int table)
+	{
+		WORD nAddress = 0;
+		int iTable = NUM_SYMBOL_TABLES;
+		const bool bFound = FindAddressFromSymbol(pSymbol, &nAddress, &iTable);
+		if (bFound != found || (found && (nAddress != address || iTable != table)))
+		{
+			printf("%s: found=%d $%04X table %d\n", pSymbol, bFound, nAddress, iTable);
+			return 1;
+		}
+		return 0;
+	}
+
+	int ExpectSymbol(const WORD address, const char* pSymbol, const int table)
+	{
+		int iTable = NUM_SYMBOL_TABLES;
+		std::string const* pFound = FindSymbolFromAddress(address, &iTable);
+		if ((pFound == NULL) != (pSymbol == NULL) || (pFound && (*pFound != pSymbol || iTable != table)))
+		{
+			printf("$%04X: %s table %d\n", address, pFound ? pFound->c_str() : "(none)", iTable);
+			return 1;
+		}
+		return 0;
+	}
+
+	int TestLookups(const std::filesystem::path& temp)
+	{
+		const std::filesystem::path path = temp / "testsymbols.sym";
+		const std::string longName(MAX_SYMBOLS_LEN + 10, 'L');
+		WriteFile(path,
+			"0800 START\r\n"
+			"loop =$0810 ; the ACME format\r\n"
+			"0900 DUP\n"
+			"0880 dup\n"
+			"wait=$FCA8\n"
+			"not a symbol\n"
+			"1000 " + longName + "\n"
+			"FFFF LAST");
+
+		const int nLoaded = ParseSymbolTable(path.string(), SYMBOLS_USER_1);
+		std::filesystem::remove(path);
+
+		int res = 0;
+		if (nLoaded != 7)
+		{
+			printf("lookups: %d symbols loaded\n", nLoaded);
+			res = 1;
+		}
+
+		res |= ExpectAddress("start", true, 0x0800, SYMBOLS_USER_1);
+		res |= ExpectAddress("LOOP", true, 0x0810, SYMBOLS_USER_1);
+		res |= ExpectAddress("wait", true, 0xFCA8, SYMBOLS_USER_1);
+		res |= ExpectAddress("last", true, 0xFFFF, SYMBOLS_USER_1);
+		res |= ExpectAddress("dup", true, 0x0880, SYMBOLS_USER_1);	// the lowest address with that name
+		res |= ExpectAddress(longName.substr(0, MAX_SYMBOLS_LEN).c_str(), true, 0x1000, SYMBOLS_USER_1);
+		res |= ExpectAddress("missing", false, 0, 0);
+		res |= ExpectSymbol(0x0810, "loop", SYMBOLS_USER_1);
+		res |= ExpectSymbol(0x0900, "DUP", SYMBOLS_USER_1);
+		res |= ExpectSymbol(0x0811, NULL, 0);
+
+		// edits
+		SymbolTableErase(SYMBOLS_USER_1, 0x0880);
+		res |= ExpectAddress("dup", true, 0x0900, SYMBOLS_USER_1);
+		res |= ExpectSymbol(0x0880, NULL, 0);
+
+		SymbolTableInsert(SYMBOLS_USER_1, 0x0900, "OTHER");
+		res |= ExpectAddress("dup", false, 0, 0);
+		res |= ExpectAddress("other", true, 0x0900, SYMBOLS_USER_1);
+		res |= ExpectSymbol(0x0900, "OTHER", SYMBOLS_USER_1);
+
+		// user 2 is searched before user 1
+		SymbolTableInsert(SYMBOLS_USER_2, 0x0810, "LOOP2");
+		SymbolTableInsert(SYMBOLS_USER_2, 0x0820, "START");
+		res |= ExpectSymbol(0x0810, "LOOP2", SYMBOLS_USER_2);
+		res |= ExpectAddress("start", true, 0x0820, SYMBOLS_USER_2);
+
+		// disabled tables are skipped
+		g_bDisplaySymbolTables &= ~(1 << SYMBOLS_USER_2);
+		res |= ExpectSymbol(0x0810, "loop", SYMBOLS_USER_1);
+		res |= ExpectAddress("start", true, 0x0800, SYMBOLS_USER_1);
+		res |= ExpectAddress("loop2", false, 0, 0);
+		g_bDisplaySymbolTables |= (1 << SYMBOLS_USER_2);
+
+		_CmdSymbolsClear(SYMBOLS_USER_1);
+		_CmdSymbolsClear(SYMBOLS_USER_2);
+		res |= ExpectAddress("start", false, 0, 0);
+		res |= ExpectSymbol(0x0800, NULL, 0);
+
+		printf("lookups: %s\n", res ? "FAILED" : "OK");
+		return res;
+	}
+
+	// as BENCHMARK SYM, but through a file & with the results checked
+	int TestManySymbols(const std::filesystem::path& temp)
+	{
+		const std::filesystem::path path = temp / "testsymbols_many.sym";
+		std::string text;
+		for (int i = 0; i < kManySymbols; i++)
+			text += (i & 1) ? StrFormat("%04X MANY_%05d\n", i, i) : StrFormat("many_%05d =$%04X ; comment\n", i, i);
+		WriteFile(path, text);
+
+		const int nLoaded = ParseSymbolTable(path.string(), SYMBOLS_USER_1);
+		std::filesystem::remove(path);
+
+		int res = nLoaded == kManySymbols ? 0 : 1;
+		int nWrong = 0;
+		for (int i = 0; i < kManySymbols; i++)
+		{
+			const std::string name = StrFormat((i & 1) ? "MANY_%05d" : "many_%05d", i);
+			nWrong += ExpectAddress(name.c_str(), true, (WORD)i, SYMBOLS_USER_1);
+			nWrong += ExpectSymbol((WORD)i, name.c_str(), SYMBOLS_USER_1);
+			if (nWrong > 10)
+				break;
+		}
+		res |= nWrong ? 1 : 0;
+		res |= ExpectSymbol(kManySymbols, NULL, 0);
+
+		_CmdSymbolsClear(SYMBOLS_USER_1);
+
+		printf("many symbols: %d loaded: %s\n", nLoaded, res ? "FAILED" : "OK");
+		return res;
+	}
+
+	int TestBenchmark(void)
+	{
+		const std::filesystem::path benchFile = std::filesystem::path(g_sProgramDir) / "A2_BENCH.SYM";
+		std::error_code ec;
+		std::filesystem::remove(benchFile, ec);
+
+		SymbolTableInsert(SYMBOLS_USER_2, 0x0300, "MINE");
+		const SymbolTable_t before = g_aSymbols[SYMBOLS_USER_2];
+		const int displaySymbolTables = g_bDisplaySymbolTables;
+
+		SymbolsBenchmark(1000);
+
+		int res = 0;
+		if (g_aSymbols[SYMBOLS_USER_2] != before || g_aSymbols[SYMBOLS_USER_1].size() || g_bDisplaySymbolTables != displaySymbolTables)
+		{
+			printf("benchmark: symbol tables changed\n");
+			res = 1;
+		}
+		res |= ExpectAddress("mine", true, 0x0300, SYMBOLS_USER_2);
+		res |= ExpectSymbol(0x0300, "MINE", SYMBOLS_USER_2);
+		if (std::filesystem::exists(benchFile))
+		{
+			printf("benchmark: %s written\n", benchFile.string().c_str());
+			res = 1;
+		}
+
+		_CmdSymbolsClear(SYMBOLS_USER_2);
+
+		printf("benchmark: %s\n", res ? "FAILED" : "OK");
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int Symbols_test(void)
+{
+	const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+	registry->putDWord(RegGetConfigSlotSection(SLOT6), REGVALUE_CARD_TYPE, CT_Empty);
+	const testcommon::TestEmulator emulator(registry);
+
+	// the user tables only: whatever the main tables hold, no aliases
+	const int displaySymbolTables = g_bDisplaySymbolTables;
+	g_bDisplaySymbolTables = (1 << SYMBOLS_USER_1) | (1 << SYMBOLS_USER_2);
+
+	const std::filesystem::path temp = std::filesystem::temp_directory_path();
+
+	int res = 0;
+	res |= TestLookups(temp);
+	res |= TestManySymbols(temp);
+	res |= TestBenchmark();
+
+	g_bDisplaySymbolTables = displaySymbolTables;
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Symbols_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
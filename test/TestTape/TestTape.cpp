@@ -0,0 +1,217 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "linux/cassettetape.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "Registry.h"
+
+#include <filesystem>
+#include <vector>
+
+// SAVE -> LOAD round trip through the cassette port: the monitor's WRITE is recorded from TAPEOUT,
+// rendered to a wave and read back by the monitor's READ, first in real time, then with the fast load.
+
+namespace
+{
+
+	const WORD kProgramAddr = 0x0300;
+	const WORD kDoneAddr = 0x031F;
+	const WORD kStart = 0x2000;
+	const WORD kEnd = 0x20FF;
+	const int kFrequency = 44100;
+	const UINT kChunk = 10000;
+	const UINT kMaxCycles = 40000000;
+
+	const WORD MONITOR_WRITE = 0xFECD;
+	const WORD MONITOR_READ = 0xFEFD;
+
+	BYTE Pattern(const WORD addr)
+	{
+		return (BYTE)((addr * 7 + 3) ^ (addr >> 8));
+	}
+
+	// INIT, SETVID, SETKBD, HOME, then WRITE or READ [A1, A2]
+	// NB. A1 & A2 are set last: SETVID & SETKBD use A2L
+	void SetupProgram(const WORD routine)
+	{
+		const BYTE program[] =
+		{
+			0x20, 0x2F, 0xFB,									// 0300: JSR INIT
+			0x20, 0x93, 0xFE,									// 0303: JSR SETVID
+			0x20, 0x89, 0xFE,									// 0306: JSR SETKBD
+			0x20, 0x58, 0xFC,									// 0309: JSR HOME
+			0xA9, (BYTE)(kStart & 0xFF),						// 030C: LDA #<start
+			0x85, 0x3C,											// 030E: STA A1L
+			0xA9, (BYTE)(kStart >> 8),							// 0310: LDA #>start
+			0x85, 0x3D,											// 0312: STA A1H
+			0xA9, (BYTE)(kEnd & 0xFF),							// 0314: LDA #<end
+			0x85, 0x3E,											// 0316: STA A2L
+			0xA9, (BYTE)(kEnd >> 8),							// 0318: LDA #>end
+			0x85, 0x3F,											// 031A: STA A2H
+			0x20, (BYTE)(routine & 0xFF), (BYTE)(routine >> 8),	// 031C: JSR WRITE / READ
+			0x4C, 0x1F, 0x03,									// 031F: JMP done
+		};
+
+		for (UINT i = 0; i < sizeof(program); i++)
+			WriteByteToMemory(kProgramAddr + i, program[i]);
+
+		regs.pc = kProgramAddr;
+	}
+
+	// cycles to complete, 0 if it didn't
+	UINT64 Run(bool& sawTurbo)
+	{
+		const UINT64 start = g_nCumulativeCycles;
+		UINT cycles = 0;
+		while (cycles < kMaxCycles && regs.pc != kDoneAddr)
+		{
+			cycles += CpuExecute(kChunk, false);
+			sawTurbo |= CassetteTape::instance().isActive();
+		}
+		return regs.pc == kDoneAddr ? g_nCumulativeCycles - start : 0;
+	}
+
+	bool HasReadError(void)
+	{
+		// the monitor prints "ERR" on a checksum mismatch
+		for (WORD addr = 0x0400; addr < 0x07FE; addr++)
+		{
+			if (ReadByteFromMemory(addr) == 0xC5 && ReadByteFromMemory(addr + 1) == 0xD2 && ReadByteFromMemory(addr + 2) == 0xD2)
+				return true;
+		}
+		return false;
+	}
+
+	int CheckMemory(const char* name, const char* pass)
+	{
+		for (UINT addr = kStart; addr <= kEnd; addr++)
+		{
+			if (ReadByteFromMemory(addr) != Pattern(addr))
+			{
+				printf("%s %s: read 0x%02X instead of 0x%02X @ $%04X\n", name, pass, ReadByteFromMemory(addr), Pattern(addr), addr);
+				return 1;
+			}
+		}
+
+		if (HasReadError())
+		{
+			printf("%s %s: ERR\n", name, pass);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	void ClearMemory(void)
+	{
+		for (UINT addr = kStart; addr <= kEnd; addr++)
+			WriteByteToMemory(addr, 0x00);
+	}
+
+	int RunTapeTest(const char* name, const eApple2Type type)
+	{
+		const testcommon::TestEmulator emulator(testcommon::CreateRegistry(type));
+
+		CassetteTape& tape = CassetteTape::instance();
+		tape.eject();
+		tape.setTurbo(true);
+
+		int res = 0;
+		bool sawTurbo = false;
+
+		// SAVE
+		const std::filesystem::path wavFile = std::filesystem::temp_directory_path() / "testtape.wav";
+		for (UINT addr = kStart; addr <= kEnd; addr++)
+			WriteByteToMemory(addr, Pattern(addr));
+		SetupProgram(MONITOR_WRITE);
+		tape.startRecording(wavFile.string());
+
+		const UINT64 writeCycles = Run(sawTurbo);
+		const size_t edges = tape.getRecordedEdges();
+		if (!tape.stopRecording() || !writeCycles || !sawTurbo)
+		{
+			printf("%s write: failed (%" SIZE_T_FMT " edges)\n", name, edges);
+			res = 1;
+		}
+
+		const std::vector<CassetteTape::tape_data_t> samples = tape.renderRecording(kFrequency);
+		std::error_code ec;
+		if (std::filesystem::file_size(wavFile, ec) != 44 + samples.size())
+		{
+			printf("%s write: bad wav file\n", name);
+			res = 1;
+		}
+		std::filesystem::remove(wavFile, ec);
+
+		// LOAD in real time
+		tape.setData("roundtrip", samples, kFrequency);
+		tape.setFastLoad(false);
+		ClearMemory();
+		SetupProgram(MONITOR_READ);
+
+		sawTurbo = false;
+		const UINT64 readCycles = Run(sawTurbo);
+		if (!readCycles || !sawTurbo)
+		{
+			printf("%s read: failed\n", name);
+			res = 1;
+		}
+		res |= CheckMemory(name, "read");
+
+		// LOAD with the fast load
+		tape.rewind();
+		tape.setFastLoad(true);
+		ClearMemory();
+		SetupProgram(MONITOR_READ);
+
+		const UINT64 fastCycles = Run(sawTurbo);
+		if (!fastCycles || fastCycles * 10 > readCycles)
+		{
+			printf("%s fast read: %llu cycles\n", name, (unsigned long long)fastCycles);
+			res = 1;
+		}
+		res |= CheckMemory(name, "fast read");
+
+		printf("%s: %" SIZE_T_FMT " edges, write %llu, read %llu, fast read %llu cycles: %s\n", name, edges,
+			(unsigned long long)writeCycles, (unsigned long long)readCycles, (unsigned long long)fastCycles, res ? "FAILED" : "OK");
+
+		tape.eject();
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int Tape_test(void)
+{
+	int res = 0;
+
+	res |= RunTapeTest("Apple ][+", A2TYPE_APPLE2PLUS);
+	res |= RunTapeTest("Enhanced //e", A2TYPE_APPLE2EENHANCED);	// READ & WRITE are in the internal $C5 ROM
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = Tape_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
@@ -0,0 +1,320 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+#include "frontends/common2/videooracle.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Interface.h"
+#include "Memory.h"
+#include "NTSC.h"
+#include "Registry.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+// Video oracle: text decoding on 3 machines, the 2 hashes, and a stream of per frame hashes
+// The video memory hash must not depend on the video type (the frame buffer hash does).
+
+namespace
+{
+
+	const UINT kFrames = 1000;
+	const double kTargetVideoMemoryHashUs = 20.0;	// only printed: the test checks the hashes, not the speed
+
+	void SetSwitch(const WORD address)
+	{
+		GetVideo().VideoSetMode(regs.pc, address, 1, 0, 0);
+	}
+
+	void SetTextMode(void)
+	{
+		SetSwitch(0xC051);	// TEXT
+		SetSwitch(0xC054);	// PAGE1
+		SetSwitch(0xC00C);	// 40COL
+		SetSwitch(0xC00E);	// ALTCHARSET off
+	}
+
+	void Poke(const WORD address, const BYTE value)
+	{
+		MemGetMainPtr(address)[0] = value;
+	}
+
+	// returns the number of frames started
+	UINT RunFrames(common2::FrameHashWriter* pWriter, const UINT frames)
+	{
+		UINT started = 0;
+		for (UINT i = 0; i < frames; i++)
+		{
+			UINT cycles = 0;
+			while (cycles < NTSC_GetCyclesPerFrame())
+			{
+				const UINT executed = CpuExecute(1000, true);
+				GetCardMgr().Update(executed);
+				const uint32_t previous = g_dwCyclesThisFrame;
+				g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executed) % NTSC_GetCyclesPerFrame();
+				started += g_dwCyclesThisFrame < previous ? 1 : 0;
+				cycles += executed;
+				if (pWriter)
+					pWriter->update(false);
+			}
+		}
+		return started;
+	}
+
+	int Expect(const char* name, const std::string& text, const std::string& expected)
+	{
+		if (text.compare(0, expected.size(), expected) != 0)
+		{
+			printf("%s: \"%s\" instead of \"%s\"\n", name, text.c_str(), expected.c_str());
+			return 1;
+		}
+		return 0;
+	}
+
+	//-------------------------------------
+
+	// row 0: normal, inverse, flash, lower case, 2 characters that depend on the character set
+	const BYTE kRow0[] = { 0xC1, 0x01, 0x41, 0xE1, 0x40, 0x60, 0xFF };
+
+	int TestText(void)
+	{
+		int res = 0;
+
+		SetTextMode();
+		for (UINT i = 0; i < 40; i++)
+			Poke(0x400 + i, 0xA0);
+		memcpy(MemGetMainPtr(0x400), kRow0, sizeof(kRow0));
+		Poke(0x7D0, 0xBE);	// row 23: ">"
+
+		std::vector<std::string> rows = common2::decodeTextScreen();
+		if (rows.size() != 24 || rows[0].size() != 40 + 2 /* UTF-8 checkerboard */)
+		{
+			printf("text: %u rows, %u bytes in row 0\n", (UINT)rows.size(), (UINT)rows[0].size());
+			return 1;
+		}
+		res |= Expect("40 columns", rows[0], "AAAa@ \xE2\x96\x92 ");
+		res |= Expect("row 23", rows[23], ">");
+
+		SetSwitch(0xC00F);	// MouseText & inverse lower case
+		res |= Expect("alt charset", common2::decodeTextScreen()[0], "AA\xE2\x8C\x98" "a\xEF\xA3\xBF" "`");
+		SetSwitch(0xC00E);
+
+		// 80 columns: aux first
+		SetSwitch(0xC00D);
+		MemGetAuxPtr(0x400)[0] = 0xDA;	// Z
+		MemGetAuxPtr(0x401)[0] = 0xD9;	// Y
+		res |= Expect("80 columns", common2::decodeTextScreen()[0], "ZAYA");
+		SetSwitch(0xC00C);
+
+		// mixed: only the last 4 rows
+		SetSwitch(0xC050);
+		SetSwitch(0xC053);
+		rows = common2::decodeTextScreen();
+		if (!rows[0].empty() || !rows[19].empty() || rows[23].empty())
+		{
+			printf("mixed: graphics rows decoded\n");
+			res = 1;
+		}
+		SetSwitch(0xC052);
+		rows = common2::decodeTextScreen();
+		if (!rows[23].empty())
+		{
+			printf("graphics: text rows decoded\n");
+			res = 1;
+		}
+		SetTextMode();
+
+		return res;
+	}
+
+	int TestOtherMachine(const eApple2Type type, const char* expected)
+	{
+		const testcommon::TestEmulator emulator(testcommon::CreateRegistry(type));
+
+		SetTextMode();
+		memcpy(MemGetMainPtr(0x400), kRow0, sizeof(kRow0));
+		return Expect(type == A2TYPE_APPLE2PLUS ? "][+" : "Pravets 82", common2::decodeTextScreen()[0], expected);
+	}
+
+	//-------------------------------------
+
+	int TestHashes(testcommon::TestFrame& frame)
+	{
+		int res = 0;
+
+		// xxHash64 reference values
+		if (common2::hash64("", 0) != 0xEF46DB3751D8E999ULL || common2::hash64("abc", 3) != 0x44BC2CF5AD770999ULL)
+		{
+			printf("hash64: %016llx %016llx\n", (unsigned long long)common2::hash64("", 0), (unsigned long long)common2::hash64("abc", 3));
+			res = 1;
+		}
+
+		// no flashing characters: the frame buffer is redrawn from memory for each hash
+		SetTextMode();
+		for (WORD address = 0x400; address < 0x800; address++)
+			Poke(address, 0xA0);
+		const uint64_t memory = common2::hashVideoMemory();
+		const uint64_t frameBuffer = common2::hashFrameBuffer(true);
+
+		// a screen hole is not shown
+		Poke(0x478, MemGetMainPtr(0x478)[0] ^ 0xFF);
+		if (common2::hashVideoMemory() != memory || common2::hashFrameBuffer(true) != frameBuffer)
+		{
+			printf("hashes: screen hole\n");
+			res = 1;
+		}
+
+		// the video type only changes the frame buffer
+		Video& video = GetVideo();
+		const VideoType_e videoType = video.GetVideoType();
+		video.SetVideoType(videoType == VT_MONO_WHITE ? VT_COLOR_IDEALIZED : VT_MONO_WHITE);
+		frame.ApplyVideoModeChange();
+		if (common2::hashVideoMemory() != memory || common2::hashFrameBuffer(true) == frameBuffer)
+		{
+			printf("hashes: video type\n");
+			res = 1;
+		}
+		video.SetVideoType(videoType);
+		frame.ApplyVideoModeChange();
+		if (common2::hashFrameBuffer(true) != frameBuffer)
+		{
+			printf("hashes: frame buffer not repeatable\n");
+			res = 1;
+		}
+
+		// a visible byte, the mode
+		Poke(0x7F7, MemGetMainPtr(0x7F7)[0] ^ 0x01);
+		const uint64_t changed = common2::hashVideoMemory();
+		SetSwitch(0xC050);
+		if (changed == memory || common2::hashVideoMemory() == changed || common2::hashFrameBuffer(true) == frameBuffer)
+		{
+			printf("hashes: not changed\n");
+			res = 1;
+		}
+		SetTextMode();
+
+		// hires: only the displayed page
+		SetSwitch(0xC050);
+		SetSwitch(0xC057);
+		const uint64_t hires = common2::hashVideoMemory();
+		Poke(0x4000, MemGetMainPtr(0x4000)[0] ^ 0xFF);
+		Poke(0x2078, MemGetMainPtr(0x2078)[0] ^ 0xFF);	// hole
+		const bool hiresHoles = common2::hashVideoMemory() != hires;
+		Poke(0x3FF7, MemGetMainPtr(0x3FF7)[0] ^ 0xFF);	// last byte of line 191
+		if (hiresHoles || common2::hashVideoMemory() == hires)
+		{
+			printf("hashes: hires page\n");
+			res = 1;
+		}
+		SetSwitch(0xC056);
+		SetTextMode();
+
+		// nothing changes, so every hash must be the same
+		const uint64_t text = common2::hashVideoMemory();
+		const auto start = std::chrono::steady_clock::now();
+		UINT differ = 0;
+		for (UINT i = 0; i < kFrames; i++)
+			differ += common2::hashVideoMemory() != text;
+		const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kFrames;
+		printf("hashes: video memory %.2f us per frame (target %.0f)\n", us, kTargetVideoMemoryHashUs);
+		if (differ)
+		{
+			printf("hashes: %u of %u hashes differ\n", differ, kFrames);
+			res = 1;
+		}
+
+		return res;
+	}
+
+	int TestFrameHashes(void)
+	{
+		int res = 0;
+
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "testvideooracle.txt";
+		UINT frames = 0;
+		{
+			common2::FrameHashWriter writer(path.string());
+			frames = RunFrames(&writer, 120);
+			if (writer.getFrames() != frames)
+			{
+				printf("frame hashes: %u frames instead of %u\n", (UINT)writer.getFrames(), frames);
+				res = 1;
+			}
+		}
+
+		std::ifstream file(path);
+		std::string line;
+		std::set<std::string> frameBuffers, memories;
+		UINT lines = 0;
+		UINT frame;
+		while (std::getline(file, line))
+		{
+			char frameBuffer[17], memory[17];
+			if (sscanf(line.c_str(), "%x %16s %16s", &frame, frameBuffer, memory) != 3 || frame != lines)
+			{
+				printf("frame hashes: %s\n", line.c_str());
+				res = 1;
+				break;
+			}
+			frameBuffers.insert(frameBuffer);
+			memories.insert(memory);
+			lines++;
+		}
+		std::filesystem::remove(path);
+
+		// idle at the BASIC prompt: the cursor blinks (the firmware swaps the character)
+		// the frame buffer shows a change a frame later if the beam had already passed it
+		printf("frame hashes: %u frames, %u frame buffers, %u video memories\n", lines, (UINT)frameBuffers.size(), (UINT)memories.size());
+		if (lines != frames || memories.size() != 2 || frameBuffers.size() < 2)
+			res = 1;
+
+		return res;
+	}
+
+}
+
+//-------------------------------------
+
+int VideoOracle_test(void)
+{
+	int res = 0;
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = testcommon::CreateRegistry();
+		registry->putDWord(RegGetConfigSlotSection(SLOT6), REGVALUE_CARD_TYPE, CT_Empty);
+		const testcommon::TestEmulator emulator(registry);
+
+		RunFrames(NULL, 120);	// to the BASIC prompt
+		res |= TestFrameHashes();
+		res |= TestText();
+		res |= TestHashes(emulator.GetFrame());
+	}
+
+	// ][+: upper case only, Pravets 82: Cyrillic instead
+	res |= TestOtherMachine(A2TYPE_APPLE2PLUS, "AAA!@ ?");
+	res |= TestOtherMachine(A2TYPE_PRAVETS82, "AAA\xD0\x90@ \xD0\xAA");
+
+	return res;
+}
+
+//-------------------------------------
+
+int DoTest(void)
+{
+	int res = 1;
+
+	res = VideoOracle_test();
+	if (res) return res;
+
+	return res;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	return DoTest();
+}
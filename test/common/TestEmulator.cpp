@@ -0,0 +1,60 @@
+#include "StdAfx.h"
+
+#include "TestEmulator.h"
+
+#include "linux/paddle.h"
+#include "debugserver/DebugServerManager.h"
+
+#include "Core.h"
+#include "Registry.h"
+
+namespace testcommon
+{
+
+	TestFrame::TestFrame(const common2::EmulatorOptions& options) : common2::GNUFrame(options)
+	{
+	}
+
+	void TestFrame::VideoPresentScreen(void)
+	{
+	}
+
+	int TestFrame::FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType)
+	{
+		fprintf(stderr, "%s: %s\n", lpCaption, lpText);
+		return IDOK;
+	}
+
+	std::shared_ptr<SoundBuffer> TestFrame::CreateSoundBuffer(uint32_t dwBufferSize, uint32_t nSampleRate, int nChannels, const char* pszVoiceName)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<common2::PTreeRegistry> CreateRegistry(const eApple2Type type)
+	{
+		const std::shared_ptr<common2::PTreeRegistry> registry = std::make_shared<common2::PTreeRegistry>();
+		registry->putDWord(REG_CONFIG, REGVALUE_APPLE2_TYPE, type);
+		return registry;
+	}
+
+	TestEmulator::TestEmulator(const std::shared_ptr<common2::PTreeRegistry>& registry,
+		const common2::EmulatorOptions& options, const bool debugServer, const std::function<void()>& beforeBegin)
+		: myRegistryContext(registry)
+		, myFrame(std::make_shared<TestFrame>(options))
+		, myInitialisation(myFrame, std::make_shared<Paddle>())
+	{
+		g_bDisableDirectSound = true;
+		g_bDisableDirectSoundMockingboard = true;
+		DebugServer_SetEnabled(debugServer);
+		if (beforeBegin)
+			beforeBegin();
+
+		myFrame->Begin();
+	}
+
+	TestEmulator::~TestEmulator()
+	{
+		myFrame->End();
+	}
+
+}
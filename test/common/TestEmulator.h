@@ -0,0 +1,50 @@
+#pragma once
+
+#include "frontends/common2/gnuframe.h"
+#include "frontends/common2/programoptions.h"
+#include "frontends/common2/ptreeregistry.h"
+#include "linux/context.h"
+
+#include "Common.h"
+
+#include <functional>
+#include <memory>
+
+// The emulator the tests run on: no video, no sound, no debug server, the registry in memory.
+
+namespace testcommon
+{
+
+	// Message boxes go to stderr
+	class TestFrame : public common2::GNUFrame
+	{
+	public:
+		TestFrame(const common2::EmulatorOptions& options);
+
+		void VideoPresentScreen(void) override;
+		int FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType) override;
+		std::shared_ptr<SoundBuffer> CreateSoundBuffer(uint32_t dwBufferSize, uint32_t nSampleRate, int nChannels, const char* pszVoiceName) override;
+	};
+
+	// The model only: the tests add their cards & settings
+	std::shared_ptr<common2::PTreeRegistry> CreateRegistry(const eApple2Type type = A2TYPE_APPLE2EENHANCED);
+
+	// Begin() in the constructor, End() in the destructor (as common2::CommonInitialisation)
+	// beforeBegin: what a command line switch would set up before Begin()
+	class TestEmulator
+	{
+	public:
+		TestEmulator(const std::shared_ptr<common2::PTreeRegistry>& registry,
+			const common2::EmulatorOptions& options = common2::EmulatorOptions(), const bool debugServer = false,
+			const std::function<void()>& beforeBegin = std::function<void()>());
+		~TestEmulator();
+
+		TestFrame& GetFrame(void) const { return *myFrame; }
+
+	private:
+		const RegistryContext myRegistryContext;
+		const std::shared_ptr<TestFrame> myFrame;
+		const Initialisation myInitialisation;
+	};
+
+}